@@ -0,0 +1,211 @@
+/**
+ * File Name: bench_alu.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <benchmark/benchmark.h>
+#include "vm/alu.h"
+#include "utils.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using alu::AluOp;
+
+constexpr size_t kOperands = 1024; // a power of two
+
+// Non-zero operands of mixed signs, so divisions take their normal path.
+std::vector<uint64_t> IntegerOperands() {
+  std::mt19937_64 random(1);
+  std::vector<uint64_t> operands(kOperands);
+  for (uint64_t &operand : operands) {
+    operand = random() | 1;
+  }
+  return operands;
+}
+
+std::vector<uint64_t> FloatOperands(bool is_double) {
+  std::mt19937_64 random(2);
+  std::uniform_real_distribution<double> dist(0.5, 1000.0);
+  std::vector<uint64_t> operands(kOperands);
+  for (uint64_t &operand : operands) {
+    if (is_double) {
+      double value = dist(random);
+      std::memcpy(&operand, &value, 8);
+    } else {
+      auto value = static_cast<float>(dist(random));
+      uint32_t bits;
+      std::memcpy(&bits, &value, 4);
+      operand = bits;
+    }
+  }
+  return operands;
+}
+
+void BM_AluExecute(benchmark::State &state, AluOp op) {
+  alu::Alu alu;
+  std::vector<uint64_t> operands = IntegerOperands();
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(alu.execute(op, operands[i], operands[(i + 1) & (kOperands - 1)]));
+    i = (i + 1) & (kOperands - 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// range(0) is the rounding mode: RNE, RTZ, RDN, RUP, RMM.
+void BM_FpExecute(benchmark::State &state, AluOp op) {
+  std::vector<uint64_t> operands = FloatOperands(false);
+  auto rm = static_cast<uint8_t>(state.range(0));
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(alu::Alu::fpexecute(op, operands[i], operands[(i + 1) & (kOperands - 1)],
+                                                 operands[(i + 2) & (kOperands - 1)], rm));
+    i = (i + 1) & (kOperands - 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_DfpExecute(benchmark::State &state, AluOp op) {
+  std::vector<uint64_t> operands = FloatOperands(true);
+  auto rm = static_cast<uint8_t>(state.range(0));
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(alu::Alu::dfpexecute(op, operands[i], operands[(i + 1) & (kOperands - 1)],
+                                                  operands[(i + 2) & (kOperands - 1)], rm));
+    i = (i + 1) & (kOperands - 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Converts a rotating set of values with fn, which takes one operand from the list.
+template <typename Operand, typename Fn>
+void RunConversion(benchmark::State &state, const std::vector<Operand> &operands, Fn fn) {
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(fn(operands[i]));
+    i = (i + 1) & (kOperands - 1);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+std::vector<float> Floats() {
+  std::mt19937_64 random(3);
+  std::uniform_real_distribution<float> dist(-100.0f, 100.0f);
+  std::vector<float> values(kOperands);
+  for (float &value : values) {
+    value = dist(random);
+  }
+  return values;
+}
+
+std::vector<uint16_t> Halves(uint16_t (*encode)(float)) {
+  std::vector<uint16_t> halves;
+  for (float value : Floats()) {
+    halves.push_back(encode(value));
+  }
+  return halves;
+}
+
+void BM_Float16Encode(benchmark::State &state) {
+  RunConversion(state, Floats(), alu::float_to_float16);
+}
+
+void BM_Float16Decode(benchmark::State &state) {
+  RunConversion(state, Halves(alu::float_to_float16), alu::float16_to_float);
+}
+
+void BM_Bfloat16Encode(benchmark::State &state) {
+  RunConversion(state, Floats(), alu::float_to_bfloat16);
+}
+
+void BM_Bfloat16Decode(benchmark::State &state) {
+  RunConversion(state, Halves(alu::float_to_bfloat16), alu::bfloat16_to_float);
+}
+
+std::vector<std::array<float, 4>> Blocks() {
+  std::vector<float> floats = Floats();
+  std::vector<std::array<float, 4>> blocks(kOperands);
+  for (size_t i = 0; i < kOperands; ++i) {
+    blocks[i] = {floats[i], floats[(i + 1) & (kOperands - 1)], floats[(i + 2) & (kOperands - 1)],
+                 floats[(i + 3) & (kOperands - 1)]};
+  }
+  return blocks;
+}
+
+void BM_Msfp16Pack(benchmark::State &state) {
+  RunConversion(state, Blocks(), alu::msfp16_pack);
+}
+
+void BM_Msfp16Unpack(benchmark::State &state) {
+  std::vector<uint64_t> packed;
+  for (const auto &block : Blocks()) {
+    packed.push_back(alu::msfp16_pack(block));
+  }
+  RunConversion(state, packed, alu::msfp16_unpack);
+}
+
+void BM_Hamming64_57Encode(benchmark::State &state) {
+  RunConversion(state, IntegerOperands(), [](uint64_t data) {
+    return hamming64_57_encode(data & ((uint64_t{1} << 57) - 1));
+  });
+}
+
+// range(0) is 1 to flip one bit of every codeword, so each decode corrects it.
+void BM_Hamming64_57Decode(benchmark::State &state) {
+  std::vector<uint64_t> codewords;
+  for (uint64_t data : IntegerOperands()) {
+    codewords.push_back(hamming64_57_encode(data & ((uint64_t{1} << 57) - 1)) ^ (state.range(0) ? 1u << 5 : 0));
+  }
+  RunConversion(state, codewords, [](uint64_t codeword) {
+    bool corrected = false, uncorrectable = false;
+    return hamming64_57_decode(codeword, &corrected, &uncorrectable);
+  });
+}
+
+} // namespace
+
+BENCHMARK_CAPTURE(BM_AluExecute, add, AluOp::kAdd);
+BENCHMARK_CAPTURE(BM_AluExecute, addw, AluOp::kAddw);
+BENCHMARK_CAPTURE(BM_AluExecute, sub, AluOp::kSub);
+BENCHMARK_CAPTURE(BM_AluExecute, and, AluOp::kAnd);
+BENCHMARK_CAPTURE(BM_AluExecute, xor, AluOp::kXor);
+BENCHMARK_CAPTURE(BM_AluExecute, sll, AluOp::kSll);
+BENCHMARK_CAPTURE(BM_AluExecute, sra, AluOp::kSra);
+BENCHMARK_CAPTURE(BM_AluExecute, slt, AluOp::kSlt);
+BENCHMARK_CAPTURE(BM_AluExecute, sltu, AluOp::kSltu);
+BENCHMARK_CAPTURE(BM_AluExecute, mul, AluOp::kMul);
+BENCHMARK_CAPTURE(BM_AluExecute, mulh, AluOp::kMulh);
+BENCHMARK_CAPTURE(BM_AluExecute, div, AluOp::kDiv);
+BENCHMARK_CAPTURE(BM_AluExecute, divu, AluOp::kDivu);
+BENCHMARK_CAPTURE(BM_AluExecute, rem, AluOp::kRem);
+BENCHMARK_CAPTURE(BM_AluExecute, add_simd32, AluOp::kAdd_simd32);
+BENCHMARK_CAPTURE(BM_AluExecute, ecc_add, AluOp::kEcc_add);
+
+BENCHMARK_CAPTURE(BM_FpExecute, fadd_s, AluOp::FADD_S)->DenseRange(0, 4);
+BENCHMARK_CAPTURE(BM_FpExecute, fmul_s, AluOp::FMUL_S)->DenseRange(0, 4);
+BENCHMARK_CAPTURE(BM_FpExecute, fdiv_s, AluOp::FDIV_S)->DenseRange(0, 4);
+BENCHMARK_CAPTURE(BM_FpExecute, fsqrt_s, AluOp::FSQRT_S)->DenseRange(0, 4);
+BENCHMARK_CAPTURE(BM_FpExecute, fmadd_s, AluOp::kFmadd_s)->DenseRange(0, 4);
+BENCHMARK_CAPTURE(BM_FpExecute, fcvt_w_s, AluOp::FCVT_W_S)->DenseRange(0, 4);
+BENCHMARK_CAPTURE(BM_FpExecute, fmadd_fp16, AluOp::FMADD_FP16)->Arg(0);
+BENCHMARK_CAPTURE(BM_FpExecute, fmadd_bf16, AluOp::FMADD_BF16)->Arg(0);
+BENCHMARK_CAPTURE(BM_FpExecute, fmadd_msfp16, AluOp::FMADD_MSFP16)->Arg(0);
+BENCHMARK_CAPTURE(BM_DfpExecute, fadd_d, AluOp::FADD_D)->DenseRange(0, 4);
+BENCHMARK_CAPTURE(BM_DfpExecute, fdiv_d, AluOp::FDIV_D)->DenseRange(0, 4);
+BENCHMARK_CAPTURE(BM_DfpExecute, fmadd_d, AluOp::FMADD_D)->DenseRange(0, 4);
+
+BENCHMARK(BM_Float16Encode);
+BENCHMARK(BM_Float16Decode);
+BENCHMARK(BM_Bfloat16Encode);
+BENCHMARK(BM_Bfloat16Decode);
+BENCHMARK(BM_Msfp16Pack);
+BENCHMARK(BM_Msfp16Unpack);
+BENCHMARK(BM_Hamming64_57Encode);
+BENCHMARK(BM_Hamming64_57Decode)->Arg(0)->Arg(1);
@@ -0,0 +1,121 @@
+/**
+ * File Name: bench_assembler.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <benchmark/benchmark.h>
+#include "assembler/assembler.h"
+#include "assembler/code_generator.h"
+#include "assembler/lexer.h"
+#include "assembler/parser.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Writes a source of about `lines` lines: a data section of numbers, then a loop body of
+ *        R, I, load/store, floating-point and branch instructions with a label every 16 lines.
+ * @return The path, reused while the size stays the same.
+ */
+std::filesystem::path GenerateSource(int64_t lines) {
+  std::filesystem::path path = std::filesystem::temp_directory_path()
+      / ("vm_bench_source_" + std::to_string(lines) + ".s");
+  if (std::filesystem::exists(path)) {
+    return path;
+  }
+  std::ofstream file(path);
+  file << ".data\n";
+  for (int64_t i = 0; i < lines/8; ++i) {
+    file << "values" << i << ": .dword " << i*7919 << ", " << -i << ", 0x" << std::hex << i*31 << std::dec << "\n";
+  }
+  file << ".text\n";
+  file << "  la s0, values0\n";
+  static const char *kBody[] = {
+      "  add t0, t1, t2\n",
+      "  addi t1, t1, -17\n",
+      "  ld t2, 8(s0)\n",
+      "  sd t2, 16(s0)\n",
+      "  mul t3, t0, t1\n",
+      "  slli t4, t3, 3\n",
+      "  fadd.d f1, f2, f3\n",
+      "  fmadd.s f4, f5, f6, f7\n",
+      "  li t5, 123456\n",
+      "  xor a0, a0, t5\n",
+      "  sltu a1, a0, t5\n",
+      "  lw a2, 4(s0)\n",
+      "  beq a1, x0, ",
+      "  jal x0, ",
+      "  mv a3, a2\n",
+      "  srai a4, a3, 2\n",
+  };
+  for (int64_t i = 0; i < lines - lines/8; ++i) {
+    if (i % 16 == 0) {
+      file << "block" << i/16 << ":\n";
+    }
+    file << kBody[i % 16];
+    if (i % 16 == 12 || i % 16 == 13) {
+      file << "block" << i/16 << "\n";
+    }
+  }
+  return path;
+}
+
+void SetCounters(benchmark::State &state, const std::filesystem::path &path) {
+  state.SetItemsProcessed(state.iterations()*state.range(0));
+  state.SetBytesProcessed(state.iterations()*static_cast<int64_t>(std::filesystem::file_size(path)));
+}
+
+void BM_Lexer(benchmark::State &state) {
+  std::filesystem::path path = GenerateSource(state.range(0));
+  for (auto _ : state) {
+    Lexer lexer(path.string());
+    benchmark::DoNotOptimize(lexer.getTokenList());
+  }
+  SetCounters(state, path);
+}
+
+void BM_Parser(benchmark::State &state) {
+  std::filesystem::path path = GenerateSource(state.range(0));
+  std::vector<Token> tokens = Lexer(path.string()).getTokenList();
+  for (auto _ : state) {
+    Parser parser(path.string(), tokens);
+    parser.parse();
+    if (parser.getErrorCount() != 0) {
+      state.SkipWithError("the generated source does not parse");
+      break;
+    }
+    benchmark::DoNotOptimize(parser.getIntermediateCode().data());
+  }
+  SetCounters(state, path);
+}
+
+void BM_CodeGenerator(benchmark::State &state) {
+  std::filesystem::path path = GenerateSource(state.range(0));
+  Parser parser(path.string(), Lexer(path.string()).getTokenList());
+  parser.parse();
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(generateMachineCode(parser.getIntermediateCode()));
+  }
+  SetCounters(state, path);
+}
+
+void BM_Assemble(benchmark::State &state) {
+  std::filesystem::path path = GenerateSource(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(assemble(path.string(), false));
+  }
+  SetCounters(state, path);
+}
+
+} // namespace
+
+// range(0) is the number of source lines; items per second are lines per second.
+BENCHMARK(BM_Lexer)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Parser)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CodeGenerator)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Assemble)->Arg(1000)->Arg(100000)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,102 @@
+/**
+ * File Name: bench_memory.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <benchmark/benchmark.h>
+#include "vm/memory_controller.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t kBase = 0x10000000;
+
+// Aligned addresses covering working_set bytes, in order or shuffled.
+std::vector<uint64_t> Addresses(uint64_t working_set, unsigned int width, bool random) {
+  std::vector<uint64_t> addresses(working_set/width);
+  for (size_t i = 0; i < addresses.size(); ++i) {
+    addresses[i] = kBase + i*width;
+  }
+  if (random) {
+    std::shuffle(addresses.begin(), addresses.end(), std::mt19937_64(1));
+  }
+  return addresses;
+}
+
+template <unsigned int kWidth>
+uint64_t Read(MemoryController &memory, uint64_t address) {
+  if constexpr (kWidth == 1) {
+    return memory.ReadByte(address);
+  } else if constexpr (kWidth == 4) {
+    return memory.ReadWord(address);
+  } else {
+    return memory.ReadDoubleWord(address);
+  }
+}
+
+template <unsigned int kWidth>
+void Write(MemoryController &memory, uint64_t address, uint64_t value) {
+  if constexpr (kWidth == 1) {
+    memory.WriteByte(address, static_cast<uint8_t>(value));
+  } else if constexpr (kWidth == 4) {
+    memory.WriteWord(address, static_cast<uint32_t>(value));
+  } else {
+    memory.WriteDoubleWord(address, value);
+  }
+}
+
+// range(0) is the working set in bytes; it is written once first so every block exists.
+template <unsigned int kWidth, bool kRandom>
+void BM_MemoryRead(benchmark::State &state) {
+  MemoryController memory;
+  std::vector<uint64_t> addresses = Addresses(state.range(0), kWidth, kRandom);
+  for (uint64_t address : addresses) {
+    Write<kWidth>(memory, address, address);
+  }
+  size_t i = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Read<kWidth>(memory, addresses[i]));
+    i = i + 1 == addresses.size() ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations()*kWidth);
+}
+
+template <unsigned int kWidth, bool kRandom>
+void BM_MemoryWrite(benchmark::State &state) {
+  MemoryController memory;
+  std::vector<uint64_t> addresses = Addresses(state.range(0), kWidth, kRandom);
+  for (uint64_t address : addresses) {
+    Write<kWidth>(memory, address, 0);
+  }
+  size_t i = 0;
+  uint64_t value = 0;
+  for (auto _ : state) {
+    Write<kWidth>(memory, addresses[i], ++value);
+    i = i + 1 == addresses.size() ? 0 : i + 1;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations()*kWidth);
+}
+
+} // namespace
+
+// 64 KiB stays in the host's L2; 16 MiB spans many memory blocks and misses the host caches.
+#define MEMORY_BENCHMARKS(width)                                                          \
+  BENCHMARK(BM_MemoryRead<width, false>)->Name("BM_MemoryRead/" #width "/sequential")     \
+      ->Arg(64 << 10)->Arg(16 << 20);                                                     \
+  BENCHMARK(BM_MemoryRead<width, true>)->Name("BM_MemoryRead/" #width "/random")          \
+      ->Arg(64 << 10)->Arg(16 << 20);                                                     \
+  BENCHMARK(BM_MemoryWrite<width, false>)->Name("BM_MemoryWrite/" #width "/sequential")   \
+      ->Arg(64 << 10)->Arg(16 << 20);                                                     \
+  BENCHMARK(BM_MemoryWrite<width, true>)->Name("BM_MemoryWrite/" #width "/random")        \
+      ->Arg(64 << 10)->Arg(16 << 20)
+
+MEMORY_BENCHMARKS(1);
+MEMORY_BENCHMARKS(4);
+MEMORY_BENCHMARKS(8);
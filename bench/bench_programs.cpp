@@ -0,0 +1,84 @@
+/**
+ * File Name: bench_programs.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <benchmark/benchmark.h>
+#include "assembler/assembler.h"
+#include "common/null_stream.h"
+#include "vm/rvss/rvss_vm.h"
+
+#include <algorithm>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint64_t kSliceInstructions = 1 << 16;
+constexpr uint64_t kInstructionLimit = 2000000; ///< Per run, for programs that never end.
+
+// Runs the program from its entry point until it ends; items per second is the guest's
+// instructions per second.
+void BM_Program(benchmark::State &state, const std::filesystem::path &path) {
+  AssembledProgram program;
+  try {
+    program = assemble(path.string(), false);
+  } catch (const std::exception &e) {
+    state.SkipWithError(e.what());
+    return;
+  }
+  uint64_t instructions = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    VmContext context = VmContext::FromGlobals();
+    context.dump_state = false;
+    context.vm_as_backend = false;
+    RVSSVM vm(std::move(context));
+    NullBuffer null_buffer;
+    std::streambuf *cout_buffer = std::cout.rdbuf(&null_buffer);
+    vm.LoadProgram(program);
+    std::cout.rdbuf(cout_buffer);
+    vm.guest_io_.SetCaptureOutput(true);
+    vm.guest_io_.PreloadStdin("/dev/null");
+    state.ResumeTiming();
+    try {
+      uint64_t executed = 0;
+      while (!vm.IsHalted() && executed < kInstructionLimit) {
+        uint64_t ran = vm.RunQuantum(kSliceInstructions);
+        if (ran == 0) {
+          break;
+        }
+        executed += ran;
+      }
+      instructions += executed;
+    } catch (const std::exception &e) {
+      state.SkipWithError(e.what());
+      break;
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(instructions));
+  state.counters["instructions"] = benchmark::Counter(static_cast<double>(instructions),
+                                                      benchmark::Counter::kAvgIterations);
+}
+
+// One benchmark per examples/*.s, registered before benchmark_main parses the command line.
+const bool kProgramsRegistered = [] {
+  std::vector<std::filesystem::path> programs;
+  for (const auto &entry : std::filesystem::directory_iterator(VM_EXAMPLES_DIR)) {
+    if (entry.path().extension() == ".s") {
+      programs.push_back(entry.path());
+    }
+  }
+  std::sort(programs.begin(), programs.end());
+  for (const auto &path : programs) {
+    benchmark::RegisterBenchmark(("BM_Program/" + path.stem().string()).c_str(), BM_Program, path)
+        ->Unit(benchmark::kMicrosecond);
+  }
+  return true;
+}();
+
+} // namespace
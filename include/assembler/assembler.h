@@ -25,8 +25,9 @@
  * machine code for each block.
  * 
  * @param IntermediateCode A vector of pairs containing ICUnit and a boolean flag.
+ * @param dump_state Whether to write the disassembly and error dumps to vm_state.
  * @return A vector of strings representing the machine code.
  */
-AssembledProgram assemble(const std::string &filename);
+AssembledProgram assemble(const std::string &filename, bool dump_state = true);
 
 #endif // ASSEMBLER_H
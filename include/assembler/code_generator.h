@@ -34,8 +34,10 @@ struct ICUnit {
   std::array<char, 33> imm;     ///< Immediate value (up to 32 characters, null-terminated).
   std::string label;            ///< Label associated with this code block, if any.
   uint8_t rm;       ///< Rounding mode (up to 4 characters, null-terminated).
+  uint32_t vtype;   ///< vtype immediate of vsetvli/vsetivli.
+  bool masked;      ///< Vector instruction executes under the v0.t mask.
 
-  ICUnit() : line_number{}, opcode{}, rd{}, rs1{}, rs2{}, rs3{}, csr{}, imm{}, label{}, rm{} {
+  ICUnit() : line_number{}, opcode{}, rd{}, rs1{}, rs2{}, rs3{}, csr{}, imm{}, label{}, rm{}, vtype{}, masked{} {
     opcode.fill('\0');
     rd.fill('\0');
     rs1.fill('\0');
@@ -87,7 +89,16 @@ struct ICUnit {
       os << " rm=" << static_cast<int>(unit.rm);
     }
 
-    // 6. label (if any) — put at the end in angle brackets
+    // 6. vector type and mask
+    if (unit.vtype != 0) {
+      std::ios_base::fmtflags f(os.flags());
+      os << " vtype=0x" << std::hex << unit.vtype;
+      os.flags(f);
+    }
+    if (unit.masked) {
+      os << ", v0.t";
+    }
+    // 7. label (if any) — put at the end in angle brackets
     if (!unit.label.empty()) {
       os << " <" << unit.label << '>';
     }
@@ -146,6 +157,14 @@ struct ICUnit {
     rm = value;
   }
 
+  void setVtype(uint32_t value) {
+    vtype = value;
+  }
+
+  void setMasked(bool value) {
+    masked = value;
+  }
+
   [[nodiscard]] unsigned int getLineNumber() const {
     return line_number;
   }
@@ -189,6 +208,14 @@ struct ICUnit {
   [[nodiscard]] uint8_t getRm() const {
     return rm;
   }
+
+  [[nodiscard]] uint32_t getVtype() const {
+    return vtype;
+  }
+
+  [[nodiscard]] bool isMasked() const {
+    return masked;
+  }
 };
 
 // TODO: use uint32_t instead of std::bitset<32>
@@ -276,6 +303,10 @@ uint32_t generateFDR4TypeMachineCode(const ICUnit &block);
 uint32_t generateFDITypeMachineCode(const ICUnit &block);
 uint32_t generateFDSTypeMachineCode(const ICUnit &block);
 
+uint32_t generateVTypeMachineCode(const ICUnit &block);
+uint32_t generateVMemTypeMachineCode(const ICUnit &block);
+uint32_t generateVConfigMachineCode(const ICUnit &block);
+
 /**
  * @brief Generates machine code from a vector of intermediate code blocks.
  * 
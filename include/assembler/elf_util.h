@@ -9,6 +9,12 @@
 
 #include "vm_asm_mw.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
 struct ElfHeader {
   uint8_t e_ident[16] = {0x7F, 'E', 'L', 'F', 1, 1, 1, 0}; // ELF magic number
   uint16_t e_type = 2;        // Executable file
@@ -41,4 +47,130 @@ struct ElfSectionHeader {
 
 void generateElfFile(const AssembledProgram &program, const std::string &output_filename);
 
-#endif // ELF_UTIL_H
\ No newline at end of file
+// ELF64 on-disk structures, as produced by GCC/LLVM for riscv64 targets.
+
+constexpr uint8_t kElfClass64 = 2;
+constexpr uint8_t kElfDataLsb = 1;
+constexpr uint16_t kElfMachineRiscv = 0xF3;
+constexpr uint32_t kElfPtLoad = 1;
+constexpr uint32_t kElfPfExecute = 0x1;
+constexpr uint32_t kElfShtSymtab = 2;
+constexpr uint8_t kElfSttObject = 1;
+constexpr uint8_t kElfSttFunc = 2;
+constexpr uint8_t kElfSttNotype = 0;
+
+struct Elf64Header {
+  uint8_t e_ident[16];
+  uint16_t e_type;
+  uint16_t e_machine;
+  uint32_t e_version;
+  uint64_t e_entry;
+  uint64_t e_phoff;
+  uint64_t e_shoff;
+  uint32_t e_flags;
+  uint16_t e_ehsize;
+  uint16_t e_phentsize;
+  uint16_t e_phnum;
+  uint16_t e_shentsize;
+  uint16_t e_shnum;
+  uint16_t e_shstrndx;
+};
+
+struct Elf64ProgramHeader {
+  uint32_t p_type;
+  uint32_t p_flags;
+  uint64_t p_offset;
+  uint64_t p_vaddr;
+  uint64_t p_paddr;
+  uint64_t p_filesz;
+  uint64_t p_memsz;
+  uint64_t p_align;
+};
+
+struct Elf64SectionHeader {
+  uint32_t sh_name;
+  uint32_t sh_type;
+  uint64_t sh_flags;
+  uint64_t sh_addr;
+  uint64_t sh_offset;
+  uint64_t sh_size;
+  uint32_t sh_link;
+  uint32_t sh_info;
+  uint64_t sh_addralign;
+  uint64_t sh_entsize;
+};
+
+struct Elf64Symbol {
+  uint32_t st_name;
+  uint8_t st_info;
+  uint8_t st_other;
+  uint16_t st_shndx;
+  uint64_t st_value;
+  uint64_t st_size;
+};
+
+/**
+ * @brief A PT_LOAD segment, with its file-backed bytes viewed straight out of the mapping.
+ */
+struct ElfSegment {
+  uint64_t vaddr; ///< Virtual address the segment is loaded at.
+  uint64_t mem_size; ///< Size in memory; bytes past file_bytes are zero-filled (.bss).
+  std::span<const uint8_t> file_bytes; ///< Initialised contents, pointing into the mapped file.
+  bool executable; ///< True if the segment carries PF_X.
+};
+
+/**
+ * @brief A named entry of the .symtab section.
+ */
+struct ElfSymbol {
+  std::string name; ///< Symbol name from the linked string table.
+  uint64_t address; ///< Symbol value (virtual address).
+  uint64_t size; ///< Symbol size in bytes.
+  bool is_function; ///< True for STT_FUNC and untyped text labels.
+};
+
+/**
+ * @brief Read-only view of an ELF64 RISC-V executable mapped into the host address space.
+ *
+ * The file is mmap'ed once; segment contents are handed out as spans into the mapping
+ * so the VM can copy them into memory pages wholesale.
+ */
+class ElfFile {
+ public:
+  /**
+   * @brief Maps and validates the given file.
+   * @param filename Path to the ELF file.
+   * @throws std::runtime_error If the file cannot be mapped or is not an ELF64 RISC-V executable.
+   */
+  explicit ElfFile(const std::string &filename);
+  ~ElfFile();
+
+  ElfFile(const ElfFile &) = delete;
+  ElfFile &operator=(const ElfFile &) = delete;
+
+  [[nodiscard]] uint64_t getEntry() const { return entry_; }
+  [[nodiscard]] const std::vector<ElfSegment> &getSegments() const { return segments_; }
+  [[nodiscard]] const std::vector<ElfSymbol> &getSymbols() const { return symbols_; }
+
+ private:
+  const uint8_t *mapping_ = nullptr; ///< Start of the mmap'ed file.
+  size_t size_ = 0; ///< Size of the mapping in bytes.
+  uint64_t entry_ = 0; ///< e_entry of the executable.
+  std::vector<ElfSegment> segments_;
+  std::vector<ElfSymbol> symbols_;
+
+  void parseProgramHeaders(const Elf64Header &header);
+  void parseSymbolTable(const Elf64Header &header);
+
+  template<typename T>
+  const T *at(uint64_t offset, uint64_t count = 1) const;
+};
+
+/**
+ * @brief Checks whether a file starts with the ELF magic number.
+ * @param filename Path to the file.
+ * @return True if the file is an ELF image.
+ */
+bool isElfFile(const std::string &filename);
+
+#endif // ELF_UTIL_H
@@ -148,6 +148,40 @@ class Parser {
   bool parse_O_GPR_C_FPR_C_FPR();
   bool parse_O_FPR_C_I_LP_GPR_RP();
 
+  bool parse_O_GPR_C_LP_GPR_RP();
+  bool parse_O_GPR_C_GPR_C_LP_GPR_RP();
+
+  /**
+   * @brief Matches the operands of a vector instruction and emits it.
+   *
+   * operands lists the expected operands in order: 'v' vector register, 'x' general register,
+   * 'f' floating-point register, 'i' immediate, '0' the literal v0, 'm' (general register) and
+   * 't' a vtype list. fields names where each one goes: 'd' rd, '1' rs1, '2' rs2, 'i' imm,
+   * 't' vtype, '-' nowhere. A trailing v0.t is accepted when the opcode is maskable.
+   */
+  bool parseVectorOperands(const std::string &operands, const std::string &fields);
+  bool parse_O_GPR_C_GPR_C_VTYPE();
+  bool parse_O_GPR_C_I_C_VTYPE();
+  bool parse_O_VR_C_VR_C_VR();
+  bool parse_O_VR_C_VR_C_GPR();
+  bool parse_O_VR_C_VR_C_I();
+  bool parse_O_VR_C_VR_C_FPR();
+  bool parse_O_VR_C_GPR_C_VR();
+  bool parse_O_VR_C_FPR_C_VR();
+  bool parse_O_VR_C_VR_C_VR_C_V0();
+  bool parse_O_VR_C_VR_C_GPR_C_V0();
+  bool parse_O_VR_C_VR_C_I_C_V0();
+  bool parse_O_VR_C_VR_C_FPR_C_V0();
+  bool parse_O_VR_C_VR();
+  bool parse_O_VR_C_GPR();
+  bool parse_O_VR_C_I();
+  bool parse_O_VR_C_FPR();
+  bool parse_O_GPR_C_VR();
+  bool parse_O_FPR_C_VR();
+  bool parse_O_VR();
+  bool parse_O_VR_C_LP_GPR_RP();
+  bool parse_O_VR_C_LP_GPR_RP_C_GPR();
+
   /**
    * @brief Parses a data directive.
    */
@@ -33,6 +33,8 @@ enum class TokenType {
   RPAREN,          ///< Right parenthesis ')'
   STRING,          ///< String literal
   RM,            ///< Rounding mode
+  VEC_MASK,      ///< Vector mask operand (v0.t)
+  VTYPE,         ///< vsetvli type field (e32, m2, ta, ...)
 };
 
 /**
@@ -0,0 +1,86 @@
+/**
+ * @file batch_runner.h
+ * @brief Runs a directory of programs on a pool of VMs and checks them against golden files.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace batch_runner
+ * @brief Headless batch execution used by `vm --batch <dir>` and the CTest target.
+ *
+ * Every `.s` or ELF file in the directory is run to completion on its own RVSSVM. If a
+ * `<name>.expected` file sits next to it, the final state is compared against it:
+ *
+ *     # comment
+ *     reg a0 50              ; GPR or FPR by name or alias, decimal or 0x-prefixed hex
+ *     mem 0x10000000 2a 00   ; bytes at an address, in hex
+ *     stdout Sum: 42\n       ; escaped text; several lines are concatenated
+ *     exit 0                 ; code passed to the exit syscall
+ *
+ * A `<name>.stdin` file, if present, is preloaded as the program's stdin.
+ */
+namespace batch_runner {
+
+struct MemoryExpectation {
+  uint64_t address;
+  std::vector<uint8_t> bytes;
+};
+
+struct ExpectedResult {
+  std::vector<std::pair<size_t, uint64_t>> gprs;
+  std::vector<std::pair<size_t, uint64_t>> fprs;
+  std::vector<MemoryExpectation> memory;
+  std::optional<std::string> stdout_text;
+  std::optional<uint64_t> exit_code;
+};
+
+struct ProgramResult {
+  std::filesystem::path program;
+  bool passed = false;
+  bool checked = false; ///< Whether an .expected file was compared.
+  std::vector<std::string> failures;
+  uint64_t instructions_retired = 0;
+  double wall_time_ms = 0;
+};
+
+/**
+ * @brief Parses a golden file.
+ * @throws std::runtime_error On a malformed line, naming the file and line number.
+ */
+ExpectedResult ParseExpectedFile(const std::filesystem::path &filename);
+
+/**
+ * @brief Assembles (or loads) and runs a single program, then checks it against its golden file.
+ *
+ * Safe to call from several threads at once: each call uses its own VM with state dumps and
+ * console output disabled.
+ */
+ProgramResult RunProgram(const std::filesystem::path &program);
+
+/**
+ * @brief Runs every program in a directory on a pool of worker threads.
+ * @param directory Directory containing the programs.
+ * @param jobs Number of worker threads; 0 uses the hardware concurrency.
+ * @return One result per program, sorted by path.
+ */
+std::vector<ProgramResult> RunBatch(const std::filesystem::path &directory, unsigned int jobs);
+
+/**
+ * @brief Prints one line per program and a summary.
+ * @return True if every program passed.
+ */
+bool PrintReport(const std::vector<ProgramResult> &results, std::ostream &os);
+
+} // namespace batch_runner
+
+#endif // BATCH_RUNNER_H
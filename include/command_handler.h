@@ -28,9 +28,14 @@ enum class CommandType {
   DUMP_MEMORY,
   PRINT_MEMORY,
   GET_MEMORY_POINT,
+  GET_STATE,
+  SAVE_STATE,
+  RESTORE_STATE,
   DUMP_CACHE,
   ADD_BREAKPOINT,
   REMOVE_BREAKPOINT,
+  ADD_WATCHPOINT,
+  REMOVE_WATCHPOINT,
   VM_STDIN,
   EXIT
 };
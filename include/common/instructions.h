@@ -778,6 +778,30 @@ struct FDSTypeInstructionEncoding {
       : opcode(opcode), funct3(funct3) {}
 };
 
+// V extension instructions=========================================================================
+
+struct VTypeInstructionEncoding { // OP-V arithmetic: funct6 | vm | vs2 | vs1 | funct3 | vd | opcode
+  std::bitset<7> opcode;
+  std::bitset<3> funct3;
+  std::bitset<6> funct6;
+  std::bitset<5> rs1; ///< vs1/rs1 field for instructions that take no operand there.
+  std::bitset<5> rs2; ///< vs2 field for instructions that take no operand there.
+  bool vm; ///< vm bit when the instruction is not masked; vmerge/vfmerge always encode 0.
+
+  VTypeInstructionEncoding(unsigned int opcode, unsigned int funct3, unsigned int funct6, unsigned int rs1,
+                           unsigned int rs2, bool vm)
+      : opcode(opcode), funct3(funct3), funct6(funct6), rs1(rs1), rs2(rs2), vm(vm) {}
+};
+
+struct VMemTypeInstructionEncoding { // nf | mew | mop | vm | rs2 | rs1 | width | vd | opcode
+  std::bitset<7> opcode;
+  std::bitset<3> width;
+  std::bitset<2> mop;
+
+  VMemTypeInstructionEncoding(unsigned int opcode, unsigned int width, unsigned int mop)
+      : opcode(opcode), width(width), mop(mop) {}
+};
+
 /**
  * @brief Enum that represents different syntax types for instructions.
  */
@@ -809,6 +833,32 @@ enum class SyntaxType {
   O_GPR_C_FPR_C_RM,       ///< Opcode general-register , floating-point-register , rounding_mode
   O_GPR_C_FPR_C_FPR,       ///< Opcode general-register , floating-point-register , floating-point-register
   O_FPR_C_I_LP_GPR_RP,    ///< Opcode floating-point-register , immediate , lparen ( general-register ) rparen
+
+  O_GPR_C_LP_GPR_RP,        ///< Opcode general-register , lparen ( general-register ) rparen
+  O_GPR_C_GPR_C_LP_GPR_RP,  ///< Opcode general-register , general-register , lparen ( general-register ) rparen
+
+  // Vector instructions; maskable ones also accept a trailing , v0.t
+  O_GPR_C_GPR_C_VTYPE,      ///< Opcode general-register , general-register , vtype
+  O_GPR_C_I_C_VTYPE,        ///< Opcode general-register , immediate , vtype
+  O_VR_C_VR_C_VR,           ///< Opcode vector-register , vector-register , vector-register
+  O_VR_C_VR_C_GPR,          ///< Opcode vector-register , vector-register , general-register
+  O_VR_C_VR_C_I,            ///< Opcode vector-register , vector-register , immediate
+  O_VR_C_VR_C_FPR,          ///< Opcode vector-register , vector-register , floating-point-register
+  O_VR_C_GPR_C_VR,          ///< Opcode vector-register , general-register , vector-register
+  O_VR_C_FPR_C_VR,          ///< Opcode vector-register , floating-point-register , vector-register
+  O_VR_C_VR_C_VR_C_V0,      ///< Opcode vector-register , vector-register , vector-register , v0
+  O_VR_C_VR_C_GPR_C_V0,     ///< Opcode vector-register , vector-register , general-register , v0
+  O_VR_C_VR_C_I_C_V0,       ///< Opcode vector-register , vector-register , immediate , v0
+  O_VR_C_VR_C_FPR_C_V0,     ///< Opcode vector-register , vector-register , floating-point-register , v0
+  O_VR_C_VR,                ///< Opcode vector-register , vector-register
+  O_VR_C_GPR,               ///< Opcode vector-register , general-register
+  O_VR_C_I,                 ///< Opcode vector-register , immediate
+  O_VR_C_FPR,               ///< Opcode vector-register , floating-point-register
+  O_GPR_C_VR,               ///< Opcode general-register , vector-register
+  O_FPR_C_VR,               ///< Opcode floating-point-register , vector-register
+  O_VR,                     ///< Opcode vector-register
+  O_VR_C_LP_GPR_RP,         ///< Opcode vector-register , lparen ( general-register ) rparen
+  O_VR_C_LP_GPR_RP_C_GPR,   ///< Opcode vector-register , lparen ( general-register ) rparen , general-register
 };
 
 extern std::unordered_map<std::string, RTypeInstructionEncoding> R_type_instruction_encoding_map;
@@ -830,6 +880,9 @@ extern std::unordered_map<std::string, FDR4TypeInstructionEncoding> F_D_R4_type_
 extern std::unordered_map<std::string, FDITypeInstructionEncoding> F_D_I_type_instruction_encoding_map;
 extern std::unordered_map<std::string, FDSTypeInstructionEncoding> F_D_S_type_instruction_encoding_map;
 
+extern std::unordered_map<std::string, VTypeInstructionEncoding> V_type_instruction_encoding_map;
+extern std::unordered_map<std::string, VMemTypeInstructionEncoding> V_mem_type_instruction_encoding_map;
+
 /**
  * @brief A map that associates instruction names with their expected syntax.
  * 
@@ -855,6 +908,8 @@ bool isValidBaseExtensionInstruction(const std::string &instruction);
 
 bool isValidMExtensionInstruction(const std::string &instruction);
 
+bool isValidAExtensionInstruction(const std::string &instruction);
+
 bool isValidCSRRTypeInstruction(const std::string &instruction);
 bool isValidCSRITypeInstruction(const std::string &instruction);
 bool isValidCSRInstruction(const std::string &instruction);
@@ -867,9 +922,25 @@ bool isValidFDR4TypeInstruction(const std::string &instruction);
 bool isValidFDITypeInstruction(const std::string &instruction);
 bool isValidFDSTypeInstruction(const std::string &instruction);
 
+bool isValidVTypeInstruction(const std::string &instruction);
+bool isValidVMemTypeInstruction(const std::string &instruction);
+bool isValidVConfigInstruction(const std::string &instruction);
+bool isValidVExtensionInstruction(const std::string &instruction);
+
+/**
+ * @brief Whether a vector instruction accepts a trailing v0.t mask operand.
+ */
+bool isMaskableVInstruction(const std::string &instruction);
+
 bool isFInstruction(const uint32_t &instruction);
 bool isDInstruction(const uint32_t &instruction);
 
+/**
+ * @brief Whether an encoded instruction belongs to the V extension: OP-V, or LOAD-FP/STORE-FP
+ *        with a vector element width.
+ */
+bool isVInstruction(const uint32_t &instruction);
+
 std::string getExpectedSyntaxes(const std::string &opcode);
 
 } // namespace instruction_set
@@ -0,0 +1,49 @@
+/**
+ * @file lz_codec.h
+ * @brief Contains a small LZ77 block codec for traces and saved VM state.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#ifndef LZ_CODEC_H
+#define LZ_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lz_codec {
+
+/**
+ * @brief Upper bound on raw bytes per compressed byte: a 255-continued length byte is the
+ *        densest encoding. Callers check sizes read from files against it before decompressing.
+ */
+inline constexpr size_t kMaxExpansion = 255;
+
+/**
+ * @brief Compresses a block with byte-aligned LZ77 in the LZ4 sequence layout.
+ *
+ * Each sequence is a token (literal length in the high nibble, match length - 4 in the low
+ * nibble), 255-continued length bytes, the literals, and a 16-bit little-endian offset into
+ * the last 64 KiB. The final sequence carries literals only. Matches are found through a
+ * single-probe hash table, which trades ratio for speed: one pass, no allocation besides
+ * the output.
+ * @param data Bytes to compress.
+ * @param size Number of bytes.
+ * @return The compressed block; the caller has to remember the raw size.
+ */
+std::vector<uint8_t> Compress(const uint8_t *data, size_t size);
+
+/**
+ * @brief Decompresses a block produced by Compress.
+ * @param data Compressed bytes.
+ * @param size Number of compressed bytes.
+ * @param raw_size Size of the original block.
+ * @return The original bytes.
+ * @throws std::runtime_error If the block is corrupt, raw_size exceeds size*kMaxExpansion, or the block
+ *         does not decompress to raw_size bytes.
+ */
+std::vector<uint8_t> Decompress(const uint8_t *data, size_t size, size_t raw_size);
+
+} // namespace lz_codec
+
+#endif // LZ_CODEC_H
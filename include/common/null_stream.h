@@ -0,0 +1,26 @@
+/**
+ * @file null_stream.h
+ * @brief Contains a stream buffer that discards everything written to it.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#ifndef NULL_STREAM_H
+#define NULL_STREAM_H
+
+#include <streambuf>
+
+/**
+ * @brief Stream buffer that discards everything; used to silence the VMs' status messages
+ *        by swapping it into std::cout.
+ */
+class NullBuffer : public std::streambuf {
+ protected:
+  int overflow(int c) override {
+    return c;
+  }
+  std::streamsize xsputn(const char *, std::streamsize count) override {
+    return count;
+  }
+};
+
+#endif // NULL_STREAM_H
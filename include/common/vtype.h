@@ -0,0 +1,88 @@
+/**
+ * File Name: vtype.h
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+#ifndef VTYPE_H
+#define VTYPE_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// vtype layout (RVV 1.0): vlmul[2:0], vsew[5:3], vta[6], vma[7], vill[XLEN-1]
+inline constexpr uint64_t kVtypeVill = 1ULL << 63;
+
+inline const std::unordered_map<std::string, uint32_t> vsewEncoding = {
+    {"e8", 0b000},
+    {"e16", 0b001},
+    {"e32", 0b010},
+    {"e64", 0b011},
+};
+
+inline const std::unordered_map<std::string, uint32_t> vlmulEncoding = {
+    {"m1", 0b000},
+    {"m2", 0b001},
+    {"m4", 0b010},
+    {"m8", 0b011},
+    {"mf8", 0b101},
+    {"mf4", 0b110},
+    {"mf2", 0b111},
+};
+
+inline bool isValidVtypeField(const std::string &field) {
+  return vsewEncoding.count(field) || vlmulEncoding.count(field)
+      || field=="ta" || field=="tu" || field=="ma" || field=="mu";
+}
+
+/**
+ * @brief Encodes the vsetvli operand list "e32, m2, ta, ma" as a vtype immediate.
+ *
+ * The element width comes first and is required; LMUL (m1 by default), the tail policy (tu by
+ * default) and the mask policy (mu by default) follow in that order, each optional.
+ */
+inline uint32_t encodeVtype(const std::vector<std::string> &fields) {
+  if (fields.empty() || !vsewEncoding.count(fields[0])) {
+    throw std::invalid_argument("vtype must start with an element width (e8, e16, e32, e64)");
+  }
+  uint32_t vtype = vsewEncoding.at(fields[0]) << 3;
+  size_t i = 1;
+  if (i < fields.size() && vlmulEncoding.count(fields[i])) {
+    vtype |= vlmulEncoding.at(fields[i++]);
+  }
+  if (i < fields.size() && (fields[i]=="ta" || fields[i]=="tu")) {
+    vtype |= (fields[i++]=="ta") << 6;
+  }
+  if (i < fields.size() && (fields[i]=="ma" || fields[i]=="mu")) {
+    vtype |= (fields[i++]=="ma") << 7;
+  }
+  if (i!=fields.size()) {
+    throw std::invalid_argument("Invalid vtype field: " + fields[i]);
+  }
+  return vtype;
+}
+
+/**
+ * @brief Element width in bits, or 0 if vsew is reserved.
+ */
+inline unsigned int vtypeSew(uint64_t vtype) {
+  unsigned int vsew = (vtype >> 3) & 0b111;
+  return vsew <= 0b011 ? 8u << vsew : 0;
+}
+
+/**
+ * @brief LMUL as a fraction num/den; returns false for the reserved encoding 100.
+ */
+inline bool vtypeLmul(uint64_t vtype, unsigned int &num, unsigned int &den) {
+  unsigned int vlmul = vtype & 0b111;
+  if (vlmul==0b100) {
+    return false;
+  }
+  num = vlmul < 0b100 ? 1u << vlmul : 1;
+  den = vlmul > 0b100 ? 1u << (8 - vlmul) : 1;
+  return true;
+}
+
+#endif // VTYPE_H
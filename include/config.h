@@ -11,8 +11,11 @@
 #include <iostream>
 #include <stdexcept>
 #include <cstdint>
+#include <filesystem>
 #include <fstream>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 /**
  * @namespace vm_config
@@ -24,6 +27,75 @@ enum class VmTypes {
   MULTI_STAGE
 };
 
+enum class HartSyncMode {
+  QUANTUM,     // Harts take turns of hart_quantum instructions, in hart order: deterministic
+  FREE_RUNNING // Every hart runs flat out on its own thread
+};
+
+enum class ExecutionEngine {
+  INTERPRETER,
+  DBT // Hot blocks translated to x86-64; the interpreter runs everything else
+};
+
+enum class BranchPredictorType {
+  NONE,
+  ALWAYS_NOT_TAKEN,
+  BIMODAL,
+  GSHARE,
+  TOURNAMENT
+};
+
+enum class CacheReplacementPolicy {
+  LRU,
+  FIFO,
+  RANDOM
+};
+
+/**
+ * @brief Cycles from issue until an instruction's result can be used, per operation class.
+ *
+ * Read by the timing model; see TimingModel in vm/timing_model.h for which instructions fall
+ * in each class.
+ */
+struct TimingLatencies {
+  uint64_t alu = 1; // Integer ALU, branches, jumps, CSRs
+  uint64_t mul = 3;
+  uint64_t div = 20; // Divides and remainders; not pipelined
+  uint64_t load = 2; // Load-to-use on a cache hit (or with no cache model); atomics too
+  uint64_t fp_add = 4;
+  uint64_t fp_mul = 4;
+  uint64_t fp_fma = 5;
+  uint64_t fp_div = 12; // Not pipelined
+  uint64_t fp_sqrt = 16; // Not pipelined
+  uint64_t fp_misc = 2; // Sign injection, min/max, compares, classify, moves, conversions
+  uint64_t simd = 1; // Packed add/sub/load of the custom SIMD extension
+  uint64_t simd_mul = 3;
+  uint64_t simd_div = 20; // Not pipelined
+  uint64_t ecc = 2;
+  uint64_t quantum = 4;
+  uint64_t fp16 = 3;
+  uint64_t bf16 = 3;
+  uint64_t msfp16 = 2;
+
+  /**
+   * @brief [Timing] config keys and the latencies they set.
+   */
+  static const std::vector<std::pair<std::string, uint64_t TimingLatencies::*>> &Keys() {
+    static const std::vector<std::pair<std::string, uint64_t TimingLatencies::*>> keys = {
+        {"latency_alu", &TimingLatencies::alu},         {"latency_mul", &TimingLatencies::mul},
+        {"latency_div", &TimingLatencies::div},         {"latency_load", &TimingLatencies::load},
+        {"latency_fp_add", &TimingLatencies::fp_add},   {"latency_fp_mul", &TimingLatencies::fp_mul},
+        {"latency_fp_fma", &TimingLatencies::fp_fma},   {"latency_fp_div", &TimingLatencies::fp_div},
+        {"latency_fp_sqrt", &TimingLatencies::fp_sqrt}, {"latency_fp_misc", &TimingLatencies::fp_misc},
+        {"latency_simd", &TimingLatencies::simd},       {"latency_simd_mul", &TimingLatencies::simd_mul},
+        {"latency_simd_div", &TimingLatencies::simd_div}, {"latency_ecc", &TimingLatencies::ecc},
+        {"latency_quantum", &TimingLatencies::quantum}, {"latency_fp16", &TimingLatencies::fp16},
+        {"latency_bf16", &TimingLatencies::bf16},       {"latency_msfp16", &TimingLatencies::msfp16},
+    };
+    return keys;
+  }
+};
+
 struct VmConfig {
   VmTypes vm_type = VmTypes::SINGLE_STAGE;
   uint64_t run_step_delay = 300;
@@ -32,8 +104,52 @@ struct VmConfig {
   uint64_t data_section_start = 0x10000000; // Default start address for data section
   uint64_t text_section_start = 0x0; // Default start address for text section
   uint64_t bss_section_start = 0x11000000; // Default start address for BSS section
+  uint64_t stack_top = 0x7ffffff0; // Initial stack pointer for loaded ELF executables
+  bool mmio_enabled = true; // Map the UART, CLINT timer, DMA and matrix engines at mmio_base
+  uint64_t mmio_base = 0x40000000; // UART at +0x0, CLINT at +0x10000, DMA at +0x20000, matrix at +0x30000
+  uint64_t dma_bytes_per_cycle = 8; // DMA copy bandwidth
+  uint64_t matrix_macs_per_cycle = 256; // Matrix engine throughput (a 16x16 array)
+  uint64_t matrix_bytes_per_cycle = 32; // Matrix engine memory bandwidth
 
   uint64_t instruction_execution_limit = 100000000;
+  uint64_t random_seed = 0; // Seed for the ALU's random operations, 0 to seed from the host
+  bool profiling_enabled = false; // Count instructions per PC and call stack, report at program end
+  uint64_t profile_top_lines = 20; // Hot lines listed in the profile report
+  std::string trace_file; // Binary execution trace written while running, empty for none
+  uint64_t hart_count = 1; // Harts sharing memory, one host thread each, for --run
+  HartSyncMode hart_sync_mode = HartSyncMode::QUANTUM;
+  uint64_t hart_quantum = 1000; // Instructions per hart between scheduling points
+  uint64_t hart_stack_size = 0x10000; // Hart i starts with sp = stack_top - i*hart_stack_size
+  ExecutionEngine execution_engine = ExecutionEngine::INTERPRETER; // What Run uses; debug runs and steps always interpret
+  uint64_t dbt_hot_threshold = 16; // Times a block is interpreted before it is translated
+  uint64_t publish_interval_instructions = 1000000; // Instructions between state publications while running, 0 for none
+  uint64_t publish_interval_ms = 33; // Milliseconds between state publications while running, 0 for none
+
+  uint64_t vector_length = 128; // VLEN in bits: a power of two from 64 to 512
+  bool vector_host_simd = true; // Run vector ops on AVX2/SSE2 kernels when the host has them
+
+  uint64_t output_buffer_size = 4096; // Buffered guest console bytes before a flush
+  std::string stdin_file; // Preloaded guest stdin, empty for interactive input
+  std::string sandbox_directory; // Host directory for guest openat, empty for vm_state/guest_fs
+
+  BranchPredictorType branch_predictor_type = BranchPredictorType::NONE; // Simulated on every branch and jump
+  uint64_t branch_table_size = 4096; // Entries in each 2-bit counter table, rounded up to a power of two
+  uint64_t branch_history_bits = 12; // Global history length of gshare and tournament
+  uint64_t btb_size = 512; // Branch target buffer entries, rounded up to a power of two
+  uint64_t ras_size = 16; // Return address stack entries
+  uint64_t misprediction_penalty = 2; // Cycles added per mispredicted branch or jump
+
+  bool cache_enabled = false; // Simulate an L1 data cache on every load and store
+  uint64_t cache_size = 32768; // Bytes
+  uint64_t cache_block_size = 64; // Bytes per line, a power of two
+  uint64_t cache_associativity = 8; // Ways per set; cache_size/cache_block_size for fully associative
+  CacheReplacementPolicy cache_replacement_policy = CacheReplacementPolicy::LRU;
+  bool cache_write_back = true; // Write back dirty lines on eviction rather than writing through
+  bool cache_write_allocate = true; // Fill a line on a write miss
+  uint64_t cache_miss_penalty = 20; // Cycles added per miss
+
+  bool timing_enabled = false; // Charge per-class latencies and scoreboard stalls to the cycle count
+  TimingLatencies timing_latencies;
 
   bool m_extension_enabled = true;
   bool f_extension_enabled = true;
@@ -88,6 +204,54 @@ struct VmConfig {
     return bss_section_start;
   }
 
+  void setStackTop(uint64_t top) {
+    stack_top = top;
+  }
+
+  uint64_t getStackTop() const {
+    return stack_top;
+  }
+
+  void setMmioEnabled(bool enabled) {
+    mmio_enabled = enabled;
+  }
+
+  bool getMmioEnabled() const {
+    return mmio_enabled;
+  }
+
+  void setMmioBase(uint64_t base) {
+    mmio_base = base;
+  }
+
+  uint64_t getMmioBase() const {
+    return mmio_base;
+  }
+
+  void setDmaBytesPerCycle(uint64_t bytes) {
+    dma_bytes_per_cycle = bytes;
+  }
+
+  uint64_t getDmaBytesPerCycle() const {
+    return dma_bytes_per_cycle;
+  }
+
+  void setMatrixMacsPerCycle(uint64_t macs) {
+    matrix_macs_per_cycle = macs;
+  }
+
+  uint64_t getMatrixMacsPerCycle() const {
+    return matrix_macs_per_cycle;
+  }
+
+  void setMatrixBytesPerCycle(uint64_t bytes) {
+    matrix_bytes_per_cycle = bytes;
+  }
+
+  uint64_t getMatrixBytesPerCycle() const {
+    return matrix_bytes_per_cycle;
+  }
+
   void setInstructionExecutionLimit(uint64_t limit) {
     instruction_execution_limit = limit;
   }
@@ -96,6 +260,275 @@ struct VmConfig {
     return instruction_execution_limit;
   }
 
+  void setRandomSeed(uint64_t seed) {
+    random_seed = seed;
+  }
+
+  uint64_t getRandomSeed() const {
+    return random_seed;
+  }
+
+  void setProfilingEnabled(bool enabled) {
+    profiling_enabled = enabled;
+  }
+
+  bool getProfilingEnabled() const {
+    return profiling_enabled;
+  }
+
+  void setProfileTopLines(uint64_t lines) {
+    profile_top_lines = lines;
+  }
+
+  uint64_t getProfileTopLines() const {
+    return profile_top_lines;
+  }
+
+  void setTraceFile(const std::string &file) {
+    trace_file = file;
+  }
+
+  const std::string &getTraceFile() const {
+    return trace_file;
+  }
+
+  void setHartCount(uint64_t count) {
+    if (count == 0) {
+      throw std::invalid_argument("hart_count must be at least 1");
+    }
+    hart_count = count;
+  }
+
+  uint64_t getHartCount() const {
+    return hart_count;
+  }
+
+  void setHartSyncMode(HartSyncMode mode) {
+    hart_sync_mode = mode;
+  }
+
+  HartSyncMode getHartSyncMode() const {
+    return hart_sync_mode;
+  }
+
+  void setHartQuantum(uint64_t quantum) {
+    hart_quantum = quantum == 0 ? 1 : quantum;
+  }
+
+  uint64_t getHartQuantum() const {
+    return hart_quantum;
+  }
+
+  void setHartStackSize(uint64_t size) {
+    hart_stack_size = size;
+  }
+
+  uint64_t getHartStackSize() const {
+    return hart_stack_size;
+  }
+
+  void setExecutionEngine(ExecutionEngine engine) {
+    execution_engine = engine;
+  }
+
+  ExecutionEngine getExecutionEngine() const {
+    return execution_engine;
+  }
+
+  void setDbtHotThreshold(uint64_t threshold) {
+    dbt_hot_threshold = threshold == 0 ? 1 : threshold;
+  }
+
+  uint64_t getDbtHotThreshold() const {
+    return dbt_hot_threshold;
+  }
+
+  void setPublishIntervalInstructions(uint64_t instructions) {
+    publish_interval_instructions = instructions;
+  }
+
+  uint64_t getPublishIntervalInstructions() const {
+    return publish_interval_instructions;
+  }
+
+  void setPublishIntervalMs(uint64_t ms) {
+    publish_interval_ms = ms;
+  }
+
+  uint64_t getPublishIntervalMs() const {
+    return publish_interval_ms;
+  }
+
+  void setVectorLength(uint64_t bits) {
+    if (bits < 64 || bits > 512 || (bits & (bits - 1)) != 0) {
+      throw std::invalid_argument("vlen must be a power of two from 64 to 512");
+    }
+    vector_length = bits;
+  }
+
+  uint64_t getVectorLength() const {
+    return vector_length;
+  }
+
+  void setVectorHostSimd(bool enabled) {
+    vector_host_simd = enabled;
+  }
+
+  bool getVectorHostSimd() const {
+    return vector_host_simd;
+  }
+
+  void setOutputBufferSize(uint64_t size) {
+    output_buffer_size = size;
+  }
+
+  uint64_t getOutputBufferSize() const {
+    return output_buffer_size;
+  }
+
+  void setStdinFile(const std::string &filename) {
+    stdin_file = filename;
+  }
+
+  const std::string &getStdinFile() const {
+    return stdin_file;
+  }
+
+  void setSandboxDirectory(const std::string &directory) {
+    sandbox_directory = directory;
+  }
+
+  const std::string &getSandboxDirectory() const {
+    return sandbox_directory;
+  }
+
+  void setBranchPredictorType(BranchPredictorType type) {
+    branch_predictor_type = type;
+  }
+
+  BranchPredictorType getBranchPredictorType() const {
+    return branch_predictor_type;
+  }
+
+  void setBranchTableSize(uint64_t size) {
+    branch_table_size = size;
+  }
+
+  uint64_t getBranchTableSize() const {
+    return branch_table_size;
+  }
+
+  void setBranchHistoryBits(uint64_t bits) {
+    branch_history_bits = bits;
+  }
+
+  uint64_t getBranchHistoryBits() const {
+    return branch_history_bits;
+  }
+
+  void setBtbSize(uint64_t size) {
+    btb_size = size;
+  }
+
+  uint64_t getBtbSize() const {
+    return btb_size;
+  }
+
+  void setRasSize(uint64_t size) {
+    ras_size = size;
+  }
+
+  uint64_t getRasSize() const {
+    return ras_size;
+  }
+
+  void setMispredictionPenalty(uint64_t cycles) {
+    misprediction_penalty = cycles;
+  }
+
+  uint64_t getMispredictionPenalty() const {
+    return misprediction_penalty;
+  }
+
+  void setCacheEnabled(bool enabled) {
+    cache_enabled = enabled;
+  }
+
+  bool getCacheEnabled() const {
+    return cache_enabled;
+  }
+
+  void setCacheSize(uint64_t size) {
+    cache_size = size;
+  }
+
+  uint64_t getCacheSize() const {
+    return cache_size;
+  }
+
+  void setCacheBlockSize(uint64_t size) {
+    cache_block_size = size;
+  }
+
+  uint64_t getCacheBlockSize() const {
+    return cache_block_size;
+  }
+
+  void setCacheAssociativity(uint64_t ways) {
+    cache_associativity = ways;
+  }
+
+  uint64_t getCacheAssociativity() const {
+    return cache_associativity;
+  }
+
+  /**
+   * @brief Checks that the cache size, block size and associativity describe a cache.
+   * @throws std::invalid_argument If the block size is not a power of two or the size is not a
+   *                               non-zero multiple of block_size*associativity.
+   */
+  void validateCacheGeometry() const {
+    if (cache_block_size == 0 || (cache_block_size & (cache_block_size - 1)) != 0) {
+      throw std::invalid_argument("cache_block_size must be a power of two: " + std::to_string(cache_block_size));
+    }
+    if (cache_associativity == 0 || cache_size == 0 || cache_associativity > cache_size/cache_block_size
+        || cache_size % (cache_block_size*cache_associativity) != 0) {
+      throw std::invalid_argument("cache_size must be a non-zero multiple of cache_block_size*cache_associativity");
+    }
+  }
+
+  void setCacheReplacementPolicy(CacheReplacementPolicy policy) {
+    cache_replacement_policy = policy;
+  }
+
+  CacheReplacementPolicy getCacheReplacementPolicy() const {
+    return cache_replacement_policy;
+  }
+
+  void setCacheWriteBack(bool write_back) {
+    cache_write_back = write_back;
+  }
+
+  bool getCacheWriteBack() const {
+    return cache_write_back;
+  }
+
+  void setCacheWriteAllocate(bool write_allocate) {
+    cache_write_allocate = write_allocate;
+  }
+
+  bool getCacheWriteAllocate() const {
+    return cache_write_allocate;
+  }
+
+  void setCacheMissPenalty(uint64_t cycles) {
+    cache_miss_penalty = cycles;
+  }
+
+  uint64_t getCacheMissPenalty() const {
+    return cache_miss_penalty;
+  }
+
   void setMExtensionEnabled(bool enabled) {
     m_extension_enabled = enabled;
   }
@@ -120,6 +553,32 @@ struct VmConfig {
     return d_extension_enabled;
   }
 
+  void setTimingEnabled(bool enabled) {
+    timing_enabled = enabled;
+  }
+
+  bool getTimingEnabled() const {
+    return timing_enabled;
+  }
+
+  void setTimingLatencies(const TimingLatencies &latencies) {
+    timing_latencies = latencies;
+  }
+
+  const TimingLatencies &getTimingLatencies() const {
+    return timing_latencies;
+  }
+
+  /**
+   * @brief Applies every key=value line of an INI file (as written by SetupConfigFile) with modifyConfig.
+   *
+   * ';' and '#' start comments. The [General] section is skipped. A line that cannot be applied
+   * is reported and the rest still load.
+   * @return One "file:line: message" entry per line that was not applied.
+   * @throws std::runtime_error If the file cannot be opened.
+   */
+  std::vector<std::string> loadConfigFile(const std::filesystem::path &filename);
+
   void modifyConfig(const std::string &section, const std::string &key, const std::string &value) {
     if (section == "Execution") {
       if (key == "processor_type") {
@@ -134,6 +593,48 @@ struct VmConfig {
         setRunStepDelay(std::stoull(value));
       } else if (key == "instruction_execution_limit") {
         setInstructionExecutionLimit(std::stoull(value));
+      } else if (key == "random_seed") {
+        setRandomSeed(std::stoull(value));
+      } else if (key == "profiling_enabled") {
+        if (value == "true") {
+          setProfilingEnabled(true);
+        } else if (value == "false") {
+          setProfilingEnabled(false);
+        } else {
+          throw std::invalid_argument("Unknown value: " + value);
+        }
+      } else if (key == "profile_top_lines") {
+        setProfileTopLines(std::stoull(value));
+      } else if (key == "trace_file") {
+        setTraceFile(value == "none" ? "" : value);
+      } else if (key == "hart_count") {
+        setHartCount(std::stoull(value));
+      } else if (key == "hart_sync") {
+        if (value == "quantum") {
+          setHartSyncMode(HartSyncMode::QUANTUM);
+        } else if (value == "free_running") {
+          setHartSyncMode(HartSyncMode::FREE_RUNNING);
+        } else {
+          throw std::invalid_argument("Unknown hart sync mode: " + value);
+        }
+      } else if (key == "hart_quantum") {
+        setHartQuantum(std::stoull(value));
+      } else if (key == "hart_stack_size") {
+        setHartStackSize(std::stoull(value, nullptr, 16));
+      } else if (key == "execution_engine") {
+        if (value == "interpreter") {
+          setExecutionEngine(ExecutionEngine::INTERPRETER);
+        } else if (value == "dbt") {
+          setExecutionEngine(ExecutionEngine::DBT);
+        } else {
+          throw std::invalid_argument("Unknown execution engine: " + value);
+        }
+      } else if (key == "dbt_hot_threshold") {
+        setDbtHotThreshold(std::stoull(value));
+      } else if (key == "publish_interval_instructions") {
+        setPublishIntervalInstructions(std::stoull(value));
+      } else if (key == "publish_interval_ms") {
+        setPublishIntervalMs(std::stoull(value));
       }
       
       else {
@@ -141,7 +642,7 @@ struct VmConfig {
       }
     } else if (section == "Memory") {
       if (key == "memory_size") {
-        setMemorySize(std::stoull(value));
+        setMemorySize(std::stoull(value, nullptr, 0));
       } else if (key == "memory_block_size") {
         setMemoryBlockSize(std::stoull(value));
       } else if (key == "data_section_start") {
@@ -150,6 +651,24 @@ struct VmConfig {
         setTextSectionStart(std::stoull(value, nullptr, 16));
       } else if (key == "bss_section_start") {
         setBssSectionStart(std::stoull(value, nullptr, 16));
+      } else if (key == "stack_top") {
+        setStackTop(std::stoull(value, nullptr, 16));
+      } else if (key == "mmio_enabled") {
+        if (value == "true") {
+          setMmioEnabled(true);
+        } else if (value == "false") {
+          setMmioEnabled(false);
+        } else {
+          throw std::invalid_argument("Unknown value: " + value);
+        }
+      } else if (key == "mmio_base") {
+        setMmioBase(std::stoull(value, nullptr, 16));
+      } else if (key == "dma_bytes_per_cycle") {
+        setDmaBytesPerCycle(std::stoull(value));
+      } else if (key == "matrix_macs_per_cycle") {
+        setMatrixMacsPerCycle(std::stoull(value));
+      } else if (key == "matrix_bytes_per_cycle") {
+        setMatrixBytesPerCycle(std::stoull(value));
       }
       
       
@@ -159,6 +678,155 @@ struct VmConfig {
       }
     } 
 
+    else if (section == "Syscall") {
+      if (key == "output_buffer_size") {
+        setOutputBufferSize(std::stoull(value));
+      } else if (key == "stdin_file") {
+        setStdinFile(value);
+      } else if (key == "sandbox_directory") {
+        setSandboxDirectory(value);
+      } else {
+        throw std::invalid_argument("Unknown key: " + key);
+      }
+    }
+
+    else if (section == "BranchPrediction") {
+      if (key == "branch_prediction_type") {
+        if (value == "none") {
+          setBranchPredictorType(BranchPredictorType::NONE);
+        } else if (value == "always_not_taken") {
+          setBranchPredictorType(BranchPredictorType::ALWAYS_NOT_TAKEN);
+        } else if (value == "bimodal") {
+          setBranchPredictorType(BranchPredictorType::BIMODAL);
+        } else if (value == "gshare") {
+          setBranchPredictorType(BranchPredictorType::GSHARE);
+        } else if (value == "tournament") {
+          setBranchPredictorType(BranchPredictorType::TOURNAMENT);
+        } else {
+          throw std::invalid_argument("Unknown branch predictor: " + value);
+        }
+      } else if (key == "branch_prediction_table_size") {
+        setBranchTableSize(std::stoull(value));
+      } else if (key == "branch_history_bits") {
+        uint64_t bits = std::stoull(value);
+        if (bits > 32) {
+          throw std::invalid_argument("branch_history_bits must be at most 32");
+        }
+        setBranchHistoryBits(bits);
+      } else if (key == "btb_size") {
+        setBtbSize(std::stoull(value));
+      } else if (key == "ras_size") {
+        setRasSize(std::stoull(value));
+      } else if (key == "misprediction_penalty") {
+        setMispredictionPenalty(std::stoull(value));
+      } else {
+        throw std::invalid_argument("Unknown key: " + key);
+      }
+    }
+
+    else if (section == "Cache") {
+      // An enabled cache keeps a valid geometry, so the next load cannot fail on it; disable the
+      // cache to change the geometry through invalid intermediate values.
+      const uint64_t old_size = cache_size, old_block_size = cache_block_size, old_associativity = cache_associativity;
+      const bool old_enabled = cache_enabled;
+      if (key == "cache_enabled") {
+        if (value == "true") {
+          setCacheEnabled(true);
+        } else if (value == "false") {
+          setCacheEnabled(false);
+        } else {
+          throw std::invalid_argument("Unknown value: " + value);
+        }
+      } else if (key == "cache_size") {
+        setCacheSize(std::stoull(value));
+      } else if (key == "cache_block_size") {
+        setCacheBlockSize(std::stoull(value));
+      } else if (key == "cache_associativity") {
+        setCacheAssociativity(std::stoull(value));
+      } else if (key == "cache_replacement_policy") {
+        if (value == "LRU") {
+          setCacheReplacementPolicy(CacheReplacementPolicy::LRU);
+        } else if (value == "FIFO") {
+          setCacheReplacementPolicy(CacheReplacementPolicy::FIFO);
+        } else if (value == "random") {
+          setCacheReplacementPolicy(CacheReplacementPolicy::RANDOM);
+        } else {
+          throw std::invalid_argument("Unknown replacement policy: " + value);
+        }
+      } else if (key == "cache_write_hit_policy") {
+        if (value == "write_back") {
+          setCacheWriteBack(true);
+        } else if (value == "write_through") {
+          setCacheWriteBack(false);
+        } else {
+          throw std::invalid_argument("Unknown write hit policy: " + value);
+        }
+      } else if (key == "cache_write_miss_policy") {
+        if (value == "write_allocate") {
+          setCacheWriteAllocate(true);
+        } else if (value == "no_write_allocate") {
+          setCacheWriteAllocate(false);
+        } else {
+          throw std::invalid_argument("Unknown write miss policy: " + value);
+        }
+      } else if (key == "cache_read_miss_policy") {
+        if (value != "read_allocate") {
+          throw std::invalid_argument("Only read_allocate is supported: " + value);
+        }
+      } else if (key == "cache_miss_penalty") {
+        setCacheMissPenalty(std::stoull(value));
+      } else {
+        throw std::invalid_argument("Unknown key: " + key);
+      }
+      if (cache_enabled) {
+        try {
+          validateCacheGeometry();
+        } catch (const std::invalid_argument &) {
+          cache_size = old_size;
+          cache_block_size = old_block_size;
+          cache_associativity = old_associativity;
+          cache_enabled = old_enabled;
+          throw;
+        }
+      }
+    }
+
+    else if (section == "Timing") {
+      if (key == "timing_enabled") {
+        if (value == "true") {
+          setTimingEnabled(true);
+        } else if (value == "false") {
+          setTimingEnabled(false);
+        } else {
+          throw std::invalid_argument("Unknown value: " + value);
+        }
+        return;
+      }
+      for (const auto &[name, latency] : TimingLatencies::Keys()) {
+        if (key == name) {
+          timing_latencies.*latency = std::stoull(value);
+          return;
+        }
+      }
+      throw std::invalid_argument("Unknown key: " + key);
+    }
+
+    else if (section == "Vector") {
+      if (key == "vlen") {
+        setVectorLength(std::stoull(value));
+      } else if (key == "host_simd") {
+        if (value == "true") {
+          setVectorHostSimd(true);
+        } else if (value == "false") {
+          setVectorHostSimd(false);
+        } else {
+          throw std::invalid_argument("Unknown value: " + value);
+        }
+      } else {
+        throw std::invalid_argument("Unknown key: " + key);
+      }
+    }
+
     else if (section == "Assembler") {
       if (key == "m_extension_enabled") {
         if (value == "true") {
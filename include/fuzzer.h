@@ -0,0 +1,135 @@
+/**
+ * @file fuzzer.h
+ * @brief Coverage-guided fuzzing of a guest program's stdin.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef FUZZER_H
+#define FUZZER_H
+
+#include "vm/edge_coverage.h"
+#include "vm/rvss/rvss_vm.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @namespace fuzzer
+ * @brief Headless fuzzing used by `vm --fuzz <program> <corpus_dir>`.
+ *
+ * The program is loaded once per worker and snapshotted at its entry point; each input runs on
+ * a copy-on-write fork of that snapshot with the input as its stdin (SYSCALL_READ on fd 0).
+ * Inputs that reach a new edge, or a known edge a new number of times, join the corpus and are
+ * written to corpus_dir. Runs that throw (an out-of-range access, a misaligned atomic, ...) are
+ * saved to corpus_dir/crashes, one per faulting pc and error; runs that hit the instruction
+ * limit are saved to corpus_dir/timeouts when they took a path no earlier timeout took.
+ */
+namespace fuzzer {
+
+struct FuzzOptions {
+  unsigned int jobs = 1; ///< Worker threads; 0 uses the hardware concurrency.
+  uint64_t max_runs = 0; ///< Stop after this many executions; 0 for no limit.
+  double max_seconds = 0; ///< Stop after this long; 0 for no limit.
+  uint64_t instruction_limit = 1000000; ///< Per input; a run that reaches it is a timeout.
+  size_t max_input_size = 4096;
+  uint64_t seed = 1; ///< Worker i seeds its mutator with seed + i.
+};
+
+enum class Outcome {
+  kOk,      ///< Ended or exited, whatever the exit code.
+  kCrash,   ///< An exception escaped the VM.
+  kTimeout, ///< Reached FuzzOptions::instruction_limit.
+};
+
+struct RunResult {
+  Outcome outcome = Outcome::kOk;
+  uint64_t pc = 0; ///< Of the faulting instruction for crashes, of the next one for timeouts.
+  std::string message;
+  uint64_t instructions = 0;
+};
+
+struct FuzzStats {
+  uint64_t runs = 0;
+  uint64_t corpus_size = 0;
+  uint64_t edges = 0; ///< Distinct map entries hit by any run.
+  uint64_t crashes = 0; ///< Unique crashes saved.
+  uint64_t timeouts = 0; ///< Unique timeouts saved.
+  double seconds = 0;
+};
+
+/**
+ * @brief Runs inputs on forks of one program snapshot and records their edge coverage.
+ */
+class Executor {
+ public:
+  /**
+   * @param program Assembly or ELF file, loaded once and snapshotted at its entry point.
+   * @param context Configuration of the VM; state dumps, tracing, profiling and the stdin file
+   *                are turned off.
+   * @throws std::runtime_error If the program does not assemble or load.
+   */
+  Executor(const std::filesystem::path &program, VmContext context, uint64_t instruction_limit);
+
+  RunResult Run(std::string_view input);
+
+  /**
+   * @brief Edges taken by the last Run.
+   */
+  [[nodiscard]] const EdgeCoverage &GetCoverage() const {
+    return coverage_;
+  }
+
+  /**
+   * @brief The VM the last Run executed on, as it ended.
+   */
+  [[nodiscard]] RVSSVM &GetVm() {
+    return vm_;
+  }
+
+ private:
+  RVSSVM vm_;
+  VmSnapshot snapshot_;
+  EdgeCoverage coverage_;
+  uint64_t instruction_limit_;
+};
+
+/**
+ * @brief Havoc-style input mutator: stacks random bit flips, byte edits, block deletions,
+ *        duplications and crossovers, and insertions of boundary integers written as text,
+ *        since student programs mostly parse their input.
+ */
+class Mutator {
+ public:
+  explicit Mutator(uint64_t seed) : rng_(seed) {}
+
+  /**
+   * @param splice Another corpus entry to cross over with; may be empty.
+   * @return The mutated input, at most max_size bytes.
+   */
+  std::string Mutate(const std::string &input, const std::string &splice, size_t max_size);
+
+  uint64_t Random(uint64_t bound) {
+    return std::uniform_int_distribution<uint64_t>(0, bound - 1)(rng_);
+  }
+
+ private:
+  std::mt19937_64 rng_;
+};
+
+/**
+ * @brief Fuzzes a program until the run or time limit, printing progress to log.
+ * @param program Assembly or ELF file.
+ * @param corpus_dir Seeds are the regular files in it (an empty input when there are none);
+ *                   created if missing.
+ * @throws std::runtime_error If the program does not assemble or load.
+ */
+FuzzStats Fuzz(const std::filesystem::path &program, const std::filesystem::path &corpus_dir,
+               const FuzzOptions &options, std::ostream &log);
+
+} // namespace fuzzer
+
+#endif // FUZZER_H
@@ -0,0 +1,101 @@
+/**
+ * @file json.h
+ * @brief Contains a small JSON value type with a parser and a serialiser, for line-based requests.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef JSON_H
+#define JSON_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace json
+ * @brief Reads and writes the JSON messages of `vm --serve`.
+ *
+ * Numbers keep their source text, so 64-bit integers survive the round trip that a double would
+ * round; AsUint64 and AsDouble convert on demand. Objects keep their members in source order.
+ */
+namespace json {
+
+struct Value {
+  enum class Type {
+    kNull,
+    kBool,
+    kNumber,
+    kString,
+    kArray,
+    kObject,
+  };
+
+  Type type = Type::kNull;
+  bool boolean = false;
+  std::string text; ///< The string, or the number as written.
+  std::vector<Value> array;
+  std::vector<std::pair<std::string, Value>> object;
+
+  static Value String(std::string text);
+  static Value Number(uint64_t number);
+  static Value Number(double number);
+  static Value Bool(bool boolean);
+  static Value Array();
+  static Value Object();
+
+  [[nodiscard]] bool IsNull() const {
+    return type == Type::kNull;
+  }
+
+  /**
+   * @return The member named key, or nullptr if this is not an object or has no such member.
+   */
+  [[nodiscard]] const Value *Find(std::string_view key) const;
+
+  /**
+   * @brief Appends a member to an object, without checking for duplicates.
+   */
+  Value &Set(std::string key, Value value);
+
+  /**
+   * @throws std::runtime_error If this is not a string.
+   */
+  [[nodiscard]] const std::string &AsString() const;
+
+  /**
+   * @brief Reads a non-negative integer, or a string holding one in decimal or 0x hex.
+   * @throws std::runtime_error If this is neither, or the value does not fit in 64 bits.
+   */
+  [[nodiscard]] uint64_t AsUint64() const;
+
+  /**
+   * @throws std::runtime_error If this is not a number.
+   */
+  [[nodiscard]] double AsDouble() const;
+
+  /**
+   * @throws std::runtime_error If this is not a bool.
+   */
+  [[nodiscard]] bool AsBool() const;
+};
+
+/**
+ * @brief Parses one JSON document; whitespace may surround it.
+ * @throws std::runtime_error On a syntax error, giving its byte offset.
+ */
+Value Parse(std::string_view text);
+
+/**
+ * @brief Writes a value on one line, with no whitespace between tokens.
+ */
+std::string Serialize(const Value &value);
+
+/**
+ * @brief Writes text as a JSON string literal, quotes included.
+ */
+std::string Quote(std::string_view text);
+
+} // namespace json
+
+#endif // JSON_H
@@ -0,0 +1,198 @@
+/**
+ * @file sim_server.h
+ * @brief Persistent simulation server: runs JSON job requests from a Unix socket on a pool of warm VMs.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef SIM_SERVER_H
+#define SIM_SERVER_H
+
+#include "json.h"
+#include "vm/vm_context.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @namespace sim_server
+ * @brief The daemon behind `vm --serve <socket>`.
+ *
+ * Clients connect to a Unix domain socket and write one JSON job per line:
+ *
+ *     {"id": 7, "source": ".text\n addi a0, x0, 5\n", "stdin": "", "max_instructions": 100000,
+ *      "config": {"Execution": {"random_seed": 3}}, "registers": true, "memory": [["0x10000000", 16]]}
+ *
+ * `program` (a path to an assembly or ELF file) may replace `source`. Every other member is
+ * optional. The server answers each job with one JSON line as soon as it finishes, so the
+ * answers to the jobs of one connection can come back in any order; `id` is echoed to match
+ * them up. A client may keep writing jobs while answers arrive, and may shut down its writing
+ * side once done: the connection stays open until every answer has been written.
+ *
+ * Jobs run on a fixed pool of worker threads, each keeping one VM between jobs. A job resets
+ * that VM instead of building a new one, so its memory table, register file and the
+ * assembler's tables stay warm, and nothing is written to vm_state.
+ */
+namespace sim_server {
+
+struct JobRequest {
+  json::Value id; ///< Echoed in the answer; null when the request had none.
+  std::filesystem::path program;
+  std::string source; ///< Inline assembly, used when program is empty.
+  std::vector<std::array<std::string, 3>> config_overrides; ///< Section, key and value, as for modify_config.
+  std::string stdin_text;
+  std::optional<uint64_t> max_instructions; ///< Defaults to Execution/instruction_execution_limit.
+  bool include_registers = false;
+  std::vector<std::pair<uint64_t, uint64_t>> memory_reads; ///< Address and length of each region to return.
+};
+
+enum class JobStatus {
+  kEnded,   ///< Ran off the end of the program.
+  kExited,  ///< Made an exit syscall.
+  kTimeout, ///< Reached its instruction limit.
+  kError,   ///< Did not assemble or load, had a bad request, or raised an error while running.
+};
+
+struct JobResult {
+  json::Value id;
+  JobStatus status = JobStatus::kEnded;
+  uint64_t exit_code = 0;
+  uint64_t instructions = 0;
+  uint64_t cycles = 0;
+  uint64_t pc = 0; ///< Of the faulting instruction for errors raised while running, else of the next one.
+  std::string stdout_text;
+  std::string stderr_text;
+  std::string error;
+  double wall_time_ms = 0;
+  std::optional<std::array<uint64_t, 32>> gprs; ///< Only when the request asked for registers.
+  std::optional<std::array<uint64_t, 32>> fprs;
+  std::vector<std::pair<uint64_t, std::vector<uint8_t>>> memory;
+};
+
+/**
+ * @brief Reads one request line.
+ * @throws std::runtime_error On malformed JSON, an unknown member, or neither or both of
+ *                            program and source.
+ */
+JobRequest ParseJobRequest(std::string_view line);
+
+/**
+ * @brief Writes an answer as one line of JSON, without the newline.
+ */
+std::string FormatJobResult(const JobResult &result);
+
+const char *StatusName(JobStatus status);
+
+/**
+ * @brief Worker threads, each with a warm VM, running jobs from a shared queue.
+ */
+class VmPool {
+ public:
+  /**
+   * @param base_context Configuration every job starts from; its overrides apply on top.
+   * @param workers Threads and VMs; 0 uses the hardware concurrency.
+   * @param scratch_directory Where inline sources are written for the assembler, one file per worker.
+   */
+  VmPool(VmContext base_context, unsigned int workers, std::filesystem::path scratch_directory);
+
+  /**
+   * @brief Stops the workers after their current jobs; queued jobs are dropped.
+   */
+  ~VmPool();
+
+  VmPool(const VmPool &) = delete;
+  VmPool &operator=(const VmPool &) = delete;
+
+  /**
+   * @brief Queues a job. done is called on a worker thread with its result.
+   */
+  void Submit(JobRequest request, std::function<void(JobResult)> done);
+
+  [[nodiscard]] unsigned int GetWorkerCount() const {
+    return static_cast<unsigned int>(workers_.size());
+  }
+
+ private:
+  struct Job {
+    JobRequest request;
+    std::function<void(JobResult)> done;
+  };
+
+  void WorkerLoop(unsigned int index);
+
+  VmContext base_context_;
+  std::filesystem::path scratch_directory_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Job> queue_;
+  std::atomic<bool> stopping_ = false; ///< Also read by running jobs, which give up between slices.
+  std::vector<std::thread> workers_;
+};
+
+/**
+ * @brief Accepts connections on a Unix domain socket and feeds their jobs to a VmPool.
+ */
+class Server {
+ public:
+  /**
+   * @param socket_path Replaced if a stale socket file is there.
+   * @throws std::runtime_error If the socket cannot be created, bound or listened on.
+   */
+  Server(const std::filesystem::path &socket_path, VmContext base_context, unsigned int workers);
+
+  /**
+   * @brief Stops serving and removes the socket file.
+   */
+  ~Server();
+
+  Server(const Server &) = delete;
+  Server &operator=(const Server &) = delete;
+
+  /**
+   * @brief Accepts and serves connections until Stop is called.
+   */
+  void Serve();
+
+  /**
+   * @brief Makes Serve return and closes every connection. Safe from any thread or a signal handler.
+   */
+  void Stop();
+
+  [[nodiscard]] unsigned int GetWorkerCount() const {
+    return pool_->GetWorkerCount();
+  }
+
+  [[nodiscard]] uint64_t GetJobsCompleted() const {
+    return jobs_completed_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Connection;
+
+  void ReadConnection(std::shared_ptr<Connection> connection);
+
+  std::filesystem::path socket_path_;
+  std::filesystem::path scratch_directory_;
+  int listen_fd_ = -1;
+  int wake_fds_[2] = {-1, -1}; ///< A pipe; Stop writes to it to interrupt Serve.
+  std::atomic<bool> stopping_ = false;
+  std::atomic<uint64_t> jobs_completed_ = 0;
+  std::mutex connections_mutex_;
+  std::vector<std::weak_ptr<Connection>> connections_;
+  /// One thread per connection, with a flag it sets on exit so Serve can join it.
+  std::vector<std::pair<std::thread, std::shared_ptr<std::atomic<bool>>>> readers_;
+  std::unique_ptr<VmPool> pool_; ///< Destroyed first, so no job outlives the server.
+};
+
+} // namespace sim_server
+
+#endif // SIM_SERVER_H
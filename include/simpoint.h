@@ -0,0 +1,133 @@
+/**
+ * @file simpoint.h
+ * @brief SimPoint-style sampled simulation: basic-block vectors, clustering and detailed runs of
+ *        representative intervals.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef SIMPOINT_H
+#define SIMPOINT_H
+
+#include "vm/rvss/rvss_vm.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+/**
+ * @namespace simpoint
+ * @brief Sampled simulation used by `vm --simpoint <program>`.
+ *
+ * A functional run splits execution into fixed-size intervals and records, for each, how many
+ * instructions every basic block executed. The normalised vectors are randomly projected to a
+ * few dimensions and clustered with k-means, k chosen by the BIC; the interval closest to each
+ * centroid represents its cluster, weighted by the cluster's share of the instructions. A
+ * second functional run snapshots the VM warmup instructions before each representative, and
+ * worker threads fork those snapshots and run the warm-up and the interval in detailed mode,
+ * with the cache and branch predictor models on. Per-interval results are combined by weight.
+ */
+namespace simpoint {
+
+struct SimPointOptions {
+  uint64_t interval_size = 1000000; ///< Instructions per interval.
+  unsigned int max_k = 10; ///< Most clusters tried.
+  uint64_t warmup = 100000; ///< Detailed instructions run before each interval and not measured.
+  unsigned int jobs = 0; ///< Worker threads for the detailed runs; 0 uses the hardware concurrency.
+  uint64_t seed = 1; ///< Seeds the projection and k-means.
+  uint64_t max_instructions = 0; ///< Only the first this many instructions are sampled; 0 for no limit.
+  bool compare = false; ///< Also run the whole program in detailed mode and report the error.
+};
+
+/**
+ * @brief Per-interval basic-block vectors.
+ *
+ * A basic block starts at the program's entry and after every taken branch or jump, and ends at
+ * the next one, so blocks are dynamic: code jumped into the middle of starts a block of its own.
+ */
+struct BasicBlockVectors {
+  std::vector<uint64_t> block_starts; ///< Address of each block, indexed by block id.
+  std::vector<std::vector<std::pair<uint32_t, uint64_t>>> intervals; ///< Sorted (block id, instructions) pairs.
+  std::vector<uint64_t> interval_instructions; ///< All full but possibly the last.
+  uint64_t total_instructions = 0;
+};
+
+/**
+ * @brief Runs vm, already loaded, to the end (or max_instructions) and records its BBVs.
+ * @param max_instructions 0 for no limit.
+ */
+BasicBlockVectors CollectBasicBlockVectors(RVSSVM &vm, uint64_t interval_size, uint64_t max_instructions);
+
+struct Clustering {
+  unsigned int k = 0;
+  std::vector<unsigned int> assignment; ///< Cluster of each interval.
+  std::vector<size_t> representatives; ///< Interval closest to each cluster's centroid.
+  std::vector<double> weights; ///< Each cluster's share of the instructions.
+};
+
+/**
+ * @brief Projects the BBVs to a few dimensions and clusters them, choosing k in [1, max_k].
+ *
+ * Each k keeps the best of several k-means++ starts; the smallest k whose BIC reaches 90% of
+ * the way from the worst score to the best is chosen, as SimPoint does. Empty clusters are
+ * dropped, so k may end up smaller than chosen.
+ */
+Clustering ClusterIntervals(const BasicBlockVectors &bbvs, unsigned int max_k, uint64_t seed);
+
+struct IntervalStats {
+  uint64_t instructions = 0;
+  uint64_t cycles = 0;
+  uint64_t cache_accesses = 0;
+  uint64_t cache_misses = 0;
+  uint64_t branches = 0;
+  uint64_t mispredictions = 0;
+
+  [[nodiscard]] double Cpi() const;
+  [[nodiscard]] double CacheMissRate() const;
+  [[nodiscard]] double MispredictionRate() const;
+  [[nodiscard]] double Mpki() const;
+};
+
+struct SimulationPoint {
+  size_t interval = 0;
+  uint64_t start = 0; ///< Instructions executed before the interval.
+  double weight = 0;
+  IntervalStats stats; ///< Of the interval alone, after the warm-up.
+};
+
+struct SimPointReport {
+  uint64_t total_instructions = 0;
+  uint64_t interval_size = 0;
+  size_t intervals = 0;
+  size_t blocks = 0;
+  std::vector<SimulationPoint> points; ///< In program order.
+  double cpi = 0; ///< Weighted over the points, as are the rates below.
+  double cache_miss_rate = 0;
+  double misprediction_rate = 0;
+  double mpki = 0;
+  uint64_t detailed_instructions = 0; ///< Run in detailed mode, warm-ups included.
+  std::optional<IntervalStats> full; ///< The whole program in detailed mode, with compare.
+};
+
+/**
+ * @brief Samples a program: collects BBVs, clusters them and runs the simulation points.
+ * @param program Assembly or ELF file.
+ * @param context Configuration of the detailed runs; its [Cache] geometry and [BranchPrediction]
+ *                settings are used with both models switched on (gshare if no predictor is
+ *                configured). State dumps, tracing and profiling are turned off.
+ * @param log Progress messages.
+ * @throws std::runtime_error If the program does not assemble or load.
+ * @throws std::invalid_argument If interval_size or max_k is 0, or the [Cache] geometry is invalid.
+ */
+SimPointReport Run(const std::filesystem::path &program, VmContext context, const SimPointOptions &options,
+                   std::ostream &log);
+
+/**
+ * @brief Writes the weighted results, the comparison if any, and the per-point table.
+ */
+void WriteReport(std::ostream &os, const SimPointReport &report);
+
+} // namespace simpoint
+
+#endif // SIMPOINT_H
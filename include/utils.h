@@ -53,6 +53,15 @@ void DumpRegisters(const std::filesystem::path &filename, RegisterFile &register
 
 void DumpDisasssembly(const std::filesystem::path &filename, AssembledProgram &program);
 
+/**
+ * @brief Dumps a symbol-annotated listing of a loaded ELF text image.
+ *
+ * @param filename The file to write the listing to.
+ * @param program The loaded program; its instruction_number_disassembly_mapping is filled in.
+ * @param text_start Address of the first word of program.text_buffer.
+ */
+void DumpElfDisassembly(const std::filesystem::path &filename, AssembledProgram &program, uint64_t text_start);
+
 void SetupConfigFile();
 
 uint64_t hamming64_57_encode(uint64_t data);
@@ -6,10 +6,12 @@
 #ifndef ALU_H
 #define ALU_H
 
+#include <array>
 #include <cfenv>
 #include <cmath>
 #include <cstdint>
 #include <ostream>
+#include <random>
 
 // #pragma float_control(precise, on)
 // #pragma STDC FENV_ACCESS ON
@@ -389,6 +391,19 @@ case AluOp::FMADD_FP16: os << "FMADD_FP16"; break;
     }
     return os;
 }
+// Conversions behind the FP16, BF16 and MSFP16 ops, shared with the matrix engine.
+float float16_to_float(uint16_t h);
+uint16_t float_to_float16(float f); ///< Rounds to nearest; overflow gives infinity.
+float bfloat16_to_float(uint16_t b);
+uint16_t float_to_bfloat16(float f); ///< Rounds to nearest-even.
+
+/**
+ * @brief Unpacks an MSFP16 block: four 14-bit sign-magnitude lanes (bits 0..55) sharing the
+ *        8-bit biased exponent in bits 56..63.
+ */
+std::array<float, 4> msfp16_unpack(uint64_t reg);
+uint64_t msfp16_pack(const std::array<float, 4> &vals); ///< Quantises to the largest lane's exponent.
+
 /**
  * @brief The alu class is responsible for performing arithmetic and logic operations.
  */
@@ -399,9 +414,37 @@ public:
     bool negative_ = false; ///< Negative flag.
     bool overflow_ = false; ///< Overflow flag.
 
-    Alu() = default;
+    /**
+     * @brief Constructs an ALU whose random operations are seeded from the host.
+     */
+    Alu() : rng_(std::random_device{}()) {}
+
+    /**
+     * @brief Constructs an ALU whose random operations (kRandom_flip, quantum noise and
+     *        measurement) replay the same sequence for the same seed.
+     */
+    explicit Alu(uint64_t seed) : rng_(seed) {}
     ~Alu() = default;
 
+    void Seed(uint64_t seed) {
+        rng_.seed(seed);
+    }
+
+    /**
+     * @brief Last operands and result of a kAdd_cache/kSub_cache/kMul_cache/kDiv_cache operation.
+     *
+     * Kept per ALU instance so that VMs running on different threads do not share memoized results.
+     */
+    struct OperandCache {
+        enum Slot { kAdd, kSub, kMul, kDiv, kCount };
+
+        int64_t prev_a = 0;
+        int64_t prev_b = 0;
+        int64_t prev_result = 0;
+        bool cache_valid = false;
+    };
+    OperandCache operand_caches_[OperandCache::kCount];
+
     /**
      * @brief Executes the given alu operation.
      * @tparam T Integer type (int32_t, uint32_t, etc.).
@@ -410,7 +453,7 @@ public:
      * @param b Second operand.
      * @return A pair (result, overflow_flag).
      */
-    [[nodiscard]] static std::pair<uint64_t, bool> execute(AluOp op, uint64_t a, uint64_t b) ;
+    [[nodiscard]] std::pair<uint64_t, bool> execute(AluOp op, uint64_t a, uint64_t b) ;
 
     // TODO: check all the floating point operations
 
@@ -420,6 +463,9 @@ public:
 
     void setFlags(bool carry, bool zero, bool negative, bool overflow);
 
+private:
+    std::mt19937_64 rng_; ///< Per-instance generator, so concurrent VMs neither race nor share a sequence.
+
 };
 }
 
@@ -0,0 +1,286 @@
+/**
+ * @file branch_predictor.h
+ * @brief Contains the branch direction predictors, the BTB, the return address stack and the
+ *        BranchPredictor that combines them and keeps misprediction statistics.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef BRANCH_PREDICTOR_H
+#define BRANCH_PREDICTOR_H
+
+#include "../config.h"
+#include "vm_asm_mw.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+enum class BranchKind : uint8_t {
+  kConditional, ///< B-type.
+  kJump,        ///< JAL/JALR that neither links nor returns.
+  kCall,        ///< JAL/JALR writing ra or t0; pushes the return address stack.
+  kReturn,      ///< JALR through ra or t0 that does not link; pops the return address stack.
+};
+
+/**
+ * @brief Classifies a JAL or JALR by the RISC-V return-address-stack hints.
+ */
+BranchKind ClassifyJump(uint32_t instruction);
+
+/**
+ * @brief Interface of the conditional branch direction predictors.
+ *
+ * Tables are flat arrays of 2-bit saturating counters indexed by a hash of the PC, sized
+ * to a power of two so indexing is a mask.
+ */
+class DirectionPredictor {
+ public:
+  virtual ~DirectionPredictor() = default;
+
+  /**
+   * @return Whether the branch at pc is predicted taken.
+   */
+  [[nodiscard]] virtual bool Predict(uint64_t pc) const = 0;
+
+  /**
+   * @brief Trains the predictor with the resolved direction of the branch at pc.
+   */
+  virtual void Update(uint64_t pc, bool taken) = 0;
+
+  [[nodiscard]] virtual const char *Name() const = 0;
+};
+
+class StaticNotTakenPredictor : public DirectionPredictor {
+ public:
+  [[nodiscard]] bool Predict(uint64_t) const override {
+    return false;
+  }
+
+  void Update(uint64_t, bool) override {}
+
+  [[nodiscard]] const char *Name() const override {
+    return "always_not_taken";
+  }
+};
+
+/**
+ * @brief One 2-bit counter per (hashed) branch address.
+ */
+class BimodalPredictor : public DirectionPredictor {
+ public:
+  explicit BimodalPredictor(uint64_t table_size);
+
+  [[nodiscard]] bool Predict(uint64_t pc) const override;
+  void Update(uint64_t pc, bool taken) override;
+
+  [[nodiscard]] const char *Name() const override {
+    return "bimodal";
+  }
+
+ private:
+  std::vector<uint8_t> counters_;
+  uint64_t mask_;
+};
+
+/**
+ * @brief 2-bit counters indexed by the branch address XORed with the global history.
+ */
+class GsharePredictor : public DirectionPredictor {
+ public:
+  GsharePredictor(uint64_t table_size, unsigned int history_bits);
+
+  [[nodiscard]] bool Predict(uint64_t pc) const override;
+  void Update(uint64_t pc, bool taken) override;
+
+  [[nodiscard]] const char *Name() const override {
+    return "gshare";
+  }
+
+ private:
+  std::vector<uint8_t> counters_;
+  uint64_t mask_;
+  uint64_t history_ = 0;
+  uint64_t history_mask_;
+
+  [[nodiscard]] uint64_t Index(uint64_t pc) const;
+};
+
+/**
+ * @brief Bimodal and gshare side by side, with per-branch 2-bit choosers picking between them.
+ */
+class TournamentPredictor : public DirectionPredictor {
+ public:
+  TournamentPredictor(uint64_t table_size, unsigned int history_bits);
+
+  [[nodiscard]] bool Predict(uint64_t pc) const override;
+  void Update(uint64_t pc, bool taken) override;
+
+  [[nodiscard]] const char *Name() const override {
+    return "tournament";
+  }
+
+ private:
+  BimodalPredictor bimodal_;
+  GsharePredictor gshare_;
+  std::vector<uint8_t> choosers_; ///< 0-1 trust bimodal, 2-3 trust gshare.
+  uint64_t mask_;
+};
+
+/**
+ * @brief Direct-mapped branch target buffer; taken branches and jumps record their targets.
+ */
+class BranchTargetBuffer {
+ public:
+  explicit BranchTargetBuffer(uint64_t entries);
+
+  /**
+   * @return Whether the BTB holds the branch at pc and predicts target for it.
+   */
+  [[nodiscard]] bool Predicts(uint64_t pc, uint64_t target) const {
+    const Entry &entry = entries_[Index(pc)];
+    return entry.pc == pc && entry.target == target;
+  }
+
+  void Update(uint64_t pc, uint64_t target) {
+    entries_[Index(pc)] = {pc, target};
+  }
+
+ private:
+  struct Entry {
+    uint64_t pc = UINT64_MAX; ///< The full branch address serves as the tag.
+    uint64_t target = 0;
+  };
+
+  std::vector<Entry> entries_;
+  uint64_t mask_;
+
+  [[nodiscard]] uint64_t Index(uint64_t pc) const {
+    return (pc >> 2) & mask_;
+  }
+};
+
+/**
+ * @brief Circular return address stack; the oldest entry is overwritten when it is full.
+ */
+class ReturnAddressStack {
+ public:
+  explicit ReturnAddressStack(uint64_t entries) : entries_(entries == 0 ? 1 : entries) {}
+
+  void Push(uint64_t address) {
+    top_ = (top_ + 1) % entries_.size();
+    entries_[top_] = address;
+    if (depth_ < entries_.size()) {
+      ++depth_;
+    }
+  }
+
+  /**
+   * @return Whether the stack held an address.
+   */
+  bool Pop(uint64_t &address) {
+    if (depth_ == 0) {
+      return false;
+    }
+    address = entries_[top_];
+    top_ = (top_ + entries_.size() - 1) % entries_.size();
+    --depth_;
+    return true;
+  }
+
+ private:
+  std::vector<uint64_t> entries_;
+  size_t top_ = 0;
+  size_t depth_ = 0;
+};
+
+/**
+ * @brief The front-end model: a direction predictor, a BTB and a return address stack.
+ *
+ * The VM executes every branch exactly, so the model only predicts and scores: a branch is
+ * mispredicted when the predicted next PC differs from the real one. A conditional branch
+ * can miss its direction, or be correctly predicted taken with no (or a stale) BTB target;
+ * jumps and calls need a BTB hit, and returns need the right RAS entry.
+ */
+class BranchPredictor {
+ public:
+  struct Stats {
+    uint64_t conditional = 0;
+    uint64_t taken = 0;
+    uint64_t direction_mispredictions = 0;
+    uint64_t jumps = 0; ///< Jumps and calls.
+    uint64_t returns = 0;
+    uint64_t target_mispredictions = 0; ///< BTB misses on taken branches, jumps and calls.
+    uint64_t return_mispredictions = 0;
+
+    [[nodiscard]] uint64_t Branches() const {
+      return conditional + jumps + returns;
+    }
+
+    [[nodiscard]] uint64_t Mispredictions() const {
+      return direction_mispredictions + target_mispredictions + return_mispredictions;
+    }
+  };
+
+  struct Site {
+    uint64_t pc;
+    uint64_t executed;
+    uint64_t mispredicted;
+  };
+
+  /**
+   * @brief Builds the configured predictor and clears all statistics.
+   * @param text_start Address of the first instruction; per-site counts cover [text_start, text_end).
+   * @param text_end Address one past the last instruction.
+   */
+  void Start(const vm_config::VmConfig &config, uint64_t text_start, uint64_t text_end);
+
+  /**
+   * @brief Disables the model and frees its tables.
+   */
+  void Reset();
+
+  [[nodiscard]] bool IsEnabled() const {
+    return direction_ != nullptr;
+  }
+
+  /**
+   * @brief Predicts a resolved branch, scores the prediction and trains the tables.
+   * @param target The next PC: the target when taken, the fall-through otherwise.
+   * @return Whether the branch was mispredicted.
+   */
+  bool Resolve(uint64_t pc, BranchKind kind, bool taken, uint64_t target);
+
+  [[nodiscard]] const Stats &GetStats() const {
+    return stats_;
+  }
+
+  /**
+   * @brief Per-branch counts for every executed branch, in address order.
+   */
+  [[nodiscard]] std::vector<Site> GetSites() const;
+
+  /**
+   * @brief Writes the configuration, the totals and the top_n most mispredicted branches.
+   */
+  void WriteReport(std::ostream &os, const AssembledProgram &program, size_t top_n) const;
+
+ private:
+  struct SiteCounts {
+    uint64_t executed = 0;
+    uint64_t mispredicted = 0;
+  };
+
+  std::unique_ptr<DirectionPredictor> direction_;
+  std::unique_ptr<BranchTargetBuffer> btb_;
+  std::unique_ptr<ReturnAddressStack> ras_;
+  Stats stats_;
+  uint64_t text_start_ = 0;
+  std::vector<SiteCounts> sites_; ///< Indexed by (pc - text_start)/4, like the profiler.
+  uint64_t table_size_ = 0;
+  uint64_t history_bits_ = 0;
+  uint64_t btb_size_ = 0;
+  uint64_t ras_size_ = 0;
+};
+
+#endif // BRANCH_PREDICTOR_H
@@ -0,0 +1,139 @@
+/**
+ * @file breakpoints.h
+ * @brief Contains the BreakpointSet class and the compiled breakpoint conditions.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef BREAKPOINTS_H
+#define BREAKPOINTS_H
+
+#include "registers.h"
+#include "memory_controller.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief A breakpoint condition compiled once to a small stack bytecode.
+ *
+ * The expression language is C-like over 64-bit values: decimal or 0x numbers, register
+ * names and ABI aliases (x0-x31, f0-f31 as raw bits), `pc`, memory reads `mem8[addr]`,
+ * `mem16[...]`, `mem32[...]` and `mem64[...]` (`mem[...]` is `mem64`), parentheses, the unary
+ * operators `- ! ~` and the binary operators `* / % + - << >> < <= > >= == != & ^ | && ||`
+ * with C precedence. Comparisons are signed; `>>` is logical.
+ */
+class BreakpointCondition {
+ public:
+  /**
+   * @brief Compiles an expression.
+   * @throws std::invalid_argument If the expression does not parse.
+   */
+  static BreakpointCondition Compile(const std::string &expression);
+
+  /**
+   * @brief Evaluates the expression; the breakpoint triggers on a non-zero result.
+   */
+  [[nodiscard]] uint64_t Evaluate(uint64_t pc, const RegisterFile &registers, MemoryController &memory) const;
+
+  [[nodiscard]] const std::string &GetExpression() const {
+    return expression_;
+  }
+
+  enum class Op : uint8_t {
+    kConst, kGpr, kFpr, kPc,
+    kLoad8, kLoad16, kLoad32, kLoad64,
+    kNeg, kNot, kBitNot,
+    kMul, kDiv, kRem, kAdd, kSub, kShl, kShr,
+    kLt, kLe, kGt, kGe, kEq, kNe,
+    kAnd, kXor, kOr, kLogicalAnd, kLogicalOr,
+  };
+
+  struct Instruction {
+    Op op;
+    uint64_t operand; ///< The constant, or the register index.
+  };
+
+  static constexpr size_t kMaxStackDepth = 32;
+
+ private:
+  std::string expression_;
+  std::vector<Instruction> code_;
+};
+
+/**
+ * @brief The breakpoints of the loaded program.
+ *
+ * Which instructions have a breakpoint is kept in a bitmap over the text section, so the
+ * per-instruction check in DebugRun is a single bit test. Conditions and hit counts live in a
+ * side table that is only consulted when the bit is set.
+ */
+class BreakpointSet {
+ public:
+  struct Breakpoint {
+    uint64_t address;
+    std::string condition; ///< Source of the condition, empty for none.
+    uint64_t hit_count; ///< Break once the breakpoint has been hit this many times.
+    uint64_t hits; ///< Times the breakpoint was reached with its condition true.
+  };
+
+  /**
+   * @brief Removes every breakpoint and sizes the bitmap for a new text section.
+   */
+  void Reset(uint64_t text_start, uint64_t text_end);
+
+  /**
+   * @brief Adds or replaces the breakpoint at an address.
+   * @param condition Condition expression, empty to break unconditionally.
+   * @param hit_count Break on the hit_count-th time the (condition-true) breakpoint is reached and after.
+   * @param hits Hits already counted, for a breakpoint restored from a saved state.
+   * @throws std::invalid_argument If the address is not an instruction in the text section,
+   *                               hit_count is 0 or the condition does not compile.
+   */
+  void Add(uint64_t address, const std::string &condition = "", uint64_t hit_count = 1, uint64_t hits = 0);
+
+  /**
+   * @return Whether a breakpoint was removed.
+   */
+  bool Remove(uint64_t address);
+
+  [[nodiscard]] bool Contains(uint64_t address) const {
+    uint64_t offset = address - text_start_;
+    uint64_t index = offset >> 2;
+    return (offset & 0b11) == 0 && index < instruction_count_ && ((bits_[index >> 6] >> (index & 63)) & 1);
+  }
+
+  /**
+   * @brief Checks the breakpoint at pc, if any, counting the hit.
+   * @return Whether execution should stop before the instruction at pc.
+   */
+  bool ShouldBreak(uint64_t pc, const RegisterFile &registers, MemoryController &memory) {
+    return Contains(pc) && Hit(pc, registers, memory);
+  }
+
+  /**
+   * @return The breakpoints in address order.
+   */
+  [[nodiscard]] std::vector<Breakpoint> GetBreakpoints() const;
+
+  [[nodiscard]] size_t Size() const {
+    return entries_.size();
+  }
+
+ private:
+  struct Entry {
+    Breakpoint breakpoint;
+    std::optional<BreakpointCondition> condition;
+  };
+
+  uint64_t text_start_ = 0;
+  uint64_t instruction_count_ = 0;
+  std::vector<uint64_t> bits_;
+  std::unordered_map<uint64_t, Entry> entries_;
+
+  bool Hit(uint64_t pc, const RegisterFile &registers, MemoryController &memory);
+};
+
+#endif // BREAKPOINTS_H
@@ -6,85 +6,88 @@
 #ifndef CACHE_H
 #define CACHE_H
 
+#include "../../config.h"
+
 #include <cstdint>
 #include <vector>
 
 namespace cache {
 
-enum class ReplacementPolicy {
-  LRU,    ///< Least Recently Used
-  FIFO,   ///< First In First Out
-  Random  ///< Random replacement
-};
-
-enum class CacheType {
-  Instruction, ///< Cache for instructions
-  Data         ///< Cache for data
-};
-
-enum class CacheLineState {
-  Valid,       ///< Cache line is valid
-  Invalid,     ///< Cache line is invalid
-  Dirty        ///< Cache line has been modified
-};
-
-enum class WriteHitPolicy {
-  WriteThrough, ///< Write through policy
-  WriteBack     ///< Write back policy
-};
-
-enum class WriteMissPolicy {
-  NoWriteAllocate, ///< Do not allocate on write miss
-  WriteAllocate    ///< Allocate on write miss
-};
-
-struct CacheConfig {
-  unsigned long lines = 0;  ///< Number of lines in the cache
-  unsigned long associativity = 0; ///< Associativity of the cache
-  unsigned long words_per_line = 0; ///< Number of words per line in the cache
-  ReplacementPolicy replacement_policy = ReplacementPolicy::LRU; ///< Replacement policy for the cache
-  CacheType cache_type = CacheType::Data; ///< Type of cache (instruction or data)
-  WriteHitPolicy write_hit_policy = WriteHitPolicy::WriteBack; ///< Write hit policy
-  WriteMissPolicy write_miss_policy = WriteMissPolicy::NoWriteAllocate; ///< Write miss policy
-  unsigned long size = 0;   ///< Size of the cache in bytes
-};
-
-struct CacheLine {
-  CacheLineState state = CacheLineState::Invalid; ///< State of the cache line
-  unsigned long tag = 0;    ///< Tag for the cache line
-  std::vector<uint8_t> data; ///< Data stored in the cache line
-  
-};
-
 struct CacheStats {
-  unsigned long accesses; ///< Total number of accesses to the cache
-  unsigned long hits;     ///< Total number of hits in the cache
-  unsigned long misses;   ///< Total number of misses in the cache
-
-
-};
-
-struct CacheSet {
-  unsigned long associativity; ///< Associativity of the cache set
-  std::vector<CacheLine> lines; ///< Lines in the cache set
-
-  CacheSet(unsigned long assoc)
-    : associativity(assoc), lines(assoc) {}
+  uint64_t accesses = 0; ///< Total number of accesses to the cache
+  uint64_t hits = 0;     ///< Total number of hits in the cache
+  uint64_t misses = 0;   ///< Total number of misses in the cache
+  uint64_t reads = 0;
+  uint64_t writes = 0;
+  uint64_t write_misses = 0;
+  uint64_t writebacks = 0; ///< Dirty lines written back on eviction.
+
+  [[nodiscard]] double MissRate() const {
+    return accesses == 0 ? 0.0 : static_cast<double>(misses)/static_cast<double>(accesses);
+  }
 };
 
+/**
+ * @brief Set-associative cache model that tracks tags only.
+ *
+ * The VM reads and writes memory directly, so the model only decides hit or miss and keeps
+ * the statistics. Lines of a set are stored contiguously; an access scans its set's ways.
+ */
 class Cache {
-  bool enabled; ///< Flag to indicate if the cache is enabled
-  CacheType type; ///< Type of cache (instruction or data)
-  CacheConfig config; ///< Configuration of the cache
-  CacheStats stats; ///< Statistics for the cache
-
-
+ public:
+  /**
+   * @brief Builds the cache described by the [Cache] configuration and clears the statistics.
+   * @throws std::invalid_argument If the block size is not a power of two or the size is not a
+   *                               multiple of block_size*associativity.
+   */
+  void Start(const vm_config::VmConfig &config);
+
+  /**
+   * @brief Disables the model and frees its lines.
+   */
+  void Reset();
+
+  [[nodiscard]] bool IsEnabled() const {
+    return enabled_;
+  }
+
+  /**
+   * @brief Looks up the line holding address, allocating it on a miss as the policies say.
+   * @return Whether the access hit.
+   */
+  bool Access(uint64_t address, bool is_write);
+
+  [[nodiscard]] const CacheStats &GetStats() const {
+    return stats_;
+  }
+
+  void ResetStats() {
+    stats_ = {};
+  }
+
+ private:
+  struct Line {
+    uint64_t tag = 0;
+    uint64_t stamp = 0; ///< Last use for LRU, fill time for FIFO.
+    bool valid = false;
+    bool dirty = false;
+  };
+
+  bool enabled_ = false;
+  std::vector<Line> lines_; ///< sets_*associativity_ lines, set by set.
+  uint64_t sets_ = 0;
+  uint64_t associativity_ = 0;
+  unsigned int block_shift_ = 0;
+  vm_config::CacheReplacementPolicy replacement_policy_ = vm_config::CacheReplacementPolicy::LRU;
+  bool write_back_ = true;
+  bool write_allocate_ = true;
+  uint64_t clock_ = 0;
+  uint64_t random_state_ = 0x9e3779b97f4a7c15ULL;
+  CacheStats stats_;
+
+  Line &Victim(Line *set);
 };
 
-
-
 } // namespace cache
 
-
-
-#endif // CACHE_H
\ No newline at end of file
+#endif // CACHE_H
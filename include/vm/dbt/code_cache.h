@@ -0,0 +1,71 @@
+/**
+ * @file code_cache.h
+ * @brief Contains the CodeCache class, the executable memory translated blocks live in.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef CODE_CACHE_H
+#define CODE_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dbt {
+
+/**
+ * @brief A bump allocator over one mmap'ed region, kept either writable or executable (W^X).
+ *
+ * Code is appended between BeginWrite and EndWrite; the region is never executable while it is
+ * writable. There is no per-block freeing: when the cache fills up it is cleared as a whole.
+ */
+class CodeCache {
+ public:
+  /**
+   * @throws std::runtime_error If the region cannot be mapped.
+   */
+  explicit CodeCache(size_t capacity);
+  ~CodeCache();
+
+  CodeCache(const CodeCache &) = delete;
+  CodeCache &operator=(const CodeCache &) = delete;
+
+  /**
+   * @brief Makes the region writable (and not executable).
+   */
+  void BeginWrite();
+
+  /**
+   * @brief Makes the region executable (and read-only) again.
+   */
+  void EndWrite();
+
+  [[nodiscard]] uint8_t *Cursor() const {
+    return base_ + used_;
+  }
+
+  [[nodiscard]] size_t Remaining() const {
+    return capacity_ - used_;
+  }
+
+  /**
+   * @brief Claims the bytes just written at the cursor.
+   */
+  void Commit(size_t bytes) {
+    used_ += bytes;
+  }
+
+  /**
+   * @brief Drops every block; the caller must not jump to old code afterwards.
+   */
+  void Clear() {
+    used_ = 0;
+  }
+
+ private:
+  uint8_t *base_;
+  size_t capacity_;
+  size_t used_ = 0;
+};
+
+} // namespace dbt
+
+#endif // CODE_CACHE_H
@@ -0,0 +1,168 @@
+/**
+ * @file dbt_engine.h
+ * @brief Contains the DbtEngine class, which translates hot guest blocks to x86-64 host code.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef DBT_ENGINE_H
+#define DBT_ENGINE_H
+
+#include "code_cache.h"
+#include "x86_emitter.h"
+
+#include <array>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+class RVSSVM;
+class Memory;
+class MmioBus;
+
+namespace dbt {
+
+struct DbtStats {
+  uint64_t blocks = 0; ///< Blocks translated.
+  uint64_t translated_instructions = 0; ///< Guest instructions in those blocks.
+  uint64_t native_instructions = 0; ///< Instructions retired by translated code.
+  uint64_t interpreted_instructions = 0; ///< Instructions retired by the interpreter.
+  uint64_t flushes = 0; ///< Times every translation was dropped while running.
+};
+
+/**
+ * @brief Runs an RVSSVM with hot blocks translated to x86-64.
+ *
+ * The engine interprets (through RVSSVM::StepHeadless) and counts how often each block starts.
+ * A block that reaches the hot threshold is translated: straight-line RV64IM code up to the
+ * first branch or jump, or up to the first instruction the translator does not handle (floating
+ * point, CSRs, ecall, atomics, word ops and the custom SIMD, quantum, ECC and cache
+ * instructions), which is left to the interpreter.
+ *
+ * Translated code keeps five guest registers, picked by a static count over the program text, in
+ * callee-saved host registers and the rest in a context struct whose address lives in rbx.
+ * Blocks ending in a direct branch or jump are chained by patching the exit into a jump to the
+ * target block once that is translated; jalr looks its target up in a small jump cache. Loads
+ * and stores go through a 256-entry TLB of guest memory blocks, which only ever holds plain RAM:
+ * MMIO, blocks near the end of memory and blocks holding translated code always take the slow
+ * path through the MemoryController, so devices, range errors and self-modifying stores behave
+ * as in the interpreter.
+ *
+ * The result matches the interpreter exactly: registers, memory, output, the instruction count,
+ * device ticks seen by the guest, and where an exception leaves the program counter.
+ */
+class DbtEngine {
+ public:
+  /**
+   * @brief Whether translated code can run on this host (x86-64 only).
+   */
+  static bool IsSupported();
+
+  /**
+   * @param hot_threshold Times a block starts in the interpreter before it is translated.
+   */
+  explicit DbtEngine(uint64_t hot_threshold);
+  ~DbtEngine();
+
+  DbtEngine(const DbtEngine &) = delete;
+  DbtEngine &operator=(const DbtEngine &) = delete;
+
+  /**
+   * @brief Executes up to max_instructions, as RVSSVM::RunQuantum would, stopping early when the
+   *        program ends, exits or a stop is requested.
+   *
+   * Translations are dropped at every call, so memory may be changed freely between runs.
+   * @return The number of instructions executed.
+   * @throws Whatever the interpreter would throw, with the program counter past the faulting
+   *         instruction and current_delta_.old_pc at it.
+   */
+  uint64_t Run(RVSSVM &vm, uint64_t max_instructions);
+
+  [[nodiscard]] const DbtStats &GetStats() const {
+    return stats_;
+  }
+
+  /**
+   * @brief Whether the translator handles the instruction; the rest are interpreted.
+   */
+  static bool IsTranslatable(uint32_t instruction);
+
+  struct Context; ///< State shared with translated code; laid out in dbt_engine.cpp.
+
+ private:
+
+  struct Block {
+    const uint8_t *code; ///< nullptr if the block starts with an instruction that is not translated.
+    uint64_t length;
+  };
+
+  struct StubSite {
+    uint8_t *site; ///< rel32 field of a jump to the stub.
+    unsigned int index; ///< Instruction in the block the stub leaves at.
+  };
+
+  uint64_t hot_threshold_;
+  DbtStats stats_;
+  CodeCache cache_;
+  std::unique_ptr<Context> context_;
+
+  RVSSVM *vm_ = nullptr;
+  Memory *memory_ = nullptr;
+  MmioBus *bus_ = nullptr;
+  unsigned int block_shift_ = 0;
+  bool fast_memory_ = false; ///< Whether loads and stores try the TLB before the slow path.
+  uint64_t generation_ = 0; ///< Memory generation the TLB entries belong to.
+
+  std::array<int, 32> host_register_{}; ///< Index into the mapped host registers, or -1.
+  const uint8_t *entry_ = nullptr;
+  const uint8_t *exit_ = nullptr;
+
+  std::unordered_map<uint64_t, Block> blocks_;
+  std::unordered_map<uint64_t, uint64_t> heat_;
+  std::unordered_map<uint64_t, std::vector<uint8_t *>> unchained_; ///< Exits waiting for a block at a pc.
+  std::unordered_set<uint64_t> code_blocks_; ///< Memory blocks holding translated instructions.
+
+  std::exception_ptr fault_; ///< Raised by a load or store of translated code.
+  bool flush_requested_ = false; ///< A store hit translated code.
+
+  void Begin(RVSSVM &vm);
+  void AllocateRegisters();
+  void ClearTranslations();
+  void ResetTlbs();
+
+  const Block *FindOrTranslate(uint64_t pc);
+  const Block *Translate(uint64_t pc);
+  uint64_t Execute(const uint8_t *code, uint64_t budget);
+  uint64_t Interpret(uint64_t max_instructions);
+
+  void EmitTrampolines(X86Emitter &emitter);
+  void EmitBlock(X86Emitter &emitter, uint64_t pc, const std::vector<uint32_t> &words);
+  void EmitInstruction(X86Emitter &emitter, uint64_t pc, uint32_t instruction, unsigned int index,
+                       unsigned int length, std::vector<StubSite> &stubs);
+  void EmitExit(X86Emitter &emitter, uint64_t target, const uint8_t *block_entry, uint64_t block_pc);
+  void EmitMemoryAccess(X86Emitter &emitter, uint32_t instruction, bool is_store, unsigned int index,
+                        unsigned int length, std::vector<StubSite> &stubs);
+  void EmitHelperCall(X86Emitter &emitter, const void *helper, unsigned int index, unsigned int length,
+                      std::vector<StubSite> &stubs);
+
+  void LoadGuest(X86Emitter &emitter, X86Reg dst, unsigned int guest) const;
+  void StoreGuest(X86Emitter &emitter, unsigned int guest, X86Reg src) const;
+  void SetGuest(X86Emitter &emitter, unsigned int guest, uint64_t value) const;
+  X86Reg SourceOf(X86Emitter &emitter, unsigned int guest, X86Reg scratch) const;
+
+  /**
+   * @brief Ticks the devices for the instructions translated code retired so far.
+   */
+  void CatchUpTicks();
+  void FillTlb(uint64_t address, bool is_store);
+
+  template<typename T, bool kSigned>
+  static uint64_t LoadHelper(Context *context, uint64_t address);
+  template<typename T>
+  static void StoreHelper(Context *context, uint64_t address, uint64_t value);
+};
+
+} // namespace dbt
+
+#endif // DBT_ENGINE_H
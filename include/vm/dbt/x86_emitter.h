@@ -0,0 +1,165 @@
+/**
+ * @file x86_emitter.h
+ * @brief Contains the X86Emitter class, the x86-64 encoder used by the binary translator.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef X86_EMITTER_H
+#define X86_EMITTER_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dbt {
+
+enum class X86Reg : uint8_t {
+  kRax, kRcx, kRdx, kRbx, kRsp, kRbp, kRsi, kRdi,
+  kR8, kR9, kR10, kR11, kR12, kR13, kR14, kR15,
+};
+
+/**
+ * @brief Condition codes, as encoded in Jcc and SETcc.
+ */
+enum class Cond : uint8_t {
+  kB = 0x2,  ///< Unsigned less.
+  kAe = 0x3, ///< Unsigned greater or equal.
+  kE = 0x4,
+  kNe = 0x5,
+  kL = 0xC,  ///< Signed less.
+  kGe = 0xD, ///< Signed greater or equal.
+};
+
+/**
+ * @brief Two-operand integer operations, numbered by their ModRM /digit in the 0x81 group.
+ */
+enum class AluKind : uint8_t {
+  kAdd = 0,
+  kOr = 1,
+  kAnd = 4,
+  kSub = 5,
+  kXor = 6,
+  kCmp = 7,
+};
+
+enum class ShiftKind : uint8_t {
+  kShl = 4,
+  kShr = 5,
+  kSar = 7,
+};
+
+/**
+ * @brief A memory operand: [base + index + disp].
+ */
+struct X86Mem {
+  X86Reg base;
+  int32_t disp = 0;
+  bool has_index = false;
+  X86Reg index = X86Reg::kRax;
+};
+
+/**
+ * @brief Appends x86-64 instructions to a buffer.
+ *
+ * Only the forms the translator needs are provided. All register operations are 64-bit unless
+ * the name says otherwise. Jumps take absolute targets and return the address of their rel32
+ * field, so forward jumps can be emitted with a null target and patched once it is known.
+ */
+class X86Emitter {
+ public:
+  X86Emitter(uint8_t *buffer, size_t capacity) : buffer_(buffer), capacity_(capacity) {}
+
+  [[nodiscard]] uint8_t *Here() const {
+    return buffer_ + size_;
+  }
+
+  [[nodiscard]] size_t Size() const {
+    return size_;
+  }
+
+  void MovRR(X86Reg dst, X86Reg src);
+
+  /**
+   * @brief Loads a 64-bit constant, using the shortest encoding that produces it.
+   */
+  void MovRI(X86Reg dst, uint64_t imm);
+
+  /**
+   * @brief Loads size (1, 2, 4 or 8) bytes, sign- or zero-extended to 64 bits.
+   */
+  void Load(X86Reg dst, X86Mem mem, unsigned int size, bool sign_extend);
+
+  /**
+   * @brief Stores the low size (1, 2, 4 or 8) bytes of src.
+   */
+  void Store(X86Mem mem, X86Reg src, unsigned int size);
+
+  /**
+   * @brief Stores a sign-extended 32-bit immediate as a 64-bit value.
+   */
+  void StoreImm(X86Mem mem, int32_t imm);
+
+  void AluRR(AluKind kind, X86Reg dst, X86Reg src);
+  void AluRM(AluKind kind, X86Reg dst, X86Mem mem);
+  void AluRI(AluKind kind, X86Reg dst, int32_t imm);
+  void AluMI(AluKind kind, X86Mem mem, int32_t imm);
+
+  /**
+   * @brief Shifts dst by cl; the hardware masks the count to 6 bits, as RV64 does.
+   */
+  void ShiftRCl(ShiftKind kind, X86Reg dst);
+  void ShiftRI(ShiftKind kind, X86Reg dst, uint8_t count);
+
+  void ImulRR(X86Reg dst, X86Reg src);
+
+  /**
+   * @brief rdx:rax = rax * src, signed or unsigned.
+   */
+  void MulWide(X86Reg src, bool is_signed);
+
+  void TestRI(X86Reg reg, int32_t imm);
+
+  /**
+   * @brief dst = condition ? 1 : 0.
+   */
+  void SetCond(Cond cond, X86Reg dst);
+
+  void Push(X86Reg reg);
+  void Pop(X86Reg reg);
+  void Ret();
+
+  /**
+   * @brief Calls a host function through rax.
+   */
+  void CallAbs(const void *target);
+
+  uint8_t *Jcc(Cond cond, const uint8_t *target);
+  uint8_t *Jmp(const uint8_t *target);
+  void JmpMem(X86Mem mem);
+  void JmpReg(X86Reg reg);
+
+  /**
+   * @brief Points the rel32 field at site (from Jcc or Jmp) to target.
+   */
+  static void PatchRel32(uint8_t *site, const uint8_t *target);
+
+ private:
+  uint8_t *buffer_;
+  size_t capacity_;
+  size_t size_ = 0;
+
+  void Byte(uint8_t value);
+  void Imm32(uint32_t value);
+  void Imm64(uint64_t value);
+
+  /**
+   * @brief Emits a REX prefix when one is needed: for a 64-bit operation, an extended register,
+   *        or (force) a byte operation on spl..dil.
+   */
+  void Rex(bool wide, uint8_t reg, uint8_t index, uint8_t base, bool force = false);
+  void ModRmReg(uint8_t reg, uint8_t rm);
+  void ModRmMem(uint8_t reg, const X86Mem &mem);
+  void RexMem(bool wide, uint8_t reg, const X86Mem &mem, bool force = false);
+};
+
+} // namespace dbt
+
+#endif // X86_EMITTER_H
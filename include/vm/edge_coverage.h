@@ -0,0 +1,66 @@
+/**
+ * @file edge_coverage.h
+ * @brief Contains the EdgeCoverage class, the control-flow edge bitmap the fuzzer is guided by.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef EDGE_COVERAGE_H
+#define EDGE_COVERAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Hit counts of control-flow edges, AFL style.
+ *
+ * Every taken branch and jump hashes its (source, target) pair into a 64K-entry array of
+ * saturating 8-bit counters. Collisions are accepted in exchange for a fixed-size map. The
+ * indices hit since the last Clear are listed, so clearing and comparing cost only the edges
+ * a run took rather than the whole map.
+ */
+class EdgeCoverage {
+ public:
+  static constexpr unsigned int kMapBits = 16;
+  static constexpr size_t kMapSize = size_t{1} << kMapBits;
+
+  EdgeCoverage() : hits_(kMapSize, 0) {}
+
+  void Record(uint64_t from, uint64_t to) {
+    // Distinct multipliers make a->b and b->a different edges; instructions are 4-byte aligned.
+    uint64_t hash = (from >> 2)*0x9E3779B97F4A7C15ULL ^ (to >> 2)*0xC2B2AE3D27D4EB4FULL;
+    auto index = static_cast<uint32_t>(hash >> (64 - kMapBits));
+    uint8_t &count = hits_[index];
+    if (count == 0) {
+      touched_.push_back(index);
+    }
+    count += count != UINT8_MAX;
+  }
+
+  /**
+   * @brief Zeroes the counters hit since the last Clear.
+   */
+  void Clear();
+
+  /**
+   * @brief Map indices hit since the last Clear, in first-hit order.
+   */
+  [[nodiscard]] const std::vector<uint32_t> &GetTouched() const {
+    return touched_;
+  }
+
+  [[nodiscard]] uint8_t GetHits(uint32_t index) const {
+    return hits_[index];
+  }
+
+  /**
+   * @brief Classifies a hit count into one of 8 ranges (1, 2, 3, 4-7, 8-15, 16-31, 32-127,
+   *        128+), returned as a single bit, so loops that run a few more times are not new paths.
+   */
+  static uint8_t Bucket(uint8_t hits);
+
+ private:
+  std::vector<uint8_t> hits_;
+  std::vector<uint32_t> touched_;
+};
+
+#endif // EDGE_COVERAGE_H
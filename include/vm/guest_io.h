@@ -0,0 +1,143 @@
+/**
+ * @file guest_io.h
+ * @brief Contains the GuestIo class, which backs the VM's console and file syscalls.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef GUEST_IO_H
+#define GUEST_IO_H
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+/**
+ * @brief Host side of the guest's file descriptors.
+ *
+ * Console output on fds 1 and 2 is buffered and flushed once the buffer reaches the flush
+ * threshold, or when Flush() is called (end of a run, before blocking on stdin, on exit).
+ * Files opened by the guest live in a sandbox directory on the host and get guest fds
+ * starting at 3. Stdin can be preloaded from a file so programs run without interaction.
+ *
+ * Functions returning int64_t follow the Linux syscall convention: a non-negative result on
+ * success and -errno on failure, ready to be written back to a0.
+ */
+class GuestIo {
+ public:
+  GuestIo() = default;
+  ~GuestIo();
+
+  GuestIo(const GuestIo &) = delete;
+  GuestIo &operator=(const GuestIo &) = delete;
+
+  /**
+   * @brief Sets the host directory that guest paths are resolved against; created on first open.
+   */
+  void SetSandboxDirectory(const std::filesystem::path &directory);
+
+  /**
+   * @brief Wraps flushed stdout in VM_STDOUT_START/VM_STDOUT_END markers for the frontend.
+   */
+  void SetBackendOutput(bool backend_output) {
+    backend_output_ = backend_output;
+  }
+
+  /**
+   * @brief Sets the number of buffered console bytes that triggers a flush; 0 disables buffering.
+   */
+  void SetFlushThreshold(size_t bytes);
+
+  /**
+   * @brief Serves guest reads from fd 0 out of the given file instead of the interactive input queue.
+   * @throws std::runtime_error If the file cannot be read.
+   */
+  void PreloadStdin(const std::filesystem::path &filename);
+
+  /**
+   * @brief Serves guest reads from fd 0 out of contents, like PreloadStdin.
+   */
+  void SetStdin(std::string contents);
+
+  [[nodiscard]] bool HasPreloadedStdin() const {
+    return stdin_preloaded_;
+  }
+
+  /**
+   * @brief Appends text to the console buffer of fd 1 (stdout) or fd 2 (stderr).
+   */
+  void WriteConsole(int64_t fd, std::string_view text);
+
+  int64_t Write(int64_t fd, std::span<const uint8_t> data);
+  int64_t Read(int64_t fd, std::span<uint8_t> buffer);
+
+  /**
+   * @brief Opens a file inside the sandbox directory.
+   * @param path Guest path; absolute paths are taken relative to the sandbox root.
+   * @param flags Linux open flags (O_RDONLY, O_WRONLY, O_RDWR, O_CREAT, O_EXCL, O_TRUNC, O_APPEND).
+   * @param mode Permission bits used when the file is created.
+   * @return The new guest fd, or -EACCES if no sandbox is set or the path escapes it.
+   */
+  int64_t Open(const std::string &path, int64_t flags, int64_t mode);
+  int64_t Close(int64_t fd);
+  int64_t Seek(int64_t fd, int64_t offset, int64_t whence);
+
+  /**
+   * @brief Keeps flushed console output in memory instead of writing it to the host console.
+   */
+  void SetCaptureOutput(bool capture) {
+    capture_output_ = capture;
+  }
+
+  [[nodiscard]] bool IsCapturingOutput() const {
+    return capture_output_;
+  }
+
+  /**
+   * @brief Everything flushed to fd 1 while capturing was enabled.
+   */
+  [[nodiscard]] const std::string &GetCapturedStdout() const {
+    return captured_stdout_;
+  }
+
+  /**
+   * @brief Everything flushed to fd 2 while capturing was enabled.
+   */
+  [[nodiscard]] const std::string &GetCapturedStderr() const {
+    return captured_stderr_;
+  }
+
+  /**
+   * @brief Writes out any buffered console output.
+   */
+  void Flush();
+
+  /**
+   * @brief Flushes, closes every guest file and drops preloaded stdin and captured output.
+   */
+  void Reset();
+
+ private:
+  std::string stdout_buffer_;
+  std::string stderr_buffer_;
+  size_t flush_threshold_ = 4096;
+  bool capture_output_ = false;
+  bool backend_output_ = false;
+  std::string captured_stdout_;
+  std::string captured_stderr_;
+
+  std::filesystem::path sandbox_directory_;
+  std::unordered_map<int64_t, int> files_; ///< Guest fd to host fd.
+  int64_t next_fd_ = 3;
+
+  std::string stdin_contents_;
+  size_t stdin_position_ = 0;
+  bool stdin_preloaded_ = false;
+
+  void FlushStdout();
+  void FlushStderr();
+};
+
+#endif // GUEST_IO_H
@@ -1,6 +1,6 @@
 /**
  * @file main_memory.h
- * @brief Contains the definition of the MemoryBlock and Memory classes.
+ * @brief Contains the definition of the Memory class.
  * @author Vishank Singh, https://github.com/VishankSingh
  */
 
@@ -9,62 +9,150 @@
 
 #include "config.h"
 
+#include <array>
+#include <atomic>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <utility>
 #include <vector>
-#include <unordered_map>
 #include <cstdint>
+#include <span>
 #include <string>
 #include <stdexcept>
 
 /**
- * @brief Represents a memory block containing 1 KB of memory.
+ * @brief Sparse guest memory, safe to share between harts running on different host threads.
+ *
+ * Blocks are allocated on first write and found through a radix table whose nodes and blocks
+ * are installed with compare-and-swap, so concurrent harts allocate without taking a lock.
+ * Naturally aligned accesses of up to 8 bytes are single atomic loads and stores (acquire and
+ * release, which is stronger than RVWMO requires); misaligned accesses are split into bytes,
+ * as the ISA allows. Block copies are plain memcpy and are not atomic.
+ *
+ * Fork gives another Memory the same blocks without copying them. Shared blocks are reference
+ * counted and marked read-only in every table that holds them; the first write through a table
+ * copies the block (or takes it over, once no other table holds it).
  */
-struct MemoryBlock {
-  std::vector<uint8_t> data; ///< A vector representing the memory block data.
-  unsigned int block_size = vm_config::config.getMemoryBlockSize(); ///< The size of the memory block in bytes.
-
+class Memory {
+ public:
   /**
-   * @brief Constructs a MemoryBlock with a size of 1 KB initialized to 0.
+   * @brief Read-modify-write operations of the A extension's AMO instructions.
    */
-  MemoryBlock() {
-    data.resize(block_size, 0);
-  }
-};
+  enum class AmoOp : uint8_t {
+    kSwap,
+    kAdd,
+    kXor,
+    kAnd,
+    kOr,
+    kMin,
+    kMax,
+    kMinu,
+    kMaxu,
+  };
 
-/**
- * @brief Represents a memory management system with dynamic memory block allocation.
- */
-class Memory {
  private:
-  std::unordered_map<uint64_t, MemoryBlock> blocks_; ///< A map storing memory blocks, indexed by block index.
-  unsigned int block_size_; ///< The size of each memory block in bytes.
-  uint64_t memory_size_ = vm_config::config.getMemorySize(); ///< The total memory size in bytes.
+  static constexpr unsigned int kRadixBits = 12; ///< Block-index bits resolved per table level.
+  static constexpr size_t kRadixFanout = size_t{1} << kRadixBits;
+  static constexpr unsigned int kReservationStripeBits = 12;
+
+  struct RadixNode {
+    /// Child nodes, or blocks at the last level; a block with the low bit set is shared and read-only here.
+    std::array<std::atomic<void *>, kRadixFanout> slots;
+
+    RadixNode() {
+      for (std::atomic<void *> &slot : slots) {
+        slot.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+  };
+
+  RadixNode *root_; ///< Never null; replaced by Reset.
+  unsigned int levels_; ///< Table levels needed to cover every block index below memory_size_.
+  /// Tags the per-thread block cache; a fresh value on Reset, Fork and copy-on-write drops every cached entry.
+  std::atomic<uint64_t> id_;
+  std::atomic<uint64_t> block_count_ = 0;
+  unsigned int block_size_; ///< The size of each memory block in bytes, a power of two.
+  unsigned int block_shift_; ///< log2(block_size_).
+  uint64_t memory_size_; ///< The total memory size in bytes.
+
+  std::mutex retired_mutex_;
+  std::vector<uint8_t *> retired_blocks_; ///< Released while other harts may still read them; freed by Reset.
+
+  bool track_reservations_ = false;
+  /// Per-granule store counters, hashed into stripes; LR records one and SC checks it is unchanged.
+  std::unique_ptr<std::atomic<uint64_t>[]> reservation_stamps_;
 
   /**
    * @brief Gets the block index for a given memory address.
    * @param address The memory address.
    * @return The block index corresponding to the address.
    */
-  uint64_t GetBlockIndex(uint64_t address) const;
+  uint64_t GetBlockIndex(uint64_t address) const {
+    return address >> block_shift_;
+  }
 
   /**
    * @brief Gets the offset within a block for a given memory address.
    * @param address The memory address.
    * @return The offset within the block corresponding to the address.
    */
-  uint64_t GetBlockOffset(uint64_t address) const;
+  uint64_t GetBlockOffset(uint64_t address) const {
+    return address & (block_size_ - 1);
+  }
 
   /**
-   * @brief Checks if a memory block is present at the specified index.
-   * @param block_index The index of the block to check.
-   * @return True if the block is present, false otherwise.
+   * @brief Finds an allocated block, checking this thread's block cache first.
+   * @return The block's bytes, or nullptr if nothing was ever written to it.
    */
-  bool IsBlockPresent(uint64_t block_index) const;
+  uint8_t *FindBlock(uint64_t block_index) const;
 
   /**
-   * @brief Ensures that a memory block exists at the specified index, if not then adds it.
-   * @param block_index The index of the block to check or create.
+   * @brief Finds a block, allocating it and any missing table nodes.
+   *
+   * Racing harts may both allocate a node; the compare-and-swap picks one and the loser frees its copy.
+   * @return The block's bytes.
    */
-  void EnsureBlockExists(uint64_t block_index);
+  uint8_t *EnsureBlockExists(uint64_t block_index);
+
+  /**
+   * @brief Replaces the shared block in slot with one only this table holds, copying it if
+   *        another table still holds it.
+   * @return The slot's new, writable block.
+   */
+  uint8_t *Unshare(std::atomic<void *> &slot, void *shared);
+
+  /**
+   * @brief Copies a table level, marking every block shared in both the original and the copy.
+   */
+  RadixNode *ShareTable(RadixNode *node, unsigned int level);
+
+  void FreeTable(RadixNode *node, unsigned int level);
+
+  void FreeRetiredBlocks();
+
+  void CollectBlocks(const RadixNode *node, unsigned int level, uint64_t prefix,
+                     std::vector<std::pair<uint64_t, const uint8_t *>> &blocks) const;
+
+  uint64_t CountSharedBlocks(const RadixNode *node, unsigned int level) const;
+
+  std::atomic<uint64_t> &ReservationStripe(uint64_t address) const;
+
+  /**
+   * @brief Invalidates reservations on the granule holding address, if tracking is on.
+   */
+  void BumpReservation(uint64_t address) {
+    if (track_reservations_) {
+      ReservationStripe(address).fetch_add(1, std::memory_order_release);
+    }
+  }
+
+  /**
+   * @brief Checks an atomic access is in range and naturally aligned.
+   * @throws std::out_of_range If the access does not fit in memory.
+   * @throws std::runtime_error If the address is not aligned to size.
+   */
+  void CheckAtomicAccess(uint64_t address, unsigned int size) const;
 
   /**
    * @brief Generic function to read data of type T from the memory.
@@ -84,22 +172,134 @@ class Memory {
   template<typename T>
   void WriteGeneric(uint64_t address, T value);
 
+  Memory(unsigned int block_size, uint64_t memory_size);
+
  public:
   /**
-   * @brief Constructs a Memory object.
+   * @brief Constructs a Memory object sized by the given configuration.
+   *
+   * The block size is rounded up to a power of two of at least 8 bytes, so no aligned word
+   * straddles two blocks.
    */
-  Memory() {
-    block_size_ = vm_config::config.getMemoryBlockSize();
-  }
+  explicit Memory(const vm_config::VmConfig &config);
+
+  /**
+   * @brief Constructs a Memory object sized by the global configuration.
+   */
+  Memory() : Memory(vm_config::config) {}
+
+  Memory(const Memory &) = delete;
+  Memory &operator=(const Memory &) = delete;
+
   /**
    * @brief Destroys the Memory object.
    */
-  ~Memory() = default;
+  ~Memory();
+
+  /**
+   * @brief Frees every block. Must not run while a hart is accessing memory.
+   */
+  void Reset();
+
+  /**
+   * @brief Creates a Memory with the same contents that shares every block with this one until
+   *        either writes to it.
+   *
+   * Costs one pointer per allocated block. Must not run while a hart is writing to this memory;
+   * several threads may fork the same memory at once as long as nothing writes to it.
+   */
+  [[nodiscard]] std::unique_ptr<Memory> Fork();
+
+  /**
+   * @brief Number of allocated blocks, including shared ones.
+   */
+  [[nodiscard]] uint64_t GetBlockCount() const {
+    return block_count_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Lists the allocated blocks in address order. Must not run while a hart is writing.
+   * @return Each block's index (its address >> GetBlockShift()) and bytes, valid until the
+   *         generation changes.
+   */
+  [[nodiscard]] std::vector<std::pair<uint64_t, const uint8_t *>> GetBlocks() const;
+
+  /**
+   * @brief Number of blocks this memory still shares with a fork, a snapshot or its origin.
+   */
+  [[nodiscard]] uint64_t GetSharedBlockCount() const;
 
-  void Reset() {
-    blocks_.clear();
+  [[nodiscard]] unsigned int GetBlockShift() const {
+    return block_shift_;
+  }
+
+  [[nodiscard]] uint64_t GetMemorySize() const {
+    return memory_size_;
+  }
+
+  /**
+   * @brief Changes whenever a block may have moved: on Reset, Fork and copy-on-write. Callers
+   *        that keep block pointers (the binary translator's TLB) drop them when it changes.
+   */
+  [[nodiscard]] uint64_t GetGeneration() const {
+    return id_.load(std::memory_order_acquire);
   }
 
+  /**
+   * @return The allocated block holding address, possibly shared with a fork, or nullptr if
+   *         nothing was ever written to it. Valid until the generation changes.
+   */
+  [[nodiscard]] uint8_t *FindBlockOf(uint64_t address) const {
+    return FindBlock(GetBlockIndex(address));
+  }
+
+  /**
+   * @return The block holding address, allocated and made private to this memory first.
+   *         Valid until the generation changes.
+   */
+  uint8_t *GetWritableBlock(uint64_t address) {
+    return EnsureBlockExists(GetBlockIndex(address));
+  }
+
+  [[nodiscard]] bool IsReservationTracking() const {
+    return track_reservations_;
+  }
+
+  /**
+   * @brief Turns on counting stores per reservation granule, which SC needs once several harts
+   *        share this memory. Set before the harts start.
+   */
+  void SetReservationTracking(bool enabled) {
+    track_reservations_ = enabled;
+  }
+
+  /**
+   * @brief Store count of the 8-byte granule holding address (shared with the granules hashed to
+   *        the same stripe). Only changes while reservation tracking is on.
+   */
+  [[nodiscard]] uint64_t GetReservationStamp(uint64_t address) const {
+    return ReservationStripe(address).load(std::memory_order_acquire);
+  }
+
+  /**
+   * @brief Atomically replaces the size-byte value at address with desired if it equals expected.
+   * @param size 4 or 8.
+   * @return Whether the value was replaced.
+   */
+  bool CompareExchange(uint64_t address, unsigned int size, uint64_t expected, uint64_t desired);
+
+  /**
+   * @brief Atomically applies op with operand to the size-byte value at address.
+   * @param size 4 or 8; 4-byte min and max compare the low 32 bits.
+   * @return The previous value, zero-extended.
+   */
+  uint64_t AtomicRmw(AmoOp op, uint64_t address, unsigned int size, uint64_t operand);
+
+  /**
+   * @brief Sequentially consistent load of a naturally aligned 4- or 8-byte value, zero-extended.
+   */
+  uint64_t AtomicLoad(uint64_t address, unsigned int size);
+
   /**
    * @brief Reads a single byte from the given memory address.
    * @param address The memory address to read from.
@@ -178,9 +378,23 @@ class Memory {
 
   void WriteDouble(uint64_t address, double value);
 
+  /**
+   * @brief Writes a contiguous range of bytes, copying a whole block at a time.
+   * @param address The memory address to start writing at.
+   * @param data The bytes to write.
+   */
+  void WriteBlock(uint64_t address, std::span<const uint8_t> data);
+
+  /**
+   * @brief Reads a contiguous range of bytes, copying a whole block at a time.
+   * @param address The memory address to start reading from.
+   * @param data The buffer to fill; bytes in unallocated blocks read as zero.
+   */
+  void ReadBlock(uint64_t address, std::span<uint8_t> data);
+
   void PrintMemory(uint64_t address, unsigned int rows);
 
-  void DumpMemory(std::vector<std::string> args);
+  void DumpMemory(std::vector<std::string> args, const std::filesystem::path &filename);
 
   void GetMemoryPoint(std::string address);
 
@@ -0,0 +1,64 @@
+/**
+ * @file matrix_gemm.h
+ * @brief Contains the element formats and the blocked GEMM behind the matrix engine device.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef MATRIX_GEMM_H
+#define MATRIX_GEMM_H
+
+#include "vm/vector/vector_kernels.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace matrix {
+
+/**
+ * @brief How the matrix engine stores elements in guest memory.
+ *
+ * MSFP16 packs four consecutive elements of a row into one 64-bit block with a shared exponent
+ * (see alu::msfp16_pack), so MSFP16 rows are stored in whole blocks.
+ */
+enum class ElementFormat : uint8_t {
+  kFp32 = 0,
+  kFp16 = 1,
+  kBf16 = 2,
+  kMsfp16 = 3,
+};
+
+/**
+ * @brief Whether a FORMAT register field names one of the formats above.
+ */
+bool IsValidFormat(uint64_t format);
+
+/**
+ * @brief Bytes taken by a row of n elements; MSFP16 rounds up to whole 4-element blocks.
+ */
+uint64_t RowBytes(ElementFormat format, uint64_t n);
+
+/**
+ * @brief Converts a stored row of n elements to fp32; exact for every format but MSFP16,
+ *        which is widened the same way the FMADD_MSFP16 op does.
+ */
+void DecodeRow(ElementFormat format, const uint8_t *src, uint64_t n, float *out);
+
+/**
+ * @brief Rounds a row of n fp32 values to the format, with the ALU's conversions. RowBytes(format, n)
+ *        bytes are written; MSFP16 pads the last block with zeros.
+ */
+void EncodeRow(ElementFormat format, const float *src, uint64_t n, uint8_t *out);
+
+/**
+ * @brief c[i][j] += sum over p of a[i][p]*b[p][j], for m x k times k x n row-major fp32 matrices
+ *        with leading dimensions lda, ldb and ldc.
+ *
+ * Each element is accumulated in p order with one fp32 fused multiply-add per step, however the
+ * loops are blocked, so every kernel gives the same bits. HostIsa::kAvx2 runs eight columns at
+ * a time with FMA; any other value runs the scalar loop, since SSE2 has no fused multiply-add.
+ */
+void Gemm(rvv::HostIsa isa, uint64_t m, uint64_t n, uint64_t k, const float *a, uint64_t lda,
+          const float *b, uint64_t ldb, float *c, uint64_t ldc);
+
+} // namespace matrix
+
+#endif // MATRIX_GEMM_H
@@ -9,8 +9,12 @@
 
 #include "../config.h"
 #include "main_memory.h"
+#include "mmio_bus.h"
 
 #include <iostream>
+#include <memory>
+#include <span>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
@@ -20,77 +24,198 @@
  */
 class MemoryController {
 private:
-    Memory memory_; ///< The main memory object.
+    std::shared_ptr<Memory> memory_; ///< The main memory object; shared by every hart of a multi-hart machine.
+    MmioBus mmio_bus_; ///< Devices mapped over RAM; checked before every access.
+
+    /**
+     * @brief This hart's LR reservation: the address, the granule's store stamp and the value loaded.
+     */
+    struct Reservation {
+        uint64_t address = 0;
+        uint64_t stamp = 0;
+        uint64_t value = 0;
+        unsigned int size = 0;
+        bool valid = false;
+    };
+    Reservation reservation_;
+
+    [[nodiscard]] MMIODevice *FindDevice(uint64_t address) const {
+        return mmio_bus_.InWindow(address) ? mmio_bus_.Find(address) : nullptr;
+    }
+
+    void CheckNotDevice(uint64_t address) const {
+        if (FindDevice(address) != nullptr) {
+            throw std::runtime_error("Atomic memory operation on a device register: " + std::to_string(address));
+        }
+    }
 public:
-    MemoryController() = default;
+    MemoryController() : memory_(std::make_shared<Memory>()) {}
+    explicit MemoryController(const vm_config::VmConfig &config) : memory_(std::make_shared<Memory>(config)) {}
+
+    /**
+     * @brief Makes this controller use another controller's memory, so two harts see the same RAM.
+     */
+    void ShareMemory(std::shared_ptr<Memory> memory) {
+        memory_ = std::move(memory);
+        reservation_ = {};
+    }
+
+    [[nodiscard]] const std::shared_ptr<Memory> &GetSharedMemory() const {
+        return memory_;
+    }
 
     void Reset() {
-        memory_.Reset();
+        memory_->Reset();
+        mmio_bus_.Reset();
+        reservation_ = {};
+    }
+
+    [[nodiscard]] MmioBus &GetMmioBus() {
+        return mmio_bus_;
     }
 
     void PrintCacheStatus() const {
     }
 
     void WriteByte(uint64_t address, uint8_t value) {
-      memory_.WriteByte(address, value);
+      if (MMIODevice *device = FindDevice(address)) [[unlikely]] {
+        device->write(address - device->baseAddress(), value, 1);
+        return;
+      }
+      memory_->WriteByte(address, value);
     }
 
     void WriteHalfWord(uint64_t address, uint16_t value) {
-      memory_.WriteHalfWord(address, value);
+      if (MMIODevice *device = FindDevice(address)) [[unlikely]] {
+        device->write(address - device->baseAddress(), value, 2);
+        return;
+      }
+      memory_->WriteHalfWord(address, value);
     }
 
     void WriteWord(uint64_t address, uint32_t value) {
-      memory_.WriteWord(address, value);
+      if (MMIODevice *device = FindDevice(address)) [[unlikely]] {
+        device->write(address - device->baseAddress(), value, 4);
+        return;
+      }
+      memory_->WriteWord(address, value);
     }
 
     void WriteDoubleWord(uint64_t address, uint64_t value) {
-      memory_.WriteDoubleWord(address, value);
+      if (MMIODevice *device = FindDevice(address)) [[unlikely]] {
+        device->write(address - device->baseAddress(), value, 8);
+        return;
+      }
+      memory_->WriteDoubleWord(address, value);
+    }
+
+    void WriteBlock(uint64_t address, std::span<const uint8_t> data) {
+      memory_->WriteBlock(address, data);
+    }
+
+    void ReadBlock(uint64_t address, std::span<uint8_t> data) {
+      memory_->ReadBlock(address, data);
     }
 
     [[nodiscard]] uint8_t ReadByte(uint64_t address) {
-        return memory_.ReadByte(address);
+        if (MMIODevice *device = FindDevice(address)) [[unlikely]] {
+            return static_cast<uint8_t>(device->read(address - device->baseAddress(), 1));
+        }
+        return memory_->ReadByte(address);
     }
 
     [[nodiscard]] uint16_t ReadHalfWord(uint64_t address) {
-        return memory_.ReadHalfWord(address);
+        if (MMIODevice *device = FindDevice(address)) [[unlikely]] {
+            return static_cast<uint16_t>(device->read(address - device->baseAddress(), 2));
+        }
+        return memory_->ReadHalfWord(address);
     }
 
     [[nodiscard]] uint32_t ReadWord(uint64_t address) {
-        return memory_.ReadWord(address);
+        if (MMIODevice *device = FindDevice(address)) [[unlikely]] {
+            return static_cast<uint32_t>(device->read(address - device->baseAddress(), 4));
+        }
+        return memory_->ReadWord(address);
     }
 
     [[nodiscard]] uint64_t ReadDoubleWord(uint64_t address) {
-        return memory_.ReadDoubleWord(address);
+        if (MMIODevice *device = FindDevice(address)) [[unlikely]] {
+            return static_cast<uint64_t>(device->read(address - device->baseAddress(), 8));
+        }
+        return memory_->ReadDoubleWord(address);
     }
 
-    // Functions to read memory directly with cache bypass
+    // Functions to read memory directly with cache bypass; they also bypass MMIO devices, so
+    // reading a device register this way has no side effects. Block copies are RAM-only too.
 
     [[nodiscard]] uint8_t ReadByte_d(uint64_t address) {
-        return memory_.ReadByte(address);
+        return memory_->ReadByte(address);
     }
 
     [[nodiscard]] uint16_t ReadHalfWord_d(uint64_t address) {
-        return memory_.ReadHalfWord(address);
+        return memory_->ReadHalfWord(address);
     }
 
     [[nodiscard]] uint32_t ReadWord_d(uint64_t address) {
-        return memory_.ReadWord(address);
+        return memory_->ReadWord(address);
     }
 
     [[nodiscard]] uint64_t ReadDoubleWord_d(uint64_t address) {
-        return memory_.ReadDoubleWord(address);
+        return memory_->ReadDoubleWord(address);
+    }
+
+    /**
+     * @brief LR.W/LR.D: loads a naturally aligned value and reserves its granule.
+     * @return The loaded value, zero-extended.
+     */
+    uint64_t LoadReserved(uint64_t address, unsigned int size) {
+        CheckNotDevice(address);
+        uint64_t stamp = memory_->GetReservationStamp(address);
+        uint64_t value = memory_->AtomicLoad(address, size);
+        reservation_ = {address, stamp, value, size, true};
+        return value;
+    }
+
+    /**
+     * @brief SC.W/SC.D: stores value if this hart still holds a reservation on address.
+     *
+     * The store happens only if no store to the granule was counted since the LR and the memory
+     * still holds the value the LR read, checked with one compare-and-swap. Either way the
+     * reservation is released.
+     * @return Whether the store happened.
+     */
+    bool StoreConditional(uint64_t address, unsigned int size, uint64_t value) {
+        CheckNotDevice(address);
+        Reservation reservation = reservation_;
+        reservation_.valid = false;
+        if (!reservation.valid || reservation.address != address || reservation.size != size) {
+            return false;
+        }
+        if (memory_->GetReservationStamp(address) != reservation.stamp) {
+            return false;
+        }
+        return memory_->CompareExchange(address, size, reservation.value, value);
+    }
+
+    /**
+     * @brief AMO*.W/AMO*.D.
+     * @return The previous value, zero-extended.
+     */
+    uint64_t AtomicMemoryOperation(Memory::AmoOp op, uint64_t address, unsigned int size, uint64_t operand) {
+        CheckNotDevice(address);
+        return memory_->AtomicRmw(op, address, size, operand);
     }
 
     void PrintMemory(const uint64_t address, unsigned int rows) {
-      memory_.PrintMemory(address, rows);
+      memory_->PrintMemory(address, rows);
     }
 
-    void DumpMemory(std::vector<std::string> args) {
-      memory_.DumpMemory(args);
+    void DumpMemory(std::vector<std::string> args, const std::filesystem::path &filename) {
+      memory_->DumpMemory(args, filename);
     }
 
     void GetMemoryPoint(std::string address) {
-      return memory_.GetMemoryPoint(address);
+      return memory_->GetMemoryPoint(address);
     }
 
 };
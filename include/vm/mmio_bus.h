@@ -0,0 +1,101 @@
+/**
+ * @file mmio_bus.h
+ * @brief Contains the MmioBus class, which decodes guest addresses to memory-mapped devices.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef MMIO_BUS_H
+#define MMIO_BUS_H
+
+#include "mmio_devices.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A sorted table of non-overlapping device ranges.
+ *
+ * Every RAM access first checks whether the address falls inside the window spanning all
+ * devices, a subtraction and a compare; only addresses inside the window are looked up in
+ * the table with a binary search. Gaps between devices inside the window fall through to RAM.
+ */
+class MmioBus {
+ public:
+  /**
+   * @brief Maps a device at its base address.
+   * @throws std::invalid_argument If the device is empty, wraps around or overlaps another one.
+   */
+  void Add(std::unique_ptr<MMIODevice> device);
+
+  /**
+   * @brief Unmaps every device.
+   */
+  void Clear();
+
+  [[nodiscard]] bool Empty() const {
+    return devices_.empty();
+  }
+
+  /**
+   * @brief The fast check: whether the address lies between the first and last device.
+   */
+  [[nodiscard]] bool InWindow(uint64_t address) const {
+    return address - window_start_ < window_size_;
+  }
+
+  /**
+   * @brief Whether any address in [address, address + size) lies in the window.
+   */
+  [[nodiscard]] bool Overlaps(uint64_t address, uint64_t size) const {
+    return window_size_ != 0 && address < window_start_ + window_size_ && window_start_ < address + size;
+  }
+
+  /**
+   * @return The device mapped at the address, or nullptr if it is RAM.
+   */
+  [[nodiscard]] MMIODevice *Find(uint64_t address) const;
+
+  /**
+   * @brief Advances every device that does work per cycle.
+   */
+  void Tick(uint64_t cycles) {
+    for (MMIODevice *device : ticking_) {
+      device->tick(cycles);
+    }
+  }
+
+  /**
+   * @brief Whether any device is busy(), i.e. ticks currently change memory.
+   */
+  [[nodiscard]] bool Busy() const {
+    for (const MMIODevice *device : ticking_) {
+      if (device->busy()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /**
+   * @brief Returns every device to its power-on state, keeping the mapping.
+   */
+  void Reset();
+
+  [[nodiscard]] const std::vector<std::unique_ptr<MMIODevice>> &GetDevices() const {
+    return devices_;
+  }
+
+  /**
+   * @return The first device with the given name, or nullptr.
+   */
+  [[nodiscard]] MMIODevice *GetDevice(const std::string &name) const;
+
+ private:
+  std::vector<std::unique_ptr<MMIODevice>> devices_; ///< Sorted by base address.
+  std::vector<MMIODevice *> ticking_;
+  uint64_t window_start_ = 0;
+  uint64_t window_size_ = 0;
+};
+
+#endif // MMIO_BUS_H
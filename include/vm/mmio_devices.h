@@ -1,13 +1,24 @@
 /**
  * @file mmio_devices.h
- * @brief 
+ * @brief Contains the MMIODevice interface and the built-in UART, CLINT timer, DMA and matrix devices.
  * @author Vishank Singh, https://github.com/VishankSingh
  */
 #pragma once
 
 #include <cstdint>
-#include <unordered_map>
+#include <deque>
 #include <string>
+#include <string_view>
+#include <vector>
+
+class GuestIo;
+class MemoryController;
+
+/// Offsets of the built-in devices from Memory/mmio_base.
+inline constexpr uint64_t kUartOffset = 0x0;
+inline constexpr uint64_t kClintOffset = 0x10000;
+inline constexpr uint64_t kDmaOffset = 0x20000;
+inline constexpr uint64_t kMatrixOffset = 0x30000;
 
 class MMIODevice {
 public:
@@ -15,35 +26,39 @@ public:
 
     /**
      * @brief Read a value from the MMIO device.
-     * @param offset The offset to read from.
-     * @return The value read from the device.
+     * @param offset The offset from the base address to read from.
+     * @param size The access size in bytes: 1, 2, 4 or 8.
+     * @return The value read from the device, zero-extended.
      */
-    virtual uint32_t read(uint32_t offset) = 0;
+    virtual uint64_t read(uint64_t offset, unsigned int size) = 0;
 
     /**
      * @brief Write a value to the MMIO device.
-     * @param offset The offset to write to.
-     * @param value The value to write.
+     * @param offset The offset from the base address to write to.
+     * @param value The value to write; only the low size bytes are used.
+     * @param size The access size in bytes: 1, 2, 4 or 8.
      */
-    virtual void write(uint32_t offset, uint32_t value) = 0;
+    virtual void write(uint64_t offset, uint64_t value, unsigned int size) = 0;
 
     /**
      * @brief Check if the MMIO device is ready for access.
      * @return True if the device is ready, false otherwise.
      */
-    virtual bool isReady() const = 0;
+    virtual bool isReady() const {
+        return true;
+    }
 
     /**
      * @brief Get the size of the MMIO device.
      * @return The size of the device in bytes.
      */
-    virtual uint32_t size() const = 0;  
+    virtual uint64_t size() const = 0;
 
     /**
      * @brief Get the base address of the MMIO device.
      * @return The base address of the device.
      */
-    virtual uint32_t baseAddress() const = 0;
+    virtual uint64_t baseAddress() const = 0;
 
     /**
      * @brief Get the name of the MMIO device.
@@ -51,12 +66,33 @@ public:
      */
     virtual const char* name() const = 0;
 
-    
-}; // class MMIODevice
+    /**
+     * @brief Whether the device does work in tick(); the bus only ticks devices that do.
+     */
+    virtual bool ticks() const {
+        return false;
+    }
 
+    /**
+     * @brief Advance the device by the given number of cycles.
+     */
+    virtual void tick(uint64_t cycles) {
+        (void)cycles;
+    }
 
-// macros for MMIO device management in assembler code
+    /**
+     * @brief Whether the next ticks may change guest-visible state other than the device's own
+     *        registers (a DMA copy in flight); the binary translator interprets until none is.
+     */
+    virtual bool busy() const {
+        return false;
+    }
 
+    /**
+     * @brief Return the device to its power-on state.
+     */
+    virtual void reset() {}
+}; // class MMIODevice
 
 
 /**
@@ -64,26 +100,319 @@ public:
  */
 class NullMMIODevice : public MMIODevice {
 public:
-    uint32_t read(uint32_t offset) override {
+    uint64_t read(uint64_t offset, unsigned int size) override {
+        (void)offset;
+        (void)size;
         return 0;
     }
 
-    void write(uint32_t offset, uint32_t value) override {
-    }
-
-    bool isReady() const override {
-        return true; 
+    void write(uint64_t offset, uint64_t value, unsigned int size) override {
+        (void)offset;
+        (void)value;
+        (void)size;
     }
 
-    uint32_t size() const override {
+    uint64_t size() const override {
         return 0;
     }
 
-    uint32_t baseAddress() const override {
+    uint64_t baseAddress() const override {
         return 0;
     }
 
     const char* name() const override {
-        return "NullMMIODevice"; 
+        return "NullMMIODevice";
     }
 }; // class NullMMIODevice
+
+
+/**
+ * @brief A 16550-style UART with byte-wide registers.
+ *
+ * Transmitted bytes go to the guest's buffered stdout, so they interleave with syscall output.
+ * Received bytes come from host input pushed with pushInput(), then from preloaded stdin.
+ * The transmitter is always empty (LSR bits 5 and 6 set) and no interrupts are raised.
+ */
+class UartDevice : public MMIODevice {
+public:
+    static constexpr uint64_t kRbrThr = 0; ///< Receive buffer (read), transmit holding (write).
+    static constexpr uint64_t kIer = 1;
+    static constexpr uint64_t kIirFcr = 2;
+    static constexpr uint64_t kLcr = 3;
+    static constexpr uint64_t kMcr = 4;
+    static constexpr uint64_t kLsr = 5;
+    static constexpr uint64_t kMsr = 6;
+    static constexpr uint64_t kScr = 7;
+
+    static constexpr uint8_t kLsrDataReady = 1 << 0;
+    static constexpr uint8_t kLsrTxEmpty = (1 << 5) | (1 << 6);
+    static constexpr uint8_t kLcrDlab = 1 << 7;
+
+    UartDevice(uint64_t base, GuestIo &io) : base_(base), io_(io) {}
+
+    uint64_t read(uint64_t offset, unsigned int size) override;
+    void write(uint64_t offset, uint64_t value, unsigned int size) override;
+
+    uint64_t size() const override {
+        return 8;
+    }
+
+    uint64_t baseAddress() const override {
+        return base_;
+    }
+
+    const char* name() const override {
+        return "uart";
+    }
+
+    void reset() override;
+
+    /**
+     * @brief Queues host input for the guest to receive.
+     */
+    void pushInput(std::string_view text);
+
+private:
+    uint64_t base_;
+    GuestIo &io_;
+    std::deque<uint8_t> rx_fifo_;
+    uint8_t ier_ = 0;
+    uint8_t lcr_ = 0;
+    uint8_t mcr_ = 0;
+    uint8_t scr_ = 0;
+    uint8_t dll_ = 0;
+    uint8_t dlm_ = 0;
+
+    bool fillReceiver();
+}; // class UartDevice
+
+
+/**
+ * @brief A CLINT-style timer: msip, mtimecmp and a free-running mtime.
+ *
+ * mtime advances by one per executed instruction. The VM has no trap support, so the timer
+ * does not interrupt the guest; software polls mtime or compares it against mtimecmp.
+ */
+class ClintDevice : public MMIODevice {
+public:
+    static constexpr uint64_t kMsip = 0x0;
+    static constexpr uint64_t kMtimecmp = 0x4000;
+    static constexpr uint64_t kMtime = 0xBFF8;
+
+    explicit ClintDevice(uint64_t base) : base_(base) {}
+
+    uint64_t read(uint64_t offset, unsigned int size) override;
+    void write(uint64_t offset, uint64_t value, unsigned int size) override;
+
+    uint64_t size() const override {
+        return 0x10000;
+    }
+
+    uint64_t baseAddress() const override {
+        return base_;
+    }
+
+    const char* name() const override {
+        return "clint";
+    }
+
+    bool ticks() const override {
+        return true;
+    }
+
+    void tick(uint64_t cycles) override {
+        mtime_ += cycles;
+    }
+
+    void reset() override;
+
+    uint64_t getMtime() const {
+        return mtime_;
+    }
+
+    /**
+     * @brief Whether mtime has reached mtimecmp, i.e. what the MTIP bit would show.
+     */
+    bool timerPending() const {
+        return mtime_ >= mtimecmp_;
+    }
+
+private:
+    uint64_t base_;
+    uint32_t msip_ = 0;
+    uint64_t mtimecmp_ = UINT64_MAX;
+    uint64_t mtime_ = 0;
+}; // class ClintDevice
+
+
+/**
+ * @brief A DMA engine copying memory in host code while the guest keeps executing.
+ *
+ * The guest programs SRC, DST and LEN, then writes 1 to CTRL. Each tick copies up to
+ * bytes_per_cycle bytes per cycle until LEN bytes are done, so a copy of n bytes completes
+ * after about n / bytes_per_cycle instructions. STATUS shows busy, done and error; writing
+ * a 1 to done or error clears it. Like memcpy, overlapping ranges give unspecified results.
+ * Copies go straight to RAM, never through the MMIO bus.
+ */
+class DmaDevice : public MMIODevice {
+public:
+    static constexpr uint64_t kSrc = 0x00;
+    static constexpr uint64_t kDst = 0x08;
+    static constexpr uint64_t kLen = 0x10;
+    static constexpr uint64_t kCtrl = 0x18;
+    static constexpr uint64_t kStatus = 0x20;
+
+    static constexpr uint64_t kCtrlStart = 1 << 0;
+    static constexpr uint64_t kStatusBusy = 1 << 0;
+    static constexpr uint64_t kStatusDone = 1 << 1;
+    static constexpr uint64_t kStatusError = 1 << 2;
+
+    DmaDevice(uint64_t base, MemoryController &memory, uint64_t bytes_per_cycle)
+        : base_(base), memory_(memory), bytes_per_cycle_(bytes_per_cycle == 0 ? 1 : bytes_per_cycle) {}
+
+    uint64_t read(uint64_t offset, unsigned int size) override;
+    void write(uint64_t offset, uint64_t value, unsigned int size) override;
+
+    uint64_t size() const override {
+        return 0x100;
+    }
+
+    uint64_t baseAddress() const override {
+        return base_;
+    }
+
+    const char* name() const override {
+        return "dma";
+    }
+
+    bool ticks() const override {
+        return true;
+    }
+
+    void tick(uint64_t cycles) override;
+    void reset() override;
+
+    bool busy() const override {
+        return (status_ & kStatusBusy) != 0;
+    }
+
+private:
+    uint64_t base_;
+    MemoryController &memory_;
+    uint64_t bytes_per_cycle_;
+    uint64_t src_ = 0;
+    uint64_t dst_ = 0;
+    uint64_t len_ = 0;
+    uint64_t status_ = 0;
+    uint64_t copied_ = 0; ///< Bytes of the current transfer already copied.
+}; // class DmaDevice
+
+
+/**
+ * @brief A tile matrix-multiply engine: C = A*B or C += A*B for an M x K matrix A and a K x N
+ *        matrix B, in fp32, fp16, bf16 or msfp16.
+ *
+ * The guest programs the addresses, dimensions, leading dimensions (in elements; 0 means dense)
+ * and FORMAT, then writes 1 to CTRL (plus 2 to accumulate into C). A, B and, when accumulating,
+ * C are read and multiplied on the host at once; C is written back once the modelled latency has
+ * elapsed, at which point STATUS goes from busy to done. Elements are widened to fp32 and summed
+ * in order with fused multiply-adds, then rounded to the output format with the ALU's conversions.
+ * MSFP16 rows are stored as 4-element blocks, so their leading dimensions must be multiples of 4.
+ *
+ * The latency is kSetupCycles + M*N*K / macs_per_cycle + bytes moved / bytes_per_cycle. CYCLES
+ * holds the latency of the last operation; TOTAL_CYCLES and TOTAL_MACS add up every operation.
+ * Like the DMA engine, the engine reads and writes RAM directly, never through the MMIO bus.
+ */
+class MatrixEngineDevice : public MMIODevice {
+public:
+    static constexpr uint64_t kA = 0x00;
+    static constexpr uint64_t kB = 0x08;
+    static constexpr uint64_t kC = 0x10;
+    static constexpr uint64_t kM = 0x18;
+    static constexpr uint64_t kN = 0x20;
+    static constexpr uint64_t kK = 0x28;
+    static constexpr uint64_t kLda = 0x30;
+    static constexpr uint64_t kLdb = 0x38;
+    static constexpr uint64_t kLdc = 0x40;
+    static constexpr uint64_t kFormat = 0x48; ///< Bits 3:0 format of A and B, bits 7:4 format of C.
+    static constexpr uint64_t kCtrl = 0x50;
+    static constexpr uint64_t kStatus = 0x58;
+    static constexpr uint64_t kCycles = 0x60;
+    static constexpr uint64_t kTotalCycles = 0x68;
+    static constexpr uint64_t kTotalMacs = 0x70;
+
+    static constexpr uint64_t kCtrlStart = 1 << 0;
+    static constexpr uint64_t kCtrlAccumulate = 1 << 1;
+    static constexpr uint64_t kStatusBusy = 1 << 0;
+    static constexpr uint64_t kStatusDone = 1 << 1;
+    static constexpr uint64_t kStatusError = 1 << 2;
+
+    static constexpr uint64_t kSetupCycles = 32;
+    static constexpr uint64_t kMaxElements = uint64_t{1} << 26; ///< Per matrix, to bound host memory.
+
+    MatrixEngineDevice(uint64_t base, MemoryController &memory, uint64_t macs_per_cycle, uint64_t bytes_per_cycle);
+
+    uint64_t read(uint64_t offset, unsigned int size) override;
+    void write(uint64_t offset, uint64_t value, unsigned int size) override;
+
+    uint64_t size() const override {
+        return 0x100;
+    }
+
+    uint64_t baseAddress() const override {
+        return base_;
+    }
+
+    const char* name() const override {
+        return "matrix";
+    }
+
+    bool ticks() const override {
+        return true;
+    }
+
+    void tick(uint64_t cycles) override;
+    void reset() override;
+
+    bool busy() const override {
+        return (status_ & kStatusBusy) != 0;
+    }
+
+    uint64_t getTotalCycles() const {
+        return total_cycles_;
+    }
+
+    uint64_t getTotalMacs() const {
+        return total_macs_;
+    }
+
+    uint64_t getOperations() const {
+        return operations_;
+    }
+
+private:
+    uint64_t base_;
+    MemoryController &memory_;
+    uint64_t macs_per_cycle_;
+    uint64_t bytes_per_cycle_;
+    uint64_t a_ = 0;
+    uint64_t b_ = 0;
+    uint64_t c_ = 0;
+    uint64_t m_ = 0;
+    uint64_t n_ = 0;
+    uint64_t k_ = 0;
+    uint64_t lda_ = 0;
+    uint64_t ldb_ = 0;
+    uint64_t ldc_ = 0;
+    uint64_t format_ = 0;
+    uint64_t status_ = 0;
+    uint64_t cycles_ = 0;
+    uint64_t total_cycles_ = 0;
+    uint64_t total_macs_ = 0;
+    uint64_t operations_ = 0;
+    uint64_t remaining_ = 0; ///< Cycles until the result of the current operation is written.
+    std::vector<float> result_; ///< M x N, waiting to be written to C.
+
+    void start(bool accumulate);
+    void writeResult();
+}; // class MatrixEngineDevice
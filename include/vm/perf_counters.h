@@ -0,0 +1,101 @@
+/**
+ * @file perf_counters.h
+ * @brief Contains the PerfCounters struct, the instruction-mix histogram behind the hpmcounter CSRs.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include "alu.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/**
+ * @brief Whether the execute path counts instructions; set with -DENABLE_PERF_COUNTERS=ON.
+ *
+ * Counting sites use `if constexpr`, so the default build compiles them out entirely.
+ */
+#ifdef VM_PERF_COUNTERS
+inline constexpr bool kPerfCountersEnabled = true;
+#else
+inline constexpr bool kPerfCountersEnabled = false;
+#endif
+
+/**
+ * @brief Instruction classes; each retired instruction falls in exactly one.
+ *
+ * Class i is also readable by the guest as hpmcounter(3 + i), CSR 0xC03 + i.
+ */
+enum class InstructionClass : uint8_t {
+  kAlu,
+  kLoad,
+  kStore,
+  kBranchTaken,
+  kBranchNotTaken,
+  kJump,
+  kFloat,
+  kSimd,
+  kEcc,
+  kQuantum,
+  kCsr,
+  kSyscall,
+  kAtomic,
+  kVector,
+  kCount
+};
+
+inline constexpr size_t kInstructionClassCount = static_cast<size_t>(InstructionClass::kCount);
+inline constexpr size_t kAluOpCount = static_cast<size_t>(alu::AluOp::kQNormB) + 1; ///< kQNormB is the last AluOp.
+
+inline constexpr uint16_t kCsrCycle = 0xC00;
+inline constexpr uint16_t kCsrTime = 0xC01;
+inline constexpr uint16_t kCsrInstret = 0xC02;
+inline constexpr uint16_t kCsrHpmCounter3 = 0xC03;
+inline constexpr uint16_t kCsrHpmCounter31 = 0xC1F;
+
+const char *InstructionClassName(InstructionClass instruction_class);
+
+/**
+ * @brief Class of an integer-pipeline instruction whose ALU operation marks it as a custom extension.
+ * @return kSimd, kEcc or kQuantum, or kAlu for a regular operation.
+ */
+InstructionClass ClassifyAluOp(alu::AluOp op);
+
+struct PerfCounters {
+  std::array<uint64_t, kAluOpCount> alu_ops{};
+  std::array<uint64_t, kInstructionClassCount> classes{};
+
+  void CountAluOp(alu::AluOp op) {
+    size_t index = static_cast<size_t>(op);
+    if (index < kAluOpCount) {
+      ++alu_ops[index];
+    }
+  }
+
+  void CountClass(InstructionClass instruction_class) {
+    ++classes[static_cast<size_t>(instruction_class)];
+  }
+
+  void Reset() {
+    alu_ops.fill(0);
+    classes.fill(0);
+  }
+
+  /**
+   * @brief Value of hpmcounter3..31; counters without a class read as zero.
+   */
+  [[nodiscard]] uint64_t ReadHpmCounter(unsigned int counter) const {
+    size_t index = counter - 3;
+    return counter >= 3 && index < kInstructionClassCount ? classes[index] : 0;
+  }
+
+  /**
+   * @brief Writes cycle/instret, the class histogram and every non-zero AluOp count as JSON.
+   */
+  void DumpJson(const std::filesystem::path &filename, uint64_t cycles, uint64_t instret) const;
+};
+
+#endif // PERF_COUNTERS_H
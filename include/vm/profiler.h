@@ -0,0 +1,128 @@
+/**
+ * @file profiler.h
+ * @brief Contains the Profiler class, which counts where guest instructions are spent.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "vm_asm_mw.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Guest hot-spot profiler.
+ *
+ * Every retired instruction bumps a counter in a dense array indexed by (pc - text_start)/4,
+ * so the hot path never hashes. JAL/JALR instructions that link through ra or t0 are tracked
+ * as calls and returns (the RISC-V return-address-stack hints) to build a call tree, which
+ * gives per-function inclusive counts and folded stacks for flame graphs.
+ */
+class Profiler {
+ public:
+  struct HotSpot {
+    uint64_t pc; ///< First instruction of the line, or the instruction itself without line info.
+    unsigned int line; ///< Source line, 0 when the program has no line mapping (ELF input).
+    uint64_t count;
+  };
+
+  struct FunctionCount {
+    std::string name;
+    uint64_t address;
+    uint64_t exclusive; ///< Instructions executed between this label and the next one.
+    uint64_t inclusive; ///< Instructions executed while this label was on the call stack.
+    bool called; ///< Whether the label was ever a call target; inclusive is 0 otherwise.
+  };
+
+  /**
+   * @brief Clears all counts and starts profiling a program.
+   * @param text_start Address of the first instruction.
+   * @param text_end Address one past the last instruction.
+   * @param entry Address execution starts at; the root of the call tree.
+   */
+  void Start(uint64_t text_start, uint64_t text_end, uint64_t entry);
+
+  /**
+   * @brief Stops profiling and frees the counters.
+   */
+  void Reset();
+
+  [[nodiscard]] bool IsEnabled() const {
+    return enabled_;
+  }
+
+  /**
+   * @brief Records one retired instruction.
+   * @param pc Address the instruction was fetched from.
+   * @param instruction The instruction word.
+   * @param next_pc Address of the next instruction, the call target for a taken JAL/JALR.
+   */
+  void RecordInstruction(uint64_t pc, uint32_t instruction, uint64_t next_pc) {
+    uint64_t index = (pc - text_start_) >> 2;
+    if (index < pc_counts_.size()) {
+      ++pc_counts_[index];
+    }
+    ++call_nodes_[current_node_].self_count;
+    uint32_t opcode = instruction & 0x7f;
+    if (opcode == kJalOpcode || opcode == kJalrOpcode) {
+      TrackCallOrReturn(instruction, next_pc);
+    }
+  }
+
+  [[nodiscard]] uint64_t GetCount(uint64_t pc) const;
+  [[nodiscard]] uint64_t GetTotal() const;
+
+  /**
+   * @brief The most executed source lines (or instructions, without line info), hottest first.
+   */
+  [[nodiscard]] std::vector<HotSpot> GetHotSpots(const AssembledProgram &program, size_t top_n) const;
+
+  /**
+   * @brief Exclusive and inclusive counts for every code label, in address order.
+   */
+  [[nodiscard]] std::vector<FunctionCount> GetFunctionCounts(const AssembledProgram &program) const;
+
+  /**
+   * @brief Writes one "caller;callee;... count" line per call stack, the input format of flamegraph.pl.
+   */
+  void WriteFoldedStacks(std::ostream &os, const AssembledProgram &program) const;
+
+  /**
+   * @brief Writes the human-readable report: totals, the top_n hot lines and the function table.
+   */
+  void WriteReport(std::ostream &os, const AssembledProgram &program, size_t top_n) const;
+
+ private:
+  static constexpr uint32_t kJalOpcode = 0b1101111;
+  static constexpr uint32_t kJalrOpcode = 0b1100111;
+  static constexpr size_t kMaxCallDepth = 1024; ///< Deeper calls are charged to the deepest tracked frame.
+
+  struct CallNode {
+    CallNode(uint64_t function, uint32_t parent) : function(function), parent(parent) {}
+
+    uint64_t function; ///< Call target address.
+    uint32_t parent;
+    uint64_t self_count = 0;
+    std::unordered_map<uint64_t, uint32_t> children; ///< Callee address to node index.
+  };
+
+  bool enabled_ = false;
+  uint64_t text_start_ = 0;
+  std::vector<uint64_t> pc_counts_;
+
+  std::vector<CallNode> call_nodes_ = {{0, 0}}; ///< Node 0 is the root, so recording never needs a check.
+  uint32_t current_node_ = 0;
+  size_t depth_ = 0;
+  size_t untracked_depth_ = 0; ///< Calls made past kMaxCallDepth that have not returned yet.
+
+  void TrackCallOrReturn(uint32_t instruction, uint64_t next_pc);
+  void PushCall(uint64_t target);
+  void PopCall();
+};
+
+#endif // PROFILER_H
@@ -14,6 +14,12 @@
 #include <string>
 #include <cstdint>
 
+inline constexpr uint16_t kCsrMhartid = 0xF14; ///< Index of the hart, read-only to the guest.
+inline constexpr uint16_t kCsrVstart = 0x008; ///< First vector element to execute; always 0 here.
+inline constexpr uint16_t kCsrVl = 0xC20; ///< Vector length set by vsetvl{i}.
+inline constexpr uint16_t kCsrVtype = 0xC21; ///< Vector type set by vsetvl{i}.
+inline constexpr uint16_t kCsrVlenb = 0xC22; ///< VLEN/8, read-only.
+
 /**
  * @brief Represents a register file containing integer, floating-point, and vector registers.
  */
@@ -21,9 +27,11 @@ class RegisterFile {
  private:
   static constexpr size_t NUM_GPR = 32; ///< Number of General-Purpose Registers (GPR).
   static constexpr size_t NUM_FPR = 32; ///< Number of Floating-Point Registers (FPR).
+  static constexpr size_t NUM_VR = 32; ///< Number of vector registers.
 
   std::array<uint64_t, NUM_GPR> gpr_ = {}; ///< Array for storing GPR values.
   std::array<uint64_t, NUM_FPR> fpr_ = {}; ///< Array for storing FPR values.
+  std::vector<uint8_t> vr_; ///< The vector registers, vlenb bytes each and back to back, so a register group is contiguous.
 
   static constexpr size_t NUM_CSR = 4096; ///< Number of Control and Status Registers (CSR).
 
@@ -73,6 +81,38 @@ class RegisterFile {
    */
   void WriteFpr(size_t reg, uint64_t value);
 
+  /**
+   * @brief Sets VLEN, clearing the vector registers and leaving vtype invalid (vill) until the
+   *        next vsetvl{i}.
+   * @param vlen_bits VLEN in bits, a power of two from 64 to 512.
+   */
+  void SetVectorLength(size_t vlen_bits);
+
+  /**
+   * @brief VLEN in bytes, the size of one vector register.
+   */
+  [[nodiscard]] size_t GetVlenb() const {
+    return vr_.size()/NUM_VR;
+  }
+
+  /**
+   * @brief The vector register file as one array; register v starts at v*GetVlenb().
+   */
+  [[nodiscard]] uint8_t *VectorData() {
+    return vr_.data();
+  }
+
+  [[nodiscard]] const uint8_t *VectorData() const {
+    return vr_.data();
+  }
+
+  /**
+   * @brief Reads 64 bits of the vector register file; slice i covers bytes [8i, 8i + 8).
+   */
+  [[nodiscard]] uint64_t ReadVectorSlice(size_t slice) const;
+
+  void WriteVectorSlice(size_t slice, uint64_t value);
+
   [[nodiscard]] uint64_t ReadCsr(size_t reg) const;
 
   void WriteCsr(size_t reg, uint64_t value);
@@ -98,6 +138,8 @@ extern const std::unordered_set<std::string> valid_general_purpose_registers;
 
 extern const std::unordered_set<std::string> valid_floating_point_registers;
 
+extern const std::unordered_set<std::string> valid_vector_registers;
+
 extern const std::unordered_set<std::string> valid_csr_registers;
 
 extern const std::unordered_map<std::string, int> csr_to_address;
@@ -111,6 +153,8 @@ bool IsValidGeneralPurposeRegister(const std::string &reg);
 
 bool IsValidFloatingPointRegister(const std::string &reg);
 
+bool IsValidVectorRegister(const std::string &reg);
+
 bool IsValidCsr(const std::string &reg);
 
 #endif // REGISTERS_H
\ No newline at end of file
@@ -0,0 +1,94 @@
+/**
+ * @file multi_hart_vm.h
+ * @brief Contains the MultiHartVm class, which runs several RVSS harts on one shared memory.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef MULTI_HART_VM_H
+#define MULTI_HART_VM_H
+
+#include "rvss_vm.h"
+
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Several RVSSVM harts sharing one Memory, each driven by its own host thread.
+ *
+ * Hart i reads i from mhartid and starts with sp = stack_top - i*hart_stack_size. Only hart 0
+ * maps the MMIO devices, and no hart records a profile, branch report or trace. Execution/hart_sync
+ * picks the scheduling:
+ * - quantum: the threads pass a turn between them and each runs hart_quantum instructions per
+ *   turn, in hart order, so a program interleaves the same way on every run.
+ * - free_running: the threads run concurrently, checking for a stop every hart_quantum instructions.
+ *
+ * A hart stops when it exits or runs off the end of the text; Run returns once all have.
+ */
+class MultiHartVm {
+ public:
+  struct Stats {
+    std::vector<uint64_t> instructions; ///< Retired by each hart during the last Run.
+    double seconds = 0; ///< Wall-clock time of the last Run.
+
+    [[nodiscard]] uint64_t TotalInstructions() const;
+  };
+
+  explicit MultiHartVm(VmContext context = VmContext::FromGlobals());
+
+  void LoadProgram(const AssembledProgram &program);
+  void LoadElfProgram(const std::string &filename);
+
+  /**
+   * @brief Runs every hart until all have halted or each has executed Execution/instruction_execution_limit instructions.
+   * @throws std::runtime_error If a hart faults; the other harts are stopped and the message names the hart.
+   */
+  void Run();
+
+  /**
+   * @brief Asks every hart to stop at its next quantum boundary; safe to call from any thread.
+   */
+  void RequestStop() {
+    stop_requested_ = true;
+  }
+
+  [[nodiscard]] unsigned int GetHartCount() const {
+    return static_cast<unsigned int>(harts_.size());
+  }
+
+  [[nodiscard]] RVSSVM &GetHart(unsigned int hart_id) {
+    return *harts_.at(hart_id);
+  }
+
+  [[nodiscard]] const Stats &GetStats() const {
+    return stats_;
+  }
+
+  /**
+   * @brief Writes the per-hart instruction counts, the wall-clock time and the aggregate MIPS.
+   */
+  void WriteSummary(std::ostream &os) const;
+
+ private:
+  VmContext context_;
+  std::vector<std::unique_ptr<RVSSVM>> harts_;
+  std::atomic<bool> stop_requested_ = false;
+  std::atomic<unsigned int> turn_ = 0; ///< Hart allowed to run in quantum mode; GetHartCount() once all are done.
+  std::vector<uint8_t> finished_; ///< Only touched by the thread holding the turn.
+  uint64_t instruction_limit_ = 0;
+  std::mutex error_mutex_;
+  std::string error_; ///< First fault of the last Run.
+  Stats stats_;
+
+  void PrepareHarts();
+  bool RunSlice(unsigned int hart_id);
+  void RunQuantumTurns(unsigned int hart_id);
+  void RunFree(unsigned int hart_id);
+  void RecordError(unsigned int hart_id, const std::exception &e);
+};
+
+#endif // MULTI_HART_VM_H
@@ -8,6 +8,8 @@
 
 
 #include "vm/vm_base.h"
+#include "vm/dbt/dbt_engine.h"
+#include "vm/vector/vector_unit.h"
 
 #include "rvss_control_unit.h"
 
@@ -15,12 +17,14 @@
 #include <vector>
 #include <iostream>
 #include <cstdint>
+#include <memory>
+#include <optional>
 
 // TODO: use a circular buffer instead of a stack for undo/redo
 
 struct RegisterChange {
   unsigned int reg_index;
-  unsigned int reg_type; // 0 for GPR, 1 for CSR, 2 for FPR
+  unsigned int reg_type; // 0 for GPR, 1 for CSR, 2 for FPR, 3 for a 64-bit vector register slice
   uint64_t old_value;
   uint64_t new_value;
 };
@@ -34,6 +38,8 @@ struct MemoryChange {
 struct StepDelta {
   uint64_t old_pc;
   uint64_t new_pc;
+  uint64_t old_cycles; ///< Cycle counts around the step, which may have stalled.
+  uint64_t new_cycles;
   std::vector<RegisterChange> register_changes;
   std::vector<MemoryChange> memory_changes;
 };
@@ -110,6 +116,7 @@ class RVSSVM : public VmBase {
 
   // intermediate variables
   int64_t execution_result_{};
+  alu::AluOp alu_operation_ = alu::AluOp::kNone; ///< What the current instruction executed, for the timing model.
   int64_t memory_result_{};
   // int64_t memory_address_{};
   // int64_t memory_data_{};
@@ -124,6 +131,11 @@ class RVSSVM : public VmBase {
   uint64_t csr_write_val_{};
   uint8_t csr_uimm_{};
 
+  bool writeback_to_fpr_ = false; ///< Whether the last write-back went to an FPR, for the trace.
+  std::optional<WatchpointHit> watchpoint_hit_; ///< Set by the current instruction's load or store.
+  std::unique_ptr<dbt::DbtEngine> dbt_; ///< Created by the first translated Run; dropped by Reset.
+  rvv::VectorUnit vector_unit_; ///< Executes OP-V and the vector loads and stores.
+
   void Fetch();
 
   void Decode();
@@ -137,22 +149,80 @@ class RVSSVM : public VmBase {
   void WriteMemory();
   void WriteMemoryFloat();
   void WriteMemoryDouble();
+  void WriteMemoryAtomic();
 
   void WriteBack();
   void WriteBackFloat();
   void WriteBackDouble();
   void WriteBackCsr();
 
-  RVSSVM();
+  /**
+   * @brief Appends the instruction just retired to the trace.
+   * @param pc Address the instruction was fetched from.
+   */
+  void RecordTrace(uint64_t pc);
+
+  /**
+   * @brief Little-endian value of size bytes of guest memory, for traces and watchpoints.
+   */
+  uint64_t ReadMemoryValue(uint64_t address, size_t size);
+
+  /**
+   * @brief Checks the current instruction's load or store against the watchpoints.
+   *
+   * Runs between Execute and WriteMemory, once the address is known but before a store
+   * changes memory, so the old value can still be read.
+   * @param pc Address the instruction was fetched from.
+   */
+  void CheckWatchpoints(uint64_t pc);
+
+  /**
+   * @brief Completes and prints the pending watchpoint hit, and clears it.
+   */
+  void ReportWatchpointHit();
+
+  explicit RVSSVM(VmContext context = VmContext::FromGlobals());
   ~RVSSVM();
 
   void Run() override;
+
+  /**
+   * @brief Executes up to max_instructions with no per-step output, dumps or undo history.
+   *
+   * The inner loop of the multi-hart scheduler and the fuzzer; the profiler and trace are not
+   * recorded. current_delta_.old_pc holds the pc of the last instruction started, so a caller
+   * catching an exception knows where it was raised.
+   * @return The number of instructions executed; fewer when the program ends or exits.
+   */
+  uint64_t RunQuantum(uint64_t max_instructions);
+
+  /**
+   * @brief Executes one instruction the way RunQuantum does; the binary translator's interpreter.
+   */
+  void StepHeadless();
+
+  /**
+   * @brief Whether Run translates hot blocks: Execution/execution_engine is dbt, the host is
+   *        x86-64, and nothing that observes every instruction (the profiler, trace, branch
+   *        predictor, cache or timing model, fuzzer coverage or compiled-in perf counters) is on.
+   */
+  [[nodiscard]] bool UsesBinaryTranslation() const;
+
+  [[nodiscard]] bool IsHalted() const {
+    return exited_ || program_counter_ >= program_size_;
+  }
+
   void DebugRun() override;
   void Step() override;
   void Undo() override;
   void Redo() override;
   void Reset() override;
 
+  /**
+   * @brief Clears the pipeline state and undo history, then forks snapshot into this VM.
+   */
+  void Fork(const VmSnapshot &snapshot) override;
+
   void RequestStop() {
     stop_requested_ = true;
   }
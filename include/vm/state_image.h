@@ -0,0 +1,70 @@
+/**
+ * @file state_image.h
+ * @brief Contains the binary state image format, for saving a VM and resuming it later or elsewhere.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef STATE_IMAGE_H
+#define STATE_IMAGE_H
+
+#include "breakpoints.h"
+#include "vm_snapshot.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+/**
+ * @brief State images start with this header. All fields are little-endian.
+ *
+ * It is followed by the metadata, one lz_codec block of metadata_size bytes holding the
+ * counters, program counter, registers (CSRs and vector registers included), breakpoints and
+ * the program (file name, text, symbols and line tables), and then page_count pages of
+ * [u64 block index][u32 stored size][bytes]. A page whose stored size equals block_size is
+ * raw; any other is an lz_codec block. Only allocated pages that are not all zero are stored.
+ */
+struct StateImageHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t block_size; ///< Bytes per page, the saved memory's block size.
+  uint64_t memory_size;
+  uint64_t vector_length; ///< VLEN in bits.
+  uint64_t page_count;
+  uint64_t metadata_size;
+  uint64_t metadata_raw_size;
+};
+
+static_assert(sizeof(StateImageHeader) == 56, "StateImageHeader is written to state images as is");
+
+inline constexpr char kStateImageMagic[8] = {'R', 'V', 'S', 'T', 'A', 'T', 'E', '\0'};
+inline constexpr uint32_t kStateImageVersion = 1;
+
+/**
+ * @brief A VM state as read from an image.
+ */
+struct StateImage {
+  VmSnapshot snapshot;
+  std::vector<BreakpointSet::Breakpoint> breakpoints;
+};
+
+/**
+ * @brief Writes a snapshot and the breakpoints set on it to a state image.
+ *
+ * Only the snapshot's memory is read, so the VM it was taken from may run on meanwhile.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+void SaveStateImage(const std::filesystem::path &filename, const VmSnapshot &snapshot,
+                    const std::vector<BreakpointSet::Breakpoint> &breakpoints);
+
+/**
+ * @brief Reads a state image.
+ *
+ * The file is mmap'ed and each page is decompressed from the mapping straight into its
+ * memory block, so nothing but the pages themselves is allocated.
+ * @param config Configuration of the restored VM; its memory size, block size and vector
+ *               length are replaced by the image's.
+ * @throws std::runtime_error If the file cannot be read, is not a state image of this version,
+ *                            or is truncated or corrupt.
+ */
+StateImage LoadStateImage(const std::filesystem::path &filename, vm_config::VmConfig config);
+
+#endif // STATE_IMAGE_H
@@ -0,0 +1,109 @@
+/**
+ * @file state_publisher.h
+ * @brief Contains the StatePublisher class, through which a running VM shows its state to other threads.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef STATE_PUBLISHER_H
+#define STATE_PUBLISHER_H
+
+#include "main_memory.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+/**
+ * @brief Registers and counters of a VM at one instruction boundary.
+ */
+struct PublishedState {
+  uint64_t sequence = 0; ///< Publications so far; 0 before the first.
+  uint64_t program_counter = 0;
+  uint64_t instructions_retired = 0;
+  uint64_t cycles = 0;
+  bool running = false; ///< False once the run that published this state has returned.
+  std::array<uint64_t, 32> gprs{};
+  std::array<uint64_t, 32> fprs{}; ///< Raw bits, NaN-boxed singles included.
+};
+
+/**
+ * @brief Guest memory frozen at the same instruction boundary as state.
+ */
+struct PublishedMemoryView {
+  PublishedState state;
+  std::shared_ptr<Memory> memory; ///< A copy-on-write fork; reading it never disturbs the VM.
+};
+
+/**
+ * @brief Hands the state of the VM thread to readers on other threads without stopping it.
+ *
+ * Registers and counters go through a seqlock: the VM thread (the only writer) makes the
+ * sequence odd, stores the words and makes it even again; a reader copies the words and retries
+ * if the sequence was odd or changed meanwhile. Neither side takes a lock or allocates, so a
+ * dashboard reading 30 times a second costs the VM nothing beyond the publications themselves.
+ *
+ * Memory is too large to copy at every publication, so a reader asks for a view and the VM
+ * thread forks its memory at its next publication point. Only the blocks the VM writes
+ * afterwards are copied, once each, and only while a view is alive.
+ */
+class StatePublisher {
+ public:
+  /**
+   * @brief Stores a new state. Only the VM thread calls this.
+   */
+  void Publish(const PublishedState &state);
+
+  /**
+   * @brief Copies the latest state. Lock-free; safe from any thread, at any time.
+   */
+  [[nodiscard]] PublishedState Read() const;
+
+  [[nodiscard]] uint64_t GetSequence() const {
+    return sequence_.load(std::memory_order_acquire)/2;
+  }
+
+  /**
+   * @brief Whether a reader is waiting in AcquireMemoryView. Cheap enough to test at every
+   *        publication point.
+   */
+  [[nodiscard]] bool MemoryViewRequested() const {
+    return memory_view_requested_.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Hands a memory view to the readers waiting for one. Only the VM thread calls this.
+   */
+  void PublishMemoryView(std::shared_ptr<Memory> memory, const PublishedState &state);
+
+  /**
+   * @brief Drops the publisher's own reference to the last view, so the VM stops sharing
+   *        blocks with it once every reader is done. Only the VM thread calls this.
+   */
+  void ReleaseMemoryView();
+
+  /**
+   * @brief Asks the VM thread for a memory view and waits for it.
+   * @return The view, or nullptr if the VM did not reach a publication point within timeout
+   *         (it is not running, or is blocked).
+   */
+  [[nodiscard]] std::shared_ptr<const PublishedMemoryView> AcquireMemoryView(std::chrono::milliseconds timeout);
+
+ private:
+  static constexpr size_t kWords = 4 + 32 + 32;
+
+  std::atomic<uint64_t> sequence_ = 0; ///< Twice the publications, plus one while a write is in progress.
+  std::array<std::atomic<uint64_t>, kWords> words_{};
+
+  std::atomic<bool> memory_view_requested_ = false;
+  std::atomic<bool> holds_memory_view_ = false;
+  std::mutex memory_view_mutex_;
+  std::condition_variable memory_view_cv_;
+  std::shared_ptr<const PublishedMemoryView> memory_view_;
+  uint64_t memory_view_generation_ = 0; ///< Views published so far; guarded by memory_view_mutex_.
+  unsigned int memory_view_waiters_ = 0; ///< Readers inside AcquireMemoryView; guarded by memory_view_mutex_.
+};
+
+#endif // STATE_PUBLISHER_H
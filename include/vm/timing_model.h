@@ -0,0 +1,123 @@
+/**
+ * @file timing_model.h
+ * @brief Contains the cycle-approximate timing model: per-class operation latencies and a
+ *        register scoreboard.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef TIMING_MODEL_H
+#define TIMING_MODEL_H
+
+#include "../config.h"
+#include "alu.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+enum class LatencyClass : uint8_t {
+  kAlu,
+  kMul,
+  kDiv,
+  kLoad,
+  kStore,
+  kFpAdd,
+  kFpMul,
+  kFpFma,
+  kFpDiv,
+  kFpSqrt,
+  kFpMisc,
+  kSimd,
+  kSimdMul,
+  kSimdDiv,
+  kEcc,
+  kQuantum,
+  kFp16,
+  kBf16,
+  kMsfp16,
+  kCount
+};
+
+inline constexpr size_t kLatencyClassCount = static_cast<size_t>(LatencyClass::kCount);
+
+const char *LatencyClassName(LatencyClass latency_class);
+
+/**
+ * @brief The latency class of an instruction, from its opcode and the ALU operation it decoded to.
+ */
+LatencyClass ClassifyLatency(uint32_t instruction, alu::AluOp op);
+
+/**
+ * @brief Registers an instruction reads and writes. Indices 0-31 are x0-x31 and 32-63 f0-f31.
+ *
+ * Vector registers are not tracked; vector instructions only depend on the scalar registers
+ * they read and write (the address base and stride, vsetvl's AVL and new vl).
+ */
+struct RegisterOperands {
+  static constexpr uint8_t kNone = 0xFF;
+
+  std::array<uint8_t, 3> sources{kNone, kNone, kNone};
+  uint8_t destination = kNone;
+};
+
+RegisterOperands DecodeRegisterOperands(uint32_t instruction);
+
+/**
+ * @brief An in-order, single-issue core: an instruction issues once its source registers are
+ *        ready, and its destination is ready latency cycles later.
+ *
+ * Every functional unit is pipelined except one iterative divider, shared by the integer, SIMD
+ * and floating-point divides and square roots, which takes a new operation only when the last
+ * one finishes. The VM charges cache misses and branch mispredictions itself; they delay every
+ * later instruction, so a load's result is ready latency cycles after its miss is served.
+ */
+class TimingModel {
+ public:
+  struct Stats {
+    std::array<uint64_t, kLatencyClassCount> instructions{};
+    uint64_t data_stalls = 0; ///< Cycles waiting for a source register.
+    uint64_t structural_stalls = 0; ///< Cycles waiting for the divider.
+  };
+
+  /**
+   * @brief Enables the model if Timing/timing_enabled is set, loading the latency table, and
+   *        clears the scoreboard and statistics.
+   */
+  void Start(const vm_config::VmConfig &config);
+
+  /**
+   * @brief Disables the model.
+   */
+  void Reset();
+
+  /**
+   * @brief Marks every register ready and the divider free, e.g. after the cycle count moved back.
+   */
+  void Clear();
+
+  [[nodiscard]] bool IsEnabled() const {
+    return enabled_;
+  }
+
+  /**
+   * @brief Issues an instruction and books the cycle its result will be ready.
+   * @param now The VM's cycle count when the instruction could issue were nothing in its way.
+   *            Only its advance since the last issue is used, so an undo may move it back.
+   * @return Stall cycles before the instruction issues.
+   */
+  uint64_t Issue(uint32_t instruction, alu::AluOp op, uint64_t now);
+
+  [[nodiscard]] const Stats &GetStats() const {
+    return stats_;
+  }
+
+ private:
+  bool enabled_ = false;
+  std::array<uint64_t, kLatencyClassCount> latencies_{};
+  std::array<uint64_t, 64> ready_{}; ///< Cycle each register's last write completes.
+  uint64_t divider_free_ = 0;
+  uint64_t clock_ = 0;
+  uint64_t last_now_ = 0;
+  Stats stats_;
+};
+
+#endif // TIMING_MODEL_H
@@ -0,0 +1,162 @@
+/**
+ * @file trace.h
+ * @brief Contains the binary execution trace format and its writer and reader.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief One retired instruction. Fixed size, so a chunk is a plain array of records.
+ */
+struct TraceRecord {
+  uint64_t pc;
+  uint32_t instruction;
+  uint8_t rd; ///< Destination register, valid with kWritesRd.
+  uint8_t flags;
+  uint16_t reserved;
+  uint64_t rd_value; ///< Destination register after the instruction.
+  uint64_t mem_address; ///< Valid with kMemRead or kMemWrite.
+  uint64_t mem_value; ///< Value loaded, or the bytes stored as read back from memory.
+
+  static constexpr uint8_t kWritesRd = 1 << 0;
+  static constexpr uint8_t kRdIsFpr = 1 << 1;
+  static constexpr uint8_t kMemRead = 1 << 2;
+  static constexpr uint8_t kMemWrite = 1 << 3;
+
+  bool operator==(const TraceRecord &other) const = default;
+};
+
+static_assert(sizeof(TraceRecord) == 40, "TraceRecord is written to trace files as is");
+
+/**
+ * @brief Trace files start with this header, followed by chunks of
+ * [u32 record count][u32 compressed size][lz_codec block].
+ *
+ * Inside a chunk each record is XORed with the one before it before compression; a
+ * sequential pc and a mostly unchanged register value then become runs of zero bytes.
+ */
+struct TraceFileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t record_size;
+};
+
+inline constexpr char kTraceMagic[8] = {'R', 'V', 'T', 'R', 'A', 'C', 'E', '\0'};
+inline constexpr uint32_t kTraceVersion = 1;
+
+/**
+ * @brief Streams records to a compressed trace file.
+ *
+ * Records are appended to one of two buffers; when it fills, a background thread compresses
+ * and writes it while the VM carries on filling the other, so the hot path is a 40-byte copy.
+ */
+class TraceWriter {
+ public:
+  static constexpr size_t kRecordsPerChunk = 1 << 14;
+
+  TraceWriter() = default;
+  ~TraceWriter();
+  TraceWriter(const TraceWriter &) = delete;
+  TraceWriter &operator=(const TraceWriter &) = delete;
+
+  /**
+   * @brief Creates the file, writes the header and starts the compression thread.
+   * @throws std::runtime_error If the file cannot be created.
+   */
+  void Open(const std::filesystem::path &filename);
+
+  /**
+   * @brief Writes the records still buffered and closes the file.
+   * @throws std::runtime_error If a chunk could not be written.
+   */
+  void Close();
+
+  [[nodiscard]] bool IsOpen() const {
+    return open_;
+  }
+
+  [[nodiscard]] uint64_t GetRecordCount() const {
+    return record_count_;
+  }
+
+  void Append(const TraceRecord &record) {
+    buffers_[active_][fill_++] = record;
+    ++record_count_;
+    if (fill_ == kRecordsPerChunk) {
+      SubmitActive();
+    }
+  }
+
+ private:
+  std::vector<TraceRecord> buffers_[2];
+  size_t active_ = 0;
+  size_t fill_ = 0;
+  uint64_t record_count_ = 0;
+  bool open_ = false;
+
+  std::ofstream file_;
+  std::thread worker_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool pending_ = false; ///< A full buffer is waiting for, or being written by, the worker.
+  size_t pending_buffer_ = 0;
+  size_t pending_count_ = 0;
+  bool stopping_ = false;
+  bool failed_ = false;
+
+  void SubmitActive();
+  void WorkerLoop();
+  void WriteChunk(const TraceRecord *records, size_t count);
+  void Stop();
+};
+
+/**
+ * @brief Reads a trace file written by TraceWriter, one chunk in memory at a time.
+ */
+class TraceReader {
+ public:
+  /**
+   * @throws std::runtime_error If the file cannot be opened or is not a trace.
+   */
+  explicit TraceReader(const std::filesystem::path &filename);
+
+  /**
+   * @brief Reads the next record.
+   * @return false at the end of the trace.
+   * @throws std::runtime_error If a chunk is truncated or corrupt.
+   */
+  bool Next(TraceRecord &record);
+
+  /**
+   * @brief Index of the next record Next will return.
+   */
+  [[nodiscard]] uint64_t GetPosition() const {
+    return position_;
+  }
+
+ private:
+  std::ifstream file_;
+  std::vector<TraceRecord> chunk_;
+  size_t chunk_index_ = 0;
+  uint64_t position_ = 0;
+
+  bool ReadChunk();
+};
+
+/**
+ * @brief Formats a record as one line: index, pc, instruction word, register write and memory access.
+ */
+std::string FormatTraceRecord(uint64_t index, const TraceRecord &record);
+
+#endif // TRACE_H
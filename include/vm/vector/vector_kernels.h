@@ -0,0 +1,65 @@
+/**
+ * @file vector_kernels.h
+ * @brief Contains the element-wise kernels behind the vector unit, with AVX2, SSE2 and scalar versions.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef VECTOR_KERNELS_H
+#define VECTOR_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace rvv {
+
+/**
+ * @brief The instruction set the kernels use on the host.
+ */
+enum class HostIsa {
+  kScalar,
+  kSse2,
+  kAvx2, ///< AVX2 together with FMA.
+};
+
+/**
+ * @brief The best HostIsa this host supports; kScalar on anything but x86-64.
+ */
+HostIsa DetectHostIsa();
+
+std::string HostIsaName(HostIsa isa);
+
+enum class IntOp {
+  kAdd, kSub, kRsub, kAnd, kOr, kXor,
+  kMinu, kMin, kMaxu, kMax,
+  kSll, kSrl, kSra,
+  kMul, kMulh, kMulhu, kMulhsu,
+  kDivu, kDiv, kRemu, kRem,
+  kMacc, kNmsac,
+};
+
+enum class FpOp {
+  kAdd, kSub, kRsub, kMul, kDiv, kRdiv,
+  kMin, kMax,
+  kSgnj, kSgnjn, kSgnjx,
+  kMacc, kNmsac,
+};
+
+/**
+ * @brief out[i] = a[i] op b[i] for the first n elements of sew bits, with RISC-V semantics (shift
+ *        amounts taken modulo sew, division by zero and overflow as in the M extension).
+ *
+ * a holds vs2 and b holds vs1 or the splatted scalar. For kMacc and kNmsac, out holds vd on entry
+ * and is accumulated into. out may be the same buffer as a or b.
+ */
+void IntKernel(HostIsa isa, IntOp op, unsigned int sew, size_t n, const uint8_t *a, const uint8_t *b, uint8_t *out);
+
+/**
+ * @brief The floating-point counterpart of IntKernel, for sew 32 and 64.
+ *
+ * Results round to nearest-even and every NaN result is the canonical NaN; no flags are raised.
+ */
+void FpKernel(HostIsa isa, FpOp op, unsigned int sew, size_t n, const uint8_t *a, const uint8_t *b, uint8_t *out);
+
+} // namespace rvv
+
+#endif // VECTOR_KERNELS_H
@@ -0,0 +1,71 @@
+/**
+ * @file vector_unit.h
+ * @brief Contains the VectorUnit class, which executes the RVV 1.0 subset the assembler accepts.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef VECTOR_UNIT_H
+#define VECTOR_UNIT_H
+
+#include "vector_kernels.h"
+
+#include <cstdint>
+#include <vector>
+
+class RegisterFile;
+class MemoryController;
+struct StepDelta;
+
+namespace rvv {
+
+/**
+ * @brief Executes vector instructions against a hart's RegisterFile and memory.
+ *
+ * Supported: vsetvli/vsetivli/vsetvl; unit-stride and strided loads and stores of 8 to 64-bit
+ * elements; integer add, subtract, logic, shifts, min/max, multiply, divide and multiply-add;
+ * compares into a mask; merges and moves; sum and logic reductions; mask logic, vcpop, vfirst
+ * and vid; and for 32 and 64-bit elements, FP add, subtract, multiply, divide, min/max,
+ * sign injection, fused multiply-add, compares and reductions.
+ *
+ * Tail and masked-off elements are left undisturbed, which the agnostic policies allow. vstart
+ * is always 0: an instruction either completes or throws before changing anything. Arithmetic
+ * goes through the kernels in vector_kernels.h; compares, reductions, moves and memory access
+ * are scalar loops.
+ */
+class VectorUnit {
+ public:
+  VectorUnit();
+
+  /**
+   * @brief Uses the best SIMD kernels the host has, or only the scalar ones.
+   */
+  void SetHostSimd(bool enabled);
+
+  [[nodiscard]] HostIsa GetHostIsa() const {
+    return isa_;
+  }
+
+  /**
+   * @brief Executes one vector instruction and records what it changed in delta: GPR, FPR and CSR
+   *        writes, 64-bit slices of the vector register file (reg_type 3) and stored bytes.
+   * @throws std::runtime_error For a reserved encoding, an illegal vtype, a misaligned register
+   *         group or an instruction this unit does not implement.
+   */
+  void Execute(uint32_t instruction, RegisterFile &registers, MemoryController &memory, StepDelta &delta);
+
+ private:
+  HostIsa detected_; ///< What the host supports, detected once.
+  HostIsa isa_;
+
+  // Scratch space for splatted scalars and results, sized for eight registers.
+  std::vector<uint8_t> operand_;
+  std::vector<uint8_t> result_;
+  std::vector<uint8_t> saved_; ///< Destination registers before the instruction, for the delta.
+
+  void ExecuteConfig(uint32_t instruction, RegisterFile &registers, StepDelta &delta);
+  void ExecuteMemory(uint32_t instruction, RegisterFile &registers, MemoryController &memory, StepDelta &delta);
+  void ExecuteArithmetic(uint32_t instruction, RegisterFile &registers, StepDelta &delta);
+};
+
+} // namespace rvv
+
+#endif // VECTOR_UNIT_H
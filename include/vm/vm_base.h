@@ -10,6 +10,19 @@
 #include "registers.h"
 #include "memory_controller.h"
 #include "alu.h"
+#include "branch_predictor.h"
+#include "cache/cache.h"
+#include "breakpoints.h"
+#include "edge_coverage.h"
+#include "guest_io.h"
+#include "perf_counters.h"
+#include "profiler.h"
+#include "state_publisher.h"
+#include "timing_model.h"
+#include "trace.h"
+#include "watchpoints.h"
+#include "vm_context.h"
+#include "vm_snapshot.h"
 
 #include "vm_asm_mw.h"
 
@@ -21,6 +34,7 @@
 #include <condition_variable>
 #include <queue>
 #include <atomic>
+#include <chrono>
 
 enum SyscallCode {
     SYSCALL_PRINT_INT = 1,
@@ -28,14 +42,27 @@ enum SyscallCode {
     SYSCALL_PRINT_DOUBLE = 3,
     SYSCALL_PRINT_STRING = 4,
     SYSCALL_EXIT = 10,
+    SYSCALL_OPENAT = 56,
+    SYSCALL_CLOSE = 57,
+    SYSCALL_LSEEK = 62,
     SYSCALL_READ = 63,
     SYSCALL_WRITE = 64,
+    SYSCALL_EXIT_LINUX = 93,
 };
 
 
 class VmBase {
 public:
-    VmBase() = default;
+    /**
+     * @param context Configuration and dump paths for this instance. Defaults to a snapshot of
+     *                the process-wide settings; headless runs (batch mode, several VMs per
+     *                process) pass their own, usually with dump_state off.
+     */
+    explicit VmBase(VmContext context = VmContext::FromGlobals())
+        : context_(std::move(context)), memory_controller_(context_.config) {
+        registers_.SetVectorLength(context_.config.getVectorLength());
+        ApplyRandomSeed();
+    }
     ~VmBase() = default;
 
     AssembledProgram program_;
@@ -44,41 +71,120 @@ public:
     std::condition_variable input_cv_;
     std::queue<std::string> input_queue_;
 
-    std::vector<uint64_t> breakpoints_;
+    BreakpointSet breakpoints_;
+    WatchpointSet watchpoints_; ///< Kept across loads and resets, like the addresses they watch.
 
     uint32_t current_instruction_{};
     uint64_t program_counter_{};
     
-    unsigned int cycle_s_{};
-    unsigned int instructions_retired_{};
+    uint64_t cycle_s_{};
+    uint64_t instructions_retired_{};
     float cpi_{};
     float ipc_{};
-    unsigned int stall_cycles_{};
-    unsigned int branch_mispredictions_{};
+    uint64_t stall_cycles_{};
+    uint64_t branch_mispredictions_{};
 
     std::string output_status_;
 
-    
-
-
+    unsigned int hart_id_ = 0; ///< Read by the guest from mhartid.
+    bool exited_ = false; ///< Set once the program makes an exit syscall.
+    uint64_t exit_code_ = 0;
 
+    VmContext context_; ///< Read instead of vm_config::config and globals; declared before the members built from it.
     MemoryController memory_controller_;
     RegisterFile registers_;
     
     alu::Alu alu_;
+    GuestIo guest_io_;
+    Profiler profiler_;
+    BranchPredictor branch_predictor_; ///< Scores every branch and jump when BranchPrediction/branch_prediction_type is set.
+    cache::Cache data_cache_; ///< Looks up every load and store when Cache/cache_enabled is set; misses stall.
+    TimingModel timing_model_; ///< Charges operation latencies and register dependencies when Timing/timing_enabled is set.
+    PerfCounters perf_counters_; ///< Only counted when built with ENABLE_PERF_COUNTERS.
+    TraceWriter trace_writer_;
+    EdgeCoverage *coverage_ = nullptr; ///< When set, every taken branch and jump is recorded in it (the fuzzer's map).
+    StatePublisher state_publisher_; ///< What other threads read while this VM runs.
+
 
+    /**
+     * @brief Loads an assembled program, taking ownership of it.
+     *
+     * The text and data sections are each written to memory with a single block copy.
+     * @param program The assembled program; pass an rvalue to avoid copying it.
+     */
+    void LoadProgram(AssembledProgram program);
 
-    void LoadProgram(const AssembledProgram &program);
+    /**
+     * @brief Loads an ELF64 RISC-V executable produced by an external toolchain.
+     *
+     * PT_LOAD segments are copied into memory page by page, the program counter is set to
+     * e_entry and the .symtab symbols become the program's symbol table.
+     * @param filename Path to the ELF file.
+     * @throws std::runtime_error If the file is not a loadable RISC-V ELF64 executable.
+     */
+    void LoadElfProgram(const std::string &filename);
     uint64_t program_size_ = 0;
+    uint64_t text_start_ = 0;
+    std::shared_ptr<const AssembledProgram> shared_program_; ///< Copy of program_ handed to snapshots; dropped by loads.
+
+    /**
+     * @brief Captures memory, registers, program counter, program and configuration.
+     *
+     * No memory block is copied: the snapshot shares them with this VM, which copies a block
+     * the first time it writes to it afterwards. Call between runs, not while executing.
+     */
+    VmSnapshot Snapshot();
+
+    /**
+     * @brief Replaces this VM's state with a copy-on-write fork of snapshot.
+     *
+     * Only the blocks the fork writes are copied, so repeated forks of one snapshot cost about
+     * what each run touches. Guest I/O, devices, the profiler, the branch predictor and the
+     * trace restart as after a load.
+     */
+    virtual void Fork(const VmSnapshot &snapshot);
+
+    /**
+     * @brief Writes registers, CSRs, counters, breakpoints, the program and every non-zero
+     *        memory page to a compressed state image (see state_image.h).
+     *
+     * Takes a snapshot first, so memory is shared rather than copied. Call between runs.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void SaveState(const std::filesystem::path &filename);
+
+    /**
+     * @brief Replaces this VM's state with one written by SaveState, here or on another machine.
+     *
+     * The memory size, block size and vector length come from the image; the rest of the
+     * configuration is this VM's. Guest I/O, devices and the trace restart as after a load.
+     * @throws std::runtime_error If the file is not a readable state image.
+     */
+    void RestoreState(const std::filesystem::path &filename);
 
     uint64_t GetProgramCounter() const;
     void UpdateProgramCounter(int64_t value);
     
     int32_t ImmGenerator(uint32_t instruction);
 
-    void AddBreakpoint(uint64_t val, bool is_line = true);
+    /**
+     * @brief Adds a breakpoint at a source line or instruction address.
+     * @param condition Expression over registers and memory; the breakpoint only counts a hit
+     *                  when it is non-zero. Empty for an unconditional breakpoint.
+     * @param hit_count DebugRun stops on the hit_count-th hit and every hit after it.
+     */
+    void AddBreakpoint(uint64_t val, bool is_line = true, const std::string &condition = "", uint64_t hit_count = 1);
     void RemoveBreakpoint(uint64_t val, bool is_line = true);
     bool CheckBreakpoint(uint64_t address);
+    void AddSymbolBreakpoint(const std::string &symbol, const std::string &condition = "", uint64_t hit_count = 1);
+    void RemoveSymbolBreakpoint(const std::string &symbol);
+
+    /**
+     * @brief Watches guest loads and/or stores touching [address, address + length).
+     * @param kind "r", "w" or "rw".
+     */
+    void AddWatchpoint(uint64_t address, uint64_t length, const std::string &kind);
+    void RemoveWatchpoint(uint64_t address);
 
     // void fetchInstruction();
     // void decodeInstruction();
@@ -87,23 +193,161 @@ public:
     // void writeback();
 
     // void HandleSyscall();
+
+    /**
+     * @brief Reads a NUL-terminated string from guest memory a block at a time.
+     * @param address Address of the first character.
+     * @return The string, without the terminator.
+     */
+    std::string ReadString(uint64_t address);
     void PrintString(uint64_t address);
 
+    /**
+     * @brief Resets the guest I/O state and applies the [Syscall] configuration to it.
+     * @throws std::runtime_error If the configured stdin file cannot be read.
+     */
+    void SetupGuestIo();
+
+    /**
+     * @brief Maps the UART, CLINT timer, DMA and matrix engines at Memory/mmio_base, or no devices
+     *        when Memory/mmio_enabled is off.
+     */
+    void SetupMmio();
+
+    /**
+     * @brief Reseeds the ALU from Execution/random_seed, if one is configured.
+     */
+    void ApplyRandomSeed();
+
+    /**
+     * @brief Starts profiling the loaded program if Execution/profiling_enabled is set.
+     * @param entry Address execution starts at.
+     */
+    void SetupProfiler(uint64_t entry);
+
+    /**
+     * @brief Writes the profile report and folded stacks, if profiling and state dumps are enabled.
+     */
+    void WriteProfile();
+
+    /**
+     * @brief Builds the configured branch predictor model and clears the misprediction count.
+     */
+    void SetupBranchPredictor();
+
+    /**
+     * @brief Builds the configured data cache model, or disables it.
+     * @throws std::invalid_argument If the [Cache] geometry is invalid.
+     */
+    void SetupCache();
+
+    /**
+     * @brief Loads the configured latency table into the timing model, or disables it.
+     */
+    void SetupTiming();
+
+    /**
+     * @brief Writes vm_state/branch_report.txt, if the branch predictor model and state dumps are enabled.
+     */
+    void WriteBranchReport();
+
+    /**
+     * @brief Starts a new trace file if Execution/trace_file is set, closing any previous one.
+     */
+    void SetupTrace();
+
+    /**
+     * @brief Flushes and closes the trace file, if one is open.
+     */
+    void CloseTrace();
+
+    /**
+     * @brief Copies cycle, instret and the hpmcounters into their CSRs (0xC00-0xC1F).
+     *
+     * Called before a CSR instruction reads a counter and before registers are dumped, so
+     * the counters cost nothing on instructions that do not look at them.
+     */
+    void SyncCounterCsrs();
+
+    /**
+     * @brief Writes vm_state/perf_counters.json, if perf counters are compiled in and state dumps are enabled.
+     */
+    void WritePerfCounters();
+
+    /**
+     * @brief Counts executed instructions towards the next publication of the state.
+     *
+     * Costs a decrement per call; the clock is only read every kPublishClockCheck instructions.
+     */
+    void TickStatePublisher(uint64_t instructions) {
+        if (instructions < publish_countdown_) {
+            publish_countdown_ -= instructions;
+        } else {
+            MaybePublishState();
+        }
+    }
+
+    /**
+     * @brief Publishes registers and counters, and a memory view if a reader asked for one.
+     * @param running False for the last publication of a run.
+     */
+    void PublishState(bool running);
+
+    /**
+     * @brief Reads Execution/publish_interval_instructions and publish_interval_ms and restarts
+     *        the intervals. Called at the start of every run.
+     */
+    void SetupStatePublisher();
+
     virtual void Run() = 0;
     virtual void DebugRun() = 0;
     virtual void Step() = 0;
     virtual void Undo() = 0;
     virtual void Redo() = 0;
     virtual void Reset() = 0;
+
+    /**
+     * @brief Recomputes cpi_ and ipc_ from the cycle and instruction counts.
+     */
+    void UpdateCpi();
+
     void DumpState(const std::filesystem::path &filename);
 
+    /**
+     * @brief Writes the register and VM state dump files, unless state dumps are disabled.
+     */
+    void DumpRegistersAndState();
+
     void ModifyRegister(const std::string &reg_name, uint64_t value);
+
+    /**
+     * @brief Sets the index the guest reads from mhartid; kept across resets.
+     */
+    void SetHartId(unsigned int hart_id) {
+        hart_id_ = hart_id;
+        registers_.WriteCsr(kCsrMhartid, hart_id);
+    }
     void PushInput(const std::string& input) {
         std::lock_guard<std::mutex> lock(input_mutex_);
         input_queue_.push(input);
         input_cv_.notify_one();
     }
 
+private:
+    static constexpr uint64_t kPublishClockCheck = 4096;
+
+    /**
+     * @brief Publishes if an interval has passed or a reader wants a memory view.
+     */
+    void MaybePublishState();
+
+    uint64_t publish_countdown_ = kPublishClockCheck; ///< Instructions until MaybePublishState runs.
+    uint64_t publish_check_interval_ = kPublishClockCheck;
+    uint64_t publish_interval_instructions_ = 0;
+    std::chrono::milliseconds publish_interval_{0};
+    uint64_t last_published_instret_ = 0;
+    std::chrono::steady_clock::time_point last_publish_time_;
+
 };
 
 #endif // VM_BASE_H
@@ -0,0 +1,79 @@
+/**
+ * @file vm_context.h
+ * @brief Contains the VmContext struct, the per-instance environment of a VM.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef VM_CONTEXT_H
+#define VM_CONTEXT_H
+
+#include "../config.h"
+#include "../globals.h"
+
+#include <filesystem>
+
+/**
+ * @brief Files a VM writes its state to.
+ */
+struct VmStatePaths {
+  std::filesystem::path directory; ///< The vm_state directory; guest files default to directory/guest_fs.
+  std::filesystem::path disassembly;
+  std::filesystem::path registers;
+  std::filesystem::path memory;
+  std::filesystem::path cache;
+  std::filesystem::path vm_state;
+  std::filesystem::path profile_report;
+  std::filesystem::path profile_folded;
+  std::filesystem::path perf_counters;
+  std::filesystem::path branch_report;
+
+  /**
+   * @brief Uses the standard file names inside the given directory.
+   */
+  static VmStatePaths InDirectory(const std::filesystem::path &directory) {
+    return {directory,
+            directory / "disassembly.txt",
+            directory / "registers_dump.json",
+            directory / "memory_dump.json",
+            directory / "cache_dump.json",
+            directory / "vm_state_dump.json",
+            directory / "profile_report.txt",
+            directory / "profile.folded",
+            directory / "perf_counters.json",
+            directory / "branch_report.txt"};
+  }
+};
+
+/**
+ * @brief Everything a VM instance reads from its environment.
+ *
+ * Each VM keeps its own copy, so several VMs with different settings can run in one process
+ * and the hot paths read plain members instead of process-wide globals.
+ */
+struct VmContext {
+  vm_config::VmConfig config;
+  VmStatePaths paths;
+  bool dump_state = true; ///< Write the vm_state files; off for headless runs.
+  bool vm_as_backend = false; ///< Wrap guest stdout in VM_STDOUT_START/END markers for the frontend.
+
+  /**
+   * @brief Snapshot of the process-wide configuration, the default for interactive use.
+   */
+  static VmContext FromGlobals() {
+    VmContext context;
+    context.config = vm_config::config;
+    context.paths = {globals::vm_state_directory,
+                     globals::disassembly_file_path,
+                     globals::registers_dump_file_path,
+                     globals::memory_dump_file_path,
+                     globals::cache_dump_file_path,
+                     globals::vm_state_dump_file_path,
+                     globals::vm_state_directory / "profile_report.txt",
+                     globals::vm_state_directory / "profile.folded",
+                     globals::vm_state_directory / "perf_counters.json",
+                     globals::vm_state_directory / "branch_report.txt"};
+    context.vm_as_backend = globals::vm_as_backend;
+    return context;
+  }
+};
+
+#endif // VM_CONTEXT_H
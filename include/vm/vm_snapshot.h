@@ -0,0 +1,41 @@
+/**
+ * @file vm_snapshot.h
+ * @brief Contains the VmSnapshot struct, a frozen copy of a VM that forks share copy-on-write.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef VM_SNAPSHOT_H
+#define VM_SNAPSHOT_H
+
+#include "../config.h"
+#include "main_memory.h"
+#include "registers.h"
+#include "vm_asm_mw.h"
+
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief The architectural state of a VM at one point: memory, registers (including CSRs),
+ *        program counter, program and configuration.
+ *
+ * The memory is never written after the snapshot is taken; each fork gets its own table over
+ * the same blocks and copies a block the first time it writes to it. Device registers, open
+ * guest files and the profiler are not captured; a fork starts them afresh.
+ * Copying a VmSnapshot is cheap, and changing its config before forking (say, stdin_file)
+ * gives the fork a different environment.
+ */
+struct VmSnapshot {
+  vm_config::VmConfig config;
+  std::shared_ptr<Memory> memory;
+  std::shared_ptr<const AssembledProgram> program;
+  RegisterFile registers;
+  uint64_t program_counter = 0;
+  uint64_t text_start = 0;
+  uint64_t program_size = 0;
+  uint64_t instructions_retired = 0;
+  uint64_t cycles = 0;
+  bool exited = false;
+  uint64_t exit_code = 0;
+};
+
+#endif // VM_SNAPSHOT_H
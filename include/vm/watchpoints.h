@@ -0,0 +1,103 @@
+/**
+ * @file watchpoints.h
+ * @brief Contains the WatchpointSet class, which stops execution on guest loads and stores.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef WATCHPOINTS_H
+#define WATCHPOINTS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+inline constexpr uint8_t kWatchRead = 1 << 0;
+inline constexpr uint8_t kWatchWrite = 1 << 1;
+
+/**
+ * @brief Parses "r", "w" or "rw".
+ * @throws std::invalid_argument For anything else.
+ */
+uint8_t ParseWatchKind(const std::string &kind);
+
+const char *WatchKindName(uint8_t kind);
+
+/**
+ * @brief Memory watchpoints, with a page-granular filter in front of the exact range check.
+ *
+ * Every watched 4 KiB page sets the read/write flags of its slot in a small direct-mapped
+ * table. A load or store first tests the flags of the slots of its first and last byte;
+ * only when a flag is set (a watched page, or another page sharing the slot) are the
+ * watchpoint ranges compared. Unwatched accesses cost two array reads.
+ */
+class WatchpointSet {
+ public:
+  static constexpr unsigned int kPageShift = 12;
+  static constexpr size_t kPageSlots = 4096;
+
+  struct Watchpoint {
+    uint64_t address;
+    uint64_t length;
+    uint8_t kind; ///< kWatchRead and/or kWatchWrite.
+    uint64_t hits;
+  };
+
+  /**
+   * @brief Adds a watchpoint, or replaces the length and kind of the one at the same address.
+   * @throws std::invalid_argument If the length is 0, the range wraps around or the kind is empty.
+   */
+  void Add(uint64_t address, uint64_t length, uint8_t kind);
+
+  /**
+   * @return Whether a watchpoint started at address.
+   */
+  bool Remove(uint64_t address);
+
+  void Clear();
+
+  [[nodiscard]] bool Empty() const {
+    return watchpoints_.empty();
+  }
+
+  /**
+   * @brief The fast filter: whether the access touches a page with a watchpoint of this kind.
+   * @param access kWatchRead or kWatchWrite.
+   */
+  [[nodiscard]] bool IsPageWatched(uint64_t address, uint64_t size, uint8_t access) const {
+    uint8_t flags = page_flags_[(address >> kPageShift) % kPageSlots]
+                    | page_flags_[((address + size - 1) >> kPageShift) % kPageSlots];
+    return (flags & access) != 0;
+  }
+
+  /**
+   * @brief The exact check: finds the first watchpoint overlapping the access and counts the hit.
+   * @return The watchpoint, or nullptr if the page matched but no range did.
+   */
+  const Watchpoint *Match(uint64_t address, uint64_t size, uint8_t access);
+
+  [[nodiscard]] const std::vector<Watchpoint> &GetWatchpoints() const {
+    return watchpoints_;
+  }
+
+ private:
+  std::vector<Watchpoint> watchpoints_;
+  std::array<uint8_t, kPageSlots> page_flags_{};
+
+  void RebuildPageFlags();
+};
+
+/**
+ * @brief A triggered watchpoint, reported after the accessing instruction has completed.
+ */
+struct WatchpointHit {
+  uint64_t pc;
+  uint64_t address;
+  uint64_t size;
+  bool is_write;
+  uint64_t old_value; ///< The accessed bytes before the instruction.
+  uint64_t new_value; ///< The accessed bytes after it; equal to old_value for a load.
+  WatchpointSet::Watchpoint watchpoint;
+};
+
+#endif // WATCHPOINTS_H
@@ -33,4 +33,14 @@ struct AssembledProgram {
   std::vector<uint32_t> text_buffer;
 };
 
+/**
+ * @brief Lays out the program's data directives as one contiguous byte image.
+ *
+ * Each value is aligned to its natural size, matching the layout the VM uses for the
+ * data section, so the image can be copied into memory in a single block write.
+ * @param program The assembled program.
+ * @return The data section bytes, starting at offset 0 of the data section.
+ */
+std::vector<uint8_t> SerializeDataSection(const AssembledProgram &program);
+
 #endif // VM_ASM_MW_H
\ No newline at end of file
@@ -0,0 +1,120 @@
+/**
+ * @file yolo_bench.h
+ * @brief Convolution-layer benchmark built from a Darknet YOLO config, run in each custom number format.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+#ifndef YOLO_BENCH_H
+#define YOLO_BENCH_H
+
+#include "vm/vm_context.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @namespace yolo_bench
+ * @brief The workload behind `vm --yolo-bench <cfg>`.
+ *
+ * The [convolutional] layers of a Darknet config (e.g. yolov4-tiny.cfg) are read with the input
+ * shape each one sees, following the [route], [maxpool], [upsample] and [yolo] layers between
+ * them. For a chosen layer a tile of its output is computed on random activations and weights by
+ * a generated assembly kernel, once per number format: fp32 with `fmadd.s`, and the packed
+ * `fmadd.fp16`, `fmadd.bf16` and `fmadd.msfp16` ops, which compute four output channels per
+ * instruction. Each run is compared against a double-precision reference of the same tile.
+ */
+namespace yolo_bench {
+
+enum class NumberFormat {
+  kFp32,
+  kFp16,
+  kBf16,
+  kMsfp16,
+};
+
+struct ConvLayer {
+  size_t index = 0;         ///< Among the [convolutional] sections, from 0.
+  size_t darknet_layer = 0; ///< Among all layers after [net], as Darknet numbers them.
+  unsigned int filters = 0;
+  unsigned int size = 1;
+  unsigned int stride = 1;
+  unsigned int pad = 0; ///< Zero border on each side, size/2 when the config says pad=1.
+  bool leaky = false;   ///< activation=leaky; anything else is treated as linear.
+  unsigned int in_channels = 0;
+  unsigned int in_height = 0;
+  unsigned int in_width = 0;
+  unsigned int out_height = 0;
+  unsigned int out_width = 0;
+};
+
+/**
+ * @brief One layer tile with its data: the top-left tile x tile outputs of the layer.
+ *
+ * input holds the padded input window in [y][x][c] order, weights are [filter][ky][kx][c] with
+ * batch normalisation already folded in, and the expected output is [y][x][filter].
+ */
+struct Workload {
+  ConvLayer layer;
+  unsigned int tile = 0;     ///< Output rows and columns computed.
+  unsigned int channels = 0; ///< Input channels used, at most layer.in_channels.
+  unsigned int filters = 0;  ///< Output channels computed, at most layer.filters.
+  unsigned int window = 0;   ///< Rows and columns of the input window, (tile - 1)*stride + size.
+  std::vector<float> input;
+  std::vector<float> weights;
+  std::vector<float> bias;
+  std::vector<float> reference; ///< Computed in double precision and rounded once.
+};
+
+struct KernelResult {
+  NumberFormat format = NumberFormat::kFp32;
+  uint64_t instructions = 0;
+  uint64_t cycles = 0; ///< One per instruction unless the VM models timing.
+  double wall_time_ms = 0;
+  double max_abs_error = 0;
+  double rms_rel_error = 0; ///< RMS of the error over RMS of the reference.
+  std::vector<float> output;
+};
+
+/**
+ * @brief Reads the convolutional layers of a Darknet config.
+ * @throws std::runtime_error If the file cannot be read, has no [net] section, or a layer refers
+ *                            to one that does not exist.
+ */
+std::vector<ConvLayer> ParseConvLayers(const std::filesystem::path &cfg);
+
+/**
+ * @brief Generates the data for a tile of a layer.
+ * @param tile Output rows and columns, clamped to the layer's output size.
+ * @param max_channels Caps the input and output channels; 0 keeps the layer's own.
+ */
+Workload MakeWorkload(const ConvLayer &layer, unsigned int tile, unsigned int max_channels, uint64_t seed);
+
+/**
+ * @brief Writes a self-contained assembly program that computes the workload's tile in a format,
+ *        leaving the result at the `output` data label, in the format's own encoding.
+ */
+std::string GenerateKernel(const Workload &workload, NumberFormat format);
+
+/**
+ * @brief Assembles source_path (written by GenerateKernel) and runs it to completion on a fresh VM.
+ * @throws std::runtime_error If the program does not assemble or does not exit.
+ */
+KernelResult RunKernel(const Workload &workload, NumberFormat format, const std::filesystem::path &source_path,
+                       VmContext context);
+
+std::string FormatName(NumberFormat format);
+
+/**
+ * @throws std::invalid_argument If the name is not fp32, fp16, bf16 or msfp16.
+ */
+NumberFormat ParseFormat(const std::string &name);
+
+void PrintLayers(const std::vector<ConvLayer> &layers, std::ostream &os);
+
+void PrintReport(const Workload &workload, const std::vector<KernelResult> &results, std::ostream &os);
+
+} // namespace yolo_bench
+
+#endif // YOLO_BENCH_H
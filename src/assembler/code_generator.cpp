@@ -306,6 +306,66 @@ uint32_t generateFDSTypeMachineCode(const ICUnit &block) {
   return machineCode;
 }
 
+uint32_t generateVTypeMachineCode(const ICUnit &block) {
+  const auto &encoding = instruction_set::V_type_instruction_encoding_map.at(block.getOpcode());
+  const uint32_t rd = extractRegisterIndex(block.getRd());
+  // The vs1/rs1 field holds a register, a 5-bit immediate, or a fixed sub-opcode.
+  uint32_t rs1 = encoding.rs1.to_ulong();
+  if (!block.getRs1().empty()) {
+    rs1 = extractRegisterIndex(block.getRs1());
+  } else if (!block.getImm().empty()) {
+    rs1 = static_cast<uint32_t>(std::stoi(block.getImm())) & 0b11111;
+  }
+  const uint32_t rs2 = block.getRs2().empty() ? encoding.rs2.to_ulong() : extractRegisterIndex(block.getRs2());
+  const uint32_t vm = block.isMasked() ? 0 : encoding.vm;
+
+  uint32_t machineCode = 0;
+  machineCode |= (encoding.funct6.to_ulong() << 26);
+  machineCode |= (vm << 25);
+  machineCode |= (rs2 << 20);
+  machineCode |= (rs1 << 15);
+  machineCode |= (encoding.funct3.to_ulong() << 12);
+  machineCode |= (rd << 7);
+  machineCode |= encoding.opcode.to_ulong();
+  return machineCode;
+}
+
+uint32_t generateVMemTypeMachineCode(const ICUnit &block) {
+  const auto &encoding = instruction_set::V_mem_type_instruction_encoding_map.at(block.getOpcode());
+  const uint32_t rd = extractRegisterIndex(block.getRd()); // vd for loads, vs3 for stores
+  const uint32_t rs1 = extractRegisterIndex(block.getRs1());
+  const uint32_t rs2 = block.getRs2().empty() ? 0 : extractRegisterIndex(block.getRs2());
+  const uint32_t vm = block.isMasked() ? 0 : 1;
+
+  uint32_t machineCode = 0;
+  machineCode |= (encoding.mop.to_ulong() << 26);
+  machineCode |= (vm << 25);
+  machineCode |= (rs2 << 20);
+  machineCode |= (rs1 << 15);
+  machineCode |= (encoding.width.to_ulong() << 12);
+  machineCode |= (rd << 7);
+  machineCode |= encoding.opcode.to_ulong();
+  return machineCode;
+}
+
+uint32_t generateVConfigMachineCode(const ICUnit &block) {
+  const uint32_t rd = extractRegisterIndex(block.getRd());
+  uint32_t machineCode = 0b1010111 | (0b111 << 12) | (rd << 7);
+  if (block.getOpcode()=="vsetvli") {
+    machineCode |= (extractRegisterIndex(block.getRs1()) << 15);
+    machineCode |= ((block.getVtype() & 0x7FF) << 20);
+  } else if (block.getOpcode()=="vsetivli") {
+    machineCode |= ((static_cast<uint32_t>(std::stoi(block.getImm())) & 0b11111) << 15);
+    machineCode |= ((block.getVtype() & 0x3FF) << 20);
+    machineCode |= (0b11u << 30);
+  } else {
+    machineCode |= (extractRegisterIndex(block.getRs1()) << 15);
+    machineCode |= (extractRegisterIndex(block.getRs2()) << 20);
+    machineCode |= (0b1000000u << 25);
+  }
+  return machineCode;
+}
+
 std::vector<uint32_t> generateMachineCode(const std::vector<std::pair<ICUnit, bool>> &IntermediateCode) {
   std::vector<uint32_t> machine_code;
   for (const auto &pair : IntermediateCode) {
@@ -345,6 +405,12 @@ std::vector<uint32_t> generateMachineCode(const std::vector<std::pair<ICUnit, bo
       code = generateFDITypeMachineCode(block);
     } else if (instruction_set::isValidFDSTypeInstruction(block.getOpcode())) {
       code = generateFDSTypeMachineCode(block);
+    } else if (instruction_set::isValidVTypeInstruction(block.getOpcode())) {
+      code = generateVTypeMachineCode(block);
+    } else if (instruction_set::isValidVMemTypeInstruction(block.getOpcode())) {
+      code = generateVMemTypeMachineCode(block);
+    } else if (instruction_set::isValidVConfigInstruction(block.getOpcode())) {
+      code = generateVConfigMachineCode(block);
     } else {
       throw std::runtime_error("Invalid instruction type: " + block.getOpcode());
     }
@@ -7,6 +7,13 @@
 #include <fstream>
 #include <variant>
 #include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 void generateElfFile(const AssembledProgram &program, const std::string &output_filename) {
   std::ofstream elfFile(output_filename, std::ios::binary);
@@ -22,11 +29,13 @@ void generateElfFile(const AssembledProgram &program, const std::string &output_
   elfHeader.e_shnum = 4;  // Now we have 4 sections: NULL, .text, .data, .shstrtab
   elfHeader.e_shstrndx = 3;  // Index of .shstrtab
 
+  std::vector<uint8_t> data_image = SerializeDataSection(program);
+
   // Section Header String Table (stores section names)
   std::string shstrtab = "\0.text\0.data\0.shstrtab\0";
   uint32_t shstrtab_offset = sizeof(ElfHeader) + 3*sizeof(ElfSectionHeader)
       + program.text_buffer.size()*sizeof(uint32_t)
-      + program.data_buffer.size();
+      + data_image.size();
   uint32_t text_offset = sizeof(ElfHeader) + 3*sizeof(ElfSectionHeader);
   uint32_t data_offset = text_offset + program.text_buffer.size()*sizeof(uint32_t);
 
@@ -35,7 +44,7 @@ void generateElfFile(const AssembledProgram &program, const std::string &output_
   ElfSectionHeader textSection = {1, 1, 6, 0x1000, text_offset,
                                   static_cast<uint32_t>(program.text_buffer.size()*sizeof(uint32_t)), 0, 0, 4, 0};
   ElfSectionHeader dataSection = {7, 1, 3, 0x2000, data_offset,
-                                  static_cast<uint32_t>(program.data_buffer.size()), 0, 0, 4, 0};
+                                  static_cast<uint32_t>(data_image.size()), 0, 0, 4, 0};
   ElfSectionHeader shstrtabSection = {13, 3, 0, 0, shstrtab_offset,
                                       static_cast<uint32_t>(shstrtab.size()), 0, 0, 1, 0};
 
@@ -54,24 +63,136 @@ void generateElfFile(const AssembledProgram &program, const std::string &output_
   }
 
   // Write `.data` section (raw binary data)
-  for (const auto &data : program.data_buffer) {
-    if (std::holds_alternative<uint8_t>(data)) {
-      uint8_t value = std::get<uint8_t>(data);
-      elfFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
-    } else if (std::holds_alternative<uint16_t>(data)) {
-      uint16_t value = std::get<uint16_t>(data);
-      elfFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
-    } else if (std::holds_alternative<uint32_t>(data)) {
-      uint32_t value = std::get<uint32_t>(data);
-      elfFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
-    } else if (std::holds_alternative<uint64_t>(data)) {
-      uint64_t value = std::get<uint64_t>(data);
-      elfFile.write(reinterpret_cast<const char *>(&value), sizeof(value));
-    }
-  }
+  elfFile.write(reinterpret_cast<const char *>(data_image.data()), static_cast<std::streamsize>(data_image.size()));
 
   // Write `.shstrtab` section
   elfFile.write(shstrtab.c_str(), shstrtab.size());
 
   std::cout << "ELF file generated: " << output_filename << std::endl;
 }
+
+
+template<typename T>
+const T *ElfFile::at(uint64_t offset, uint64_t count) const {
+  if (offset > size_ || count > (size_ - offset)/sizeof(T)) {
+    throw std::runtime_error("ELF file truncated: offset " + std::to_string(offset) + " out of range");
+  }
+  return reinterpret_cast<const T *>(mapping_ + offset);
+}
+
+ElfFile::ElfFile(const std::string &filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Failed to open ELF file: " + filename);
+  }
+  struct stat st{};
+  if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(Elf64Header))) {
+    ::close(fd);
+    throw std::runtime_error("Invalid ELF file: " + filename);
+  }
+  size_ = static_cast<size_t>(st.st_size);
+  void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::runtime_error("Failed to map ELF file: " + filename);
+  }
+  mapping_ = static_cast<const uint8_t *>(mapping);
+
+  try {
+    const Elf64Header &header = *at<Elf64Header>(0);
+    if (std::memcmp(header.e_ident, "\x7F" "ELF", 4) != 0) {
+      throw std::runtime_error("Not an ELF file: " + filename);
+    }
+    if (header.e_ident[4] != kElfClass64 || header.e_ident[5] != kElfDataLsb) {
+      throw std::runtime_error("Only little-endian ELF64 files are supported: " + filename);
+    }
+    if (header.e_machine != kElfMachineRiscv) {
+      throw std::runtime_error("ELF file is not a RISC-V executable: " + filename);
+    }
+    entry_ = header.e_entry;
+    parseProgramHeaders(header);
+    parseSymbolTable(header);
+  } catch (...) {
+    ::munmap(const_cast<uint8_t *>(mapping_), size_);
+    throw;
+  }
+}
+
+ElfFile::~ElfFile() {
+  if (mapping_) {
+    ::munmap(const_cast<uint8_t *>(mapping_), size_);
+  }
+}
+
+void ElfFile::parseProgramHeaders(const Elf64Header &header) {
+  if (header.e_phnum == 0) {
+    throw std::runtime_error("ELF file has no program headers");
+  }
+  if (header.e_phentsize != sizeof(Elf64ProgramHeader)) {
+    throw std::runtime_error("Unexpected ELF program header size");
+  }
+  const auto *phdrs = at<Elf64ProgramHeader>(header.e_phoff, header.e_phnum);
+  for (uint16_t i = 0; i < header.e_phnum; ++i) {
+    const Elf64ProgramHeader &ph = phdrs[i];
+    if (ph.p_type != kElfPtLoad || ph.p_memsz == 0) {
+      continue;
+    }
+    if (ph.p_filesz > ph.p_memsz) {
+      throw std::runtime_error("Malformed PT_LOAD segment: file size exceeds memory size");
+    }
+    const uint8_t *bytes = at<uint8_t>(ph.p_offset, ph.p_filesz);
+    segments_.push_back({ph.p_vaddr, ph.p_memsz, {bytes, ph.p_filesz}, (ph.p_flags & kElfPfExecute) != 0});
+  }
+}
+
+void ElfFile::parseSymbolTable(const Elf64Header &header) {
+  if (header.e_shnum == 0 || header.e_shoff == 0) {
+    return; // stripped binary, nothing to load
+  }
+  if (header.e_shentsize != sizeof(Elf64SectionHeader)) {
+    throw std::runtime_error("Unexpected ELF section header size");
+  }
+  const auto *shdrs = at<Elf64SectionHeader>(header.e_shoff, header.e_shnum);
+  for (uint16_t i = 0; i < header.e_shnum; ++i) {
+    const Elf64SectionHeader &sh = shdrs[i];
+    if (sh.sh_type != kElfShtSymtab || sh.sh_link >= header.e_shnum) {
+      continue;
+    }
+    const Elf64SectionHeader &strtab = shdrs[sh.sh_link];
+    const char *names = at<char>(strtab.sh_offset, strtab.sh_size);
+    const auto *syms = at<Elf64Symbol>(sh.sh_offset, sh.sh_size/sizeof(Elf64Symbol));
+    for (uint64_t j = 0; j < sh.sh_size/sizeof(Elf64Symbol); ++j) {
+      const Elf64Symbol &sym = syms[j];
+      uint8_t type = sym.st_info & 0xF;
+      if (sym.st_name == 0 || sym.st_name >= strtab.sh_size || sym.st_shndx == 0) {
+        continue;
+      }
+      if (type != kElfSttFunc && type != kElfSttObject && type != kElfSttNotype) {
+        continue; // sections, files, TLS
+      }
+      std::string name(names + sym.st_name, strnlen(names + sym.st_name, strtab.sh_size - sym.st_name));
+      if (name.empty() || name[0] == '$') {
+        continue; // mapping symbols
+      }
+      bool is_function = type == kElfSttFunc;
+      if (type == kElfSttNotype) {
+        for (const auto &segment : segments_) {
+          if (segment.executable && sym.st_value >= segment.vaddr && sym.st_value < segment.vaddr + segment.mem_size) {
+            is_function = true;
+            break;
+          }
+        }
+      }
+      symbols_.push_back({std::move(name), sym.st_value, sym.st_size, is_function});
+    }
+  }
+}
+
+bool isElfFile(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  char magic[4] = {};
+  if (!file.read(magic, sizeof(magic))) {
+    return false;
+  }
+  return std::memcmp(magic, "\x7F" "ELF", 4) == 0;
+}
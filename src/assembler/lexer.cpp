@@ -10,6 +10,7 @@
 #include "common/instructions.h"
 #include "vm/registers.h"
 #include"common/rounding_modes.h"
+#include "common/vtype.h"
 
 #include <utility>
 #include <string>
@@ -85,7 +86,7 @@ Token Lexer::identifier() {
   }
   std::string value = current_line_.substr(start_pos, pos_ - start_pos);
 
-  std::regex label_regex("^[a-zA-Z][a-zA-Z0-9_]*:$");
+  static const std::regex label_regex("^[a-zA-Z][a-zA-Z0-9_]*:$");
 
   if (pos_ < current_line_.size() && current_line_[pos_]==':') {
     if (value.find('.')!=std::string::npos) {
@@ -110,10 +111,19 @@ Token Lexer::identifier() {
   if (IsValidCsr(value)) {
     return {TokenType::CSR_REGISTER, value, line_number_, start_column};
   }
+  if (IsValidVectorRegister(value)) {
+    return {TokenType::VEC_REGISTER, value, line_number_, start_column};
+  }
+  if (value=="v0.t") {
+    return {TokenType::VEC_MASK, value, line_number_, start_column};
+  }
 
   if (isValidRoundingMode(value)) {
     return {TokenType::RM, value, line_number_, start_column};
   }
+  if (isValidVtypeField(value)) {
+    return {TokenType::VTYPE, value, line_number_, start_column};
+  }
 
   if (pos_ < current_line_.size() && current_line_[pos_]==':') {
     return {TokenType::LABEL, value, line_number_, start_column};
@@ -153,11 +163,11 @@ Token Lexer::number() {
 
   std::string value = current_line_.substr(start_pos, pos_ - start_pos);
 
-  std::regex hex_regex("^-?0[xX][0-9a-fA-F]+$");
-  std::regex binary_regex("^-?0[bB][01]+$");
-  std::regex octal_regex("^-?0[oO][0-7]+$");
-  std::regex decimal_regex("^-?[0-9]+$");
-  std::regex float_regex("^-?[0-9]*\\.[0-9]+([eE][-+]?[0-9]+)?$|^-?[0-9]+[eE][-+]?[0-9]+$");
+  static const std::regex hex_regex("^-?0[xX][0-9a-fA-F]+$");
+  static const std::regex binary_regex("^-?0[bB][01]+$");
+  static const std::regex octal_regex("^-?0[oO][0-7]+$");
+  static const std::regex decimal_regex("^-?[0-9]+$");
+  static const std::regex float_regex("^-?[0-9]*\\.[0-9]+([eE][-+]?[0-9]+)?$|^-?[0-9]+[eE][-+]?[0-9]+$");
 
   if (std::regex_match(value, hex_regex)) {
     bool is_negative = value[0]=='-';
@@ -0,0 +1,264 @@
+/**
+ * File Name: v_formats.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include "assembler/parser.h"
+#include "common/instructions.h"
+#include "common/vtype.h"
+#include "vm/registers.h"
+#include "utils.h"
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+bool Parser::parseVectorOperands(const std::string &operands, const std::string &fields) {
+  const unsigned int line = currentToken().line_number;
+  auto on_line = [this, line](int n) {
+    return peekToken(n).type!=TokenType::EOF_ && peekToken(n).line_number==line;
+  };
+
+  std::vector<Token> values;
+  std::vector<std::string> vtype_fields;
+  int n = 1;
+  for (size_t i = 0; i < operands.size(); ++i) {
+    if (i > 0) {
+      if (!on_line(n) || peekToken(n).type!=TokenType::COMMA) {
+        return false;
+      }
+      n++;
+    }
+    if (!on_line(n)) {
+      return false;
+    }
+    switch (operands[i]) {
+      case 'v':
+        if (peekToken(n).type!=TokenType::VEC_REGISTER) {
+          return false;
+        }
+        break;
+      case 'x':
+        if (peekToken(n).type!=TokenType::GP_REGISTER) {
+          return false;
+        }
+        break;
+      case 'f':
+        if (peekToken(n).type!=TokenType::FP_REGISTER) {
+          return false;
+        }
+        break;
+      case 'i':
+        if (peekToken(n).type!=TokenType::NUM) {
+          return false;
+        }
+        break;
+      case '0':
+        if (peekToken(n).type!=TokenType::VEC_REGISTER || peekToken(n).value!="v0") {
+          return false;
+        }
+        break;
+      case 'm':
+        if (peekToken(n).type!=TokenType::LPAREN
+            || !on_line(n + 1) || peekToken(n + 1).type!=TokenType::GP_REGISTER
+            || !on_line(n + 2) || peekToken(n + 2).type!=TokenType::RPAREN) {
+          return false;
+        }
+        n++;
+        break;
+      case 't':
+        // e32, m2, ta, ma: one or more fields, each separated by a comma.
+        if (peekToken(n).type!=TokenType::VTYPE) {
+          return false;
+        }
+        vtype_fields.push_back(peekToken(n).value);
+        while (on_line(n + 1) && peekToken(n + 1).type==TokenType::COMMA
+            && on_line(n + 2) && peekToken(n + 2).type==TokenType::VTYPE) {
+          n += 2;
+          vtype_fields.push_back(peekToken(n).value);
+        }
+        break;
+      default:
+        return false;
+    }
+    values.push_back(peekToken(n));
+    n += operands[i]=='m' ? 2 : 1;
+  }
+
+  bool masked = false;
+  if (instruction_set::isMaskableVInstruction(currentToken().value)
+      && on_line(n) && peekToken(n).type==TokenType::COMMA
+      && on_line(n + 1) && peekToken(n + 1).type==TokenType::VEC_MASK) {
+    masked = true;
+    n += 2;
+  }
+  if (on_line(n)) {
+    return false;
+  }
+
+  uint32_t vtype = 0;
+  if (!vtype_fields.empty()) {
+    try {
+      vtype = encodeVtype(vtype_fields);
+    } catch (const std::invalid_argument &) {
+      return false;
+    }
+  }
+
+  ICUnit block;
+  block.setOpcode(currentToken().value);
+  block.setLineNumber(line);
+  block.setInstructionIndex(instruction_index_);
+  block.setMasked(masked);
+  block.setVtype(vtype);
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    const Token &token = values[i];
+    std::string value = token.value;
+    if (token.type==TokenType::GP_REGISTER || token.type==TokenType::FP_REGISTER) {
+      value = reg_alias_to_name.at(token.value);
+    }
+    switch (fields[i]) {
+      case 'd': block.setRd(value);
+        break;
+      case '1': block.setRs1(value);
+        break;
+      case '2': block.setRs2(value);
+        break;
+      case 'i': {
+        // Shift amounts and the vsetivli AVL are unsigned; every other immediate is simm5.
+        const std::string &op = currentToken().value;
+        bool is_unsigned = op=="vsetivli" || op=="vsll.vi" || op=="vsrl.vi" || op=="vsra.vi";
+        int64_t low = is_unsigned ? 0 : -16;
+        int64_t high = is_unsigned ? 31 : 15;
+        int64_t imm = std::stoll(value);
+        if (imm < low || imm > high) {
+          errors_.count++;
+          recordError(ParseError(token.line_number, "Immediate value out of range"));
+          errors_.all_errors.emplace_back(errors::ImmediateOutOfRangeError("Immediate value out of range",
+                                                                           "Expected: " + std::to_string(low)
+                                                                               + " <= imm <= " + std::to_string(high),
+                                                                           filename_,
+                                                                           token.line_number,
+                                                                           token.column_number,
+                                                                           GetLineFromFile(filename_,
+                                                                                           token.line_number)));
+          skipCurrentLine();
+          return true;
+        }
+        block.setImm(std::to_string(imm));
+        break;
+      }
+      default: break;
+    }
+  }
+
+  skipCurrentLine();
+  intermediate_code_.emplace_back(block, true);
+  instruction_number_line_number_mapping_[instruction_index_] = block.getLineNumber();
+  instruction_index_++;
+  return true;
+}
+
+// vsetvli rd, rs1, e32, m1, ta, ma
+bool Parser::parse_O_GPR_C_GPR_C_VTYPE() {
+  return parseVectorOperands("xxt", "d1t");
+}
+
+// vsetivli rd, uimm, e32, m1, ta, ma
+bool Parser::parse_O_GPR_C_I_C_VTYPE() {
+  return parseVectorOperands("xit", "dit");
+}
+
+// vd, vs2, vs1; the multiply-adds name vs1 before vs2.
+bool Parser::parse_O_VR_C_VR_C_VR() {
+  const std::string &op = currentToken().value;
+  if (op=="vmacc.vv" || op=="vnmsac.vv" || op=="vfmacc.vv" || op=="vfnmsac.vv") {
+    return parseVectorOperands("vvv", "d12");
+  }
+  return parseVectorOperands("vvv", "d21");
+}
+
+bool Parser::parse_O_VR_C_VR_C_GPR() {
+  return parseVectorOperands("vvx", "d21");
+}
+
+bool Parser::parse_O_VR_C_VR_C_I() {
+  return parseVectorOperands("vvi", "d2i");
+}
+
+bool Parser::parse_O_VR_C_VR_C_FPR() {
+  return parseVectorOperands("vvf", "d21");
+}
+
+// vmacc.vx vd, rs1, vs2
+bool Parser::parse_O_VR_C_GPR_C_VR() {
+  return parseVectorOperands("vxv", "d12");
+}
+
+// vfmacc.vf vd, rs1, vs2
+bool Parser::parse_O_VR_C_FPR_C_VR() {
+  return parseVectorOperands("vfv", "d12");
+}
+
+// vmerge.vvm vd, vs2, vs1, v0
+bool Parser::parse_O_VR_C_VR_C_VR_C_V0() {
+  return parseVectorOperands("vvv0", "d21-");
+}
+
+bool Parser::parse_O_VR_C_VR_C_GPR_C_V0() {
+  return parseVectorOperands("vvx0", "d21-");
+}
+
+bool Parser::parse_O_VR_C_VR_C_I_C_V0() {
+  return parseVectorOperands("vvi0", "d2i-");
+}
+
+bool Parser::parse_O_VR_C_VR_C_FPR_C_V0() {
+  return parseVectorOperands("vvf0", "d21-");
+}
+
+// vmv.v.v vd, vs1
+bool Parser::parse_O_VR_C_VR() {
+  return parseVectorOperands("vv", "d1");
+}
+
+// vmv.v.x/vmv.s.x vd, rs1
+bool Parser::parse_O_VR_C_GPR() {
+  return parseVectorOperands("vx", "d1");
+}
+
+bool Parser::parse_O_VR_C_I() {
+  return parseVectorOperands("vi", "di");
+}
+
+// vfmv.v.f/vfmv.s.f vd, rs1
+bool Parser::parse_O_VR_C_FPR() {
+  return parseVectorOperands("vf", "d1");
+}
+
+// vmv.x.s/vcpop.m/vfirst.m rd, vs2
+bool Parser::parse_O_GPR_C_VR() {
+  return parseVectorOperands("xv", "d2");
+}
+
+// vfmv.f.s rd, vs2
+bool Parser::parse_O_FPR_C_VR() {
+  return parseVectorOperands("fv", "d2");
+}
+
+// vid.v vd
+bool Parser::parse_O_VR() {
+  return parseVectorOperands("v", "d");
+}
+
+// vle32.v vd, (rs1) and vse32.v vs3, (rs1); the store data register goes in rd's place.
+bool Parser::parse_O_VR_C_LP_GPR_RP() {
+  return parseVectorOperands("vm", "d1");
+}
+
+// vlse32.v vd, (rs1), rs2
+bool Parser::parse_O_VR_C_LP_GPR_RP_C_GPR() {
+  return parseVectorOperands("vmx", "d12");
+}
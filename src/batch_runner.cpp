@@ -0,0 +1,263 @@
+/**
+ * @file batch_runner.cpp
+ * @brief Contains the implementation of the batch runner.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "batch_runner.h"
+
+#include "assembler/assembler.h"
+#include "assembler/elf_util.h"
+#include "common/null_stream.h"
+#include "utils.h"
+#include "vm/registers.h"
+#include "vm/rvss/rvss_vm.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace batch_runner {
+
+namespace {
+
+uint64_t ParseValue(const std::string &text) {
+  if (!text.empty() && text[0] == '-') {
+    return static_cast<uint64_t>(std::stoll(text, nullptr, 0));
+  }
+  return std::stoull(text, nullptr, 0);
+}
+
+std::string ToHex(uint64_t value) {
+  std::ostringstream os;
+  os << "0x" << std::hex << value;
+  return os.str();
+}
+
+std::string Mismatch(char prefix, uint64_t location, uint64_t expected, uint64_t actual) {
+  std::ostringstream os;
+  if (prefix == 'm') {
+    os << "mem " << ToHex(location);
+  } else {
+    os << prefix << location;
+  }
+  os << ": expected " << ToHex(expected) << ", got " << ToHex(actual);
+  return os.str();
+}
+
+bool IsProgramFile(const std::filesystem::path &path) {
+  if (!std::filesystem::is_regular_file(path)) {
+    return false;
+  }
+  if (path.extension() == ".s") {
+    return true;
+  }
+  return path.extension() != ".expected" && path.extension() != ".stdin" && isElfFile(path.string());
+}
+
+void CompareResults(RVSSVM &vm, const ExpectedResult &expected, std::vector<std::string> &failures) {
+  for (const auto &[reg, value] : expected.gprs) {
+    uint64_t actual = vm.registers_.ReadGpr(reg);
+    if (actual != value) {
+      failures.push_back(Mismatch('x', reg, value, actual));
+    }
+  }
+  for (const auto &[reg, value] : expected.fprs) {
+    uint64_t actual = vm.registers_.ReadFpr(reg);
+    if (actual != value) {
+      failures.push_back(Mismatch('f', reg, value, actual));
+    }
+  }
+  for (const auto &region : expected.memory) {
+    std::vector<uint8_t> actual(region.bytes.size());
+    vm.memory_controller_.ReadBlock(region.address, actual);
+    auto [expected_it, actual_it] = std::mismatch(region.bytes.begin(), region.bytes.end(), actual.begin());
+    if (expected_it != region.bytes.end()) {
+      uint64_t address = region.address + static_cast<uint64_t>(expected_it - region.bytes.begin());
+      failures.push_back(Mismatch('m', address, *expected_it, *actual_it));
+    }
+  }
+  if (expected.stdout_text && vm.guest_io_.GetCapturedStdout() != *expected.stdout_text) {
+    failures.push_back("stdout: expected \"" + *expected.stdout_text + "\", got \""
+                           + vm.guest_io_.GetCapturedStdout() + "\"");
+  }
+  if (expected.exit_code) {
+    if (!vm.exited_) {
+      failures.push_back("exit: expected " + std::to_string(*expected.exit_code) + ", program did not exit");
+    } else if (vm.exit_code_ != *expected.exit_code) {
+      failures.push_back("exit: expected " + std::to_string(*expected.exit_code) + ", got "
+                             + std::to_string(vm.exit_code_));
+    }
+  }
+}
+
+} // namespace
+
+ExpectedResult ParseExpectedFile(const std::filesystem::path &filename) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    throw std::runtime_error("Unable to open expected file: " + filename.string());
+  }
+
+  ExpectedResult expected;
+  std::string line;
+  unsigned int line_number = 0;
+  while (std::getline(file, line)) {
+    ++line_number;
+    std::istringstream tokens(line);
+    std::string key;
+    if (!(tokens >> key) || key[0] == '#') {
+      continue;
+    }
+    try {
+      if (key == "reg") {
+        std::string name, value;
+        if (!(tokens >> name >> value)) {
+          throw std::invalid_argument("expected 'reg <name> <value>'");
+        }
+        std::string reg = reg_alias_to_name.at(name);
+        size_t index = std::stoul(reg.substr(1));
+        (reg[0] == 'f' ? expected.fprs : expected.gprs).emplace_back(index, ParseValue(value));
+      } else if (key == "mem") {
+        std::string address, byte;
+        if (!(tokens >> address)) {
+          throw std::invalid_argument("expected 'mem <address> <bytes...>'");
+        }
+        MemoryExpectation region{ParseValue(address), {}};
+        while (tokens >> byte) {
+          region.bytes.push_back(static_cast<uint8_t>(std::stoul(byte, nullptr, 16)));
+        }
+        expected.memory.push_back(std::move(region));
+      } else if (key == "stdout") {
+        std::string text;
+        std::getline(tokens >> std::ws, text);
+        expected.stdout_text = expected.stdout_text.value_or("") + ParseEscapedString(text);
+      } else if (key == "exit") {
+        std::string value;
+        if (!(tokens >> value)) {
+          throw std::invalid_argument("expected 'exit <code>'");
+        }
+        expected.exit_code = ParseValue(value);
+      } else {
+        throw std::invalid_argument("unknown key '" + key + "'");
+      }
+    } catch (const std::logic_error &e) {
+      throw std::runtime_error(filename.string() + ":" + std::to_string(line_number) + ": " + e.what());
+    }
+  }
+  return expected;
+}
+
+ProgramResult RunProgram(const std::filesystem::path &program) {
+  ProgramResult result;
+  result.program = program;
+  auto start = std::chrono::steady_clock::now();
+
+  try {
+    std::filesystem::path expected_path = std::filesystem::path(program).replace_extension(".expected");
+    std::optional<ExpectedResult> expected;
+    if (std::filesystem::exists(expected_path)) {
+      expected = ParseExpectedFile(expected_path);
+    }
+
+    VmContext context = VmContext::FromGlobals();
+    context.dump_state = false;
+    context.vm_as_backend = false;
+    RVSSVM vm(std::move(context));
+    if (isElfFile(program.string())) {
+      vm.LoadElfProgram(program.string());
+    } else {
+      vm.LoadProgram(assemble(program.string(), false));
+    }
+    vm.guest_io_.SetCaptureOutput(true);
+    // Without a .stdin file, reads from fd 0 see EOF instead of waiting for vm_stdin.
+    std::filesystem::path stdin_path = std::filesystem::path(program).replace_extension(".stdin");
+    vm.guest_io_.PreloadStdin(std::filesystem::exists(stdin_path) ? stdin_path : "/dev/null");
+
+    vm.Run();
+    result.instructions_retired = vm.instructions_retired_;
+
+    if (!vm.exited_ && vm.program_counter_ < vm.program_size_) {
+      result.failures.push_back("did not finish within " + std::to_string(vm.instructions_retired_)
+                                    + " instructions");
+    }
+    if (expected) {
+      result.checked = true;
+      CompareResults(vm, *expected, result.failures);
+    }
+  } catch (const std::exception &e) {
+    result.failures.emplace_back(e.what());
+  }
+
+  result.wall_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  result.passed = result.failures.empty();
+  return result;
+}
+
+std::vector<ProgramResult> RunBatch(const std::filesystem::path &directory, unsigned int jobs) {
+  std::vector<std::filesystem::path> programs;
+  for (const auto &entry : std::filesystem::directory_iterator(directory)) {
+    if (IsProgramFile(entry.path())) {
+      programs.push_back(entry.path());
+    }
+  }
+  std::sort(programs.begin(), programs.end());
+
+  if (jobs == 0) {
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+  }
+  jobs = std::min<unsigned int>(jobs, std::max<size_t>(programs.size(), 1));
+
+  std::vector<ProgramResult> results(programs.size());
+  std::atomic<size_t> next_program = 0;
+  auto worker = [&]() {
+    for (size_t i = next_program++; i < programs.size(); i = next_program++) {
+      results[i] = RunProgram(programs[i]);
+    }
+  };
+
+  // The VMs report their status on std::cout; nobody is listening in batch mode.
+  NullBuffer null_buffer;
+  std::streambuf *cout_buffer = std::cout.rdbuf(&null_buffer);
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < jobs; ++i) {
+    workers.emplace_back(worker);
+  }
+  for (auto &thread : workers) {
+    thread.join();
+  }
+  std::cout.rdbuf(cout_buffer);
+
+  return results;
+}
+
+bool PrintReport(const std::vector<ProgramResult> &results, std::ostream &os) {
+  size_t passed = 0, unchecked = 0, failed = 0;
+  for (const auto &result : results) {
+    const char *status = !result.passed ? "FAIL" : (result.checked ? "PASS" : "RAN ");
+    os << status << "  " << result.program.filename().string()
+       << "  instret=" << result.instructions_retired
+       << "  time=" << std::fixed << std::setprecision(2) << result.wall_time_ms << " ms\n";
+    for (const auto &failure : result.failures) {
+      os << "      " << failure << "\n";
+    }
+    if (!result.passed) {
+      ++failed;
+    } else if (result.checked) {
+      ++passed;
+    } else {
+      ++unchecked;
+    }
+  }
+  os << results.size() << " programs: " << passed << " passed, " << unchecked
+     << " ran without an expected file, " << failed << " failed" << std::endl;
+  return failed == 0;
+}
+
+} // namespace batch_runner
@@ -50,12 +50,22 @@ Command ParseCommand(const std::string &input) {
     command_type = command_handler::CommandType::PRINT_MEMORY;
   } else if (command_str=="get_mem_point" || command_str=="gmp") {
     command_type = command_handler::CommandType::GET_MEMORY_POINT;
+  } else if (command_str=="get_state" || command_str=="gst") {
+    command_type = command_handler::CommandType::GET_STATE;
+  } else if (command_str=="save_state") {
+    command_type = command_handler::CommandType::SAVE_STATE;
+  } else if (command_str=="restore_state") {
+    command_type = command_handler::CommandType::RESTORE_STATE;
   } else if (command_str=="dump_cache") {
     command_type = command_handler::CommandType::DUMP_CACHE;
   } else if (command_str=="add_breakpoint") {
     command_type = command_handler::CommandType::ADD_BREAKPOINT;
   } else if (command_str=="remove_breakpoint") {
     command_type = command_handler::CommandType::REMOVE_BREAKPOINT;
+  } else if (command_str=="add_watchpoint") {
+    command_type = command_handler::CommandType::ADD_WATCHPOINT;
+  } else if (command_str=="remove_watchpoint") {
+    command_type = command_handler::CommandType::REMOVE_WATCHPOINT;
   } else if (command_str=="vm_stdin" || command_str=="vmsin") {
     command_type = command_handler::CommandType::VM_STDIN;
   }
@@ -300,6 +300,10 @@ static const std::unordered_set<std::string> valid_instructions = {
     "mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu",
     "mulw", "divw", "divuw", "remw", "remuw",
 
+    // A Extension
+    "lr.w", "sc.w", "amoswap.w", "amoadd.w", "amoxor.w", "amoand.w", "amoor.w", "amomin.w", "amomax.w", "amominu.w", "amomaxu.w",
+    "lr.d", "sc.d", "amoswap.d", "amoadd.d", "amoxor.d", "amoand.d", "amoor.d", "amomin.d", "amomax.d", "amominu.d", "amomaxu.d",
+
     // RV64F
     "flw", "fsw", "fmadd.s", "fmsub.s", "fnmsub.s", "fnmadd.s",
     "fadd.s", "fsub.s", "fmul.s", "fdiv.s", "fsqrt.s",
@@ -333,7 +337,27 @@ static const std::unordered_set<std::string> valid_instructions = {
     // Quantum ALU
   "qalloc.a", "qalloc.b", "qha", "qhb", "qxa", "qxb", "qphase", "qmeas", "qnorma", "qnormb",
 
-
+    // V Extension
+    "vsetvli", "vsetivli", "vsetvl", "vle8.v", "vse8.v", "vlse8.v", "vsse8.v", "vle16.v", "vse16.v",
+    "vlse16.v", "vsse16.v", "vle32.v", "vse32.v", "vlse32.v", "vsse32.v", "vle64.v", "vse64.v", "vlse64.v",
+    "vsse64.v", "vadd.vv", "vadd.vx", "vadd.vi", "vsub.vv", "vsub.vx", "vrsub.vx", "vrsub.vi", "vminu.vv",
+    "vminu.vx", "vmin.vv", "vmin.vx", "vmaxu.vv", "vmaxu.vx", "vmax.vv", "vmax.vx", "vand.vv", "vand.vx",
+    "vand.vi", "vor.vv", "vor.vx", "vor.vi", "vxor.vv", "vxor.vx", "vxor.vi", "vsll.vv", "vsll.vx",
+    "vsll.vi", "vsrl.vv", "vsrl.vx", "vsrl.vi", "vsra.vv", "vsra.vx", "vsra.vi", "vmseq.vv", "vmseq.vx",
+    "vmseq.vi", "vmsne.vv", "vmsne.vx", "vmsne.vi", "vmsltu.vv", "vmsltu.vx", "vmslt.vv", "vmslt.vx",
+    "vmsleu.vv", "vmsleu.vx", "vmsleu.vi", "vmsle.vv", "vmsle.vx", "vmsle.vi", "vmsgtu.vx", "vmsgtu.vi",
+    "vmsgt.vx", "vmsgt.vi", "vmerge.vvm", "vmerge.vxm", "vmerge.vim", "vmv.v.v", "vmv.v.x", "vmv.v.i",
+    "vmul.vv", "vmul.vx", "vmulh.vv", "vmulh.vx", "vmulhu.vv", "vmulhu.vx", "vmulhsu.vv", "vmulhsu.vx",
+    "vdivu.vv", "vdivu.vx", "vdiv.vv", "vdiv.vx", "vremu.vv", "vremu.vx", "vrem.vv", "vrem.vx", "vmacc.vv",
+    "vmacc.vx", "vnmsac.vv", "vnmsac.vx", "vredsum.vs", "vredand.vs", "vredor.vs", "vredxor.vs",
+    "vredminu.vs", "vredmin.vs", "vredmaxu.vs", "vredmax.vs", "vmv.x.s", "vmv.s.x", "vcpop.m", "vfirst.m",
+    "vid.v", "vmandn.mm", "vmand.mm", "vmor.mm", "vmxor.mm", "vmorn.mm", "vmnand.mm", "vmnor.mm",
+    "vmxnor.mm", "vfadd.vv", "vfadd.vf", "vfsub.vv", "vfsub.vf", "vfrsub.vf", "vfmin.vv", "vfmin.vf",
+    "vfmax.vv", "vfmax.vf", "vfmul.vv", "vfmul.vf", "vfdiv.vv", "vfdiv.vf", "vfrdiv.vf", "vfsgnj.vv",
+    "vfsgnj.vf", "vfsgnjn.vv", "vfsgnjn.vf", "vfsgnjx.vv", "vfsgnjx.vf", "vmfeq.vv", "vmfeq.vf", "vmfle.vv",
+    "vmfle.vf", "vmflt.vv", "vmflt.vf", "vmfne.vv", "vmfne.vf", "vmfgt.vf", "vmfge.vf", "vfmacc.vv",
+    "vfmacc.vf", "vfnmsac.vv", "vfnmsac.vf", "vfredusum.vs", "vfredosum.vs", "vfredmin.vs", "vfredmax.vs",
+    "vfmv.v.f", "vfmerge.vfm", "vfmv.f.s", "vfmv.s.f",
 };
 
 static const std::unordered_set<std::string> RTypeInstructions = {
@@ -357,6 +381,11 @@ static const std::unordered_set<std::string> RTypeInstructions = {
 
     // M Extension RV64
     "mulw", "divw", "divuw", "remw", "remuw",
+
+    // A Extension
+    "lr.w", "sc.w", "amoswap.w", "amoadd.w", "amoxor.w", "amoand.w", "amoor.w", "amomin.w", "amomax.w", "amominu.w", "amomaxu.w",
+    "lr.d", "sc.d", "amoswap.d", "amoadd.d", "amoxor.d", "amoand.d", "amoor.d", "amomin.d", "amomax.d", "amominu.d", "amomaxu.d",
+
     // Quantum ALU
   "qalloc.a", "qalloc.b", "qha", "qhb", "qxa", "qxb", "qphase", "qmeas", "qnorma", "qnormb",
  
@@ -440,6 +469,11 @@ static const std::unordered_set<std::string> MExtensionInstructions = {
     "mulw", "divw", "divuw", "remw", "remuw",
 };
 
+static const std::unordered_set<std::string> AExtensionInstructions = {
+    "lr.w", "sc.w", "amoswap.w", "amoadd.w", "amoxor.w", "amoand.w", "amoor.w", "amomin.w", "amomax.w", "amominu.w", "amomaxu.w",
+    "lr.d", "sc.d", "amoswap.d", "amoadd.d", "amoxor.d", "amoand.d", "amoor.d", "amomin.d", "amomax.d", "amominu.d", "amomaxu.d",
+};
+
 //====================================================================================
 static const std::unordered_set<std::string> FDExtensionRTypeInstructions = {
     "fsgnj.s", "fsgnjn.s", "fsgnjx.s", "fmin.s", "fmax.s",
@@ -511,6 +545,44 @@ static const std::unordered_set<std::string> FExtensionInstructions = {
 
 static const std::unordered_set<std::string> DExtensionInstructions = {};
 
+//====================================================================================
+static const std::unordered_set<std::string> VExtensionConfigInstructions = {
+    "vsetvli", "vsetivli", "vsetvl",
+};
+
+static const std::unordered_set<std::string> VExtensionMemTypeInstructions = {
+    "vle8.v", "vse8.v", "vlse8.v", "vsse8.v", "vle16.v", "vse16.v", "vlse16.v", "vsse16.v", "vle32.v",
+    "vse32.v", "vlse32.v", "vsse32.v", "vle64.v", "vse64.v", "vlse64.v", "vsse64.v",
+};
+
+static const std::unordered_set<std::string> VExtensionTypeInstructions = {
+    "vadd.vv", "vadd.vx", "vadd.vi", "vsub.vv", "vsub.vx", "vrsub.vx", "vrsub.vi", "vminu.vv", "vminu.vx",
+    "vmin.vv", "vmin.vx", "vmaxu.vv", "vmaxu.vx", "vmax.vv", "vmax.vx", "vand.vv", "vand.vx", "vand.vi",
+    "vor.vv", "vor.vx", "vor.vi", "vxor.vv", "vxor.vx", "vxor.vi", "vsll.vv", "vsll.vx", "vsll.vi",
+    "vsrl.vv", "vsrl.vx", "vsrl.vi", "vsra.vv", "vsra.vx", "vsra.vi", "vmseq.vv", "vmseq.vx", "vmseq.vi",
+    "vmsne.vv", "vmsne.vx", "vmsne.vi", "vmsltu.vv", "vmsltu.vx", "vmslt.vv", "vmslt.vx", "vmsleu.vv",
+    "vmsleu.vx", "vmsleu.vi", "vmsle.vv", "vmsle.vx", "vmsle.vi", "vmsgtu.vx", "vmsgtu.vi", "vmsgt.vx",
+    "vmsgt.vi", "vmerge.vvm", "vmerge.vxm", "vmerge.vim", "vmv.v.v", "vmv.v.x", "vmv.v.i", "vmul.vv",
+    "vmul.vx", "vmulh.vv", "vmulh.vx", "vmulhu.vv", "vmulhu.vx", "vmulhsu.vv", "vmulhsu.vx", "vdivu.vv",
+    "vdivu.vx", "vdiv.vv", "vdiv.vx", "vremu.vv", "vremu.vx", "vrem.vv", "vrem.vx", "vmacc.vv", "vmacc.vx",
+    "vnmsac.vv", "vnmsac.vx", "vredsum.vs", "vredand.vs", "vredor.vs", "vredxor.vs", "vredminu.vs",
+    "vredmin.vs", "vredmaxu.vs", "vredmax.vs", "vmv.x.s", "vmv.s.x", "vcpop.m", "vfirst.m", "vid.v",
+    "vmandn.mm", "vmand.mm", "vmor.mm", "vmxor.mm", "vmorn.mm", "vmnand.mm", "vmnor.mm", "vmxnor.mm",
+    "vfadd.vv", "vfadd.vf", "vfsub.vv", "vfsub.vf", "vfrsub.vf", "vfmin.vv", "vfmin.vf", "vfmax.vv",
+    "vfmax.vf", "vfmul.vv", "vfmul.vf", "vfdiv.vv", "vfdiv.vf", "vfrdiv.vf", "vfsgnj.vv", "vfsgnj.vf",
+    "vfsgnjn.vv", "vfsgnjn.vf", "vfsgnjx.vv", "vfsgnjx.vf", "vmfeq.vv", "vmfeq.vf", "vmfle.vv", "vmfle.vf",
+    "vmflt.vv", "vmflt.vf", "vmfne.vv", "vmfne.vf", "vmfgt.vf", "vmfge.vf", "vfmacc.vv", "vfmacc.vf",
+    "vfnmsac.vv", "vfnmsac.vf", "vfredusum.vs", "vfredosum.vs", "vfredmin.vs", "vfredmax.vs", "vfmv.v.f",
+    "vfmerge.vfm", "vfmv.f.s", "vfmv.s.f",
+};
+
+// Vector instructions that take no v0.t operand; vmerge and vfmerge name v0 explicitly instead.
+static const std::unordered_set<std::string> VExtensionUnmaskedInstructions = {
+    "vmerge.vvm", "vmerge.vxm", "vmerge.vim", "vmv.v.v", "vmv.v.x", "vmv.v.i", "vmv.x.s", "vmv.s.x",
+    "vmandn.mm", "vmand.mm", "vmor.mm", "vmxor.mm", "vmorn.mm", "vmnand.mm", "vmnor.mm", "vmxnor.mm",
+    "vfmv.v.f", "vfmerge.vfm", "vfmv.f.s", "vfmv.s.f",
+};
+
 std::unordered_map<std::string, RTypeInstructionEncoding> R_type_instruction_encoding_map = {
     {"add", {0b0110011, 0b000, 0b0000000}}, // O_GPR_C_GPR_C_GPR
     {"sub", {0b0110011, 0b000, 0b0100000}}, // O_GPR_C_GPR_C_GPR
@@ -604,6 +676,30 @@ std::unordered_map<std::string, RTypeInstructionEncoding> R_type_instruction_enc
     {"remw", {0b0111011, 0b110, 0b0000001}}, // O_GPR_C_GPR_C_GPR
     {"remuw", {0b0111011, 0b111, 0b0000001}}, // O_GPR_C_GPR_C_GPR
 
+    // A Extension: funct7 is funct5 followed by the aq and rl bits, which are left clear
+    {"lr.w", {0b0101111, 0b010, 0b0001000}}, // O_GPR_C_LP_GPR_RP
+    {"sc.w", {0b0101111, 0b010, 0b0001100}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoswap.w", {0b0101111, 0b010, 0b0000100}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoadd.w", {0b0101111, 0b010, 0b0000000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoxor.w", {0b0101111, 0b010, 0b0010000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoand.w", {0b0101111, 0b010, 0b0110000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoor.w", {0b0101111, 0b010, 0b0100000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amomin.w", {0b0101111, 0b010, 0b1000000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amomax.w", {0b0101111, 0b010, 0b1010000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amominu.w", {0b0101111, 0b010, 0b1100000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amomaxu.w", {0b0101111, 0b010, 0b1110000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"lr.d", {0b0101111, 0b011, 0b0001000}}, // O_GPR_C_LP_GPR_RP
+    {"sc.d", {0b0101111, 0b011, 0b0001100}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoswap.d", {0b0101111, 0b011, 0b0000100}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoadd.d", {0b0101111, 0b011, 0b0000000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoxor.d", {0b0101111, 0b011, 0b0010000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoand.d", {0b0101111, 0b011, 0b0110000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amoor.d", {0b0101111, 0b011, 0b0100000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amomin.d", {0b0101111, 0b011, 0b1000000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amomax.d", {0b0101111, 0b011, 0b1010000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amominu.d", {0b0101111, 0b011, 0b1100000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+    {"amomaxu.d", {0b0101111, 0b011, 0b1110000}}, // O_GPR_C_GPR_C_LP_GPR_RP
+
 
   // Quantum ALU
   {"qalloc.a", {0b0110011, 0b000, 0b0101010}}, // O_GPR_C_GPR_C_GPR
@@ -816,6 +912,173 @@ std::unordered_map<std::string, FDITypeInstructionEncoding> F_D_I_type_instructi
     {"fld", {0b0000111, 0b011}}, // O_FPR_C_I_LP_GPR_RP, O_FPR_C_DL
 };
 
+std::unordered_map<std::string, VTypeInstructionEncoding> V_type_instruction_encoding_map = {
+    // {opcode, funct3, funct6, fixed vs1, fixed vs2, vm}
+    // funct3: OPIVV 000, OPFVV 001, OPMVV 010, OPIVI 011, OPIVX 100, OPFVF 101, OPMVX 110
+    {"vadd.vv", {0b1010111, 0b000, 0b000000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vadd.vx", {0b1010111, 0b100, 0b000000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vadd.vi", {0b1010111, 0b011, 0b000000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vsub.vv", {0b1010111, 0b000, 0b000010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vsub.vx", {0b1010111, 0b100, 0b000010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vrsub.vx", {0b1010111, 0b100, 0b000011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vrsub.vi", {0b1010111, 0b011, 0b000011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vminu.vv", {0b1010111, 0b000, 0b000100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vminu.vx", {0b1010111, 0b100, 0b000100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmin.vv", {0b1010111, 0b000, 0b000101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmin.vx", {0b1010111, 0b100, 0b000101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmaxu.vv", {0b1010111, 0b000, 0b000110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmaxu.vx", {0b1010111, 0b100, 0b000110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmax.vv", {0b1010111, 0b000, 0b000111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmax.vx", {0b1010111, 0b100, 0b000111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vand.vv", {0b1010111, 0b000, 0b001001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vand.vx", {0b1010111, 0b100, 0b001001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vand.vi", {0b1010111, 0b011, 0b001001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vor.vv", {0b1010111, 0b000, 0b001010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vor.vx", {0b1010111, 0b100, 0b001010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vor.vi", {0b1010111, 0b011, 0b001010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vxor.vv", {0b1010111, 0b000, 0b001011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vxor.vx", {0b1010111, 0b100, 0b001011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vxor.vi", {0b1010111, 0b011, 0b001011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vsll.vv", {0b1010111, 0b000, 0b100101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vsll.vx", {0b1010111, 0b100, 0b100101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vsll.vi", {0b1010111, 0b011, 0b100101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vsrl.vv", {0b1010111, 0b000, 0b101000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vsrl.vx", {0b1010111, 0b100, 0b101000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vsrl.vi", {0b1010111, 0b011, 0b101000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vsra.vv", {0b1010111, 0b000, 0b101001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vsra.vx", {0b1010111, 0b100, 0b101001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vsra.vi", {0b1010111, 0b011, 0b101001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vmseq.vv", {0b1010111, 0b000, 0b011000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmseq.vx", {0b1010111, 0b100, 0b011000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmseq.vi", {0b1010111, 0b011, 0b011000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vmsne.vv", {0b1010111, 0b000, 0b011001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmsne.vx", {0b1010111, 0b100, 0b011001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmsne.vi", {0b1010111, 0b011, 0b011001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vmsltu.vv", {0b1010111, 0b000, 0b011010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmsltu.vx", {0b1010111, 0b100, 0b011010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmslt.vv", {0b1010111, 0b000, 0b011011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmslt.vx", {0b1010111, 0b100, 0b011011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmsleu.vv", {0b1010111, 0b000, 0b011100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmsleu.vx", {0b1010111, 0b100, 0b011100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmsleu.vi", {0b1010111, 0b011, 0b011100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vmsle.vv", {0b1010111, 0b000, 0b011101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmsle.vx", {0b1010111, 0b100, 0b011101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmsle.vi", {0b1010111, 0b011, 0b011101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vmsgtu.vx", {0b1010111, 0b100, 0b011110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmsgtu.vi", {0b1010111, 0b011, 0b011110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vmsgt.vx", {0b1010111, 0b100, 0b011111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmsgt.vi", {0b1010111, 0b011, 0b011111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_I
+    {"vmerge.vvm", {0b1010111, 0b000, 0b010111, 0b00000, 0b00000, false}}, // O_VR_C_VR_C_VR_C_V0
+    {"vmerge.vxm", {0b1010111, 0b100, 0b010111, 0b00000, 0b00000, false}}, // O_VR_C_VR_C_GPR_C_V0
+    {"vmerge.vim", {0b1010111, 0b011, 0b010111, 0b00000, 0b00000, false}}, // O_VR_C_VR_C_I_C_V0
+    {"vmv.v.v", {0b1010111, 0b000, 0b010111, 0b00000, 0b00000, true}}, // O_VR_C_VR
+    {"vmv.v.x", {0b1010111, 0b100, 0b010111, 0b00000, 0b00000, true}}, // O_VR_C_GPR
+    {"vmv.v.i", {0b1010111, 0b011, 0b010111, 0b00000, 0b00000, true}}, // O_VR_C_I
+    {"vmul.vv", {0b1010111, 0b010, 0b100101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmul.vx", {0b1010111, 0b110, 0b100101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmulh.vv", {0b1010111, 0b010, 0b100111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmulh.vx", {0b1010111, 0b110, 0b100111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmulhu.vv", {0b1010111, 0b010, 0b100100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmulhu.vx", {0b1010111, 0b110, 0b100100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmulhsu.vv", {0b1010111, 0b010, 0b100110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmulhsu.vx", {0b1010111, 0b110, 0b100110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vdivu.vv", {0b1010111, 0b010, 0b100000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vdivu.vx", {0b1010111, 0b110, 0b100000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vdiv.vv", {0b1010111, 0b010, 0b100001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vdiv.vx", {0b1010111, 0b110, 0b100001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vremu.vv", {0b1010111, 0b010, 0b100010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vremu.vx", {0b1010111, 0b110, 0b100010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vrem.vv", {0b1010111, 0b010, 0b100011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vrem.vx", {0b1010111, 0b110, 0b100011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_GPR
+    {"vmacc.vv", {0b1010111, 0b010, 0b101101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmacc.vx", {0b1010111, 0b110, 0b101101, 0b00000, 0b00000, true}}, // O_VR_C_GPR_C_VR
+    {"vnmsac.vv", {0b1010111, 0b010, 0b101111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vnmsac.vx", {0b1010111, 0b110, 0b101111, 0b00000, 0b00000, true}}, // O_VR_C_GPR_C_VR
+    {"vredsum.vs", {0b1010111, 0b010, 0b000000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vredand.vs", {0b1010111, 0b010, 0b000001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vredor.vs", {0b1010111, 0b010, 0b000010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vredxor.vs", {0b1010111, 0b010, 0b000011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vredminu.vs", {0b1010111, 0b010, 0b000100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vredmin.vs", {0b1010111, 0b010, 0b000101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vredmaxu.vs", {0b1010111, 0b010, 0b000110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vredmax.vs", {0b1010111, 0b010, 0b000111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmv.x.s", {0b1010111, 0b010, 0b010000, 0b00000, 0b00000, true}}, // O_GPR_C_VR
+    {"vmv.s.x", {0b1010111, 0b110, 0b010000, 0b00000, 0b00000, true}}, // O_VR_C_GPR
+    {"vcpop.m", {0b1010111, 0b010, 0b010000, 0b10000, 0b00000, true}}, // O_GPR_C_VR
+    {"vfirst.m", {0b1010111, 0b010, 0b010000, 0b10001, 0b00000, true}}, // O_GPR_C_VR
+    {"vid.v", {0b1010111, 0b010, 0b010100, 0b10001, 0b00000, true}}, // O_VR
+    {"vmandn.mm", {0b1010111, 0b010, 0b011000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmand.mm", {0b1010111, 0b010, 0b011001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmor.mm", {0b1010111, 0b010, 0b011010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmxor.mm", {0b1010111, 0b010, 0b011011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmorn.mm", {0b1010111, 0b010, 0b011100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmnand.mm", {0b1010111, 0b010, 0b011101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmnor.mm", {0b1010111, 0b010, 0b011110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmxnor.mm", {0b1010111, 0b010, 0b011111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfadd.vv", {0b1010111, 0b001, 0b000000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfadd.vf", {0b1010111, 0b101, 0b000000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfsub.vv", {0b1010111, 0b001, 0b000010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfsub.vf", {0b1010111, 0b101, 0b000010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfrsub.vf", {0b1010111, 0b101, 0b100111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfmin.vv", {0b1010111, 0b001, 0b000100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfmin.vf", {0b1010111, 0b101, 0b000100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfmax.vv", {0b1010111, 0b001, 0b000110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfmax.vf", {0b1010111, 0b101, 0b000110, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfmul.vv", {0b1010111, 0b001, 0b100100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfmul.vf", {0b1010111, 0b101, 0b100100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfdiv.vv", {0b1010111, 0b001, 0b100000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfdiv.vf", {0b1010111, 0b101, 0b100000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfrdiv.vf", {0b1010111, 0b101, 0b100001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfsgnj.vv", {0b1010111, 0b001, 0b001000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfsgnj.vf", {0b1010111, 0b101, 0b001000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfsgnjn.vv", {0b1010111, 0b001, 0b001001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfsgnjn.vf", {0b1010111, 0b101, 0b001001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfsgnjx.vv", {0b1010111, 0b001, 0b001010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfsgnjx.vf", {0b1010111, 0b101, 0b001010, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vmfeq.vv", {0b1010111, 0b001, 0b011000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmfeq.vf", {0b1010111, 0b101, 0b011000, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vmfle.vv", {0b1010111, 0b001, 0b011001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmfle.vf", {0b1010111, 0b101, 0b011001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vmflt.vv", {0b1010111, 0b001, 0b011011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmflt.vf", {0b1010111, 0b101, 0b011011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vmfne.vv", {0b1010111, 0b001, 0b011100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vmfne.vf", {0b1010111, 0b101, 0b011100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vmfgt.vf", {0b1010111, 0b101, 0b011101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vmfge.vf", {0b1010111, 0b101, 0b011111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_FPR
+    {"vfmacc.vv", {0b1010111, 0b001, 0b101100, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfmacc.vf", {0b1010111, 0b101, 0b101100, 0b00000, 0b00000, true}}, // O_VR_C_FPR_C_VR
+    {"vfnmsac.vv", {0b1010111, 0b001, 0b101111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfnmsac.vf", {0b1010111, 0b101, 0b101111, 0b00000, 0b00000, true}}, // O_VR_C_FPR_C_VR
+    {"vfredusum.vs", {0b1010111, 0b001, 0b000001, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfredosum.vs", {0b1010111, 0b001, 0b000011, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfredmin.vs", {0b1010111, 0b001, 0b000101, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfredmax.vs", {0b1010111, 0b001, 0b000111, 0b00000, 0b00000, true}}, // O_VR_C_VR_C_VR
+    {"vfmv.v.f", {0b1010111, 0b101, 0b010111, 0b00000, 0b00000, true}}, // O_VR_C_FPR
+    {"vfmerge.vfm", {0b1010111, 0b101, 0b010111, 0b00000, 0b00000, false}}, // O_VR_C_VR_C_FPR_C_V0
+    {"vfmv.f.s", {0b1010111, 0b001, 0b010000, 0b00000, 0b00000, true}}, // O_FPR_C_VR
+    {"vfmv.s.f", {0b1010111, 0b101, 0b010000, 0b00000, 0b00000, true}}, // O_VR_C_FPR
+};
+
+std::unordered_map<std::string, VMemTypeInstructionEncoding> V_mem_type_instruction_encoding_map = {
+    // {opcode, width, mop}; width 000/101/110/111 selects 8/16/32/64-bit elements
+    {"vle8.v", {0b0000111, 0b000, 0b00}}, // O_VR_C_LP_GPR_RP
+    {"vse8.v", {0b0100111, 0b000, 0b00}}, // O_VR_C_LP_GPR_RP
+    {"vlse8.v", {0b0000111, 0b000, 0b10}}, // O_VR_C_LP_GPR_RP_C_GPR
+    {"vsse8.v", {0b0100111, 0b000, 0b10}}, // O_VR_C_LP_GPR_RP_C_GPR
+    {"vle16.v", {0b0000111, 0b101, 0b00}}, // O_VR_C_LP_GPR_RP
+    {"vse16.v", {0b0100111, 0b101, 0b00}}, // O_VR_C_LP_GPR_RP
+    {"vlse16.v", {0b0000111, 0b101, 0b10}}, // O_VR_C_LP_GPR_RP_C_GPR
+    {"vsse16.v", {0b0100111, 0b101, 0b10}}, // O_VR_C_LP_GPR_RP_C_GPR
+    {"vle32.v", {0b0000111, 0b110, 0b00}}, // O_VR_C_LP_GPR_RP
+    {"vse32.v", {0b0100111, 0b110, 0b00}}, // O_VR_C_LP_GPR_RP
+    {"vlse32.v", {0b0000111, 0b110, 0b10}}, // O_VR_C_LP_GPR_RP_C_GPR
+    {"vsse32.v", {0b0100111, 0b110, 0b10}}, // O_VR_C_LP_GPR_RP_C_GPR
+    {"vle64.v", {0b0000111, 0b111, 0b00}}, // O_VR_C_LP_GPR_RP
+    {"vse64.v", {0b0100111, 0b111, 0b00}}, // O_VR_C_LP_GPR_RP
+    {"vlse64.v", {0b0000111, 0b111, 0b10}}, // O_VR_C_LP_GPR_RP_C_GPR
+    {"vsse64.v", {0b0100111, 0b111, 0b10}}, // O_VR_C_LP_GPR_RP_C_GPR
+};
+
 std::unordered_map<std::string, FDSTypeInstructionEncoding> F_D_S_type_instruction_encoding_map = {
     {"fsw", {0b0100111, 0b010}}, // O_FPR_C_I_LP_GPR_RP
     {"fsd", {0b0100111, 0b011}}, // O_FPR_C_I_LP_GPR_RP
@@ -1019,6 +1282,29 @@ std::unordered_map<std::string, std::vector<SyntaxType>> instruction_syntax_map
     {"remw", {SyntaxType::O_GPR_C_GPR_C_GPR}},
     {"remuw", {SyntaxType::O_GPR_C_GPR_C_GPR}},
 
+    {"lr.w", {SyntaxType::O_GPR_C_LP_GPR_RP}},
+    {"sc.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoswap.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoadd.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoxor.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoand.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoor.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amomin.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amomax.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amominu.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amomaxu.w", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"lr.d", {SyntaxType::O_GPR_C_LP_GPR_RP}},
+    {"sc.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoswap.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoadd.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoxor.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoand.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amoor.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amomin.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amomax.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amominu.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+    {"amomaxu.d", {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP}},
+
 ///////////////////////////////////////////////////////////////////////////////////
 
     {"flw", {SyntaxType::O_FPR_C_I_LP_GPR_RP}},
@@ -1142,7 +1428,170 @@ std::unordered_map<std::string, std::vector<SyntaxType>> instruction_syntax_map
   {"qmeas", {SyntaxType::O_GPR_C_GPR_C_GPR}},
   {"qnorma", {SyntaxType::O_GPR_C_GPR_C_GPR}},
   {"qnormb", {SyntaxType::O_GPR_C_GPR_C_GPR}},
-  
+
+///////////////////////////////////////////////////////////////////////////////////
+
+    {"vsetvli", {SyntaxType::O_GPR_C_GPR_C_VTYPE}},
+    {"vsetivli", {SyntaxType::O_GPR_C_I_C_VTYPE}},
+    {"vsetvl", {SyntaxType::O_GPR_C_GPR_C_GPR}},
+    {"vle8.v", {SyntaxType::O_VR_C_LP_GPR_RP}},
+    {"vse8.v", {SyntaxType::O_VR_C_LP_GPR_RP}},
+    {"vlse8.v", {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR}},
+    {"vsse8.v", {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR}},
+    {"vle16.v", {SyntaxType::O_VR_C_LP_GPR_RP}},
+    {"vse16.v", {SyntaxType::O_VR_C_LP_GPR_RP}},
+    {"vlse16.v", {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR}},
+    {"vsse16.v", {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR}},
+    {"vle32.v", {SyntaxType::O_VR_C_LP_GPR_RP}},
+    {"vse32.v", {SyntaxType::O_VR_C_LP_GPR_RP}},
+    {"vlse32.v", {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR}},
+    {"vsse32.v", {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR}},
+    {"vle64.v", {SyntaxType::O_VR_C_LP_GPR_RP}},
+    {"vse64.v", {SyntaxType::O_VR_C_LP_GPR_RP}},
+    {"vlse64.v", {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR}},
+    {"vsse64.v", {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR}},
+    {"vadd.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vadd.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vadd.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vsub.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vsub.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vrsub.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vrsub.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vminu.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vminu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmin.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmin.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmaxu.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmaxu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmax.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmax.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vand.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vand.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vand.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vor.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vor.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vor.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vxor.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vxor.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vxor.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vsll.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vsll.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vsll.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vsrl.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vsrl.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vsrl.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vsra.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vsra.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vsra.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vmseq.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmseq.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmseq.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vmsne.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmsne.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmsne.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vmsltu.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmsltu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmslt.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmslt.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmsleu.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmsleu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmsleu.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vmsle.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmsle.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmsle.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vmsgtu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmsgtu.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vmsgt.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmsgt.vi", {SyntaxType::O_VR_C_VR_C_I}},
+    {"vmerge.vvm", {SyntaxType::O_VR_C_VR_C_VR_C_V0}},
+    {"vmerge.vxm", {SyntaxType::O_VR_C_VR_C_GPR_C_V0}},
+    {"vmerge.vim", {SyntaxType::O_VR_C_VR_C_I_C_V0}},
+    {"vmv.v.v", {SyntaxType::O_VR_C_VR}},
+    {"vmv.v.x", {SyntaxType::O_VR_C_GPR}},
+    {"vmv.v.i", {SyntaxType::O_VR_C_I}},
+    {"vmul.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmul.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmulh.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmulh.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmulhu.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmulhu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmulhsu.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmulhsu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vdivu.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vdivu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vdiv.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vdiv.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vremu.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vremu.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vrem.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vrem.vx", {SyntaxType::O_VR_C_VR_C_GPR}},
+    {"vmacc.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmacc.vx", {SyntaxType::O_VR_C_GPR_C_VR}},
+    {"vnmsac.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vnmsac.vx", {SyntaxType::O_VR_C_GPR_C_VR}},
+    {"vredsum.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vredand.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vredor.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vredxor.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vredminu.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vredmin.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vredmaxu.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vredmax.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmv.x.s", {SyntaxType::O_GPR_C_VR}},
+    {"vmv.s.x", {SyntaxType::O_VR_C_GPR}},
+    {"vcpop.m", {SyntaxType::O_GPR_C_VR}},
+    {"vfirst.m", {SyntaxType::O_GPR_C_VR}},
+    {"vid.v", {SyntaxType::O_VR}},
+    {"vmandn.mm", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmand.mm", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmor.mm", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmxor.mm", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmorn.mm", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmnand.mm", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmnor.mm", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmxnor.mm", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfadd.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfadd.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfsub.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfsub.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfrsub.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfmin.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfmin.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfmax.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfmax.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfmul.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfmul.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfdiv.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfdiv.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfrdiv.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfsgnj.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfsgnj.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfsgnjn.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfsgnjn.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfsgnjx.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfsgnjx.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vmfeq.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmfeq.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vmfle.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmfle.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vmflt.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmflt.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vmfne.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vmfne.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vmfgt.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vmfge.vf", {SyntaxType::O_VR_C_VR_C_FPR}},
+    {"vfmacc.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfmacc.vf", {SyntaxType::O_VR_C_FPR_C_VR}},
+    {"vfnmsac.vv", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfnmsac.vf", {SyntaxType::O_VR_C_FPR_C_VR}},
+    {"vfredusum.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfredosum.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfredmin.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfredmax.vs", {SyntaxType::O_VR_C_VR_C_VR}},
+    {"vfmv.v.f", {SyntaxType::O_VR_C_FPR}},
+    {"vfmerge.vfm", {SyntaxType::O_VR_C_VR_C_FPR_C_V0}},
+    {"vfmv.f.s", {SyntaxType::O_FPR_C_VR}},
+    {"vfmv.s.f", {SyntaxType::O_VR_C_FPR}},
 };
 
 bool isValidInstruction(const std::string &instruction) {
@@ -1199,6 +1648,10 @@ bool isValidMExtensionInstruction(const std::string &instruction) {
   return MExtensionInstructions.find(instruction)!=MExtensionInstructions.end();
 }
 
+bool isValidAExtensionInstruction(const std::string &instruction) {
+  return AExtensionInstructions.find(instruction)!=AExtensionInstructions.end();
+}
+
 bool isValidCSRRTypeInstruction(const std::string &instruction) {
   return CSRRInstructions.find(instruction)!=CSRRInstructions.end();
 }
@@ -1240,6 +1693,28 @@ bool isValidFDSTypeInstruction(const std::string &instruction) {
   return (FDExtensionSTypeInstructions.find(instruction)!=FDExtensionSTypeInstructions.end());
 }
 
+bool isValidVTypeInstruction(const std::string &instruction) {
+  return VExtensionTypeInstructions.find(instruction)!=VExtensionTypeInstructions.end();
+}
+
+bool isValidVMemTypeInstruction(const std::string &instruction) {
+  return VExtensionMemTypeInstructions.find(instruction)!=VExtensionMemTypeInstructions.end();
+}
+
+bool isValidVConfigInstruction(const std::string &instruction) {
+  return VExtensionConfigInstructions.find(instruction)!=VExtensionConfigInstructions.end();
+}
+
+bool isValidVExtensionInstruction(const std::string &instruction) {
+  return isValidVTypeInstruction(instruction) || isValidVMemTypeInstruction(instruction)
+      || isValidVConfigInstruction(instruction);
+}
+
+bool isMaskableVInstruction(const std::string &instruction) {
+  return (isValidVTypeInstruction(instruction) || isValidVMemTypeInstruction(instruction))
+      && VExtensionUnmaskedInstructions.find(instruction)==VExtensionUnmaskedInstructions.end();
+}
+
 bool isFInstruction(const uint32_t &instruction) {
   uint8_t opcode = (instruction & 0b1111111);
   uint8_t funct3 = (instruction >> 12) & 0b111;
@@ -1322,6 +1797,23 @@ bool isDInstruction(const uint32_t &instruction) {
   return false;
 }
 
+bool isVInstruction(const uint32_t &instruction) {
+  uint8_t opcode = (instruction & 0b1111111);
+  uint8_t funct3 = (instruction >> 12) & 0b111;
+
+  switch (opcode) {
+    case 0b1010111: { // OP-V
+      return true;
+    }
+    case 0b0000111: // vle/vlse
+    case 0b0100111: { // vse/vsse
+      return funct3==0b000 || funct3==0b101 || funct3==0b110 || funct3==0b111;
+    }
+    default: break;
+  }
+  return false;
+}
+
 std::string getExpectedSyntaxes(const std::string &opcode) {
   static const std::unordered_map<std::string, std::string> opcodeSyntaxMap = {
       {"nop", "nop"},
@@ -1376,6 +1868,29 @@ std::string getExpectedSyntaxes(const std::string &opcode) {
       {SyntaxType::O_GPR_C_FPR_C_RM, "<gp-reg>, <fp-reg>, <rm>"},
       {SyntaxType::O_GPR_C_FPR_C_FPR, "<gp-reg>, <fp-reg>, <fp-reg>"},
       {SyntaxType::O_FPR_C_I_LP_GPR_RP, "<fp-reg>, <imm>(<gp-reg>)"},
+      {SyntaxType::O_GPR_C_LP_GPR_RP, "<gp-reg>, (<gp-reg>)"},
+      {SyntaxType::O_GPR_C_GPR_C_LP_GPR_RP, "<gp-reg>, <gp-reg>, (<gp-reg>)"},
+      {SyntaxType::O_GPR_C_GPR_C_VTYPE, "<gp-reg>, <gp-reg>, <sew>[, <lmul>][, ta|tu][, ma|mu]"},
+      {SyntaxType::O_GPR_C_I_C_VTYPE, "<gp-reg>, <uimm>, <sew>[, <lmul>][, ta|tu][, ma|mu]"},
+      {SyntaxType::O_VR_C_VR_C_VR, "<v-reg>, <v-reg>, <v-reg>[, v0.t]"},
+      {SyntaxType::O_VR_C_VR_C_GPR, "<v-reg>, <v-reg>, <gp-reg>[, v0.t]"},
+      {SyntaxType::O_VR_C_VR_C_I, "<v-reg>, <v-reg>, <imm>[, v0.t]"},
+      {SyntaxType::O_VR_C_VR_C_FPR, "<v-reg>, <v-reg>, <fp-reg>[, v0.t]"},
+      {SyntaxType::O_VR_C_GPR_C_VR, "<v-reg>, <gp-reg>, <v-reg>[, v0.t]"},
+      {SyntaxType::O_VR_C_FPR_C_VR, "<v-reg>, <fp-reg>, <v-reg>[, v0.t]"},
+      {SyntaxType::O_VR_C_VR_C_VR_C_V0, "<v-reg>, <v-reg>, <v-reg>, v0"},
+      {SyntaxType::O_VR_C_VR_C_GPR_C_V0, "<v-reg>, <v-reg>, <gp-reg>, v0"},
+      {SyntaxType::O_VR_C_VR_C_I_C_V0, "<v-reg>, <v-reg>, <imm>, v0"},
+      {SyntaxType::O_VR_C_VR_C_FPR_C_V0, "<v-reg>, <v-reg>, <fp-reg>, v0"},
+      {SyntaxType::O_VR_C_VR, "<v-reg>, <v-reg>"},
+      {SyntaxType::O_VR_C_GPR, "<v-reg>, <gp-reg>"},
+      {SyntaxType::O_VR_C_I, "<v-reg>, <imm>"},
+      {SyntaxType::O_VR_C_FPR, "<v-reg>, <fp-reg>"},
+      {SyntaxType::O_GPR_C_VR, "<gp-reg>, <v-reg>[, v0.t]"},
+      {SyntaxType::O_FPR_C_VR, "<fp-reg>, <v-reg>"},
+      {SyntaxType::O_VR, "<v-reg>[, v0.t]"},
+      {SyntaxType::O_VR_C_LP_GPR_RP, "<v-reg>, (<gp-reg>)[, v0.t]"},
+      {SyntaxType::O_VR_C_LP_GPR_RP_C_GPR, "<v-reg>, (<gp-reg>), <gp-reg>[, v0.t]"},
   };
 
   std::string syntaxes;
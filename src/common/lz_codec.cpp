@@ -0,0 +1,155 @@
+/**
+ * @file lz_codec.cpp
+ * @brief Contains the implementation of the LZ77 block codec.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "common/lz_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace lz_codec {
+
+namespace {
+
+constexpr size_t kMinMatch = 4;
+constexpr size_t kMaxOffset = 0xFFFF;
+constexpr unsigned int kHashBits = 14;
+
+uint32_t Load32(const uint8_t *p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t Hash(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - kHashBits);
+}
+
+void WriteLength(std::vector<uint8_t> &out, size_t length) {
+  while (length >= 255) {
+    out.push_back(255);
+    length -= 255;
+  }
+  out.push_back(static_cast<uint8_t>(length));
+}
+
+void WriteSequence(std::vector<uint8_t> &out, const uint8_t *literals, size_t literal_length,
+                   size_t offset, size_t match_length) {
+  size_t match_code = match_length ? match_length - kMinMatch : 0;
+  uint8_t token = static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4)
+                                       | std::min<size_t>(match_code, 15));
+  out.push_back(token);
+  if (literal_length >= 15) {
+    WriteLength(out, literal_length - 15);
+  }
+  out.insert(out.end(), literals, literals + literal_length);
+  if (match_length == 0) {
+    return;
+  }
+  out.push_back(static_cast<uint8_t>(offset & 0xFF));
+  out.push_back(static_cast<uint8_t>(offset >> 8));
+  if (match_code >= 15) {
+    WriteLength(out, match_code - 15);
+  }
+}
+
+size_t ReadLength(const uint8_t *&ip, const uint8_t *end, size_t length) {
+  uint8_t byte;
+  do {
+    if (ip >= end) {
+      throw std::runtime_error("Corrupt compressed block: truncated length");
+    }
+    byte = *ip++;
+    length += byte;
+  } while (byte == 255);
+  return length;
+}
+
+} // namespace
+
+std::vector<uint8_t> Compress(const uint8_t *data, size_t size) {
+  std::vector<uint8_t> out;
+  out.reserve(size / 2 + 16);
+
+  // Positions are stored + 1 so that 0 means "empty".
+  std::array<uint32_t, 1u << kHashBits> table{};
+  size_t anchor = 0;
+  size_t i = 0;
+  while (i + kMinMatch <= size) {
+    uint32_t sequence = Load32(data + i);
+    uint32_t &slot = table[Hash(sequence)];
+    size_t candidate = slot;
+    slot = static_cast<uint32_t>(i + 1);
+    if (candidate == 0 || i - (candidate - 1) > kMaxOffset || Load32(data + candidate - 1) != sequence) {
+      ++i;
+      continue;
+    }
+    size_t match = candidate - 1;
+    size_t length = kMinMatch;
+    while (i + length < size && data[match + length] == data[i + length]) {
+      ++length;
+    }
+    WriteSequence(out, data + anchor, i - anchor, i - match, length);
+    i += length;
+    anchor = i;
+  }
+  WriteSequence(out, data + anchor, size - anchor, 0, 0);
+  return out;
+}
+
+std::vector<uint8_t> Decompress(const uint8_t *data, size_t size, size_t raw_size) {
+  // Checked before allocating, so a corrupt size cannot ask for more memory than the block could fill.
+  if (raw_size/kMaxExpansion > size) {
+    throw std::runtime_error("Corrupt compressed block: raw size out of range");
+  }
+  std::vector<uint8_t> out(raw_size);
+  const uint8_t *ip = data;
+  const uint8_t *end = data + size;
+  size_t op = 0;
+
+  while (ip < end) {
+    uint8_t token = *ip++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15) {
+      literal_length = ReadLength(ip, end, literal_length);
+    }
+    if (literal_length > static_cast<size_t>(end - ip) || literal_length > raw_size - op) {
+      throw std::runtime_error("Corrupt compressed block: literals out of range");
+    }
+    std::memcpy(out.data() + op, ip, literal_length);
+    ip += literal_length;
+    op += literal_length;
+    if (ip == end) {
+      break;
+    }
+
+    if (end - ip < 2) {
+      throw std::runtime_error("Corrupt compressed block: truncated offset");
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_length = token & 0x0F;
+    if (match_length == 15) {
+      match_length = ReadLength(ip, end, match_length);
+    }
+    match_length += kMinMatch;
+    if (offset == 0 || offset > op || match_length > raw_size - op) {
+      throw std::runtime_error("Corrupt compressed block: match out of range");
+    }
+    // Byte by byte: an offset shorter than the match repeats the bytes just written.
+    for (size_t k = 0; k < match_length; ++k, ++op) {
+      out[op] = out[op - offset];
+    }
+  }
+
+  if (op != raw_size) {
+    throw std::runtime_error("Corrupt compressed block: size mismatch");
+  }
+  return out;
+}
+
+} // namespace lz_codec
@@ -12,5 +12,60 @@
 
 namespace vm_config {
     VmConfig config;
+
+namespace {
+
+std::string Trim(const std::string &text) {
+  size_t begin = text.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+std::vector<std::string> VmConfig::loadConfigFile(const std::filesystem::path &filename) {
+  std::ifstream file(filename);
+  if (!file.is_open()) {
+    throw std::runtime_error("Unable to open config file: " + filename.string());
+  }
+  std::vector<std::string> errors;
+  std::string section;
+  std::string line;
+  for (size_t line_number = 1; std::getline(file, line); ++line_number) {
+    auto report = [&](const std::string &message) {
+      errors.push_back(filename.string() + ":" + std::to_string(line_number) + ": " + message);
+    };
+    line = Trim(line.substr(0, line.find_first_of(";#")));
+    if (line.empty()) {
+      continue;
+    }
+    if (line.front() == '[') {
+      if (line.back() != ']') {
+        report("Malformed section header: " + line);
+      }
+      section = Trim(line.substr(1, line.size() - 2));
+      continue;
+    }
+    // [General] only names the configuration.
+    if (section == "General") {
+      continue;
+    }
+    size_t equals = line.find('=');
+    if (equals == std::string::npos) {
+      report("Expected key=value: " + line);
+      continue;
+    }
+    std::string key = Trim(line.substr(0, equals));
+    try {
+      modifyConfig(section, key, Trim(line.substr(equals + 1)));
+    } catch (const std::exception &e) {
+      report(key + ": " + e.what());
+    }
+  }
+  return errors;
 }
 
+} // namespace vm_config
@@ -0,0 +1,432 @@
+/**
+ * @file fuzzer.cpp
+ * @brief Contains the implementation of the coverage-guided stdin fuzzer.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "fuzzer.h"
+
+#include "assembler/assembler.h"
+#include "assembler/elf_util.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+namespace fuzzer {
+
+namespace {
+
+// RunQuantum keeps one instruction slice of undo deltas; slicing keeps that bounded.
+constexpr uint64_t kSliceInstructions = 65536;
+
+// Integers around the usual type boundaries, and separators, written the way programs read them.
+constexpr std::array<std::string_view, 26> kTokens = {
+    "0", "1", "-1", "2", "10", "127", "128", "-128", "255", "256", "32767", "65535", "65536",
+    "2147483647", "-2147483648", "4294967295", "4294967296", "9223372036854775807",
+    "-9223372036854775808", "18446744073709551616", "99999999999999999999", "-0", " ", "\n",
+    "-", "0x"};
+
+constexpr std::array<uint8_t, 10> kInterestingBytes = {0, 1, 0x7F, 0x80, 0xFF, '\n', ' ', '-', '0', '9'};
+
+constexpr std::string_view kTextBytes = "0123456789 -\n";
+
+using Clock = std::chrono::steady_clock;
+
+std::string ContentName(const std::string &data) {
+  std::ostringstream os;
+  os << std::hex << std::setw(16) << std::setfill('0') << std::hash<std::string>{}(data);
+  return os.str();
+}
+
+std::string Hex(uint64_t value) {
+  std::ostringstream os;
+  os << "0x" << std::hex << value;
+  return os.str();
+}
+
+/**
+ * @brief Coverage no run has reached yet: one bit per hit-count bucket per map entry, cleared
+ *        as runs reach them. Shared by the workers without a lock.
+ */
+class VirginMap {
+ public:
+  VirginMap() : bits_(std::make_unique<std::atomic<uint8_t>[]>(EdgeCoverage::kMapSize)) {
+    for (size_t i = 0; i < EdgeCoverage::kMapSize; ++i) {
+      bits_[i].store(0xFF, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @return Whether coverage reached a bucket no earlier run had.
+   */
+  bool Merge(const EdgeCoverage &coverage) {
+    bool found = false;
+    for (uint32_t index : coverage.GetTouched()) {
+      uint8_t bucket = EdgeCoverage::Bucket(coverage.GetHits(index));
+      if ((bits_[index].load(std::memory_order_relaxed) & bucket) == 0) {
+        continue;
+      }
+      uint8_t before = bits_[index].fetch_and(static_cast<uint8_t>(~bucket), std::memory_order_relaxed);
+      if (before & bucket) {
+        found = true;
+        edges_.fetch_add(before == 0xFF, std::memory_order_relaxed);
+      }
+    }
+    return found;
+  }
+
+  [[nodiscard]] uint64_t GetEdges() const {
+    return edges_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::unique_ptr<std::atomic<uint8_t>[]> bits_;
+  std::atomic<uint64_t> edges_ = 0;
+};
+
+struct CorpusEntry {
+  std::string data;
+  std::atomic<uint64_t> picks = 0;
+  std::atomic<uint64_t> finds = 0; ///< Inputs derived from this one that joined the corpus.
+
+  explicit CorpusEntry(std::string input) : data(std::move(input)) {}
+};
+
+/**
+ * @brief State shared by the workers of one Fuzz call.
+ */
+class Campaign {
+ public:
+  Campaign(const std::filesystem::path &program, const std::filesystem::path &corpus_dir,
+           const FuzzOptions &options, std::ostream &log)
+      : program_(program), corpus_dir_(corpus_dir), options_(options), log_(log),
+        context_(VmContext::FromGlobals()), start_(Clock::now()) {}
+
+  /**
+   * @brief Runs every seed once; seeds join the corpus whatever their coverage.
+   */
+  void LoadSeeds() {
+    std::vector<std::string> seeds;
+    if (std::filesystem::is_directory(corpus_dir_)) {
+      std::vector<std::filesystem::path> files;
+      for (const auto &entry : std::filesystem::directory_iterator(corpus_dir_)) {
+        if (entry.is_regular_file()) {
+          files.push_back(entry.path());
+        }
+      }
+      std::sort(files.begin(), files.end());
+      for (const auto &file : files) {
+        std::ifstream input(file, std::ios::binary);
+        std::ostringstream contents;
+        contents << input.rdbuf();
+        seeds.push_back(contents.str().substr(0, options_.max_input_size));
+      }
+    }
+    if (seeds.empty()) {
+      seeds.emplace_back();
+    }
+    std::filesystem::create_directories(corpus_dir_);
+
+    Executor executor(program_, context_, options_.instruction_limit);
+    for (std::string &seed : seeds) {
+      RunResult result = executor.Run(seed);
+      runs_.fetch_add(1, std::memory_order_relaxed);
+      Triage(result, seed, executor.GetCoverage(), nullptr, false);
+      corpus_.push_back(std::make_shared<CorpusEntry>(std::move(seed)));
+    }
+  }
+
+  void Work(unsigned int worker) {
+    try {
+      Executor executor(program_, context_, options_.instruction_limit);
+      Mutator mutator(options_.seed + worker);
+      size_t cursor = worker;
+      while (!Done()) {
+        std::shared_ptr<CorpusEntry> entry = Pick(cursor);
+        // Power schedule: inputs that led somewhere new get more mutations; well-worn ones fewer.
+        uint64_t picks = entry->picks.fetch_add(1, std::memory_order_relaxed);
+        uint64_t finds = entry->finds.load(std::memory_order_relaxed);
+        uint64_t energy = std::clamp<uint64_t>(16*(1 + 4*finds)/(1 + picks/8), 4, 256);
+        for (uint64_t i = 0; i < energy && !Done(); ++i) {
+          std::shared_ptr<CorpusEntry> other = RandomEntry(mutator);
+          std::string input = mutator.Mutate(entry->data, other->data, options_.max_input_size);
+          RunResult result = executor.Run(input);
+          runs_.fetch_add(1, std::memory_order_relaxed);
+          Triage(result, input, executor.GetCoverage(), entry.get(), true);
+        }
+      }
+    } catch (const std::exception &e) {
+      std::lock_guard<std::mutex> lock(log_mutex_);
+      log_ << "Worker " << worker << " stopped: " << e.what() << std::endl;
+    }
+  }
+
+  [[nodiscard]] bool Done() const {
+    if (options_.max_runs != 0 && runs_.load(std::memory_order_relaxed) >= options_.max_runs) {
+      return true;
+    }
+    return options_.max_seconds > 0 && Elapsed() >= options_.max_seconds;
+  }
+
+  [[nodiscard]] double Elapsed() const {
+    return std::chrono::duration<double>(Clock::now() - start_).count();
+  }
+
+  FuzzStats GetStats() {
+    FuzzStats stats;
+    stats.runs = runs_.load(std::memory_order_relaxed);
+    {
+      std::lock_guard<std::mutex> lock(corpus_mutex_);
+      stats.corpus_size = corpus_.size();
+    }
+    stats.edges = virgin_.GetEdges();
+    stats.crashes = crashes_.load(std::memory_order_relaxed);
+    stats.timeouts = timeouts_.load(std::memory_order_relaxed);
+    stats.seconds = Elapsed();
+    return stats;
+  }
+
+  void PrintStatus() {
+    FuzzStats stats = GetStats();
+    std::lock_guard<std::mutex> lock(log_mutex_);
+    log_ << std::fixed << std::setprecision(1) << "[" << stats.seconds << " s] runs " << stats.runs
+         << " (" << std::setprecision(0) << (stats.seconds > 0 ? stats.runs/stats.seconds : 0) << "/s)"
+         << ", corpus " << stats.corpus_size << ", edges " << stats.edges
+         << ", crashes " << stats.crashes << ", timeouts " << stats.timeouts << std::endl;
+  }
+
+ private:
+  std::filesystem::path program_;
+  std::filesystem::path corpus_dir_;
+  FuzzOptions options_;
+  std::ostream &log_;
+  std::mutex log_mutex_;
+  VmContext context_;
+  Clock::time_point start_;
+
+  std::mutex corpus_mutex_;
+  std::vector<std::shared_ptr<CorpusEntry>> corpus_;
+  VirginMap virgin_;
+  VirginMap timeout_virgin_;
+  std::mutex crash_mutex_;
+  std::set<std::pair<uint64_t, std::string>> crash_signatures_;
+  std::atomic<uint64_t> runs_ = 0;
+  std::atomic<uint64_t> crashes_ = 0;
+  std::atomic<uint64_t> timeouts_ = 0;
+
+  std::shared_ptr<CorpusEntry> Pick(size_t &cursor) {
+    std::lock_guard<std::mutex> lock(corpus_mutex_);
+    return corpus_[cursor++ % corpus_.size()];
+  }
+
+  std::shared_ptr<CorpusEntry> RandomEntry(Mutator &mutator) {
+    std::lock_guard<std::mutex> lock(corpus_mutex_);
+    return corpus_[mutator.Random(corpus_.size())];
+  }
+
+  void Triage(const RunResult &result, const std::string &input, const EdgeCoverage &coverage,
+              CorpusEntry *parent, bool add_to_corpus) {
+    switch (result.outcome) {
+      case Outcome::kOk:
+        if (virgin_.Merge(coverage) && add_to_corpus) {
+          Save(corpus_dir_, "id_" + ContentName(input), input);
+          if (parent != nullptr) {
+            parent->finds.fetch_add(1, std::memory_order_relaxed);
+          }
+          std::lock_guard<std::mutex> lock(corpus_mutex_);
+          corpus_.push_back(std::make_shared<CorpusEntry>(input));
+        }
+        break;
+      case Outcome::kCrash: {
+        virgin_.Merge(coverage);
+        // Group by the error's kind, not the address it names.
+        std::string kind = result.message.substr(0, result.message.find(':'));
+        {
+          std::lock_guard<std::mutex> lock(crash_mutex_);
+          if (!crash_signatures_.emplace(result.pc, kind).second) {
+            break;
+          }
+        }
+        crashes_.fetch_add(1, std::memory_order_relaxed);
+        std::string name = "crash_pc_" + Hex(result.pc) + "_" + ContentName(input);
+        Save(corpus_dir_ / "crashes", name, input);
+        Save(corpus_dir_ / "crashes", name + ".txt", "pc " + Hex(result.pc) + ": " + result.message + "\n");
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        log_ << "Crash at pc " << Hex(result.pc) << ": " << result.message << " -> crashes/" << name << std::endl;
+        break;
+      }
+      case Outcome::kTimeout: {
+        if (!timeout_virgin_.Merge(coverage)) {
+          break;
+        }
+        timeouts_.fetch_add(1, std::memory_order_relaxed);
+        std::string name = "timeout_" + ContentName(input);
+        Save(corpus_dir_ / "timeouts", name, input);
+        std::lock_guard<std::mutex> lock(log_mutex_);
+        log_ << "Timeout after " << result.instructions << " instructions -> timeouts/" << name << std::endl;
+        break;
+      }
+    }
+  }
+
+  static void Save(const std::filesystem::path &directory, const std::string &name, const std::string &data) {
+    std::filesystem::create_directories(directory);
+    std::ofstream(directory / name, std::ios::binary) << data;
+  }
+};
+
+} // namespace
+
+Executor::Executor(const std::filesystem::path &program, VmContext context, uint64_t instruction_limit)
+    : vm_([&context]() {
+        context.dump_state = false;
+        context.vm_as_backend = false;
+        context.config.setStdinFile("");
+        context.config.setTraceFile("");
+        context.config.setProfilingEnabled(false);
+        return context;
+      }()),
+      instruction_limit_(instruction_limit) {
+  if (isElfFile(program.string())) {
+    vm_.LoadElfProgram(program.string());
+  } else {
+    vm_.LoadProgram(assemble(program.string(), false));
+  }
+  vm_.guest_io_.SetCaptureOutput(true);
+  vm_.coverage_ = &coverage_;
+  snapshot_ = vm_.Snapshot();
+}
+
+RunResult Executor::Run(std::string_view input) {
+  coverage_.Clear();
+  vm_.Fork(snapshot_);
+  vm_.guest_io_.SetStdin(std::string(input));
+  RunResult result;
+  try {
+    while (!vm_.IsHalted()) {
+      if (result.instructions >= instruction_limit_) {
+        result.outcome = Outcome::kTimeout;
+        result.pc = vm_.program_counter_;
+        result.message = "instruction limit exceeded";
+        return result;
+      }
+      result.instructions += vm_.RunQuantum(std::min(kSliceInstructions, instruction_limit_ - result.instructions));
+    }
+  } catch (const std::exception &e) {
+    result.outcome = Outcome::kCrash;
+    result.pc = vm_.current_delta_.old_pc;
+    result.message = e.what();
+  }
+  return result;
+}
+
+std::string Mutator::Mutate(const std::string &input, const std::string &splice, size_t max_size) {
+  std::string data = input;
+  uint64_t stack = uint64_t{1} << Random(5);
+  for (uint64_t i = 0; i < stack; ++i) {
+    size_t size = data.size();
+    switch (Random(10)) {
+      case 0: // flip a bit
+        if (size > 0) {
+          data[Random(size)] ^= static_cast<char>(1 << Random(8));
+        }
+        break;
+      case 1: // random byte
+        if (size > 0) {
+          data[Random(size)] = static_cast<char>(Random(256));
+        }
+        break;
+      case 2: // boundary or separator byte
+        if (size > 0) {
+          data[Random(size)] = static_cast<char>(kInterestingBytes[Random(kInterestingBytes.size())]);
+        }
+        break;
+      case 3: // small increment or decrement
+        if (size > 0) {
+          data[Random(size)] += static_cast<char>(static_cast<int>(Random(33)) - 16);
+        }
+        break;
+      case 4: // delete a block
+        if (size > 1) {
+          size_t length = 1 + Random(std::min<size_t>(size - 1, 16));
+          data.erase(Random(size - length + 1), length);
+        }
+        break;
+      case 5: // duplicate a block
+        if (size > 0) {
+          size_t length = 1 + Random(std::min<size_t>(size, 16));
+          std::string block = data.substr(Random(size - length + 1), length);
+          data.insert(Random(size + 1), block);
+        }
+        break;
+      case 6: // insert a token
+        data.insert(Random(size + 1), kTokens[Random(kTokens.size())]);
+        break;
+      case 7: { // overwrite a few bytes with a token
+        size_t position = Random(size + 1);
+        data.replace(position, Random(std::min<size_t>(size - position, 8) + 1), kTokens[Random(kTokens.size())]);
+        break;
+      }
+      case 8: { // insert digits, spaces and newlines
+        size_t count = 1 + Random(8);
+        std::string text;
+        for (size_t j = 0; j < count; ++j) {
+          text += kTextBytes[Random(kTextBytes.size())];
+        }
+        data.insert(Random(size + 1), text);
+        break;
+      }
+      default: // cross over: keep a prefix, take the rest from another entry
+        if (!splice.empty()) {
+          data = data.substr(0, Random(size + 1)) + splice.substr(Random(splice.size()));
+        }
+        break;
+    }
+  }
+  if (data.size() > max_size) {
+    data.resize(max_size);
+  }
+  return data;
+}
+
+FuzzStats Fuzz(const std::filesystem::path &program, const std::filesystem::path &corpus_dir,
+               const FuzzOptions &options, std::ostream &log) {
+  Campaign campaign(program, corpus_dir, options, log);
+  campaign.LoadSeeds();
+
+  unsigned int jobs = options.jobs == 0 ? std::max(1u, std::thread::hardware_concurrency()) : options.jobs;
+  std::atomic<unsigned int> running = jobs;
+  std::vector<std::thread> workers;
+  for (unsigned int worker = 0; worker < jobs; ++worker) {
+    workers.emplace_back([&campaign, &running, worker]() {
+      campaign.Work(worker);
+      running.fetch_sub(1);
+    });
+  }
+  auto last_status = Clock::now();
+  while (running.load() > 0) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (Clock::now() - last_status >= std::chrono::seconds(2)) {
+      campaign.PrintStatus();
+      last_status = Clock::now();
+    }
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  campaign.PrintStatus();
+  return campaign.GetStats();
+}
+
+} // namespace fuzzer
@@ -0,0 +1,468 @@
+/**
+ * @file json.cpp
+ * @brief Contains the implementation of the JSON parser and serialiser.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "json.h"
+
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace json {
+
+namespace {
+
+// Deep enough for any request; stops a hostile message from overflowing the stack.
+constexpr unsigned int kMaxDepth = 64;
+
+class Parser {
+ public:
+  explicit Parser(std::string_view text) : text_(text) {}
+
+  Value ParseDocument() {
+    Value value = ParseValue(0);
+    SkipWhitespace();
+    if (pos_ != text_.size()) {
+      Fail("unexpected text after the value");
+    }
+    return value;
+  }
+
+ private:
+  std::string_view text_;
+  size_t pos_ = 0;
+
+  [[noreturn]] void Fail(const std::string &message) const {
+    throw std::runtime_error("JSON error at offset " + std::to_string(pos_) + ": " + message);
+  }
+
+  void SkipWhitespace() {
+    while (pos_ < text_.size() && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n'
+                                   || text_[pos_] == '\r')) {
+      ++pos_;
+    }
+  }
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(char c) {
+    if (!Consume(c)) {
+      Fail(std::string("expected '") + c + "'");
+    }
+  }
+
+  void ExpectWord(std::string_view word) {
+    if (text_.substr(pos_, word.size()) != word) {
+      Fail("unknown literal");
+    }
+    pos_ += word.size();
+  }
+
+  Value ParseValue(unsigned int depth) {
+    if (depth > kMaxDepth) {
+      Fail("nested too deeply");
+    }
+    SkipWhitespace();
+    if (pos_ >= text_.size()) {
+      Fail("unexpected end of input");
+    }
+    Value value;
+    char c = text_[pos_];
+    if (c == '{') {
+      ++pos_;
+      value.type = Value::Type::kObject;
+      if (Consume('}')) {
+        return value;
+      }
+      do {
+        SkipWhitespace();
+        if (pos_ >= text_.size() || text_[pos_] != '"') {
+          Fail("expected a member name");
+        }
+        std::string key = ParseString();
+        Expect(':');
+        value.object.emplace_back(std::move(key), ParseValue(depth + 1));
+      } while (Consume(','));
+      Expect('}');
+    } else if (c == '[') {
+      ++pos_;
+      value.type = Value::Type::kArray;
+      if (Consume(']')) {
+        return value;
+      }
+      do {
+        value.array.push_back(ParseValue(depth + 1));
+      } while (Consume(','));
+      Expect(']');
+    } else if (c == '"') {
+      value.type = Value::Type::kString;
+      value.text = ParseString();
+    } else if (c == 't') {
+      ExpectWord("true");
+      value.type = Value::Type::kBool;
+      value.boolean = true;
+    } else if (c == 'f') {
+      ExpectWord("false");
+      value.type = Value::Type::kBool;
+    } else if (c == 'n') {
+      ExpectWord("null");
+    } else if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
+      value.type = Value::Type::kNumber;
+      value.text = ParseNumber();
+    } else {
+      Fail(std::string("unexpected character '") + c + "'");
+    }
+    return value;
+  }
+
+  std::string ParseNumber() {
+    size_t start = pos_;
+    auto digits = [this]() {
+      size_t first = pos_;
+      while (pos_ < text_.size() && std::isdigit(static_cast<unsigned char>(text_[pos_]))) {
+        ++pos_;
+      }
+      if (pos_ == first) {
+        Fail("expected a digit");
+      }
+    };
+    if (text_[pos_] == '-') {
+      ++pos_;
+    }
+    digits();
+    if (pos_ < text_.size() && text_[pos_] == '.') {
+      ++pos_;
+      digits();
+    }
+    if (pos_ < text_.size() && (text_[pos_] == 'e' || text_[pos_] == 'E')) {
+      ++pos_;
+      if (pos_ < text_.size() && (text_[pos_] == '+' || text_[pos_] == '-')) {
+        ++pos_;
+      }
+      digits();
+    }
+    return std::string(text_.substr(start, pos_ - start));
+  }
+
+  unsigned int ParseHex4() {
+    if (pos_ + 4 > text_.size()) {
+      Fail("truncated \\u escape");
+    }
+    unsigned int code = 0;
+    auto [end, error] = std::from_chars(text_.data() + pos_, text_.data() + pos_ + 4, code, 16);
+    if (error != std::errc() || end != text_.data() + pos_ + 4) {
+      Fail("bad \\u escape");
+    }
+    pos_ += 4;
+    return code;
+  }
+
+  static void AppendUtf8(std::string &out, unsigned int code) {
+    if (code < 0x80) {
+      out += static_cast<char>(code);
+    } else if (code < 0x800) {
+      out += static_cast<char>(0xC0 | (code >> 6));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+      out += static_cast<char>(0xE0 | (code >> 12));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (code >> 18));
+      out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+  }
+
+  std::string ParseString() {
+    ++pos_; // opening quote
+    std::string out;
+    while (true) {
+      if (pos_ >= text_.size()) {
+        Fail("unterminated string");
+      }
+      char c = text_[pos_++];
+      if (c == '"') {
+        return out;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        Fail("control character in string");
+      }
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (pos_ >= text_.size()) {
+        Fail("unterminated string");
+      }
+      char escape = text_[pos_++];
+      switch (escape) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+          unsigned int code = ParseHex4();
+          if (code >= 0xD800 && code < 0xDC00 && text_.substr(pos_, 2) == "\\u") {
+            pos_ += 2;
+            unsigned int low = ParseHex4();
+            if (low < 0xDC00 || low >= 0xE000) {
+              Fail("unpaired surrogate");
+            }
+            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+          }
+          AppendUtf8(out, code);
+          break;
+        }
+        default:
+          Fail(std::string("unknown escape '\\") + escape + "'");
+      }
+    }
+  }
+};
+
+// Length of the well-formed UTF-8 sequence text starts with, or 0 if it does not start with one.
+size_t Utf8SequenceLength(std::string_view text) {
+  auto byte = [&text](size_t i) {
+    return static_cast<unsigned char>(text[i]);
+  };
+  unsigned char lead = byte(0);
+  size_t length;
+  unsigned int code;
+  if (lead >= 0xC2 && lead <= 0xDF) {
+    length = 2;
+    code = lead & 0x1F;
+  } else if (lead >= 0xE0 && lead <= 0xEF) {
+    length = 3;
+    code = lead & 0x0F;
+  } else if (lead >= 0xF0 && lead <= 0xF4) {
+    length = 4;
+    code = lead & 0x07;
+  } else {
+    return 0;
+  }
+  if (text.size() < length) {
+    return 0;
+  }
+  for (size_t i = 1; i < length; ++i) {
+    if ((byte(i) & 0xC0) != 0x80) {
+      return 0;
+    }
+    code = (code << 6) | (byte(i) & 0x3F);
+  }
+  // Overlong forms, surrogates and code points past U+10FFFF.
+  if ((length == 3 && code < 0x800) || (length == 4 && code < 0x10000) || (code >= 0xD800 && code < 0xE000)
+      || code > 0x10FFFF) {
+    return 0;
+  }
+  return length;
+}
+
+void SerializeTo(const Value &value, std::string &out) {
+  switch (value.type) {
+    case Value::Type::kNull:
+      out += "null";
+      break;
+    case Value::Type::kBool:
+      out += value.boolean ? "true" : "false";
+      break;
+    case Value::Type::kNumber:
+      out += value.text;
+      break;
+    case Value::Type::kString:
+      out += Quote(value.text);
+      break;
+    case Value::Type::kArray:
+      out += '[';
+      for (size_t i = 0; i < value.array.size(); ++i) {
+        if (i > 0) {
+          out += ',';
+        }
+        SerializeTo(value.array[i], out);
+      }
+      out += ']';
+      break;
+    case Value::Type::kObject:
+      out += '{';
+      for (size_t i = 0; i < value.object.size(); ++i) {
+        if (i > 0) {
+          out += ',';
+        }
+        out += Quote(value.object[i].first);
+        out += ':';
+        SerializeTo(value.object[i].second, out);
+      }
+      out += '}';
+      break;
+  }
+}
+
+} // namespace
+
+Value Value::String(std::string text) {
+  Value value;
+  value.type = Type::kString;
+  value.text = std::move(text);
+  return value;
+}
+
+Value Value::Number(uint64_t number) {
+  Value value;
+  value.type = Type::kNumber;
+  value.text = std::to_string(number);
+  return value;
+}
+
+Value Value::Number(double number) {
+  Value value;
+  if (!std::isfinite(number)) {
+    return value; // JSON has no NaN or infinity.
+  }
+  std::ostringstream os;
+  os.precision(17);
+  os << number;
+  value.type = Type::kNumber;
+  value.text = os.str();
+  return value;
+}
+
+Value Value::Bool(bool boolean) {
+  Value value;
+  value.type = Type::kBool;
+  value.boolean = boolean;
+  return value;
+}
+
+Value Value::Array() {
+  Value value;
+  value.type = Type::kArray;
+  return value;
+}
+
+Value Value::Object() {
+  Value value;
+  value.type = Type::kObject;
+  return value;
+}
+
+const Value *Value::Find(std::string_view key) const {
+  for (const auto &[name, member] : object) {
+    if (name == key) {
+      return &member;
+    }
+  }
+  return nullptr;
+}
+
+Value &Value::Set(std::string key, Value value) {
+  object.emplace_back(std::move(key), std::move(value));
+  return object.back().second;
+}
+
+const std::string &Value::AsString() const {
+  if (type != Type::kString) {
+    throw std::runtime_error("expected a string");
+  }
+  return text;
+}
+
+uint64_t Value::AsUint64() const {
+  if (type != Type::kNumber && type != Type::kString) {
+    throw std::runtime_error("expected an integer");
+  }
+  std::string_view digits = text;
+  int base = 10;
+  if (type == Type::kString && digits.size() > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) {
+    digits.remove_prefix(2);
+    base = 16;
+  }
+  uint64_t number = 0;
+  auto [end, error] = std::from_chars(digits.data(), digits.data() + digits.size(), number, base);
+  if (error != std::errc() || end != digits.data() + digits.size()) {
+    throw std::runtime_error("expected a non-negative 64-bit integer, got " + text);
+  }
+  return number;
+}
+
+double Value::AsDouble() const {
+  if (type != Type::kNumber) {
+    throw std::runtime_error("expected a number");
+  }
+  return std::stod(text);
+}
+
+bool Value::AsBool() const {
+  if (type != Type::kBool) {
+    throw std::runtime_error("expected true or false");
+  }
+  return boolean;
+}
+
+Value Parse(std::string_view text) {
+  return Parser(text).ParseDocument();
+}
+
+std::string Serialize(const Value &value) {
+  std::string out;
+  SerializeTo(value, out);
+  return out;
+}
+
+std::string Quote(std::string_view text) {
+  static constexpr char kHex[] = "0123456789abcdef";
+  std::string out;
+  out.reserve(text.size() + 2);
+  out += '"';
+  for (size_t i = 0; i < text.size(); ++i) {
+    char c = text[i];
+    if (static_cast<unsigned char>(c) >= 0x80) {
+      // Valid UTF-8 is copied; any other byte (guest output is arbitrary) becomes the code
+      // point of the same value, so the line stays valid JSON.
+      size_t length = Utf8SequenceLength(text.substr(i));
+      if (length > 0) {
+        out += text.substr(i, length);
+        i += length - 1;
+      } else {
+        out += "\\u00";
+        out += kHex[(c >> 4) & 0xF];
+        out += kHex[c & 0xF];
+      }
+      continue;
+    }
+    switch (c) {
+      case '"': out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          out += "\\u00";
+          out += kHex[(c >> 4) & 0xF];
+          out += kHex[c & 0xF];
+        } else {
+          out += c;
+        }
+    }
+  }
+  out += '"';
+  return out;
+}
+
+} // namespace json
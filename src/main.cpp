@@ -1,25 +1,75 @@
 #include "main.h"
 #include "assembler/assembler.h"
+#include "assembler/elf_util.h"
+#include "batch_runner.h"
+#include "fuzzer.h"
+#include "sim_server.h"
+#include "simpoint.h"
+#include "yolo_bench.h"
 #include "utils.h"
 #include "globals.h"
 #include "vm/rvss/rvss_vm.h"
+#include "vm/rvss/multi_hart_vm.h"
 #include "vm_runner.h"
 #include "command_handler.h"
 #include "config.h"
 
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 #include <thread>
 #include <bitset>
 #include <regex>
 
 
 
+namespace {
+
+sim_server::Server *serving_server = nullptr;
+
+void StopServing(int) {
+  if (serving_server != nullptr) {
+    serving_server->Stop();
+  }
+}
+
+RVSSVM *checkpointed_vm = nullptr;
+
+void StopForCheckpoint(int) {
+  if (checkpointed_vm != nullptr) {
+    checkpointed_vm->RequestStop();
+  }
+}
+
+/**
+ * @brief Runs vm to the end, the instruction limit or SIGINT, then saves its state if asked to.
+ */
+void RunAndCheckpoint(RVSSVM &vm, const std::filesystem::path &save_state) {
+  if (!save_state.empty()) {
+    checkpointed_vm = &vm;
+    std::signal(SIGINT, StopForCheckpoint);
+  }
+  vm.Run();
+  if (!save_state.empty()) {
+    std::signal(SIGINT, SIG_DFL);
+    checkpointed_vm = nullptr;
+    vm.SaveState(save_state);
+    std::cout << "State saved: " << save_state.string() << " (instret " << vm.instructions_retired_ << ")\n";
+  }
+}
+
+} // namespace
+
 int main(int argc, char *argv[]) {
   if (argc <= 1) {
     std::cerr << "No arguments provided. Use --help for usage information.\n";
     return 1;
   }
 
+  std::filesystem::path save_state;
   for (int i = 1; i < argc; ++i) {
     std::string arg = argv[i];
 
@@ -28,7 +78,23 @@ int main(int argc, char *argv[]) {
                   << "Options:\n"
                   << "  --help, -h           Show this help message\n"
                   << "  --assemble <file>    Assemble the specified file\n"
-                  << "  --run <file>         Run the specified file\n"
+                  << "  --run <file>         Run the specified assembly or ELF64 file\n"
+                  << "  --batch <dir> [--jobs <n>]  Run every program in a directory and check .expected files\n"
+                  << "  --serve <socket> [--jobs <n>]  Run JSON jobs sent to a Unix socket on a pool of warm VMs\n"
+                  << "  --fuzz <file> <dir> [--jobs <n>] [--runs <n>] [--seconds <n>] [--max-instructions <n>] [--seed <n>]\n"
+                  << "                       Fuzz a program's stdin, keeping the corpus, crashes and timeouts in dir\n"
+                  << "  --simpoint <file> [--interval <n>] [--max-k <n>] [--warmup <n>] [--jobs <n>] [--seed <n>]\n"
+                  << "            [--max-instructions <n>] [--compare]\n"
+                  << "                       Estimate CPI and miss rates from detailed runs of representative intervals\n"
+                  << "  --yolo-bench <cfg> [--layer <n>] [--tile <n>] [--channels <n>] [--formats <list>] [--emit <dir>] [--seed <n>]\n"
+                  << "                       Run a tile of a Darknet conv layer in fp32, fp16, bf16 and msfp16\n"
+                  << "  --restore <file>     Resume a VM from a state image and run it\n"
+                  << "  --save-state <file>  Save the state of later --run/--restore programs when they stop\n"
+                  << "                       (end, instruction limit or Ctrl-C)\n"
+                  << "  --config <file>      Apply the settings in an ini file to later commands\n"
+                  << "  --trace <file>       Record a binary execution trace of later --run programs\n"
+                  << "  --harts <n>          Run later --run programs on n harts sharing memory\n"
+                  << "  --dbt                Run later --run programs with hot blocks translated to x86-64\n"
                   << "  --verbose-errors     Enable verbose error printing\n"
                   << "  --start-vm           Start the VM with the default program\n"
                   << "  --start-vm --vm-as-backend  Start the VM with the default program in backend mode\n";
@@ -48,23 +114,337 @@ int main(int argc, char *argv[]) {
             return 1;
         }
 
+    } else if (arg == "--batch") {
+        if (++i >= argc) {
+            std::cerr << "Error: No directory specified for batch run.\n";
+            return 1;
+        }
+        std::filesystem::path directory = argv[i];
+        unsigned int jobs = 0;
+        if (i + 2 < argc && std::string(argv[i + 1]) == "--jobs") {
+            try {
+                jobs = static_cast<unsigned int>(std::stoul(argv[i + 2]));
+            } catch (const std::exception &) {
+                std::cerr << "Error: Invalid --jobs value.\n"
+                          << "Usage: " << argv[0] << " --batch <dir> [--jobs <n>]\n";
+                return 1;
+            }
+        }
+        if (!std::filesystem::is_directory(directory)) {
+            std::cerr << "Error: Not a directory: " << directory << '\n';
+            return 1;
+        }
+        std::vector<batch_runner::ProgramResult> results = batch_runner::RunBatch(directory, jobs);
+        return batch_runner::PrintReport(results, std::cout) ? 0 : 1;
+
+    } else if (arg == "--serve") {
+        if (++i >= argc) {
+            std::cerr << "Error: No socket path specified to serve on.\n";
+            return 1;
+        }
+        std::filesystem::path socket_path = argv[i];
+        unsigned int jobs = 0;
+        if (i + 2 < argc && std::string(argv[i + 1]) == "--jobs") {
+            try {
+                jobs = static_cast<unsigned int>(std::stoul(argv[i + 2]));
+            } catch (const std::exception &) {
+                std::cerr << "Error: Invalid --jobs value.\n"
+                          << "Usage: " << argv[0] << " --serve <socket> [--jobs <n>]\n";
+                return 1;
+            }
+        }
+        try {
+            sim_server::Server server(socket_path, VmContext::FromGlobals(), jobs);
+            serving_server = &server;
+            std::signal(SIGINT, StopServing);
+            std::signal(SIGTERM, StopServing);
+            std::cout << "VM_SERVER_LISTENING " << socket_path.string() << " workers=" << server.GetWorkerCount()
+                      << std::endl;
+            server.Serve();
+            serving_server = nullptr;
+            std::cout << "VM_SERVER_STOPPED jobs=" << server.GetJobsCompleted() << std::endl;
+            return 0;
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
+    } else if (arg == "--fuzz") {
+        if (i + 2 >= argc) {
+            std::cerr << "Error: --fuzz needs a program and a corpus directory.\n";
+            return 1;
+        }
+        std::filesystem::path program = argv[++i];
+        std::filesystem::path corpus_dir = argv[++i];
+        fuzzer::FuzzOptions options;
+        try {
+            while (i + 1 < argc) {
+                std::string option = argv[i + 1];
+                if (option != "--jobs" && option != "--runs" && option != "--seconds"
+                    && option != "--max-instructions" && option != "--seed") {
+                    break;
+                }
+                if (i + 2 >= argc) {
+                    std::cerr << "Error: No value specified for " << option << ".\n";
+                    return 1;
+                }
+                std::string value = argv[i + 2];
+                i += 2;
+                if (option == "--jobs") {
+                    options.jobs = static_cast<unsigned int>(std::stoul(value));
+                } else if (option == "--runs") {
+                    options.max_runs = std::stoull(value);
+                } else if (option == "--seconds") {
+                    options.max_seconds = std::stod(value);
+                } else if (option == "--max-instructions") {
+                    options.instruction_limit = std::stoull(value);
+                } else {
+                    options.seed = std::stoull(value);
+                }
+            }
+        } catch (const std::exception &) {
+            std::cerr << "Error: Invalid --fuzz option value.\n";
+            return 1;
+        }
+        try {
+            fuzzer::FuzzStats stats = fuzzer::Fuzz(program, corpus_dir, options, std::cout);
+            std::cout << "Fuzzing finished: " << stats.runs << " runs, corpus " << stats.corpus_size
+                      << ", edges " << stats.edges << ", " << stats.crashes << " unique crashes, "
+                      << stats.timeouts << " unique timeouts\n";
+            return stats.crashes == 0 ? 0 : 1;
+        } catch (const std::runtime_error& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
+    } else if (arg == "--simpoint") {
+        if (++i >= argc) {
+            std::cerr << "Error: No file specified for --simpoint.\n";
+            return 1;
+        }
+        std::filesystem::path program = argv[i];
+        simpoint::SimPointOptions options;
+        try {
+            while (i + 1 < argc) {
+                std::string option = argv[i + 1];
+                if (option == "--compare") {
+                    options.compare = true;
+                    ++i;
+                    continue;
+                }
+                if (option != "--interval" && option != "--max-k" && option != "--warmup" && option != "--jobs"
+                    && option != "--seed" && option != "--max-instructions") {
+                    break;
+                }
+                if (i + 2 >= argc) {
+                    std::cerr << "Error: No value specified for " << option << ".\n";
+                    return 1;
+                }
+                std::string value = argv[i + 2];
+                i += 2;
+                if (option == "--interval") {
+                    options.interval_size = std::stoull(value);
+                } else if (option == "--max-k") {
+                    options.max_k = static_cast<unsigned int>(std::stoul(value));
+                } else if (option == "--warmup") {
+                    options.warmup = std::stoull(value);
+                } else if (option == "--jobs") {
+                    options.jobs = static_cast<unsigned int>(std::stoul(value));
+                } else if (option == "--seed") {
+                    options.seed = std::stoull(value);
+                } else {
+                    options.max_instructions = std::stoull(value);
+                }
+            }
+        } catch (const std::exception &) {
+            std::cerr << "Error: Invalid --simpoint option value.\n";
+            return 1;
+        }
+        try {
+            simpoint::SimPointReport report = simpoint::Run(program, VmContext::FromGlobals(), options, std::cout);
+            simpoint::WriteReport(std::cout, report);
+            return 0;
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
+    } else if (arg == "--yolo-bench") {
+        if (++i >= argc) {
+            std::cerr << "Error: No Darknet config specified for --yolo-bench.\n";
+            return 1;
+        }
+        std::filesystem::path cfg = argv[i];
+        size_t layer_index = 0;
+        unsigned int tile = 4;
+        unsigned int channels = 64; // the deep layers take minutes to run in full
+        uint64_t seed = 1;
+        std::vector<yolo_bench::NumberFormat> formats = {yolo_bench::NumberFormat::kFp32, yolo_bench::NumberFormat::kFp16,
+                                                         yolo_bench::NumberFormat::kBf16, yolo_bench::NumberFormat::kMsfp16};
+        std::filesystem::path emit_dir = std::filesystem::temp_directory_path() / "vm_yolo_bench";
+        try {
+            while (i + 1 < argc) {
+                std::string option = argv[i + 1];
+                if (option != "--layer" && option != "--tile" && option != "--channels" && option != "--formats"
+                    && option != "--emit" && option != "--seed") {
+                    break;
+                }
+                if (i + 2 >= argc) {
+                    std::cerr << "Error: No value specified for " << option << ".\n";
+                    return 1;
+                }
+                std::string value = argv[i + 2];
+                i += 2;
+                if (option == "--layer") {
+                    layer_index = std::stoul(value);
+                } else if (option == "--tile") {
+                    tile = static_cast<unsigned int>(std::stoul(value));
+                } else if (option == "--channels") {
+                    channels = static_cast<unsigned int>(std::stoul(value));
+                } else if (option == "--formats") {
+                    formats.clear();
+                    std::stringstream list(value);
+                    std::string name;
+                    while (std::getline(list, name, ',')) {
+                        formats.push_back(yolo_bench::ParseFormat(name));
+                    }
+                } else if (option == "--emit") {
+                    emit_dir = value;
+                } else {
+                    seed = std::stoull(value);
+                }
+            }
+        } catch (const std::exception &e) {
+            std::cerr << "Error: Invalid --yolo-bench option value: " << e.what() << "\n";
+            return 1;
+        }
+        try {
+            std::vector<yolo_bench::ConvLayer> layers = yolo_bench::ParseConvLayers(cfg);
+            yolo_bench::PrintLayers(layers, std::cout);
+            if (layer_index >= layers.size()) {
+                std::cerr << "Error: " << cfg << " has " << layers.size() << " convolutional layers.\n";
+                return 1;
+            }
+            yolo_bench::Workload workload = yolo_bench::MakeWorkload(layers[layer_index], tile, channels, seed);
+            std::filesystem::create_directories(emit_dir);
+            std::vector<yolo_bench::KernelResult> results;
+            for (yolo_bench::NumberFormat format : formats) {
+                std::filesystem::path source = emit_dir / ("layer" + std::to_string(layer_index) + "_"
+                                                           + yolo_bench::FormatName(format) + ".s");
+                std::ofstream(source) << yolo_bench::GenerateKernel(workload, format);
+                results.push_back(yolo_bench::RunKernel(workload, format, source, VmContext::FromGlobals()));
+            }
+            std::cout << "\n";
+            yolo_bench::PrintReport(workload, results, std::cout);
+            std::cout << "Kernels written to " << emit_dir.string() << "\n";
+            return 0;
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
     } else if (arg == "--run") {
         if (++i >= argc) {
             std::cerr << "Error: No file specified to run.\n";
             return 1;
         }
         try {
-            AssembledProgram program = assemble(argv[i]);
+            if (vm_config::config.getHartCount() > 1) {
+                if (!save_state.empty()) {
+                    std::cerr << "Error: --save-state runs a single hart.\n";
+                    return 1;
+                }
+                MultiHartVm machine;
+                if (isElfFile(argv[i])) {
+                    machine.LoadElfProgram(argv[i]);
+                } else {
+                    machine.LoadProgram(assemble(argv[i]));
+                }
+                machine.Run();
+                machine.WriteSummary(std::cout);
+                return 0;
+            }
             RVSSVM vm;
-            vm.LoadProgram(program);
-            vm.Run();
-            std::cout << "Program running: " << program.filename << '\n';
+            if (isElfFile(argv[i])) {
+                vm.LoadElfProgram(argv[i]);
+            } else {
+                vm.LoadProgram(assemble(argv[i]));
+            }
+            RunAndCheckpoint(vm, save_state);
+            std::cout << "Program running: " << argv[i] << '\n';
             return 0;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
+    } else if (arg == "--restore") {
+        if (++i >= argc) {
+            std::cerr << "Error: No state image specified to restore.\n";
+            return 1;
+        }
+        if (vm_config::config.getHartCount() > 1) {
+            std::cerr << "Error: --restore runs a single hart.\n";
+            return 1;
+        }
+        try {
+            RVSSVM vm;
+            vm.RestoreState(argv[i]);
+            std::cout << "State restored: " << argv[i] << " (instret " << vm.instructions_retired_ << ")\n";
+            RunAndCheckpoint(vm, save_state);
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+
+    } else if (arg == "--save-state") {
+        if (++i >= argc) {
+            std::cerr << "Error: No state image specified to save to.\n";
+            return 1;
+        }
+        save_state = argv[i];
+
+    } else if (arg == "--config") {
+        if (++i >= argc) {
+            std::cerr << "Error: No config file specified.\n";
+            return 1;
+        }
+        try {
+            std::vector<std::string> errors = vm_config::config.loadConfigFile(argv[i]);
+            for (const std::string &error : errors) {
+                std::cerr << error << '\n';
+            }
+            if (!errors.empty()) {
+                return 1;
+            }
         } catch (const std::runtime_error& e) {
             std::cerr << e.what() << '\n';
             return 1;
         }
 
+    } else if (arg == "--trace") {
+        if (++i >= argc) {
+            std::cerr << "Error: No trace file specified.\n";
+            return 1;
+        }
+        vm_config::config.setTraceFile(argv[i]);
+
+    } else if (arg == "--harts") {
+        if (++i >= argc) {
+            std::cerr << "Error: No hart count specified.\n";
+            return 1;
+        }
+        try {
+            vm_config::config.setHartCount(std::stoull(argv[i]));
+        } catch (const std::exception &) {
+            std::cerr << "Error: Invalid hart count: " << argv[i] << '\n';
+            return 1;
+        }
+
+    } else if (arg == "--dbt") {
+        vm_config::config.setExecutionEngine(vm_config::ExecutionEngine::DBT);
+
     } else if (arg == "--verbose-errors") {
         globals::verbose_errors_print = true;
         std::cout << "Verbose error printing enabled.\n";
@@ -116,7 +496,25 @@ int main(int argc, char *argv[]) {
   // std::cout << globals::invokation_path << std::endl;
 
   std::thread vm_thread;
-  bool vm_running = false;
+  std::atomic<bool> vm_running = false;
+
+  // While the VM thread runs, registers come from its last published state and memory from a
+  // view it forks at its next publication point, so inspecting it never stops the simulation.
+  constexpr std::chrono::milliseconds kMemoryViewTimeout{500};
+  auto with_memory = [&](auto fn) {
+    if (vm_running) {
+      std::shared_ptr<const PublishedMemoryView> view = vm.state_publisher_.AcquireMemoryView(kMemoryViewTimeout);
+      if (view) {
+        fn(*view->memory);
+        return true;
+      }
+      if (vm_running) {
+        return false;
+      }
+    }
+    fn(*vm.memory_controller_.GetSharedMemory());
+    return true;
+  };
 
   auto launch_vm_thread = [&](auto fn) {
     if (vm_thread.joinable()) {
@@ -140,12 +538,14 @@ int main(int argc, char *argv[]) {
     command_handler::Command command = command_handler::ParseCommand(command_buffer);
 
     if (command.type==command_handler::CommandType::MODIFY_CONFIG) {
-      if (command.args.size() != 3) {
+      // The VM thread reads its config while it runs.
+      if (command.args.size() != 3 || vm_running) {
         std::cout << "VM_MODIFY_CONFIG_ERROR" << std::endl;
         continue;
       }
       try {
         vm_config::config.modifyConfig(command.args[0], command.args[1], command.args[2]);
+        vm.context_.config = vm_config::config;
         std::cout << "VM_MODIFY_CONFIG_SUCCESS" << std::endl;
       } catch (const std::exception &e) {
         std::cout << "VM_MODIFY_CONFIG_ERROR" << std::endl;
@@ -158,19 +558,40 @@ int main(int argc, char *argv[]) {
 
 
     if (command.type==command_handler::CommandType::LOAD) {
+      if (isElfFile(command.args[0])) {
+        try {
+          vm.LoadElfProgram(command.args[0]);
+        } catch (const std::exception &e) {
+          std::cout << "VM_PARSE_ERROR" << std::endl;
+          vm.output_status_ = "VM_PARSE_ERROR";
+          vm.DumpState(vm.context_.paths.vm_state);
+          std::cerr << e.what() << '\n';
+          continue;
+        }
+        std::cout << "Program loaded: " << command.args[0] << std::endl;
+        continue;
+      }
       try {
         program = assemble(command.args[0]);
         std::cout << "VM_PARSE_SUCCESS" << std::endl;
         vm.output_status_ = "VM_PARSE_SUCCESS";
-        vm.DumpState(globals::vm_state_dump_file_path);
+        vm.DumpState(vm.context_.paths.vm_state);
       } catch (const std::runtime_error &e) {
         std::cout << "VM_PARSE_ERROR" << std::endl;
         vm.output_status_ = "VM_PARSE_ERROR";
-        vm.DumpState(globals::vm_state_dump_file_path);
+        vm.DumpState(vm.context_.paths.vm_state);
+        std::cerr << e.what() << '\n';
+        continue;
+      }
+      try {
+        vm.LoadProgram(std::move(program));
+      } catch (const std::exception &e) {
+        std::cout << "VM_PARSE_ERROR" << std::endl;
+        vm.output_status_ = "VM_PARSE_ERROR";
+        vm.DumpState(vm.context_.paths.vm_state);
         std::cerr << e.what() << '\n';
         continue;
       }
-      vm.LoadProgram(program);
       std::cout << "Program loaded: " << command.args[0] << std::endl;
     } else if (command.type==command_handler::CommandType::RUN) {
       launch_vm_thread([&]() { vm.Run(); });
@@ -180,7 +601,7 @@ int main(int argc, char *argv[]) {
       vm.RequestStop();
       std::cout << "VM_STOPPED" << std::endl;
       vm.output_status_ = "VM_STOPPED";
-      vm.DumpState(globals::vm_state_dump_file_path);
+      vm.DumpState(vm.context_.paths.vm_state);
     } else if (command.type==command_handler::CommandType::STEP) {
       if (vm_running) continue;
       launch_vm_thread([&]() { vm.Step(); });
@@ -197,12 +618,78 @@ int main(int argc, char *argv[]) {
       vm.RequestStop();
       if (vm_thread.joinable()) vm_thread.join(); // ensure clean exit
       vm.output_status_ = "VM_EXITED";
-      vm.DumpState(globals::vm_state_dump_file_path);
+      vm.DumpState(vm.context_.paths.vm_state);
       break;
     } else if (command.type==command_handler::CommandType::ADD_BREAKPOINT) {
-      vm.AddBreakpoint(std::stoul(command.args[0], nullptr, 10));
+      if (command.args.empty()) {
+        std::cerr << "Usage: add_breakpoint <line|symbol> [if \"<condition>\"] [hits <n>]" << std::endl;
+        continue;
+      }
+      std::string condition;
+      uint64_t hit_count = 1;
+      bool valid = true;
+      for (size_t i = 1; i < command.args.size(); i += 2) {
+        if (i + 1 >= command.args.size()) {
+          valid = false;
+        } else if (command.args[i] == "if") {
+          condition = command.args[i + 1];
+        } else if (command.args[i] == "hits") {
+          try {
+            hit_count = std::stoull(command.args[i + 1]);
+          } catch (const std::exception &) {
+            valid = false;
+          }
+        } else {
+          valid = false;
+        }
+      }
+      if (!valid) {
+        std::cerr << "Usage: add_breakpoint <line|symbol> [if \"<condition>\"] [hits <n>]" << std::endl;
+        continue;
+      }
+      try {
+        if (std::isdigit(static_cast<unsigned char>(command.args[0][0]))) {
+          vm.AddBreakpoint(std::stoul(command.args[0], nullptr, 10), true, condition, hit_count);
+        } else {
+          vm.AddSymbolBreakpoint(command.args[0], condition, hit_count);
+        }
+      } catch (const std::exception &e) {
+        std::cerr << "Invalid breakpoint: " << e.what() << std::endl;
+        std::cerr << "Usage: add_breakpoint <line|symbol> [if \"<condition>\"] [hits <n>]" << std::endl;
+      }
     } else if (command.type==command_handler::CommandType::REMOVE_BREAKPOINT) {
-      vm.RemoveBreakpoint(std::stoul(command.args[0], nullptr, 10));
+      if (command.args.empty()) {
+        continue;
+      }
+      try {
+        if (std::isdigit(static_cast<unsigned char>(command.args[0][0]))) {
+          vm.RemoveBreakpoint(std::stoul(command.args[0], nullptr, 10));
+        } else {
+          vm.RemoveSymbolBreakpoint(command.args[0]);
+        }
+      } catch (const std::exception &e) {
+        std::cerr << "Invalid breakpoint: " << e.what() << std::endl;
+      }
+    } else if (command.type==command_handler::CommandType::ADD_WATCHPOINT) {
+      if (command.args.size() != 3) {
+        std::cerr << "Usage: add_watchpoint <address (hex)> <length> <r|w|rw>" << std::endl;
+        continue;
+      }
+      try {
+        vm.AddWatchpoint(std::stoull(command.args[0], nullptr, 16), std::stoull(command.args[1]), command.args[2]);
+      } catch (const std::exception &e) {
+        std::cerr << "Invalid watchpoint: " << e.what() << std::endl;
+      }
+    } else if (command.type==command_handler::CommandType::REMOVE_WATCHPOINT) {
+      if (command.args.size() != 1) {
+        std::cerr << "Usage: remove_watchpoint <address (hex)>" << std::endl;
+        continue;
+      }
+      try {
+        vm.RemoveWatchpoint(std::stoull(command.args[0], nullptr, 16));
+      } catch (const std::exception &e) {
+        std::cerr << "Invalid watchpoint: " << e.what() << std::endl;
+      }
     } else if (command.type==command_handler::CommandType::MODIFY_REGISTER) {
       try {
         if (command.args.size() != 2) {
@@ -212,7 +699,8 @@ int main(int argc, char *argv[]) {
         std::string reg_name = command.args[0];
         uint64_t value = std::stoull(command.args[1], nullptr, 16);
         vm.ModifyRegister(reg_name, value);
-        DumpRegisters(globals::registers_dump_file_path, vm.registers_);
+        vm.SyncCounterCsrs();
+        DumpRegisters(vm.context_.paths.registers, vm.registers_);
         std::cout << "VM_MODIFY_REGISTER_SUCCESS" << std::endl;
       } catch (const std::out_of_range &e) {
         std::cout << "VM_MODIFY_REGISTER_ERROR" << std::endl;
@@ -223,21 +711,40 @@ int main(int argc, char *argv[]) {
       }
     } else if (command.type==command_handler::CommandType::GET_REGISTER) {
       std::string reg_str = command.args[0];
+      const bool from_published = vm_running;
+      PublishedState published;
+      if (from_published) {
+        published = vm.state_publisher_.Read();
+      }
       if (reg_str[0] == 'x') {
+        size_t index = std::stoi(reg_str.substr(1));
         std::cout << "value: ";
         std::cout << "0x"
                   << std::hex
-                  << vm.registers_.ReadGpr(std::stoi(reg_str.substr(1))) 
+                  << (from_published ? published.gprs.at(index) : vm.registers_.ReadGpr(index))
                   << std::dec;
         std::cout << ""<< std::endl;
       } else if(reg_str[0] == 'f') {
+        size_t index = std::stoi(reg_str.substr(1));
         std::cout << "value: ";
         std::cout << "0x"
                   << std::hex
-                  << vm.registers_.ReadFpr(std::stoi(reg_str.substr(1))) 
+                  << (from_published ? published.fprs.at(index) : vm.registers_.ReadFpr(index))
                   << std::dec;
         std::cout << ""<< std::endl;
       }
+    } else if (command.type==command_handler::CommandType::GET_STATE) {
+      PublishedState state = vm.state_publisher_.Read();
+      if (!vm_running) {
+        state.program_counter = vm.program_counter_;
+        state.instructions_retired = vm.instructions_retired_;
+        state.cycles = vm.cycle_s_;
+      }
+      std::cout << "VM_STATE pc=0x" << std::hex << state.program_counter << std::dec
+                << " instret=" << state.instructions_retired
+                << " cycles=" << state.cycles
+                << " running=" << (vm_running ? "true" : "false")
+                << " sequence=" << state.sequence << std::endl;
     }
 
   
@@ -277,7 +784,10 @@ int main(int argc, char *argv[]) {
     
     else if (command.type==command_handler::CommandType::DUMP_MEMORY) {
       try {
-        vm.memory_controller_.DumpMemory(command.args);
+        if (!with_memory([&](Memory &memory) { memory.DumpMemory(command.args, vm.context_.paths.memory); })) {
+          std::cout << "VM_MEMORY_DUMP_ERROR" << std::endl;
+          continue;
+        }
       } catch (const std::out_of_range &e) {
         std::cout << "VM_MEMORY_DUMP_ERROR" << std::endl;
         continue;
@@ -286,10 +796,15 @@ int main(int argc, char *argv[]) {
         continue;
       }
     } else if (command.type==command_handler::CommandType::PRINT_MEMORY) {
-      for (size_t i = 0; i < command.args.size(); i+=2) {
-        uint64_t address = std::stoull(command.args[i], nullptr, 16);
-        uint64_t rows = std::stoull(command.args[i+1]);
-        vm.memory_controller_.PrintMemory(address, rows);
+      bool printed = with_memory([&](Memory &memory) {
+        for (size_t i = 0; i < command.args.size(); i+=2) {
+          uint64_t address = std::stoull(command.args[i], nullptr, 16);
+          uint64_t rows = std::stoull(command.args[i+1]);
+          memory.PrintMemory(address, rows);
+        }
+      });
+      if (!printed) {
+        std::cout << "VM_PRINT_MEMORY_ERROR";
       }
       std::cout << std::endl;
     } else if (command.type==command_handler::CommandType::GET_MEMORY_POINT) {
@@ -298,10 +813,38 @@ int main(int argc, char *argv[]) {
         continue;
       }
       // uint64_t address = std::stoull(command.args[0], nullptr, 16);
-      vm.memory_controller_.GetMemoryPoint(command.args[0]);
+      if (!with_memory([&](Memory &memory) { memory.GetMemoryPoint(command.args[0]); })) {
+        std::cout << "VM_GET_MEMORY_POINT_ERROR" << std::endl;
+      }
     } 
 
 
+    else if (command.type==command_handler::CommandType::SAVE_STATE) {
+      if (command.args.size() != 1 || vm_running) {
+        std::cout << "VM_SAVE_STATE_ERROR" << std::endl;
+        continue;
+      }
+      try {
+        vm.SaveState(command.args[0]);
+        std::cout << "VM_SAVE_STATE_SUCCESS" << std::endl;
+      } catch (const std::runtime_error &e) {
+        std::cout << "VM_SAVE_STATE_ERROR" << std::endl;
+        std::cerr << e.what() << '\n';
+      }
+    } else if (command.type==command_handler::CommandType::RESTORE_STATE) {
+      if (command.args.size() != 1 || vm_running) {
+        std::cout << "VM_RESTORE_STATE_ERROR" << std::endl;
+        continue;
+      }
+      try {
+        vm.RestoreState(command.args[0]);
+        std::cout << "VM_RESTORE_STATE_SUCCESS" << std::endl;
+      } catch (const std::exception &e) {
+        std::cout << "VM_RESTORE_STATE_ERROR" << std::endl;
+        std::cerr << e.what() << '\n';
+      }
+    }
+
     else if (command.type==command_handler::CommandType::VM_STDIN) {
       vm.PushInput(command.args[0]);
     }
@@ -0,0 +1,532 @@
+/**
+ * @file sim_server.cpp
+ * @brief Contains the implementation of the simulation server and its VM pool.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "sim_server.h"
+
+#include "assembler/assembler.h"
+#include "assembler/elf_util.h"
+#include "common/null_stream.h"
+#include "vm/rvss/rvss_vm.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace sim_server {
+
+namespace {
+
+constexpr uint64_t kSliceInstructions = 65536; ///< Between checks for the instruction limit and a stop.
+constexpr uint64_t kMaxMemoryRead = uint64_t{1} << 20; ///< Per region of "memory" in a request.
+constexpr size_t kMaxRequestLine = size_t{16} << 20;
+
+std::string ToHex(uint64_t value) {
+  std::ostringstream os;
+  os << "0x" << std::hex << value;
+  return os.str();
+}
+
+std::string ConfigValueText(const json::Value &value) {
+  switch (value.type) {
+    case json::Value::Type::kString:
+    case json::Value::Type::kNumber:
+      return value.text;
+    case json::Value::Type::kBool:
+      return value.boolean ? "true" : "false";
+    default:
+      throw std::runtime_error("config values must be strings, numbers or booleans");
+  }
+}
+
+bool NamesHostPath(const std::string &key) {
+  // A job must not make the server read or write host files other than its program.
+  return key == "trace_file" || key == "stdin_file" || key == "sandbox_directory";
+}
+
+JobResult RunJob(std::unique_ptr<RVSSVM> &vm, const JobRequest &request, const VmContext &base_context,
+                 const std::filesystem::path &scratch_source, const std::atomic<bool> &stopping) {
+  JobResult result;
+  result.id = request.id;
+  auto start = std::chrono::steady_clock::now();
+  bool loaded = false;
+
+  try {
+    VmContext context = base_context;
+    for (const auto &[section, key, value] : request.config_overrides) {
+      context.config.modifyConfig(section, key, value);
+    }
+    const uint64_t limit = request.max_instructions.value_or(context.config.getInstructionExecutionLimit());
+
+    // The memory table is built for a size and block size; any other VM state is reset per job.
+    if (!vm || vm->context_.config.getMemorySize() != context.config.getMemorySize()
+        || vm->context_.config.getMemoryBlockSize() != context.config.getMemoryBlockSize()) {
+      vm = std::make_unique<RVSSVM>(context);
+    } else {
+      vm->context_ = context;
+      vm->Reset();
+    }
+
+    std::filesystem::path program = request.program;
+    if (program.empty()) {
+      std::ofstream source(scratch_source, std::ios::trunc);
+      source << request.source;
+      if (!source.flush()) {
+        throw std::runtime_error("Unable to write " + scratch_source.string());
+      }
+      program = scratch_source;
+    }
+    try {
+      if (isElfFile(program.string())) {
+        vm->LoadElfProgram(program.string());
+      } else {
+        vm->LoadProgram(assemble(program.string(), false));
+      }
+    } catch (const std::runtime_error &e) {
+      std::string message = e.what();
+      if (request.program.empty()) {
+        size_t at = message.find(scratch_source.string());
+        if (at != std::string::npos) {
+          message.replace(at, scratch_source.string().size(), "<source>");
+        }
+      }
+      throw std::runtime_error(message);
+    }
+    loaded = true;
+    vm->guest_io_.SetCaptureOutput(true);
+    vm->guest_io_.SetStdin(request.stdin_text);
+
+    while (!vm->IsHalted()) {
+      if (result.instructions >= limit) {
+        result.status = JobStatus::kTimeout;
+        result.error = "instruction limit exceeded";
+        break;
+      }
+      if (stopping.load(std::memory_order_relaxed)) {
+        throw std::runtime_error("server stopping");
+      }
+      result.instructions += vm->RunQuantum(std::min(kSliceInstructions, limit - result.instructions));
+    }
+    if (vm->exited_) {
+      result.status = JobStatus::kExited;
+      result.exit_code = vm->exit_code_;
+    }
+    result.pc = vm->program_counter_;
+  } catch (const std::exception &e) {
+    result.status = JobStatus::kError;
+    result.error = e.what();
+    if (loaded) {
+      result.pc = vm->current_delta_.old_pc;
+    }
+  }
+
+  if (loaded) {
+    vm->guest_io_.Flush();
+    result.stdout_text = vm->guest_io_.GetCapturedStdout();
+    result.stderr_text = vm->guest_io_.GetCapturedStderr();
+    result.cycles = vm->cycle_s_;
+    if (request.include_registers) {
+      result.gprs.emplace();
+      result.fprs.emplace();
+      for (size_t i = 0; i < 32; ++i) {
+        (*result.gprs)[i] = vm->registers_.ReadGpr(i);
+        (*result.fprs)[i] = vm->registers_.ReadFpr(i);
+      }
+    }
+    for (const auto &[address, length] : request.memory_reads) {
+      std::vector<uint8_t> bytes(length);
+      try {
+        vm->memory_controller_.ReadBlock(address, bytes);
+      } catch (const std::exception &e) {
+        result.status = JobStatus::kError;
+        result.error = "memory " + ToHex(address) + ": " + e.what();
+        break;
+      }
+      result.memory.emplace_back(address, std::move(bytes));
+    }
+  }
+  result.wall_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
+
+} // namespace
+
+const char *StatusName(JobStatus status) {
+  switch (status) {
+    case JobStatus::kEnded: return "ended";
+    case JobStatus::kExited: return "exited";
+    case JobStatus::kTimeout: return "timeout";
+    case JobStatus::kError: return "error";
+  }
+  return "error";
+}
+
+JobRequest ParseJobRequest(std::string_view line) {
+  json::Value message = json::Parse(line);
+  if (message.type != json::Value::Type::kObject) {
+    throw std::runtime_error("a job must be a JSON object");
+  }
+  JobRequest request;
+  if (const json::Value *id = message.Find("id")) {
+    request.id = *id;
+  }
+  for (const auto &[name, value] : message.object) {
+    try {
+      if (name == "id") {
+        continue;
+      } else if (name == "program") {
+        request.program = value.AsString();
+        if (request.program.empty()) {
+          throw std::runtime_error("expected a path");
+        }
+      } else if (name == "source") {
+        request.source = value.AsString();
+      } else if (name == "stdin") {
+        request.stdin_text = value.AsString();
+      } else if (name == "max_instructions") {
+        request.max_instructions = value.AsUint64();
+      } else if (name == "registers") {
+        request.include_registers = value.AsBool();
+      } else if (name == "config") {
+        if (value.type != json::Value::Type::kObject) {
+          throw std::runtime_error("expected an object of sections");
+        }
+        for (const auto &[section, keys] : value.object) {
+          if (keys.type != json::Value::Type::kObject) {
+            throw std::runtime_error("expected an object of keys in section " + section);
+          }
+          for (const auto &[key, setting] : keys.object) {
+            if (NamesHostPath(key)) {
+              throw std::runtime_error(key + " cannot be set by a job");
+            }
+            request.config_overrides.push_back({section, key, ConfigValueText(setting)});
+          }
+        }
+      } else if (name == "memory") {
+        if (value.type != json::Value::Type::kArray) {
+          throw std::runtime_error("expected an array of [address, length] pairs");
+        }
+        for (const json::Value &region : value.array) {
+          if (region.type != json::Value::Type::kArray || region.array.size() != 2) {
+            throw std::runtime_error("expected an [address, length] pair");
+          }
+          uint64_t length = region.array[1].AsUint64();
+          if (length > kMaxMemoryRead) {
+            throw std::runtime_error("at most " + std::to_string(kMaxMemoryRead) + " bytes per region");
+          }
+          request.memory_reads.emplace_back(region.array[0].AsUint64(), length);
+        }
+      } else {
+        throw std::runtime_error("unknown member");
+      }
+    } catch (const std::runtime_error &e) {
+      throw std::runtime_error("\"" + name + "\": " + e.what());
+    }
+  }
+  if ((message.Find("program") == nullptr) == (message.Find("source") == nullptr)) {
+    throw std::runtime_error("a job needs exactly one of \"program\" and \"source\"");
+  }
+  return request;
+}
+
+std::string FormatJobResult(const JobResult &result) {
+  json::Value answer = json::Value::Object();
+  answer.Set("id", result.id);
+  answer.Set("status", json::Value::String(StatusName(result.status)));
+  if (result.status == JobStatus::kExited) {
+    answer.Set("exit_code", json::Value::Number(result.exit_code));
+  }
+  answer.Set("instructions", json::Value::Number(result.instructions));
+  answer.Set("cycles", json::Value::Number(result.cycles));
+  answer.Set("wall_time_ms", json::Value::Number(result.wall_time_ms));
+  answer.Set("stdout", json::Value::String(result.stdout_text));
+  if (!result.stderr_text.empty()) {
+    answer.Set("stderr", json::Value::String(result.stderr_text));
+  }
+  if (result.status == JobStatus::kError || result.status == JobStatus::kTimeout) {
+    answer.Set("error", json::Value::String(result.error));
+    answer.Set("pc", json::Value::String(ToHex(result.pc)));
+  }
+  if (result.gprs && result.fprs) {
+    json::Value &registers = answer.Set("registers", json::Value::Object());
+    for (size_t i = 0; i < 32; ++i) {
+      registers.Set("x" + std::to_string(i), json::Value::String(ToHex((*result.gprs)[i])));
+    }
+    for (size_t i = 0; i < 32; ++i) {
+      registers.Set("f" + std::to_string(i), json::Value::String(ToHex((*result.fprs)[i])));
+    }
+  }
+  if (!result.memory.empty()) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    json::Value &memory = answer.Set("memory", json::Value::Array());
+    for (const auto &[address, bytes] : result.memory) {
+      std::string hex;
+      hex.reserve(2*bytes.size());
+      for (uint8_t byte : bytes) {
+        hex += kHex[byte >> 4];
+        hex += kHex[byte & 0xF];
+      }
+      json::Value region = json::Value::Object();
+      region.Set("address", json::Value::String(ToHex(address)));
+      region.Set("bytes", json::Value::String(std::move(hex)));
+      memory.array.push_back(std::move(region));
+    }
+  }
+  return json::Serialize(answer);
+}
+
+VmPool::VmPool(VmContext base_context, unsigned int workers, std::filesystem::path scratch_directory)
+    : base_context_(std::move(base_context)), scratch_directory_(std::move(scratch_directory)) {
+  base_context_.dump_state = false;
+  base_context_.vm_as_backend = false;
+  if (workers == 0) {
+    workers = std::max(1u, std::thread::hardware_concurrency());
+  }
+  std::filesystem::create_directories(scratch_directory_);
+  for (unsigned int i = 0; i < workers; ++i) {
+    workers_.emplace_back(&VmPool::WorkerLoop, this, i);
+  }
+}
+
+VmPool::~VmPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+void VmPool::Submit(JobRequest request, std::function<void(JobResult)> done) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back({std::move(request), std::move(done)});
+  }
+  cv_.notify_one();
+}
+
+void VmPool::WorkerLoop(unsigned int index) {
+  std::unique_ptr<RVSSVM> vm;
+  const std::filesystem::path scratch_source = scratch_directory_ / ("worker_" + std::to_string(index) + ".s");
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]() { return stopping_ || !queue_.empty(); });
+      if (stopping_) {
+        return;
+      }
+      job = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    job.done(RunJob(vm, job.request, base_context_, scratch_source, stopping_));
+  }
+}
+
+struct Server::Connection {
+  int fd;
+  std::mutex write_mutex;
+
+  explicit Connection(int fd) : fd(fd) {}
+
+  ~Connection() {
+    ::close(fd);
+  }
+
+  /**
+   * @brief Writes a line whole, even when answers from several workers race. A client that went
+   *        away loses its answers; the server carries on.
+   */
+  void WriteLine(std::string line) {
+    line += '\n';
+    std::lock_guard<std::mutex> lock(write_mutex);
+    size_t written = 0;
+    while (written < line.size()) {
+      ssize_t n = ::send(fd, line.data() + written, line.size() - written, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        return;
+      }
+      written += static_cast<size_t>(n);
+    }
+  }
+};
+
+Server::Server(const std::filesystem::path &socket_path, VmContext base_context, unsigned int workers)
+    : socket_path_(socket_path),
+      scratch_directory_(std::filesystem::temp_directory_path() / ("vm_server_" + std::to_string(::getpid()))) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (socket_path.string().size() >= sizeof(address.sun_path)) {
+    throw std::runtime_error("Socket path too long: " + socket_path.string());
+  }
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+
+  if (::pipe(wake_fds_) != 0) {
+    throw std::runtime_error(std::string("Unable to create a pipe: ") + std::strerror(errno));
+  }
+  listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (listen_fd_ < 0) {
+    throw std::runtime_error(std::string("Unable to create a socket: ") + std::strerror(errno));
+  }
+  std::error_code ignored;
+  std::filesystem::remove(socket_path, ignored);
+  if (::bind(listen_fd_, reinterpret_cast<sockaddr *>(&address), sizeof(address)) != 0
+      || ::listen(listen_fd_, SOMAXCONN) != 0) {
+    std::string error = std::strerror(errno);
+    ::close(listen_fd_);
+    ::close(wake_fds_[0]);
+    ::close(wake_fds_[1]);
+    throw std::runtime_error("Unable to listen on " + socket_path.string() + ": " + error);
+  }
+  pool_ = std::make_unique<VmPool>(std::move(base_context), workers, scratch_directory_ / "sources");
+}
+
+Server::~Server() {
+  Stop();
+  pool_.reset();
+  ::close(listen_fd_);
+  ::close(wake_fds_[0]);
+  ::close(wake_fds_[1]);
+  std::error_code ignored;
+  std::filesystem::remove(socket_path_, ignored);
+  std::filesystem::remove_all(scratch_directory_, ignored);
+}
+
+void Server::Stop() {
+  stopping_.store(true);
+  char byte = 0;
+  // Serve may already have stopped and the pipe be full; either way there is nothing to do.
+  [[maybe_unused]] ssize_t ignored = ::write(wake_fds_[1], &byte, 1);
+}
+
+void Server::Serve() {
+  // The VMs report their status on std::cout; answers go to the sockets instead.
+  NullBuffer null_buffer;
+  std::streambuf *cout_buffer = std::cout.rdbuf(&null_buffer);
+
+  while (!stopping_) {
+    pollfd fds[2] = {{listen_fd_, POLLIN, 0}, {wake_fds_[0], POLLIN, 0}};
+    if (::poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (fds[1].revents != 0 || stopping_) {
+      break;
+    }
+    if ((fds[0].revents & POLLIN) == 0) {
+      continue;
+    }
+    int fd = ::accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+
+    auto connection = std::make_shared<Connection>(fd);
+    auto finished = std::make_shared<std::atomic<bool>>(false);
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    // Join the readers of connections whose clients have finished writing.
+    std::erase_if(readers_, [](auto &reader) {
+      if (!reader.second->load()) {
+        return false;
+      }
+      reader.first.join();
+      return true;
+    });
+    std::erase_if(connections_, [](const std::weak_ptr<Connection> &weak) { return weak.expired(); });
+    connections_.push_back(connection);
+    readers_.emplace_back(std::thread([this, connection, finished]() {
+      ReadConnection(connection);
+      finished->store(true);
+    }), finished);
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    for (const std::weak_ptr<Connection> &weak : connections_) {
+      if (std::shared_ptr<Connection> connection = weak.lock()) {
+        ::shutdown(connection->fd, SHUT_RDWR);
+      }
+    }
+    for (auto &reader : readers_) {
+      reader.first.join();
+    }
+    readers_.clear();
+    connections_.clear();
+  }
+  std::cout.rdbuf(cout_buffer);
+}
+
+void Server::ReadConnection(std::shared_ptr<Connection> connection) {
+  std::string buffer;
+  char chunk[4096];
+  while (true) {
+    ssize_t n = ::recv(connection->fd, chunk, sizeof(chunk), 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return;
+    }
+    buffer.append(chunk, static_cast<size_t>(n));
+
+    size_t start = 0;
+    for (size_t end = buffer.find('\n'); end != std::string::npos; end = buffer.find('\n', start)) {
+      std::string_view line(buffer.data() + start, end - start);
+      start = end + 1;
+      if (line.find_first_not_of(" \t\r") == std::string_view::npos) {
+        continue;
+      }
+      JobRequest request;
+      try {
+        request = ParseJobRequest(line);
+      } catch (const std::exception &e) {
+        JobResult result;
+        result.status = JobStatus::kError;
+        result.error = std::string("bad request: ") + e.what();
+        // Answer with the id when the line was valid JSON, so the client can still match it.
+        try {
+          json::Value message = json::Parse(line);
+          if (const json::Value *id = message.Find("id")) {
+            result.id = *id;
+          }
+        } catch (const std::exception &) {
+        }
+        connection->WriteLine(FormatJobResult(result));
+        continue;
+      }
+      pool_->Submit(std::move(request), [this, connection](JobResult result) {
+        connection->WriteLine(FormatJobResult(result));
+        jobs_completed_.fetch_add(1, std::memory_order_relaxed);
+      });
+    }
+    buffer.erase(0, start);
+    if (buffer.size() > kMaxRequestLine) {
+      JobResult result;
+      result.status = JobStatus::kError;
+      result.error = "bad request: line longer than " + std::to_string(kMaxRequestLine) + " bytes";
+      connection->WriteLine(FormatJobResult(result));
+      return;
+    }
+  }
+}
+
+} // namespace sim_server
@@ -0,0 +1,510 @@
+/**
+ * @file simpoint.cpp
+ * @brief Contains the implementation of SimPoint-style sampled simulation.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "simpoint.h"
+
+#include "assembler/assembler.h"
+#include "assembler/elf_util.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace simpoint {
+
+namespace {
+
+// RunQuantum keeps one slice of undo deltas, and a slice's cycles fit the 32-bit cycle counter.
+constexpr uint64_t kSliceInstructions = 65536;
+
+// SimPoint projects to 15 dimensions; more buys little clustering accuracy for the time.
+constexpr unsigned int kDimensions = 15;
+constexpr unsigned int kRestarts = 5;
+constexpr unsigned int kMaxIterations = 100;
+constexpr double kBicThreshold = 0.9;
+
+using Point = std::array<double, kDimensions>;
+
+uint64_t SplitMix64(uint64_t x) {
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30))*0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27))*0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// The projection matrix is never stored: each entry is a hash of its block and dimension.
+double Coefficient(uint64_t seed, uint32_t block, unsigned int dimension) {
+  uint64_t bits = SplitMix64(seed ^ SplitMix64((uint64_t{block} << 4) | dimension));
+  return static_cast<double>(bits >> 11)*0x1.0p-52 - 1.0;
+}
+
+double Distance2(const Point &a, const Point &b) {
+  double sum = 0;
+  for (unsigned int d = 0; d < kDimensions; ++d) {
+    double delta = a[d] - b[d];
+    sum += delta*delta;
+  }
+  return sum;
+}
+
+struct KMeansResult {
+  std::vector<unsigned int> assignment;
+  std::vector<Point> centroids;
+  double distortion = 0; ///< Sum of squared distances to the assigned centroids.
+};
+
+KMeansResult KMeans(const std::vector<Point> &points, unsigned int k, std::mt19937_64 &rng) {
+  const size_t n = points.size();
+  KMeansResult result;
+
+  // k-means++: each further centroid is a point drawn with probability proportional to its
+  // squared distance from the centroids chosen so far.
+  result.centroids.push_back(points[std::uniform_int_distribution<size_t>(0, n - 1)(rng)]);
+  std::vector<double> nearest(n);
+  for (size_t i = 0; i < n; ++i) {
+    nearest[i] = Distance2(points[i], result.centroids[0]);
+  }
+  while (result.centroids.size() < k) {
+    double total = std::accumulate(nearest.begin(), nearest.end(), 0.0);
+    size_t chosen = 0;
+    if (total > 0) {
+      double target = std::uniform_real_distribution<double>(0, total)(rng);
+      while (chosen + 1 < n && target >= nearest[chosen]) {
+        target -= nearest[chosen];
+        ++chosen;
+      }
+    } else {
+      chosen = std::uniform_int_distribution<size_t>(0, n - 1)(rng);
+    }
+    result.centroids.push_back(points[chosen]);
+    for (size_t i = 0; i < n; ++i) {
+      nearest[i] = std::min(nearest[i], Distance2(points[i], result.centroids.back()));
+    }
+  }
+
+  result.assignment.assign(n, 0);
+  for (unsigned int iteration = 0; iteration < kMaxIterations; ++iteration) {
+    bool changed = iteration == 0;
+    for (size_t i = 0; i < n; ++i) {
+      unsigned int best = 0;
+      double best_distance = Distance2(points[i], result.centroids[0]);
+      for (unsigned int c = 1; c < k; ++c) {
+        double distance = Distance2(points[i], result.centroids[c]);
+        if (distance < best_distance) {
+          best = c;
+          best_distance = distance;
+        }
+      }
+      changed |= result.assignment[i] != best;
+      result.assignment[i] = best;
+    }
+    if (!changed) {
+      break;
+    }
+    std::vector<Point> sums(k, Point{});
+    std::vector<size_t> sizes(k, 0);
+    for (size_t i = 0; i < n; ++i) {
+      for (unsigned int d = 0; d < kDimensions; ++d) {
+        sums[result.assignment[i]][d] += points[i][d];
+      }
+      ++sizes[result.assignment[i]];
+    }
+    // A cluster that lost all its points keeps its centroid.
+    for (unsigned int c = 0; c < k; ++c) {
+      if (sizes[c] > 0) {
+        for (unsigned int d = 0; d < kDimensions; ++d) {
+          result.centroids[c][d] = sums[c][d]/static_cast<double>(sizes[c]);
+        }
+      }
+    }
+  }
+
+  for (size_t i = 0; i < n; ++i) {
+    result.distortion += Distance2(points[i], result.centroids[result.assignment[i]]);
+  }
+  return result;
+}
+
+// Bayesian information criterion of a clustering under the identical spherical Gaussian
+// model of Pelleg and Moore's X-means; larger is better.
+double Bic(const KMeansResult &clustering, size_t n, unsigned int k) {
+  const auto r = static_cast<double>(n);
+  const auto m = static_cast<double>(kDimensions);
+  double variance = n > k ? clustering.distortion/(m*(r - k)) : 0;
+  variance = std::max(variance, 1e-12);
+  std::vector<size_t> sizes(k, 0);
+  for (unsigned int cluster : clustering.assignment) {
+    ++sizes[cluster];
+  }
+  double likelihood = -r*std::log(r) - r*m/2*std::log(2*M_PI*variance) - m*(r - k)/2;
+  for (size_t size : sizes) {
+    if (size > 0) {
+      likelihood += static_cast<double>(size)*std::log(static_cast<double>(size));
+    }
+  }
+  double parameters = (k - 1) + m*k + 1;
+  return likelihood - parameters/2*std::log(r);
+}
+
+void ClearDelta(RVSSVM &vm) {
+  vm.current_delta_.register_changes.clear();
+  vm.current_delta_.memory_changes.clear();
+}
+
+// Runs up to instructions instructions, fewer if the program ends.
+uint64_t RunFor(RVSSVM &vm, uint64_t instructions) {
+  uint64_t executed = 0;
+  while (executed < instructions && !vm.IsHalted()) {
+    executed += vm.RunQuantum(std::min(kSliceInstructions, instructions - executed));
+  }
+  return executed;
+}
+
+// Runs like RunFor and returns what the cache and branch predictor models saw meanwhile.
+IntervalStats Measure(RVSSVM &vm, uint64_t instructions) {
+  IntervalStats stats;
+  vm.data_cache_.ResetStats();
+  uint64_t branches = vm.branch_predictor_.GetStats().Branches();
+  uint64_t mispredictions = vm.branch_predictor_.GetStats().Mispredictions();
+  while (stats.instructions < instructions && !vm.IsHalted()) {
+    uint64_t cycles = vm.cycle_s_;
+    stats.instructions += vm.RunQuantum(std::min(kSliceInstructions, instructions - stats.instructions));
+    stats.cycles += vm.cycle_s_ - cycles;
+  }
+  stats.cache_accesses = vm.data_cache_.GetStats().accesses;
+  stats.cache_misses = vm.data_cache_.GetStats().misses;
+  stats.branches = vm.branch_predictor_.GetStats().Branches() - branches;
+  stats.mispredictions = vm.branch_predictor_.GetStats().Mispredictions() - mispredictions;
+  return stats;
+}
+
+void Load(RVSSVM &vm, const std::filesystem::path &program) {
+  if (isElfFile(program.string())) {
+    vm.LoadElfProgram(program.string());
+  } else {
+    vm.LoadProgram(assemble(program.string(), false));
+  }
+  vm.guest_io_.SetCaptureOutput(true);
+}
+
+double Ratio(uint64_t numerator, uint64_t denominator) {
+  return denominator == 0 ? 0.0 : static_cast<double>(numerator)/static_cast<double>(denominator);
+}
+
+std::string Percent(double fraction) {
+  std::ostringstream os;
+  os << std::fixed << std::setprecision(2) << 100*fraction << "%";
+  return os.str();
+}
+
+} // namespace
+
+double IntervalStats::Cpi() const {
+  return Ratio(cycles, instructions);
+}
+
+double IntervalStats::CacheMissRate() const {
+  return Ratio(cache_misses, cache_accesses);
+}
+
+double IntervalStats::MispredictionRate() const {
+  return Ratio(mispredictions, branches);
+}
+
+double IntervalStats::Mpki() const {
+  return 1000*Ratio(mispredictions, instructions);
+}
+
+BasicBlockVectors CollectBasicBlockVectors(RVSSVM &vm, uint64_t interval_size, uint64_t max_instructions) {
+  BasicBlockVectors bbvs;
+  std::unordered_map<uint64_t, uint32_t> block_ids;
+  std::vector<uint64_t> counts; // Of the current interval, indexed by block id.
+  std::vector<uint32_t> touched; // Blocks with a non-zero count.
+  auto block_id = [&](uint64_t pc) {
+    auto [it, inserted] = block_ids.try_emplace(pc, static_cast<uint32_t>(bbvs.block_starts.size()));
+    if (inserted) {
+      bbvs.block_starts.push_back(pc);
+      counts.push_back(0);
+    }
+    return it->second;
+  };
+
+  uint32_t block = block_id(vm.program_counter_);
+  uint64_t in_block = 0;
+  uint64_t in_interval = 0;
+  auto flush_block = [&]() {
+    if (in_block > 0) {
+      if (counts[block] == 0) {
+        touched.push_back(block);
+      }
+      counts[block] += in_block;
+      in_block = 0;
+    }
+  };
+  auto flush_interval = [&]() {
+    flush_block();
+    std::sort(touched.begin(), touched.end());
+    auto &vector = bbvs.intervals.emplace_back();
+    vector.reserve(touched.size());
+    for (uint32_t id : touched) {
+      vector.emplace_back(id, counts[id]);
+      counts[id] = 0;
+    }
+    touched.clear();
+    bbvs.interval_instructions.push_back(in_interval);
+    in_interval = 0;
+  };
+
+  const uint64_t limit = max_instructions == 0 ? std::numeric_limits<uint64_t>::max() : max_instructions;
+  while (!vm.IsHalted() && bbvs.total_instructions < limit) {
+    uint64_t pc = vm.program_counter_;
+    vm.StepHeadless();
+    ClearDelta(vm);
+    ++in_block;
+    ++in_interval;
+    ++bbvs.total_instructions;
+    if (in_interval == interval_size) {
+      flush_interval();
+    }
+    if (vm.program_counter_ != pc + 4) {
+      flush_block();
+      block = block_id(vm.program_counter_);
+    }
+  }
+  if (in_interval > 0) {
+    flush_interval();
+  }
+  return bbvs;
+}
+
+Clustering ClusterIntervals(const BasicBlockVectors &bbvs, unsigned int max_k, uint64_t seed) {
+  const size_t n = bbvs.intervals.size();
+  Clustering clustering;
+  if (n == 0) {
+    return clustering;
+  }
+
+  // Normalised so intervals compare by where they spend their time, not how long they are.
+  std::vector<Point> points(n, Point{});
+  for (size_t i = 0; i < n; ++i) {
+    auto total = static_cast<double>(bbvs.interval_instructions[i]);
+    for (auto [block, count] : bbvs.intervals[i]) {
+      double share = static_cast<double>(count)/total;
+      for (unsigned int d = 0; d < kDimensions; ++d) {
+        points[i][d] += share*Coefficient(seed, block, d);
+      }
+    }
+  }
+
+  std::mt19937_64 rng(seed);
+  std::vector<KMeansResult> results;
+  std::vector<double> scores;
+  const auto largest_k = static_cast<unsigned int>(std::min<size_t>(max_k, n));
+  for (unsigned int k = 1; k <= largest_k; ++k) {
+    KMeansResult best;
+    for (unsigned int restart = 0; restart < kRestarts; ++restart) {
+      KMeansResult result = KMeans(points, k, rng);
+      if (restart == 0 || result.distortion < best.distortion) {
+        best = std::move(result);
+      }
+    }
+    scores.push_back(Bic(best, n, k));
+    results.push_back(std::move(best));
+  }
+  auto [worst, best] = std::minmax_element(scores.begin(), scores.end());
+  double threshold = *worst + kBicThreshold*(*best - *worst);
+  size_t chosen = 0;
+  while (scores[chosen] < threshold) {
+    ++chosen;
+  }
+  const KMeansResult &result = results[chosen];
+
+  // Renumbers the clusters that kept points, in order of their first interval.
+  std::vector<unsigned int> renumbered(chosen + 1, UINT32_MAX);
+  clustering.assignment.resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    unsigned int &cluster = renumbered[result.assignment[i]];
+    if (cluster == UINT32_MAX) {
+      cluster = clustering.k++;
+      clustering.representatives.push_back(i);
+      clustering.weights.push_back(0);
+    }
+    clustering.assignment[i] = cluster;
+  }
+  std::vector<double> closest(clustering.k, std::numeric_limits<double>::infinity());
+  for (size_t i = 0; i < n; ++i) {
+    unsigned int cluster = clustering.assignment[i];
+    double distance = Distance2(points[i], result.centroids[result.assignment[i]]);
+    if (distance < closest[cluster]) {
+      closest[cluster] = distance;
+      clustering.representatives[cluster] = i;
+    }
+    clustering.weights[cluster] += Ratio(bbvs.interval_instructions[i], bbvs.total_instructions);
+  }
+  return clustering;
+}
+
+SimPointReport Run(const std::filesystem::path &program, VmContext context, const SimPointOptions &options,
+                   std::ostream &log) {
+  if (options.interval_size == 0 || options.max_k == 0) {
+    throw std::invalid_argument("SimPoint interval size and max k must be positive");
+  }
+  context.dump_state = false;
+  context.vm_as_backend = false;
+  context.config.setTraceFile("");
+  context.config.setProfilingEnabled(false);
+  vm_config::VmConfig detailed = context.config;
+  detailed.setCacheEnabled(true);
+  if (detailed.getBranchPredictorType() == vm_config::BranchPredictorType::NONE) {
+    detailed.setBranchPredictorType(vm_config::BranchPredictorType::GSHARE);
+  }
+  cache::Cache().Start(detailed); // Rejects a bad geometry before the functional runs.
+  VmContext functional = context;
+  functional.config.setCacheEnabled(false);
+  functional.config.setBranchPredictorType(vm_config::BranchPredictorType::NONE);
+  functional.config.setTimingEnabled(false);
+
+  auto vm = std::make_unique<RVSSVM>(functional);
+  Load(*vm, program);
+  VmSnapshot entry = vm->Snapshot();
+
+  log << "Collecting basic-block vectors, " << options.interval_size << " instructions per interval" << std::endl;
+  BasicBlockVectors bbvs = CollectBasicBlockVectors(*vm, options.interval_size, options.max_instructions);
+  Clustering clustering = ClusterIntervals(bbvs, options.max_k, options.seed);
+
+  SimPointReport report;
+  report.total_instructions = bbvs.total_instructions;
+  report.interval_size = options.interval_size;
+  report.intervals = bbvs.intervals.size();
+  report.blocks = bbvs.block_starts.size();
+  std::vector<uint64_t> starts(bbvs.intervals.size(), 0);
+  for (size_t i = 1; i < starts.size(); ++i) {
+    starts[i] = starts[i - 1] + bbvs.interval_instructions[i - 1];
+  }
+  for (unsigned int cluster = 0; cluster < clustering.k; ++cluster) {
+    size_t interval = clustering.representatives[cluster];
+    report.points.push_back({interval, starts[interval], clustering.weights[cluster], {}});
+  }
+  std::sort(report.points.begin(), report.points.end(),
+            [](const SimulationPoint &a, const SimulationPoint &b) { return a.start < b.start; });
+  log << bbvs.total_instructions << " instructions in " << report.intervals << " intervals and "
+      << report.blocks << " basic blocks; " << report.points.size() << " simulation points" << std::endl;
+
+  // Fast-forwards functionally to each point's warm-up, snapshotting on the way.
+  std::vector<VmSnapshot> snapshots;
+  std::vector<uint64_t> warmups;
+  vm->Fork(entry);
+  uint64_t position = 0;
+  for (const SimulationPoint &point : report.points) {
+    uint64_t warmup_start = point.start - std::min(options.warmup, point.start);
+    position += RunFor(*vm, warmup_start - position);
+    snapshots.push_back(vm->Snapshot());
+    snapshots.back().config = detailed;
+    warmups.push_back(point.start - warmup_start);
+  }
+  vm.reset();
+
+  unsigned int jobs = options.jobs == 0 ? std::max(1u, std::thread::hardware_concurrency()) : options.jobs;
+  jobs = static_cast<unsigned int>(std::min<size_t>(jobs, std::max<size_t>(report.points.size(), 1)));
+  log << "Running " << report.points.size() << " simulation points on " << jobs << " workers" << std::endl;
+  std::atomic<size_t> next = 0;
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  std::vector<std::thread> workers;
+  for (unsigned int worker = 0; worker < jobs; ++worker) {
+    workers.emplace_back([&]() {
+      try {
+        RVSSVM detailed_vm(context);
+        detailed_vm.guest_io_.SetCaptureOutput(true);
+        for (size_t i = next++; i < report.points.size(); i = next++) {
+          SimulationPoint &point = report.points[i];
+          detailed_vm.Fork(snapshots[i]);
+          RunFor(detailed_vm, warmups[i]);
+          point.stats = Measure(detailed_vm, bbvs.interval_instructions[point.interval]);
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(error_mutex);
+        error = std::current_exception();
+      }
+    });
+  }
+  for (auto &worker : workers) {
+    worker.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  // Rates combine per-instruction counts, so each point counts by its weight, not its accesses.
+  double accesses = 0;
+  double misses = 0;
+  double branches = 0;
+  double mispredictions = 0;
+  for (size_t i = 0; i < report.points.size(); ++i) {
+    const SimulationPoint &point = report.points[i];
+    auto instructions = static_cast<double>(std::max<uint64_t>(point.stats.instructions, 1));
+    report.cpi += point.weight*point.stats.Cpi();
+    accesses += point.weight*static_cast<double>(point.stats.cache_accesses)/instructions;
+    misses += point.weight*static_cast<double>(point.stats.cache_misses)/instructions;
+    branches += point.weight*static_cast<double>(point.stats.branches)/instructions;
+    mispredictions += point.weight*static_cast<double>(point.stats.mispredictions)/instructions;
+    report.detailed_instructions += warmups[i] + point.stats.instructions;
+  }
+  report.cache_miss_rate = accesses > 0 ? misses/accesses : 0;
+  report.misprediction_rate = branches > 0 ? mispredictions/branches : 0;
+  report.mpki = 1000*mispredictions;
+
+  if (options.compare) {
+    log << "Running the whole program in detailed mode" << std::endl;
+    entry.config = detailed;
+    RVSSVM full(context);
+    full.guest_io_.SetCaptureOutput(true);
+    full.Fork(entry);
+    report.full = Measure(full, bbvs.total_instructions);
+  }
+  return report;
+}
+
+void WriteReport(std::ostream &os, const SimPointReport &report) {
+  os << "SimPoint: " << report.total_instructions << " instructions, " << report.intervals
+     << " intervals of " << report.interval_size << ", " << report.blocks << " basic blocks, "
+     << report.points.size() << " simulation points\n";
+  os << "Detailed instructions: " << report.detailed_instructions << " ("
+     << Percent(Ratio(report.detailed_instructions, report.total_instructions)) << " of the program)\n";
+  os << std::fixed << std::setprecision(4);
+  os << "Weighted CPI: " << report.cpi << "\n";
+  os << "Weighted D-cache miss rate: " << Percent(report.cache_miss_rate) << "\n";
+  os << "Weighted branch misprediction rate: " << Percent(report.misprediction_rate)
+     << " (MPKI " << std::setprecision(2) << report.mpki << ")\n";
+  if (report.full) {
+    double error = report.full->Cpi() == 0 ? 0 : (report.cpi - report.full->Cpi())/report.full->Cpi();
+    os << std::setprecision(4) << "Full detailed run: CPI " << report.full->Cpi() << " (sampling error "
+       << Percent(error) << "), D-cache miss rate " << Percent(report.full->CacheMissRate())
+       << ", branch misprediction rate " << Percent(report.full->MispredictionRate()) << "\n";
+  }
+  os << "\n" << std::left << std::setw(10) << "Interval" << std::setw(14) << "Start" << std::setw(10)
+     << "Weight" << std::setw(10) << "CPI" << std::setw(12) << "Miss rate" << "Mispredict rate\n";
+  for (const SimulationPoint &point : report.points) {
+    os << std::setw(10) << point.interval << std::setw(14) << point.start << std::setw(10)
+       << std::setprecision(4) << point.weight << std::setw(10) << point.stats.Cpi() << std::setw(12)
+       << Percent(point.stats.CacheMissRate()) << Percent(point.stats.MispredictionRate()) << "\n";
+  }
+  os << std::right << std::defaultfloat;
+}
+
+} // namespace simpoint
@@ -468,6 +468,52 @@ void DumpDisasssembly(const std::filesystem::path &filename, AssembledProgram &p
 }
 
 
+void DumpElfDisassembly(const std::filesystem::path &filename, AssembledProgram &program, uint64_t text_start) {
+  std::ofstream out(filename);
+  if (!out) {
+    std::cerr << "Failed to open disassembly output file: " << filename << std::endl;
+    return;
+  }
+
+  std::map<uint64_t, std::string> label_for_address;
+  for (const auto& [name, data] : program.symbol_table) {
+    if (!data.isData) {
+      label_for_address.emplace(data.address, name);
+    }
+  }
+
+  std::map<unsigned int, unsigned int> instruction_number_disassembly_mapping;
+  unsigned int line_number = 1;
+
+  for (unsigned int instruction_index = 0; instruction_index < program.text_buffer.size(); ++instruction_index) {
+    uint64_t current_address = text_start + instruction_index * 4;
+
+    auto it = label_for_address.find(current_address);
+    if (it != label_for_address.end()) {
+      if (line_number > 1) {
+        out << std::endl;
+        ++line_number;
+      }
+      out << std::setw(16) << std::setfill('0') << std::hex
+          << current_address
+          << std::dec << std::setfill(' ')
+          << " <" << it->second << ">:" << std::endl;
+      ++line_number;
+    }
+
+    out << "  " << std::hex << current_address << ": "
+        << std::setfill('0') << std::setw(8) << std::right
+        << program.text_buffer[instruction_index]
+        << std::dec << std::setfill(' ') << "             "
+        << ".word 0x" << std::hex << std::setfill('0') << std::setw(8)
+        << program.text_buffer[instruction_index]
+        << std::dec << std::setfill(' ') << std::endl;
+    instruction_number_disassembly_mapping[instruction_index] = line_number;
+    ++line_number;
+  }
+
+  program.instruction_number_disassembly_mapping = instruction_number_disassembly_mapping;
+}
 
 void SetupConfigFile() {
   std::ofstream config_file(globals::config_file_path);
@@ -481,27 +527,62 @@ void SetupConfigFile() {
   config_file << "[Execution]\n";
   config_file << "run_step_delay=0   ; in ms\n";
   config_file << "processor_type=single_stage\n";
-  config_file << "hazard_detection=false\n";
-  config_file << "forwarding=false\n";
-  config_file << "branch_prediction=none\n\n";
+  config_file << "random_seed=0   ; 0 seeds from the host\n";
+  config_file << "profiling_enabled=false\n";
+  config_file << "profile_top_lines=20\n";
+  config_file << "trace_file=\n";
+  config_file << "hart_count=1\n";
+  config_file << "hart_sync=quantum   ; quantum | free_running\n";
+  config_file << "hart_quantum=1000\n";
+  config_file << "hart_stack_size=0x10000\n";
+  config_file << "execution_engine=interpreter   ; interpreter | dbt\n";
+  config_file << "dbt_hot_threshold=16\n";
+  config_file << "publish_interval_instructions=1000000\n";
+  config_file << "publish_interval_ms=33\n\n";
 
   config_file << "[Memory]\n";
   config_file << "memory_size=0xffffffffffffffff\n";
-  config_file << "block_size=1024\n\n";
+  config_file << "memory_block_size=1024\n";
+  config_file << "mmio_enabled=true\n";
+  config_file << "mmio_base=0x40000000\n";
+  config_file << "dma_bytes_per_cycle=8\n";
+  config_file << "matrix_macs_per_cycle=256\n";
+  config_file << "matrix_bytes_per_cycle=32\n\n";
+
+  config_file << "[Syscall]\n";
+  config_file << "output_buffer_size=4096\n";
+  config_file << "stdin_file=\n";
+  config_file << "sandbox_directory=\n\n";
 
   config_file << "[Cache]\n";
-  config_file << "cache_enabled=false\n";
-  config_file << "cache_size=0\n";
-  config_file << "cache_block_size=0\n";
-  config_file << "cache_associativity=0\n";
+  config_file << "cache_enabled=false   ; L1 data cache model\n";
+  config_file << "cache_size=32768\n";
+  config_file << "cache_block_size=64\n";
+  config_file << "cache_associativity=8\n";
   config_file << "cache_read_miss_policy=read_allocate\n";
-  config_file << "cache_replacement_policy=LRU\n";
-  config_file << "cache_write_hit_policy=write_back\n";
-  config_file << "cache_write_miss_policy=write_allocate\n\n";
+  config_file << "cache_replacement_policy=LRU   ; LRU | FIFO | random\n";
+  config_file << "cache_write_hit_policy=write_back   ; write_back | write_through\n";
+  config_file << "cache_write_miss_policy=write_allocate   ; write_allocate | no_write_allocate\n";
+  config_file << "cache_miss_penalty=20   ; cycles\n\n";
+
+  config_file << "[Vector]\n";
+  config_file << "vlen=128   ; bits, 64 to 512\n";
+  config_file << "host_simd=true   ; AVX2/SSE2 kernels when the host has them\n\n";
 
   config_file << "[BranchPrediction]\n";
-  config_file << "branch_prediction_type=always_not_taken\n";
-  config_file << "branch_prediction_table_size=0\n";
-  config_file << "branch_prediction_table_associativity=0\n";
+  config_file << "branch_prediction_type=none\n";
+  config_file << "branch_prediction_table_size=4096\n";
+  config_file << "branch_history_bits=12\n";
+  config_file << "btb_size=512\n";
+  config_file << "ras_size=16\n";
+  config_file << "misprediction_penalty=2   ; cycles\n\n";
+
+  // The latencies are written from the defaults so the two cannot drift apart.
+  config_file << "[Timing]\n";
+  config_file << "timing_enabled=false   ; per-class latencies and a register scoreboard\n";
+  const vm_config::TimingLatencies latencies;
+  for (const auto &[key, latency] : vm_config::TimingLatencies::Keys()) {
+    config_file << key << "=" << latencies.*latency << "\n";
+  }
   config_file.close();
 }
\ No newline at end of file
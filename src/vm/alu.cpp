@@ -26,9 +26,9 @@
 namespace alu {
 
 
-static bool seeded = [](){ 
-  std::srand(std::time(nullptr)); return true;
- }();
+static double uniform_unit(std::mt19937_64 &rng){
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+}
 
 
 // bit - casts
@@ -45,7 +45,7 @@ static inline float bits_to_f32(uint32_t u){
 
 
 // float16 to float32
-static inline float float16_to_float(uint16_t h){
+float float16_to_float(uint16_t h){
     uint32_t sign  = (uint32_t)(h & 0x8000u) << 16;      // sign to bit 31
     uint32_t exp_h = (uint32_t)(h & 0x7C00u) >> 10;      // 5-bit exponent
     uint32_t man_h = (uint32_t)(h & 0x03FFu);            // 10-bit mantissa
@@ -86,7 +86,7 @@ static inline float float16_to_float(uint16_t h){
 }
 
 // float32 to float16
-static inline uint16_t float_to_float16(float f){
+uint16_t float_to_float16(float f){
     uint32_t u = f32_to_bits(f);
     uint32_t sign = (u >> 16) & 0x8000u;
     uint32_t exp  = (u >> 23) & 0xFFu;
@@ -158,7 +158,7 @@ static inline void fp16_set_lane(uint64_t &dst, int i, uint16_t h){
 }
 
 
-static inline std::array<float, 4> msfp16_unpack(uint64_t reg){
+std::array<float, 4> msfp16_unpack(uint64_t reg){
     std::array<float, 4> out;
 
     uint32_t shared_exp_bits = (reg >> 56) & 0xFF;
@@ -187,7 +187,7 @@ static inline std::array<float, 4> msfp16_unpack(uint64_t reg){
 }
 
 
-static inline uint64_t msfp16_pack(const std::array<float, 4> &vals){
+uint64_t msfp16_pack(const std::array<float, 4> &vals){
     bool all_zero = true;
     int e_max = INT_MIN;
 
@@ -221,6 +221,10 @@ static inline uint64_t msfp16_pack(const std::array<float, 4> &vals){
         return 0ull;
     }
 
+    // Lanes hold m/2^13 of 2^shared with frac in [1, 2), so the shared exponent sits one
+    // above the largest lane's; otherwise that lane saturates just below 2^e_max.
+    e_max += 1;
+
     // Clamp shared exponent to representable range
     if(e_max > 127){
       e_max = 127;
@@ -367,8 +371,8 @@ static double get_norm_squared(double real, double imag){
 }
 
  // apply random noise to double value (simualtion for othe rprobabilisitc applications)
-static double apply_noise(double val){
-    double noise = ((double)std::rand() / (double)RAND_MAX) * 0.02 - 0.01;
+static double apply_noise(double val, std::mt19937_64 &rng){
+    double noise = uniform_unit(rng) * 0.02 - 0.01;
     return val + noise;
 }
 
@@ -387,7 +391,7 @@ static uint64_t qalloc_b(uint64_t rs1, uint64_t rs2){
 }
 
 
-static uint64_t qha(uint64_t a, uint64_t b){
+static uint64_t qha(uint64_t a, uint64_t b, std::mt19937_64 &rng){
     uint8_t tag = get_tag(a); 
     double ar = get_real(a); double ai = get_imag(a);
     double br = get_real(b); double bi = get_imag(b);
@@ -397,15 +401,15 @@ static uint64_t qha(uint64_t a, uint64_t b){
 
     
     if(tag == 0x1){ // applying noise if tag is 1 for demonstration
-        res_r = apply_noise(res_r);
-        res_i = apply_noise(res_i);
+        res_r = apply_noise(res_r, rng);
+        res_i = apply_noise(res_i, rng);
     }
 
     return pack_amplitude(tag, res_r, res_i);
 }
 
 
-static uint64_t qhb(uint64_t a, uint64_t b){
+static uint64_t qhb(uint64_t a, uint64_t b, std::mt19937_64 &rng){
     uint8_t tag = get_tag(a); 
     double ar = get_real(a); double ai = get_imag(a);
     double br = get_real(b); double bi = get_imag(b);
@@ -415,15 +419,15 @@ static uint64_t qhb(uint64_t a, uint64_t b){
     
     
     if(tag == 0x1){ 
-        res_r = apply_noise(res_r);
-        res_i = apply_noise(res_i);
+        res_r = apply_noise(res_r, rng);
+        res_i = apply_noise(res_i, rng);
     }
     
 
     return pack_amplitude(tag, res_r, res_i);
 }
 
-static uint64_t qphase(uint64_t a, uint64_t b) {
+static uint64_t qphase(uint64_t a, uint64_t b, std::mt19937_64 &rng) {
     uint8_t tag = get_tag(a);
     double br = get_real(a); double bi = get_imag(a);
 
@@ -439,8 +443,8 @@ static uint64_t qphase(uint64_t a, uint64_t b) {
     
    
     if(tag == 0x1){ 
-        res_r = apply_noise(res_r);
-        res_i = apply_noise(res_i);
+        res_r = apply_noise(res_r, rng);
+        res_i = apply_noise(res_i, rng);
     }
     
 
@@ -457,7 +461,7 @@ static uint64_t qxb(uint64_t a, uint64_t b){
 }
 
 // meansure state 0 or 1 and return classical 0 or 1
-static uint64_t qmeas(uint64_t a, uint64_t b){
+static uint64_t qmeas(uint64_t a, uint64_t b, std::mt19937_64 &rng){
     double ar = get_real(a); double ai = get_imag(a);
     double br = get_real(b); double bi = get_imag(b);
 
@@ -470,7 +474,7 @@ static uint64_t qmeas(uint64_t a, uint64_t b){
     }
 
 
-    double rand_val = (double)std::rand() / (double)RAND_MAX;
+    double rand_val = uniform_unit(rng);
 
     if(rand_val < (p0 / total_p)){
         return 0; // Collapsed to |0>
@@ -1846,10 +1850,7 @@ static std::string decode_fclass(uint16_t res) {
     }
 
     case AluOp::kAdd_cache: {
-      static int64_t prev_a = 0;
-      static int64_t prev_b = 0;
-      static int64_t prev_result = 0;
-      static bool cache_valid = false;
+      auto &[prev_a, prev_b, prev_result, cache_valid] = operand_caches_[OperandCache::kAdd];
       if(cache_valid && 
           ((a == prev_a && b == prev_b)||(a == prev_b && b == prev_a))){
           std::cout << "cache hit" << "\n";
@@ -1871,10 +1872,7 @@ static std::string decode_fclass(uint16_t res) {
       return {sr, false};
     }
     case AluOp::kSub_cache: {
-      static int64_t prev_a = 0;
-      static int64_t prev_b = 0;
-      static int64_t prev_result = 0;
-      static bool cache_valid = false;
+      auto &[prev_a, prev_b, prev_result, cache_valid] = operand_caches_[OperandCache::kSub];
       if(cache_valid && (a == prev_a && b == prev_b)){
          std::cout << "cache hit" << "\n";
           return {prev_result, false};
@@ -1899,10 +1897,7 @@ static std::string decode_fclass(uint16_t res) {
       return {sr, false};
     }
     case AluOp::kMul_cache: {
-      static int64_t prev_a = 0;
-      static int64_t prev_b = 0;
-      static int64_t prev_result = 0;
-      static bool cache_valid = false;
+      auto &[prev_a, prev_b, prev_result, cache_valid] = operand_caches_[OperandCache::kMul];
 
       
       if(cache_valid && 
@@ -1928,10 +1923,7 @@ static std::string decode_fclass(uint16_t res) {
       return {sr, false};
     }
     case AluOp::kDiv_cache: {
-      static int64_t prev_a = 0;
-      static int64_t prev_b = 0;
-      static int64_t prev_result = 0;
-      static bool cache_valid = false;
+      auto &[prev_a, prev_b, prev_result, cache_valid] = operand_caches_[OperandCache::kDiv];
       if(cache_valid && (a == prev_a && b == prev_b)){
          std::cout << "cache hit" << "\n";
           return {prev_result, false};
@@ -1966,7 +1958,7 @@ static std::string decode_fclass(uint16_t res) {
     }
     case AluOp::kRandom_flip: {
       int64_t val = a;
-      int bit_pos = rand() % 64;  
+      int bit_pos = static_cast<int>(rng_() % 64);
       int64_t flip_mask = 1LL << bit_pos;
       int64_t result = val ^ flip_mask;
       return {result, false};
@@ -2016,17 +2008,17 @@ static std::string decode_fclass(uint16_t res) {
      case AluOp::kQAlloc_B:
          return {qalloc_b(a, b), false};
      case AluOp::kQHA:
-         return {qha(a, b), false};
+         return {qha(a, b, rng_), false};
      case AluOp::kQHB:
-         return {qhb(a, b), false};
+         return {qhb(a, b, rng_), false};
      case AluOp::kQXA:
          return {qxa(a, b), false};
      case AluOp::kQXB:
          return {qxb(a, b), false};
      case AluOp::kQPhase:
-         return {qphase(a, b), false};
+         return {qphase(a, b, rng_), false};
      case AluOp::kQMeas:
-         return {qmeas(a, b), false};
+         return {qmeas(a, b, rng_), false};
      case AluOp::kQNormA:
          return {qnorma(a, b), false};
      case AluOp::kQNormB:
@@ -0,0 +1,273 @@
+/**
+ * @file branch_predictor.cpp
+ * @brief Contains the implementation of the branch predictors and the BranchPredictor model.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/branch_predictor.h"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+namespace {
+
+constexpr uint32_t kJalOpcode = 0b1101111;
+
+uint64_t TableSize(uint64_t requested) {
+  return std::bit_ceil(std::max<uint64_t>(requested, 1));
+}
+
+// Folds the upper address bits into the index so code placed a table size apart does not alias.
+uint64_t HashPc(uint64_t pc, uint64_t mask) {
+  uint64_t word = pc >> 2;
+  return (word ^ (word >> std::popcount(mask))) & mask;
+}
+
+void Train(uint8_t &counter, bool taken) {
+  if (taken) {
+    counter += counter < 3;
+  } else {
+    counter -= counter > 0;
+  }
+}
+
+bool IsLinkRegister(uint32_t reg) {
+  return reg == 1 || reg == 5;
+}
+
+std::string HexAddress(uint64_t address) {
+  std::ostringstream os;
+  os << "0x" << std::hex << address;
+  return os.str();
+}
+
+} // namespace
+
+BranchKind ClassifyJump(uint32_t instruction) {
+  uint32_t rd = (instruction >> 7) & 0b11111;
+  uint32_t rs1 = (instruction >> 15) & 0b11111;
+  if (IsLinkRegister(rd)) {
+    return BranchKind::kCall;
+  }
+  if ((instruction & 0x7f) != kJalOpcode && IsLinkRegister(rs1)) {
+    return BranchKind::kReturn;
+  }
+  return BranchKind::kJump;
+}
+
+BimodalPredictor::BimodalPredictor(uint64_t table_size)
+    : counters_(TableSize(table_size), 1), mask_(counters_.size() - 1) {}
+
+bool BimodalPredictor::Predict(uint64_t pc) const {
+  return counters_[HashPc(pc, mask_)] >= 2;
+}
+
+void BimodalPredictor::Update(uint64_t pc, bool taken) {
+  Train(counters_[HashPc(pc, mask_)], taken);
+}
+
+GsharePredictor::GsharePredictor(uint64_t table_size, unsigned int history_bits)
+    : counters_(TableSize(table_size), 1),
+      mask_(counters_.size() - 1),
+      history_mask_(history_bits >= 64 ? UINT64_MAX : (uint64_t{1} << history_bits) - 1) {}
+
+uint64_t GsharePredictor::Index(uint64_t pc) const {
+  return ((pc >> 2) ^ history_) & mask_;
+}
+
+bool GsharePredictor::Predict(uint64_t pc) const {
+  return counters_[Index(pc)] >= 2;
+}
+
+void GsharePredictor::Update(uint64_t pc, bool taken) {
+  Train(counters_[Index(pc)], taken);
+  history_ = ((history_ << 1) | (taken ? 1 : 0)) & history_mask_;
+}
+
+TournamentPredictor::TournamentPredictor(uint64_t table_size, unsigned int history_bits)
+    : bimodal_(table_size),
+      gshare_(table_size, history_bits),
+      choosers_(TableSize(table_size), 1),
+      mask_(choosers_.size() - 1) {}
+
+bool TournamentPredictor::Predict(uint64_t pc) const {
+  return choosers_[HashPc(pc, mask_)] >= 2 ? gshare_.Predict(pc) : bimodal_.Predict(pc);
+}
+
+void TournamentPredictor::Update(uint64_t pc, bool taken) {
+  bool bimodal = bimodal_.Predict(pc);
+  bool gshare = gshare_.Predict(pc);
+  // The chooser only learns from branches where the two components disagree.
+  if (bimodal != gshare) {
+    Train(choosers_[HashPc(pc, mask_)], gshare == taken);
+  }
+  bimodal_.Update(pc, taken);
+  gshare_.Update(pc, taken);
+}
+
+BranchTargetBuffer::BranchTargetBuffer(uint64_t entries)
+    : entries_(TableSize(entries)), mask_(entries_.size() - 1) {}
+
+void BranchPredictor::Start(const vm_config::VmConfig &config, uint64_t text_start, uint64_t text_end) {
+  Reset();
+  table_size_ = TableSize(config.getBranchTableSize());
+  history_bits_ = config.getBranchHistoryBits();
+  btb_size_ = TableSize(config.getBtbSize());
+  ras_size_ = std::max<uint64_t>(config.getRasSize(), 1);
+  auto history_bits = static_cast<unsigned int>(history_bits_);
+  switch (config.getBranchPredictorType()) {
+    case vm_config::BranchPredictorType::NONE:
+      return;
+    case vm_config::BranchPredictorType::ALWAYS_NOT_TAKEN:
+      direction_ = std::make_unique<StaticNotTakenPredictor>();
+      break;
+    case vm_config::BranchPredictorType::BIMODAL:
+      direction_ = std::make_unique<BimodalPredictor>(table_size_);
+      break;
+    case vm_config::BranchPredictorType::GSHARE:
+      direction_ = std::make_unique<GsharePredictor>(table_size_, history_bits);
+      break;
+    case vm_config::BranchPredictorType::TOURNAMENT:
+      direction_ = std::make_unique<TournamentPredictor>(table_size_, history_bits);
+      break;
+  }
+  btb_ = std::make_unique<BranchTargetBuffer>(btb_size_);
+  ras_ = std::make_unique<ReturnAddressStack>(ras_size_);
+  text_start_ = text_start;
+  sites_.assign(text_end > text_start ? (text_end - text_start + 3) / 4 : 0, {});
+}
+
+void BranchPredictor::Reset() {
+  direction_.reset();
+  btb_.reset();
+  ras_.reset();
+  stats_ = {};
+  sites_.clear();
+  sites_.shrink_to_fit();
+}
+
+bool BranchPredictor::Resolve(uint64_t pc, BranchKind kind, bool taken, uint64_t target) {
+  bool mispredicted = false;
+  switch (kind) {
+    case BranchKind::kConditional: {
+      ++stats_.conditional;
+      stats_.taken += taken;
+      bool predicted_taken = direction_->Predict(pc);
+      direction_->Update(pc, taken);
+      if (predicted_taken != taken) {
+        ++stats_.direction_mispredictions;
+        mispredicted = true;
+      } else if (taken && !btb_->Predicts(pc, target)) {
+        ++stats_.target_mispredictions;
+        mispredicted = true;
+      }
+      if (taken) {
+        btb_->Update(pc, target);
+      }
+      break;
+    }
+    case BranchKind::kReturn: {
+      ++stats_.returns;
+      uint64_t predicted = 0;
+      if (!ras_->Pop(predicted) || predicted != target) {
+        ++stats_.return_mispredictions;
+        mispredicted = true;
+      }
+      break;
+    }
+    default: {
+      ++stats_.jumps;
+      if (!btb_->Predicts(pc, target)) {
+        ++stats_.target_mispredictions;
+        mispredicted = true;
+      }
+      btb_->Update(pc, target);
+      if (kind == BranchKind::kCall) {
+        ras_->Push(pc + 4);
+      }
+      break;
+    }
+  }
+
+  uint64_t index = (pc - text_start_) >> 2;
+  if (index < sites_.size()) {
+    ++sites_[index].executed;
+    sites_[index].mispredicted += mispredicted;
+  }
+  return mispredicted;
+}
+
+std::vector<BranchPredictor::Site> BranchPredictor::GetSites() const {
+  std::vector<Site> sites;
+  for (size_t i = 0; i < sites_.size(); ++i) {
+    if (sites_[i].executed != 0) {
+      sites.push_back({text_start_ + i*4, sites_[i].executed, sites_[i].mispredicted});
+    }
+  }
+  return sites;
+}
+
+void BranchPredictor::WriteReport(std::ostream &os, const AssembledProgram &program, size_t top_n) const {
+  auto percent = [](uint64_t part, uint64_t total) {
+    return total == 0 ? 0.0 : 100.0*static_cast<double>(part)/static_cast<double>(total);
+  };
+
+  std::vector<std::string> source;
+  std::ifstream file(program.filename);
+  for (std::string line; file.is_open() && std::getline(file, line);) {
+    source.push_back(line);
+  }
+
+  os << "Branch prediction: " << program.filename << "\n";
+  os << "Predictor: " << (direction_ ? direction_->Name() : "none")
+     << ", " << table_size_ << "-entry tables, " << history_bits_ << " history bits, "
+     << btb_size_ << "-entry BTB, " << ras_size_ << "-entry RAS\n\n";
+
+  os << std::fixed << std::setprecision(2);
+  os << "Branches:                 " << stats_.Branches() << "\n";
+  os << "Mispredictions:           " << stats_.Mispredictions()
+     << " (" << 100.0 - percent(stats_.Mispredictions(), stats_.Branches()) << "% accuracy)\n";
+  os << "Conditional:              " << stats_.conditional << ", " << stats_.taken << " taken\n";
+  os << "  direction mispredicted: " << stats_.direction_mispredictions
+     << " (" << 100.0 - percent(stats_.direction_mispredictions, stats_.conditional) << "% accuracy)\n";
+  os << "Jumps and calls:          " << stats_.jumps << "\n";
+  os << "  target mispredicted:    " << stats_.target_mispredictions << " (BTB, includes taken branches)\n";
+  os << "Returns:                  " << stats_.returns << "\n";
+  os << "  return mispredicted:    " << stats_.return_mispredictions
+     << " (" << 100.0 - percent(stats_.return_mispredictions, stats_.returns) << "% accuracy)\n\n";
+
+  std::vector<Site> sites = GetSites();
+  std::stable_sort(sites.begin(), sites.end(), [](const Site &a, const Site &b) {
+    return a.mispredicted > b.mispredicted;
+  });
+  if (sites.size() > top_n) {
+    sites.resize(top_n);
+  }
+
+  os << "Most mispredicted branches (top " << top_n << "):\n";
+  os << std::setw(12) << "pc" << std::setw(8) << "line" << std::setw(14) << "executed"
+     << std::setw(14) << "mispredicted" << std::setw(10) << "accuracy" << "  instruction\n";
+  for (const Site &site : sites) {
+    unsigned int line = 0;
+    auto mapping = program.instruction_number_line_number_mapping.find(
+        static_cast<unsigned int>((site.pc - text_start_) / 4));
+    if (mapping != program.instruction_number_line_number_mapping.end()) {
+      line = mapping->second;
+    }
+    os << std::setw(12) << HexAddress(site.pc)
+       << std::setw(8) << (line == 0 ? "-" : std::to_string(line))
+       << std::setw(14) << site.executed
+       << std::setw(14) << site.mispredicted
+       << std::setw(9) << 100.0 - percent(site.mispredicted, site.executed) << "%  ";
+    if (line != 0 && line <= source.size()) {
+      std::string text = source[line - 1];
+      text.erase(0, text.find_first_not_of(" \t"));
+      os << text;
+    }
+    os << "\n";
+  }
+}
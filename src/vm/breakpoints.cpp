@@ -0,0 +1,323 @@
+/**
+ * @file breakpoints.cpp
+ * @brief Contains the implementation of the BreakpointSet class and the condition compiler.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/breakpoints.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+
+using Op = BreakpointCondition::Op;
+
+struct BinaryOperator {
+  const char *token;
+  int precedence;
+  Op op;
+};
+
+// Two-character operators first, so "<=" is not read as "<".
+constexpr std::array<BinaryOperator, 18> kBinaryOperators = {{
+    {"||", 1, Op::kLogicalOr}, {"&&", 2, Op::kLogicalAnd},
+    {"==", 6, Op::kEq}, {"!=", 6, Op::kNe}, {"<=", 7, Op::kLe}, {">=", 7, Op::kGe},
+    {"<<", 8, Op::kShl}, {">>", 8, Op::kShr},
+    {"|", 3, Op::kOr}, {"^", 4, Op::kXor}, {"&", 5, Op::kAnd},
+    {"<", 7, Op::kLt}, {">", 7, Op::kGt},
+    {"+", 9, Op::kAdd}, {"-", 9, Op::kSub},
+    {"*", 10, Op::kMul}, {"/", 10, Op::kDiv}, {"%", 10, Op::kRem},
+}};
+
+/**
+ * @brief Recursive-descent parser emitting postfix code; tracks the stack depth it needs.
+ */
+class ConditionParser {
+ public:
+  explicit ConditionParser(const std::string &source) : source_(source) {}
+
+  std::vector<BreakpointCondition::Instruction> Parse() {
+    ParseBinary(1);
+    SkipSpaces();
+    if (pos_ != source_.size()) {
+      Fail("unexpected '" + source_.substr(pos_, 1) + "'");
+    }
+    return std::move(code_);
+  }
+
+ private:
+  const std::string &source_;
+  size_t pos_ = 0;
+  size_t depth_ = 0;
+  std::vector<BreakpointCondition::Instruction> code_;
+
+  [[noreturn]] void Fail(const std::string &message) const {
+    throw std::invalid_argument("Invalid breakpoint condition \"" + source_ + "\": " + message);
+  }
+
+  void SkipSpaces() {
+    while (pos_ < source_.size() && std::isspace(static_cast<unsigned char>(source_[pos_]))) {
+      ++pos_;
+    }
+  }
+
+  bool Accept(const std::string &token) {
+    SkipSpaces();
+    if (source_.compare(pos_, token.size(), token) == 0) {
+      pos_ += token.size();
+      return true;
+    }
+    return false;
+  }
+
+  void Expect(const std::string &token) {
+    if (!Accept(token)) {
+      Fail("expected '" + token + "'");
+    }
+  }
+
+  void Emit(Op op, uint64_t operand = 0) {
+    code_.push_back({op, operand});
+    if (op <= Op::kPc) {
+      if (++depth_ > BreakpointCondition::kMaxStackDepth) {
+        Fail("expression too deep");
+      }
+    } else if (op >= Op::kMul) {
+      --depth_;
+    }
+  }
+
+  const BinaryOperator *PeekBinary() {
+    SkipSpaces();
+    for (const auto &candidate : kBinaryOperators) {
+      if (source_.compare(pos_, std::char_traits<char>::length(candidate.token), candidate.token) == 0) {
+        return &candidate;
+      }
+    }
+    return nullptr;
+  }
+
+  // Precedence climbing: parses operators binding at least as tightly as min_precedence.
+  void ParseBinary(int min_precedence) {
+    ParseUnary();
+    while (const BinaryOperator *op = PeekBinary()) {
+      if (op->precedence < min_precedence) {
+        break;
+      }
+      pos_ += std::char_traits<char>::length(op->token);
+      ParseBinary(op->precedence + 1);
+      Emit(op->op);
+    }
+  }
+
+  void ParseUnary() {
+    if (Accept("-")) {
+      ParseUnary();
+      Emit(Op::kNeg);
+    } else if (Accept("!")) {
+      ParseUnary();
+      Emit(Op::kNot);
+    } else if (Accept("~")) {
+      ParseUnary();
+      Emit(Op::kBitNot);
+    } else {
+      ParsePrimary();
+    }
+  }
+
+  void ParsePrimary() {
+    SkipSpaces();
+    if (Accept("(")) {
+      ParseBinary(1);
+      Expect(")");
+      return;
+    }
+    if (pos_ >= source_.size()) {
+      Fail("unexpected end of expression");
+    }
+    if (std::isdigit(static_cast<unsigned char>(source_[pos_]))) {
+      size_t used = 0;
+      uint64_t value;
+      try {
+        value = std::stoull(source_.substr(pos_), &used, 0);
+      } catch (const std::exception &) {
+        Fail("bad number");
+      }
+      pos_ += used;
+      Emit(Op::kConst, value);
+      return;
+    }
+
+    size_t start = pos_;
+    while (pos_ < source_.size()
+        && (std::isalnum(static_cast<unsigned char>(source_[pos_])) || source_[pos_] == '_')) {
+      ++pos_;
+    }
+    std::string name = source_.substr(start, pos_ - start);
+    if (name.empty()) {
+      Fail("unexpected '" + source_.substr(pos_, 1) + "'");
+    }
+
+    if (name == "pc") {
+      Emit(Op::kPc);
+      return;
+    }
+    static const std::unordered_map<std::string, Op> kLoads = {
+        {"mem", Op::kLoad64}, {"mem8", Op::kLoad8}, {"mem16", Op::kLoad16},
+        {"mem32", Op::kLoad32}, {"mem64", Op::kLoad64},
+    };
+    if (auto load = kLoads.find(name); load != kLoads.end()) {
+      Expect("[");
+      ParseBinary(1);
+      Expect("]");
+      Emit(load->second);
+      return;
+    }
+    auto alias = reg_alias_to_name.find(name);
+    if (alias != reg_alias_to_name.end()) {
+      const std::string &reg = alias->second;
+      if (IsValidGeneralPurposeRegister(reg)) {
+        Emit(Op::kGpr, std::stoull(reg.substr(1)));
+        return;
+      }
+      if (IsValidFloatingPointRegister(reg)) {
+        Emit(Op::kFpr, std::stoull(reg.substr(1)));
+        return;
+      }
+    }
+    Fail("unknown name '" + name + "'");
+  }
+};
+
+} // namespace
+
+BreakpointCondition BreakpointCondition::Compile(const std::string &expression) {
+  BreakpointCondition condition;
+  condition.expression_ = expression;
+  condition.code_ = ConditionParser(expression).Parse();
+  return condition;
+}
+
+uint64_t BreakpointCondition::Evaluate(uint64_t pc, const RegisterFile &registers, MemoryController &memory) const {
+  std::array<uint64_t, kMaxStackDepth> stack;
+  size_t top = 0;
+  for (const Instruction &instruction : code_) {
+    if (instruction.op <= Op::kPc) {
+      uint64_t value = 0;
+      switch (instruction.op) {
+        case Op::kConst: value = instruction.operand; break;
+        case Op::kGpr: value = registers.ReadGpr(instruction.operand); break;
+        case Op::kFpr: value = registers.ReadFpr(instruction.operand); break;
+        default: value = pc; break;
+      }
+      stack[top++] = value;
+      continue;
+    }
+
+    uint64_t &a = stack[top - 1];
+    if (instruction.op <= Op::kBitNot) {
+      switch (instruction.op) {
+        case Op::kLoad8: a = memory.ReadByte(a); break;
+        case Op::kLoad16: a = memory.ReadHalfWord(a); break;
+        case Op::kLoad32: a = memory.ReadWord(a); break;
+        case Op::kLoad64: a = memory.ReadDoubleWord(a); break;
+        case Op::kNeg: a = -a; break;
+        case Op::kNot: a = a == 0; break;
+        default: a = ~a; break;
+      }
+      continue;
+    }
+
+    uint64_t b = stack[--top];
+    uint64_t &lhs = stack[top - 1];
+    auto sa = static_cast<int64_t>(lhs);
+    auto sb = static_cast<int64_t>(b);
+    switch (instruction.op) {
+      // Division follows the RISC-V rules instead of trapping: x/0 = -1, x%0 = x.
+      case Op::kMul: lhs *= b; break;
+      case Op::kDiv: lhs = b == 0 ? UINT64_MAX : lhs / b; break;
+      case Op::kRem: lhs = b == 0 ? lhs : lhs % b; break;
+      case Op::kAdd: lhs += b; break;
+      case Op::kSub: lhs -= b; break;
+      case Op::kShl: lhs = b >= 64 ? 0 : lhs << b; break;
+      case Op::kShr: lhs = b >= 64 ? 0 : lhs >> b; break;
+      case Op::kLt: lhs = sa < sb; break;
+      case Op::kLe: lhs = sa <= sb; break;
+      case Op::kGt: lhs = sa > sb; break;
+      case Op::kGe: lhs = sa >= sb; break;
+      case Op::kEq: lhs = lhs == b; break;
+      case Op::kNe: lhs = lhs != b; break;
+      case Op::kAnd: lhs &= b; break;
+      case Op::kXor: lhs ^= b; break;
+      case Op::kOr: lhs |= b; break;
+      case Op::kLogicalAnd: lhs = lhs != 0 && b != 0; break;
+      default: lhs = lhs != 0 || b != 0; break;
+    }
+  }
+  return stack[0];
+}
+
+void BreakpointSet::Reset(uint64_t text_start, uint64_t text_end) {
+  text_start_ = text_start;
+  instruction_count_ = text_end > text_start ? (text_end - text_start + 3) / 4 : 0;
+  bits_.assign((instruction_count_ + 63) / 64, 0);
+  entries_.clear();
+}
+
+void BreakpointSet::Add(uint64_t address, const std::string &condition, uint64_t hit_count, uint64_t hits) {
+  uint64_t offset = address - text_start_;
+  if ((offset & 0b11) != 0 || (offset >> 2) >= instruction_count_) {
+    throw std::invalid_argument("Breakpoint address is not an instruction: " + std::to_string(address));
+  }
+  if (hit_count == 0) {
+    throw std::invalid_argument("Breakpoint hit count must be at least 1");
+  }
+  Entry entry{{address, condition, hit_count, hits}, std::nullopt};
+  if (!condition.empty()) {
+    entry.condition = BreakpointCondition::Compile(condition);
+  }
+  entries_.insert_or_assign(address, std::move(entry));
+  uint64_t index = offset >> 2;
+  bits_[index >> 6] |= uint64_t{1} << (index & 63);
+}
+
+bool BreakpointSet::Remove(uint64_t address) {
+  if (!entries_.erase(address)) {
+    return false;
+  }
+  uint64_t index = (address - text_start_) >> 2;
+  bits_[index >> 6] &= ~(uint64_t{1} << (index & 63));
+  return true;
+}
+
+std::vector<BreakpointSet::Breakpoint> BreakpointSet::GetBreakpoints() const {
+  std::vector<Breakpoint> breakpoints;
+  breakpoints.reserve(entries_.size());
+  for (const auto &[address, entry] : entries_) {
+    breakpoints.push_back(entry.breakpoint);
+  }
+  std::sort(breakpoints.begin(), breakpoints.end(),
+            [](const Breakpoint &a, const Breakpoint &b) { return a.address < b.address; });
+  return breakpoints;
+}
+
+bool BreakpointSet::Hit(uint64_t pc, const RegisterFile &registers, MemoryController &memory) {
+  Entry &entry = entries_.at(pc);
+  if (entry.condition) {
+    try {
+      if (entry.condition->Evaluate(pc, registers, memory) == 0) {
+        return false;
+      }
+    } catch (const std::exception &e) {
+      // Like a debugger, stop rather than silently run past a condition that cannot be evaluated.
+      std::cerr << "Error evaluating breakpoint condition \"" << entry.breakpoint.condition << "\": "
+                << e.what() << std::endl;
+      return true;
+    }
+  }
+  return ++entry.breakpoint.hits >= entry.breakpoint.hit_count;
+}
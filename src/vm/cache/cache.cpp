@@ -4,3 +4,104 @@
  * @author Vishank Singh, https://github.com/VishankSingh
  */
 #include "vm/cache/cache.h"
+
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+namespace cache {
+
+void Cache::Start(const vm_config::VmConfig &config) {
+  Reset();
+  if (!config.getCacheEnabled()) {
+    return;
+  }
+  config.validateCacheGeometry();
+  uint64_t block_size = config.getCacheBlockSize();
+  uint64_t associativity = config.getCacheAssociativity();
+  uint64_t size = config.getCacheSize();
+  sets_ = size/(block_size*associativity);
+  associativity_ = associativity;
+  block_shift_ = static_cast<unsigned int>(std::countr_zero(block_size));
+  replacement_policy_ = config.getCacheReplacementPolicy();
+  write_back_ = config.getCacheWriteBack();
+  write_allocate_ = config.getCacheWriteAllocate();
+  lines_.assign(sets_*associativity_, {});
+  enabled_ = true;
+}
+
+void Cache::Reset() {
+  enabled_ = false;
+  lines_.clear();
+  lines_.shrink_to_fit();
+  sets_ = 0;
+  associativity_ = 0;
+  clock_ = 0;
+  random_state_ = 0x9e3779b97f4a7c15ULL;
+  stats_ = {};
+}
+
+bool Cache::Access(uint64_t address, bool is_write) {
+  ++stats_.accesses;
+  ++clock_;
+  if (is_write) {
+    ++stats_.writes;
+  } else {
+    ++stats_.reads;
+  }
+
+  uint64_t block = address >> block_shift_;
+  uint64_t tag = block/sets_;
+  Line *set = &lines_[(block % sets_)*associativity_];
+  for (uint64_t way = 0; way < associativity_; ++way) {
+    Line &line = set[way];
+    if (line.valid && line.tag == tag) {
+      ++stats_.hits;
+      if (replacement_policy_ == vm_config::CacheReplacementPolicy::LRU) {
+        line.stamp = clock_;
+      }
+      // Write-through keeps memory current, so its lines are never dirty.
+      line.dirty |= is_write && write_back_;
+      return true;
+    }
+  }
+
+  ++stats_.misses;
+  if (is_write) {
+    ++stats_.write_misses;
+    if (!write_allocate_) {
+      return false;
+    }
+  }
+  Line &line = Victim(set);
+  if (line.valid && line.dirty) {
+    ++stats_.writebacks;
+  }
+  line = {tag, clock_, true, is_write && write_back_};
+  return false;
+}
+
+Cache::Line &Cache::Victim(Line *set) {
+  for (uint64_t way = 0; way < associativity_; ++way) {
+    if (!set[way].valid) {
+      return set[way];
+    }
+  }
+  if (replacement_policy_ == vm_config::CacheReplacementPolicy::RANDOM) {
+    // xorshift64: deterministic, so runs and forks of a snapshot evict the same lines.
+    random_state_ ^= random_state_ << 13;
+    random_state_ ^= random_state_ >> 7;
+    random_state_ ^= random_state_ << 17;
+    return set[random_state_ % associativity_];
+  }
+  // LRU stamps each use and FIFO only each fill, so both evict the smallest stamp.
+  Line *victim = set;
+  for (uint64_t way = 1; way < associativity_; ++way) {
+    if (set[way].stamp < victim->stamp) {
+      victim = &set[way];
+    }
+  }
+  return *victim;
+}
+
+} // namespace cache
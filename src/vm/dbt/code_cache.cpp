@@ -0,0 +1,43 @@
+/**
+ * @file code_cache.cpp
+ * @brief Contains the implementation of the CodeCache class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/dbt/code_cache.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/mman.h>
+
+namespace dbt {
+
+CodeCache::CodeCache(size_t capacity) : capacity_(capacity) {
+  void *region = mmap(nullptr, capacity_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (region == MAP_FAILED) {
+    throw std::runtime_error(std::string("Unable to map the code cache: ") + std::strerror(errno));
+  }
+  base_ = static_cast<uint8_t *>(region);
+  EndWrite();
+}
+
+CodeCache::~CodeCache() {
+  munmap(base_, capacity_);
+}
+
+void CodeCache::BeginWrite() {
+  if (mprotect(base_, capacity_, PROT_READ | PROT_WRITE) != 0) {
+    throw std::runtime_error(std::string("Unable to unprotect the code cache: ") + std::strerror(errno));
+  }
+}
+
+void CodeCache::EndWrite() {
+  if (mprotect(base_, capacity_, PROT_READ | PROT_EXEC) != 0) {
+    throw std::runtime_error(std::string("Unable to protect the code cache: ") + std::strerror(errno));
+  }
+}
+
+} // namespace dbt
@@ -0,0 +1,902 @@
+/**
+ * @file dbt_engine.cpp
+ * @brief Contains the implementation of the DbtEngine class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/dbt/dbt_engine.h"
+
+#include "vm/rvss/rvss_vm.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+namespace dbt {
+
+namespace {
+
+constexpr unsigned int kMaxBlockInstructions = 64;
+constexpr size_t kTlbEntries = 256;
+constexpr size_t kJumpCacheEntries = 4096;
+constexpr size_t kCodeCacheSize = size_t{32} << 20;
+constexpr size_t kMaxBlockCode = size_t{64} << 10; // Far more than kMaxBlockInstructions can need.
+constexpr int64_t kChunk = int64_t{1} << 22; // Instructions between checks for a stop request.
+constexpr unsigned int kMaxFastBlockShift = 30; // The offset mask must fit in an imm32.
+constexpr uint64_t kInvalidTag = ~uint64_t{0};
+constexpr uint64_t kRegisterScanLimit = uint64_t{1} << 20;
+
+constexpr std::array<X86Reg, 5> kMappedHostRegisters = {
+    X86Reg::kRbp, X86Reg::kR12, X86Reg::kR13, X86Reg::kR14, X86Reg::kR15,
+};
+
+constexpr uint8_t kOpcodeLoad = 0b0000011;
+constexpr uint8_t kOpcodeOpImm = 0b0010011;
+constexpr uint8_t kOpcodeAuipc = 0b0010111;
+constexpr uint8_t kOpcodeStore = 0b0100011;
+constexpr uint8_t kOpcodeOp = 0b0110011;
+constexpr uint8_t kOpcodeLui = 0b0110111;
+constexpr uint8_t kOpcodeBranch = 0b1100011;
+constexpr uint8_t kOpcodeJalr = 0b1100111;
+constexpr uint8_t kOpcodeJal = 0b1101111;
+
+enum ExitReason : uint64_t {
+  kExitNormal = 0,
+  kExitFault = 1, ///< The instruction at pc raised an exception and did not retire.
+  kExitSync = 2,  ///< The instruction at pc retired, but the dispatcher must look before going on.
+};
+
+bool EndsBlock(uint32_t instruction) {
+  uint8_t opcode = instruction & 0b1111111;
+  return opcode == kOpcodeBranch || opcode == kOpcodeJal || opcode == kOpcodeJalr;
+}
+
+int64_t UpperImmediate(uint32_t instruction) {
+  return static_cast<int32_t>(instruction & 0xFFFFF000);
+}
+
+/**
+ * @brief The M operations without a short x86 sequence, computed by the VM's own ALU so that
+ *        division by zero and overflow give exactly the interpreter's results.
+ */
+template<alu::AluOp kOp>
+uint64_t AluHelper(alu::Alu *alu, uint64_t a, uint64_t b) {
+  return alu->execute(kOp, a, b).first;
+}
+
+const void *HelperAddress(auto *function) {
+  return reinterpret_cast<const void *>(function);
+}
+
+} // namespace
+
+struct DbtEngine::Context {
+  struct TlbEntry {
+    uint64_t tag; ///< Guest memory block index, or kInvalidTag.
+    uint8_t *block;
+  };
+
+  struct JumpCacheEntry {
+    uint64_t pc;
+    const uint8_t *code; ///< The exit trampoline for an empty entry.
+  };
+
+  uint64_t gpr[32];
+  uint64_t pc; ///< Where execution continues after translated code returns.
+  int64_t budget; ///< Instructions translated code may still start.
+  int64_t start_budget;
+  int64_t pending; ///< Instructions of the current block not retired, set before each helper call.
+  int64_t ticked; ///< Instructions the devices have been ticked for.
+  uint64_t exit_reason;
+  DbtEngine *engine;
+  TlbEntry read_tlb[kTlbEntries];
+  TlbEntry write_tlb[kTlbEntries];
+  JumpCacheEntry jump_cache[kJumpCacheEntries];
+};
+
+namespace {
+
+using Context = DbtEngine::Context;
+
+X86Mem Field(size_t offset) {
+  return {X86Reg::kRbx, static_cast<int32_t>(offset)};
+}
+
+X86Mem GuestSlot(unsigned int guest) {
+  return Field(offsetof(Context, gpr) + 8*guest);
+}
+
+} // namespace
+
+bool DbtEngine::IsSupported() {
+#if defined(__x86_64__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+DbtEngine::DbtEngine(uint64_t hot_threshold)
+    : hot_threshold_(std::max<uint64_t>(hot_threshold, 1)),
+      cache_(kCodeCacheSize),
+      context_(std::make_unique<Context>()) {
+  context_->engine = this;
+  host_register_.fill(-1);
+}
+
+DbtEngine::~DbtEngine() = default;
+
+bool DbtEngine::IsTranslatable(uint32_t instruction) {
+  uint8_t opcode = instruction & 0b1111111;
+  uint8_t funct3 = (instruction >> 12) & 0b111;
+  uint8_t funct7 = (instruction >> 25) & 0b1111111;
+  switch (opcode) {
+    case kOpcodeOpImm:
+      // SRLI/SRAI with a shift of 32 or more are not decoded by the interpreter's control unit.
+      return funct3 != 0b101 || funct7 == 0b0000000 || funct7 == 0b0100000;
+    case kOpcodeLui:
+    case kOpcodeAuipc:
+    case kOpcodeJal:
+      return true;
+    case kOpcodeJalr:
+      return funct3 == 0b000;
+    case kOpcodeBranch:
+      return funct3 != 0b010 && funct3 != 0b011;
+    case kOpcodeLoad:
+      return funct3 != 0b111; // the custom ECC load
+    case kOpcodeStore:
+      return funct3 <= 0b011;
+    case kOpcodeOp:
+      if (funct7 == 0b0000000 || funct7 == 0b0000001) {
+        return true;
+      }
+      return funct7 == 0b0100000 && (funct3 == 0b000 || funct3 == 0b101);
+    default:
+      return false;
+  }
+}
+
+uint64_t DbtEngine::Run(RVSSVM &vm, uint64_t max_instructions) {
+  Begin(vm);
+  uint64_t executed = 0;
+  while (executed < max_instructions && !vm.stop_requested_ && !vm.IsHalted()) {
+    uint64_t remaining = max_instructions - executed;
+    const Block *block = bus_->Busy() ? nullptr : FindOrTranslate(vm.program_counter_);
+    uint64_t chunk;
+    if (block != nullptr && block->length <= remaining) {
+      chunk = Execute(block->code, std::min<uint64_t>(remaining, kChunk));
+    } else {
+      chunk = Interpret(remaining);
+    }
+    executed += chunk;
+    vm.TickStatePublisher(chunk);
+    if (flush_requested_) {
+      flush_requested_ = false;
+      ClearTranslations();
+      stats_.flushes++;
+    }
+  }
+  return executed;
+}
+
+void DbtEngine::Begin(RVSSVM &vm) {
+  vm_ = &vm;
+  memory_ = vm.memory_controller_.GetSharedMemory().get();
+  bus_ = &vm.memory_controller_.GetMmioBus();
+  block_shift_ = memory_->GetBlockShift();
+  fast_memory_ = block_shift_ <= kMaxFastBlockShift && memory_->GetMemorySize() > 8;
+  flush_requested_ = false;
+  fault_ = nullptr;
+  AllocateRegisters();
+  ClearTranslations();
+}
+
+void DbtEngine::AllocateRegisters() {
+  std::array<uint64_t, 32> uses{};
+  uint64_t end = std::min(vm_->program_size_, vm_->text_start_ + 4*kRegisterScanLimit);
+  for (uint64_t pc = vm_->text_start_; pc < end; pc += 4) {
+    uint32_t instruction;
+    try {
+      instruction = memory_->ReadWord(pc);
+    } catch (const std::out_of_range &) {
+      break;
+    }
+    if (!IsTranslatable(instruction)) {
+      continue;
+    }
+    uint8_t opcode = instruction & 0b1111111;
+    if (opcode != kOpcodeStore && opcode != kOpcodeBranch) {
+      uses[(instruction >> 7) & 0b11111]++;
+    }
+    if (opcode != kOpcodeLui && opcode != kOpcodeAuipc && opcode != kOpcodeJal) {
+      uses[(instruction >> 15) & 0b11111]++;
+    }
+    if (opcode == kOpcodeOp || opcode == kOpcodeStore || opcode == kOpcodeBranch) {
+      uses[(instruction >> 20) & 0b11111]++;
+    }
+  }
+  uses[0] = 0;
+
+  std::array<unsigned int, 32> order{};
+  for (unsigned int i = 0; i < order.size(); ++i) {
+    order[i] = i;
+  }
+  std::stable_sort(order.begin(), order.end(), [&uses](unsigned int a, unsigned int b) {
+    return uses[a] > uses[b];
+  });
+  host_register_.fill(-1);
+  for (unsigned int i = 0; i < kMappedHostRegisters.size() && uses[order[i]] > 0; ++i) {
+    host_register_[order[i]] = static_cast<int>(i);
+  }
+}
+
+void DbtEngine::ClearTranslations() {
+  cache_.BeginWrite();
+  cache_.Clear();
+  X86Emitter emitter(cache_.Cursor(), cache_.Remaining());
+  EmitTrampolines(emitter);
+  cache_.Commit(emitter.Size());
+  cache_.EndWrite();
+
+  blocks_.clear();
+  heat_.clear();
+  unchained_.clear();
+  code_blocks_.clear();
+  for (Context::JumpCacheEntry &entry : context_->jump_cache) {
+    entry = {kInvalidTag, exit_};
+  }
+  ResetTlbs();
+}
+
+void DbtEngine::ResetTlbs() {
+  for (size_t i = 0; i < kTlbEntries; ++i) {
+    context_->read_tlb[i] = {kInvalidTag, nullptr};
+    context_->write_tlb[i] = {kInvalidTag, nullptr};
+  }
+  generation_ = memory_->GetGeneration();
+}
+
+const DbtEngine::Block *DbtEngine::FindOrTranslate(uint64_t pc) {
+  auto found = blocks_.find(pc);
+  if (found != blocks_.end()) {
+    return found->second.code != nullptr ? &found->second : nullptr;
+  }
+  uint64_t &heat = heat_[pc];
+  if (++heat < hot_threshold_) {
+    return nullptr;
+  }
+  heat_.erase(pc);
+  return Translate(pc);
+}
+
+const DbtEngine::Block *DbtEngine::Translate(uint64_t pc) {
+  std::vector<uint32_t> words;
+  if (pc % 4 == 0) {
+    for (uint64_t address = pc; words.size() < kMaxBlockInstructions && address < vm_->program_size_;
+         address += 4) {
+      if (bus_->Overlaps(address, 4)) {
+        break;
+      }
+      uint32_t instruction;
+      try {
+        instruction = memory_->ReadWord(address);
+      } catch (const std::out_of_range &) {
+        break;
+      }
+      if (!IsTranslatable(instruction)) {
+        break;
+      }
+      words.push_back(instruction);
+      if (EndsBlock(instruction)) {
+        break;
+      }
+    }
+  }
+  if (words.empty()) {
+    blocks_[pc] = {nullptr, 0};
+    return nullptr;
+  }
+
+  if (cache_.Remaining() < kMaxBlockCode) {
+    ClearTranslations();
+    stats_.flushes++;
+  }
+  cache_.BeginWrite();
+  uint8_t *code = cache_.Cursor();
+  X86Emitter emitter(code, kMaxBlockCode);
+  EmitBlock(emitter, pc, words);
+  cache_.Commit(emitter.Size());
+  auto waiting = unchained_.find(pc);
+  if (waiting != unchained_.end()) {
+    for (uint8_t *site : waiting->second) {
+      X86Emitter::PatchRel32(site, code);
+    }
+    unchained_.erase(waiting);
+  }
+  cache_.EndWrite();
+
+  // Stores to these blocks now have to go through the slow path, which notices them.
+  uint64_t last = pc + 4*words.size() - 1;
+  for (uint64_t index = pc >> block_shift_; index <= last >> block_shift_; ++index) {
+    code_blocks_.insert(index);
+    Context::TlbEntry &entry = context_->write_tlb[index % kTlbEntries];
+    if (entry.tag == index) {
+      entry = {kInvalidTag, nullptr};
+    }
+  }
+  context_->jump_cache[(pc >> 2) % kJumpCacheEntries] = {pc, code};
+  stats_.blocks++;
+  stats_.translated_instructions += words.size();
+  Block &block = blocks_[pc];
+  block = {code, words.size()};
+  return &block;
+}
+
+uint64_t DbtEngine::Execute(const uint8_t *code, uint64_t budget) {
+  Context &context = *context_;
+  context.gpr[0] = 0;
+  for (unsigned int i = 1; i < 32; ++i) {
+    context.gpr[i] = vm_->registers_.ReadGpr(i);
+  }
+  if (memory_->GetGeneration() != generation_) {
+    ResetTlbs();
+  }
+  context.budget = static_cast<int64_t>(budget);
+  context.start_budget = context.budget;
+  context.pending = 0;
+  context.ticked = 0;
+  context.exit_reason = kExitNormal;
+
+  reinterpret_cast<void (*)(Context *, const uint8_t *)>(entry_)(&context, code);
+
+  int64_t executed = context.start_budget - context.budget;
+  uint64_t pc = context.pc;
+  if (context.exit_reason == kExitFault) {
+    executed -= context.pending;
+    vm_->current_delta_.old_pc = pc;
+    pc += 4;
+  } else if (context.exit_reason == kExitSync) {
+    executed -= context.pending - 1;
+    pc += 4;
+  }
+  for (unsigned int i = 1; i < 32; ++i) {
+    vm_->registers_.WriteGpr(i, context.gpr[i]);
+  }
+  vm_->program_counter_ = pc;
+  if (executed > context.ticked) {
+    bus_->Tick(static_cast<uint64_t>(executed - context.ticked));
+  }
+  vm_->instructions_retired_ += static_cast<uint64_t>(executed);
+  vm_->cycle_s_ += static_cast<uint64_t>(executed);
+  stats_.native_instructions += static_cast<uint64_t>(executed);
+
+  if (context.exit_reason == kExitFault) {
+    std::exception_ptr fault = std::exchange(fault_, nullptr);
+    std::rethrow_exception(fault);
+  }
+  return static_cast<uint64_t>(executed);
+}
+
+uint64_t DbtEngine::Interpret(uint64_t max_instructions) {
+  uint64_t executed = 0;
+  while (executed < max_instructions && !vm_->IsHalted()) {
+    vm_->StepHeadless();
+    executed++;
+    uint32_t instruction = vm_->current_instruction_;
+    if (vm_->control_unit_.GetMemWrite() && !code_blocks_.empty()) {
+      uint64_t address = static_cast<uint64_t>(vm_->execution_result_);
+      if (code_blocks_.contains(address >> block_shift_) || code_blocks_.contains((address + 7) >> block_shift_)) {
+        flush_requested_ = true;
+        break;
+      }
+    }
+    if (EndsBlock(instruction) || !IsTranslatable(instruction) || blocks_.contains(vm_->program_counter_)) {
+      break;
+    }
+  }
+  vm_->current_delta_ = StepDelta();
+  stats_.interpreted_instructions += executed;
+  return executed;
+}
+
+void DbtEngine::EmitTrampolines(X86Emitter &emitter) {
+  // Entry, called as entry(context, code): saves the callee-saved registers (keeping the stack
+  // 16-byte aligned for helper calls), loads the mapped guest registers and jumps to the block.
+  entry_ = emitter.Here();
+  emitter.Push(X86Reg::kRbx);
+  for (X86Reg reg : kMappedHostRegisters) {
+    emitter.Push(reg);
+  }
+  emitter.AluRI(AluKind::kSub, X86Reg::kRsp, 8);
+  emitter.MovRR(X86Reg::kRbx, X86Reg::kRdi);
+  for (unsigned int guest = 1; guest < 32; ++guest) {
+    if (host_register_[guest] >= 0) {
+      emitter.Load(kMappedHostRegisters[host_register_[guest]], GuestSlot(guest), 8, false);
+    }
+  }
+  emitter.JmpReg(X86Reg::kRsi);
+
+  // Exit: every block leaves through here with the next pc already stored.
+  exit_ = emitter.Here();
+  for (unsigned int guest = 1; guest < 32; ++guest) {
+    if (host_register_[guest] >= 0) {
+      emitter.Store(GuestSlot(guest), kMappedHostRegisters[host_register_[guest]], 8);
+    }
+  }
+  emitter.AluRI(AluKind::kAdd, X86Reg::kRsp, 8);
+  for (auto reg = kMappedHostRegisters.rbegin(); reg != kMappedHostRegisters.rend(); ++reg) {
+    emitter.Pop(*reg);
+  }
+  emitter.Pop(X86Reg::kRbx);
+  emitter.Ret();
+}
+
+void DbtEngine::EmitBlock(X86Emitter &emitter, uint64_t pc, const std::vector<uint32_t> &words) {
+  const uint8_t *entry = emitter.Here();
+  auto length = static_cast<unsigned int>(words.size());
+  std::vector<StubSite> stubs;
+
+  // Leave before starting a block the budget cannot finish, so the count stays exact.
+  emitter.AluMI(AluKind::kCmp, Field(offsetof(Context, budget)), static_cast<int32_t>(length));
+  stubs.push_back({emitter.Jcc(Cond::kL, nullptr), 0});
+  emitter.AluMI(AluKind::kSub, Field(offsetof(Context, budget)), static_cast<int32_t>(length));
+
+  for (unsigned int i = 0; i < length; ++i) {
+    uint64_t instruction_pc = pc + 4*i;
+    uint8_t opcode = words[i] & 0b1111111;
+    int32_t imm = vm_->ImmGenerator(words[i]);
+    if (opcode == kOpcodeBranch) {
+      X86Reg a = SourceOf(emitter, (words[i] >> 15) & 0b11111, X86Reg::kRax);
+      X86Reg b = SourceOf(emitter, (words[i] >> 20) & 0b11111, X86Reg::kRcx);
+      emitter.AluRR(AluKind::kCmp, a, b);
+      Cond cond;
+      switch ((words[i] >> 12) & 0b111) {
+        case 0b000: cond = Cond::kE; break;
+        case 0b001: cond = Cond::kNe; break;
+        case 0b100: cond = Cond::kL; break;
+        case 0b101: cond = Cond::kGe; break;
+        case 0b110: cond = Cond::kB; break;
+        default: cond = Cond::kAe; break;
+      }
+      uint8_t *taken = emitter.Jcc(cond, nullptr);
+      EmitExit(emitter, instruction_pc + 4, entry, pc);
+      X86Emitter::PatchRel32(taken, emitter.Here());
+      EmitExit(emitter, instruction_pc + imm, entry, pc);
+    } else if (opcode == kOpcodeJal) {
+      SetGuest(emitter, (words[i] >> 7) & 0b11111, instruction_pc + 4);
+      EmitExit(emitter, instruction_pc + imm, entry, pc);
+    } else if (opcode == kOpcodeJalr) {
+      LoadGuest(emitter, X86Reg::kRax, (words[i] >> 15) & 0b11111);
+      if (imm != 0) {
+        emitter.AluRI(AluKind::kAdd, X86Reg::kRax, imm);
+      }
+      SetGuest(emitter, (words[i] >> 7) & 0b11111, instruction_pc + 4);
+      emitter.Store(Field(offsetof(Context, pc)), X86Reg::kRax, 8);
+      emitter.MovRR(X86Reg::kRcx, X86Reg::kRax);
+      emitter.ShiftRI(ShiftKind::kShr, X86Reg::kRcx, 2);
+      emitter.AluRI(AluKind::kAnd, X86Reg::kRcx, kJumpCacheEntries - 1);
+      emitter.ShiftRI(ShiftKind::kShl, X86Reg::kRcx, 4);
+      auto jump_cache = static_cast<int32_t>(offsetof(Context, jump_cache));
+      emitter.AluRM(AluKind::kCmp, X86Reg::kRax, {X86Reg::kRbx, jump_cache, true, X86Reg::kRcx});
+      emitter.Jcc(Cond::kNe, exit_);
+      emitter.JmpMem({X86Reg::kRbx, jump_cache + 8, true, X86Reg::kRcx});
+    } else {
+      EmitInstruction(emitter, instruction_pc, words[i], i, length, stubs);
+    }
+  }
+  if (!EndsBlock(words.back())) {
+    EmitExit(emitter, pc + 4*length, entry, pc);
+  }
+
+  // One stub per instruction that can leave early, storing its pc.
+  std::sort(stubs.begin(), stubs.end(), [](const StubSite &a, const StubSite &b) {
+    return a.index < b.index;
+  });
+  const uint8_t *stub = nullptr;
+  for (size_t i = 0; i < stubs.size(); ++i) {
+    if (i == 0 || stubs[i].index != stubs[i - 1].index) {
+      stub = emitter.Here();
+      emitter.MovRI(X86Reg::kRax, pc + 4*stubs[i].index);
+      emitter.Store(Field(offsetof(Context, pc)), X86Reg::kRax, 8);
+      emitter.Jmp(exit_);
+    }
+    X86Emitter::PatchRel32(stubs[i].site, stub);
+  }
+}
+
+void DbtEngine::EmitInstruction(X86Emitter &emitter, uint64_t pc, uint32_t instruction, unsigned int index,
+                                unsigned int length, std::vector<StubSite> &stubs) {
+  uint8_t opcode = instruction & 0b1111111;
+  unsigned int rd = (instruction >> 7) & 0b11111;
+  uint8_t funct3 = (instruction >> 12) & 0b111;
+  unsigned int rs1 = (instruction >> 15) & 0b11111;
+  unsigned int rs2 = (instruction >> 20) & 0b11111;
+  uint8_t funct7 = (instruction >> 25) & 0b1111111;
+  int32_t imm = vm_->ImmGenerator(instruction);
+
+  if (opcode == kOpcodeLoad) {
+    EmitMemoryAccess(emitter, instruction, false, index, length, stubs);
+    return;
+  }
+  if (opcode == kOpcodeStore) {
+    EmitMemoryAccess(emitter, instruction, true, index, length, stubs);
+    return;
+  }
+  if (rd == 0) {
+    return; // Nothing else here has a side effect.
+  }
+  if (opcode == kOpcodeLui) {
+    SetGuest(emitter, rd, static_cast<uint64_t>(UpperImmediate(instruction)));
+    return;
+  }
+  if (opcode == kOpcodeAuipc) {
+    SetGuest(emitter, rd, pc + static_cast<uint64_t>(UpperImmediate(instruction)));
+    return;
+  }
+
+  // Work in rd's host register when it has one, unless that would overwrite rs2 before it is read.
+  X86Reg work = host_register_[rd] >= 0 && !(opcode == kOpcodeOp && rs2 == rd)
+                    ? kMappedHostRegisters[host_register_[rd]]
+                    : X86Reg::kRax;
+
+  if (opcode == kOpcodeOpImm) {
+    LoadGuest(emitter, work, rs1);
+    switch (funct3) {
+      case 0b000:
+        if (imm != 0) {
+          emitter.AluRI(AluKind::kAdd, work, imm);
+        }
+        break;
+      case 0b001: emitter.ShiftRI(ShiftKind::kShl, work, imm & 63); break;
+      case 0b010:
+        emitter.AluRI(AluKind::kCmp, work, imm);
+        emitter.SetCond(Cond::kL, work);
+        break;
+      case 0b011:
+        emitter.AluRI(AluKind::kCmp, work, imm);
+        emitter.SetCond(Cond::kB, work);
+        break;
+      case 0b100: emitter.AluRI(AluKind::kXor, work, imm); break;
+      case 0b101:
+        emitter.ShiftRI(funct7 == 0b0100000 ? ShiftKind::kSar : ShiftKind::kShr, work, imm & 63);
+        break;
+      case 0b110: emitter.AluRI(AluKind::kOr, work, imm); break;
+      default: emitter.AluRI(AluKind::kAnd, work, imm); break;
+    }
+    StoreGuest(emitter, rd, work);
+    return;
+  }
+
+  // OP: RV64I and RV64M register-register operations.
+  if (funct7 == 0b0000001) {
+    switch (funct3) {
+      case 0b000:
+        LoadGuest(emitter, work, rs1);
+        emitter.ImulRR(work, SourceOf(emitter, rs2, X86Reg::kRcx));
+        StoreGuest(emitter, rd, work);
+        return;
+      case 0b001:
+      case 0b011:
+        LoadGuest(emitter, X86Reg::kRax, rs1);
+        emitter.MulWide(SourceOf(emitter, rs2, X86Reg::kRcx), funct3 == 0b001);
+        StoreGuest(emitter, rd, X86Reg::kRdx);
+        return;
+      default: {
+        const void *helper;
+        switch (funct3) {
+          case 0b010: helper = HelperAddress(&AluHelper<alu::AluOp::kMulhsu>); break;
+          case 0b100: helper = HelperAddress(&AluHelper<alu::AluOp::kDiv>); break;
+          case 0b101: helper = HelperAddress(&AluHelper<alu::AluOp::kDivu>); break;
+          case 0b110: helper = HelperAddress(&AluHelper<alu::AluOp::kRem>); break;
+          default: helper = HelperAddress(&AluHelper<alu::AluOp::kRemu>); break;
+        }
+        LoadGuest(emitter, X86Reg::kRsi, rs1);
+        LoadGuest(emitter, X86Reg::kRdx, rs2);
+        emitter.MovRI(X86Reg::kRdi, reinterpret_cast<uint64_t>(&vm_->alu_));
+        emitter.CallAbs(helper);
+        StoreGuest(emitter, rd, X86Reg::kRax);
+        return;
+      }
+    }
+  }
+
+  switch (funct3) {
+    case 0b001:
+    case 0b101:
+      LoadGuest(emitter, X86Reg::kRcx, rs2);
+      LoadGuest(emitter, work, rs1);
+      emitter.ShiftRCl(funct3 == 0b001 ? ShiftKind::kShl
+                                       : (funct7 == 0b0100000 ? ShiftKind::kSar : ShiftKind::kShr), work);
+      break;
+    case 0b010:
+    case 0b011:
+      LoadGuest(emitter, work, rs1);
+      emitter.AluRR(AluKind::kCmp, work, SourceOf(emitter, rs2, X86Reg::kRcx));
+      emitter.SetCond(funct3 == 0b010 ? Cond::kL : Cond::kB, work);
+      break;
+    default: {
+      AluKind kind;
+      switch (funct3) {
+        case 0b000: kind = funct7 == 0b0100000 ? AluKind::kSub : AluKind::kAdd; break;
+        case 0b100: kind = AluKind::kXor; break;
+        case 0b110: kind = AluKind::kOr; break;
+        default: kind = AluKind::kAnd; break;
+      }
+      LoadGuest(emitter, work, rs1);
+      emitter.AluRR(kind, work, SourceOf(emitter, rs2, X86Reg::kRcx));
+      break;
+    }
+  }
+  StoreGuest(emitter, rd, work);
+}
+
+void DbtEngine::EmitMemoryAccess(X86Emitter &emitter, uint32_t instruction, bool is_store, unsigned int index,
+                                 unsigned int length, std::vector<StubSite> &stubs) {
+  uint8_t funct3 = (instruction >> 12) & 0b111;
+  unsigned int size = 1u << (funct3 & 0b11);
+  bool sign_extend = funct3 < 0b100;
+  int32_t imm = vm_->ImmGenerator(instruction);
+
+  LoadGuest(emitter, X86Reg::kRax, (instruction >> 15) & 0b11111);
+  if (imm != 0) {
+    emitter.AluRI(AluKind::kAdd, X86Reg::kRax, imm);
+  }
+  if (is_store) {
+    LoadGuest(emitter, X86Reg::kR8, (instruction >> 20) & 0b11111);
+  }
+
+  uint8_t *done = nullptr;
+  if (fast_memory_) {
+    // rcx = block index, rdx = its TLB entry's offset; misaligned accesses and misses go slow.
+    std::vector<uint8_t *> slow;
+    if (size > 1) {
+      emitter.TestRI(X86Reg::kRax, static_cast<int32_t>(size - 1));
+      slow.push_back(emitter.Jcc(Cond::kNe, nullptr));
+    }
+    auto tlb = static_cast<int32_t>(is_store ? offsetof(Context, write_tlb) : offsetof(Context, read_tlb));
+    emitter.MovRR(X86Reg::kRcx, X86Reg::kRax);
+    emitter.ShiftRI(ShiftKind::kShr, X86Reg::kRcx, static_cast<uint8_t>(block_shift_));
+    emitter.MovRR(X86Reg::kRdx, X86Reg::kRcx);
+    emitter.AluRI(AluKind::kAnd, X86Reg::kRdx, kTlbEntries - 1);
+    emitter.ShiftRI(ShiftKind::kShl, X86Reg::kRdx, 4);
+    emitter.AluRM(AluKind::kCmp, X86Reg::kRcx, {X86Reg::kRbx, tlb, true, X86Reg::kRdx});
+    slow.push_back(emitter.Jcc(Cond::kNe, nullptr));
+    emitter.MovRR(X86Reg::kRcx, X86Reg::kRax);
+    emitter.AluRI(AluKind::kAnd, X86Reg::kRcx, static_cast<int32_t>((uint64_t{1} << block_shift_) - 1));
+    emitter.AluRM(AluKind::kAdd, X86Reg::kRcx, {X86Reg::kRbx, tlb + 8, true, X86Reg::kRdx});
+    if (is_store) {
+      emitter.Store({X86Reg::kRcx}, X86Reg::kR8, size);
+    } else {
+      emitter.Load(X86Reg::kRax, {X86Reg::kRcx}, size, sign_extend);
+    }
+    done = emitter.Jmp(nullptr);
+    for (uint8_t *site : slow) {
+      X86Emitter::PatchRel32(site, emitter.Here());
+    }
+  }
+
+  emitter.MovRR(X86Reg::kRsi, X86Reg::kRax);
+  const void *helper;
+  if (is_store) {
+    emitter.MovRR(X86Reg::kRdx, X86Reg::kR8);
+    switch (size) {
+      case 1: helper = HelperAddress(&StoreHelper<uint8_t>); break;
+      case 2: helper = HelperAddress(&StoreHelper<uint16_t>); break;
+      case 4: helper = HelperAddress(&StoreHelper<uint32_t>); break;
+      default: helper = HelperAddress(&StoreHelper<uint64_t>); break;
+    }
+  } else {
+    switch (funct3) {
+      case 0b000: helper = HelperAddress(&LoadHelper<uint8_t, true>); break;
+      case 0b001: helper = HelperAddress(&LoadHelper<uint16_t, true>); break;
+      case 0b010: helper = HelperAddress(&LoadHelper<uint32_t, true>); break;
+      case 0b011: helper = HelperAddress(&LoadHelper<uint64_t, false>); break;
+      case 0b100: helper = HelperAddress(&LoadHelper<uint8_t, false>); break;
+      case 0b101: helper = HelperAddress(&LoadHelper<uint16_t, false>); break;
+      default: helper = HelperAddress(&LoadHelper<uint32_t, false>); break;
+    }
+  }
+  EmitHelperCall(emitter, helper, index, length, stubs);
+
+  if (done != nullptr) {
+    X86Emitter::PatchRel32(done, emitter.Here());
+  }
+  if (!is_store) {
+    StoreGuest(emitter, (instruction >> 7) & 0b11111, X86Reg::kRax);
+  }
+}
+
+void DbtEngine::EmitHelperCall(X86Emitter &emitter, const void *helper, unsigned int index, unsigned int length,
+                               std::vector<StubSite> &stubs) {
+  emitter.StoreImm(Field(offsetof(Context, pending)), static_cast<int32_t>(length - index));
+  emitter.MovRR(X86Reg::kRdi, X86Reg::kRbx);
+  emitter.CallAbs(helper);
+  emitter.AluMI(AluKind::kCmp, Field(offsetof(Context, exit_reason)), kExitNormal);
+  stubs.push_back({emitter.Jcc(Cond::kNe, nullptr), index});
+}
+
+void DbtEngine::EmitExit(X86Emitter &emitter, uint64_t target, const uint8_t *block_entry, uint64_t block_pc) {
+  if (target == block_pc) {
+    emitter.Jmp(block_entry);
+    return;
+  }
+  auto found = blocks_.find(target);
+  if (found != blocks_.end() && found->second.code != nullptr) {
+    emitter.Jmp(found->second.code);
+    return;
+  }
+  // Falls through to the exit until a block at target is translated and the jump is patched.
+  uint8_t *site = emitter.Jmp(nullptr);
+  X86Emitter::PatchRel32(site, emitter.Here());
+  emitter.MovRI(X86Reg::kRax, target);
+  emitter.Store(Field(offsetof(Context, pc)), X86Reg::kRax, 8);
+  emitter.Jmp(exit_);
+  if (target < vm_->program_size_) {
+    unchained_[target].push_back(site);
+  }
+}
+
+void DbtEngine::LoadGuest(X86Emitter &emitter, X86Reg dst, unsigned int guest) const {
+  if (guest == 0) {
+    emitter.MovRI(dst, 0);
+  } else if (host_register_[guest] >= 0) {
+    X86Reg host = kMappedHostRegisters[host_register_[guest]];
+    if (host != dst) {
+      emitter.MovRR(dst, host);
+    }
+  } else {
+    emitter.Load(dst, GuestSlot(guest), 8, false);
+  }
+}
+
+void DbtEngine::StoreGuest(X86Emitter &emitter, unsigned int guest, X86Reg src) const {
+  if (guest == 0) {
+    return;
+  }
+  if (host_register_[guest] >= 0) {
+    X86Reg host = kMappedHostRegisters[host_register_[guest]];
+    if (host != src) {
+      emitter.MovRR(host, src);
+    }
+  } else {
+    emitter.Store(GuestSlot(guest), src, 8);
+  }
+}
+
+void DbtEngine::SetGuest(X86Emitter &emitter, unsigned int guest, uint64_t value) const {
+  if (guest == 0) {
+    return;
+  }
+  auto signed_value = static_cast<int64_t>(value);
+  if (host_register_[guest] >= 0) {
+    emitter.MovRI(kMappedHostRegisters[host_register_[guest]], value);
+  } else if (signed_value >= INT32_MIN && signed_value <= INT32_MAX) {
+    emitter.StoreImm(GuestSlot(guest), static_cast<int32_t>(signed_value));
+  } else {
+    emitter.MovRI(X86Reg::kRcx, value);
+    emitter.Store(GuestSlot(guest), X86Reg::kRcx, 8);
+  }
+}
+
+X86Reg DbtEngine::SourceOf(X86Emitter &emitter, unsigned int guest, X86Reg scratch) const {
+  if (guest != 0 && host_register_[guest] >= 0) {
+    return kMappedHostRegisters[host_register_[guest]];
+  }
+  LoadGuest(emitter, scratch, guest);
+  return scratch;
+}
+
+void DbtEngine::CatchUpTicks() {
+  Context &context = *context_;
+  int64_t executed = context.start_budget - context.budget - context.pending;
+  if (executed > context.ticked) {
+    bus_->Tick(static_cast<uint64_t>(executed - context.ticked));
+    context.ticked = executed;
+  }
+}
+
+void DbtEngine::FillTlb(uint64_t address, bool is_store) {
+  if (memory_->GetGeneration() != generation_) {
+    ResetTlbs();
+  }
+  if (!fast_memory_) {
+    return;
+  }
+  uint64_t index = address >> block_shift_;
+  uint64_t block_size = uint64_t{1} << block_shift_;
+  uint64_t start = index << block_shift_;
+  // Only plain RAM, far enough from the end of memory that no access in it is out of range.
+  if (bus_->Overlaps(start, block_size) || start + block_size < start
+      || start + block_size > memory_->GetMemorySize() - 8) {
+    return;
+  }
+  Context &context = *context_;
+  if (!is_store) {
+    uint8_t *block = memory_->FindBlockOf(address);
+    if (block != nullptr) {
+      context.read_tlb[index % kTlbEntries] = {index, block};
+    }
+    return;
+  }
+  if (code_blocks_.contains(index) || memory_->IsReservationTracking()) {
+    return;
+  }
+  uint8_t *block = memory_->GetWritableBlock(address);
+  if (memory_->GetGeneration() != generation_) {
+    ResetTlbs();
+  }
+  context.write_tlb[index % kTlbEntries] = {index, block};
+  context.read_tlb[index % kTlbEntries] = {index, block};
+}
+
+template<typename T, bool kSigned>
+uint64_t DbtEngine::LoadHelper(Context *context, uint64_t address) {
+  DbtEngine &engine = *context->engine;
+  try {
+    if (engine.bus_->Overlaps(address, sizeof(T))) {
+      engine.CatchUpTicks();
+    }
+    MemoryController &memory = engine.vm_->memory_controller_;
+    T value;
+    if constexpr (sizeof(T) == 1) {
+      value = memory.ReadByte(address);
+    } else if constexpr (sizeof(T) == 2) {
+      value = memory.ReadHalfWord(address);
+    } else if constexpr (sizeof(T) == 4) {
+      value = memory.ReadWord(address);
+    } else {
+      value = memory.ReadDoubleWord(address);
+    }
+    engine.FillTlb(address, false);
+    if constexpr (kSigned) {
+      return static_cast<uint64_t>(static_cast<int64_t>(static_cast<std::make_signed_t<T>>(value)));
+    } else {
+      return value;
+    }
+  } catch (...) {
+    engine.fault_ = std::current_exception();
+    context->exit_reason = kExitFault;
+    return 0;
+  }
+}
+
+template<typename T>
+void DbtEngine::StoreHelper(Context *context, uint64_t address, uint64_t value) {
+  DbtEngine &engine = *context->engine;
+  try {
+    // The interpreter reads the old bytes for its undo history first, so range errors come
+    // from those reads.
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      (void)engine.memory_->ReadByte(address + i);
+    }
+    bool device = engine.bus_->Overlaps(address, sizeof(T));
+    if (device) {
+      engine.CatchUpTicks();
+    }
+    MemoryController &memory = engine.vm_->memory_controller_;
+    if constexpr (sizeof(T) == 1) {
+      memory.WriteByte(address, static_cast<T>(value));
+    } else if constexpr (sizeof(T) == 2) {
+      memory.WriteHalfWord(address, static_cast<T>(value));
+    } else if constexpr (sizeof(T) == 4) {
+      memory.WriteWord(address, static_cast<T>(value));
+    } else {
+      memory.WriteDoubleWord(address, static_cast<T>(value));
+    }
+    if (device && engine.bus_->Busy()) {
+      context->exit_reason = kExitSync; // a DMA copy started: interpret until it is done
+    }
+    if (engine.code_blocks_.contains(address >> engine.block_shift_)
+        || engine.code_blocks_.contains((address + sizeof(T) - 1) >> engine.block_shift_)) {
+      engine.flush_requested_ = true;
+      context->exit_reason = kExitSync;
+    }
+    engine.FillTlb(address, true);
+  } catch (...) {
+    engine.fault_ = std::current_exception();
+    context->exit_reason = kExitFault;
+  }
+}
+
+} // namespace dbt
@@ -0,0 +1,279 @@
+/**
+ * @file x86_emitter.cpp
+ * @brief Contains the implementation of the X86Emitter class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/dbt/x86_emitter.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace dbt {
+
+namespace {
+
+uint8_t Code(X86Reg reg) {
+  return static_cast<uint8_t>(reg);
+}
+
+bool FitsInt8(int64_t value) {
+  return value >= INT8_MIN && value <= INT8_MAX;
+}
+
+} // namespace
+
+void X86Emitter::Byte(uint8_t value) {
+  if (size_ >= capacity_) {
+    throw std::length_error("Translated code does not fit in the code cache");
+  }
+  buffer_[size_++] = value;
+}
+
+void X86Emitter::Imm32(uint32_t value) {
+  for (int i = 0; i < 4; ++i) {
+    Byte(static_cast<uint8_t>(value >> (8*i)));
+  }
+}
+
+void X86Emitter::Imm64(uint64_t value) {
+  for (int i = 0; i < 8; ++i) {
+    Byte(static_cast<uint8_t>(value >> (8*i)));
+  }
+}
+
+void X86Emitter::Rex(bool wide, uint8_t reg, uint8_t index, uint8_t base, bool force) {
+  uint8_t rex = 0x40 | (wide ? 0x08 : 0) | ((reg >> 3) << 2) | ((index >> 3) << 1) | (base >> 3);
+  if (rex != 0x40 || force) {
+    Byte(rex);
+  }
+}
+
+void X86Emitter::ModRmReg(uint8_t reg, uint8_t rm) {
+  Byte(0xC0 | ((reg & 7) << 3) | (rm & 7));
+}
+
+void X86Emitter::ModRmMem(uint8_t reg, const X86Mem &mem) {
+  uint8_t base = Code(mem.base) & 7;
+  // rsp/r12 as a base need a SIB byte; rbp/r13 with no displacement mean rip-relative.
+  bool sib = mem.has_index || base == 4;
+  uint8_t mod = (mem.disp == 0 && base != 5) ? 0 : (FitsInt8(mem.disp) ? 1 : 2);
+  Byte((mod << 6) | ((reg & 7) << 3) | (sib ? 4 : base));
+  if (sib) {
+    uint8_t index = mem.has_index ? (Code(mem.index) & 7) : 4;
+    Byte((index << 3) | base);
+  }
+  if (mod == 1) {
+    Byte(static_cast<uint8_t>(mem.disp));
+  } else if (mod == 2) {
+    Imm32(static_cast<uint32_t>(mem.disp));
+  }
+}
+
+void X86Emitter::RexMem(bool wide, uint8_t reg, const X86Mem &mem, bool force) {
+  Rex(wide, reg, mem.has_index ? Code(mem.index) : 0, Code(mem.base), force);
+}
+
+void X86Emitter::MovRR(X86Reg dst, X86Reg src) {
+  Rex(true, Code(src), 0, Code(dst));
+  Byte(0x89);
+  ModRmReg(Code(src), Code(dst));
+}
+
+void X86Emitter::MovRI(X86Reg dst, uint64_t imm) {
+  if (imm <= UINT32_MAX) { // mov r32, imm32 zero-extends
+    Rex(false, 0, 0, Code(dst));
+    Byte(0xB8 + (Code(dst) & 7));
+    Imm32(static_cast<uint32_t>(imm));
+  } else if (static_cast<int64_t>(imm) >= INT32_MIN && static_cast<int64_t>(imm) <= INT32_MAX) {
+    Rex(true, 0, 0, Code(dst));
+    Byte(0xC7);
+    ModRmReg(0, Code(dst));
+    Imm32(static_cast<uint32_t>(imm));
+  } else {
+    Rex(true, 0, 0, Code(dst));
+    Byte(0xB8 + (Code(dst) & 7));
+    Imm64(imm);
+  }
+}
+
+void X86Emitter::Load(X86Reg dst, X86Mem mem, unsigned int size, bool sign_extend) {
+  switch (size) {
+    case 1:
+      RexMem(sign_extend, Code(dst), mem);
+      Byte(0x0F);
+      Byte(sign_extend ? 0xBE : 0xB6);
+      break;
+    case 2:
+      RexMem(sign_extend, Code(dst), mem);
+      Byte(0x0F);
+      Byte(sign_extend ? 0xBF : 0xB7);
+      break;
+    case 4:
+      RexMem(sign_extend, Code(dst), mem);
+      Byte(sign_extend ? 0x63 : 0x8B); // movsxd, or mov r32 which zero-extends
+      break;
+    default:
+      RexMem(true, Code(dst), mem);
+      Byte(0x8B);
+      break;
+  }
+  ModRmMem(Code(dst), mem);
+}
+
+void X86Emitter::Store(X86Mem mem, X86Reg src, unsigned int size) {
+  if (size == 2) {
+    Byte(0x66);
+  }
+  RexMem(size == 8, Code(src), mem, size == 1 && Code(src) >= 4);
+  Byte(size == 1 ? 0x88 : 0x89);
+  ModRmMem(Code(src), mem);
+}
+
+void X86Emitter::StoreImm(X86Mem mem, int32_t imm) {
+  RexMem(true, 0, mem);
+  Byte(0xC7);
+  ModRmMem(0, mem);
+  Imm32(static_cast<uint32_t>(imm));
+}
+
+void X86Emitter::AluRR(AluKind kind, X86Reg dst, X86Reg src) {
+  Rex(true, Code(src), 0, Code(dst));
+  Byte(static_cast<uint8_t>(kind)*8 + 1);
+  ModRmReg(Code(src), Code(dst));
+}
+
+void X86Emitter::AluRM(AluKind kind, X86Reg dst, X86Mem mem) {
+  RexMem(true, Code(dst), mem);
+  Byte(static_cast<uint8_t>(kind)*8 + 3);
+  ModRmMem(Code(dst), mem);
+}
+
+void X86Emitter::AluRI(AluKind kind, X86Reg dst, int32_t imm) {
+  Rex(true, 0, 0, Code(dst));
+  Byte(FitsInt8(imm) ? 0x83 : 0x81);
+  ModRmReg(static_cast<uint8_t>(kind), Code(dst));
+  if (FitsInt8(imm)) {
+    Byte(static_cast<uint8_t>(imm));
+  } else {
+    Imm32(static_cast<uint32_t>(imm));
+  }
+}
+
+void X86Emitter::AluMI(AluKind kind, X86Mem mem, int32_t imm) {
+  RexMem(true, 0, mem);
+  Byte(FitsInt8(imm) ? 0x83 : 0x81);
+  ModRmMem(static_cast<uint8_t>(kind), mem);
+  if (FitsInt8(imm)) {
+    Byte(static_cast<uint8_t>(imm));
+  } else {
+    Imm32(static_cast<uint32_t>(imm));
+  }
+}
+
+void X86Emitter::ShiftRCl(ShiftKind kind, X86Reg dst) {
+  Rex(true, 0, 0, Code(dst));
+  Byte(0xD3);
+  ModRmReg(static_cast<uint8_t>(kind), Code(dst));
+}
+
+void X86Emitter::ShiftRI(ShiftKind kind, X86Reg dst, uint8_t count) {
+  Rex(true, 0, 0, Code(dst));
+  Byte(0xC1);
+  ModRmReg(static_cast<uint8_t>(kind), Code(dst));
+  Byte(count);
+}
+
+void X86Emitter::ImulRR(X86Reg dst, X86Reg src) {
+  Rex(true, Code(dst), 0, Code(src));
+  Byte(0x0F);
+  Byte(0xAF);
+  ModRmReg(Code(dst), Code(src));
+}
+
+void X86Emitter::MulWide(X86Reg src, bool is_signed) {
+  Rex(true, 0, 0, Code(src));
+  Byte(0xF7);
+  ModRmReg(is_signed ? 5 : 4, Code(src));
+}
+
+void X86Emitter::TestRI(X86Reg reg, int32_t imm) {
+  Rex(true, 0, 0, Code(reg));
+  Byte(0xF7);
+  ModRmReg(0, Code(reg));
+  Imm32(static_cast<uint32_t>(imm));
+}
+
+void X86Emitter::SetCond(Cond cond, X86Reg dst) {
+  Rex(false, 0, 0, Code(dst), Code(dst) >= 4);
+  Byte(0x0F);
+  Byte(0x90 + static_cast<uint8_t>(cond));
+  ModRmReg(0, Code(dst));
+  // movzx r32, r8 clears the rest of the register.
+  Rex(false, Code(dst), 0, Code(dst), Code(dst) >= 4);
+  Byte(0x0F);
+  Byte(0xB6);
+  ModRmReg(Code(dst), Code(dst));
+}
+
+void X86Emitter::Push(X86Reg reg) {
+  Rex(false, 0, 0, Code(reg));
+  Byte(0x50 + (Code(reg) & 7));
+}
+
+void X86Emitter::Pop(X86Reg reg) {
+  Rex(false, 0, 0, Code(reg));
+  Byte(0x58 + (Code(reg) & 7));
+}
+
+void X86Emitter::Ret() {
+  Byte(0xC3);
+}
+
+void X86Emitter::CallAbs(const void *target) {
+  Rex(true, 0, 0, 0);
+  Byte(0xB8);
+  Imm64(reinterpret_cast<uint64_t>(target));
+  Byte(0xFF);
+  ModRmReg(2, Code(X86Reg::kRax));
+}
+
+uint8_t *X86Emitter::Jcc(Cond cond, const uint8_t *target) {
+  Byte(0x0F);
+  Byte(0x80 + static_cast<uint8_t>(cond));
+  uint8_t *site = Here();
+  Imm32(0);
+  if (target != nullptr) {
+    PatchRel32(site, target);
+  }
+  return site;
+}
+
+uint8_t *X86Emitter::Jmp(const uint8_t *target) {
+  Byte(0xE9);
+  uint8_t *site = Here();
+  Imm32(0);
+  if (target != nullptr) {
+    PatchRel32(site, target);
+  }
+  return site;
+}
+
+void X86Emitter::JmpMem(X86Mem mem) {
+  RexMem(false, 0, mem);
+  Byte(0xFF);
+  ModRmMem(4, mem);
+}
+
+void X86Emitter::JmpReg(X86Reg reg) {
+  Rex(false, 0, 0, Code(reg));
+  Byte(0xFF);
+  ModRmReg(4, Code(reg));
+}
+
+void X86Emitter::PatchRel32(uint8_t *site, const uint8_t *target) {
+  auto rel = static_cast<int32_t>(target - (site + 4));
+  std::memcpy(site, &rel, sizeof(rel));
+}
+
+} // namespace dbt
@@ -0,0 +1,30 @@
+/**
+ * @file edge_coverage.cpp
+ * @brief Contains the implementation of the EdgeCoverage class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/edge_coverage.h"
+
+void EdgeCoverage::Clear() {
+  for (uint32_t index : touched_) {
+    hits_[index] = 0;
+  }
+  touched_.clear();
+}
+
+uint8_t EdgeCoverage::Bucket(uint8_t hits) {
+  if (hits <= 3) {
+    return hits == 3 ? 4 : hits;
+  }
+  if (hits < 8) {
+    return 8;
+  }
+  if (hits < 16) {
+    return 16;
+  }
+  if (hits < 32) {
+    return 32;
+  }
+  return hits < 128 ? 64 : 128;
+}
@@ -0,0 +1,208 @@
+/**
+ * @file guest_io.cpp
+ * @brief Contains the implementation of the GuestIo class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/guest_io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+// Open flags as defined by the RISC-V Linux ABI (asm-generic/fcntl.h).
+constexpr int64_t kGuestOWronly = 01;
+constexpr int64_t kGuestORdwr = 02;
+constexpr int64_t kGuestOCreat = 0100;
+constexpr int64_t kGuestOExcl = 0200;
+constexpr int64_t kGuestOTrunc = 01000;
+constexpr int64_t kGuestOAppend = 02000;
+
+int HostOpenFlags(int64_t guest_flags) {
+  int flags = O_RDONLY;
+  if ((guest_flags & 03) == kGuestOWronly) flags = O_WRONLY;
+  if ((guest_flags & 03) == kGuestORdwr) flags = O_RDWR;
+  if (guest_flags & kGuestOCreat) flags |= O_CREAT;
+  if (guest_flags & kGuestOExcl) flags |= O_EXCL;
+  if (guest_flags & kGuestOTrunc) flags |= O_TRUNC;
+  if (guest_flags & kGuestOAppend) flags |= O_APPEND;
+  return flags;
+}
+} // namespace
+
+GuestIo::~GuestIo() {
+  Reset();
+}
+
+void GuestIo::SetSandboxDirectory(const std::filesystem::path &directory) {
+  sandbox_directory_ = directory;
+}
+
+void GuestIo::SetFlushThreshold(size_t bytes) {
+  flush_threshold_ = bytes;
+}
+
+void GuestIo::PreloadStdin(const std::filesystem::path &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Unable to open stdin file: " + filename.string());
+  }
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  SetStdin(contents.str());
+}
+
+void GuestIo::SetStdin(std::string contents) {
+  stdin_contents_ = std::move(contents);
+  stdin_position_ = 0;
+  stdin_preloaded_ = true;
+}
+
+void GuestIo::WriteConsole(int64_t fd, std::string_view text) {
+  std::string &buffer = (fd == 2) ? stderr_buffer_ : stdout_buffer_;
+  buffer.append(text);
+  if (buffer.size() >= flush_threshold_) {
+    (fd == 2) ? FlushStderr() : FlushStdout();
+  }
+}
+
+int64_t GuestIo::Write(int64_t fd, std::span<const uint8_t> data) {
+  if (fd == 1 || fd == 2) {
+    WriteConsole(fd, {reinterpret_cast<const char *>(data.data()), data.size()});
+    return static_cast<int64_t>(data.size());
+  }
+  auto it = files_.find(fd);
+  if (it == files_.end()) {
+    return -EBADF;
+  }
+  ssize_t written = ::write(it->second, data.data(), data.size());
+  return written < 0 ? -errno : written;
+}
+
+int64_t GuestIo::Read(int64_t fd, std::span<uint8_t> buffer) {
+  if (fd == 0) {
+    if (!stdin_preloaded_) {
+      return -EAGAIN;
+    }
+    size_t count = std::min(buffer.size(), stdin_contents_.size() - stdin_position_);
+    std::copy_n(stdin_contents_.begin() + static_cast<std::ptrdiff_t>(stdin_position_), count, buffer.begin());
+    stdin_position_ += count;
+    return static_cast<int64_t>(count);
+  }
+  auto it = files_.find(fd);
+  if (it == files_.end()) {
+    return -EBADF;
+  }
+  ssize_t count = ::read(it->second, buffer.data(), buffer.size());
+  return count < 0 ? -errno : count;
+}
+
+int64_t GuestIo::Open(const std::string &path, int64_t flags, int64_t mode) {
+  if (sandbox_directory_.empty()) {
+    return -EACCES;
+  }
+  std::filesystem::path sandbox = sandbox_directory_;
+  std::error_code ec;
+  std::filesystem::create_directories(sandbox, ec);
+  sandbox = std::filesystem::weakly_canonical(sandbox, ec);
+
+  std::filesystem::path host_path = std::filesystem::weakly_canonical(
+      sandbox / std::filesystem::path(path).relative_path(), ec);
+  if (ec) {
+    return -ENOENT;
+  }
+  auto [sandbox_end, unused] = std::mismatch(sandbox.begin(), sandbox.end(), host_path.begin(), host_path.end());
+  if (sandbox_end != sandbox.end()) {
+    return -EACCES;
+  }
+
+  int host_fd = ::open(host_path.c_str(), HostOpenFlags(flags), static_cast<mode_t>(mode & 0777));
+  if (host_fd < 0) {
+    return -errno;
+  }
+  int64_t fd = next_fd_++;
+  files_[fd] = host_fd;
+  return fd;
+}
+
+int64_t GuestIo::Close(int64_t fd) {
+  if (fd >= 0 && fd <= 2) {
+    Flush();
+    return 0;
+  }
+  auto it = files_.find(fd);
+  if (it == files_.end()) {
+    return -EBADF;
+  }
+  int result = ::close(it->second);
+  files_.erase(it);
+  return result < 0 ? -errno : 0;
+}
+
+int64_t GuestIo::Seek(int64_t fd, int64_t offset, int64_t whence) {
+  if (fd >= 0 && fd <= 2) {
+    return -ESPIPE;
+  }
+  auto it = files_.find(fd);
+  if (it == files_.end()) {
+    return -EBADF;
+  }
+  if (whence != SEEK_SET && whence != SEEK_CUR && whence != SEEK_END) {
+    return -EINVAL;
+  }
+  off_t position = ::lseek(it->second, static_cast<off_t>(offset), static_cast<int>(whence));
+  return position < 0 ? -errno : position;
+}
+
+void GuestIo::FlushStdout() {
+  if (stdout_buffer_.empty()) {
+    return;
+  }
+  if (capture_output_) {
+    captured_stdout_ += stdout_buffer_;
+  } else if (backend_output_) {
+    std::cout << "VM_STDOUT_START" << stdout_buffer_ << "VM_STDOUT_END" << std::endl;
+  } else {
+    std::cout << stdout_buffer_ << std::flush;
+  }
+  stdout_buffer_.clear();
+}
+
+void GuestIo::FlushStderr() {
+  if (stderr_buffer_.empty()) {
+    return;
+  }
+  if (capture_output_) {
+    captured_stderr_ += stderr_buffer_;
+  } else {
+    std::cerr << stderr_buffer_ << std::flush;
+  }
+  stderr_buffer_.clear();
+}
+
+void GuestIo::Flush() {
+  FlushStdout();
+  FlushStderr();
+}
+
+void GuestIo::Reset() {
+  Flush();
+  for (const auto &[fd, host_fd] : files_) {
+    ::close(host_fd);
+  }
+  files_.clear();
+  next_fd_ = 3;
+  stdin_contents_.clear();
+  stdin_position_ = 0;
+  stdin_preloaded_ = false;
+  captured_stdout_.clear();
+  captured_stderr_.clear();
+}
@@ -5,11 +5,13 @@
  */
 
 #include "vm/main_memory.h"
-#include "globals.h"
 
+#include <bit>
 #include <cstdint>
+#include <new>
 #include <stdexcept>
 #include <cstring>
+#include <type_traits>
 #include <iostream>
 #include <vector>
 #include <ostream>
@@ -18,66 +20,422 @@
 #include <algorithm>
 #include <sstream>
 
-uint8_t Memory::Read(uint64_t address) {
-  if (address >= memory_size_) {
-    throw std::out_of_range("Memory address out of range: " + std::to_string(address));
+namespace {
+
+static_assert(std::endian::native == std::endian::little,
+              "guest memory is little-endian and words are accessed in host byte order");
+
+constexpr std::align_val_t kBlockAlignment{64};
+
+// Each block is preceded by a header padded to the alignment, so the data stays cache-line aligned.
+struct BlockHeader {
+  std::atomic<uint64_t> references; ///< Tables holding the block.
+};
+
+constexpr size_t kBlockHeaderSize = static_cast<size_t>(kBlockAlignment);
+static_assert(sizeof(BlockHeader) <= kBlockHeaderSize);
+
+constexpr uintptr_t kSharedTag = 1;
+
+uint8_t *AllocateBlock(size_t block_size) {
+  auto *raw = static_cast<uint8_t *>(::operator new(kBlockHeaderSize + block_size, kBlockAlignment));
+  new (raw) BlockHeader{1};
+  return raw + kBlockHeaderSize;
+}
+
+void FreeBlock(uint8_t *block) {
+  ::operator delete(block - kBlockHeaderSize, kBlockAlignment);
+}
+
+BlockHeader &HeaderOf(uint8_t *block) {
+  return *reinterpret_cast<BlockHeader *>(block - kBlockHeaderSize);
+}
+
+bool IsShared(const void *slot) {
+  return (reinterpret_cast<uintptr_t>(slot) & kSharedTag) != 0;
+}
+
+uint8_t *BlockOf(void *slot) {
+  return reinterpret_cast<uint8_t *>(reinterpret_cast<uintptr_t>(slot) & ~kSharedTag);
+}
+
+void *Shared(uint8_t *block) {
+  return reinterpret_cast<void *>(reinterpret_cast<uintptr_t>(block) | kSharedTag);
+}
+
+// Drops one table's reference, freeing the block with the last one.
+void ReleaseBlock(uint8_t *block) {
+  if (HeaderOf(block).references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    FreeBlock(block);
   }
-  uint64_t block_index = GetBlockIndex(address);
-  uint64_t offset = GetBlockOffset(address);
-  if (!IsBlockPresent(block_index)) {
-    return 0;
+}
+
+// A small direct-mapped cache of table slots per host thread, so most accesses skip the
+// table walk. Entries are tagged with the owning Memory's id, which Reset, Fork and
+// copy-on-write change.
+struct BlockCacheEntry {
+  uint64_t memory_id = 0;
+  uint64_t block_index = 0;
+  void *slot = nullptr; ///< Keeps the shared tag, so writes know to copy the block first.
+};
+
+constexpr size_t kBlockCacheSize = 64;
+thread_local std::array<BlockCacheEntry, kBlockCacheSize> block_cache;
+
+std::atomic<uint64_t> next_memory_id{1};
+
+template<typename T>
+std::atomic_ref<T> AtomicAt(uint8_t *block, uint64_t offset) {
+  return std::atomic_ref<T>(*reinterpret_cast<T *>(block + offset));
+}
+
+template<typename T>
+T ApplyAmo(Memory::AmoOp op, std::atomic_ref<T> value, T operand) {
+  using Signed = std::make_signed_t<T>;
+  switch (op) {
+    case Memory::AmoOp::kSwap: return value.exchange(operand);
+    case Memory::AmoOp::kAdd: return value.fetch_add(operand);
+    case Memory::AmoOp::kXor: return value.fetch_xor(operand);
+    case Memory::AmoOp::kAnd: return value.fetch_and(operand);
+    case Memory::AmoOp::kOr: return value.fetch_or(operand);
+    default: break;
+  }
+  T old = value.load(std::memory_order_relaxed);
+  T desired;
+  do {
+    switch (op) {
+      case Memory::AmoOp::kMin:
+        desired = static_cast<Signed>(old) < static_cast<Signed>(operand) ? old : operand;
+        break;
+      case Memory::AmoOp::kMax:
+        desired = static_cast<Signed>(old) > static_cast<Signed>(operand) ? old : operand;
+        break;
+      case Memory::AmoOp::kMinu: desired = std::min(old, operand); break;
+      default: desired = std::max(old, operand); break;
+    }
+  } while (!value.compare_exchange_weak(old, desired));
+  return old;
+}
+
+} // namespace
+
+Memory::Memory(const vm_config::VmConfig &config)
+    : Memory(static_cast<unsigned int>(std::bit_ceil(std::max<uint64_t>(config.getMemoryBlockSize(), 8))),
+             config.getMemorySize()) {}
+
+Memory::Memory(unsigned int block_size, uint64_t memory_size)
+    : root_(new RadixNode),
+      id_(next_memory_id.fetch_add(1)),
+      block_size_(block_size),
+      block_shift_(static_cast<unsigned int>(std::countr_zero(block_size_))),
+      memory_size_(memory_size),
+      reservation_stamps_(std::make_unique<std::atomic<uint64_t>[]>(size_t{1} << kReservationStripeBits)) {
+  unsigned int address_bits = memory_size_ <= 1 ? 1 : static_cast<unsigned int>(std::bit_width(memory_size_ - 1));
+  unsigned int index_bits = address_bits > block_shift_ ? address_bits - block_shift_ : 1;
+  levels_ = (index_bits + kRadixBits - 1)/kRadixBits;
+}
+
+Memory::~Memory() {
+  FreeTable(root_, levels_ - 1);
+  FreeRetiredBlocks();
+}
+
+void Memory::Reset() {
+  FreeTable(root_, levels_ - 1);
+  FreeRetiredBlocks();
+  root_ = new RadixNode;
+  id_ = next_memory_id.fetch_add(1);
+  block_count_ = 0;
+  for (size_t i = 0; i < (size_t{1} << kReservationStripeBits); ++i) {
+    reservation_stamps_[i].store(0, std::memory_order_relaxed);
   }
-  return blocks_[block_index].data[offset];
 }
 
-void Memory::Write(uint64_t address, uint8_t value) {
-  if (address >= memory_size_) {
-    throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));
+void Memory::FreeTable(RadixNode *node, unsigned int level) {
+  for (std::atomic<void *> &slot : node->slots) {
+    void *child = slot.load(std::memory_order_relaxed);
+    if (child == nullptr) {
+      continue;
+    }
+    if (level == 0) {
+      ReleaseBlock(BlockOf(child));
+    } else {
+      FreeTable(static_cast<RadixNode *>(child), level - 1);
+    }
+  }
+  delete node;
+}
+
+void Memory::FreeRetiredBlocks() {
+  std::lock_guard<std::mutex> lock(retired_mutex_);
+  for (uint8_t *block : retired_blocks_) {
+    FreeBlock(block);
+  }
+  retired_blocks_.clear();
+}
+
+std::unique_ptr<Memory> Memory::Fork() {
+  std::unique_ptr<Memory> fork(new Memory(block_size_, memory_size_));
+  delete fork->root_;
+  fork->root_ = ShareTable(root_, levels_ - 1);
+  fork->block_count_ = block_count_.load();
+  // Blocks this thread cached as writable are shared now.
+  id_ = next_memory_id.fetch_add(1);
+  return fork;
+}
+
+Memory::RadixNode *Memory::ShareTable(RadixNode *node, unsigned int level) {
+  auto *copy = new RadixNode;
+  for (size_t slot = 0; slot < kRadixFanout; ++slot) {
+    void *child = node->slots[slot].load(std::memory_order_acquire);
+    if (child == nullptr) {
+      continue;
+    }
+    if (level == 0) {
+      uint8_t *block = BlockOf(child);
+      HeaderOf(block).references.fetch_add(1, std::memory_order_relaxed);
+      node->slots[slot].store(Shared(block), std::memory_order_release);
+      copy->slots[slot].store(Shared(block), std::memory_order_relaxed);
+    } else {
+      copy->slots[slot].store(ShareTable(static_cast<RadixNode *>(child), level - 1), std::memory_order_relaxed);
+    }
+  }
+  return copy;
+}
+
+uint64_t Memory::GetSharedBlockCount() const {
+  return CountSharedBlocks(root_, levels_ - 1);
+}
+
+uint64_t Memory::CountSharedBlocks(const RadixNode *node, unsigned int level) const {
+  uint64_t count = 0;
+  for (const std::atomic<void *> &slot : node->slots) {
+    void *child = slot.load(std::memory_order_acquire);
+    if (child == nullptr) {
+      continue;
+    }
+    if (level == 0) {
+      count += IsShared(child) && HeaderOf(BlockOf(child)).references.load(std::memory_order_relaxed) > 1;
+    } else {
+      count += CountSharedBlocks(static_cast<const RadixNode *>(child), level - 1);
+    }
+  }
+  return count;
+}
+
+uint8_t *Memory::FindBlock(uint64_t block_index) const {
+  BlockCacheEntry &cached = block_cache[block_index % kBlockCacheSize];
+  uint64_t id = id_.load(std::memory_order_acquire);
+  if (cached.memory_id == id && cached.block_index == block_index) {
+    return BlockOf(cached.slot);
+  }
+  const RadixNode *node = root_;
+  for (unsigned int level = levels_ - 1;; --level) {
+    size_t slot = (block_index >> (level*kRadixBits)) & (kRadixFanout - 1);
+    void *child = node->slots[slot].load(std::memory_order_acquire);
+    if (child == nullptr) {
+      return nullptr;
+    }
+    if (level == 0) {
+      cached = {id, block_index, child};
+      return BlockOf(child);
+    }
+    node = static_cast<const RadixNode *>(child);
+  }
+}
+
+uint8_t *Memory::EnsureBlockExists(uint64_t block_index) {
+  BlockCacheEntry &cached = block_cache[block_index % kBlockCacheSize];
+  uint64_t id = id_.load(std::memory_order_acquire);
+  if (cached.memory_id == id && cached.block_index == block_index && !IsShared(cached.slot)) {
+    return static_cast<uint8_t *>(cached.slot);
+  }
+  RadixNode *node = root_;
+  for (unsigned int level = levels_ - 1;; --level) {
+    std::atomic<void *> &slot = node->slots[(block_index >> (level*kRadixBits)) & (kRadixFanout - 1)];
+    void *child = slot.load(std::memory_order_acquire);
+    if (child == nullptr) {
+      void *fresh;
+      if (level == 0) {
+        fresh = AllocateBlock(block_size_);
+        std::memset(fresh, 0, block_size_);
+      } else {
+        fresh = new RadixNode;
+      }
+      if (slot.compare_exchange_strong(child, fresh, std::memory_order_acq_rel, std::memory_order_acquire)) {
+        child = fresh;
+        if (level == 0) {
+          block_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+      } else if (level == 0) {
+        FreeBlock(static_cast<uint8_t *>(fresh));
+      } else {
+        delete static_cast<RadixNode *>(fresh);
+      }
+    }
+    if (level == 0) {
+      uint8_t *block = IsShared(child) ? Unshare(slot, child) : static_cast<uint8_t *>(child);
+      cached = {id_.load(std::memory_order_acquire), block_index, block};
+      return block;
+    }
+    node = static_cast<RadixNode *>(child);
   }
-  uint64_t block_index = GetBlockIndex(address);
-  uint64_t offset = GetBlockOffset(address);
-  EnsureBlockExists(block_index);
-  blocks_[block_index].data[offset] = value;
 }
 
-uint64_t Memory::GetBlockIndex(uint64_t address) const {
-  return address/block_size_;
+uint8_t *Memory::Unshare(std::atomic<void *> &slot, void *shared) {
+  while (IsShared(shared)) {
+    uint8_t *block = BlockOf(shared);
+    BlockHeader &header = HeaderOf(block);
+    // Forks only happen while nothing writes to this memory, so a count of one stays one.
+    bool sole_owner = header.references.load(std::memory_order_acquire) == 1;
+    uint8_t *owned = block;
+    if (!sole_owner) {
+      owned = AllocateBlock(block_size_);
+      std::memcpy(owned, block, block_size_);
+    }
+    if (slot.compare_exchange_strong(shared, owned, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      if (!sole_owner && header.references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        // The other holders let go meanwhile; harts of this memory may still read it through their caches.
+        std::lock_guard<std::mutex> lock(retired_mutex_);
+        retired_blocks_.push_back(block);
+      }
+      // Other threads may have cached the shared block for reading.
+      id_ = next_memory_id.fetch_add(1);
+      return owned;
+    }
+    if (!sole_owner) {
+      FreeBlock(owned);
+    }
+  }
+  return static_cast<uint8_t *>(shared);
 }
 
-uint64_t Memory::GetBlockOffset(uint64_t address) const {
-  return address%block_size_;
+void Memory::CollectBlocks(const RadixNode *node, unsigned int level, uint64_t prefix,
+                           std::vector<std::pair<uint64_t, const uint8_t *>> &blocks) const {
+  for (size_t slot = 0; slot < kRadixFanout; ++slot) {
+    void *child = node->slots[slot].load(std::memory_order_acquire);
+    if (child == nullptr) {
+      continue;
+    }
+    uint64_t index = (prefix << kRadixBits) | slot;
+    if (level == 0) {
+      blocks.emplace_back(index, BlockOf(child));
+    } else {
+      CollectBlocks(static_cast<const RadixNode *>(child), level - 1, index, blocks);
+    }
+  }
 }
 
-bool Memory::IsBlockPresent(uint64_t block_index) const {
-  return blocks_.find(block_index)!=blocks_.end();
+std::vector<std::pair<uint64_t, const uint8_t *>> Memory::GetBlocks() const {
+  std::vector<std::pair<uint64_t, const uint8_t *>> blocks;
+  blocks.reserve(GetBlockCount());
+  CollectBlocks(root_, levels_ - 1, 0, blocks);
+  return blocks;
 }
 
-void Memory::EnsureBlockExists(uint64_t block_index) {
-  if (blocks_.find(block_index)==blocks_.end()) {
-    blocks_.emplace(block_index, MemoryBlock());
+std::atomic<uint64_t> &Memory::ReservationStripe(uint64_t address) const {
+  // Fibonacci hashing spreads neighbouring granules over different cache lines.
+  uint64_t granule = address >> 3;
+  return reservation_stamps_[(granule*0x9E3779B97F4A7C15ULL) >> (64 - kReservationStripeBits)];
+}
+
+void Memory::CheckAtomicAccess(uint64_t address, unsigned int size) const {
+  if (address >= memory_size_ || size > memory_size_ - address) {
+    throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));
+  }
+  if (address % size != 0) {
+    throw std::runtime_error("Misaligned atomic memory access: " + std::to_string(address));
+  }
+}
+
+bool Memory::CompareExchange(uint64_t address, unsigned int size, uint64_t expected, uint64_t desired) {
+  CheckAtomicAccess(address, size);
+  uint8_t *block = EnsureBlockExists(GetBlockIndex(address));
+  uint64_t offset = GetBlockOffset(address);
+  bool exchanged;
+  if (size == 4) {
+    auto old = static_cast<uint32_t>(expected);
+    exchanged = AtomicAt<uint32_t>(block, offset).compare_exchange_strong(old, static_cast<uint32_t>(desired));
+  } else {
+    exchanged = AtomicAt<uint64_t>(block, offset).compare_exchange_strong(expected, desired);
+  }
+  if (exchanged) {
+    BumpReservation(address);
+  }
+  return exchanged;
+}
+
+uint64_t Memory::AtomicRmw(AmoOp op, uint64_t address, unsigned int size, uint64_t operand) {
+  CheckAtomicAccess(address, size);
+  uint8_t *block = EnsureBlockExists(GetBlockIndex(address));
+  uint64_t offset = GetBlockOffset(address);
+  uint64_t old;
+  if (size == 4) {
+    old = ApplyAmo<uint32_t>(op, AtomicAt<uint32_t>(block, offset), static_cast<uint32_t>(operand));
+  } else {
+    old = ApplyAmo<uint64_t>(op, AtomicAt<uint64_t>(block, offset), operand);
+  }
+  BumpReservation(address);
+  return old;
+}
+
+uint64_t Memory::AtomicLoad(uint64_t address, unsigned int size) {
+  CheckAtomicAccess(address, size);
+  uint8_t *block = FindBlock(GetBlockIndex(address));
+  if (block == nullptr) {
+    return 0;
   }
+  uint64_t offset = GetBlockOffset(address);
+  if (size == 4) {
+    return AtomicAt<uint32_t>(block, offset).load();
+  }
+  return AtomicAt<uint64_t>(block, offset).load();
 }
 
 template<typename T>
 T Memory::ReadGeneric(uint64_t address) {
+  if (address % sizeof(T) == 0) [[likely]] {
+    uint8_t *block = FindBlock(GetBlockIndex(address));
+    if (block == nullptr) {
+      return 0;
+    }
+    return AtomicAt<T>(block, GetBlockOffset(address)).load(std::memory_order_acquire);
+  }
   T value = 0;
   for (size_t i = 0; i < sizeof(T); ++i) {
-    value |= static_cast<T>(Read(address + i)) << (8*i);
+    value |= static_cast<T>(ReadGeneric<uint8_t>(address + i)) << (8*i);
   }
   return value;
 }
 
 template<typename T>
 void Memory::WriteGeneric(uint64_t address, T value) {
+  if (address % sizeof(T) == 0) [[likely]] {
+    uint8_t *block = EnsureBlockExists(GetBlockIndex(address));
+    AtomicAt<T>(block, GetBlockOffset(address)).store(value, std::memory_order_release);
+    BumpReservation(address);
+    return;
+  }
   for (size_t i = 0; i < sizeof(T); ++i) {
-    Write(address + i, static_cast<uint8_t>(value >> (8*i)));
+    WriteGeneric<uint8_t>(address + i, static_cast<uint8_t>(value >> (8*i)));
   }
 }
 
-uint8_t Memory::ReadByte(uint64_t address) {
+uint8_t Memory::Read(uint64_t address) {
+  if (address >= memory_size_) {
+    throw std::out_of_range("Memory address out of range: " + std::to_string(address));
+  }
+  return ReadGeneric<uint8_t>(address);
+}
+
+void Memory::Write(uint64_t address, uint8_t value) {
   if (address >= memory_size_) {
     throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));
   }
+  WriteGeneric<uint8_t>(address, value);
+}
+
+uint8_t Memory::ReadByte(uint64_t address) {
   return Read(address);
 }
 
@@ -103,35 +461,14 @@ uint64_t Memory::ReadDoubleWord(uint64_t address) {
 }
 
 float Memory::ReadFloat(uint64_t address) {
-  if (address >= memory_size_ - (sizeof(float) - 1)) {
-    throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));;
-  }
-  uint32_t value = 0;
-  for (size_t i = 0; i < sizeof(float); ++i) {
-    value |= static_cast<uint32_t>(Read(address + i)) << (8*i);
-  }
-  float result;
-  std::memcpy(&result, &value, sizeof(float));
-  return result;
+  return std::bit_cast<float>(ReadWord(address));
 }
 
 double Memory::ReadDouble(uint64_t address) {
-  if (address >= memory_size_ - (sizeof(double) - 1)) {
-    throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));
-  }
-  uint64_t value = 0;
-  for (size_t i = 0; i < sizeof(double); ++i) {
-    value |= static_cast<uint64_t>(Read(address + i)) << (8*i);
-  }
-  double result;
-  std::memcpy(&result, &value, sizeof(double));
-  return result;
+  return std::bit_cast<double>(ReadDoubleWord(address));
 }
 
 void Memory::WriteByte(uint64_t address, uint8_t value) {
-  if (address >= memory_size_) {
-    throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));
-  }
   Write(address, value);
 }
 
@@ -157,24 +494,57 @@ void Memory::WriteDoubleWord(uint64_t address, uint64_t value) {
 }
 
 void Memory::WriteFloat(uint64_t address, float value) {
-  if (address >= memory_size_ - (sizeof(float) - 1)) {
+  WriteWord(address, std::bit_cast<uint32_t>(value));
+}
+
+void Memory::WriteDouble(uint64_t address, double value) {
+  WriteDoubleWord(address, std::bit_cast<uint64_t>(value));
+}
+
+void Memory::WriteBlock(uint64_t address, std::span<const uint8_t> data) {
+  if (data.empty()) {
+    return;
+  }
+  if (address >= memory_size_ || data.size() > memory_size_ - address) {
     throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));
   }
-  uint32_t value_bits;
-  std::memcpy(&value_bits, &value, sizeof(float));
-  for (size_t i = 0; i < sizeof(float); ++i) {
-    Write(address + i, static_cast<uint8_t>((value_bits >> (8*i)) & 0xFF));
+  size_t written = 0;
+  while (written < data.size()) {
+    uint64_t current_address = address + written;
+    uint64_t block_index = GetBlockIndex(current_address);
+    uint64_t offset = GetBlockOffset(current_address);
+    size_t chunk = std::min<size_t>(block_size_ - offset, data.size() - written);
+    std::memcpy(EnsureBlockExists(block_index) + offset, data.data() + written, chunk);
+    written += chunk;
+  }
+  if (track_reservations_) {
+    // Steps of 8 touch every 8-byte granule in the range at least once.
+    for (uint64_t offset = 0; offset < data.size(); offset += 8) {
+      BumpReservation(address + offset);
+    }
+    BumpReservation(address + data.size() - 1);
   }
 }
 
-void Memory::WriteDouble(uint64_t address, double value) {
-  if (address >= memory_size_ - (sizeof(double) - 1)) {
+void Memory::ReadBlock(uint64_t address, std::span<uint8_t> data) {
+  if (data.empty()) {
+    return;
+  }
+  if (address >= memory_size_ || data.size() > memory_size_ - address) {
     throw std::out_of_range(std::string("Memory address out of range: ") + std::to_string(address));
   }
-  uint64_t value_bits;
-  std::memcpy(&value_bits, &value, sizeof(double));
-  for (size_t i = 0; i < sizeof(double); ++i) {
-    Write(address + i, static_cast<uint8_t>((value_bits >> (8*i)) & 0xFF));
+  size_t read = 0;
+  while (read < data.size()) {
+    uint64_t current_address = address + read;
+    uint64_t block_index = GetBlockIndex(current_address);
+    uint64_t offset = GetBlockOffset(current_address);
+    size_t chunk = std::min<size_t>(block_size_ - offset, data.size() - read);
+    if (const uint8_t *block = FindBlock(block_index)) {
+      std::memcpy(data.data() + read, block + offset, chunk);
+    } else {
+      std::memset(data.data() + read, 0, chunk);
+    }
+    read += chunk;
   }
 }
 
@@ -202,10 +572,10 @@ void Memory::PrintMemory(const uint64_t address, unsigned int rows) {
   std::cout << "-----------------------------------------------------------------\n";
 }
 
-void Memory::DumpMemory(std::vector<std::string> args) {
-    std::ofstream file(globals::memory_dump_file_path);
+void Memory::DumpMemory(std::vector<std::string> args, const std::filesystem::path &filename) {
+    std::ofstream file(filename);
     if (!file.is_open()) {
-        throw std::runtime_error("Unable to open memory dump file: " + globals::memory_dump_file_path.string());
+        throw std::runtime_error("Unable to open memory dump file: " + filename.string());
     }
     file << "{\n";
 
@@ -272,9 +642,11 @@ void Memory::GetMemoryPoint(std::string addr_str) {
 void Memory::printMemoryUsage() const {
   std::cout << "Memory Usage Report:\n";
   std::cout << "---------------------\n";
-  std::cout << "Block Count: " << blocks_.size() << "\n";
-  for (const auto &[block_index, block] : blocks_) {
-    size_t used_bytes = std::count_if(block.data.begin(), block.data.end(),
+  std::cout << "Block Count: " << block_count_.load() << "\n";
+  std::vector<std::pair<uint64_t, const uint8_t *>> blocks;
+  CollectBlocks(root_, levels_ - 1, 0, blocks);
+  for (const auto &[block_index, block] : blocks) {
+    size_t used_bytes = std::count_if(block, block + block_size_,
                                       [](uint8_t byte) { return byte!=0; });
     if (used_bytes > 0) {
       std::cout << "Block " << block_index << ": " << used_bytes
@@ -0,0 +1,163 @@
+/**
+ * @file matrix_gemm.cpp
+ * @brief Contains the implementation of the matrix engine's format conversions and GEMM.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/matrix_gemm.h"
+#include "vm/alu.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace matrix {
+
+namespace {
+
+// Each pass updates every row of a 256-column strip of C (1 KB per row) from a 128 x 256 panel
+// of B (128 KB), so the panel stays in L2 while the rows of A and C stream through L1.
+constexpr uint64_t kBlockDepth = 128;
+constexpr uint64_t kBlockCols = 256;
+
+// c[j] += sum over p < depth of a[p]*b[p*ldb + j], for j < width.
+void RowKernelScalar(uint64_t depth, uint64_t width, const float *a, const float *b, uint64_t ldb, float *c) {
+  for (uint64_t p = 0; p < depth; ++p) {
+    const float *b_row = b + p*ldb;
+    for (uint64_t j = 0; j < width; ++j) {
+      c[j] = std::fma(a[p], b_row[j], c[j]);
+    }
+  }
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2,fma")))
+void RowKernelAvx2(uint64_t depth, uint64_t width, const float *a, const float *b, uint64_t ldb, float *c) {
+  uint64_t j = 0;
+  // 32 columns at a time, kept in registers across the whole panel.
+  for (; j + 32 <= width; j += 32) {
+    __m256 c0 = _mm256_loadu_ps(c + j);
+    __m256 c1 = _mm256_loadu_ps(c + j + 8);
+    __m256 c2 = _mm256_loadu_ps(c + j + 16);
+    __m256 c3 = _mm256_loadu_ps(c + j + 24);
+    for (uint64_t p = 0; p < depth; ++p) {
+      __m256 a_p = _mm256_broadcast_ss(a + p);
+      const float *b_row = b + p*ldb + j;
+      c0 = _mm256_fmadd_ps(a_p, _mm256_loadu_ps(b_row), c0);
+      c1 = _mm256_fmadd_ps(a_p, _mm256_loadu_ps(b_row + 8), c1);
+      c2 = _mm256_fmadd_ps(a_p, _mm256_loadu_ps(b_row + 16), c2);
+      c3 = _mm256_fmadd_ps(a_p, _mm256_loadu_ps(b_row + 24), c3);
+    }
+    _mm256_storeu_ps(c + j, c0);
+    _mm256_storeu_ps(c + j + 8, c1);
+    _mm256_storeu_ps(c + j + 16, c2);
+    _mm256_storeu_ps(c + j + 24, c3);
+  }
+  for (; j + 8 <= width; j += 8) {
+    __m256 c0 = _mm256_loadu_ps(c + j);
+    for (uint64_t p = 0; p < depth; ++p) {
+      c0 = _mm256_fmadd_ps(_mm256_broadcast_ss(a + p), _mm256_loadu_ps(b + p*ldb + j), c0);
+    }
+    _mm256_storeu_ps(c + j, c0);
+  }
+  for (; j < width; ++j) {
+    float sum = c[j];
+    for (uint64_t p = 0; p < depth; ++p) {
+      sum = std::fma(a[p], b[p*ldb + j], sum);
+    }
+    c[j] = sum;
+  }
+}
+#endif
+
+} // namespace
+
+bool IsValidFormat(uint64_t format) {
+  return format <= static_cast<uint64_t>(ElementFormat::kMsfp16);
+}
+
+uint64_t RowBytes(ElementFormat format, uint64_t n) {
+  switch (format) {
+    case ElementFormat::kFp32: return 4*n;
+    case ElementFormat::kFp16:
+    case ElementFormat::kBf16: return 2*n;
+    case ElementFormat::kMsfp16: return 8*((n + 3)/4);
+  }
+  return 0;
+}
+
+void DecodeRow(ElementFormat format, const uint8_t *src, uint64_t n, float *out) {
+  switch (format) {
+    case ElementFormat::kFp32:
+      std::memcpy(out, src, 4*n);
+      break;
+    case ElementFormat::kFp16:
+    case ElementFormat::kBf16:
+      for (uint64_t i = 0; i < n; ++i) {
+        uint16_t bits;
+        std::memcpy(&bits, src + 2*i, 2);
+        out[i] = format==ElementFormat::kFp16 ? alu::float16_to_float(bits) : alu::bfloat16_to_float(bits);
+      }
+      break;
+    case ElementFormat::kMsfp16:
+      for (uint64_t block = 0; 4*block < n; ++block) {
+        uint64_t bits;
+        std::memcpy(&bits, src + 8*block, 8);
+        std::array<float, 4> values = alu::msfp16_unpack(bits);
+        std::copy_n(values.begin(), std::min<uint64_t>(4, n - 4*block), out + 4*block);
+      }
+      break;
+  }
+}
+
+void EncodeRow(ElementFormat format, const float *src, uint64_t n, uint8_t *out) {
+  switch (format) {
+    case ElementFormat::kFp32:
+      std::memcpy(out, src, 4*n);
+      break;
+    case ElementFormat::kFp16:
+    case ElementFormat::kBf16:
+      for (uint64_t i = 0; i < n; ++i) {
+        uint16_t bits = format==ElementFormat::kFp16 ? alu::float_to_float16(src[i]) : alu::float_to_bfloat16(src[i]);
+        std::memcpy(out + 2*i, &bits, 2);
+      }
+      break;
+    case ElementFormat::kMsfp16:
+      for (uint64_t block = 0; 4*block < n; ++block) {
+        std::array<float, 4> values{};
+        std::copy_n(src + 4*block, std::min<uint64_t>(4, n - 4*block), values.begin());
+        uint64_t bits = alu::msfp16_pack(values);
+        std::memcpy(out + 8*block, &bits, 8);
+      }
+      break;
+  }
+}
+
+void Gemm(rvv::HostIsa isa, uint64_t m, uint64_t n, uint64_t k, const float *a, uint64_t lda,
+          const float *b, uint64_t ldb, float *c, uint64_t ldc) {
+  auto row_kernel = RowKernelScalar;
+#if defined(__x86_64__)
+  if (isa==rvv::HostIsa::kAvx2) {
+    row_kernel = RowKernelAvx2;
+  }
+#else
+  (void)isa;
+#endif
+  // Column blocks outermost and depth blocks next, so every element of C still sees p in order.
+  for (uint64_t jj = 0; jj < n; jj += kBlockCols) {
+    uint64_t width = std::min(kBlockCols, n - jj);
+    for (uint64_t pp = 0; pp < k; pp += kBlockDepth) {
+      uint64_t depth = std::min(kBlockDepth, k - pp);
+      for (uint64_t i = 0; i < m; ++i) {
+        row_kernel(depth, width, a + i*lda + pp, b + pp*ldb + jj, ldb, c + i*ldc + jj);
+      }
+    }
+  }
+}
+
+} // namespace matrix
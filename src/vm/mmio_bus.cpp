@@ -0,0 +1,72 @@
+/**
+ * @file mmio_bus.cpp
+ * @brief Contains the implementation of the MmioBus class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/mmio_bus.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+void MmioBus::Add(std::unique_ptr<MMIODevice> device) {
+  uint64_t base = device->baseAddress();
+  uint64_t size = device->size();
+  if (size == 0 || base + size - 1 < base) {
+    throw std::invalid_argument(std::string("Invalid MMIO range for device ") + device->name());
+  }
+  auto position = std::upper_bound(devices_.begin(), devices_.end(), base,
+                                   [](uint64_t address, const std::unique_ptr<MMIODevice> &d) {
+                                     return address < d->baseAddress();
+                                   });
+  bool overlaps_next = position != devices_.end() && (*position)->baseAddress() <= base + size - 1;
+  bool overlaps_previous = position != devices_.begin()
+      && base <= (*(position - 1))->baseAddress() + (*(position - 1))->size() - 1;
+  if (overlaps_next || overlaps_previous) {
+    throw std::invalid_argument(std::string("MMIO range of device ") + device->name() + " overlaps another device");
+  }
+
+  if (device->ticks()) {
+    ticking_.push_back(device.get());
+  }
+  devices_.insert(position, std::move(device));
+
+  const MMIODevice &last = *devices_.back();
+  window_start_ = devices_.front()->baseAddress();
+  window_size_ = last.baseAddress() + last.size() - window_start_;
+}
+
+void MmioBus::Clear() {
+  devices_.clear();
+  ticking_.clear();
+  window_start_ = 0;
+  window_size_ = 0;
+}
+
+MMIODevice *MmioBus::Find(uint64_t address) const {
+  auto position = std::upper_bound(devices_.begin(), devices_.end(), address,
+                                   [](uint64_t a, const std::unique_ptr<MMIODevice> &d) {
+                                     return a < d->baseAddress();
+                                   });
+  if (position == devices_.begin()) {
+    return nullptr;
+  }
+  MMIODevice *device = (position - 1)->get();
+  return address - device->baseAddress() < device->size() ? device : nullptr;
+}
+
+void MmioBus::Reset() {
+  for (const auto &device : devices_) {
+    device->reset();
+  }
+}
+
+MMIODevice *MmioBus::GetDevice(const std::string &name) const {
+  for (const auto &device : devices_) {
+    if (name == device->name()) {
+      return device.get();
+    }
+  }
+  return nullptr;
+}
@@ -0,0 +1,404 @@
+/**
+ * @file mmio_devices.cpp
+ * @brief Contains the implementation of the built-in UART, CLINT timer, DMA and matrix devices.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/mmio_devices.h"
+#include "vm/guest_io.h"
+#include "vm/memory_controller.h"
+#include "vm/matrix_gemm.h"
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+uint64_t SizeMask(unsigned int size) {
+  return size >= 8 ? UINT64_MAX : (uint64_t{1} << (8 * size)) - 1;
+}
+
+// Extracts an access of size bytes at byte offset within a 64-bit register.
+uint64_t ReadField(uint64_t reg, uint64_t byte, unsigned int size) {
+  return (reg >> (8 * byte)) & SizeMask(size);
+}
+
+// Replaces the bytes an access of size bytes at byte offset covers within a 64-bit register.
+uint64_t MergeField(uint64_t reg, uint64_t byte, uint64_t value, unsigned int size) {
+  uint64_t mask = SizeMask(size) << (8 * byte);
+  return (reg & ~mask) | ((value << (8 * byte)) & mask);
+}
+
+} // namespace
+
+uint64_t UartDevice::read(uint64_t offset, unsigned int size) {
+  (void)size;
+  bool dlab = (lcr_ & kLcrDlab) != 0;
+  switch (offset) {
+    case kRbrThr: {
+      if (dlab) {
+        return dll_;
+      }
+      if (!fillReceiver()) {
+        return 0;
+      }
+      uint8_t byte = rx_fifo_.front();
+      rx_fifo_.pop_front();
+      return byte;
+    }
+    case kIer: return dlab ? dlm_ : ier_;
+    case kIirFcr: return 0x01; // no interrupt pending
+    case kLcr: return lcr_;
+    case kMcr: return mcr_;
+    case kLsr: return kLsrTxEmpty | (fillReceiver() ? kLsrDataReady : 0);
+    case kScr: return scr_;
+    default: return 0;
+  }
+}
+
+void UartDevice::write(uint64_t offset, uint64_t value, unsigned int size) {
+  (void)size;
+  auto byte = static_cast<uint8_t>(value);
+  bool dlab = (lcr_ & kLcrDlab) != 0;
+  switch (offset) {
+    case kRbrThr:
+      if (dlab) {
+        dll_ = byte;
+      } else {
+        char c = static_cast<char>(byte);
+        io_.WriteConsole(1, std::string_view(&c, 1));
+      }
+      break;
+    case kIer:
+      if (dlab) {
+        dlm_ = byte;
+      } else {
+        ier_ = byte & 0x0F;
+      }
+      break;
+    case kIirFcr:
+      if (byte & 0x02) { // clear the receive FIFO
+        rx_fifo_.clear();
+      }
+      break;
+    case kLcr: lcr_ = byte; break;
+    case kMcr: mcr_ = byte & 0x1F; break;
+    case kScr: scr_ = byte; break;
+    default: break;
+  }
+}
+
+void UartDevice::reset() {
+  rx_fifo_.clear();
+  ier_ = 0;
+  lcr_ = 0;
+  mcr_ = 0;
+  scr_ = 0;
+  dll_ = 0;
+  dlm_ = 0;
+}
+
+void UartDevice::pushInput(std::string_view text) {
+  rx_fifo_.insert(rx_fifo_.end(), text.begin(), text.end());
+}
+
+bool UartDevice::fillReceiver() {
+  if (!rx_fifo_.empty()) {
+    return true;
+  }
+  if (io_.HasPreloadedStdin()) {
+    uint8_t byte = 0;
+    if (io_.Read(0, std::span<uint8_t>(&byte, 1)) == 1) {
+      rx_fifo_.push_back(byte);
+      return true;
+    }
+  }
+  return false;
+}
+
+uint64_t ClintDevice::read(uint64_t offset, unsigned int size) {
+  if (offset - kMsip < 4) {
+    return ReadField(msip_, offset - kMsip, size);
+  }
+  if (offset - kMtimecmp < 8) {
+    return ReadField(mtimecmp_, offset - kMtimecmp, size);
+  }
+  if (offset - kMtime < 8) {
+    return ReadField(mtime_, offset - kMtime, size);
+  }
+  return 0;
+}
+
+void ClintDevice::write(uint64_t offset, uint64_t value, unsigned int size) {
+  if (offset - kMsip < 4) {
+    msip_ = static_cast<uint32_t>(MergeField(msip_, offset - kMsip, value, size)) & 1;
+  } else if (offset - kMtimecmp < 8) {
+    mtimecmp_ = MergeField(mtimecmp_, offset - kMtimecmp, value, size);
+  } else if (offset - kMtime < 8) {
+    mtime_ = MergeField(mtime_, offset - kMtime, value, size);
+  }
+}
+
+void ClintDevice::reset() {
+  msip_ = 0;
+  mtimecmp_ = UINT64_MAX;
+  mtime_ = 0;
+}
+
+uint64_t DmaDevice::read(uint64_t offset, unsigned int size) {
+  uint64_t byte = offset % 8;
+  switch (offset - byte) {
+    case kSrc: return ReadField(src_, byte, size);
+    case kDst: return ReadField(dst_, byte, size);
+    case kLen: return ReadField(len_, byte, size);
+    case kStatus: return ReadField(status_, byte, size);
+    default: return 0;
+  }
+}
+
+void DmaDevice::write(uint64_t offset, uint64_t value, unsigned int size) {
+  uint64_t byte = offset % 8;
+  bool busy = (status_ & kStatusBusy) != 0;
+  switch (offset - byte) {
+    // The transfer registers are latched while a copy is in progress.
+    case kSrc:
+      if (!busy) {
+        src_ = MergeField(src_, byte, value, size);
+      }
+      break;
+    case kDst:
+      if (!busy) {
+        dst_ = MergeField(dst_, byte, value, size);
+      }
+      break;
+    case kLen:
+      if (!busy) {
+        len_ = MergeField(len_, byte, value, size);
+      }
+      break;
+    case kCtrl:
+      if (!busy && (MergeField(0, byte, value, size) & kCtrlStart)) {
+        copied_ = 0;
+        status_ = len_ == 0 ? kStatusDone : kStatusBusy;
+      }
+      break;
+    case kStatus:
+      status_ &= ~(MergeField(0, byte, value, size) & (kStatusDone | kStatusError));
+      break;
+    default: break;
+  }
+}
+
+void DmaDevice::tick(uint64_t cycles) {
+  if (!(status_ & kStatusBusy)) {
+    return;
+  }
+  uint64_t budget = std::min(bytes_per_cycle_ * cycles, len_ - copied_);
+  std::array<uint8_t, 4096> buffer;
+  try {
+    while (budget > 0) {
+      size_t count = std::min<uint64_t>(budget, buffer.size());
+      std::span<uint8_t> chunk(buffer.data(), count);
+      memory_.ReadBlock(src_ + copied_, chunk);
+      memory_.WriteBlock(dst_ + copied_, chunk);
+      copied_ += count;
+      budget -= count;
+    }
+  } catch (const std::out_of_range &) {
+    status_ = kStatusError;
+    return;
+  }
+  if (copied_ == len_) {
+    status_ = kStatusDone;
+  }
+}
+
+void DmaDevice::reset() {
+  src_ = 0;
+  dst_ = 0;
+  len_ = 0;
+  status_ = 0;
+  copied_ = 0;
+}
+
+MatrixEngineDevice::MatrixEngineDevice(uint64_t base, MemoryController &memory, uint64_t macs_per_cycle,
+                                       uint64_t bytes_per_cycle)
+    : base_(base), memory_(memory), macs_per_cycle_(macs_per_cycle == 0 ? 1 : macs_per_cycle),
+      bytes_per_cycle_(bytes_per_cycle == 0 ? 1 : bytes_per_cycle) {}
+
+uint64_t MatrixEngineDevice::read(uint64_t offset, unsigned int size) {
+  uint64_t byte = offset % 8;
+  switch (offset - byte) {
+    case kA: return ReadField(a_, byte, size);
+    case kB: return ReadField(b_, byte, size);
+    case kC: return ReadField(c_, byte, size);
+    case kM: return ReadField(m_, byte, size);
+    case kN: return ReadField(n_, byte, size);
+    case kK: return ReadField(k_, byte, size);
+    case kLda: return ReadField(lda_, byte, size);
+    case kLdb: return ReadField(ldb_, byte, size);
+    case kLdc: return ReadField(ldc_, byte, size);
+    case kFormat: return ReadField(format_, byte, size);
+    case kStatus: return ReadField(status_, byte, size);
+    case kCycles: return ReadField(cycles_, byte, size);
+    case kTotalCycles: return ReadField(total_cycles_, byte, size);
+    case kTotalMacs: return ReadField(total_macs_, byte, size);
+    default: return 0;
+  }
+}
+
+void MatrixEngineDevice::write(uint64_t offset, uint64_t value, unsigned int size) {
+  uint64_t byte = offset % 8;
+  uint64_t reg = offset - byte;
+  if (reg == kStatus) {
+    status_ &= ~(MergeField(0, byte, value, size) & (kStatusDone | kStatusError));
+    return;
+  }
+  // Like the DMA engine, the operation registers are latched while busy.
+  if (status_ & kStatusBusy) {
+    return;
+  }
+  switch (reg) {
+    case kA: a_ = MergeField(a_, byte, value, size); break;
+    case kB: b_ = MergeField(b_, byte, value, size); break;
+    case kC: c_ = MergeField(c_, byte, value, size); break;
+    case kM: m_ = MergeField(m_, byte, value, size); break;
+    case kN: n_ = MergeField(n_, byte, value, size); break;
+    case kK: k_ = MergeField(k_, byte, value, size); break;
+    case kLda: lda_ = MergeField(lda_, byte, value, size); break;
+    case kLdb: ldb_ = MergeField(ldb_, byte, value, size); break;
+    case kLdc: ldc_ = MergeField(ldc_, byte, value, size); break;
+    case kFormat: format_ = MergeField(format_, byte, value, size); break;
+    case kCtrl: {
+      uint64_t ctrl = MergeField(0, byte, value, size);
+      if (ctrl & kCtrlStart) {
+        start((ctrl & kCtrlAccumulate) != 0);
+      }
+      break;
+    }
+    default: break;
+  }
+}
+
+void MatrixEngineDevice::start(bool accumulate) {
+  using matrix::ElementFormat;
+  status_ = kStatusError;
+  uint64_t in_field = format_ & 0xF;
+  uint64_t out_field = (format_ >> 4) & 0xF;
+  if (!matrix::IsValidFormat(in_field) || !matrix::IsValidFormat(out_field)) {
+    return;
+  }
+  auto in = static_cast<ElementFormat>(in_field);
+  auto out = static_cast<ElementFormat>(out_field);
+  uint64_t lda = lda_ == 0 ? k_ : lda_;
+  uint64_t ldb = ldb_ == 0 ? n_ : ldb_;
+  uint64_t ldc = ldc_ == 0 ? n_ : ldc_;
+  if (lda < k_ || ldb < n_ || ldc < n_) {
+    return;
+  }
+  // Bounding every dimension first keeps the products below from overflowing.
+  for (uint64_t dimension : {m_, n_, k_, lda, ldb, ldc}) {
+    if (dimension > kMaxElements) {
+      return;
+    }
+  }
+  if (m_*lda > kMaxElements || k_*ldb > kMaxElements || m_*ldc > kMaxElements) {
+    return;
+  }
+  if ((in == ElementFormat::kMsfp16 && (lda % 4 != 0 || ldb % 4 != 0))
+      || (out == ElementFormat::kMsfp16 && ldc % 4 != 0)) {
+    return;
+  }
+
+  std::vector<float> a(m_*k_);
+  std::vector<float> b(k_*n_);
+  result_.assign(m_*n_, 0.0f);
+  std::vector<uint8_t> row;
+  try {
+    for (uint64_t i = 0; i < m_; ++i) {
+      row.resize(matrix::RowBytes(in, k_));
+      memory_.ReadBlock(a_ + i*matrix::RowBytes(in, lda), row);
+      matrix::DecodeRow(in, row.data(), k_, a.data() + i*k_);
+    }
+    for (uint64_t p = 0; p < k_; ++p) {
+      row.resize(matrix::RowBytes(in, n_));
+      memory_.ReadBlock(b_ + p*matrix::RowBytes(in, ldb), row);
+      matrix::DecodeRow(in, row.data(), n_, b.data() + p*n_);
+    }
+    if (accumulate) {
+      for (uint64_t i = 0; i < m_; ++i) {
+        row.resize(matrix::RowBytes(out, n_));
+        memory_.ReadBlock(c_ + i*matrix::RowBytes(out, ldc), row);
+        matrix::DecodeRow(out, row.data(), n_, result_.data() + i*n_);
+      }
+    }
+  } catch (const std::out_of_range &) {
+    result_.clear();
+    return;
+  }
+  static const rvv::HostIsa kHostIsa = rvv::DetectHostIsa();
+  matrix::Gemm(kHostIsa, m_, n_, k_, a.data(), k_, b.data(), n_, result_.data(), n_);
+
+  uint64_t macs = m_*n_*k_;
+  uint64_t bytes = m_*matrix::RowBytes(in, k_) + k_*matrix::RowBytes(in, n_)
+      + (accumulate ? 2 : 1)*m_*matrix::RowBytes(out, n_);
+  cycles_ = kSetupCycles + (macs + macs_per_cycle_ - 1)/macs_per_cycle_ + (bytes + bytes_per_cycle_ - 1)/bytes_per_cycle_;
+  remaining_ = cycles_;
+  total_cycles_ += cycles_;
+  total_macs_ += macs;
+  operations_++;
+  status_ = kStatusBusy;
+}
+
+void MatrixEngineDevice::tick(uint64_t cycles) {
+  if (!(status_ & kStatusBusy)) {
+    return;
+  }
+  if (cycles < remaining_) {
+    remaining_ -= cycles;
+    return;
+  }
+  remaining_ = 0;
+  writeResult();
+}
+
+void MatrixEngineDevice::writeResult() {
+  auto out = static_cast<matrix::ElementFormat>((format_ >> 4) & 0xF);
+  uint64_t ldc = ldc_ == 0 ? n_ : ldc_;
+  std::vector<uint8_t> row(matrix::RowBytes(out, n_));
+  try {
+    for (uint64_t i = 0; i < m_; ++i) {
+      matrix::EncodeRow(out, result_.data() + i*n_, n_, row.data());
+      memory_.WriteBlock(c_ + i*matrix::RowBytes(out, ldc), row);
+    }
+  } catch (const std::out_of_range &) {
+    status_ = kStatusError;
+    result_.clear();
+    return;
+  }
+  status_ = kStatusDone;
+  result_.clear();
+}
+
+void MatrixEngineDevice::reset() {
+  a_ = 0;
+  b_ = 0;
+  c_ = 0;
+  m_ = 0;
+  n_ = 0;
+  k_ = 0;
+  lda_ = 0;
+  ldb_ = 0;
+  ldc_ = 0;
+  format_ = 0;
+  status_ = 0;
+  cycles_ = 0;
+  total_cycles_ = 0;
+  total_macs_ = 0;
+  operations_ = 0;
+  remaining_ = 0;
+  result_.clear();
+}
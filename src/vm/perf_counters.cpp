@@ -0,0 +1,80 @@
+/**
+ * @file perf_counters.cpp
+ * @brief Contains the implementation of the PerfCounters struct.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/perf_counters.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+const char *InstructionClassName(InstructionClass instruction_class) {
+  switch (instruction_class) {
+    case InstructionClass::kAlu: return "alu";
+    case InstructionClass::kLoad: return "load";
+    case InstructionClass::kStore: return "store";
+    case InstructionClass::kBranchTaken: return "branch_taken";
+    case InstructionClass::kBranchNotTaken: return "branch_not_taken";
+    case InstructionClass::kJump: return "jump";
+    case InstructionClass::kFloat: return "float";
+    case InstructionClass::kSimd: return "simd";
+    case InstructionClass::kEcc: return "ecc";
+    case InstructionClass::kQuantum: return "quantum";
+    case InstructionClass::kCsr: return "csr";
+    case InstructionClass::kSyscall: return "syscall";
+    case InstructionClass::kAtomic: return "atomic";
+    case InstructionClass::kVector: return "vector";
+    default: return "unknown";
+  }
+}
+
+InstructionClass ClassifyAluOp(alu::AluOp op) {
+  if (op >= alu::AluOp::kAdd_simd32 && op <= alu::AluOp::kRem_simdb) {
+    return InstructionClass::kSimd;
+  }
+  if (op >= alu::AluOp::kEcc_check && op <= alu::AluOp::kEcc_div) {
+    return InstructionClass::kEcc;
+  }
+  if (op >= alu::AluOp::kQAlloc_A && op <= alu::AluOp::kQNormB) {
+    return InstructionClass::kQuantum;
+  }
+  return InstructionClass::kAlu;
+}
+
+void PerfCounters::DumpJson(const std::filesystem::path &filename, uint64_t cycles, uint64_t instret) const {
+  std::ofstream file(filename);
+  if (!file.is_open()) {
+    throw std::runtime_error("Unable to open perf counter dump file: " + filename.string());
+  }
+
+  file << "{\n";
+  file << "    \"cycle\": " << cycles << ",\n";
+  file << "    \"instret\": " << instret << ",\n";
+
+  file << "    \"instruction_classes\": {\n";
+  for (size_t i = 0; i < kInstructionClassCount; ++i) {
+    file << "        \"" << InstructionClassName(static_cast<InstructionClass>(i)) << "\": " << classes[i]
+         << (i + 1 < kInstructionClassCount ? ",\n" : "\n");
+  }
+  file << "    },\n";
+
+  file << "    \"alu_ops\": {";
+  bool first = true;
+  for (size_t i = 0; i < kAluOpCount; ++i) {
+    if (alu_ops[i] == 0) {
+      continue;
+    }
+    std::ostringstream name;
+    name << static_cast<alu::AluOp>(i);
+    if (name.str() == "UNKNOWN") {
+      name.str("");
+      name << "op_" << i;
+    }
+    file << (first ? "\n" : ",\n") << "        \"" << name.str() << "\": " << alu_ops[i];
+    first = false;
+  }
+  file << (first ? "}\n" : "\n    }\n");
+  file << "}\n";
+}
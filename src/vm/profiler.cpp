@@ -0,0 +1,259 @@
+/**
+ * @file profiler.cpp
+ * @brief Contains the implementation of the Profiler class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/profiler.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <numeric>
+#include <sstream>
+
+namespace {
+
+/**
+ * @brief Code labels sorted by address, used to name addresses.
+ */
+std::vector<std::pair<uint64_t, std::string>> CodeLabels(const AssembledProgram &program) {
+  std::vector<std::pair<uint64_t, std::string>> labels;
+  for (const auto &[name, symbol] : program.symbol_table) {
+    if (!symbol.isData) {
+      labels.emplace_back(symbol.address, name);
+    }
+  }
+  std::sort(labels.begin(), labels.end());
+  return labels;
+}
+
+std::string NameAddress(const std::vector<std::pair<uint64_t, std::string>> &labels, uint64_t address) {
+  auto it = std::upper_bound(labels.begin(), labels.end(), address,
+                             [](uint64_t value, const auto &label) { return value < label.first; });
+  std::ostringstream os;
+  if (it == labels.begin()) {
+    os << "0x" << std::hex << address;
+  } else {
+    --it;
+    os << it->second;
+    if (it->first != address) {
+      os << "+0x" << std::hex << (address - it->first);
+    }
+  }
+  return os.str();
+}
+
+bool IsLinkRegister(uint32_t reg) {
+  return reg == 1 || reg == 5;
+}
+
+} // namespace
+
+void Profiler::Start(uint64_t text_start, uint64_t text_end, uint64_t entry) {
+  enabled_ = true;
+  text_start_ = text_start;
+  pc_counts_.assign(text_end > text_start ? (text_end - text_start + 3)/4 : 0, 0);
+  call_nodes_.assign(1, CallNode{entry, 0});
+  current_node_ = 0;
+  depth_ = 0;
+  untracked_depth_ = 0;
+}
+
+void Profiler::Reset() {
+  enabled_ = false;
+  text_start_ = 0;
+  pc_counts_.clear();
+  pc_counts_.shrink_to_fit();
+  call_nodes_.assign(1, CallNode{0, 0});
+  current_node_ = 0;
+  depth_ = 0;
+  untracked_depth_ = 0;
+}
+
+void Profiler::TrackCallOrReturn(uint32_t instruction, uint64_t next_pc) {
+  uint32_t rd = (instruction >> 7) & 0b11111;
+  uint32_t rs1 = (instruction >> 15) & 0b11111;
+  bool is_jalr = (instruction & 0x7f) == kJalrOpcode;
+
+  // Return-address-stack hints from the RISC-V spec: a jump that writes ra/t0 is a call, a JALR
+  // through ra/t0 that does not link is a return, and one that links through the other
+  // register is a coroutine swap (return, then call).
+  if (IsLinkRegister(rd)) {
+    if (is_jalr && IsLinkRegister(rs1) && rs1 != rd) {
+      PopCall();
+    }
+    PushCall(next_pc);
+  } else if (is_jalr && IsLinkRegister(rs1)) {
+    PopCall();
+  }
+}
+
+void Profiler::PushCall(uint64_t target) {
+  if (depth_ >= kMaxCallDepth) {
+    ++untracked_depth_;
+    return;
+  }
+  auto [it, inserted] = call_nodes_[current_node_].children.try_emplace(target, static_cast<uint32_t>(call_nodes_.size()));
+  if (inserted) {
+    call_nodes_.push_back(CallNode{target, current_node_});
+  }
+  current_node_ = it->second;
+  ++depth_;
+}
+
+void Profiler::PopCall() {
+  if (untracked_depth_ > 0) {
+    --untracked_depth_;
+  } else if (depth_ > 0) {
+    current_node_ = call_nodes_[current_node_].parent;
+    --depth_;
+  }
+}
+
+uint64_t Profiler::GetCount(uint64_t pc) const {
+  uint64_t index = (pc - text_start_) >> 2;
+  return index < pc_counts_.size() ? pc_counts_[index] : 0;
+}
+
+uint64_t Profiler::GetTotal() const {
+  return std::accumulate(pc_counts_.begin(), pc_counts_.end(), uint64_t{0});
+}
+
+std::vector<Profiler::HotSpot> Profiler::GetHotSpots(const AssembledProgram &program, size_t top_n) const {
+  std::vector<HotSpot> spots;
+  if (program.instruction_number_line_number_mapping.empty()) {
+    for (size_t i = 0; i < pc_counts_.size(); ++i) {
+      if (pc_counts_[i] != 0) {
+        spots.push_back({text_start_ + i*4, 0, pc_counts_[i]});
+      }
+    }
+  } else {
+    // Pseudo-instructions expand to several instructions on one line.
+    std::map<unsigned int, HotSpot> by_line;
+    for (size_t i = 0; i < pc_counts_.size(); ++i) {
+      auto line = program.instruction_number_line_number_mapping.find(static_cast<unsigned int>(i));
+      if (pc_counts_[i] == 0 || line == program.instruction_number_line_number_mapping.end()) {
+        continue;
+      }
+      auto [it, inserted] = by_line.try_emplace(line->second, HotSpot{text_start_ + i*4, line->second, 0});
+      it->second.count += pc_counts_[i];
+    }
+    for (const auto &[line, spot] : by_line) {
+      spots.push_back(spot);
+    }
+  }
+
+  std::stable_sort(spots.begin(), spots.end(), [](const HotSpot &a, const HotSpot &b) {
+    return a.count > b.count;
+  });
+  if (spots.size() > top_n) {
+    spots.resize(top_n);
+  }
+  return spots;
+}
+
+std::vector<Profiler::FunctionCount> Profiler::GetFunctionCounts(const AssembledProgram &program) const {
+  // Children are always created after their parent, so one backwards pass sums the subtrees.
+  std::vector<uint64_t> node_inclusive(call_nodes_.size());
+  for (size_t i = call_nodes_.size(); i-- > 0;) {
+    node_inclusive[i] += call_nodes_[i].self_count;
+    if (i != 0) {
+      node_inclusive[call_nodes_[i].parent] += node_inclusive[i];
+    }
+  }
+  // Only the outermost frame of a recursive function counts, so recursion is not double counted.
+  std::unordered_map<uint64_t, uint64_t> inclusive_by_function;
+  for (size_t i = 0; i < call_nodes_.size(); ++i) {
+    bool outermost = true;
+    for (size_t ancestor = i; ancestor != 0 && outermost;) {
+      ancestor = call_nodes_[ancestor].parent;
+      outermost = call_nodes_[ancestor].function != call_nodes_[i].function;
+    }
+    if (outermost) {
+      inclusive_by_function[call_nodes_[i].function] += node_inclusive[i];
+    }
+  }
+
+  uint64_t text_end = text_start_ + pc_counts_.size()*4;
+  std::vector<std::pair<uint64_t, std::string>> labels = CodeLabels(program);
+  std::vector<FunctionCount> functions;
+  for (size_t i = 0; i < labels.size(); ++i) {
+    const auto &[address, name] = labels[i];
+    if (address < text_start_ || address >= text_end) {
+      continue;
+    }
+    uint64_t end = i + 1 < labels.size() ? std::min(labels[i + 1].first, text_end) : text_end;
+    uint64_t exclusive = 0;
+    for (uint64_t pc = address; pc < end; pc += 4) {
+      exclusive += GetCount(pc);
+    }
+    auto inclusive = inclusive_by_function.find(address);
+    bool called = inclusive != inclusive_by_function.end();
+    functions.push_back({name, address, exclusive, called ? inclusive->second : 0, called});
+  }
+  return functions;
+}
+
+void Profiler::WriteFoldedStacks(std::ostream &os, const AssembledProgram &program) const {
+  std::vector<std::pair<uint64_t, std::string>> labels = CodeLabels(program);
+  std::vector<std::string> stacks(call_nodes_.size());
+  for (size_t i = 0; i < call_nodes_.size(); ++i) {
+    std::string name = NameAddress(labels, call_nodes_[i].function);
+    stacks[i] = i == 0 ? name : stacks[call_nodes_[i].parent] + ";" + name;
+    if (call_nodes_[i].self_count != 0) {
+      os << stacks[i] << " " << call_nodes_[i].self_count << "\n";
+    }
+  }
+}
+
+void Profiler::WriteReport(std::ostream &os, const AssembledProgram &program, size_t top_n) const {
+  uint64_t total = GetTotal();
+  auto percent = [total](uint64_t count) {
+    return total == 0 ? 0.0 : 100.0*static_cast<double>(count)/static_cast<double>(total);
+  };
+
+  std::vector<std::string> source;
+  std::ifstream file(program.filename);
+  for (std::string line; file.is_open() && std::getline(file, line);) {
+    source.push_back(line);
+  }
+
+  os << "Profile: " << program.filename << "\n";
+  os << "Instructions retired: " << total << "\n\n";
+
+  std::vector<std::pair<uint64_t, std::string>> labels = CodeLabels(program);
+  os << "Hot spots (top " << top_n << "):\n";
+  os << std::setw(8) << "line" << std::setw(14) << "count" << std::setw(9) << "%" << "  location\n";
+  for (const HotSpot &spot : GetHotSpots(program, top_n)) {
+    os << std::setw(8) << (spot.line == 0 ? "-" : std::to_string(spot.line))
+       << std::setw(14) << spot.count
+       << std::setw(8) << std::fixed << std::setprecision(2) << percent(spot.count) << "%  ";
+    if (spot.line != 0 && spot.line <= source.size()) {
+      std::string text = source[spot.line - 1];
+      text.erase(0, text.find_first_not_of(" \t"));
+      os << text;
+    } else {
+      os << NameAddress(labels, spot.pc);
+    }
+    os << "\n";
+  }
+
+  os << "\nFunctions:\n";
+  os << std::left << std::setw(24) << "label" << std::right
+     << std::setw(14) << "exclusive" << std::setw(9) << "%"
+     << std::setw(14) << "inclusive" << std::setw(9) << "%" << "\n";
+  for (const FunctionCount &function : GetFunctionCounts(program)) {
+    os << std::left << std::setw(24) << function.name << std::right
+       << std::setw(14) << function.exclusive
+       << std::setw(8) << std::fixed << std::setprecision(2) << percent(function.exclusive) << "%";
+    if (function.called) {
+      os << std::setw(14) << function.inclusive
+         << std::setw(8) << percent(function.inclusive) << "%";
+    } else {
+      os << std::setw(14) << "-" << std::setw(9) << "-";
+    }
+    os << "\n";
+  }
+}
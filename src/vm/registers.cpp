@@ -11,14 +11,38 @@
 #include <unordered_map>
 #include <vector>
 #include <array>
+#include <cstring>
 
-RegisterFile::RegisterFile() = default;
+RegisterFile::RegisterFile() {
+  SetVectorLength(128);
+}
 
 void RegisterFile::Reset() {
   gpr_.fill(0);
   fpr_.fill(0.0);
   csr_.fill(0);
   csr_[0x002] = 0b000; // Default: RNE (IEEE 754)
+  SetVectorLength(GetVlenb()*8);
+}
+
+void RegisterFile::SetVectorLength(size_t vlen_bits) {
+  vr_.assign(NUM_VR*vlen_bits/8, 0);
+  csr_[kCsrVlenb] = vlen_bits/8;
+  csr_[kCsrVtype] = 1ULL << 63; // vill
+  csr_[kCsrVl] = 0;
+  csr_[kCsrVstart] = 0;
+}
+
+uint64_t RegisterFile::ReadVectorSlice(size_t slice) const {
+  if (slice >= vr_.size()/8) throw std::out_of_range("Invalid vector register slice");
+  uint64_t value;
+  std::memcpy(&value, vr_.data() + 8*slice, sizeof(value));
+  return value;
+}
+
+void RegisterFile::WriteVectorSlice(size_t slice, uint64_t value) {
+  if (slice >= vr_.size()/8) throw std::out_of_range("Invalid vector register slice");
+  std::memcpy(vr_.data() + 8*slice, &value, sizeof(value));
 }
 
 uint64_t RegisterFile::ReadGpr(size_t reg) const {
@@ -104,15 +128,41 @@ const std::unordered_set<std::string> valid_floating_point_registers = {
     "ft28", "ft29", "ft30", "ft31",
 };
 
-const std::unordered_set<std::string> valid_csr_registers = {
-    "fflags", "frm", "fcsr"
+const std::unordered_set<std::string> valid_vector_registers = {
+    "v0", "v1", "v2", "v3", "v4", "v5", "v6", "v7", "v8", "v9",
+    "v10", "v11", "v12", "v13", "v14", "v15", "v16", "v17", "v18", "v19",
+    "v20", "v21", "v22", "v23", "v24", "v25", "v26", "v27", "v28", "v29",
+    "v30", "v31",
 };
 
-const std::unordered_map<std::string, int> csr_to_address{
-    {"fflags", 0x001},
-    {"frm", 0x002},
-    {"fcsr", 0x003},
-};
+// Unprivileged counters: cycle, time and instret at 0xC00-0xC02, then hpmcounter3..31.
+const std::unordered_map<std::string, int> csr_to_address = []() {
+  std::unordered_map<std::string, int> csrs{
+      {"fflags", 0x001},
+      {"frm", 0x002},
+      {"fcsr", 0x003},
+      {"cycle", 0xC00},
+      {"time", 0xC01},
+      {"instret", 0xC02},
+      {"mhartid", 0xF14},
+      {"vstart", 0x008},
+      {"vl", 0xC20},
+      {"vtype", 0xC21},
+      {"vlenb", 0xC22},
+  };
+  for (int counter = 3; counter <= 31; ++counter) {
+    csrs["hpmcounter" + std::to_string(counter)] = 0xC00 + counter;
+  }
+  return csrs;
+}();
+
+const std::unordered_set<std::string> valid_csr_registers = []() {
+  std::unordered_set<std::string> names;
+  for (const auto &[name, address] : csr_to_address) {
+    names.insert(name);
+  }
+  return names;
+}();
 
 const std::unordered_map<std::string, std::string> reg_alias_to_name = {
     {"zero", "x0"},
@@ -262,6 +312,10 @@ bool IsValidFloatingPointRegister(const std::string &reg) {
   return valid_floating_point_registers.find(reg)!=valid_floating_point_registers.end();
 }
 
+bool IsValidVectorRegister(const std::string &reg) {
+  return valid_vector_registers.find(reg)!=valid_vector_registers.end();
+}
+
 bool IsValidCsr(const std::string &reg) {
   return valid_csr_registers.find(reg)!=valid_csr_registers.end();
 }
\ No newline at end of file
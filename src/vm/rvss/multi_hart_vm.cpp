@@ -0,0 +1,186 @@
+/**
+ * @file multi_hart_vm.cpp
+ * @brief Contains the implementation of the MultiHartVm class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/rvss/multi_hart_vm.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+uint64_t MultiHartVm::Stats::TotalInstructions() const {
+  return std::accumulate(instructions.begin(), instructions.end(), uint64_t{0});
+}
+
+MultiHartVm::MultiHartVm(VmContext context) : context_(std::move(context)) {
+  // The harts only step through RunQuantum, which records neither a profile nor a trace.
+  context_.config.setTraceFile("");
+  context_.config.setProfilingEnabled(false);
+  auto count = static_cast<unsigned int>(context_.config.getHartCount());
+  harts_.reserve(count);
+  for (unsigned int id = 0; id < count; ++id) {
+    VmContext hart_context = context_;
+    if (id != 0) {
+      // The devices are not thread-safe, so only hart 0 maps them; the others see RAM there.
+      hart_context.dump_state = false;
+      hart_context.config.setMmioEnabled(false);
+    }
+    harts_.push_back(std::make_unique<RVSSVM>(std::move(hart_context)));
+    if (id != 0) {
+      harts_[id]->memory_controller_.ShareMemory(harts_[0]->memory_controller_.GetSharedMemory());
+    }
+  }
+}
+
+void MultiHartVm::LoadProgram(const AssembledProgram &program) {
+  for (auto &hart : harts_) {
+    hart->LoadProgram(program);
+  }
+  PrepareHarts();
+}
+
+void MultiHartVm::LoadElfProgram(const std::string &filename) {
+  for (auto &hart : harts_) {
+    hart->LoadElfProgram(filename);
+  }
+  PrepareHarts();
+}
+
+void MultiHartVm::PrepareHarts() {
+  uint64_t stack_top = context_.config.getStackTop();
+  uint64_t stack_size = context_.config.getHartStackSize();
+  for (unsigned int id = 0; id < GetHartCount(); ++id) {
+    harts_[id]->SetHartId(id);
+    harts_[id]->registers_.WriteGpr(2, stack_top - id*stack_size);
+  }
+}
+
+void MultiHartVm::Run() {
+  unsigned int count = GetHartCount();
+  stop_requested_ = false;
+  error_.clear();
+  finished_.assign(count, 0);
+  turn_ = 0;
+  stats_.instructions.assign(count, 0);
+  instruction_limit_ = context_.config.getInstructionExecutionLimit();
+  if (instruction_limit_ == 0) {
+    instruction_limit_ = UINT64_MAX;
+  }
+  // Stores only need to break other harts' LR reservations when there are other harts.
+  harts_[0]->memory_controller_.GetSharedMemory()->SetReservationTracking(count > 1);
+
+  bool quantum = context_.config.getHartSyncMode() == vm_config::HartSyncMode::QUANTUM;
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  threads.reserve(count);
+  for (unsigned int id = 0; id < count; ++id) {
+    threads.emplace_back([this, id, quantum]() {
+      if (quantum) {
+        RunQuantumTurns(id);
+      } else {
+        RunFree(id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  stats_.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  for (auto &hart : harts_) {
+    hart->guest_io_.Flush();
+  }
+  if (!error_.empty()) {
+    throw std::runtime_error(error_);
+  }
+  if (std::all_of(harts_.begin(), harts_.end(), [](const auto &hart) { return hart->IsHalted(); })) {
+    std::cout << "VM_PROGRAM_END" << std::endl;
+    harts_[0]->output_status_ = "VM_PROGRAM_END";
+  }
+  harts_[0]->DumpRegistersAndState();
+}
+
+bool MultiHartVm::RunSlice(unsigned int hart_id) {
+  RVSSVM &hart = *harts_[hart_id];
+  uint64_t &executed = stats_.instructions[hart_id];
+  try {
+    if (!stop_requested_.load(std::memory_order_relaxed)) {
+      executed += hart.RunQuantum(std::min(context_.config.getHartQuantum(), instruction_limit_ - executed));
+    }
+  } catch (const std::exception &e) {
+    RecordError(hart_id, e);
+  }
+  return stop_requested_.load(std::memory_order_relaxed) || hart.IsHalted() || executed >= instruction_limit_;
+}
+
+void MultiHartVm::RunQuantumTurns(unsigned int hart_id) {
+  unsigned int count = GetHartCount();
+  while (true) {
+    for (unsigned int turn = turn_.load(std::memory_order_acquire); turn != hart_id;
+         turn = turn_.load(std::memory_order_acquire)) {
+      if (turn == count) {
+        return;
+      }
+      turn_.wait(turn, std::memory_order_acquire);
+    }
+
+    bool finished = RunSlice(hart_id);
+    finished_[hart_id] = finished;
+    // Hand the turn to the next hart still running, or to no one once every hart is done.
+    unsigned int next = count;
+    for (unsigned int step = 1; step <= count; ++step) {
+      unsigned int candidate = (hart_id + step) % count;
+      if (!finished_[candidate]) {
+        next = candidate;
+        break;
+      }
+    }
+    if (next != hart_id) {
+      turn_.store(next, std::memory_order_release);
+      turn_.notify_all();
+    }
+    if (finished) {
+      return;
+    }
+  }
+}
+
+void MultiHartVm::RunFree(unsigned int hart_id) {
+  while (!RunSlice(hart_id)) {
+  }
+}
+
+void MultiHartVm::RecordError(unsigned int hart_id, const std::exception &e) {
+  {
+    std::lock_guard<std::mutex> lock(error_mutex_);
+    if (error_.empty()) {
+      error_ = "Hart " + std::to_string(hart_id) + ": " + e.what();
+    }
+  }
+  stop_requested_ = true;
+}
+
+void MultiHartVm::WriteSummary(std::ostream &os) const {
+  bool quantum = context_.config.getHartSyncMode() == vm_config::HartSyncMode::QUANTUM;
+  os << "Harts: " << GetHartCount() << " (" << (quantum ? "quantum" : "free_running")
+     << ", " << context_.config.getHartQuantum() << " instructions per quantum)\n";
+  for (unsigned int id = 0; id < GetHartCount(); ++id) {
+    const RVSSVM &hart = *harts_[id];
+    uint64_t executed = id < stats_.instructions.size() ? stats_.instructions[id] : 0;
+    os << "  hart " << id << ": " << executed << " instructions";
+    if (hart.exited_) {
+      os << ", exit code " << static_cast<int64_t>(hart.exit_code_);
+    }
+    os << "\n";
+  }
+  uint64_t total = stats_.TotalInstructions();
+  double mips = stats_.seconds > 0 ? static_cast<double>(total) / stats_.seconds / 1e6 : 0.0;
+  os << std::fixed << std::setprecision(3)
+     << "Total: " << total << " instructions in " << stats_.seconds << " s ("
+     << std::setprecision(2) << mips << " MIPS)\n";
+}
@@ -127,6 +127,19 @@ void RVSSControlUnit::SetControlSignals(uint32_t instruction) {
       break;
     }
 
+    case 0b1010111: { // V extension: only vsetvl{i} writes a GPR; the vector unit handles the rest
+      reg_write_ = ((instruction >> 12) & 0b111) == 0b111;
+      break;
+    }
+
+    case 0b0101111: { // A extension: LR reads, SC writes, AMOs do both
+      uint8_t funct5 = (instruction >> 27) & 0b11111;
+      reg_write_ = true;
+      mem_read_ = funct5 != 0b00011;
+      mem_write_ = funct5 != 0b00010;
+      break;
+    }
+
 
 
 
@@ -7,11 +7,16 @@
 #include "vm/rvss/rvss_vm.h"
 
 #include "utils.h"
-#include "globals.h"
 #include "common/instructions.h"
 #include "config.h"
 
+#include <array>
 #include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <limits>
+#include <sstream>
 #include <cstdint>
 #include <iostream>
 #include <tuple>
@@ -26,10 +31,42 @@
 using instruction_set::Instruction;
 using instruction_set::get_instr_encoding;
 
+namespace {
 
-RVSSVM::RVSSVM() : VmBase() {
-  DumpRegisters(globals::registers_dump_file_path, registers_);
-  DumpState(globals::vm_state_dump_file_path);
+constexpr uint8_t kAtomicOpcode = 0b0101111;
+constexpr uint8_t kFunct5Lr = 0b00010;
+constexpr uint8_t kFunct5Sc = 0b00011;
+
+// read and write copy guest buffers in chunks of this size, so a huge length does not
+// allocate a host buffer of that size.
+constexpr uint64_t kSyscallChunkSize = 64*1024;
+// Linux's MAX_RW_COUNT: longer reads and writes transfer at most this many bytes.
+constexpr uint64_t kMaxReadWriteCount = 0x7ffff000;
+
+bool FitsInMemory(uint64_t address, uint64_t length, uint64_t memory_size) {
+  return length <= memory_size && address <= memory_size - length;
+}
+
+Memory::AmoOp AmoOpFromFunct5(uint8_t funct5) {
+  switch (funct5) {
+    case 0b00001: return Memory::AmoOp::kSwap;
+    case 0b00000: return Memory::AmoOp::kAdd;
+    case 0b00100: return Memory::AmoOp::kXor;
+    case 0b01100: return Memory::AmoOp::kAnd;
+    case 0b01000: return Memory::AmoOp::kOr;
+    case 0b10000: return Memory::AmoOp::kMin;
+    case 0b10100: return Memory::AmoOp::kMax;
+    case 0b11000: return Memory::AmoOp::kMinu;
+    case 0b11100: return Memory::AmoOp::kMaxu;
+    default: throw std::runtime_error("Unknown atomic memory operation: funct5 " + std::to_string(funct5));
+  }
+}
+
+} // namespace
+
+
+RVSSVM::RVSSVM(VmContext context) : VmBase(std::move(context)) {
+  DumpRegistersAndState();
 }
 
 RVSSVM::~RVSSVM() = default;
@@ -46,13 +83,26 @@ void RVSSVM::Decode() {
 void RVSSVM::Execute() {
   uint8_t opcode = current_instruction_ & 0b1111111;
   uint8_t funct3 = (current_instruction_ >> 12) & 0b111;
+  alu_operation_ = alu::AluOp::kNone;
 
   if (opcode == get_instr_encoding(Instruction::kecall).opcode && 
       funct3 == get_instr_encoding(Instruction::kecall).funct3) {
+    if constexpr (kPerfCountersEnabled) {
+      perf_counters_.CountClass(InstructionClass::kSyscall);
+    }
     HandleSyscall();
     return;
   }
 
+  if (instruction_set::isVInstruction(current_instruction_)) { // RVV; also owns its loads and stores
+    if constexpr (kPerfCountersEnabled) {
+      perf_counters_.CountClass(InstructionClass::kVector);
+    }
+    vector_unit_.SetHostSimd(context_.config.getVectorHostSimd());
+    vector_unit_.Execute(current_instruction_, registers_, memory_controller_, current_delta_);
+    return;
+  }
+
   if (instruction_set::isFInstruction(current_instruction_)) { // RV64 F
     ExecuteFloat();
     return;
@@ -60,8 +110,17 @@ void RVSSVM::Execute() {
     ExecuteDouble();
     return;
   } else if (opcode==0b1110011) {
+    if constexpr (kPerfCountersEnabled) {
+      perf_counters_.CountClass(InstructionClass::kCsr);
+    }
     ExecuteCsr();
     return;
+  } else if (opcode==kAtomicOpcode) { // the address is rs1, with no offset
+    if constexpr (kPerfCountersEnabled) {
+      perf_counters_.CountClass(InstructionClass::kAtomic);
+    }
+    execution_result_ = static_cast<int64_t>(registers_.ReadGpr((current_instruction_ >> 15) & 0b11111));
+    return;
   }
 
   uint8_t rs1 = (current_instruction_ >> 15) & 0b11111;
@@ -80,7 +139,10 @@ void RVSSVM::Execute() {
 
   alu::AluOp aluOperation = control_unit_.GetAluSignal(current_instruction_, control_unit_.GetAluOp());
   std::tie(execution_result_, overflow) = alu_.execute(aluOperation, reg1_value, reg2_value);
+  alu_operation_ = aluOperation;
+
 
+  const uint64_t instruction_pc = program_counter_ - 4; // PC was already updated in Fetch()
 
   if (control_unit_.GetBranch()) {
     if (opcode==get_instr_encoding(Instruction::kjalr).opcode || 
@@ -138,11 +200,43 @@ void RVSSVM::Execute() {
     UpdateProgramCounter(imm);
   }
 
+  if (coverage_ != nullptr && control_unit_.GetBranch() && (opcode != 0b1100011 || branch_flag_)) {
+    coverage_->Record(instruction_pc, program_counter_);
+  }
+
+  if (branch_predictor_.IsEnabled() && control_unit_.GetBranch()) {
+    BranchKind kind = opcode == 0b1100011 ? BranchKind::kConditional : ClassifyJump(current_instruction_);
+    bool taken = kind != BranchKind::kConditional || branch_flag_;
+    if (branch_predictor_.Resolve(instruction_pc, kind, taken, program_counter_)) {
+      branch_mispredictions_++;
+      cycle_s_ += context_.config.getMispredictionPenalty();
+      stall_cycles_ += context_.config.getMispredictionPenalty();
+    }
+  }
+
 
   if (opcode==get_instr_encoding(Instruction::kauipc).opcode) { // AUIPC
     execution_result_ = static_cast<int64_t>(program_counter_) - 4 + (imm << 12);
 
   }
+
+  if constexpr (kPerfCountersEnabled) {
+    perf_counters_.CountAluOp(aluOperation);
+    InstructionClass instruction_class = ClassifyAluOp(aluOperation);
+    if (instruction_class == InstructionClass::kAlu) {
+      if (opcode == 0b0000011) {
+        instruction_class = InstructionClass::kLoad;
+      } else if (opcode == 0b0100011) {
+        instruction_class = InstructionClass::kStore;
+      } else if (opcode == 0b1100011) {
+        instruction_class = branch_flag_ ? InstructionClass::kBranchTaken : InstructionClass::kBranchNotTaken;
+      } else if (opcode == get_instr_encoding(Instruction::kjal).opcode ||
+                 opcode == get_instr_encoding(Instruction::kjalr).opcode) {
+        instruction_class = InstructionClass::kJump;
+      }
+    }
+    perf_counters_.CountClass(instruction_class);
+  }
 }
 
 void RVSSVM::ExecuteFloat() {
@@ -176,6 +270,11 @@ void RVSSVM::ExecuteFloat() {
 
   alu::AluOp aluOperation = control_unit_.GetAluSignal(current_instruction_, control_unit_.GetAluOp());
   std::tie(execution_result_, fcsr_status) = alu::Alu::fpexecute(aluOperation, reg1_value, reg2_value, reg3_value, rm);
+  alu_operation_ = aluOperation;
+  if constexpr (kPerfCountersEnabled) {
+    perf_counters_.CountAluOp(aluOperation);
+    perf_counters_.CountClass(InstructionClass::kFloat);
+  }
 
   // std::cout << "+++++ Float execution result: " << execution_result_ << std::endl;
 
@@ -210,11 +309,19 @@ void RVSSVM::ExecuteDouble() {
 
   alu::AluOp aluOperation = control_unit_.GetAluSignal(current_instruction_, control_unit_.GetAluOp());
   std::tie(execution_result_, fcsr_status) = alu::Alu::dfpexecute(aluOperation, reg1_value, reg2_value, reg3_value, rm);
+  alu_operation_ = aluOperation;
+  if constexpr (kPerfCountersEnabled) {
+    perf_counters_.CountAluOp(aluOperation);
+    perf_counters_.CountClass(InstructionClass::kFloat);
+  }
 }
 
 void RVSSVM::ExecuteCsr() {
   uint8_t rs1 = (current_instruction_ >> 15) & 0b11111;
   uint16_t csr = (current_instruction_ >> 20) & 0xFFF;
+  if (csr >= kCsrCycle && csr <= kCsrHpmCounter31) {
+    SyncCounterCsrs();
+  }
   uint64_t csr_val = registers_.ReadCsr(csr);
 
   csr_target_address_ = csr;
@@ -226,168 +333,193 @@ void RVSSVM::ExecuteCsr() {
 // TODO: implement writeback for syscalls
 void RVSSVM::HandleSyscall() {
   uint64_t syscall_number = registers_.ReadGpr(17);
+
+  // Console output goes through guest_io_, which buffers it until a flush point.
+  auto print_output = [this](const std::string &text) {
+    if (!context_.vm_as_backend) {
+      guest_io_.WriteConsole(1, "[Syscall output: " + text + "]\n");
+    } else {
+      guest_io_.WriteConsole(1, text);
+    }
+  };
+  auto write_result = [this](uint64_t new_reg) {
+    uint64_t old_reg = registers_.ReadGpr(10);
+    unsigned int reg_index = 10;
+    unsigned int reg_type = 0; // 0 for GPR, 1 for CSR, 2 for FPR
+    registers_.WriteGpr(10, new_reg);
+    if (old_reg != new_reg) {
+      current_delta_.register_changes.push_back({reg_index, reg_type, old_reg, new_reg});
+    }
+  };
+
   switch (syscall_number) {
     case SYSCALL_PRINT_INT: {
-        if (!globals::vm_as_backend) {
-            std::cout << "[Syscall output: ";
-        } else {
-          std::cout << "VM_STDOUT_START";
-        }
-        std::cout << static_cast<int64_t>(registers_.ReadGpr(10)); // Print signed integer
-        if (!globals::vm_as_backend) {
-            std::cout << "]" << std::endl;
-        } else {
-          std::cout << "VM_STDOUT_END" << std::endl;
-        }
+        print_output(std::to_string(static_cast<int64_t>(registers_.ReadGpr(10)))); // Print signed integer
         break;
     }
     case SYSCALL_PRINT_FLOAT: { // print float
-        if (!globals::vm_as_backend) {
-            std::cout << "[Syscall output: ";
-        } else {
-          std::cout << "VM_STDOUT_START";
-        }
         float float_value;
         uint64_t raw = registers_.ReadGpr(10);
         std::memcpy(&float_value, &raw, sizeof(float_value));
-        std::cout << std::setprecision(std::numeric_limits<float>::max_digits10) << float_value;
-        if (!globals::vm_as_backend) {
-            std::cout << "]" << std::endl;
-        } else {
-          std::cout << "VM_STDOUT_END" << std::endl;
-        }
+        std::ostringstream text;
+        text << std::setprecision(std::numeric_limits<float>::max_digits10) << float_value;
+        print_output(text.str());
         break;
     }
     case SYSCALL_PRINT_DOUBLE: { // print double
-        if (!globals::vm_as_backend) {
-            std::cout << "[Syscall output: ";
-        } else {
-          std::cout << "VM_STDOUT_START";
-        }
         double double_value;
         uint64_t raw = registers_.ReadGpr(10);
         std::memcpy(&double_value, &raw, sizeof(double_value));
-        std::cout << std::setprecision(std::numeric_limits<double>::max_digits10) << double_value;
-        if (!globals::vm_as_backend) {
-            std::cout << "]" << std::endl;
-        } else {
-          std::cout << "VM_STDOUT_END" << std::endl;
-        }
+        std::ostringstream text;
+        text << std::setprecision(std::numeric_limits<double>::max_digits10) << double_value;
+        print_output(text.str());
         break;
     }
     case SYSCALL_PRINT_STRING: {
-        if (!globals::vm_as_backend) {
-            std::cout << "[Syscall output: ";
-        }
-        PrintString(registers_.ReadGpr(10)); // Print string
-        if (!globals::vm_as_backend) {
-            std::cout << "]" << std::endl;
-        }
+        print_output(ReadString(registers_.ReadGpr(10))); // Print string
         break;
     }
-    case SYSCALL_EXIT: {
-        stop_requested_ = true; // Stop the VM
-        if (!globals::vm_as_backend) {
+    case SYSCALL_EXIT:
+    case SYSCALL_EXIT_LINUX: {
+        guest_io_.Flush();
+        // Headless runs that capture the guest's output keep the console quiet too.
+        if (!context_.vm_as_backend && !guest_io_.IsCapturingOutput()) {
             std::cout << "VM_EXIT" << std::endl;
         }
         output_status_ = "VM_EXIT";
-        std::cout << "Exited with exit code: " << registers_.ReadGpr(10) << std::endl;
-        exit(0); // Exit the program
+        exited_ = true;
+        exit_code_ = registers_.ReadGpr(10);
+        if (!guest_io_.IsCapturingOutput()) {
+            std::cout << "Exited with exit code: " << exit_code_ << std::endl;
+        }
         break;
     }
+    case SYSCALL_OPENAT: {
+      constexpr int64_t at_fdcwd = -100;
+      int64_t dir_fd = static_cast<int64_t>(registers_.ReadGpr(10));
+      if (dir_fd != at_fdcwd) {
+        write_result(static_cast<uint64_t>(-EBADF));
+        break;
+      }
+      std::string path = ReadString(registers_.ReadGpr(11));
+      write_result(static_cast<uint64_t>(guest_io_.Open(path,
+                                                        static_cast<int64_t>(registers_.ReadGpr(12)),
+                                                        static_cast<int64_t>(registers_.ReadGpr(13)))));
+      break;
+    }
+    case SYSCALL_CLOSE: {
+      write_result(static_cast<uint64_t>(guest_io_.Close(static_cast<int64_t>(registers_.ReadGpr(10)))));
+      break;
+    }
+    case SYSCALL_LSEEK: {
+      write_result(static_cast<uint64_t>(guest_io_.Seek(static_cast<int64_t>(registers_.ReadGpr(10)),
+                                                        static_cast<int64_t>(registers_.ReadGpr(11)),
+                                                        static_cast<int64_t>(registers_.ReadGpr(12)))));
+      break;
+    }
     case SYSCALL_READ: { // Read
-      uint64_t file_descriptor = registers_.ReadGpr(10);
+      int64_t file_descriptor = static_cast<int64_t>(registers_.ReadGpr(10));
       uint64_t buffer_address = registers_.ReadGpr(11);
-      uint64_t length = registers_.ReadGpr(12);
-
-      if (file_descriptor == 0) {
-        // Read from stdin
-        std::string input;
-        {
-          std::cout << "VM_STDIN_START" << std::endl;
-          output_status_ = "VM_STDIN_START";
-          std::unique_lock<std::mutex> lock(input_mutex_);
-          input_cv_.wait(lock, [this]() { 
-            return !input_queue_.empty(); 
-          });
-          output_status_ = "VM_STDIN_END";
-          std::cout << "VM_STDIN_END" << std::endl;
+      uint64_t length = std::min(registers_.ReadGpr(12), kMaxReadWriteCount);
+      if (!FitsInMemory(buffer_address, length, memory_controller_.GetSharedMemory()->GetMemorySize())) {
+        write_result(static_cast<uint64_t>(-EFAULT));
+        break;
+      }
 
-          input = input_queue_.front();
-          input_queue_.pop();
+      bool interactive_stdin = file_descriptor == 0 && !guest_io_.HasPreloadedStdin();
+      std::string input;
+      if (interactive_stdin) {
+        guest_io_.Flush();
+        std::cout << "VM_STDIN_START" << std::endl;
+        output_status_ = "VM_STDIN_START";
+        std::unique_lock<std::mutex> lock(input_mutex_);
+        // Keeps serving the frontend's memory views while the program waits for input.
+        PublishState(true);
+        while (!input_cv_.wait_for(lock, std::chrono::milliseconds(10), [this]() {
+          return !input_queue_.empty();
+        })) {
+          if (state_publisher_.MemoryViewRequested()) {
+            PublishState(true);
+          }
         }
+        output_status_ = "VM_STDIN_END";
+        std::cout << "VM_STDIN_END" << std::endl;
 
+        input = input_queue_.front();
+        input_queue_.pop();
+      }
 
-        std::vector<uint8_t> old_bytes_vec(length, 0);
-        std::vector<uint8_t> new_bytes_vec(length, 0);
-
-        for (size_t i = 0; i < length; ++i) {
-          old_bytes_vec[i] = memory_controller_.ReadByte(buffer_address + i);
-        }
-        
-        for (size_t i = 0; i < input.size() && i < length; ++i) {
-          memory_controller_.WriteByte(buffer_address + i, static_cast<uint8_t>(input[i]));
+      int64_t bytes_read = 0;
+      do {
+        uint64_t chunk_address = buffer_address + bytes_read;
+        std::vector<uint8_t> old_bytes_vec(std::min(kSyscallChunkSize, length - bytes_read), 0);
+        memory_controller_.ReadBlock(chunk_address, old_bytes_vec);
+        std::vector<uint8_t> new_bytes_vec = old_bytes_vec;
+
+        int64_t chunk_read = 0;
+        if (interactive_stdin) {
+          size_t offset = std::min<size_t>(input.size(), bytes_read);
+          chunk_read = static_cast<int64_t>(std::min<size_t>(new_bytes_vec.size(), input.size() - offset));
+          std::copy_n(input.begin() + offset, chunk_read, new_bytes_vec.begin());
+        } else {
+          chunk_read = guest_io_.Read(file_descriptor, new_bytes_vec);
         }
-        if (input.size() < length) {
-          memory_controller_.WriteByte(buffer_address + input.size(), '\0');
+        if (chunk_read < 0) {
+          if (bytes_read == 0) {
+            bytes_read = chunk_read;
+          }
+          break;
         }
 
-        for (size_t i = 0; i < length; ++i) {
-          new_bytes_vec[i] = memory_controller_.ReadByte(buffer_address + i);
+        bool short_read = static_cast<uint64_t>(chunk_read) < new_bytes_vec.size();
+        size_t changed = static_cast<size_t>(chunk_read);
+        if (file_descriptor == 0 && short_read) {
+          new_bytes_vec[changed++] = '\0';
         }
-
-        current_delta_.memory_changes.push_back({
-          buffer_address, 
-          old_bytes_vec, 
-          new_bytes_vec
-        });
-
-        uint64_t old_reg = registers_.ReadGpr(10);
-        unsigned int reg_index = 10;
-        unsigned int reg_type = 0; // 0 for GPR, 1 for CSR, 2 for FPR
-        uint64_t new_reg = std::min(static_cast<uint64_t>(length), static_cast<uint64_t>(input.size()));
-        registers_.WriteGpr(10, new_reg); 
-        if (old_reg != new_reg) {
-          current_delta_.register_changes.push_back({reg_index, reg_type, old_reg, new_reg});
+        if (changed > 0) {
+          old_bytes_vec.resize(changed);
+          new_bytes_vec.resize(changed);
+          memory_controller_.WriteBlock(chunk_address, new_bytes_vec);
+          current_delta_.memory_changes.push_back({
+            chunk_address,
+            old_bytes_vec,
+            new_bytes_vec
+          });
         }
-
-      } else {
-          std::cerr << "Unsupported file descriptor: " << file_descriptor << std::endl;
-      }
+        bytes_read += chunk_read;
+        if (short_read) {
+          break;
+        }
+      } while (static_cast<uint64_t>(bytes_read) < length);
+      write_result(static_cast<uint64_t>(bytes_read));
       break;
     }
     case SYSCALL_WRITE: { // Write
-        uint64_t file_descriptor = registers_.ReadGpr(10);
+        int64_t file_descriptor = static_cast<int64_t>(registers_.ReadGpr(10));
         uint64_t buffer_address = registers_.ReadGpr(11);
-        uint64_t length = registers_.ReadGpr(12);
-
-        if (file_descriptor == 1) { // stdout
-          std::cout << "VM_STDOUT_START";
-          output_status_ = "VM_STDOUT_START";
-          uint64_t bytes_printed = 0;
-          for (uint64_t i = 0; i < length; ++i) {
-              char c = memory_controller_.ReadByte(buffer_address + i);
-              // if (c == '\0') {
-              //     break;
-              // }
-              std::cout << c;
-              bytes_printed++;
+        uint64_t length = std::min(registers_.ReadGpr(12), kMaxReadWriteCount);
+        if (!FitsInMemory(buffer_address, length, memory_controller_.GetSharedMemory()->GetMemorySize())) {
+          write_result(static_cast<uint64_t>(-EFAULT));
+          break;
+        }
+
+        int64_t bytes_written = 0;
+        do {
+          std::vector<uint8_t> bytes(std::min(kSyscallChunkSize, length - bytes_written));
+          memory_controller_.ReadBlock(buffer_address + bytes_written, bytes);
+          int64_t chunk_written = guest_io_.Write(file_descriptor, bytes);
+          if (chunk_written < 0) {
+            if (bytes_written == 0) {
+              bytes_written = chunk_written;
+            }
+            break;
           }
-          std::cout << std::flush; 
-          output_status_ = "VM_STDOUT_END";
-          std::cout << "VM_STDOUT_END" << std::endl;
-
-          uint64_t old_reg = registers_.ReadGpr(10);
-          unsigned int reg_index = 10;
-          unsigned int reg_type = 0; // 0 for GPR, 1 for CSR, 2 for FPR
-          uint64_t new_reg = std::min(static_cast<uint64_t>(length), bytes_printed);
-          registers_.WriteGpr(10, new_reg);
-          if (old_reg != new_reg) {
-            current_delta_.register_changes.push_back({reg_index, reg_type, old_reg, new_reg});
+          bytes_written += chunk_written;
+          if (static_cast<uint64_t>(chunk_written) < bytes.size()) {
+            break;
           }
-        } else {
-            std::cerr << "Unsupported file descriptor: " << file_descriptor << std::endl;
-        }
+        } while (static_cast<uint64_t>(bytes_written) < length);
+        write_result(static_cast<uint64_t>(bytes_written));
         break;
     }
     default: {
@@ -406,12 +538,28 @@ void RVSSVM::WriteMemory() {
     return;
   }
 
+  if (instruction_set::isVInstruction(current_instruction_)) {
+    return;
+  }
+
+  if (data_cache_.IsEnabled()
+      && (control_unit_.GetMemRead() || control_unit_.GetMemWrite() || opcode==kAtomicOpcode)) {
+    // Atomics read and write their line, so they count as stores.
+    if (!data_cache_.Access(execution_result_, control_unit_.GetMemWrite() || opcode==kAtomicOpcode)) {
+      cycle_s_ += context_.config.getCacheMissPenalty();
+      stall_cycles_ += context_.config.getCacheMissPenalty();
+    }
+  }
+
   if (instruction_set::isFInstruction(current_instruction_)) { // RV64 F
     WriteMemoryFloat();
     return;
   } else if (instruction_set::isDInstruction(current_instruction_)) {
     WriteMemoryDouble();
     return;
+  } else if (opcode==kAtomicOpcode) {
+    WriteMemoryAtomic();
+    return;
   }
 
   if (control_unit_.GetMemRead()) {
@@ -455,48 +603,49 @@ void RVSSVM::WriteMemory() {
   std::vector<uint8_t> old_bytes_vec;
   std::vector<uint8_t> new_bytes_vec;
 
-  // TODO: use direct read to read memory for undo/redo functionality, i.e. ReadByte -> ReadByte_d
+  // The undo snapshots read RAM directly: reading a device register could have side effects,
+  // and device stores leave RAM unchanged, so they are not recorded (I/O cannot be undone).
 
 
   if (control_unit_.GetMemWrite()) {
     switch (funct3) {
       case 0b000: {// SB
         addr = execution_result_;
-        old_bytes_vec.push_back(memory_controller_.ReadByte(addr));
+        old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr));
         memory_controller_.WriteByte(execution_result_, registers_.ReadGpr(rs2) & 0xFF);
-        new_bytes_vec.push_back(memory_controller_.ReadByte(addr));
+        new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr));
         break;
       }
       case 0b001: {// SH
         addr = execution_result_;
         for (size_t i = 0; i < 2; ++i) {
-          old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         memory_controller_.WriteHalfWord(execution_result_, registers_.ReadGpr(rs2) & 0xFFFF);
         for (size_t i = 0; i < 2; ++i) {
-          new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         break;
       }
       case 0b010: {// SW
         addr = execution_result_;
         for (size_t i = 0; i < 4; ++i) {
-          old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         memory_controller_.WriteWord(execution_result_, registers_.ReadGpr(rs2) & 0xFFFFFFFF);
         for (size_t i = 0; i < 4; ++i) {
-          new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         break;
       }
       case 0b011: {// SD
         addr = execution_result_;
         for (size_t i = 0; i < 8; ++i) {
-          old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         memory_controller_.WriteDoubleWord(execution_result_, registers_.ReadGpr(rs2) & 0xFFFFFFFFFFFFFFFF);
         for (size_t i = 0; i < 8; ++i) {
-          new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+          new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
         }
         break;
       }
@@ -512,6 +661,40 @@ void RVSSVM::WriteMemory() {
   }
 }
 
+void RVSSVM::WriteMemoryAtomic() {
+  uint8_t rs2 = (current_instruction_ >> 20) & 0b11111;
+  uint8_t funct3 = (current_instruction_ >> 12) & 0b111;
+  uint8_t funct5 = (current_instruction_ >> 27) & 0b11111;
+  unsigned int size = funct3 == 0b010 ? 4 : 8;
+  uint64_t address = execution_result_;
+  uint64_t operand = registers_.ReadGpr(rs2);
+
+  std::vector<uint8_t> old_bytes_vec(size);
+  memory_controller_.ReadBlock(address, old_bytes_vec);
+
+  uint64_t result;
+  if (funct5 == kFunct5Lr) {
+    result = memory_controller_.LoadReserved(address, size);
+  } else if (funct5 == kFunct5Sc) {
+    result = memory_controller_.StoreConditional(address, size, operand) ? 0 : 1;
+  } else {
+    result = memory_controller_.AtomicMemoryOperation(AmoOpFromFunct5(funct5), address, size, operand);
+  }
+  // Loaded words are sign-extended, like LW.
+  if (size == 4 && funct5 != kFunct5Sc) {
+    result = static_cast<uint64_t>(static_cast<int64_t>(static_cast<int32_t>(result)));
+  }
+  memory_result_ = static_cast<int64_t>(result);
+
+  if (funct5 != kFunct5Lr) {
+    std::vector<uint8_t> new_bytes_vec(size);
+    memory_controller_.ReadBlock(address, new_bytes_vec);
+    if (old_bytes_vec != new_bytes_vec) {
+      current_delta_.memory_changes.push_back({address, old_bytes_vec, new_bytes_vec});
+    }
+  }
+}
+
 void RVSSVM::WriteMemoryFloat() {
   uint8_t rs2 = (current_instruction_ >> 20) & 0b11111;
 
@@ -528,13 +711,13 @@ void RVSSVM::WriteMemoryFloat() {
   if (control_unit_.GetMemWrite()) { // FSW
     addr = execution_result_;
     for (size_t i = 0; i < 4; ++i) {
-      old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+      old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
     }
     uint32_t val = registers_.ReadFpr(rs2) & 0xFFFFFFFF;
     memory_controller_.WriteWord(execution_result_, val);
-    // new_bytes_vec.push_back(memory_controller_.ReadByte(addr));
+    // new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr));
     for (size_t i = 0; i < 4; ++i) {
-      new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+      new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
     }
   }
 
@@ -557,11 +740,11 @@ void RVSSVM::WriteMemoryDouble() {
   if (control_unit_.GetMemWrite()) {// FSD
     addr = execution_result_;
     for (size_t i = 0; i < 8; ++i) {
-      old_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+      old_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
     }
     memory_controller_.WriteDoubleWord(execution_result_, registers_.ReadFpr(rs2));
     for (size_t i = 0; i < 8; ++i) {
-      new_bytes_vec.push_back(memory_controller_.ReadByte(addr + i));
+      new_bytes_vec.push_back(memory_controller_.ReadByte_d(addr + i));
     }
   }
 
@@ -575,12 +758,23 @@ void RVSSVM::WriteBack() {
   uint8_t funct3 = (current_instruction_ >> 12) & 0b111;
   uint8_t rd = (current_instruction_ >> 7) & 0b11111;
   int32_t imm = ImmGenerator(current_instruction_);
+  writeback_to_fpr_ = false;
+
+  if (timing_model_.IsEnabled()) {
+    uint64_t stall = timing_model_.Issue(current_instruction_, alu_operation_, cycle_s_);
+    cycle_s_ += stall;
+    stall_cycles_ += stall;
+  }
 
   if (opcode == get_instr_encoding(Instruction::kecall).opcode && 
       funct3 == get_instr_encoding(Instruction::kecall).funct3) { // ecall
     return;
   }
 
+  if (instruction_set::isVInstruction(current_instruction_)) {
+    return;
+  }
+
   if (instruction_set::isFInstruction(current_instruction_)) { // RV64 F
     WriteBackFloat();
     return;
@@ -634,6 +828,10 @@ void RVSSVM::WriteBack() {
         registers_.WriteGpr(rd, (imm << 12));
         break;
       }
+      case kAtomicOpcode: /* LR, SC, AMO */ {
+        registers_.WriteGpr(rd, memory_result_);
+        break;
+      }
       default: break;
     }
   }
@@ -723,6 +921,7 @@ void RVSSVM::WriteBackFloat() {
     // }
   }
 
+  writeback_to_fpr_ = reg_type == 2;
   if (old_reg!=new_reg) {
     current_delta_.register_changes.push_back({reg_index, reg_type, old_reg, new_reg});
   }
@@ -762,6 +961,7 @@ void RVSSVM::WriteBackDouble() {
     }
   }
 
+  writeback_to_fpr_ = reg_type == 2;
   if (old_reg!=new_reg) {
     current_delta_.register_changes.push_back({reg_index, reg_type, old_reg, new_reg});
   }
@@ -772,43 +972,50 @@ void RVSSVM::WriteBackDouble() {
 void RVSSVM::WriteBackCsr() {
   uint8_t rd = (current_instruction_ >> 7) & 0b11111;
   uint8_t funct3 = (current_instruction_ >> 12) & 0b111;
+  // CSRs 0xC00-0xFFF are read-only (the counters and mhartid); writes to them are dropped.
+  bool read_only = (csr_target_address_ >> 10) == 0b11;
+  auto write_csr = [this, read_only](uint64_t value) {
+    if (!read_only) {
+      registers_.WriteCsr(csr_target_address_, value);
+    }
+  };
 
   switch (funct3) {
     case get_instr_encoding(Instruction::kcsrrw).funct3: { // CSRRW
       registers_.WriteGpr(rd, csr_old_value_);
-      registers_.WriteCsr(csr_target_address_, csr_write_val_);
+      write_csr(csr_write_val_);
       break;
     }
     case get_instr_encoding(Instruction::kcsrrs).funct3: { // CSRRS
       registers_.WriteGpr(rd, csr_old_value_);
       if (csr_write_val_!=0) {
-        registers_.WriteCsr(csr_target_address_, csr_old_value_ | csr_write_val_);
+        write_csr(csr_old_value_ | csr_write_val_);
       }
       break;
     }
     case get_instr_encoding(Instruction::kcsrrc).funct3: { // CSRRC
       registers_.WriteGpr(rd, csr_old_value_);
       if (csr_write_val_!=0) {
-        registers_.WriteCsr(csr_target_address_, csr_old_value_ & ~csr_write_val_);
+        write_csr(csr_old_value_ & ~csr_write_val_);
       }
       break;
     }
     case get_instr_encoding(Instruction::kcsrrwi).funct3: { // CSRRWI
       registers_.WriteGpr(rd, csr_old_value_);
-      registers_.WriteCsr(csr_target_address_, csr_uimm_);
+      write_csr(csr_uimm_);
       break;
     }
     case get_instr_encoding(Instruction::kcsrrsi).funct3: { // CSRRSI
       registers_.WriteGpr(rd, csr_old_value_);
       if (csr_uimm_!=0) {
-        registers_.WriteCsr(csr_target_address_, csr_old_value_ | csr_uimm_);
+        write_csr(csr_old_value_ | csr_uimm_);
       }
       break;
     }
     case get_instr_encoding(Instruction::kcsrrci).funct3: { // CSRRCI
       registers_.WriteGpr(rd, csr_old_value_);
       if (csr_uimm_!=0) {
-        registers_.WriteCsr(csr_target_address_, csr_old_value_ & ~csr_uimm_);
+        write_csr(csr_old_value_ & ~csr_uimm_);
       }
       break;
     }
@@ -816,97 +1023,287 @@ void RVSSVM::WriteBackCsr() {
 
 }
 
+void RVSSVM::RecordTrace(uint64_t pc) {
+  uint8_t opcode = current_instruction_ & 0b1111111;
+  uint8_t funct3 = (current_instruction_ >> 12) & 0b111;
+  TraceRecord record{};
+  record.pc = pc;
+  record.instruction = current_instruction_;
+  record.rd = (current_instruction_ >> 7) & 0b11111;
+
+  if (opcode == get_instr_encoding(Instruction::kecall).opcode) {
+    if (funct3 == get_instr_encoding(Instruction::kecall).funct3) {
+      record.rd = 10; // syscalls return in a0
+    }
+    record.flags |= TraceRecord::kWritesRd;
+  } else if (control_unit_.GetRegWrite()) {
+    record.flags |= TraceRecord::kWritesRd;
+  }
+  if (record.flags & TraceRecord::kWritesRd) {
+    if (writeback_to_fpr_) {
+      record.flags |= TraceRecord::kRdIsFpr;
+      record.rd_value = registers_.ReadFpr(record.rd);
+    } else {
+      record.rd_value = registers_.ReadGpr(record.rd);
+    }
+  }
+
+  if (control_unit_.GetMemRead()) {
+    record.flags |= TraceRecord::kMemRead;
+    record.mem_address = execution_result_;
+    record.mem_value = memory_result_;
+  } else if (control_unit_.GetMemWrite()) {
+    record.flags |= TraceRecord::kMemWrite;
+    record.mem_address = execution_result_;
+    record.mem_value = ReadMemoryValue(record.mem_address, size_t{1} << (funct3 & 0b11));
+  }
+  trace_writer_.Append(record);
+}
+
+uint64_t RVSSVM::ReadMemoryValue(uint64_t address, size_t size) {
+  std::array<uint8_t, 8> bytes{};
+  memory_controller_.ReadBlock(address, std::span<uint8_t>(bytes.data(), size));
+  uint64_t value = 0;
+  for (size_t i = 0; i < size; ++i) {
+    value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+  }
+  return value;
+}
+
+void RVSSVM::CheckWatchpoints(uint64_t pc) {
+  bool is_write = control_unit_.GetMemWrite();
+  if (!is_write && !control_unit_.GetMemRead()) {
+    return;
+  }
+  uint8_t funct3 = (current_instruction_ >> 12) & 0b111;
+  uint64_t address = execution_result_;
+  uint64_t size = uint64_t{1} << (funct3 & 0b11);
+  uint8_t access = is_write ? kWatchWrite : kWatchRead;
+  if (!watchpoints_.IsPageWatched(address, size, access)) {
+    return;
+  }
+  const WatchpointSet::Watchpoint *watchpoint = watchpoints_.Match(address, size, access);
+  if (watchpoint == nullptr) {
+    return;
+  }
+  uint64_t value = ReadMemoryValue(address, size);
+  watchpoint_hit_ = WatchpointHit{pc, address, size, is_write, value, value, *watchpoint};
+}
+
+void RVSSVM::ReportWatchpointHit() {
+  WatchpointHit &hit = *watchpoint_hit_;
+  if (hit.is_write) {
+    hit.new_value = ReadMemoryValue(hit.address, hit.size);
+  }
+  guest_io_.Flush();
+  std::cout << "VM_WATCHPOINT_HIT " << hit.pc << std::endl;
+  std::cout << std::hex << "Watchpoint 0x" << hit.watchpoint.address << " (" << std::dec << hit.watchpoint.length
+            << " bytes, " << WatchKindName(hit.watchpoint.kind) << "): " << (hit.is_write ? "write" : "read")
+            << " of " << hit.size << " bytes at 0x" << std::hex << hit.address << " by pc 0x" << hit.pc;
+  if (hit.is_write) {
+    std::cout << ", old 0x" << hit.old_value << ", new 0x" << hit.new_value;
+  } else {
+    std::cout << ", value 0x" << hit.old_value;
+  }
+  std::cout << std::dec << std::endl;
+  output_status_ = "VM_WATCHPOINT_HIT";
+  watchpoint_hit_.reset();
+}
+
 void RVSSVM::Run() {
   ClearStop();
+  SetupStatePublisher();
   uint64_t instruction_executed = 0;
+  const uint64_t instruction_limit = context_.config.getInstructionExecutionLimit();
 
-  while (!stop_requested_ && program_counter_ < program_size_) {
-    if (instruction_executed > vm_config::config.getInstructionExecutionLimit())
-      break;
+  if (UsesBinaryTranslation()) {
+    // Same count as the loop below, which stops once it has executed limit + 1 instructions.
+    if (!dbt_) {
+      dbt_ = std::make_unique<dbt::DbtEngine>(context_.config.getDbtHotThreshold());
+    }
+    dbt_->Run(*this, instruction_limit == std::numeric_limits<uint64_t>::max() ? instruction_limit
+                                                                               : instruction_limit + 1);
+  } else {
+    while (!stop_requested_ && !exited_ && program_counter_ < program_size_) {
+      if (instruction_executed > instruction_limit)
+        break;
 
-    Fetch();
-    Decode();
-    Execute();
-    WriteMemory();
-    WriteBack();
-    instructions_retired_++;
-    instruction_executed++;
-    cycle_s_++;
-    std::cout << "Program Counter: " << program_counter_ << std::endl;
+      uint64_t pc = program_counter_;
+      Fetch();
+      Decode();
+      Execute();
+      WriteMemory();
+      WriteBack();
+      if (profiler_.IsEnabled()) {
+        profiler_.RecordInstruction(pc, current_instruction_, program_counter_);
+      }
+      if (trace_writer_.IsOpen()) {
+        RecordTrace(pc);
+      }
+      instructions_retired_++;
+      instruction_executed++;
+      cycle_s_++;
+      memory_controller_.GetMmioBus().Tick(1);
+      TickStatePublisher(1);
+    }
   }
+  guest_io_.Flush();
   if (program_counter_ >= program_size_) {
     std::cout << "VM_PROGRAM_END" << std::endl;
     output_status_ = "VM_PROGRAM_END";
   }
-  DumpRegisters(globals::registers_dump_file_path, registers_);
-  DumpState(globals::vm_state_dump_file_path);
+  if (exited_ || program_counter_ >= program_size_) {
+    WriteProfile();
+    WriteBranchReport();
+    WritePerfCounters();
+    CloseTrace();
+  }
+  PublishState(false);
+  DumpRegistersAndState();
+}
+
+uint64_t RVSSVM::RunQuantum(uint64_t max_instructions) {
+  uint64_t executed = 0;
+  while (executed < max_instructions && !IsHalted()) {
+    StepHeadless();
+    executed++;
+  }
+  current_delta_ = StepDelta();
+  return executed;
+}
+
+void RVSSVM::StepHeadless() {
+  current_delta_.old_pc = program_counter_;
+  Fetch();
+  Decode();
+  Execute();
+  WriteMemory();
+  WriteBack();
+  instructions_retired_++;
+  cycle_s_++;
+  memory_controller_.GetMmioBus().Tick(1);
+}
+
+bool RVSSVM::UsesBinaryTranslation() const {
+  return context_.config.getExecutionEngine() == vm_config::ExecutionEngine::DBT && dbt::DbtEngine::IsSupported()
+         && !kPerfCountersEnabled && !profiler_.IsEnabled() && !trace_writer_.IsOpen()
+         && !branch_predictor_.IsEnabled() && !data_cache_.IsEnabled() && !timing_model_.IsEnabled()
+         && coverage_ == nullptr;
 }
 
 void RVSSVM::DebugRun() {
   ClearStop();
+  SetupStatePublisher();
   uint64_t instruction_executed = 0;
-  while (!stop_requested_ && program_counter_ < program_size_) {
-    if (instruction_executed > vm_config::config.getInstructionExecutionLimit())
+  const uint64_t instruction_limit = context_.config.getInstructionExecutionLimit();
+  const uint64_t delay_ms = context_.config.getRunStepDelay();
+  const bool animate_steps = delay_ms > 0;
+  while (!stop_requested_ && !exited_ && program_counter_ < program_size_) {
+    if (instruction_executed > instruction_limit)
       break;
     current_delta_.old_pc = program_counter_;
-    if (std::find(breakpoints_.begin(), breakpoints_.end(), program_counter_) == breakpoints_.end()) {
+    current_delta_.old_cycles = cycle_s_;
+    if (!breakpoints_.ShouldBreak(program_counter_, registers_, memory_controller_)) {
       Fetch();
       Decode();
       Execute();
+      if (!watchpoints_.Empty()) {
+        CheckWatchpoints(current_delta_.old_pc);
+      }
       WriteMemory();
       WriteBack();
+      if (profiler_.IsEnabled()) {
+        profiler_.RecordInstruction(current_delta_.old_pc, current_instruction_, program_counter_);
+      }
+      if (trace_writer_.IsOpen()) {
+        RecordTrace(current_delta_.old_pc);
+      }
       instructions_retired_++;
       instruction_executed++;
       cycle_s_++;
-      std::cout << "Program Counter: " << program_counter_ << std::endl;
+      memory_controller_.GetMmioBus().Tick(1);
+      TickStatePublisher(1);
 
       current_delta_.new_pc = program_counter_;
+      current_delta_.new_cycles = cycle_s_;
       // history_.push(current_delta_);
       undo_stack_.push(current_delta_);
       while (!redo_stack_.empty()) {
         redo_stack_.pop();
       }
       current_delta_ = StepDelta();
-      if (program_counter_ < program_size_) {
-        std::cout << "VM_STEP_COMPLETED" << std::endl;
-        output_status_ = "VM_STEP_COMPLETED";
-      } else if (program_counter_ >= program_size_) {
-        std::cout << "VM_LAST_INSTRUCTION_STEPPED" << std::endl;
-        output_status_ = "VM_LAST_INSTRUCTION_STEPPED";
+
+      // With no delay nobody can watch the steps, so skip the per-step reports and state
+      // dumps and run to the next breakpoint at full speed.
+      if (animate_steps) {
+        std::cout << "Program Counter: " << program_counter_ << std::endl;
+        guest_io_.Flush();
+        if (program_counter_ < program_size_) {
+          std::cout << "VM_STEP_COMPLETED" << std::endl;
+          output_status_ = "VM_STEP_COMPLETED";
+        } else if (program_counter_ >= program_size_) {
+          std::cout << "VM_LAST_INSTRUCTION_STEPPED" << std::endl;
+          output_status_ = "VM_LAST_INSTRUCTION_STEPPED";
+        }
+        DumpRegistersAndState();
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
+      }
+      if (watchpoint_hit_) {
+        ReportWatchpointHit();
+        break;
       }
-      DumpRegisters(globals::registers_dump_file_path, registers_);
-      DumpState(globals::vm_state_dump_file_path);
 
-      unsigned int delay_ms = vm_config::config.getRunStepDelay();
-      std::this_thread::sleep_for(std::chrono::milliseconds(delay_ms));
-      
     } else {
+      guest_io_.Flush();
       std::cout << "VM_BREAKPOINT_HIT " << program_counter_ << std::endl;
       output_status_ = "VM_BREAKPOINT_HIT";
       break;
     }
   }
+  guest_io_.Flush();
   if (program_counter_ >= program_size_) {
     std::cout << "VM_PROGRAM_END" << std::endl;
     output_status_ = "VM_PROGRAM_END";
   }
-  DumpRegisters(globals::registers_dump_file_path, registers_);
-  DumpState(globals::vm_state_dump_file_path);
+  if (exited_ || program_counter_ >= program_size_) {
+    WriteProfile();
+    WriteBranchReport();
+    WritePerfCounters();
+    CloseTrace();
+  }
+  PublishState(false);
+  DumpRegistersAndState();
 }
 
 void RVSSVM::Step() {
   current_delta_.old_pc = program_counter_;
-  if (program_counter_ < program_size_) {
+  current_delta_.old_cycles = cycle_s_;
+  if (exited_) {
+    std::cout << "VM_EXIT" << std::endl;
+    output_status_ = "VM_EXIT";
+  } else if (program_counter_ < program_size_) {
     Fetch();
     Decode();
     Execute();
+    if (!watchpoints_.Empty()) {
+      CheckWatchpoints(current_delta_.old_pc);
+    }
     WriteMemory();
     WriteBack();
+    if (profiler_.IsEnabled()) {
+      profiler_.RecordInstruction(current_delta_.old_pc, current_instruction_, program_counter_);
+    }
+    if (trace_writer_.IsOpen()) {
+      RecordTrace(current_delta_.old_pc);
+    }
     instructions_retired_++;
     cycle_s_++;
+    memory_controller_.GetMmioBus().Tick(1);
     std::cout << "Program Counter: " << std::hex << program_counter_ << std::dec << std::endl;
+    guest_io_.Flush();
 
     current_delta_.new_pc = program_counter_;
+    current_delta_.new_cycles = cycle_s_;
 
     // history_.push(current_delta_);
 
@@ -925,13 +1322,22 @@ void RVSSVM::Step() {
       std::cout << "VM_LAST_INSTRUCTION_STEPPED" << std::endl;
       output_status_ = "VM_LAST_INSTRUCTION_STEPPED";
     }
+    if (watchpoint_hit_) {
+      ReportWatchpointHit();
+    }
 
   } else if (program_counter_ >= program_size_) {
     std::cout << "VM_PROGRAM_END" << std::endl;
     output_status_ = "VM_PROGRAM_END";
   }
-  DumpRegisters(globals::registers_dump_file_path, registers_);
-  DumpState(globals::vm_state_dump_file_path);
+  if (exited_ || program_counter_ >= program_size_) {
+    WriteProfile();
+    WriteBranchReport();
+    WritePerfCounters();
+    CloseTrace();
+  }
+  PublishState(false);
+  DumpRegistersAndState();
 }
 
 void RVSSVM::Undo() {
@@ -965,6 +1371,10 @@ void RVSSVM::Undo() {
         registers_.WriteFpr(change.reg_index, change.old_value);
         break;
       }
+      case 3: { // vector register slice
+        registers_.WriteVectorSlice(change.reg_index, change.old_value);
+        break;
+      }
       default:std::cerr << "Invalid register type: " << change.reg_type << std::endl;
         break;
     }
@@ -978,7 +1388,8 @@ void RVSSVM::Undo() {
 
   program_counter_ = last.old_pc;
   instructions_retired_--;
-  cycle_s_--;
+  cycle_s_ = last.old_cycles;
+  timing_model_.Clear();
   std::cout << "Program Counter: " << program_counter_ << std::endl;
 
   redo_stack_.push(last);
@@ -986,8 +1397,7 @@ void RVSSVM::Undo() {
   output_status_ = "VM_UNDO_COMPLETED";
   std::cout << "VM_UNDO_COMPLETED" << std::endl;
 
-  DumpRegisters(globals::registers_dump_file_path, registers_);
-  DumpState(globals::vm_state_dump_file_path);
+  DumpRegistersAndState();
 }
 
 void RVSSVM::Redo() {
@@ -1020,6 +1430,10 @@ void RVSSVM::Redo() {
         registers_.WriteFpr(change.reg_index, change.new_value);
         break;
       }
+      case 3: { // vector register slice
+        registers_.WriteVectorSlice(change.reg_index, change.new_value);
+        break;
+      }
       default:std::cerr << "Invalid register type: " << change.reg_type << std::endl;
         break;
     }
@@ -1033,9 +1447,9 @@ void RVSSVM::Redo() {
 
   program_counter_ = next.new_pc;
   instructions_retired_++;
-  cycle_s_++;
-  DumpRegisters(globals::registers_dump_file_path, registers_);
-  DumpState(globals::vm_state_dump_file_path);
+  cycle_s_ = next.new_cycles;
+  timing_model_.Clear();
+  DumpRegistersAndState();
   std::cout << "Program Counter: " << program_counter_ << std::endl;
   undo_stack_.push(next);
 
@@ -1046,6 +1460,7 @@ void RVSSVM::Reset() {
   instructions_retired_ = 0;
   cycle_s_ = 0;
   registers_.Reset();
+  registers_.WriteCsr(kCsrMhartid, hart_id_);
   memory_controller_.Reset();
   control_unit_.Reset();
   branch_flag_ = false;
@@ -1062,9 +1477,30 @@ void RVSSVM::Reset() {
   current_delta_.memory_changes.clear();
   current_delta_.old_pc = 0;
   current_delta_.new_pc = 0;
+  current_delta_.old_cycles = 0;
+  current_delta_.new_cycles = 0;
   undo_stack_ = std::stack<StepDelta>();
   redo_stack_ = std::stack<StepDelta>();
+  guest_io_.Reset();
+  profiler_.Reset();
+  perf_counters_.Reset();
+  branch_predictor_.Reset();
+  branch_mispredictions_ = 0;
+  data_cache_.Reset();
+  timing_model_.Reset();
+  stall_cycles_ = 0;
+  CloseTrace();
+  writeback_to_fpr_ = false;
+  watchpoint_hit_.reset();
+  dbt_.reset();
+  exited_ = false;
+  exit_code_ = 0;
+
+}
 
+void RVSSVM::Fork(const VmSnapshot &snapshot) {
+  Reset();
+  VmBase::Fork(snapshot);
 }
 
 
@@ -0,0 +1,375 @@
+/**
+ * @file state_image.cpp
+ * @brief Contains the implementation of the state image writer and reader.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/state_image.h"
+#include "common/lz_codec.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+constexpr size_t kCsrCount = 4096;
+
+class ByteWriter {
+ public:
+  template<typename T>
+  void Put(T value) {
+    const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+    bytes_.insert(bytes_.end(), bytes, bytes + sizeof(T));
+  }
+
+  void PutBytes(const uint8_t *data, size_t size) {
+    bytes_.insert(bytes_.end(), data, data + size);
+  }
+
+  void PutString(const std::string &text) {
+    Put<uint64_t>(text.size());
+    PutBytes(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+  }
+
+  void PutMap(const std::map<unsigned int, unsigned int> &map) {
+    Put<uint64_t>(map.size());
+    for (const auto &[key, value] : map) {
+      Put<uint32_t>(key);
+      Put<uint32_t>(value);
+    }
+  }
+
+  [[nodiscard]] const std::vector<uint8_t> &GetBytes() const {
+    return bytes_;
+  }
+
+ private:
+  std::vector<uint8_t> bytes_;
+};
+
+class ByteReader {
+ public:
+  ByteReader(const uint8_t *data, size_t size) : data_(data), size_(size) {}
+
+  const uint8_t *Take(size_t size) {
+    if (size > size_ - offset_) {
+      throw std::runtime_error("State image is truncated");
+    }
+    const uint8_t *bytes = data_ + offset_;
+    offset_ += size;
+    return bytes;
+  }
+
+  template<typename T>
+  T Get() {
+    T value;
+    std::memcpy(&value, Take(sizeof(T)), sizeof(T));
+    return value;
+  }
+
+  /**
+   * @brief Reads an element count, checking that many elements of at least element_size bytes remain.
+   */
+  uint64_t GetCount(size_t element_size) {
+    uint64_t count = Get<uint64_t>();
+    if (count > (size_ - offset_)/element_size) {
+      throw std::runtime_error("State image is truncated");
+    }
+    return count;
+  }
+
+  std::string GetString() {
+    uint64_t size = GetCount(1);
+    return {reinterpret_cast<const char *>(Take(size)), size};
+  }
+
+  std::map<unsigned int, unsigned int> GetMap() {
+    std::map<unsigned int, unsigned int> map;
+    uint64_t count = GetCount(2*sizeof(uint32_t));
+    for (uint64_t i = 0; i < count; ++i) {
+      uint32_t key = Get<uint32_t>();
+      map.emplace_hint(map.end(), key, Get<uint32_t>());
+    }
+    return map;
+  }
+
+  [[nodiscard]] size_t GetOffset() const {
+    return offset_;
+  }
+
+ private:
+  const uint8_t *data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+
+/**
+ * @brief A read-only mapping of a whole file.
+ */
+class MappedFile {
+ public:
+  explicit MappedFile(const std::filesystem::path &filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Unable to open state image: " + filename.string());
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(StateImageHeader))) {
+      ::close(fd);
+      throw std::runtime_error("Not a state image: " + filename.string());
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void *mapping = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+      throw std::runtime_error("Unable to map state image: " + filename.string());
+    }
+    mapping_ = static_cast<const uint8_t *>(mapping);
+    // Pages are read once, front to back.
+    ::madvise(mapping, size_, MADV_SEQUENTIAL);
+  }
+
+  ~MappedFile() {
+    ::munmap(const_cast<uint8_t *>(mapping_), size_);
+  }
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+
+  [[nodiscard]] const uint8_t *GetData() const {
+    return mapping_;
+  }
+
+  [[nodiscard]] size_t GetSize() const {
+    return size_;
+  }
+
+ private:
+  const uint8_t *mapping_ = nullptr;
+  size_t size_ = 0;
+};
+
+std::vector<uint8_t> WriteMetadata(const VmSnapshot &snapshot,
+                                   const std::vector<BreakpointSet::Breakpoint> &breakpoints) {
+  ByteWriter writer;
+  writer.Put<uint64_t>(snapshot.program_counter);
+  writer.Put<uint64_t>(snapshot.text_start);
+  writer.Put<uint64_t>(snapshot.program_size);
+  writer.Put<uint64_t>(snapshot.instructions_retired);
+  writer.Put<uint64_t>(snapshot.cycles);
+  writer.Put<uint8_t>(snapshot.exited);
+  writer.Put<uint64_t>(snapshot.exit_code);
+
+  const RegisterFile &registers = snapshot.registers;
+  for (size_t r = 0; r < 32; ++r) {
+    writer.Put<uint64_t>(registers.ReadGpr(r));
+  }
+  for (size_t r = 0; r < 32; ++r) {
+    writer.Put<uint64_t>(registers.ReadFpr(r));
+  }
+  for (size_t csr = 0; csr < kCsrCount; ++csr) {
+    writer.Put<uint64_t>(registers.ReadCsr(csr));
+  }
+  writer.PutBytes(registers.VectorData(), 32*registers.GetVlenb());
+
+  writer.Put<uint64_t>(breakpoints.size());
+  for (const BreakpointSet::Breakpoint &breakpoint : breakpoints) {
+    writer.Put<uint64_t>(breakpoint.address);
+    writer.Put<uint64_t>(breakpoint.hit_count);
+    writer.Put<uint64_t>(breakpoint.hits);
+    writer.PutString(breakpoint.condition);
+  }
+
+  const AssembledProgram &program = *snapshot.program;
+  writer.PutString(program.filename);
+  writer.Put<uint64_t>(program.text_buffer.size());
+  writer.PutBytes(reinterpret_cast<const uint8_t *>(program.text_buffer.data()),
+                  program.text_buffer.size()*sizeof(uint32_t));
+  writer.Put<uint64_t>(program.symbol_table.size());
+  for (const auto &[name, symbol] : program.symbol_table) {
+    writer.PutString(name);
+    writer.Put<uint64_t>(symbol.address);
+    writer.Put<uint64_t>(symbol.line_number);
+    writer.Put<uint8_t>(symbol.isData);
+  }
+  writer.PutMap(program.line_number_instruction_number_mapping);
+  writer.PutMap(program.instruction_number_line_number_mapping);
+  writer.PutMap(program.instruction_number_disassembly_mapping);
+  return writer.GetBytes();
+}
+
+void ReadMetadata(ByteReader &reader, size_t vector_length, StateImage &image) {
+  VmSnapshot &snapshot = image.snapshot;
+  snapshot.program_counter = reader.Get<uint64_t>();
+  snapshot.text_start = reader.Get<uint64_t>();
+  snapshot.program_size = reader.Get<uint64_t>();
+  snapshot.instructions_retired = reader.Get<uint64_t>();
+  snapshot.cycles = reader.Get<uint64_t>();
+  snapshot.exited = reader.Get<uint8_t>() != 0;
+  snapshot.exit_code = reader.Get<uint64_t>();
+
+  RegisterFile &registers = snapshot.registers;
+  registers.SetVectorLength(vector_length);
+  for (size_t r = 0; r < 32; ++r) {
+    registers.WriteGpr(r, reader.Get<uint64_t>());
+  }
+  for (size_t r = 0; r < 32; ++r) {
+    registers.WriteFpr(r, reader.Get<uint64_t>());
+  }
+  for (size_t csr = 0; csr < kCsrCount; ++csr) {
+    registers.WriteCsr(csr, reader.Get<uint64_t>());
+  }
+  std::memcpy(registers.VectorData(), reader.Take(32*registers.GetVlenb()), 32*registers.GetVlenb());
+
+  uint64_t breakpoint_count = reader.GetCount(3*sizeof(uint64_t));
+  for (uint64_t i = 0; i < breakpoint_count; ++i) {
+    BreakpointSet::Breakpoint breakpoint{};
+    breakpoint.address = reader.Get<uint64_t>();
+    breakpoint.hit_count = reader.Get<uint64_t>();
+    breakpoint.hits = reader.Get<uint64_t>();
+    breakpoint.condition = reader.GetString();
+    image.breakpoints.push_back(std::move(breakpoint));
+  }
+
+  AssembledProgram program;
+  program.filename = reader.GetString();
+  program.text_buffer.resize(reader.GetCount(sizeof(uint32_t)));
+  std::memcpy(program.text_buffer.data(), reader.Take(program.text_buffer.size()*sizeof(uint32_t)),
+              program.text_buffer.size()*sizeof(uint32_t));
+  uint64_t symbol_count = reader.GetCount(3*sizeof(uint64_t));
+  for (uint64_t i = 0; i < symbol_count; ++i) {
+    std::string name = reader.GetString();
+    SymbolData symbol{};
+    symbol.address = reader.Get<uint64_t>();
+    symbol.line_number = reader.Get<uint64_t>();
+    symbol.isData = reader.Get<uint8_t>() != 0;
+    program.symbol_table.emplace(std::move(name), symbol);
+  }
+  program.line_number_instruction_number_mapping = reader.GetMap();
+  program.instruction_number_line_number_mapping = reader.GetMap();
+  program.instruction_number_disassembly_mapping = reader.GetMap();
+  snapshot.program = std::make_shared<const AssembledProgram>(std::move(program));
+}
+
+} // namespace
+
+void SaveStateImage(const std::filesystem::path &filename, const VmSnapshot &snapshot,
+                    const std::vector<BreakpointSet::Breakpoint> &breakpoints) {
+  const Memory &memory = *snapshot.memory;
+  const uint32_t block_size = uint32_t{1} << memory.GetBlockShift();
+  std::vector<std::pair<uint64_t, const uint8_t *>> blocks = memory.GetBlocks();
+  // Blocks that were written back to zero read the same as unallocated ones.
+  std::erase_if(blocks, [block_size](const auto &block) {
+    return std::all_of(block.second, block.second + block_size, [](uint8_t byte) { return byte == 0; });
+  });
+
+  std::vector<uint8_t> metadata = WriteMetadata(snapshot, breakpoints);
+  std::vector<uint8_t> compressed_metadata = lz_codec::Compress(metadata.data(), metadata.size());
+
+  std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+  if (!file.is_open()) {
+    throw std::runtime_error("Unable to create state image: " + filename.string());
+  }
+  StateImageHeader header{};
+  std::memcpy(header.magic, kStateImageMagic, sizeof(header.magic));
+  header.version = kStateImageVersion;
+  header.block_size = block_size;
+  header.memory_size = memory.GetMemorySize();
+  header.vector_length = snapshot.registers.GetVlenb()*8;
+  header.page_count = blocks.size();
+  header.metadata_size = compressed_metadata.size();
+  header.metadata_raw_size = metadata.size();
+  file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char *>(compressed_metadata.data()),
+             static_cast<std::streamsize>(compressed_metadata.size()));
+
+  for (const auto &[index, bytes] : blocks) {
+    std::vector<uint8_t> compressed = lz_codec::Compress(bytes, block_size);
+    const bool raw = compressed.size() >= block_size;
+    const uint32_t stored_size = raw ? block_size : static_cast<uint32_t>(compressed.size());
+    file.write(reinterpret_cast<const char *>(&index), sizeof(index));
+    file.write(reinterpret_cast<const char *>(&stored_size), sizeof(stored_size));
+    file.write(reinterpret_cast<const char *>(raw ? bytes : compressed.data()), stored_size);
+  }
+  file.close();
+  if (file.fail()) {
+    throw std::runtime_error("Error writing state image: " + filename.string());
+  }
+}
+
+StateImage LoadStateImage(const std::filesystem::path &filename, vm_config::VmConfig config) {
+  MappedFile file(filename);
+  ByteReader reader(file.GetData(), file.GetSize());
+  StateImageHeader header = reader.Get<StateImageHeader>();
+  if (std::memcmp(header.magic, kStateImageMagic, sizeof(header.magic)) != 0) {
+    throw std::runtime_error("Not a state image: " + filename.string());
+  }
+  if (header.version != kStateImageVersion) {
+    throw std::runtime_error("Unsupported state image version " + std::to_string(header.version)
+                             + " (expected " + std::to_string(kStateImageVersion) + "): " + filename.string());
+  }
+  if (header.block_size < 8 || (header.block_size & (header.block_size - 1)) != 0 || header.memory_size == 0) {
+    throw std::runtime_error("State image is corrupt: bad memory geometry");
+  }
+  config.setMemorySize(header.memory_size);
+  config.setMemoryBlockSize(header.block_size);
+  try {
+    config.setVectorLength(header.vector_length);
+  } catch (const std::invalid_argument &e) {
+    throw std::runtime_error(std::string("State image is corrupt: ") + e.what());
+  }
+
+  if (header.metadata_raw_size/lz_codec::kMaxExpansion > header.metadata_size
+      || header.metadata_size > file.GetSize()) {
+    throw std::runtime_error("State image is corrupt: bad metadata size");
+  }
+  if (header.page_count > ((header.memory_size - 1) >> std::countr_zero(header.block_size)) + 1) {
+    throw std::runtime_error("State image is corrupt: more pages than memory");
+  }
+
+  StateImage image;
+  std::vector<uint8_t> metadata = lz_codec::Decompress(reader.Take(header.metadata_size), header.metadata_size,
+                                                       header.metadata_raw_size);
+  ByteReader metadata_reader(metadata.data(), metadata.size());
+  ReadMetadata(metadata_reader, header.vector_length, image);
+  if (metadata_reader.GetOffset() != metadata.size()) {
+    throw std::runtime_error("State image is corrupt: metadata has trailing bytes");
+  }
+
+  auto memory = std::make_shared<Memory>(config);
+  const unsigned int block_shift = memory->GetBlockShift();
+  const uint64_t last_block = (header.memory_size - 1) >> block_shift;
+  for (uint64_t page = 0; page < header.page_count; ++page) {
+    uint64_t index = reader.Get<uint64_t>();
+    uint32_t stored_size = reader.Get<uint32_t>();
+    if (index > last_block || stored_size > header.block_size) {
+      throw std::runtime_error("State image is corrupt: page " + std::to_string(page));
+    }
+    const uint8_t *bytes = reader.Take(stored_size);
+    uint8_t *block = memory->GetWritableBlock(index << block_shift);
+    if (stored_size == header.block_size) {
+      std::memcpy(block, bytes, stored_size);
+    } else {
+      std::vector<uint8_t> raw = lz_codec::Decompress(bytes, stored_size, header.block_size);
+      std::memcpy(block, raw.data(), raw.size());
+    }
+  }
+  if (reader.GetOffset() != file.GetSize()) {
+    throw std::runtime_error("State image is corrupt: trailing bytes after the last page");
+  }
+
+  image.snapshot.config = std::move(config);
+  image.snapshot.memory = std::move(memory);
+  return image;
+}
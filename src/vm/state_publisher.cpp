@@ -0,0 +1,92 @@
+/**
+ * @file state_publisher.cpp
+ * @brief Contains the implementation of the StatePublisher class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/state_publisher.h"
+
+#include <thread>
+
+void StatePublisher::Publish(const PublishedState &state) {
+  uint64_t sequence = sequence_.load(std::memory_order_relaxed);
+  sequence_.store(sequence + 1, std::memory_order_relaxed);
+  // Keeps the word stores below from moving above the odd sequence.
+  std::atomic_thread_fence(std::memory_order_release);
+  words_[0].store(state.program_counter, std::memory_order_relaxed);
+  words_[1].store(state.instructions_retired, std::memory_order_relaxed);
+  words_[2].store(state.cycles, std::memory_order_relaxed);
+  words_[3].store(state.running ? 1 : 0, std::memory_order_relaxed);
+  for (size_t i = 0; i < 32; ++i) {
+    words_[4 + i].store(state.gprs[i], std::memory_order_relaxed);
+    words_[36 + i].store(state.fprs[i], std::memory_order_relaxed);
+  }
+  sequence_.store(sequence + 2, std::memory_order_release);
+}
+
+PublishedState StatePublisher::Read() const {
+  PublishedState state;
+  while (true) {
+    uint64_t before = sequence_.load(std::memory_order_acquire);
+    if (before & 1) {
+      std::this_thread::yield();
+      continue;
+    }
+    state.program_counter = words_[0].load(std::memory_order_relaxed);
+    state.instructions_retired = words_[1].load(std::memory_order_relaxed);
+    state.cycles = words_[2].load(std::memory_order_relaxed);
+    state.running = words_[3].load(std::memory_order_relaxed) != 0;
+    for (size_t i = 0; i < 32; ++i) {
+      state.gprs[i] = words_[4 + i].load(std::memory_order_relaxed);
+      state.fprs[i] = words_[36 + i].load(std::memory_order_relaxed);
+    }
+    // Keeps the word loads above from moving below the second sequence load.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (sequence_.load(std::memory_order_relaxed) == before) {
+      state.sequence = before/2;
+      return state;
+    }
+  }
+}
+
+void StatePublisher::PublishMemoryView(std::shared_ptr<Memory> memory, const PublishedState &state) {
+  auto view = std::make_shared<PublishedMemoryView>();
+  view->state = state;
+  view->memory = std::move(memory);
+  {
+    std::lock_guard<std::mutex> lock(memory_view_mutex_);
+    memory_view_ = std::move(view);
+    memory_view_generation_++;
+    memory_view_requested_.store(false, std::memory_order_relaxed);
+    holds_memory_view_.store(true, std::memory_order_relaxed);
+  }
+  memory_view_cv_.notify_all();
+}
+
+void StatePublisher::ReleaseMemoryView() {
+  if (!holds_memory_view_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  std::shared_ptr<const PublishedMemoryView> released;
+  {
+    std::lock_guard<std::mutex> lock(memory_view_mutex_);
+    // A reader may have been woken but not yet have taken its copy.
+    if (memory_view_waiters_ > 0) {
+      return;
+    }
+    released = std::move(memory_view_);
+    holds_memory_view_.store(false, std::memory_order_relaxed);
+  }
+}
+
+std::shared_ptr<const PublishedMemoryView> StatePublisher::AcquireMemoryView(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(memory_view_mutex_);
+  const uint64_t generation = memory_view_generation_;
+  memory_view_requested_.store(true, std::memory_order_relaxed);
+  memory_view_waiters_++;
+  bool published = memory_view_cv_.wait_for(lock, timeout, [this, generation]() {
+    return memory_view_generation_ != generation;
+  });
+  memory_view_waiters_--;
+  return published ? memory_view_ : nullptr;
+}
@@ -0,0 +1,380 @@
+/**
+ * @file timing_model.cpp
+ * @brief Contains the implementation of the cycle-approximate timing model.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/timing_model.h"
+
+#include "common/instructions.h"
+
+#include <algorithm>
+
+namespace {
+
+constexpr uint32_t kOpcodeLoad = 0b0000011;
+constexpr uint32_t kOpcodeLoadFp = 0b0000111;
+constexpr uint32_t kOpcodeOpImm = 0b0010011;
+constexpr uint32_t kOpcodeAuipc = 0b0010111;
+constexpr uint32_t kOpcodeOpImm32 = 0b0011011;
+constexpr uint32_t kOpcodeStore = 0b0100011;
+constexpr uint32_t kOpcodeStoreFp = 0b0100111;
+constexpr uint32_t kOpcodeAmo = 0b0101111;
+constexpr uint32_t kOpcodeOp = 0b0110011;
+constexpr uint32_t kOpcodeLui = 0b0110111;
+constexpr uint32_t kOpcodeOp32 = 0b0111011;
+constexpr uint32_t kOpcodeFmadd = 0b1000011;
+constexpr uint32_t kOpcodeFmsub = 0b1000111;
+constexpr uint32_t kOpcodeFnmsub = 0b1001011;
+constexpr uint32_t kOpcodeFnmadd = 0b1001111;
+constexpr uint32_t kOpcodeOpFp = 0b1010011;
+constexpr uint32_t kOpcodeOpV = 0b1010111;
+constexpr uint32_t kOpcodeBranch = 0b1100011;
+constexpr uint32_t kOpcodeJalr = 0b1100111;
+constexpr uint32_t kOpcodeJal = 0b1101111;
+constexpr uint32_t kOpcodeSystem = 0b1110011;
+
+constexpr uint8_t Fpr(uint32_t reg) {
+  return static_cast<uint8_t>(32 + reg);
+}
+
+bool InRange(alu::AluOp op, alu::AluOp first, alu::AluOp last) {
+  return op >= first && op <= last;
+}
+
+bool UsesDivider(LatencyClass latency_class) {
+  return latency_class == LatencyClass::kDiv || latency_class == LatencyClass::kSimdDiv
+         || latency_class == LatencyClass::kFpDiv || latency_class == LatencyClass::kFpSqrt;
+}
+
+RegisterOperands DecodeVectorOperands(uint32_t instruction) {
+  uint32_t opcode = instruction & 0x7f;
+  uint32_t rd = (instruction >> 7) & 0b11111;
+  uint32_t funct3 = (instruction >> 12) & 0b111;
+  uint32_t rs1 = (instruction >> 15) & 0b11111;
+  uint32_t rs2 = (instruction >> 20) & 0b11111;
+  uint32_t funct6 = instruction >> 26;
+  RegisterOperands operands;
+  if (opcode != kOpcodeOpV) { // unit-stride, strided or indexed load/store
+    operands.sources[0] = static_cast<uint8_t>(rs1);
+    if (((instruction >> 26) & 0b11) == 0b10) {
+      operands.sources[1] = static_cast<uint8_t>(rs2);
+    }
+    return operands;
+  }
+  switch (funct3) {
+    case 0b111: // vsetvli, vsetivli, vsetvl
+      if ((instruction >> 30) != 0b11) {
+        operands.sources[0] = static_cast<uint8_t>(rs1);
+      }
+      if ((instruction >> 30) == 0b10) {
+        operands.sources[1] = static_cast<uint8_t>(rs2);
+      }
+      operands.destination = static_cast<uint8_t>(rd);
+      break;
+    case 0b100: // OPIVX
+    case 0b110: // OPMVX
+      operands.sources[0] = static_cast<uint8_t>(rs1);
+      break;
+    case 0b101: // OPFVF
+      operands.sources[0] = Fpr(rs1);
+      break;
+    case 0b010: // OPMVV: vmv.x.s writes rd
+      if (funct6 == 0b010000 && rs1 == 0) {
+        operands.destination = static_cast<uint8_t>(rd);
+      }
+      break;
+    case 0b001: // OPFVV: vfmv.f.s writes rd
+      if (funct6 == 0b010000 && rs1 == 0) {
+        operands.destination = Fpr(rd);
+      }
+      break;
+    default:
+      break;
+  }
+  return operands;
+}
+
+RegisterOperands DecodeOpFpOperands(uint32_t instruction) {
+  uint32_t rd = (instruction >> 7) & 0b11111;
+  uint32_t rs1 = (instruction >> 15) & 0b11111;
+  uint32_t rs2 = (instruction >> 20) & 0b11111;
+  uint32_t funct7 = instruction >> 25;
+  RegisterOperands operands;
+  switch (funct7) {
+    case 0b1101000: // fcvt.s.{w,wu,l,lu}
+    case 0b1101001: // fcvt.d.{w,wu,l,lu}
+    case 0b1111000: // fmv.w.x
+    case 0b1111001: // fmv.d.x
+      operands.sources[0] = static_cast<uint8_t>(rs1);
+      operands.destination = Fpr(rd);
+      break;
+    case 0b1100000: // fcvt.{w,wu,l,lu}.s
+    case 0b1100001: // fcvt.{w,wu,l,lu}.d
+    case 0b1110000: // fmv.x.w, fclass.s
+    case 0b1110001: // fmv.x.d, fclass.d
+      operands.sources[0] = Fpr(rs1);
+      operands.destination = static_cast<uint8_t>(rd);
+      break;
+    case 0b1010000: // feq, flt, fle
+    case 0b1010001:
+      operands.sources = {Fpr(rs1), Fpr(rs2), RegisterOperands::kNone};
+      operands.destination = static_cast<uint8_t>(rd);
+      break;
+    case 0b0101100: // fsqrt.s; rs2 selects the operation
+    case 0b0101101: // fsqrt.d
+    case 0b0100000: // fcvt.s.d
+    case 0b0100001: // fcvt.d.s
+      operands.sources[0] = Fpr(rs1);
+      operands.destination = Fpr(rd);
+      break;
+    default: // two-operand arithmetic, including the fp16, bf16 and msfp16 instructions
+      operands.sources = {Fpr(rs1), Fpr(rs2), RegisterOperands::kNone};
+      operands.destination = Fpr(rd);
+      break;
+  }
+  return operands;
+}
+
+} // namespace
+
+const char *LatencyClassName(LatencyClass latency_class) {
+  switch (latency_class) {
+    case LatencyClass::kAlu: return "alu";
+    case LatencyClass::kMul: return "mul";
+    case LatencyClass::kDiv: return "div";
+    case LatencyClass::kLoad: return "load";
+    case LatencyClass::kStore: return "store";
+    case LatencyClass::kFpAdd: return "fp_add";
+    case LatencyClass::kFpMul: return "fp_mul";
+    case LatencyClass::kFpFma: return "fp_fma";
+    case LatencyClass::kFpDiv: return "fp_div";
+    case LatencyClass::kFpSqrt: return "fp_sqrt";
+    case LatencyClass::kFpMisc: return "fp_misc";
+    case LatencyClass::kSimd: return "simd";
+    case LatencyClass::kSimdMul: return "simd_mul";
+    case LatencyClass::kSimdDiv: return "simd_div";
+    case LatencyClass::kEcc: return "ecc";
+    case LatencyClass::kQuantum: return "quantum";
+    case LatencyClass::kFp16: return "fp16";
+    case LatencyClass::kBf16: return "bf16";
+    case LatencyClass::kMsfp16: return "msfp16";
+    case LatencyClass::kCount: break;
+  }
+  return "unknown";
+}
+
+LatencyClass ClassifyLatency(uint32_t instruction, alu::AluOp op) {
+  using alu::AluOp;
+  if (instruction_set::isVInstruction(instruction)) {
+    return LatencyClass::kAlu;
+  }
+  switch (instruction & 0x7f) {
+    case kOpcodeLoad:
+    case kOpcodeLoadFp:
+    case kOpcodeAmo:
+      return LatencyClass::kLoad;
+    case kOpcodeStore:
+    case kOpcodeStoreFp:
+      return LatencyClass::kStore;
+    case kOpcodeLui:
+    case kOpcodeAuipc:
+    case kOpcodeJal:
+    case kOpcodeJalr:
+    case kOpcodeBranch:
+    case kOpcodeSystem:
+      return LatencyClass::kAlu;
+    default:
+      break;
+  }
+
+  if (InRange(op, AluOp::kMul, AluOp::kMulw) || op == AluOp::kMul_cache) {
+    return LatencyClass::kMul;
+  }
+  if (InRange(op, AluOp::kDiv, AluOp::kRemuw) || op == AluOp::kDiv_cache) {
+    return LatencyClass::kDiv;
+  }
+  if (InRange(op, AluOp::kAdd_simd32, AluOp::kRem_simdb)) {
+    // Each element width has add, sub, mul, load, div and rem, in that order.
+    switch ((static_cast<int>(op) - static_cast<int>(AluOp::kAdd_simd32)) % 6) {
+      case 2: return LatencyClass::kSimdMul;
+      case 4:
+      case 5: return LatencyClass::kSimdDiv;
+      default: return LatencyClass::kSimd;
+    }
+  }
+  if (InRange(op, AluOp::kEcc_check, AluOp::kEcc_div)) {
+    return LatencyClass::kEcc;
+  }
+  if (InRange(op, AluOp::kQAlloc_A, AluOp::kQNormB)) {
+    return LatencyClass::kQuantum;
+  }
+  if (InRange(op, AluOp::FADD_BF16, AluOp::FMADD_BF16)) {
+    return LatencyClass::kBf16;
+  }
+  if (InRange(op, AluOp::FADD_FP16, AluOp::FMADD_FP16)) {
+    return LatencyClass::kFp16;
+  }
+  if (InRange(op, AluOp::FADD_MSFP16, AluOp::FMADD_MSFP16)) {
+    return LatencyClass::kMsfp16;
+  }
+  switch (op) {
+    case AluOp::FADD_S:
+    case AluOp::FSUB_S:
+    case AluOp::FADD_D:
+    case AluOp::FSUB_D:
+      return LatencyClass::kFpAdd;
+    case AluOp::FMUL_S:
+    case AluOp::FMUL_D:
+      return LatencyClass::kFpMul;
+    case AluOp::FDIV_S:
+    case AluOp::FDIV_D:
+      return LatencyClass::kFpDiv;
+    case AluOp::FSQRT_S:
+    case AluOp::FSQRT_D:
+      return LatencyClass::kFpSqrt;
+    default:
+      break;
+  }
+  if (InRange(op, AluOp::kFmadd_s, AluOp::kFnmsub_s) || InRange(op, AluOp::FMADD_D, AluOp::FNMSUB_D)) {
+    return LatencyClass::kFpFma;
+  }
+  if (InRange(op, AluOp::kFmadd_s, AluOp::FMV_X_D)) {
+    return LatencyClass::kFpMisc;
+  }
+  return LatencyClass::kAlu;
+}
+
+RegisterOperands DecodeRegisterOperands(uint32_t instruction) {
+  if (instruction_set::isVInstruction(instruction)) {
+    return DecodeVectorOperands(instruction);
+  }
+  uint32_t opcode = instruction & 0x7f;
+  auto rd = static_cast<uint8_t>((instruction >> 7) & 0b11111);
+  uint32_t funct3 = (instruction >> 12) & 0b111;
+  auto rs1 = static_cast<uint8_t>((instruction >> 15) & 0b11111);
+  auto rs2 = static_cast<uint8_t>((instruction >> 20) & 0b11111);
+  auto rs3 = static_cast<uint8_t>((instruction >> 27) & 0b11111);
+  RegisterOperands operands;
+  switch (opcode) {
+    case kOpcodeLui:
+    case kOpcodeAuipc:
+    case kOpcodeJal:
+      operands.destination = rd;
+      break;
+    case kOpcodeJalr:
+    case kOpcodeLoad:
+    case kOpcodeOpImm:
+    case kOpcodeOpImm32:
+      operands.sources[0] = rs1;
+      operands.destination = rd;
+      break;
+    case kOpcodeStore:
+    case kOpcodeBranch:
+      operands.sources = {rs1, rs2, RegisterOperands::kNone};
+      break;
+    case kOpcodeSystem:
+      if (funct3 != 0) { // CSR instructions; the immediate forms have no rs1
+        if ((funct3 & 0b100) == 0) {
+          operands.sources[0] = rs1;
+        }
+        operands.destination = rd;
+      }
+      break;
+    case kOpcodeLoadFp:
+      operands.sources[0] = rs1;
+      operands.destination = Fpr(rd);
+      break;
+    case kOpcodeStoreFp:
+      operands.sources = {rs1, Fpr(rs2), RegisterOperands::kNone};
+      break;
+    case kOpcodeFmadd:
+    case kOpcodeFmsub:
+    case kOpcodeFnmsub:
+    case kOpcodeFnmadd:
+      operands.sources = {Fpr(rs1), Fpr(rs2), Fpr(rs3)};
+      operands.destination = Fpr(rd);
+      break;
+    case kOpcodeOpFp:
+      return DecodeOpFpOperands(instruction);
+    default: // OP, OP-32, AMO and the custom R-type extensions
+      operands.sources = {rs1, rs2, RegisterOperands::kNone};
+      operands.destination = rd;
+      break;
+  }
+  return operands;
+}
+
+void TimingModel::Start(const vm_config::VmConfig &config) {
+  Reset();
+  if (!config.getTimingEnabled()) {
+    return;
+  }
+  const vm_config::TimingLatencies &latencies = config.getTimingLatencies();
+  latencies_[static_cast<size_t>(LatencyClass::kAlu)] = latencies.alu;
+  latencies_[static_cast<size_t>(LatencyClass::kMul)] = latencies.mul;
+  latencies_[static_cast<size_t>(LatencyClass::kDiv)] = latencies.div;
+  latencies_[static_cast<size_t>(LatencyClass::kLoad)] = latencies.load;
+  latencies_[static_cast<size_t>(LatencyClass::kStore)] = 0;
+  latencies_[static_cast<size_t>(LatencyClass::kFpAdd)] = latencies.fp_add;
+  latencies_[static_cast<size_t>(LatencyClass::kFpMul)] = latencies.fp_mul;
+  latencies_[static_cast<size_t>(LatencyClass::kFpFma)] = latencies.fp_fma;
+  latencies_[static_cast<size_t>(LatencyClass::kFpDiv)] = latencies.fp_div;
+  latencies_[static_cast<size_t>(LatencyClass::kFpSqrt)] = latencies.fp_sqrt;
+  latencies_[static_cast<size_t>(LatencyClass::kFpMisc)] = latencies.fp_misc;
+  latencies_[static_cast<size_t>(LatencyClass::kSimd)] = latencies.simd;
+  latencies_[static_cast<size_t>(LatencyClass::kSimdMul)] = latencies.simd_mul;
+  latencies_[static_cast<size_t>(LatencyClass::kSimdDiv)] = latencies.simd_div;
+  latencies_[static_cast<size_t>(LatencyClass::kEcc)] = latencies.ecc;
+  latencies_[static_cast<size_t>(LatencyClass::kQuantum)] = latencies.quantum;
+  latencies_[static_cast<size_t>(LatencyClass::kFp16)] = latencies.fp16;
+  latencies_[static_cast<size_t>(LatencyClass::kBf16)] = latencies.bf16;
+  latencies_[static_cast<size_t>(LatencyClass::kMsfp16)] = latencies.msfp16;
+  enabled_ = true;
+}
+
+void TimingModel::Reset() {
+  enabled_ = false;
+  latencies_.fill(0);
+  Clear();
+  clock_ = 0;
+  last_now_ = 0;
+  stats_ = {};
+}
+
+void TimingModel::Clear() {
+  // Ready times in the past cost nothing, whatever the clock reads next.
+  ready_.fill(0);
+  divider_free_ = 0;
+}
+
+uint64_t TimingModel::Issue(uint32_t instruction, alu::AluOp op, uint64_t now) {
+  clock_ += now - last_now_;
+  LatencyClass latency_class = ClassifyLatency(instruction, op);
+  uint64_t latency = latencies_[static_cast<size_t>(latency_class)];
+  RegisterOperands operands = DecodeRegisterOperands(instruction);
+
+  uint64_t issue = clock_;
+  for (uint8_t source : operands.sources) {
+    if (source != RegisterOperands::kNone) {
+      issue = std::max(issue, ready_[source]);
+    }
+  }
+  stats_.data_stalls += issue - clock_;
+  if (UsesDivider(latency_class)) {
+    uint64_t operands_ready = issue;
+    issue = std::max(issue, divider_free_);
+    stats_.structural_stalls += issue - operands_ready;
+    divider_free_ = issue + latency;
+  }
+  // x0 is always ready.
+  if (operands.destination != RegisterOperands::kNone && operands.destination != 0) {
+    ready_[operands.destination] = issue + latency;
+  }
+  ++stats_.instructions[static_cast<size_t>(latency_class)];
+
+  uint64_t stall = issue - clock_;
+  clock_ = issue;
+  last_now_ = now + stall;
+  return stall;
+}
@@ -0,0 +1,204 @@
+/**
+ * @file trace.cpp
+ * @brief Contains the implementation of the TraceWriter and TraceReader classes.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/trace.h"
+#include "common/lz_codec.h"
+
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+void XorRecords(uint8_t *bytes, size_t count, bool encode) {
+  constexpr size_t kSize = sizeof(TraceRecord);
+  // Encoding walks backwards so every record is XORed with its original predecessor.
+  if (encode) {
+    for (size_t r = count; r-- > 1;) {
+      for (size_t b = 0; b < kSize; ++b) {
+        bytes[r * kSize + b] ^= bytes[(r - 1) * kSize + b];
+      }
+    }
+  } else {
+    for (size_t r = 1; r < count; ++r) {
+      for (size_t b = 0; b < kSize; ++b) {
+        bytes[r * kSize + b] ^= bytes[(r - 1) * kSize + b];
+      }
+    }
+  }
+}
+
+} // namespace
+
+TraceWriter::~TraceWriter() {
+  Stop();
+}
+
+void TraceWriter::Open(const std::filesystem::path &filename) {
+  if (open_) {
+    Close();
+  }
+  file_.open(filename, std::ios::binary | std::ios::trunc);
+  if (!file_.is_open()) {
+    throw std::runtime_error("Unable to open trace file: " + filename.string());
+  }
+  TraceFileHeader header{};
+  std::memcpy(header.magic, kTraceMagic, sizeof(header.magic));
+  header.version = kTraceVersion;
+  header.record_size = sizeof(TraceRecord);
+  file_.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  for (auto &buffer : buffers_) {
+    buffer.resize(kRecordsPerChunk);
+  }
+  active_ = 0;
+  fill_ = 0;
+  record_count_ = 0;
+  pending_ = false;
+  stopping_ = false;
+  failed_ = false;
+  open_ = true;
+  worker_ = std::thread(&TraceWriter::WorkerLoop, this);
+}
+
+void TraceWriter::Close() {
+  if (!open_) {
+    return;
+  }
+  Stop();
+  if (failed_) {
+    throw std::runtime_error("Error writing the trace file");
+  }
+}
+
+void TraceWriter::Stop() {
+  if (!open_) {
+    return;
+  }
+  if (fill_ > 0) {
+    SubmitActive();
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  cv_.notify_all();
+  worker_.join();
+  file_.close();
+  failed_ = failed_ || file_.fail();
+  for (auto &buffer : buffers_) {
+    buffer = std::vector<TraceRecord>();
+  }
+  open_ = false;
+}
+
+void TraceWriter::SubmitActive() {
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this] { return !pending_; });
+    pending_ = true;
+    pending_buffer_ = active_;
+    pending_count_ = fill_;
+  }
+  cv_.notify_all();
+  active_ ^= 1;
+  fill_ = 0;
+}
+
+void TraceWriter::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return pending_ || stopping_; });
+    if (!pending_) {
+      return;
+    }
+    size_t buffer = pending_buffer_;
+    size_t count = pending_count_;
+    lock.unlock();
+    WriteChunk(buffers_[buffer].data(), count);
+    lock.lock();
+    pending_ = false;
+    cv_.notify_all();
+  }
+}
+
+void TraceWriter::WriteChunk(const TraceRecord *records, size_t count) {
+  std::vector<uint8_t> raw(count * sizeof(TraceRecord));
+  std::memcpy(raw.data(), records, raw.size());
+  XorRecords(raw.data(), count, true);
+  std::vector<uint8_t> compressed = lz_codec::Compress(raw.data(), raw.size());
+
+  uint32_t chunk_header[2] = {static_cast<uint32_t>(count), static_cast<uint32_t>(compressed.size())};
+  file_.write(reinterpret_cast<const char *>(chunk_header), sizeof(chunk_header));
+  file_.write(reinterpret_cast<const char *>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+  if (!file_) {
+    failed_ = true;
+  }
+}
+
+TraceReader::TraceReader(const std::filesystem::path &filename) : file_(filename, std::ios::binary) {
+  if (!file_.is_open()) {
+    throw std::runtime_error("Unable to open trace file: " + filename.string());
+  }
+  TraceFileHeader header{};
+  file_.read(reinterpret_cast<char *>(&header), sizeof(header));
+  if (!file_ || std::memcmp(header.magic, kTraceMagic, sizeof(header.magic)) != 0) {
+    throw std::runtime_error("Not a trace file: " + filename.string());
+  }
+  if (header.version != kTraceVersion || header.record_size != sizeof(TraceRecord)) {
+    throw std::runtime_error("Unsupported trace version in " + filename.string());
+  }
+}
+
+bool TraceReader::Next(TraceRecord &record) {
+  if (chunk_index_ == chunk_.size() && !ReadChunk()) {
+    return false;
+  }
+  record = chunk_[chunk_index_++];
+  ++position_;
+  return true;
+}
+
+bool TraceReader::ReadChunk() {
+  uint32_t chunk_header[2];
+  file_.read(reinterpret_cast<char *>(chunk_header), sizeof(chunk_header));
+  if (file_.gcount() == 0) {
+    return false;
+  }
+  if (!file_) {
+    throw std::runtime_error("Truncated trace chunk header");
+  }
+  std::vector<uint8_t> compressed(chunk_header[1]);
+  file_.read(reinterpret_cast<char *>(compressed.data()), static_cast<std::streamsize>(compressed.size()));
+  if (!file_) {
+    throw std::runtime_error("Truncated trace chunk");
+  }
+  size_t count = chunk_header[0];
+  std::vector<uint8_t> raw = lz_codec::Decompress(compressed.data(), compressed.size(), count * sizeof(TraceRecord));
+  XorRecords(raw.data(), count, false);
+  chunk_.resize(count);
+  std::memcpy(chunk_.data(), raw.data(), raw.size());
+  chunk_index_ = 0;
+  return count > 0 || ReadChunk();
+}
+
+std::string FormatTraceRecord(uint64_t index, const TraceRecord &record) {
+  std::ostringstream os;
+  os << std::setw(10) << index << "  pc=0x" << std::hex << std::setw(8) << std::setfill('0') << record.pc
+     << "  insn=0x" << std::setw(8) << record.instruction << std::setfill(' ');
+  if (record.flags & TraceRecord::kWritesRd) {
+    os << "  " << ((record.flags & TraceRecord::kRdIsFpr) ? 'f' : 'x') << std::dec << static_cast<int>(record.rd)
+       << "=0x" << std::hex << record.rd_value;
+  }
+  if (record.flags & TraceRecord::kMemRead) {
+    os << "  load [0x" << record.mem_address << "]=0x" << record.mem_value;
+  }
+  if (record.flags & TraceRecord::kMemWrite) {
+    os << "  store [0x" << record.mem_address << "]=0x" << record.mem_value;
+  }
+  return os.str();
+}
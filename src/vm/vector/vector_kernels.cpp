@@ -0,0 +1,504 @@
+/**
+ * @file vector_kernels.cpp
+ * @brief Contains the implementation of the element-wise vector kernels.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/vector/vector_kernels.h"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace rvv {
+
+namespace {
+
+template<typename T>
+T Load(const uint8_t *base, size_t i) {
+  T value;
+  std::memcpy(&value, base + i*sizeof(T), sizeof(T));
+  return value;
+}
+
+template<typename T>
+void Store(uint8_t *base, size_t i, T value) {
+  std::memcpy(base + i*sizeof(T), &value, sizeof(T));
+}
+
+template<typename U>
+U MulLow(U x, U y) {
+  return static_cast<U>(static_cast<uint64_t>(x)*static_cast<uint64_t>(y));
+}
+
+template<typename U>
+U MulHigh(U x, U y, bool x_signed, bool y_signed) {
+  constexpr unsigned int kBits = sizeof(U)*8;
+  using S = std::make_signed_t<U>;
+  if constexpr (sizeof(U)==8) {
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+    if (!x_signed) {
+      return static_cast<U>((static_cast<unsigned __int128>(x)*y) >> 64);
+    }
+    __int128 sx = static_cast<S>(x);
+    __int128 sy = y_signed ? static_cast<__int128>(static_cast<S>(y)) : static_cast<__int128>(y);
+    return static_cast<U>((sx*sy) >> 64);
+#pragma GCC diagnostic pop
+  } else {
+    if (!x_signed) {
+      return static_cast<U>((static_cast<uint64_t>(x)*y) >> kBits);
+    }
+    int64_t sx = static_cast<S>(x);
+    int64_t sy = y_signed ? static_cast<int64_t>(static_cast<S>(y)) : static_cast<int64_t>(y);
+    return static_cast<U>((sx*sy) >> kBits);
+  }
+}
+
+template<typename U>
+void ScalarInt(IntOp op, size_t begin, size_t n, const uint8_t *a, const uint8_t *b, uint8_t *out) {
+  using S = std::make_signed_t<U>;
+  constexpr unsigned int kShiftMask = sizeof(U)*8 - 1;
+  constexpr U kAllOnes = std::numeric_limits<U>::max();
+  constexpr S kMinSigned = std::numeric_limits<S>::min();
+  for (size_t i = begin; i < n; ++i) {
+    U x = Load<U>(a, i);
+    U y = Load<U>(b, i);
+    U r = 0;
+    switch (op) {
+      case IntOp::kAdd: r = static_cast<U>(x + y);
+        break;
+      case IntOp::kSub: r = static_cast<U>(x - y);
+        break;
+      case IntOp::kRsub: r = static_cast<U>(y - x);
+        break;
+      case IntOp::kAnd: r = x & y;
+        break;
+      case IntOp::kOr: r = x | y;
+        break;
+      case IntOp::kXor: r = x ^ y;
+        break;
+      case IntOp::kMinu: r = x < y ? x : y;
+        break;
+      case IntOp::kMin: r = static_cast<S>(x) < static_cast<S>(y) ? x : y;
+        break;
+      case IntOp::kMaxu: r = x > y ? x : y;
+        break;
+      case IntOp::kMax: r = static_cast<S>(x) > static_cast<S>(y) ? x : y;
+        break;
+      case IntOp::kSll: r = static_cast<U>(x << (y & kShiftMask));
+        break;
+      case IntOp::kSrl: r = static_cast<U>(x >> (y & kShiftMask));
+        break;
+      case IntOp::kSra: r = static_cast<U>(static_cast<S>(x) >> (y & kShiftMask));
+        break;
+      case IntOp::kMul: r = MulLow(x, y);
+        break;
+      case IntOp::kMulh: r = MulHigh(x, y, true, true);
+        break;
+      case IntOp::kMulhu: r = MulHigh(x, y, false, false);
+        break;
+      case IntOp::kMulhsu: r = MulHigh(x, y, true, false);
+        break;
+      case IntOp::kDivu: r = y==0 ? kAllOnes : static_cast<U>(x/y);
+        break;
+      case IntOp::kDiv:
+        if (y==0) {
+          r = kAllOnes;
+        } else if (static_cast<S>(x)==kMinSigned && static_cast<S>(y)==-1) {
+          r = x;
+        } else {
+          r = static_cast<U>(static_cast<S>(x)/static_cast<S>(y));
+        }
+        break;
+      case IntOp::kRemu: r = y==0 ? x : static_cast<U>(x%y);
+        break;
+      case IntOp::kRem:
+        if (y==0) {
+          r = x;
+        } else if (static_cast<S>(x)==kMinSigned && static_cast<S>(y)==-1) {
+          r = 0;
+        } else {
+          r = static_cast<U>(static_cast<S>(x)%static_cast<S>(y));
+        }
+        break;
+      case IntOp::kMacc: r = static_cast<U>(Load<U>(out, i) + MulLow(x, y));
+        break;
+      case IntOp::kNmsac: r = static_cast<U>(Load<U>(out, i) - MulLow(x, y));
+        break;
+    }
+    Store<U>(out, i, r);
+  }
+}
+
+template<typename F, typename U>
+void ScalarFp(FpOp op, size_t begin, size_t n, const uint8_t *a, const uint8_t *b, uint8_t *out) {
+  constexpr U kSign = U(1) << (sizeof(U)*8 - 1);
+  constexpr U kCanonicalNan = sizeof(U)==4 ? U(0x7fc00000) : U(0x7ff8000000000000);
+  for (size_t i = begin; i < n; ++i) {
+    U ux = Load<U>(a, i);
+    U uy = Load<U>(b, i);
+    F x = std::bit_cast<F>(ux);
+    F y = std::bit_cast<F>(uy);
+    U r;
+    switch (op) {
+      case FpOp::kSgnj: r = (ux & ~kSign) | (uy & kSign);
+        break;
+      case FpOp::kSgnjn: r = (ux & ~kSign) | (~uy & kSign);
+        break;
+      case FpOp::kSgnjx: r = ux ^ (uy & kSign);
+        break;
+      case FpOp::kMin:
+      case FpOp::kMax: {
+        // IEEE 754-2019 minimumNumber/maximumNumber, with -0 below +0.
+        bool is_min = op==FpOp::kMin;
+        if (std::isnan(x) && std::isnan(y)) {
+          r = kCanonicalNan;
+        } else if (std::isnan(x)) {
+          r = uy;
+        } else if (std::isnan(y)) {
+          r = ux;
+        } else if (x==y) {
+          r = is_min ? (ux | uy) : (ux & uy);
+        } else {
+          r = (x < y)==is_min ? ux : uy;
+        }
+        break;
+      }
+      default: {
+        F f = 0;
+        switch (op) {
+          case FpOp::kAdd: f = x + y;
+            break;
+          case FpOp::kSub: f = x - y;
+            break;
+          case FpOp::kRsub: f = y - x;
+            break;
+          case FpOp::kMul: f = x*y;
+            break;
+          case FpOp::kDiv: f = x/y;
+            break;
+          case FpOp::kRdiv: f = y/x;
+            break;
+          case FpOp::kMacc: f = std::fma(x, y, std::bit_cast<F>(Load<U>(out, i)));
+            break;
+          case FpOp::kNmsac: f = std::fma(-x, y, std::bit_cast<F>(Load<U>(out, i)));
+            break;
+          default: break;
+        }
+        r = std::isnan(f) ? kCanonicalNan : std::bit_cast<U>(f);
+        break;
+      }
+    }
+    Store<U>(out, i, r);
+  }
+}
+
+#if defined(__x86_64__)
+
+// Each SIMD routine handles the longest prefix it can in whole registers and returns its length in
+// bytes, or 0 for an operation it has no kernel for; the scalar code finishes the rest.
+
+#define RVV_SSE2_INT_LOOP(expr) { \
+    for (size_t i = 0; i < count; i += 16) { \
+      __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)); \
+      __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)); \
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), (expr)); \
+    } \
+    return count; \
+  }
+
+#define RVV_SSE2_FP_LOOP(vec, elem, suffix, cast, nan_bits, expr) { \
+    const vec nan = cast(nan_bits); \
+    for (size_t i = 0; i < count; i += 16) { \
+      vec x = _mm_loadu_##suffix(reinterpret_cast<const elem *>(a + i)); \
+      vec y = _mm_loadu_##suffix(reinterpret_cast<const elem *>(b + i)); \
+      vec r = (expr); \
+      vec unordered = _mm_cmpunord_##suffix(r, r); \
+      r = _mm_or_##suffix(_mm_andnot_##suffix(unordered, r), _mm_and_##suffix(unordered, nan)); \
+      _mm_storeu_##suffix(reinterpret_cast<elem *>(out + i), r); \
+    } \
+    return count; \
+  }
+
+size_t Sse2Int(IntOp op, unsigned int sew, size_t bytes, const uint8_t *a, const uint8_t *b, uint8_t *out) {
+  const size_t count = bytes & ~size_t(15);
+  switch (op) {
+    case IntOp::kAdd:
+      switch (sew) {
+        case 8: RVV_SSE2_INT_LOOP(_mm_add_epi8(x, y));
+        case 16: RVV_SSE2_INT_LOOP(_mm_add_epi16(x, y));
+        case 32: RVV_SSE2_INT_LOOP(_mm_add_epi32(x, y));
+        default: RVV_SSE2_INT_LOOP(_mm_add_epi64(x, y));
+      }
+    case IntOp::kSub:
+      switch (sew) {
+        case 8: RVV_SSE2_INT_LOOP(_mm_sub_epi8(x, y));
+        case 16: RVV_SSE2_INT_LOOP(_mm_sub_epi16(x, y));
+        case 32: RVV_SSE2_INT_LOOP(_mm_sub_epi32(x, y));
+        default: RVV_SSE2_INT_LOOP(_mm_sub_epi64(x, y));
+      }
+    case IntOp::kRsub:
+      switch (sew) {
+        case 8: RVV_SSE2_INT_LOOP(_mm_sub_epi8(y, x));
+        case 16: RVV_SSE2_INT_LOOP(_mm_sub_epi16(y, x));
+        case 32: RVV_SSE2_INT_LOOP(_mm_sub_epi32(y, x));
+        default: RVV_SSE2_INT_LOOP(_mm_sub_epi64(y, x));
+      }
+    case IntOp::kAnd: RVV_SSE2_INT_LOOP(_mm_and_si128(x, y));
+    case IntOp::kOr: RVV_SSE2_INT_LOOP(_mm_or_si128(x, y));
+    case IntOp::kXor: RVV_SSE2_INT_LOOP(_mm_xor_si128(x, y));
+    case IntOp::kMinu:
+      if (sew==8) RVV_SSE2_INT_LOOP(_mm_min_epu8(x, y));
+      return 0;
+    case IntOp::kMaxu:
+      if (sew==8) RVV_SSE2_INT_LOOP(_mm_max_epu8(x, y));
+      return 0;
+    case IntOp::kMin:
+      if (sew==16) RVV_SSE2_INT_LOOP(_mm_min_epi16(x, y));
+      return 0;
+    case IntOp::kMax:
+      if (sew==16) RVV_SSE2_INT_LOOP(_mm_max_epi16(x, y));
+      return 0;
+    case IntOp::kMul:
+      if (sew==16) RVV_SSE2_INT_LOOP(_mm_mullo_epi16(x, y));
+      return 0;
+    default: return 0;
+  }
+}
+
+size_t Sse2Fp(FpOp op, unsigned int sew, size_t bytes, const uint8_t *a, const uint8_t *b, uint8_t *out) {
+  const size_t count = bytes & ~size_t(15);
+  if (sew==32) {
+    switch (op) {
+      case FpOp::kAdd: RVV_SSE2_FP_LOOP(__m128, float, ps, _mm_castsi128_ps, _mm_set1_epi32(0x7fc00000), _mm_add_ps(x, y));
+      case FpOp::kSub: RVV_SSE2_FP_LOOP(__m128, float, ps, _mm_castsi128_ps, _mm_set1_epi32(0x7fc00000), _mm_sub_ps(x, y));
+      case FpOp::kRsub: RVV_SSE2_FP_LOOP(__m128, float, ps, _mm_castsi128_ps, _mm_set1_epi32(0x7fc00000), _mm_sub_ps(y, x));
+      case FpOp::kMul: RVV_SSE2_FP_LOOP(__m128, float, ps, _mm_castsi128_ps, _mm_set1_epi32(0x7fc00000), _mm_mul_ps(x, y));
+      case FpOp::kDiv: RVV_SSE2_FP_LOOP(__m128, float, ps, _mm_castsi128_ps, _mm_set1_epi32(0x7fc00000), _mm_div_ps(x, y));
+      case FpOp::kRdiv: RVV_SSE2_FP_LOOP(__m128, float, ps, _mm_castsi128_ps, _mm_set1_epi32(0x7fc00000), _mm_div_ps(y, x));
+      default: return 0;
+    }
+  }
+  switch (op) {
+    case FpOp::kAdd: RVV_SSE2_FP_LOOP(__m128d, double, pd, _mm_castsi128_pd, _mm_set1_epi64x(0x7ff8000000000000), _mm_add_pd(x, y));
+    case FpOp::kSub: RVV_SSE2_FP_LOOP(__m128d, double, pd, _mm_castsi128_pd, _mm_set1_epi64x(0x7ff8000000000000), _mm_sub_pd(x, y));
+    case FpOp::kRsub: RVV_SSE2_FP_LOOP(__m128d, double, pd, _mm_castsi128_pd, _mm_set1_epi64x(0x7ff8000000000000), _mm_sub_pd(y, x));
+    case FpOp::kMul: RVV_SSE2_FP_LOOP(__m128d, double, pd, _mm_castsi128_pd, _mm_set1_epi64x(0x7ff8000000000000), _mm_mul_pd(x, y));
+    case FpOp::kDiv: RVV_SSE2_FP_LOOP(__m128d, double, pd, _mm_castsi128_pd, _mm_set1_epi64x(0x7ff8000000000000), _mm_div_pd(x, y));
+    case FpOp::kRdiv: RVV_SSE2_FP_LOOP(__m128d, double, pd, _mm_castsi128_pd, _mm_set1_epi64x(0x7ff8000000000000), _mm_div_pd(y, x));
+    default: return 0;
+  }
+}
+
+#define RVV_AVX2_INT_LOOP(expr) { \
+    for (size_t i = 0; i < count; i += 32) { \
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i)); \
+      __m256i y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i)); \
+      __m256i acc = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(out + i)); \
+      (void)acc; \
+      _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), (expr)); \
+    } \
+    return count; \
+  }
+
+#define RVV_AVX2_FP_LOOP(vec, elem, suffix, cast, nan_bits, expr) { \
+    const vec nan = cast(nan_bits); \
+    for (size_t i = 0; i < count; i += 32) { \
+      vec x = _mm256_loadu_##suffix(reinterpret_cast<const elem *>(a + i)); \
+      vec y = _mm256_loadu_##suffix(reinterpret_cast<const elem *>(b + i)); \
+      vec acc = _mm256_loadu_##suffix(reinterpret_cast<const elem *>(out + i)); \
+      (void)acc; \
+      vec r = (expr); \
+      vec unordered = _mm256_cmp_##suffix(r, r, _CMP_UNORD_Q); \
+      r = _mm256_blendv_##suffix(r, nan, unordered); \
+      _mm256_storeu_##suffix(reinterpret_cast<elem *>(out + i), r); \
+    } \
+    return count; \
+  }
+
+__attribute__((target("avx2,fma")))
+size_t Avx2Int(IntOp op, unsigned int sew, size_t bytes, const uint8_t *a, const uint8_t *b, uint8_t *out) {
+  const size_t count = bytes & ~size_t(31);
+  switch (op) {
+    case IntOp::kAdd:
+      switch (sew) {
+        case 8: RVV_AVX2_INT_LOOP(_mm256_add_epi8(x, y));
+        case 16: RVV_AVX2_INT_LOOP(_mm256_add_epi16(x, y));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_add_epi32(x, y));
+        default: RVV_AVX2_INT_LOOP(_mm256_add_epi64(x, y));
+      }
+    case IntOp::kSub:
+      switch (sew) {
+        case 8: RVV_AVX2_INT_LOOP(_mm256_sub_epi8(x, y));
+        case 16: RVV_AVX2_INT_LOOP(_mm256_sub_epi16(x, y));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_sub_epi32(x, y));
+        default: RVV_AVX2_INT_LOOP(_mm256_sub_epi64(x, y));
+      }
+    case IntOp::kRsub:
+      switch (sew) {
+        case 8: RVV_AVX2_INT_LOOP(_mm256_sub_epi8(y, x));
+        case 16: RVV_AVX2_INT_LOOP(_mm256_sub_epi16(y, x));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_sub_epi32(y, x));
+        default: RVV_AVX2_INT_LOOP(_mm256_sub_epi64(y, x));
+      }
+    case IntOp::kAnd: RVV_AVX2_INT_LOOP(_mm256_and_si256(x, y));
+    case IntOp::kOr: RVV_AVX2_INT_LOOP(_mm256_or_si256(x, y));
+    case IntOp::kXor: RVV_AVX2_INT_LOOP(_mm256_xor_si256(x, y));
+    case IntOp::kMinu:
+      switch (sew) {
+        case 8: RVV_AVX2_INT_LOOP(_mm256_min_epu8(x, y));
+        case 16: RVV_AVX2_INT_LOOP(_mm256_min_epu16(x, y));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_min_epu32(x, y));
+        default: return 0;
+      }
+    case IntOp::kMin:
+      switch (sew) {
+        case 8: RVV_AVX2_INT_LOOP(_mm256_min_epi8(x, y));
+        case 16: RVV_AVX2_INT_LOOP(_mm256_min_epi16(x, y));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_min_epi32(x, y));
+        default: return 0;
+      }
+    case IntOp::kMaxu:
+      switch (sew) {
+        case 8: RVV_AVX2_INT_LOOP(_mm256_max_epu8(x, y));
+        case 16: RVV_AVX2_INT_LOOP(_mm256_max_epu16(x, y));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_max_epu32(x, y));
+        default: return 0;
+      }
+    case IntOp::kMax:
+      switch (sew) {
+        case 8: RVV_AVX2_INT_LOOP(_mm256_max_epi8(x, y));
+        case 16: RVV_AVX2_INT_LOOP(_mm256_max_epi16(x, y));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_max_epi32(x, y));
+        default: return 0;
+      }
+    case IntOp::kMul:
+      switch (sew) {
+        case 16: RVV_AVX2_INT_LOOP(_mm256_mullo_epi16(x, y));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_mullo_epi32(x, y));
+        default: return 0;
+      }
+    case IntOp::kMacc:
+      switch (sew) {
+        case 16: RVV_AVX2_INT_LOOP(_mm256_add_epi16(acc, _mm256_mullo_epi16(x, y)));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_add_epi32(acc, _mm256_mullo_epi32(x, y)));
+        default: return 0;
+      }
+    case IntOp::kNmsac:
+      switch (sew) {
+        case 16: RVV_AVX2_INT_LOOP(_mm256_sub_epi16(acc, _mm256_mullo_epi16(x, y)));
+        case 32: RVV_AVX2_INT_LOOP(_mm256_sub_epi32(acc, _mm256_mullo_epi32(x, y)));
+        default: return 0;
+      }
+    default: return 0;
+  }
+}
+
+__attribute__((target("avx2,fma")))
+size_t Avx2Fp(FpOp op, unsigned int sew, size_t bytes, const uint8_t *a, const uint8_t *b, uint8_t *out) {
+  const size_t count = bytes & ~size_t(31);
+  if (sew==32) {
+    switch (op) {
+      case FpOp::kAdd: RVV_AVX2_FP_LOOP(__m256, float, ps, _mm256_castsi256_ps, _mm256_set1_epi32(0x7fc00000), _mm256_add_ps(x, y));
+      case FpOp::kSub: RVV_AVX2_FP_LOOP(__m256, float, ps, _mm256_castsi256_ps, _mm256_set1_epi32(0x7fc00000), _mm256_sub_ps(x, y));
+      case FpOp::kRsub: RVV_AVX2_FP_LOOP(__m256, float, ps, _mm256_castsi256_ps, _mm256_set1_epi32(0x7fc00000), _mm256_sub_ps(y, x));
+      case FpOp::kMul: RVV_AVX2_FP_LOOP(__m256, float, ps, _mm256_castsi256_ps, _mm256_set1_epi32(0x7fc00000), _mm256_mul_ps(x, y));
+      case FpOp::kDiv: RVV_AVX2_FP_LOOP(__m256, float, ps, _mm256_castsi256_ps, _mm256_set1_epi32(0x7fc00000), _mm256_div_ps(x, y));
+      case FpOp::kRdiv: RVV_AVX2_FP_LOOP(__m256, float, ps, _mm256_castsi256_ps, _mm256_set1_epi32(0x7fc00000), _mm256_div_ps(y, x));
+      case FpOp::kMacc: RVV_AVX2_FP_LOOP(__m256, float, ps, _mm256_castsi256_ps, _mm256_set1_epi32(0x7fc00000), _mm256_fmadd_ps(x, y, acc));
+      case FpOp::kNmsac: RVV_AVX2_FP_LOOP(__m256, float, ps, _mm256_castsi256_ps, _mm256_set1_epi32(0x7fc00000), _mm256_fnmadd_ps(x, y, acc));
+      default: return 0;
+    }
+  }
+  switch (op) {
+    case FpOp::kAdd: RVV_AVX2_FP_LOOP(__m256d, double, pd, _mm256_castsi256_pd, _mm256_set1_epi64x(0x7ff8000000000000), _mm256_add_pd(x, y));
+    case FpOp::kSub: RVV_AVX2_FP_LOOP(__m256d, double, pd, _mm256_castsi256_pd, _mm256_set1_epi64x(0x7ff8000000000000), _mm256_sub_pd(x, y));
+    case FpOp::kRsub: RVV_AVX2_FP_LOOP(__m256d, double, pd, _mm256_castsi256_pd, _mm256_set1_epi64x(0x7ff8000000000000), _mm256_sub_pd(y, x));
+    case FpOp::kMul: RVV_AVX2_FP_LOOP(__m256d, double, pd, _mm256_castsi256_pd, _mm256_set1_epi64x(0x7ff8000000000000), _mm256_mul_pd(x, y));
+    case FpOp::kDiv: RVV_AVX2_FP_LOOP(__m256d, double, pd, _mm256_castsi256_pd, _mm256_set1_epi64x(0x7ff8000000000000), _mm256_div_pd(x, y));
+    case FpOp::kRdiv: RVV_AVX2_FP_LOOP(__m256d, double, pd, _mm256_castsi256_pd, _mm256_set1_epi64x(0x7ff8000000000000), _mm256_div_pd(y, x));
+    case FpOp::kMacc: RVV_AVX2_FP_LOOP(__m256d, double, pd, _mm256_castsi256_pd, _mm256_set1_epi64x(0x7ff8000000000000), _mm256_fmadd_pd(x, y, acc));
+    case FpOp::kNmsac: RVV_AVX2_FP_LOOP(__m256d, double, pd, _mm256_castsi256_pd, _mm256_set1_epi64x(0x7ff8000000000000), _mm256_fnmadd_pd(x, y, acc));
+    default: return 0;
+  }
+}
+
+#endif // __x86_64__
+
+} // namespace
+
+HostIsa DetectHostIsa() {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return HostIsa::kAvx2;
+  }
+  return HostIsa::kSse2;
+#else
+  return HostIsa::kScalar;
+#endif
+}
+
+std::string HostIsaName(HostIsa isa) {
+  switch (isa) {
+    case HostIsa::kAvx2: return "avx2";
+    case HostIsa::kSse2: return "sse2";
+    default: return "scalar";
+  }
+}
+
+void IntKernel(HostIsa isa, IntOp op, unsigned int sew, size_t n, const uint8_t *a, const uint8_t *b, uint8_t *out) {
+  const size_t element_bytes = sew/8;
+  size_t done = 0;
+#if defined(__x86_64__)
+  const size_t bytes = n*element_bytes;
+  if (isa==HostIsa::kAvx2) {
+    done = Avx2Int(op, sew, bytes, a, b, out);
+  }
+  if (isa!=HostIsa::kScalar) {
+    done += Sse2Int(op, sew, bytes - done, a + done, b + done, out + done);
+  }
+#else
+  (void)isa;
+#endif
+  switch (sew) {
+    case 8: ScalarInt<uint8_t>(op, done/element_bytes, n, a, b, out);
+      break;
+    case 16: ScalarInt<uint16_t>(op, done/element_bytes, n, a, b, out);
+      break;
+    case 32: ScalarInt<uint32_t>(op, done/element_bytes, n, a, b, out);
+      break;
+    default: ScalarInt<uint64_t>(op, done/element_bytes, n, a, b, out);
+      break;
+  }
+}
+
+void FpKernel(HostIsa isa, FpOp op, unsigned int sew, size_t n, const uint8_t *a, const uint8_t *b, uint8_t *out) {
+  const size_t element_bytes = sew/8;
+  size_t done = 0;
+#if defined(__x86_64__)
+  const size_t bytes = n*element_bytes;
+  if (isa==HostIsa::kAvx2) {
+    done = Avx2Fp(op, sew, bytes, a, b, out);
+  }
+  if (isa!=HostIsa::kScalar) {
+    done += Sse2Fp(op, sew, bytes - done, a + done, b + done, out + done);
+  }
+#else
+  (void)isa;
+#endif
+  if (sew==32) {
+    ScalarFp<float, uint32_t>(op, done/element_bytes, n, a, b, out);
+  } else {
+    ScalarFp<double, uint64_t>(op, done/element_bytes, n, a, b, out);
+  }
+}
+
+} // namespace rvv
@@ -0,0 +1,837 @@
+/**
+ * @file vector_unit.cpp
+ * @brief Contains the implementation of the VectorUnit class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/vector/vector_unit.h"
+#include "vm/rvss/rvss_vm.h"
+#include "vm/registers.h"
+#include "vm/memory_controller.h"
+#include "common/vtype.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace rvv {
+
+namespace {
+
+constexpr uint32_t kOpcodeOpV = 0b1010111;
+constexpr uint32_t kOpcodeLoadFp = 0b0000111;
+
+// funct3 of OP-V.
+constexpr uint32_t kOpIvv = 0b000;
+constexpr uint32_t kOpFvv = 0b001;
+constexpr uint32_t kOpMvv = 0b010;
+constexpr uint32_t kOpIvi = 0b011;
+constexpr uint32_t kOpIvx = 0b100;
+constexpr uint32_t kOpFvf = 0b101;
+constexpr uint32_t kOpMvx = 0b110;
+constexpr uint32_t kOpCfg = 0b111;
+
+constexpr unsigned int kElen = 64;
+constexpr unsigned int kNumVectorRegisters = 32;
+constexpr uint64_t kCanonicalNanF = 0x7FC00000;
+
+[[noreturn]] void Illegal(uint32_t instruction, const std::string &reason) {
+  std::ostringstream message;
+  message << "Illegal vector instruction 0x" << std::hex << std::setw(8) << std::setfill('0') << instruction
+          << ": " << reason;
+  throw std::runtime_error(message.str());
+}
+
+uint64_t ReadElement(const uint8_t *base, size_t index, unsigned int bytes) {
+  uint64_t value = 0;
+  std::memcpy(&value, base + index*bytes, bytes);
+  return value;
+}
+
+void WriteElement(uint8_t *base, size_t index, unsigned int bytes, uint64_t value) {
+  std::memcpy(base + index*bytes, &value, bytes);
+}
+
+int64_t SignExtend(uint64_t value, unsigned int bits) {
+  if (bits >= 64) {
+    return static_cast<int64_t>(value);
+  }
+  unsigned int shift = 64 - bits;
+  return static_cast<int64_t>(value << shift) >> shift;
+}
+
+uint64_t Truncate(uint64_t value, unsigned int bits) {
+  return bits >= 64 ? value : value & ((1ULL << bits) - 1);
+}
+
+bool MaskBit(const uint8_t *mask, size_t index) {
+  return (mask[index/8] >> (index%8)) & 1;
+}
+
+void SetMaskBit(uint8_t *mask, size_t index, bool value) {
+  if (value) {
+    mask[index/8] |= static_cast<uint8_t>(1u << (index%8));
+  } else {
+    mask[index/8] &= static_cast<uint8_t>(~(1u << (index%8)));
+  }
+}
+
+/**
+ * @brief SEW, LMUL and VLMAX of a vtype, or false if vtype is reserved for this VLEN.
+ */
+bool DecodeVtype(uint64_t vtype, size_t vlenb, unsigned int &sew, unsigned int &lmul_num,
+                 unsigned int &lmul_den, uint64_t &vlmax) {
+  if (vtype & ~uint64_t{0xFF}) {
+    return false;
+  }
+  sew = vtypeSew(vtype);
+  if (sew==0 || !vtypeLmul(vtype, lmul_num, lmul_den)) {
+    return false;
+  }
+  if (lmul_den > 1 && sew*lmul_den > kElen) {
+    return false;
+  }
+  vlmax = (vlenb*8*lmul_num)/(static_cast<uint64_t>(lmul_den)*sew);
+  return vlmax > 0;
+}
+
+void WriteGprRecorded(RegisterFile &registers, StepDelta &delta, unsigned int reg, uint64_t value) {
+  if (reg==0) {
+    return;
+  }
+  uint64_t old_value = registers.ReadGpr(reg);
+  registers.WriteGpr(reg, value);
+  if (old_value!=value) {
+    delta.register_changes.push_back({reg, 0, old_value, value});
+  }
+}
+
+void WriteFprRecorded(RegisterFile &registers, StepDelta &delta, unsigned int reg, uint64_t value) {
+  uint64_t old_value = registers.ReadFpr(reg);
+  registers.WriteFpr(reg, value);
+  if (old_value!=value) {
+    delta.register_changes.push_back({reg, 2, old_value, value});
+  }
+}
+
+void WriteCsrRecorded(RegisterFile &registers, StepDelta &delta, unsigned int csr, uint64_t value) {
+  uint64_t old_value = registers.ReadCsr(csr);
+  registers.WriteCsr(csr, value);
+  if (old_value!=value) {
+    delta.register_changes.push_back({csr, 1, old_value, value});
+  }
+}
+
+// vtype and vl as the executing instruction sees them.
+struct VectorState {
+  unsigned int sew = 0;        ///< Element width in bits.
+  unsigned int sew_bytes = 0;
+  unsigned int lmul_num = 1;
+  unsigned int lmul_den = 1;
+  unsigned int group = 1;      ///< Registers per operand: LMUL, or 1 if fractional.
+  uint64_t vl = 0;
+  size_t vlenb = 0;
+};
+
+VectorState CurrentState(uint32_t instruction, const RegisterFile &registers) {
+  VectorState state;
+  state.vlenb = registers.GetVlenb();
+  uint64_t vtype = registers.ReadCsr(kCsrVtype);
+  uint64_t vlmax = 0;
+  if (vtype & kVtypeVill) {
+    Illegal(instruction, "vtype is illegal; configure it with vsetvli first");
+  }
+  if (!DecodeVtype(vtype, state.vlenb, state.sew, state.lmul_num, state.lmul_den, vlmax)) {
+    Illegal(instruction, "vtype holds a reserved value");
+  }
+  if (registers.ReadCsr(kCsrVstart)!=0) {
+    Illegal(instruction, "a non-zero vstart is not supported");
+  }
+  state.sew_bytes = state.sew/8;
+  state.group = state.lmul_den > 1 ? 1 : state.lmul_num;
+  state.vl = std::min(registers.ReadCsr(kCsrVl), vlmax);
+  return state;
+}
+
+void CheckGroup(uint32_t instruction, unsigned int reg, unsigned int group) {
+  if (reg%group!=0 || reg + group > kNumVectorRegisters) {
+    Illegal(instruction, "v" + std::to_string(reg) + " does not start a group of " + std::to_string(group)
+        + " registers");
+  }
+}
+
+} // namespace
+
+VectorUnit::VectorUnit() : detected_(DetectHostIsa()), isa_(detected_) {}
+
+void VectorUnit::SetHostSimd(bool enabled) {
+  isa_ = enabled ? detected_ : HostIsa::kScalar;
+}
+
+void VectorUnit::Execute(uint32_t instruction, RegisterFile &registers, MemoryController &memory, StepDelta &delta) {
+  uint32_t opcode = instruction & 0b1111111;
+  if (opcode==kOpcodeOpV) {
+    if (((instruction >> 12) & 0b111)==kOpCfg) {
+      ExecuteConfig(instruction, registers, delta);
+    } else {
+      ExecuteArithmetic(instruction, registers, delta);
+    }
+    return;
+  }
+  ExecuteMemory(instruction, registers, memory, delta);
+}
+
+void VectorUnit::ExecuteConfig(uint32_t instruction, RegisterFile &registers, StepDelta &delta) {
+  unsigned int rd = (instruction >> 7) & 0b11111;
+  unsigned int rs1 = (instruction >> 15) & 0b11111;
+  unsigned int rs2 = (instruction >> 20) & 0b11111;
+
+  uint64_t vtype;
+  bool immediate_avl = false;
+  if (((instruction >> 31) & 1)==0) { // vsetvli
+    vtype = (instruction >> 20) & 0x7FF;
+  } else if (((instruction >> 30) & 0b11)==0b11) { // vsetivli
+    vtype = (instruction >> 20) & 0x3FF;
+    immediate_avl = true;
+  } else if (((instruction >> 25) & 0b1111111)==0b1000000) { // vsetvl
+    vtype = registers.ReadGpr(rs2);
+  } else {
+    Illegal(instruction, "reserved vset encoding");
+  }
+
+  size_t vlenb = registers.GetVlenb();
+  unsigned int sew = 0;
+  unsigned int lmul_num = 1;
+  unsigned int lmul_den = 1;
+  uint64_t vlmax = 0;
+  uint64_t vl = 0;
+  if (!DecodeVtype(vtype, vlenb, sew, lmul_num, lmul_den, vlmax)) {
+    vtype = kVtypeVill;
+  } else if (immediate_avl) {
+    vl = std::min<uint64_t>(rs1, vlmax);
+  } else if (rs1!=0) {
+    vl = std::min(registers.ReadGpr(rs1), vlmax);
+  } else if (rd!=0) {
+    vl = vlmax;
+  } else {
+    // rd = rs1 = x0 keeps vl, which only makes sense when VLMAX does not shrink below it.
+    vl = std::min(registers.ReadCsr(kCsrVl), vlmax);
+  }
+
+  WriteCsrRecorded(registers, delta, kCsrVtype, vtype);
+  WriteCsrRecorded(registers, delta, kCsrVl, vl);
+  WriteCsrRecorded(registers, delta, kCsrVstart, 0);
+  WriteGprRecorded(registers, delta, rd, vl);
+}
+
+void VectorUnit::ExecuteMemory(uint32_t instruction, RegisterFile &registers, MemoryController &memory,
+                               StepDelta &delta) {
+  bool is_load = (instruction & 0b1111111)==kOpcodeLoadFp;
+  unsigned int vd = (instruction >> 7) & 0b11111;
+  unsigned int width = (instruction >> 12) & 0b111;
+  unsigned int rs1 = (instruction >> 15) & 0b11111;
+  unsigned int rs2 = (instruction >> 20) & 0b11111;
+  bool unmasked = (instruction >> 25) & 1;
+  unsigned int mop = (instruction >> 26) & 0b11;
+  unsigned int mew = (instruction >> 28) & 1;
+  unsigned int nf = (instruction >> 29) & 0b111;
+
+  if (nf!=0 || mew!=0) {
+    Illegal(instruction, "segment and 128-bit element accesses are not supported");
+  }
+  if (mop==0b01 || mop==0b11) {
+    Illegal(instruction, "indexed accesses are not supported");
+  }
+  if (mop==0b00 && rs2!=0) {
+    Illegal(instruction, "only the plain unit-stride form is supported");
+  }
+
+  VectorState state = CurrentState(instruction, registers);
+  unsigned int eew = width==0 ? 8 : 8u << (width - 4);
+  unsigned int eew_bytes = eew/8;
+
+  // EMUL = EEW/SEW * LMUL, which must stay within [1/8, 8].
+  uint64_t emul_num = static_cast<uint64_t>(eew)*state.lmul_num;
+  uint64_t emul_den = static_cast<uint64_t>(state.sew)*state.lmul_den;
+  if (emul_num > 8*emul_den || 8*emul_num < emul_den) {
+    Illegal(instruction, "EEW/SEW * LMUL is out of range");
+  }
+  unsigned int group = emul_num > emul_den ? static_cast<unsigned int>(emul_num/emul_den) : 1;
+  CheckGroup(instruction, vd, group);
+  if (is_load && !unmasked && vd==0) {
+    Illegal(instruction, "a masked load cannot write v0");
+  }
+
+  uint8_t *data = registers.VectorData();
+  const uint8_t *mask = data;
+  uint8_t *vd_data = data + vd*state.vlenb;
+  uint64_t base = registers.ReadGpr(rs1);
+  uint64_t stride = mop==0b10 ? registers.ReadGpr(rs2) : eew_bytes;
+  auto active = [&](size_t i) {
+    return unmasked || MaskBit(mask, i);
+  };
+
+  if (is_load) {
+    // Load into scratch space first so a fault leaves the registers untouched.
+    size_t group_bytes = group*state.vlenb;
+    result_.assign(vd_data, vd_data + group_bytes);
+    for (size_t i = 0; i < state.vl; ++i) {
+      if (!active(i)) {
+        continue;
+      }
+      uint64_t address = base + i*stride;
+      uint64_t value;
+      switch (eew) {
+        case 8: value = memory.ReadByte(address);
+          break;
+        case 16: value = memory.ReadHalfWord(address);
+          break;
+        case 32: value = memory.ReadWord(address);
+          break;
+        default: value = memory.ReadDoubleWord(address);
+          break;
+      }
+      WriteElement(result_.data(), i, eew_bytes, value);
+    }
+    saved_.assign(vd_data, vd_data + group_bytes);
+    std::memcpy(vd_data, result_.data(), group_bytes);
+    for (size_t offset = 0; offset < group_bytes; offset += 8) {
+      uint64_t old_value;
+      uint64_t new_value;
+      std::memcpy(&old_value, saved_.data() + offset, 8);
+      std::memcpy(&new_value, vd_data + offset, 8);
+      if (old_value!=new_value) {
+        delta.register_changes.push_back({static_cast<unsigned int>((vd*state.vlenb + offset)/8), 3, old_value, new_value});
+      }
+    }
+    return;
+  }
+
+  // Stores: read every old value before writing anything, so an out-of-range element throws
+  // before memory changes.
+  std::vector<uint64_t> addresses;
+  std::vector<std::vector<uint8_t>> old_bytes;
+  for (size_t i = 0; i < state.vl; ++i) {
+    if (!active(i)) {
+      continue;
+    }
+    addresses.push_back(base + i*stride);
+    old_bytes.emplace_back(eew_bytes);
+    memory.ReadBlock(addresses.back(), old_bytes.back());
+  }
+  for (size_t k = 0, i = 0; i < state.vl; ++i) {
+    if (!active(i)) {
+      continue;
+    }
+    uint64_t value = ReadElement(vd_data, i, eew_bytes);
+    switch (eew) {
+      case 8: memory.WriteByte(addresses[k], static_cast<uint8_t>(value));
+        break;
+      case 16: memory.WriteHalfWord(addresses[k], static_cast<uint16_t>(value));
+        break;
+      case 32: memory.WriteWord(addresses[k], static_cast<uint32_t>(value));
+        break;
+      default: memory.WriteDoubleWord(addresses[k], value);
+        break;
+    }
+    std::vector<uint8_t> new_bytes(eew_bytes);
+    std::memcpy(new_bytes.data(), &value, eew_bytes);
+    if (new_bytes!=old_bytes[k]) {
+      delta.memory_changes.push_back({addresses[k], std::move(old_bytes[k]), std::move(new_bytes)});
+    }
+    ++k;
+  }
+}
+
+void VectorUnit::ExecuteArithmetic(uint32_t instruction, RegisterFile &registers, StepDelta &delta) {
+  unsigned int funct3 = (instruction >> 12) & 0b111;
+  unsigned int funct6 = (instruction >> 26) & 0b111111;
+  bool unmasked = (instruction >> 25) & 1;
+  unsigned int vd = (instruction >> 7) & 0b11111;
+  unsigned int rs1 = (instruction >> 15) & 0b11111;
+  unsigned int vs2 = (instruction >> 20) & 0b11111;
+
+  VectorState state = CurrentState(instruction, registers);
+  const unsigned int sew = state.sew;
+  const unsigned int sew_bytes = state.sew_bytes;
+  const size_t vl = state.vl;
+  const size_t vlenb = state.vlenb;
+  const size_t group_bytes = state.group*vlenb;
+
+  uint8_t *data = registers.VectorData();
+  const uint8_t *mask = data;
+  auto reg = [&](unsigned int r) {
+    return data + r*vlenb;
+  };
+  auto active = [&](size_t i) {
+    return unmasked || MaskBit(mask, i);
+  };
+
+  bool is_fp = funct3==kOpFvv || funct3==kOpFvf;
+  if (is_fp && sew!=32 && sew!=64) {
+    Illegal(instruction, "vector floating point needs SEW of 32 or 64");
+  }
+
+  // The second operand: vs1, or the scalar splatted across vl elements.
+  bool vector_operand = funct3==kOpIvv || funct3==kOpFvv || funct3==kOpMvv;
+  uint64_t scalar = 0;
+  switch (funct3) {
+    case kOpIvx:
+    case kOpMvx: scalar = Truncate(registers.ReadGpr(rs1), sew);
+      break;
+    case kOpIvi: {
+      // Shift amounts are unsigned; every other immediate is simm5.
+      bool is_shift = funct6==0b100101 || funct6==0b101000 || funct6==0b101001;
+      scalar = Truncate(is_shift ? rs1 : static_cast<uint64_t>(SignExtend(rs1, 5)), sew);
+      break;
+    }
+    case kOpFvf: {
+      uint64_t value = registers.ReadFpr(rs1);
+      if (sew==32) {
+        // Single-precision values are NaN-boxed in the 64-bit FPRs.
+        value = (value >> 32)==0xFFFFFFFF ? value & 0xFFFFFFFF : kCanonicalNanF;
+      }
+      scalar = value;
+      break;
+    }
+    default: break;
+  }
+  const uint8_t *operand = reg(rs1);
+  if (!vector_operand) {
+    operand_.resize(std::max<size_t>(group_bytes, vl*sew_bytes));
+    for (size_t i = 0; i < vl; ++i) {
+      WriteElement(operand_.data(), i, sew_bytes, scalar);
+    }
+    operand = operand_.data();
+  }
+
+  // Commits result_ to the vd group: every element below vl when ignore_mask is set (merges and
+  // moves), otherwise the active ones.
+  auto commit_group = [&](bool ignore_mask) {
+    CheckGroup(instruction, vd, state.group);
+    if (!unmasked && vd==0) {
+      Illegal(instruction, "a masked instruction cannot write v0");
+    }
+    uint8_t *vd_data = reg(vd);
+    saved_.assign(vd_data, vd_data + group_bytes);
+    for (size_t i = 0; i < vl; ++i) {
+      if (ignore_mask || active(i)) {
+        WriteElement(vd_data, i, sew_bytes, ReadElement(result_.data(), i, sew_bytes));
+      }
+    }
+    for (size_t offset = 0; offset < group_bytes; offset += 8) {
+      uint64_t old_value;
+      uint64_t new_value;
+      std::memcpy(&old_value, saved_.data() + offset, 8);
+      std::memcpy(&new_value, vd_data + offset, 8);
+      if (old_value!=new_value) {
+        delta.register_changes.push_back({static_cast<unsigned int>((vd*vlenb + offset)/8), 3, old_value, new_value});
+      }
+    }
+  };
+  // Writes a single register (a mask or a scalar element) from result_, given which bytes changed.
+  auto commit_register = [&](const std::vector<uint8_t> &new_bytes) {
+    uint8_t *vd_data = reg(vd);
+    for (size_t offset = 0; offset < vlenb; offset += 8) {
+      uint64_t old_value;
+      uint64_t new_value;
+      std::memcpy(&old_value, vd_data + offset, 8);
+      std::memcpy(&new_value, new_bytes.data() + offset, 8);
+      if (old_value!=new_value) {
+        delta.register_changes.push_back({static_cast<unsigned int>((vd*vlenb + offset)/8), 3, old_value, new_value});
+      }
+    }
+    std::memcpy(vd_data, new_bytes.data(), vlenb);
+  };
+  auto check_sources = [&]() {
+    CheckGroup(instruction, vs2, state.group);
+    if (vector_operand) {
+      CheckGroup(instruction, rs1, state.group);
+    }
+  };
+  auto run_int = [&](IntOp op) {
+    check_sources();
+    result_.resize(std::max<size_t>(group_bytes, vl*sew_bytes));
+    if (op==IntOp::kMacc || op==IntOp::kNmsac) {
+      CheckGroup(instruction, vd, state.group);
+      std::memcpy(result_.data(), reg(vd), vl*sew_bytes);
+    }
+    IntKernel(isa_, op, sew, vl, reg(vs2), operand, result_.data());
+    commit_group(false);
+  };
+  auto run_fp = [&](FpOp op) {
+    check_sources();
+    result_.resize(std::max<size_t>(group_bytes, vl*sew_bytes));
+    if (op==FpOp::kMacc || op==FpOp::kNmsac) {
+      CheckGroup(instruction, vd, state.group);
+      std::memcpy(result_.data(), reg(vd), vl*sew_bytes);
+    }
+    FpKernel(isa_, op, sew, vl, reg(vs2), operand, result_.data());
+    commit_group(false);
+  };
+  // Compares write one mask bit per active element into vd.
+  auto run_compare = [&](auto compare) {
+    check_sources();
+    std::vector<uint8_t> bits(reg(vd), reg(vd) + vlenb);
+    for (size_t i = 0; i < vl; ++i) {
+      if (active(i)) {
+        SetMaskBit(bits.data(), i, compare(ReadElement(reg(vs2), i, sew_bytes), ReadElement(operand, i, sew_bytes)));
+      }
+    }
+    commit_register(bits);
+  };
+  auto run_int_reduction = [&](IntOp op) {
+    CheckGroup(instruction, vs2, state.group);
+    uint64_t accumulator = ReadElement(reg(rs1), 0, sew_bytes);
+    for (size_t i = 0; i < vl; ++i) {
+      if (active(i)) {
+        uint64_t element = ReadElement(reg(vs2), i, sew_bytes);
+        IntKernel(HostIsa::kScalar, op, sew, 1, reinterpret_cast<const uint8_t *>(&accumulator),
+                  reinterpret_cast<const uint8_t *>(&element), reinterpret_cast<uint8_t *>(&accumulator));
+      }
+    }
+    if (vl > 0) {
+      std::vector<uint8_t> bytes(reg(vd), reg(vd) + vlenb);
+      WriteElement(bytes.data(), 0, sew_bytes, accumulator);
+      commit_register(bytes);
+    }
+  };
+  auto run_fp_reduction = [&](FpOp op) {
+    CheckGroup(instruction, vs2, state.group);
+    uint64_t accumulator = ReadElement(reg(rs1), 0, sew_bytes);
+    for (size_t i = 0; i < vl; ++i) {
+      if (active(i)) {
+        uint64_t element = ReadElement(reg(vs2), i, sew_bytes);
+        FpKernel(HostIsa::kScalar, op, sew, 1, reinterpret_cast<const uint8_t *>(&accumulator),
+                 reinterpret_cast<const uint8_t *>(&element), reinterpret_cast<uint8_t *>(&accumulator));
+      }
+    }
+    if (vl > 0) {
+      std::vector<uint8_t> bytes(reg(vd), reg(vd) + vlenb);
+      WriteElement(bytes.data(), 0, sew_bytes, accumulator);
+      commit_register(bytes);
+    }
+  };
+  // vmerge (masked) and vmv.v (unmasked) share an encoding.
+  auto run_merge = [&]() {
+    if (unmasked && vs2!=0) {
+      Illegal(instruction, "vmv.v.* needs vs2 = v0");
+    }
+    if (!unmasked) {
+      CheckGroup(instruction, vs2, state.group);
+    }
+    if (vector_operand) {
+      CheckGroup(instruction, rs1, state.group);
+    }
+    result_.resize(std::max<size_t>(group_bytes, vl*sew_bytes));
+    for (size_t i = 0; i < vl; ++i) {
+      bool take_operand = unmasked || MaskBit(mask, i);
+      uint64_t value = take_operand ? ReadElement(operand, i, sew_bytes) : ReadElement(reg(vs2), i, sew_bytes);
+      WriteElement(result_.data(), i, sew_bytes, value);
+    }
+    commit_group(true);
+  };
+  auto signed_value = [sew](uint64_t value) {
+    return SignExtend(value, sew);
+  };
+
+  if (funct3==kOpIvv || funct3==kOpIvx || funct3==kOpIvi) {
+    bool is_vv = funct3==kOpIvv;
+    bool is_vi = funct3==kOpIvi;
+    switch (funct6) {
+      case 0b000000: return run_int(IntOp::kAdd);
+      case 0b000010:
+        if (!is_vi) {
+          return run_int(IntOp::kSub);
+        }
+        break;
+      case 0b000011:
+        if (!is_vv) {
+          return run_int(IntOp::kRsub);
+        }
+        break;
+      case 0b000100:
+        if (!is_vi) {
+          return run_int(IntOp::kMinu);
+        }
+        break;
+      case 0b000101:
+        if (!is_vi) {
+          return run_int(IntOp::kMin);
+        }
+        break;
+      case 0b000110:
+        if (!is_vi) {
+          return run_int(IntOp::kMaxu);
+        }
+        break;
+      case 0b000111:
+        if (!is_vi) {
+          return run_int(IntOp::kMax);
+        }
+        break;
+      case 0b001001: return run_int(IntOp::kAnd);
+      case 0b001010: return run_int(IntOp::kOr);
+      case 0b001011: return run_int(IntOp::kXor);
+      case 0b100101: return run_int(IntOp::kSll);
+      case 0b101000: return run_int(IntOp::kSrl);
+      case 0b101001: return run_int(IntOp::kSra);
+      case 0b010111: return run_merge();
+      case 0b011000: return run_compare([](uint64_t a, uint64_t b) { return a==b; });
+      case 0b011001: return run_compare([](uint64_t a, uint64_t b) { return a!=b; });
+      case 0b011010:
+        if (!is_vi) {
+          return run_compare([](uint64_t a, uint64_t b) { return a < b; });
+        }
+        break;
+      case 0b011011:
+        if (!is_vi) {
+          return run_compare([&](uint64_t a, uint64_t b) { return signed_value(a) < signed_value(b); });
+        }
+        break;
+      case 0b011100: return run_compare([](uint64_t a, uint64_t b) { return a <= b; });
+      case 0b011101: return run_compare([&](uint64_t a, uint64_t b) { return signed_value(a) <= signed_value(b); });
+      case 0b011110:
+        if (!is_vv) {
+          return run_compare([](uint64_t a, uint64_t b) { return a > b; });
+        }
+        break;
+      case 0b011111:
+        if (!is_vv) {
+          return run_compare([&](uint64_t a, uint64_t b) { return signed_value(a) > signed_value(b); });
+        }
+        break;
+      default: break;
+    }
+    Illegal(instruction, "unsupported integer operation");
+  }
+
+  if (funct3==kOpMvv || funct3==kOpMvx) {
+    bool is_vv = funct3==kOpMvv;
+    if (is_vv && funct6 <= 0b000111) {
+      static constexpr IntOp kReductions[] = {IntOp::kAdd, IntOp::kAnd, IntOp::kOr, IntOp::kXor,
+                                              IntOp::kMinu, IntOp::kMin, IntOp::kMaxu, IntOp::kMax};
+      return run_int_reduction(kReductions[funct6]);
+    }
+    switch (funct6) {
+      case 0b010000:
+        if (!is_vv) {
+          // vmv.s.x
+          if (!unmasked || vs2!=0) {
+            break;
+          }
+          if (vl > 0) {
+            std::vector<uint8_t> bytes(reg(vd), reg(vd) + vlenb);
+            WriteElement(bytes.data(), 0, sew_bytes, scalar);
+            commit_register(bytes);
+          }
+          return;
+        }
+        if (rs1==0b00000 && unmasked) {
+          // vmv.x.s
+          WriteGprRecorded(registers, delta, vd, static_cast<uint64_t>(signed_value(ReadElement(reg(vs2), 0, sew_bytes))));
+          return;
+        }
+        if (rs1==0b10000) {
+          // vcpop.m
+          uint64_t count = 0;
+          for (size_t i = 0; i < vl; ++i) {
+            count += active(i) && MaskBit(reg(vs2), i);
+          }
+          WriteGprRecorded(registers, delta, vd, count);
+          return;
+        }
+        if (rs1==0b10001) {
+          // vfirst.m
+          int64_t first = -1;
+          for (size_t i = 0; i < vl; ++i) {
+            if (active(i) && MaskBit(reg(vs2), i)) {
+              first = static_cast<int64_t>(i);
+              break;
+            }
+          }
+          WriteGprRecorded(registers, delta, vd, static_cast<uint64_t>(first));
+          return;
+        }
+        break;
+      case 0b010100:
+        if (is_vv && rs1==0b10001 && vs2==0) {
+          // vid.v
+          result_.resize(std::max<size_t>(group_bytes, vl*sew_bytes));
+          for (size_t i = 0; i < vl; ++i) {
+            WriteElement(result_.data(), i, sew_bytes, Truncate(i, sew));
+          }
+          return commit_group(false);
+        }
+        break;
+      case 0b011000:
+      case 0b011001:
+      case 0b011010:
+      case 0b011011:
+      case 0b011100:
+      case 0b011101:
+      case 0b011110:
+      case 0b011111: {
+        if (!is_vv || !unmasked) {
+          break;
+        }
+        std::vector<uint8_t> bits(reg(vd), reg(vd) + vlenb);
+        for (size_t i = 0; i < vl; ++i) {
+          bool a = MaskBit(reg(vs2), i);
+          bool b = MaskBit(reg(rs1), i);
+          bool value;
+          switch (funct6) {
+            case 0b011000: value = a && !b;
+              break;
+            case 0b011001: value = a && b;
+              break;
+            case 0b011010: value = a || b;
+              break;
+            case 0b011011: value = a!=b;
+              break;
+            case 0b011100: value = a || !b;
+              break;
+            case 0b011101: value = !(a && b);
+              break;
+            case 0b011110: value = !(a || b);
+              break;
+            default: value = a==b;
+              break;
+          }
+          SetMaskBit(bits.data(), i, value);
+        }
+        commit_register(bits);
+        return;
+      }
+      case 0b100000: return run_int(IntOp::kDivu);
+      case 0b100001: return run_int(IntOp::kDiv);
+      case 0b100010: return run_int(IntOp::kRemu);
+      case 0b100011: return run_int(IntOp::kRem);
+      case 0b100100: return run_int(IntOp::kMulhu);
+      case 0b100101: return run_int(IntOp::kMul);
+      case 0b100110: return run_int(IntOp::kMulhsu);
+      case 0b100111: return run_int(IntOp::kMulh);
+      case 0b101101: return run_int(IntOp::kMacc);
+      case 0b101111: return run_int(IntOp::kNmsac);
+      default: break;
+    }
+    Illegal(instruction, "unsupported integer operation");
+  }
+
+  // OPFVV and OPFVF.
+  bool is_vv = funct3==kOpFvv;
+  auto fp_compare = [&](int predicate) {
+    // predicate: 0 eq, 1 le, 2 lt, 3 ne, 4 gt, 5 ge. Any comparison with NaN is false, except ne.
+    return run_compare([sew, predicate](uint64_t a, uint64_t b) {
+      double x;
+      double y;
+      if (sew==32) {
+        float fa;
+        float fb;
+        uint32_t ua = static_cast<uint32_t>(a);
+        uint32_t ub = static_cast<uint32_t>(b);
+        std::memcpy(&fa, &ua, 4);
+        std::memcpy(&fb, &ub, 4);
+        x = fa;
+        y = fb;
+      } else {
+        std::memcpy(&x, &a, 8);
+        std::memcpy(&y, &b, 8);
+      }
+      switch (predicate) {
+        case 0: return x==y;
+        case 1: return x <= y;
+        case 2: return x < y;
+        case 3: return x!=y;
+        case 4: return x > y;
+        default: return x >= y;
+      }
+    });
+  };
+  switch (funct6) {
+    case 0b000000: return run_fp(FpOp::kAdd);
+    case 0b000010: return run_fp(FpOp::kSub);
+    case 0b100111:
+      if (!is_vv) {
+        return run_fp(FpOp::kRsub);
+      }
+      break;
+    case 0b000100: return run_fp(FpOp::kMin);
+    case 0b000110: return run_fp(FpOp::kMax);
+    case 0b100100: return run_fp(FpOp::kMul);
+    case 0b100000: return run_fp(FpOp::kDiv);
+    case 0b100001:
+      if (!is_vv) {
+        return run_fp(FpOp::kRdiv);
+      }
+      break;
+    case 0b101100: return run_fp(FpOp::kMacc);
+    case 0b101111: return run_fp(FpOp::kNmsac);
+    case 0b001000: return run_fp(FpOp::kSgnj);
+    case 0b001001: return run_fp(FpOp::kSgnjn);
+    case 0b001010: return run_fp(FpOp::kSgnjx);
+    case 0b011000: return fp_compare(0);
+    case 0b011001: return fp_compare(1);
+    case 0b011011: return fp_compare(2);
+    case 0b011100: return fp_compare(3);
+    case 0b011101:
+      if (!is_vv) {
+        return fp_compare(4);
+      }
+      break;
+    case 0b011111:
+      if (!is_vv) {
+        return fp_compare(5);
+      }
+      break;
+    case 0b000001:
+    case 0b000011:
+      // vfredusum and vfredosum; both sum in element order.
+      if (is_vv) {
+        return run_fp_reduction(FpOp::kAdd);
+      }
+      break;
+    case 0b000101:
+      if (is_vv) {
+        return run_fp_reduction(FpOp::kMin);
+      }
+      break;
+    case 0b000111:
+      if (is_vv) {
+        return run_fp_reduction(FpOp::kMax);
+      }
+      break;
+    case 0b010111:
+      if (!is_vv) {
+        return run_merge();
+      }
+      break;
+    case 0b010000:
+      if (is_vv && rs1==0 && unmasked) {
+        // vfmv.f.s
+        uint64_t value = ReadElement(reg(vs2), 0, sew_bytes);
+        if (sew==32) {
+          value |= 0xFFFFFFFF00000000ULL;
+        }
+        WriteFprRecorded(registers, delta, vd, value);
+        return;
+      }
+      if (!is_vv && vs2==0 && unmasked) {
+        // vfmv.s.f
+        if (vl > 0) {
+          std::vector<uint8_t> bytes(reg(vd), reg(vd) + vlenb);
+          WriteElement(bytes.data(), 0, sew_bytes, scalar);
+          commit_register(bytes);
+        }
+        return;
+      }
+      break;
+    default: break;
+  }
+  Illegal(instruction, "unsupported floating-point operation");
+}
+
+} // namespace rvv
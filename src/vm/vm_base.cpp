@@ -5,9 +5,11 @@
  */
 
 #include "vm/vm_base.h"
+#include "vm/state_image.h"
 
-#include "globals.h"
 #include "config.h"
+#include "utils.h"
+#include "assembler/elf_util.h"
 
 #include <cstdint>
 #include <iostream>
@@ -15,74 +17,163 @@
 #include <fstream>
 #include <filesystem>
 #include <algorithm>
+#include <array>
 #include <cstring>
+#include <memory>
 #include <thread>
 
 
-void VmBase::LoadProgram(const AssembledProgram &program) {
-  program_ = program;
-  unsigned int counter = 0;
-  for (const auto &instruction: program.text_buffer) {
-    memory_controller_.WriteWord(counter, instruction);
-      counter += 4;
+void VmBase::LoadProgram(AssembledProgram program) {
+  program_ = std::move(program);
+  shared_program_.reset();
+  text_start_ = 0;
+  exited_ = false;
+
+  const auto &text = program_.text_buffer;
+  const size_t text_size = text.size()*sizeof(uint32_t);
+  // Memory is little-endian, like the host, so instruction words can be copied as raw bytes.
+  memory_controller_.WriteBlock(0, {reinterpret_cast<const uint8_t *>(text.data()), text_size});
+  program_size_ = text_size;
+  breakpoints_.Reset(text_start_, program_size_);
+
+  std::vector<uint8_t> data_image = SerializeDataSection(program_);
+  memory_controller_.WriteBlock(context_.config.getDataSectionStart(), data_image);
+  registers_.SetVectorLength(context_.config.getVectorLength());
+  SetupGuestIo();
+  SetupMmio();
+  ApplyRandomSeed();
+  SetupProfiler(text_start_);
+  SetupBranchPredictor();
+  SetupCache();
+  SetupTiming();
+  SetupTrace();
+  perf_counters_.Reset();
+
+  std::cout << "VM_PROGRAM_LOADED" << std::endl;
+  output_status_ = "VM_PROGRAM_LOADED";
+
+  DumpState(context_.paths.vm_state);
+}
+
+void VmBase::LoadElfProgram(const std::string &filename) {
+  ElfFile elf(filename);
+
+  uint64_t text_start = UINT64_MAX;
+  uint64_t text_end = 0;
+  for (const auto &segment : elf.getSegments()) {
+    // Bytes between file_bytes and mem_size (.bss) stay zero: blocks are zero-initialised on allocation.
+    memory_controller_.WriteBlock(segment.vaddr, segment.file_bytes);
+    if (segment.executable) {
+      text_start = std::min(text_start, segment.vaddr);
+      text_end = std::max(text_end, segment.vaddr + segment.mem_size);
+    }
   }
-  program_size_ = counter;
-  AddBreakpoint(program_size_, false);  // address
-
-  unsigned int data_counter = 0;
-  uint64_t base_data_address = vm_config::config.getDataSectionStart();
-  auto align = [&](unsigned int alignment) {
-    if (data_counter % alignment != 0)
-      data_counter += alignment - (data_counter % alignment);
-  };
-  for (const auto& data : program.data_buffer) {
-    std::visit([&](auto&& value) {
-      using T = std::decay_t<decltype(value)>; 
-      
-
-      if constexpr (std::is_same_v<T, uint8_t>) {
-        align(1);
-        memory_controller_.WriteByte(base_data_address + data_counter, value);  // Write a byte
-        data_counter += 1;
-      } else if constexpr (std::is_same_v<T, uint16_t>) {
-        align(2);
-        memory_controller_.WriteHalfWord(base_data_address + data_counter, value);  // Write a halfword (16 bits)
-        data_counter += 2;
-      } else if constexpr (std::is_same_v<T, uint32_t>) {
-        align(4);
-        memory_controller_.WriteWord(base_data_address + data_counter, value);  // Write a word (32 bits)
-        data_counter += 4;
-      } else if constexpr (std::is_same_v<T, uint64_t>) {
-        align(8);
-        memory_controller_.WriteDoubleWord(base_data_address + data_counter, value);  // Write a double word (64 bits)
-        data_counter += 8;
-      } else if constexpr (std::is_same_v<T, float>) {
-        align(4);
-        uint32_t float_as_int;
-        std::memcpy(&float_as_int, &value, sizeof(float));
-        memory_controller_.WriteWord(base_data_address + data_counter, float_as_int);  // Write the float as a word
-        data_counter += 4;
-      } else if constexpr (std::is_same_v<T, double>) {
-        align(8);
-        uint64_t double_as_int;
-        std::memcpy(&double_as_int, &value, sizeof(double));
-        memory_controller_.WriteDoubleWord(base_data_address + data_counter, double_as_int);  // Write the double as a double word
-        data_counter += 8;
-      } else if constexpr (std::is_same_v<T, std::string>) {
-        align(1);
-        for (size_t i = 0; i < value.size(); i++) {
-          memory_controller_.WriteByte(base_data_address + data_counter, static_cast<uint8_t>(value[i]));  // Write each byte of the string
-          data_counter += 1;
-        }
-      }
-    }, data);
+  if (text_end == 0) {
+    throw std::runtime_error("ELF file has no executable segment: " + filename);
+  }
+
+  AssembledProgram program;
+  program.filename = filename;
+  program.text_buffer.resize((text_end - text_start + 3)/4, 0);
+  auto *text_bytes = reinterpret_cast<uint8_t *>(program.text_buffer.data());
+  for (const auto &segment : elf.getSegments()) {
+    if (segment.executable) {
+      std::memcpy(text_bytes + (segment.vaddr - text_start), segment.file_bytes.data(), segment.file_bytes.size());
+    }
+  }
+  for (const auto &symbol : elf.getSymbols()) {
+    program.symbol_table[symbol.name] = {symbol.address, 0, !symbol.is_function};
+  }
+
+  program_ = std::move(program);
+  shared_program_.reset();
+  text_start_ = text_start;
+  exited_ = false;
+  program_size_ = text_end;
+  program_counter_ = elf.getEntry();
+  registers_.WriteGpr(2, context_.config.getStackTop());
+  breakpoints_.Reset(text_start_, program_size_);
+  registers_.SetVectorLength(context_.config.getVectorLength());
+  SetupGuestIo();
+  SetupMmio();
+  ApplyRandomSeed();
+  SetupProfiler(program_counter_);
+  SetupBranchPredictor();
+  SetupCache();
+  SetupTiming();
+  SetupTrace();
+  perf_counters_.Reset();
+
+  if (context_.dump_state) {
+    DumpElfDisassembly(context_.paths.disassembly, program_, text_start_);
   }
   std::cout << "VM_PROGRAM_LOADED" << std::endl;
   output_status_ = "VM_PROGRAM_LOADED";
 
-  DumpState(globals::vm_state_dump_file_path);
-    
+  DumpState(context_.paths.vm_state);
+}
 
+VmSnapshot VmBase::Snapshot() {
+  if (!shared_program_) {
+    shared_program_ = std::make_shared<const AssembledProgram>(program_);
+  }
+  VmSnapshot snapshot;
+  snapshot.config = context_.config;
+  snapshot.memory = memory_controller_.GetSharedMemory()->Fork();
+  snapshot.program = shared_program_;
+  snapshot.registers = registers_;
+  snapshot.program_counter = program_counter_;
+  snapshot.text_start = text_start_;
+  snapshot.program_size = program_size_;
+  snapshot.instructions_retired = instructions_retired_;
+  snapshot.cycles = cycle_s_;
+  snapshot.exited = exited_;
+  snapshot.exit_code = exit_code_;
+  return snapshot;
+}
+
+void VmBase::Fork(const VmSnapshot &snapshot) {
+  context_.config = snapshot.config;
+  memory_controller_.ShareMemory(snapshot.memory->Fork());
+  // Forking the same snapshot again, the usual case, skips copying the program.
+  if (shared_program_ != snapshot.program) {
+    program_ = *snapshot.program;
+    shared_program_ = snapshot.program;
+    breakpoints_.Reset(snapshot.text_start, snapshot.program_size);
+  }
+  text_start_ = snapshot.text_start;
+  program_size_ = snapshot.program_size;
+  program_counter_ = snapshot.program_counter;
+  registers_ = snapshot.registers;
+  hart_id_ = static_cast<unsigned int>(registers_.ReadCsr(kCsrMhartid));
+  instructions_retired_ = snapshot.instructions_retired;
+  cycle_s_ = snapshot.cycles;
+  exited_ = snapshot.exited;
+  exit_code_ = snapshot.exit_code;
+  SetupGuestIo();
+  SetupMmio();
+  ApplyRandomSeed();
+  SetupProfiler(program_counter_);
+  SetupBranchPredictor();
+  SetupCache();
+  SetupTiming();
+  SetupTrace();
+  perf_counters_.Reset();
+}
+
+void VmBase::SaveState(const std::filesystem::path &filename) {
+  SyncCounterCsrs();
+  SaveStateImage(filename, Snapshot(), breakpoints_.GetBreakpoints());
+}
+
+void VmBase::RestoreState(const std::filesystem::path &filename) {
+  StateImage image = LoadStateImage(filename, context_.config);
+  Fork(image.snapshot);
+  for (const BreakpointSet::Breakpoint &breakpoint : image.breakpoints) {
+    breakpoints_.Add(breakpoint.address, breakpoint.condition, breakpoint.hit_count, breakpoint.hits);
+  }
+  output_status_ = "VM_STATE_RESTORED";
+  DumpState(context_.paths.vm_state);
 }
 
 uint64_t VmBase::GetProgramCounter() const {
@@ -173,87 +264,298 @@ int32_t VmBase::ImmGenerator(uint32_t instruction) {
 }
 
 
-void VmBase::AddBreakpoint(uint64_t val, bool is_line) {
+void VmBase::AddBreakpoint(uint64_t val, bool is_line, const std::string &condition, uint64_t hit_count) {
+    uint64_t bp = val;
     if (is_line) {
         // If the value is a line number, convert it to an instruction address
         if (program_.line_number_instruction_number_mapping.find(val) == program_.line_number_instruction_number_mapping.end()) {
             std::cerr << "Invalid line number: " << val << std::endl;
             return;
         }
-        uint64_t line = val;
-        uint64_t bp = program_.line_number_instruction_number_mapping[line] * 4;
-        if (CheckBreakpoint(bp)) {
-            std::cerr << "Breakpoint already exists at line: " << line << std::endl;
-            return;
-        }
-        breakpoints_.emplace_back(bp);
-    } else {
-        if (val % 4 != 0) {
-            std::cerr << "Invalid instruction address: " << val << ". Must be a multiple of 4." << std::endl;
-            return;
-        }
-        if (CheckBreakpoint(val)) {
-            std::cerr << "Breakpoint already exists at address: " << val << std::endl;
-            return;
-        }
-        breakpoints_.emplace_back(val);
+        bp = program_.line_number_instruction_number_mapping[val] * 4;
+    } else if (val % 4 != 0) {
+        std::cerr << "Invalid instruction address: " << val << ". Must be a multiple of 4." << std::endl;
+        return;
+    }
+    // Re-adding an existing breakpoint replaces its condition and hit count.
+    try {
+        breakpoints_.Add(bp, condition, hit_count);
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << std::endl;
+        return;
     }
 
-    DumpState(globals::vm_state_dump_file_path);
+    DumpState(context_.paths.vm_state);
 }
 
 void VmBase::RemoveBreakpoint(uint64_t val, bool is_line) {
+    uint64_t bp = val;
     if (is_line) {
         // If the value is a line number, convert it to an instruction address
         if (program_.line_number_instruction_number_mapping.find(val) == program_.line_number_instruction_number_mapping.end()) {
             std::cerr << "Invalid line number: " << val << std::endl;
             return;
         }
-        uint64_t line = val;
-        uint64_t bp = program_.line_number_instruction_number_mapping[line] * 4;
-        if (!CheckBreakpoint(bp)) {
-            std::cerr << "No breakpoint exists at line: " << line << std::endl;
-            return;
+        bp = program_.line_number_instruction_number_mapping[val] * 4;
+    } else if (val % 4 != 0) {
+        std::cerr << "Invalid instruction address: " << val << ". Must be a multiple of 4." << std::endl;
+        return;
+    }
+    if (!breakpoints_.Remove(bp)) {
+        std::cerr << "No breakpoint exists at " << (is_line ? "line: " : "address: ") << val << std::endl;
+        return;
+    }
+    DumpState(context_.paths.vm_state);
+}
+
+bool VmBase::CheckBreakpoint(uint64_t address) {
+    return breakpoints_.Contains(address);
+}
+
+void VmBase::AddSymbolBreakpoint(const std::string &symbol, const std::string &condition, uint64_t hit_count) {
+    auto it = program_.symbol_table.find(symbol);
+    if (it == program_.symbol_table.end() || it->second.isData) {
+        std::cerr << "Invalid code symbol: " << symbol << std::endl;
+        return;
+    }
+    AddBreakpoint(it->second.address, false, condition, hit_count);
+}
+
+void VmBase::RemoveSymbolBreakpoint(const std::string &symbol) {
+    auto it = program_.symbol_table.find(symbol);
+    if (it == program_.symbol_table.end() || it->second.isData) {
+        std::cerr << "Invalid code symbol: " << symbol << std::endl;
+        return;
+    }
+    RemoveBreakpoint(it->second.address, false);
+}
+
+void VmBase::AddWatchpoint(uint64_t address, uint64_t length, const std::string &kind) {
+    try {
+        watchpoints_.Add(address, length, ParseWatchKind(kind));
+    } catch (const std::invalid_argument &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void VmBase::RemoveWatchpoint(uint64_t address) {
+    if (!watchpoints_.Remove(address)) {
+        std::cerr << "No watchpoint exists at address: 0x" << std::hex << address << std::dec << std::endl;
+    }
+}
+
+std::string VmBase::ReadString(uint64_t address) {
+    constexpr size_t chunk_size = 64;
+    std::string result;
+    std::array<uint8_t, chunk_size> chunk{};
+    while (true) {
+        // Stop each chunk at a block boundary so a string ending near the top of memory is not over-read.
+        size_t count = chunk_size - (address % chunk_size);
+        memory_controller_.ReadBlock(address, std::span<uint8_t>(chunk.data(), count));
+        auto end = std::find(chunk.begin(), chunk.begin() + static_cast<std::ptrdiff_t>(count), 0);
+        result.append(chunk.begin(), end);
+        if (end != chunk.begin() + static_cast<std::ptrdiff_t>(count)) {
+            return result;
         }
-        breakpoints_.erase(std::remove(breakpoints_.begin(), breakpoints_.end(), bp), breakpoints_.end());
+        address += count;
+    }
+}
+
+void VmBase::PrintString(uint64_t address) {
+    guest_io_.WriteConsole(1, ReadString(address));
+}
+
+void VmBase::SetupGuestIo() {
+    guest_io_.Reset();
+    guest_io_.SetFlushThreshold(context_.config.getOutputBufferSize());
+    guest_io_.SetBackendOutput(context_.vm_as_backend);
+    guest_io_.SetSandboxDirectory(context_.config.getSandboxDirectory().empty()
+                                      ? context_.paths.directory / "guest_fs"
+                                      : std::filesystem::path(context_.config.getSandboxDirectory()));
+    if (!context_.config.getStdinFile().empty()) {
+        guest_io_.PreloadStdin(context_.config.getStdinFile());
+    }
+}
+
+void VmBase::SetupMmio() {
+    MmioBus &bus = memory_controller_.GetMmioBus();
+    bus.Clear();
+    if (!context_.config.getMmioEnabled()) {
+        return;
+    }
+    uint64_t base = context_.config.getMmioBase();
+    bus.Add(std::make_unique<UartDevice>(base + kUartOffset, guest_io_));
+    bus.Add(std::make_unique<ClintDevice>(base + kClintOffset));
+    bus.Add(std::make_unique<DmaDevice>(base + kDmaOffset, memory_controller_,
+                                        context_.config.getDmaBytesPerCycle()));
+    bus.Add(std::make_unique<MatrixEngineDevice>(base + kMatrixOffset, memory_controller_,
+                                                 context_.config.getMatrixMacsPerCycle(),
+                                                 context_.config.getMatrixBytesPerCycle()));
+}
+
+void VmBase::ApplyRandomSeed() {
+    if (context_.config.getRandomSeed() != 0) {
+        alu_.Seed(context_.config.getRandomSeed());
+    }
+}
+
+void VmBase::SetupProfiler(uint64_t entry) {
+    if (context_.config.getProfilingEnabled()) {
+        profiler_.Start(text_start_, program_size_, entry);
     } else {
-        if (val % 4 != 0) {
-            std::cerr << "Invalid instruction address: " << val << ". Must be a multiple of 4." << std::endl;
-            return;
-        }
-        if (!CheckBreakpoint(val)) {
-            std::cerr << "No breakpoint exists at address: " << val << std::endl;
-            return;
-        }
-        breakpoints_.erase(std::remove(breakpoints_.begin(), breakpoints_.end(), val), breakpoints_.end());
+        profiler_.Reset();
+    }
+}
+
+void VmBase::WriteProfile() {
+    if (!profiler_.IsEnabled() || !context_.dump_state) {
+        return;
+    }
+    std::ofstream report(context_.paths.profile_report);
+    std::ofstream folded(context_.paths.profile_folded);
+    if (!report.is_open() || !folded.is_open()) {
+        std::cerr << "Error opening file for writing the profile: " << context_.paths.profile_report.string() << std::endl;
+        return;
     }
-    DumpState(globals::vm_state_dump_file_path);
+    profiler_.WriteReport(report, program_, context_.config.getProfileTopLines());
+    profiler_.WriteFoldedStacks(folded, program_);
+}
 
+void VmBase::SetupBranchPredictor() {
+    branch_predictor_.Start(context_.config, text_start_, program_size_);
+    branch_mispredictions_ = 0;
+}
 
+void VmBase::SetupCache() {
+    data_cache_.Start(context_.config);
 }
 
-bool VmBase::CheckBreakpoint(uint64_t address) {
-    return std::find(breakpoints_.begin(), breakpoints_.end(), address) != breakpoints_.end();
+void VmBase::SetupTiming() {
+    timing_model_.Start(context_.config);
 }
 
+void VmBase::WriteBranchReport() {
+    if (!branch_predictor_.IsEnabled() || !context_.dump_state) {
+        return;
+    }
+    std::ofstream report(context_.paths.branch_report);
+    if (!report.is_open()) {
+        std::cerr << "Error opening file for writing the branch report: " << context_.paths.branch_report.string() << std::endl;
+        return;
+    }
+    branch_predictor_.WriteReport(report, program_, context_.config.getProfileTopLines());
+}
 
-void VmBase::PrintString(uint64_t address) {
-    while (true) {
-        char c = memory_controller_.ReadByte(address);
-        if (c == '\0') break;
-        std::cout << c;
-        address++;
+void VmBase::SetupTrace() {
+    CloseTrace();
+    const std::string &trace_file = context_.config.getTraceFile();
+    if (trace_file.empty()) {
+        return;
+    }
+    try {
+        trace_writer_.Open(trace_file);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
     }
 }
 
+void VmBase::CloseTrace() {
+    try {
+        trace_writer_.Close();
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void VmBase::SyncCounterCsrs() {
+    registers_.WriteCsr(kCsrCycle, cycle_s_);
+    registers_.WriteCsr(kCsrTime, cycle_s_);
+    registers_.WriteCsr(kCsrInstret, instructions_retired_);
+    for (unsigned int counter = 3; counter <= 31; ++counter) {
+        registers_.WriteCsr(kCsrCycle + counter, perf_counters_.ReadHpmCounter(counter));
+    }
+}
+
+void VmBase::SetupStatePublisher() {
+    publish_interval_instructions_ = context_.config.getPublishIntervalInstructions();
+    publish_interval_ = std::chrono::milliseconds(context_.config.getPublishIntervalMs());
+    publish_check_interval_ = publish_interval_instructions_ > 0
+                                  ? std::min(publish_interval_instructions_, kPublishClockCheck)
+                                  : kPublishClockCheck;
+    PublishState(true);
+}
+
+void VmBase::MaybePublishState() {
+    publish_countdown_ = publish_check_interval_;
+    bool due = state_publisher_.MemoryViewRequested();
+    if (!due && publish_interval_instructions_ > 0) {
+        due = instructions_retired_ - last_published_instret_ >= publish_interval_instructions_;
+    }
+    if (!due && publish_interval_.count() > 0) {
+        due = std::chrono::steady_clock::now() - last_publish_time_ >= publish_interval_;
+    }
+    if (due) {
+        PublishState(true);
+    }
+}
+
+void VmBase::PublishState(bool running) {
+    PublishedState state;
+    state.program_counter = program_counter_;
+    state.instructions_retired = instructions_retired_;
+    state.cycles = cycle_s_;
+    state.running = running;
+    for (size_t i = 0; i < 32; ++i) {
+        state.gprs[i] = registers_.ReadGpr(i);
+        state.fprs[i] = registers_.ReadFpr(i);
+    }
+    state_publisher_.Publish(state);
+    if (state_publisher_.MemoryViewRequested()) {
+        state_publisher_.PublishMemoryView(memory_controller_.GetSharedMemory()->Fork(), state);
+    } else {
+        state_publisher_.ReleaseMemoryView();
+    }
+    publish_countdown_ = publish_check_interval_;
+    last_published_instret_ = instructions_retired_;
+    last_publish_time_ = std::chrono::steady_clock::now();
+}
+
+void VmBase::WritePerfCounters() {
+    if (!kPerfCountersEnabled || !context_.dump_state) {
+        return;
+    }
+    try {
+        perf_counters_.DumpJson(context_.paths.perf_counters, cycle_s_, instructions_retired_);
+    } catch (const std::runtime_error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+void VmBase::DumpRegistersAndState() {
+    if (!context_.dump_state) {
+        return;
+    }
+    SyncCounterCsrs();
+    DumpRegisters(context_.paths.registers, registers_);
+    DumpState(context_.paths.vm_state);
+}
+
+void VmBase::UpdateCpi() {
+    cpi_ = instructions_retired_ == 0 ? 0.0f : static_cast<float>(cycle_s_) / static_cast<float>(instructions_retired_);
+    ipc_ = cycle_s_ == 0 ? 0.0f : static_cast<float>(instructions_retired_) / static_cast<float>(cycle_s_);
+}
+
 void VmBase::DumpState(const std::filesystem::path &filename) {
+    if (!context_.dump_state) {
+        return;
+    }
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error opening file for dumping VM state: " << filename.string() << std::endl;
         return;
     }
 
-    unsigned int instruction_number = program_counter_ / 4;
+    unsigned int instruction_number = program_counter_ >= text_start_ ? (program_counter_ - text_start_) / 4 : 0;
     unsigned int current_line = program_.instruction_number_line_number_mapping[instruction_number];
 
     file << "{\n";
@@ -271,15 +573,21 @@ void VmBase::DumpState(const std::filesystem::path &filename) {
     file << "    \"disassembly_line_number\": " << program_.instruction_number_disassembly_mapping[instruction_number] << ",\n";
     file << "    \"cycle_count\": " << cycle_s_ << ",\n";
     file << "    \"instructions_retired\": " << instructions_retired_ << ",\n";
+    UpdateCpi();
     file << "    \"cpi\": " << cpi_ << ",\n";
     file << "    \"ipc\": " << ipc_ << ",\n";
     file << "    \"stall_cycles\": " << stall_cycles_ << ",\n";
     file << "    \"branch_mispredictions\": " << branch_mispredictions_ << ",\n";
+    if (auto *engine = dynamic_cast<MatrixEngineDevice *>(memory_controller_.GetMmioBus().GetDevice("matrix"))) {
+        file << "    \"matrix_engine_operations\": " << engine->getOperations() << ",\n";
+        file << "    \"matrix_engine_macs\": " << engine->getTotalMacs() << ",\n";
+        file << "    \"matrix_engine_cycles\": " << engine->getTotalCycles() << ",\n";
+    }
     file << "    \"breakpoints\": [";
-    for (size_t i = 1; i < breakpoints_.size(); ++i) {
-        program_.instruction_number_line_number_mapping[breakpoints_[i] / 4];
-        file << program_.instruction_number_line_number_mapping[breakpoints_[i] / 4];
-        if (i < breakpoints_.size() - 1) {
+    std::vector<BreakpointSet::Breakpoint> breakpoints = breakpoints_.GetBreakpoints();
+    for (size_t i = 0; i < breakpoints.size(); ++i) {
+        file << program_.instruction_number_line_number_mapping[(breakpoints[i].address - text_start_) / 4];
+        if (i < breakpoints.size() - 1) {
             file << ", ";
         }
     }
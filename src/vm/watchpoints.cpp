@@ -0,0 +1,89 @@
+/**
+ * @file watchpoints.cpp
+ * @brief Contains the implementation of the WatchpointSet class.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/watchpoints.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+uint8_t ParseWatchKind(const std::string &kind) {
+  if (kind == "r") {
+    return kWatchRead;
+  }
+  if (kind == "w") {
+    return kWatchWrite;
+  }
+  if (kind == "rw" || kind == "wr") {
+    return kWatchRead | kWatchWrite;
+  }
+  throw std::invalid_argument("Invalid watchpoint kind: " + kind + " (expected r, w or rw)");
+}
+
+const char *WatchKindName(uint8_t kind) {
+  switch (kind) {
+    case kWatchRead: return "r";
+    case kWatchWrite: return "w";
+    default: return "rw";
+  }
+}
+
+void WatchpointSet::Add(uint64_t address, uint64_t length, uint8_t kind) {
+  if (length == 0 || address + length - 1 < address) {
+    throw std::invalid_argument("Invalid watchpoint range");
+  }
+  if ((kind & (kWatchRead | kWatchWrite)) == 0) {
+    throw std::invalid_argument("Watchpoint must watch reads or writes");
+  }
+  auto it = std::find_if(watchpoints_.begin(), watchpoints_.end(),
+                         [address](const Watchpoint &w) { return w.address == address; });
+  if (it != watchpoints_.end()) {
+    *it = {address, length, kind, 0};
+  } else {
+    watchpoints_.push_back({address, length, kind, 0});
+  }
+  RebuildPageFlags();
+}
+
+bool WatchpointSet::Remove(uint64_t address) {
+  auto it = std::find_if(watchpoints_.begin(), watchpoints_.end(),
+                         [address](const Watchpoint &w) { return w.address == address; });
+  if (it == watchpoints_.end()) {
+    return false;
+  }
+  watchpoints_.erase(it);
+  RebuildPageFlags();
+  return true;
+}
+
+void WatchpointSet::Clear() {
+  watchpoints_.clear();
+  page_flags_.fill(0);
+}
+
+const WatchpointSet::Watchpoint *WatchpointSet::Match(uint64_t address, uint64_t size, uint8_t access) {
+  uint64_t last = address + size - 1;
+  for (Watchpoint &watchpoint : watchpoints_) {
+    if ((watchpoint.kind & access) && address <= watchpoint.address + watchpoint.length - 1
+        && watchpoint.address <= last) {
+      ++watchpoint.hits;
+      return &watchpoint;
+    }
+  }
+  return nullptr;
+}
+
+void WatchpointSet::RebuildPageFlags() {
+  page_flags_.fill(0);
+  for (const Watchpoint &watchpoint : watchpoints_) {
+    uint64_t first_page = watchpoint.address >> kPageShift;
+    uint64_t last_page = (watchpoint.address + watchpoint.length - 1) >> kPageShift;
+    // A range covering more pages than there are slots sets every slot.
+    uint64_t pages = std::min<uint64_t>(last_page - first_page, kPageSlots - 1) + 1;
+    for (uint64_t page = 0; page < pages; ++page) {
+      page_flags_[(first_page + page) % kPageSlots] |= watchpoint.kind;
+    }
+  }
+}
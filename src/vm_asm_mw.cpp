@@ -4,4 +4,30 @@
  * @author Vishank Singh, https://github.com/VishankSingh
  */
 
-#include "vm_asm_mw.h"
\ No newline at end of file
+#include "vm_asm_mw.h"
+
+#include <cstring>
+
+std::vector<uint8_t> SerializeDataSection(const AssembledProgram &program) {
+  std::vector<uint8_t> image;
+  auto append = [&image](const void *bytes, size_t size, size_t alignment) {
+    if (image.size()%alignment != 0) {
+      image.resize(image.size() + alignment - image.size()%alignment, 0);
+    }
+    size_t offset = image.size();
+    image.resize(offset + size);
+    std::memcpy(image.data() + offset, bytes, size);
+  };
+
+  for (const auto &data : program.data_buffer) {
+    std::visit([&](auto &&value) {
+      using T = std::decay_t<decltype(value)>;
+      if constexpr (std::is_same_v<T, std::string>) {
+        append(value.data(), value.size(), 1);
+      } else {
+        append(&value, sizeof(T), sizeof(T));
+      }
+    }, data);
+  }
+  return image;
+}
@@ -0,0 +1,511 @@
+/**
+ * @file yolo_bench.cpp
+ * @brief Contains the implementation of the YOLO convolution benchmark.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "yolo_bench.h"
+
+#include "assembler/assembler.h"
+#include "vm/alu.h"
+#include "vm/rvss/rvss_vm.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace yolo_bench {
+
+namespace {
+
+constexpr uint64_t kSliceInstructions = 1 << 20;
+
+struct Shape {
+  unsigned int channels = 0;
+  unsigned int height = 0;
+  unsigned int width = 0;
+};
+
+struct Section {
+  std::string name;
+  std::map<std::string, std::string> options;
+  unsigned int line_number = 0;
+};
+
+std::string Trim(const std::string &text) {
+  size_t begin = text.find_first_not_of(" \t\r");
+  if (begin == std::string::npos) {
+    return "";
+  }
+  size_t end = text.find_last_not_of(" \t\r");
+  return text.substr(begin, end - begin + 1);
+}
+
+std::vector<Section> ReadSections(const std::filesystem::path &cfg) {
+  std::ifstream file(cfg);
+  if (!file.is_open()) {
+    throw std::runtime_error("Unable to open config: " + cfg.string());
+  }
+  std::vector<Section> sections;
+  std::string line;
+  unsigned int line_number = 0;
+  while (std::getline(file, line)) {
+    ++line_number;
+    line = Trim(line.substr(0, line.find_first_of("#;")));
+    if (line.empty()) {
+      continue;
+    }
+    if (line.front() == '[' && line.back() == ']') {
+      sections.push_back({line.substr(1, line.size() - 2), {}, line_number});
+      continue;
+    }
+    size_t equals = line.find('=');
+    if (sections.empty() || equals == std::string::npos) {
+      throw std::runtime_error(cfg.string() + ":" + std::to_string(line_number) + ": expected 'key=value'");
+    }
+    sections.back().options[Trim(line.substr(0, equals))] = Trim(line.substr(equals + 1));
+  }
+  return sections;
+}
+
+unsigned int Option(const Section &section, const std::string &key, unsigned int fallback) {
+  auto it = section.options.find(key);
+  if (it == section.options.end()) {
+    return fallback;
+  }
+  try {
+    return static_cast<unsigned int>(std::stoul(it->second));
+  } catch (const std::exception &) {
+    throw std::runtime_error("Line " + std::to_string(section.line_number) + ": invalid " + key + "=" + it->second);
+  }
+}
+
+// Darknet's own output size formulas, so the shapes match the detector's.
+unsigned int ConvOutput(unsigned int in, unsigned int size, unsigned int stride, unsigned int pad) {
+  return (in + 2*pad < size) ? 0 : (in + 2*pad - size)/stride + 1;
+}
+
+std::vector<size_t> RouteInputs(const Section &section, size_t layer, const std::vector<Shape> &shapes) {
+  auto it = section.options.find("layers");
+  if (it == section.options.end()) {
+    throw std::runtime_error("Line " + std::to_string(section.line_number) + ": [route] without layers");
+  }
+  std::vector<size_t> inputs;
+  std::stringstream list(it->second);
+  std::string item;
+  while (std::getline(list, item, ',')) {
+    long index = std::stol(Trim(item));
+    if (index < 0) {
+      index += static_cast<long>(layer);
+    }
+    if (index < 0 || static_cast<size_t>(index) >= shapes.size()) {
+      throw std::runtime_error("Line " + std::to_string(section.line_number) + ": [route] refers to layer "
+                                   + Trim(item) + ", which does not exist");
+    }
+    inputs.push_back(static_cast<size_t>(index));
+  }
+  return inputs;
+}
+
+// Packed formats keep four lanes of 16 bits (or one MSFP16 block) in each 64-bit register.
+unsigned int Lanes(NumberFormat format) {
+  return format == NumberFormat::kFp32 ? 1 : 4;
+}
+
+unsigned int WordBytes(NumberFormat format) {
+  return format == NumberFormat::kFp32 ? 4 : 8;
+}
+
+uint64_t Encode(NumberFormat format, const std::array<float, 4> &lanes) {
+  uint64_t word = 0;
+  switch (format) {
+    case NumberFormat::kFp32: {
+      uint32_t bits;
+      std::memcpy(&bits, &lanes[0], 4);
+      word = bits;
+      break;
+    }
+    case NumberFormat::kFp16:
+    case NumberFormat::kBf16:
+      for (unsigned int i = 0; i < 4; ++i) {
+        uint64_t half = format == NumberFormat::kFp16 ? alu::float_to_float16(lanes[i]) : alu::float_to_bfloat16(lanes[i]);
+        word |= half << (16*i);
+      }
+      break;
+    case NumberFormat::kMsfp16:
+      word = alu::msfp16_pack(lanes);
+      break;
+  }
+  return word;
+}
+
+std::array<float, 4> Decode(NumberFormat format, uint64_t word) {
+  std::array<float, 4> lanes{};
+  switch (format) {
+    case NumberFormat::kFp32: {
+      auto bits = static_cast<uint32_t>(word);
+      std::memcpy(&lanes[0], &bits, 4);
+      break;
+    }
+    case NumberFormat::kFp16:
+    case NumberFormat::kBf16:
+      for (unsigned int i = 0; i < 4; ++i) {
+        auto half = static_cast<uint16_t>(word >> (16*i));
+        lanes[i] = format == NumberFormat::kFp16 ? alu::float16_to_float(half) : alu::bfloat16_to_float(half);
+      }
+      break;
+    case NumberFormat::kMsfp16:
+      lanes = alu::msfp16_unpack(word);
+      break;
+  }
+  return lanes;
+}
+
+void EmitData(std::ostream &os, const std::string &label, NumberFormat format, const std::vector<uint64_t> &words) {
+  os << label << ":\n";
+  const char *directive = format == NumberFormat::kFp32 ? ".word" : ".dword";
+  for (size_t i = 0; i < words.size(); i += 16) {
+    os << "  " << directive << " ";
+    for (size_t j = i; j < std::min(words.size(), i + 16); ++j) {
+      // The lexer reads decimal literals as signed 64-bit values.
+      os << (j == i ? "" : ", ") << static_cast<int64_t>(words[j]);
+    }
+    os << "\n";
+  }
+}
+
+} // namespace
+
+std::vector<ConvLayer> ParseConvLayers(const std::filesystem::path &cfg) {
+  std::vector<Section> sections = ReadSections(cfg);
+  if (sections.empty() || (sections[0].name != "net" && sections[0].name != "network")) {
+    throw std::runtime_error(cfg.string() + ": the first section must be [net]");
+  }
+  Shape shape{Option(sections[0], "channels", 3), Option(sections[0], "height", 416), Option(sections[0], "width", 416)};
+
+  std::vector<ConvLayer> layers;
+  std::vector<Shape> shapes; // output of every layer so far, for [route]
+  for (size_t s = 1; s < sections.size(); ++s) {
+    const Section &section = sections[s];
+    size_t layer = shapes.size();
+    if (section.name == "convolutional") {
+      ConvLayer conv;
+      conv.index = layers.size();
+      conv.darknet_layer = layer;
+      conv.filters = Option(section, "filters", 1);
+      conv.size = Option(section, "size", 1);
+      conv.stride = std::max(1u, Option(section, "stride", 1));
+      conv.pad = Option(section, "pad", 0) ? conv.size/2 : Option(section, "padding", 0);
+      auto activation = section.options.find("activation");
+      conv.leaky = activation != section.options.end() && activation->second == "leaky";
+      conv.in_channels = shape.channels;
+      conv.in_height = shape.height;
+      conv.in_width = shape.width;
+      conv.out_height = ConvOutput(shape.height, conv.size, conv.stride, conv.pad);
+      conv.out_width = ConvOutput(shape.width, conv.size, conv.stride, conv.pad);
+      shape = {conv.filters, conv.out_height, conv.out_width};
+      layers.push_back(conv);
+    } else if (section.name == "maxpool") {
+      unsigned int stride = std::max(1u, Option(section, "stride", 1));
+      unsigned int size = Option(section, "size", stride);
+      unsigned int padding = Option(section, "padding", size - 1);
+      shape.height = (shape.height + padding - size)/stride + 1;
+      shape.width = (shape.width + padding - size)/stride + 1;
+    } else if (section.name == "route") {
+      std::vector<size_t> inputs = RouteInputs(section, layer, shapes);
+      unsigned int groups = std::max(1u, Option(section, "groups", 1));
+      shape = shapes[inputs[0]];
+      shape.channels = 0;
+      for (size_t input : inputs) {
+        shape.channels += shapes[input].channels/groups;
+      }
+    } else if (section.name == "upsample") {
+      unsigned int stride = Option(section, "stride", 2);
+      shape.height *= stride;
+      shape.width *= stride;
+    } else if (section.name != "yolo" && section.name != "shortcut" && section.name != "dropout") {
+      throw std::runtime_error("Line " + std::to_string(section.line_number) + ": unsupported layer ["
+                                   + section.name + "]");
+    }
+    shapes.push_back(shape);
+  }
+  return layers;
+}
+
+Workload MakeWorkload(const ConvLayer &layer, unsigned int tile, unsigned int max_channels, uint64_t seed) {
+  Workload workload;
+  workload.layer = layer;
+  workload.tile = std::max(1u, std::min({tile, layer.out_height, layer.out_width}));
+  workload.channels = max_channels ? std::min(max_channels, layer.in_channels) : layer.in_channels;
+  workload.filters = max_channels ? std::min(max_channels, layer.filters) : layer.filters;
+  workload.window = (workload.tile - 1)*layer.stride + layer.size;
+
+  const unsigned int window = workload.window, channels = workload.channels, filters = workload.filters;
+  const unsigned int size = layer.size;
+  std::mt19937_64 random(seed);
+  std::uniform_real_distribution<float> activation(-1.0f, 1.0f);
+  // Keeps the outputs around the inputs' magnitude, as batch normalisation would.
+  const float weight_scale = std::sqrt(3.0f/static_cast<float>(size*size*channels));
+  std::uniform_real_distribution<float> weight(-weight_scale, weight_scale);
+  std::uniform_real_distribution<float> bias(-0.1f, 0.1f);
+
+  // The tile starts at output (0, 0), so the window starts pad rows and columns before the input.
+  workload.input.assign(static_cast<size_t>(window)*window*channels, 0.0f);
+  for (unsigned int y = 0; y < window; ++y) {
+    for (unsigned int x = 0; x < window; ++x) {
+      bool inside = y >= layer.pad && y - layer.pad < layer.in_height && x >= layer.pad && x - layer.pad < layer.in_width;
+      for (unsigned int c = 0; c < channels && inside; ++c) {
+        workload.input[(static_cast<size_t>(y)*window + x)*channels + c] = activation(random);
+      }
+    }
+  }
+  workload.weights.resize(static_cast<size_t>(filters)*size*size*channels);
+  for (float &w : workload.weights) {
+    w = weight(random);
+  }
+  workload.bias.resize(filters);
+  for (float &b : workload.bias) {
+    b = bias(random);
+  }
+
+  const unsigned int t = workload.tile;
+  workload.reference.resize(static_cast<size_t>(t)*t*filters);
+  for (unsigned int oy = 0; oy < t; ++oy) {
+    for (unsigned int ox = 0; ox < t; ++ox) {
+      for (unsigned int f = 0; f < filters; ++f) {
+        double sum = workload.bias[f];
+        for (unsigned int ky = 0; ky < size; ++ky) {
+          for (unsigned int kx = 0; kx < size; ++kx) {
+            const float *in = &workload.input[((static_cast<size_t>(oy)*layer.stride + ky)*window
+                                                  + ox*layer.stride + kx)*channels];
+            const float *w = &workload.weights[((static_cast<size_t>(f)*size + ky)*size + kx)*channels];
+            for (unsigned int c = 0; c < channels; ++c) {
+              sum += static_cast<double>(in[c])*w[c];
+            }
+          }
+        }
+        if (layer.leaky && sum < 0) {
+          sum *= 0.1;
+        }
+        workload.reference[(static_cast<size_t>(oy)*t + ox)*filters + f] = static_cast<float>(sum);
+      }
+    }
+  }
+  return workload;
+}
+
+std::string GenerateKernel(const Workload &workload, NumberFormat format) {
+  const ConvLayer &layer = workload.layer;
+  const unsigned int lanes = Lanes(format), word = WordBytes(format);
+  const unsigned int groups = (workload.filters + lanes - 1)/lanes; // zero filters pad the last group
+  const unsigned int channels = workload.channels, size = layer.size, window = workload.window;
+  const std::string suffix = format == NumberFormat::kFp32 ? "s" : FormatName(format);
+  const std::string load = format == NumberFormat::kFp32 ? "flw" : "fld";
+  const std::string store = format == NumberFormat::kFp32 ? "fsw" : "fsd";
+
+  // Every activation is broadcast to all lanes, so one packed fmadd updates `lanes` filters.
+  std::vector<uint64_t> input(workload.input.size());
+  for (size_t i = 0; i < input.size(); ++i) {
+    float a = workload.input[i];
+    input[i] = Encode(format, {a, a, a, a});
+  }
+  const size_t filter_elements = static_cast<size_t>(size)*size*channels;
+  std::vector<uint64_t> weights(groups*filter_elements);
+  std::vector<uint64_t> bias(groups);
+  for (unsigned int g = 0; g < groups; ++g) {
+    std::array<float, 4> b{};
+    for (unsigned int lane = 0; lane < lanes && g*lanes + lane < workload.filters; ++lane) {
+      b[lane] = workload.bias[g*lanes + lane];
+    }
+    bias[g] = Encode(format, b);
+    for (size_t e = 0; e < filter_elements; ++e) {
+      std::array<float, 4> w{};
+      for (unsigned int lane = 0; lane < lanes && g*lanes + lane < workload.filters; ++lane) {
+        w[lane] = workload.weights[(g*lanes + lane)*filter_elements + e];
+      }
+      weights[g*filter_elements + e] = Encode(format, w);
+    }
+  }
+
+  std::ostringstream os;
+  os << "# " << FormatName(format) << " kernel for convolutional layer " << layer.index << " (Darknet layer "
+     << layer.darknet_layer << "): " << workload.tile << "x" << workload.tile << " outputs, " << workload.filters
+     << " filters of " << size << "x" << size << "x" << channels << ", stride " << layer.stride
+     << (layer.leaky ? ", leaky" : ", linear") << "\n";
+  os << ".data\n";
+  EmitData(os, "input", format, input);
+  EmitData(os, "weights", format, weights);
+  EmitData(os, "bias", format, bias);
+  EmitData(os, "leak", format, {Encode(format, {0.1f, 0.1f, 0.1f, 0.1f})});
+  os << "output:\n  .zero " << static_cast<size_t>(workload.tile)*workload.tile*groups*word << "\n";
+
+  const size_t row_bytes = static_cast<size_t>(window)*channels*word;
+  os << ".text\n"
+        "  la s0, input\n"
+        "  la s1, weights\n"
+        "  la s2, bias\n"
+        "  la s3, output\n"
+        "  la t4, leak\n"
+        "  " << load << " f3, 0(t4)\n"
+        "  li s10, " << row_bytes << "\n"
+        "  li s11, " << static_cast<size_t>(layer.stride)*channels*word << "\n"
+        "  li t2, " << layer.stride*row_bytes << "\n"
+        "  li t3, " << static_cast<size_t>(size)*channels << "\n"
+        "  li t1, " << workload.tile << "\n"
+        "  mv s7, s0\n"
+        "  li s4, 0\n"
+        "row_loop:\n"
+        "  mv s6, s7\n"
+        "  li s5, 0\n"
+        "column_loop:\n"
+        "  mv a1, s1\n"
+        "  mv a2, s2\n"
+        "  li s8, " << groups << "\n"
+        "group_loop:\n"
+        "  " << load << " f0, 0(a2)\n"
+        "  mv a3, s6\n"
+        "  li s9, " << size << "\n"
+        "kernel_row_loop:\n"
+        "  mv a0, a3\n"
+        "  mv t0, t3\n"
+        // One kernel row of the window and of the filters is contiguous: size*channels elements.
+        "mac_loop:\n"
+        "  " << load << " f1, 0(a0)\n"
+        "  " << load << " f2, 0(a1)\n"
+        "  fmadd." << suffix << " f0, f1, f2, f0\n"
+        "  addi a0, a0, " << word << "\n"
+        "  addi a1, a1, " << word << "\n"
+        "  addi t0, t0, -1\n"
+        "  bne t0, x0, mac_loop\n"
+        "  add a3, a3, s10\n"
+        "  addi s9, s9, -1\n"
+        "  bne s9, x0, kernel_row_loop\n";
+  if (layer.leaky) {
+    os << "  fmul." << suffix << " f4, f0, f3\n"
+          "  fmax." << suffix << " f0, f0, f4\n";
+  }
+  os << "  " << store << " f0, 0(s3)\n"
+        "  addi s3, s3, " << word << "\n"
+        "  addi a2, a2, " << word << "\n"
+        "  addi s8, s8, -1\n"
+        "  bne s8, x0, group_loop\n"
+        "  add s6, s6, s11\n"
+        "  addi s5, s5, 1\n"
+        "  blt s5, t1, column_loop\n"
+        "  add s7, s7, t2\n"
+        "  addi s4, s4, 1\n"
+        "  blt s4, t1, row_loop\n"
+        "  li a7, 93\n"
+        "  li a0, 0\n"
+        "  ecall\n";
+  return os.str();
+}
+
+KernelResult RunKernel(const Workload &workload, NumberFormat format, const std::filesystem::path &source_path,
+                       VmContext context) {
+  context.dump_state = false;
+  context.vm_as_backend = false;
+  context.config.setStdinFile("");
+  context.config.setTraceFile("");
+  context.config.setProfilingEnabled(false);
+  RVSSVM vm(std::move(context));
+  vm.LoadProgram(assemble(source_path.string(), false));
+
+  KernelResult result;
+  result.format = format;
+  auto start = std::chrono::steady_clock::now();
+  while (!vm.IsHalted()) {
+    vm.RunQuantum(kSliceInstructions);
+  }
+  result.wall_time_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (!vm.exited_) {
+    throw std::runtime_error(source_path.string() + ": kernel ended without exiting");
+  }
+  result.instructions = vm.instructions_retired_;
+  result.cycles = vm.cycle_s_;
+
+  const unsigned int lanes = Lanes(format), word = WordBytes(format);
+  const unsigned int groups = (workload.filters + lanes - 1)/lanes;
+  const uint64_t output = vm.context_.config.getDataSectionStart() + vm.program_.symbol_table.at("output").address;
+  const size_t pixels = static_cast<size_t>(workload.tile)*workload.tile;
+  result.output.resize(pixels*workload.filters);
+  for (size_t pixel = 0; pixel < pixels; ++pixel) {
+    for (unsigned int g = 0; g < groups; ++g) {
+      uint64_t address = output + (pixel*groups + g)*word;
+      std::array<float, 4> values = Decode(format, word == 8 ? vm.memory_controller_.ReadDoubleWord(address)
+                                                             : vm.memory_controller_.ReadWord(address));
+      for (unsigned int lane = 0; lane < lanes && g*lanes + lane < workload.filters; ++lane) {
+        result.output[pixel*workload.filters + g*lanes + lane] = values[lane];
+      }
+    }
+  }
+
+  double error_squares = 0, reference_squares = 0;
+  for (size_t i = 0; i < result.output.size(); ++i) {
+    double error = static_cast<double>(result.output[i]) - workload.reference[i];
+    result.max_abs_error = std::max(result.max_abs_error, std::fabs(error));
+    error_squares += error*error;
+    reference_squares += static_cast<double>(workload.reference[i])*workload.reference[i];
+  }
+  result.rms_rel_error = reference_squares > 0 ? std::sqrt(error_squares/reference_squares) : std::sqrt(error_squares);
+  return result;
+}
+
+std::string FormatName(NumberFormat format) {
+  switch (format) {
+    case NumberFormat::kFp32: return "fp32";
+    case NumberFormat::kFp16: return "fp16";
+    case NumberFormat::kBf16: return "bf16";
+    case NumberFormat::kMsfp16: return "msfp16";
+  }
+  return "";
+}
+
+NumberFormat ParseFormat(const std::string &name) {
+  for (NumberFormat format : {NumberFormat::kFp32, NumberFormat::kFp16, NumberFormat::kBf16, NumberFormat::kMsfp16}) {
+    if (FormatName(format) == name) {
+      return format;
+    }
+  }
+  throw std::invalid_argument("Unknown number format: " + name);
+}
+
+void PrintLayers(const std::vector<ConvLayer> &layers, std::ostream &os) {
+  os << "conv  darknet  input          filters  size/stride  output\n";
+  for (const ConvLayer &layer : layers) {
+    std::ostringstream input, output;
+    input << layer.in_width << "x" << layer.in_height << "x" << layer.in_channels;
+    output << layer.out_width << "x" << layer.out_height << "x" << layer.filters;
+    os << std::left << std::setw(6) << layer.index << std::setw(9) << layer.darknet_layer << std::setw(15)
+       << input.str() << std::setw(9) << layer.filters << std::setw(13)
+       << (std::to_string(layer.size) + "/" + std::to_string(layer.stride)) << output.str() << "\n";
+  }
+  os << std::right;
+}
+
+void PrintReport(const Workload &workload, const std::vector<KernelResult> &results, std::ostream &os) {
+  const ConvLayer &layer = workload.layer;
+  const uint64_t macs = static_cast<uint64_t>(workload.tile)*workload.tile*workload.filters*layer.size*layer.size
+                        *workload.channels;
+  os << "Layer " << layer.index << " (Darknet layer " << layer.darknet_layer << "): " << workload.tile << "x"
+     << workload.tile << " outputs x " << workload.filters << " filters, " << layer.size << "x" << layer.size << "x"
+     << workload.channels << " kernel, stride " << layer.stride << ", " << macs << " MACs\n";
+  os << "format   instructions      cycles   inst/MAC   wall ms    max abs err   rms rel err\n";
+  for (const KernelResult &result : results) {
+    os << std::left << std::setw(7) << FormatName(result.format) << std::right << std::setw(14) << result.instructions
+       << std::setw(12) << result.cycles << std::fixed << std::setprecision(3) << std::setw(11)
+       << static_cast<double>(result.instructions)/static_cast<double>(std::max<uint64_t>(macs, 1))
+       << std::setprecision(2) << std::setw(10) << result.wall_time_ms << std::scientific << std::setprecision(3)
+       << std::setw(15) << result.max_abs_error << std::setw(14) << result.rms_rel_error << std::defaultfloat << "\n";
+  }
+}
+
+} // namespace yolo_bench
@@ -0,0 +1,15 @@
+.data
+buffer: .zero 16
+
+.text
+    li a7, 63
+    li a0, 0
+    la a1, buffer
+    li a2, 16
+    ecall
+
+    mv a2, a0
+    li a7, 64
+    li a0, 1
+    la a1, buffer
+    ecall
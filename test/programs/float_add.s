@@ -0,0 +1,11 @@
+.data
+a: .double 1.5
+b: .double -3.75
+
+.text
+    la t0, a
+    fld f0, 0(t0)
+    la t0, b
+    fld f1, 0(t0)
+    fadd.d f10, f0, f1
+    fcvt.l.d a0, f10
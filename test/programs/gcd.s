@@ -0,0 +1,20 @@
+.data
+.dword 1071
+.dword 462
+
+.text
+
+lui x3, 0x10000
+
+ld x10, 0(x3)
+ld x11, 8(x3)
+
+gcd_loop:
+    beq x11, x0, end_gcd
+    rem x12, x10, x11
+    mv x10, x11
+    mv x11, x12
+    jal x0, gcd_loop
+
+end_gcd:
+    sd x10, 16(x3)
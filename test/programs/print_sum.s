@@ -0,0 +1,34 @@
+.data
+label: .string "sum="
+newline: .string "\n"
+
+.text
+    li t0, 1
+    li t1, 11
+    li a0, 0
+loop:
+    add a0, a0, t0
+    addi t0, t0, 1
+    blt t0, t1, loop
+
+    mv s0, a0
+    li a7, 64
+    li a0, 1
+    la a1, label
+    li a2, 4
+    ecall
+
+    li a7, 1
+    mv a0, s0
+    ecall
+
+    li a7, 64
+    li a0, 1
+    la a1, newline
+    li a2, 1
+    ecall
+
+    li a7, 10
+    li a0, 3
+    ecall
+    li s0, 0
@@ -1,5 +1,5 @@
 #include <gtest/gtest.h>
-#include "../src/vm/alu.h"
+#include "vm/alu.h"
 
 TEST(ALUTest, AddTest) {
   alu::Alu alu;
@@ -41,4 +41,32 @@ TEST(ALUTest, SraTest) {
   auto result = alu.execute(alu::AluOp::kSra, 0xfffffffffffffffa, 2);
   ASSERT_EQ(result.first, 0xfffffffffffffffe);
   ASSERT_FALSE(result.second);
-}
\ No newline at end of file
+}
+TEST(ALUTest, OperandCacheIsPerInstanceTest) {
+  alu::Alu first;
+  alu::Alu second;
+  auto result = first.execute(alu::AluOp::kAdd_cache, 1, 2);
+  ASSERT_EQ(result.first, 3);
+  ASSERT_TRUE(first.operand_caches_[alu::Alu::OperandCache::kAdd].cache_valid);
+  ASSERT_FALSE(second.operand_caches_[alu::Alu::OperandCache::kAdd].cache_valid);
+  result = second.execute(alu::AluOp::kAdd_cache, 1, 2);
+  ASSERT_EQ(result.first, 3);
+}
+
+TEST(ALUTest, RandomSeedIsReproducibleTest) {
+  alu::Alu first(42);
+  alu::Alu second(42);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_EQ(first.execute(alu::AluOp::kRandom_flip, 0, 0).first,
+              second.execute(alu::AluOp::kRandom_flip, 0, 0).first);
+  }
+}
+
+TEST(ALUTest, Msfp16KeepsTheLargestLaneTest) {
+  // The lane with the largest exponent used to saturate just below 2^e.
+  std::array<float, 4> values = alu::msfp16_unpack(alu::msfp16_pack({1.5f, -3.75f, 0.25f, 2.0f}));
+  EXPECT_EQ(values[0], 1.5f);
+  EXPECT_EQ(values[1], -3.75f);
+  EXPECT_EQ(values[2], 0.25f);
+  EXPECT_EQ(values[3], 2.0f);
+}
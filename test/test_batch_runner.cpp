@@ -0,0 +1,62 @@
+/**
+ * File Name: test_batch_runner.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "batch_runner.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+
+TEST(BatchRunnerTest, ParseExpectedFileTest) {
+  std::filesystem::path path = TempPath("golden.expected");
+  std::ofstream(path) << "# comment\n"
+                         "reg a0 50\n"
+                         "reg x5 -1\n"
+                         "reg fa1 0x3ff0000000000000\n"
+                         "mem 0x10000000 2a 00 ff\n"
+                         "stdout a\\tb\n"
+                         "stdout \\n\n"
+                         "exit 3\n";
+
+  batch_runner::ExpectedResult expected = batch_runner::ParseExpectedFile(path);
+  ASSERT_EQ(expected.gprs.size(), 2);
+  EXPECT_EQ(expected.gprs[0], std::make_pair(size_t{10}, uint64_t{50}));
+  EXPECT_EQ(expected.gprs[1].second, UINT64_MAX);
+  ASSERT_EQ(expected.fprs.size(), 1);
+  EXPECT_EQ(expected.fprs[0].first, 11);
+  ASSERT_EQ(expected.memory.size(), 1);
+  EXPECT_EQ(expected.memory[0].address, 0x10000000);
+  EXPECT_EQ(expected.memory[0].bytes, (std::vector<uint8_t>{0x2a, 0x00, 0xff}));
+  EXPECT_EQ(expected.stdout_text, "a\tb\n");
+  EXPECT_EQ(expected.exit_code, 3);
+
+  std::ofstream(path) << "reg q9 1\n";
+  EXPECT_THROW(batch_runner::ParseExpectedFile(path), std::runtime_error);
+}
+
+TEST(BatchRunnerTest, RunBatchTest) {
+  std::vector<batch_runner::ProgramResult> results = batch_runner::RunBatch(VM_TEST_PROGRAMS_DIR, 2);
+  ASSERT_FALSE(results.empty());
+  for (const auto &result : results) {
+    EXPECT_TRUE(result.passed) << result.program << ": "
+                               << (result.failures.empty() ? "" : result.failures.front());
+    EXPECT_TRUE(result.checked);
+    EXPECT_GT(result.instructions_retired, 0);
+  }
+}
+
+TEST(BatchRunnerTest, RunProgramMismatchTest) {
+  std::filesystem::path directory = TempPath("batch");
+  std::filesystem::create_directories(directory);
+  std::ofstream(directory / "add.s") << "li a0, 2\naddi a0, a0, 3\n";
+  std::ofstream(directory / "add.expected") << "reg a0 6\n";
+
+  batch_runner::ProgramResult result = batch_runner::RunProgram(directory / "add.s");
+  EXPECT_FALSE(result.passed);
+  ASSERT_EQ(result.failures.size(), 1);
+  EXPECT_EQ(result.failures[0], "x10: expected 0x6, got 0x5");
+}
@@ -0,0 +1,120 @@
+/**
+ * File Name: test_branch_predictor.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/branch_predictor.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Mispredictions over the last half of a repeating direction pattern, once trained.
+int TrainedMisses(DirectionPredictor &predictor, uint64_t pc, const std::vector<bool> &pattern, int rounds) {
+  int misses = 0;
+  for (int round = 0; round < rounds; ++round) {
+    for (bool taken : pattern) {
+      misses += round >= rounds/2 && predictor.Predict(pc) != taken;
+      predictor.Update(pc, taken);
+    }
+  }
+  return misses;
+}
+
+} // namespace
+
+TEST(BranchPredictorTest, DirectionPredictorTest) {
+  StaticNotTakenPredictor static_not_taken;
+  BimodalPredictor bimodal(1024);
+  GsharePredictor gshare(1024, 8);
+  TournamentPredictor tournament(1024, 8);
+
+  EXPECT_EQ(TrainedMisses(static_not_taken, 0x100, {true}, 10), 5);
+  EXPECT_EQ(TrainedMisses(bimodal, 0x100, {true}, 10), 0);
+  // A loop branch taken three times then falling through: bimodal misses every exit.
+  EXPECT_EQ(TrainedMisses(bimodal, 0x200, {true, true, true, false}, 40), 20);
+  // Global history captures the period, so gshare and tournament learn it completely.
+  EXPECT_EQ(TrainedMisses(gshare, 0x200, {true, true, true, false}, 40), 0);
+  EXPECT_EQ(TrainedMisses(tournament, 0x200, {true, true, true, false}, 40), 0);
+  // Bimodal is stuck on alternation; the tournament chooser moves that branch to gshare.
+  BimodalPredictor alternating(1024);
+  EXPECT_GE(TrainedMisses(alternating, 0x300, {true, false}, 20), 10);
+  EXPECT_EQ(TrainedMisses(tournament, 0x300, {true, false}, 20), 0);
+}
+
+TEST(BranchPredictorTest, TargetAndReturnTest) {
+  BranchTargetBuffer btb(4);
+  EXPECT_FALSE(btb.Predicts(0x10, 0x40));
+  btb.Update(0x10, 0x40);
+  EXPECT_TRUE(btb.Predicts(0x10, 0x40));
+  EXPECT_FALSE(btb.Predicts(0x10, 0x44));
+  btb.Update(0x20, 0x80); // same set in a 4-entry table
+  EXPECT_FALSE(btb.Predicts(0x10, 0x40));
+
+  ReturnAddressStack ras(2);
+  uint64_t address = 0;
+  EXPECT_FALSE(ras.Pop(address));
+  ras.Push(1);
+  ras.Push(2);
+  ras.Push(3); // overwrites 1
+  EXPECT_TRUE(ras.Pop(address));
+  EXPECT_EQ(address, 3);
+  EXPECT_TRUE(ras.Pop(address));
+  EXPECT_EQ(address, 2);
+  EXPECT_FALSE(ras.Pop(address));
+
+  // jal ra, jalr x0 0(ra), jal x0, jalr t0 (call through t0)
+  EXPECT_EQ(ClassifyJump(0x008000ef), BranchKind::kCall);
+  EXPECT_EQ(ClassifyJump(0x00008067), BranchKind::kReturn);
+  EXPECT_EQ(ClassifyJump(0x0080006f), BranchKind::kJump);
+  EXPECT_EQ(ClassifyJump(0x000302e7), BranchKind::kCall);
+}
+
+TEST(BranchPredictorTest, VmMispredictionTest) {
+  const std::string source = "main:\n"
+                             "  addi s0, x0, 50\n"
+                             "loop:\n"
+                             "  jal ra, work\n"
+                             "  addi s0, s0, -1\n"
+                             "  bne s0, x0, loop\n"
+                             "  jal x0, end\n"
+                             "work:\n"
+                             "  addi a0, a0, 1\n"
+                             "  jalr x0, 0(ra)\n"
+                             "end:\n"
+                             "  addi a1, x0, 1\n";
+
+  VmContext context = HeadlessContext();
+  context.config.setBranchPredictorType(vm_config::BranchPredictorType::BIMODAL);
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("branch_predictor.s", source));
+  vm.Run();
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 50);
+
+  const BranchPredictor::Stats &stats = vm.branch_predictor_.GetStats();
+  EXPECT_EQ(stats.conditional, 50);
+  EXPECT_EQ(stats.taken, 49);
+  EXPECT_EQ(stats.jumps, 51);
+  EXPECT_EQ(stats.returns, 50);
+  // bne misses its first iteration, while the counter trains, and the loop exit.
+  EXPECT_EQ(stats.direction_mispredictions, 2);
+  // The BTB misses each jal once; the RAS predicts every return.
+  EXPECT_EQ(stats.target_mispredictions, 2);
+  EXPECT_EQ(stats.return_mispredictions, 0);
+  EXPECT_EQ(vm.branch_mispredictions_, stats.Mispredictions());
+
+  std::vector<BranchPredictor::Site> sites = vm.branch_predictor_.GetSites();
+  ASSERT_EQ(sites.size(), 4);
+  EXPECT_EQ(sites[1].pc, 12);
+  EXPECT_EQ(sites[1].executed, 50);
+  EXPECT_EQ(sites[1].mispredicted, 2);
+
+  std::ostringstream report;
+  vm.branch_predictor_.WriteReport(report, vm.program_, 5);
+  EXPECT_NE(report.str().find("Predictor: bimodal"), std::string::npos);
+}
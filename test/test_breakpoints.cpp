@@ -0,0 +1,131 @@
+/**
+ * File Name: test_breakpoints.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/breakpoints.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <stdexcept>
+
+namespace {
+
+uint64_t Evaluate(const std::string &expression, RegisterFile &registers, MemoryController &memory, uint64_t pc = 0) {
+  return BreakpointCondition::Compile(expression).Evaluate(pc, registers, memory);
+}
+
+} // namespace
+
+TEST(BreakpointTest, ConditionTest) {
+  RegisterFile registers;
+  registers.Reset();
+  MemoryController memory;
+  registers.WriteGpr(10, 5);
+  registers.WriteGpr(2, 0x1000);
+  registers.WriteFpr(1, 0x4000000000000000);
+  memory.WriteDoubleWord(0x1008, 0x1122334455667788);
+
+  EXPECT_EQ(Evaluate("a0 == 5", registers, memory), 1);
+  EXPECT_EQ(Evaluate("x10 != 5", registers, memory), 0);
+  EXPECT_EQ(Evaluate("1 + 2 * 3", registers, memory), 7);
+  EXPECT_EQ(Evaluate("(1 + 2) * 3", registers, memory), 9);
+  EXPECT_EQ(Evaluate("1 << 4 | 1", registers, memory), 17);
+  EXPECT_EQ(Evaluate("-1 < 0 && !0", registers, memory), 1);
+  EXPECT_EQ(Evaluate("a0 - 6 >= 0 || pc == 0x20", registers, memory, 0x20), 1);
+  EXPECT_EQ(Evaluate("~0 >> 60", registers, memory), 0xF);
+  EXPECT_EQ(Evaluate("7 / 0", registers, memory), UINT64_MAX);
+  EXPECT_EQ(Evaluate("7 % 0", registers, memory), 7);
+  EXPECT_EQ(Evaluate("mem[sp + 8]", registers, memory), 0x1122334455667788);
+  EXPECT_EQ(Evaluate("mem8[sp+8]", registers, memory), 0x88);
+  EXPECT_EQ(Evaluate("mem32[sp + 12] == 0x11223344", registers, memory), 1);
+  EXPECT_EQ(Evaluate("f1 == 0x4000000000000000", registers, memory), 1);
+
+  EXPECT_THROW(BreakpointCondition::Compile("a0 +"), std::invalid_argument);
+  EXPECT_THROW(BreakpointCondition::Compile("a0 == bogus"), std::invalid_argument);
+  EXPECT_THROW(BreakpointCondition::Compile("(a0"), std::invalid_argument);
+  EXPECT_THROW(BreakpointCondition::Compile("mem[a0"), std::invalid_argument);
+  EXPECT_THROW(BreakpointCondition::Compile("a0 5"), std::invalid_argument);
+}
+
+TEST(BreakpointTest, BitmapTest) {
+  BreakpointSet breakpoints;
+  breakpoints.Reset(0x1000, 0x1000 + 200 * 4);
+  breakpoints.Add(0x1000);
+  breakpoints.Add(0x1000 + 64 * 4);
+  breakpoints.Add(0x1000 + 199 * 4);
+
+  EXPECT_TRUE(breakpoints.Contains(0x1000));
+  EXPECT_TRUE(breakpoints.Contains(0x1000 + 64 * 4));
+  EXPECT_TRUE(breakpoints.Contains(0x1000 + 199 * 4));
+  EXPECT_FALSE(breakpoints.Contains(0x1004));
+  EXPECT_FALSE(breakpoints.Contains(0x1001));
+  EXPECT_FALSE(breakpoints.Contains(0xFFC));
+  EXPECT_FALSE(breakpoints.Contains(0x1000 + 200 * 4));
+
+  EXPECT_THROW(breakpoints.Add(0x1000 + 200 * 4), std::invalid_argument);
+  EXPECT_THROW(breakpoints.Add(0x1002), std::invalid_argument);
+  EXPECT_THROW(breakpoints.Add(0x1004, "", 0), std::invalid_argument);
+
+  EXPECT_TRUE(breakpoints.Remove(0x1000 + 64 * 4));
+  EXPECT_FALSE(breakpoints.Remove(0x1000 + 64 * 4));
+  EXPECT_FALSE(breakpoints.Contains(0x1000 + 64 * 4));
+  ASSERT_EQ(breakpoints.GetBreakpoints().size(), 2);
+  EXPECT_EQ(breakpoints.GetBreakpoints()[1].address, 0x1000 + 199 * 4);
+
+  breakpoints.Reset(0, 8);
+  EXPECT_EQ(breakpoints.Size(), 0);
+  EXPECT_FALSE(breakpoints.Contains(0x1000));
+}
+
+TEST(BreakpointTest, HitCountTest) {
+  RegisterFile registers;
+  registers.Reset();
+  MemoryController memory;
+  BreakpointSet breakpoints;
+  breakpoints.Reset(0, 16);
+  breakpoints.Add(4, "a0 > 1", 2);
+
+  registers.WriteGpr(10, 1);
+  EXPECT_FALSE(breakpoints.ShouldBreak(4, registers, memory)); // condition false, not a hit
+  registers.WriteGpr(10, 2);
+  EXPECT_FALSE(breakpoints.ShouldBreak(4, registers, memory)); // first hit
+  EXPECT_TRUE(breakpoints.ShouldBreak(4, registers, memory));
+  EXPECT_TRUE(breakpoints.ShouldBreak(4, registers, memory));
+  EXPECT_FALSE(breakpoints.ShouldBreak(8, registers, memory));
+  EXPECT_EQ(breakpoints.GetBreakpoints()[0].hits, 3);
+}
+
+TEST(BreakpointTest, VmConditionalBreakpointTest) {
+  const std::string source = "main:\n"
+                             "  addi t1, x0, 10\n"
+                             "loop:\n"
+                             "  addi t1, t1, -1\n"
+                             "  bne t1, x0, loop\n"
+                             "  addi a0, x0, 7\n";
+
+  VmContext context = HeadlessContext();
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("breakpoints.s", source));
+  vm.AddSymbolBreakpoint("loop", "t1 == 4");
+  EXPECT_TRUE(vm.CheckBreakpoint(4));
+
+  vm.DebugRun();
+  EXPECT_EQ(vm.output_status_, "VM_BREAKPOINT_HIT");
+  EXPECT_EQ(vm.program_counter_, 4);
+  EXPECT_EQ(vm.registers_.ReadGpr(6), 4);
+
+  vm.AddSymbolBreakpoint("loop", "", 3);
+  vm.Step();
+  vm.DebugRun();
+  EXPECT_EQ(vm.program_counter_, 4);
+  EXPECT_EQ(vm.registers_.ReadGpr(6), 1);
+
+  vm.RemoveSymbolBreakpoint("loop");
+  vm.Step();
+  vm.DebugRun();
+  EXPECT_EQ(vm.output_status_, "VM_PROGRAM_END");
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 7);
+}
@@ -0,0 +1,138 @@
+/**
+ * File Name: test_cache.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/cache/cache.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+namespace {
+
+vm_config::VmConfig CacheConfig(uint64_t size, uint64_t block_size, uint64_t associativity) {
+  vm_config::VmConfig config;
+  config.setCacheEnabled(true);
+  config.setCacheSize(size);
+  config.setCacheBlockSize(block_size);
+  config.setCacheAssociativity(associativity);
+  return config;
+}
+
+} // namespace
+
+TEST(CacheTest, ReplacementPolicyTest) {
+  // One set of two 16-byte lines.
+  vm_config::VmConfig config = CacheConfig(32, 16, 2);
+  cache::Cache lru;
+  lru.Start(config);
+  EXPECT_FALSE(lru.Access(0x000, false));
+  EXPECT_TRUE(lru.Access(0x00c, false));
+  EXPECT_FALSE(lru.Access(0x100, false));
+  EXPECT_TRUE(lru.Access(0x000, false)); // 0x100 is now least recently used
+  EXPECT_FALSE(lru.Access(0x200, false));
+  EXPECT_TRUE(lru.Access(0x000, false));
+  EXPECT_FALSE(lru.Access(0x100, false));
+
+  config.setCacheReplacementPolicy(vm_config::CacheReplacementPolicy::FIFO);
+  cache::Cache fifo;
+  fifo.Start(config);
+  fifo.Access(0x000, false);
+  fifo.Access(0x100, false);
+  EXPECT_TRUE(fifo.Access(0x000, false));
+  EXPECT_FALSE(fifo.Access(0x200, false)); // evicts 0x000, filled first despite its use
+  EXPECT_FALSE(fifo.Access(0x000, false));
+  EXPECT_EQ(fifo.GetStats().accesses, 5);
+  EXPECT_EQ(fifo.GetStats().misses, 4);
+  EXPECT_DOUBLE_EQ(fifo.GetStats().MissRate(), 0.8);
+}
+
+TEST(CacheTest, WritePolicyTest) {
+  // Direct-mapped, four 16-byte lines.
+  vm_config::VmConfig config = CacheConfig(64, 16, 1);
+  cache::Cache write_back;
+  write_back.Start(config);
+  EXPECT_FALSE(write_back.Access(0x00, true));
+  EXPECT_TRUE(write_back.Access(0x04, false));
+  EXPECT_FALSE(write_back.Access(0x40, false)); // same set: the dirty line is written back
+  EXPECT_FALSE(write_back.Access(0x00, false));
+  EXPECT_EQ(write_back.GetStats().writebacks, 1);
+  EXPECT_EQ(write_back.GetStats().write_misses, 1);
+
+  config.setCacheWriteBack(false);
+  config.setCacheWriteAllocate(false);
+  cache::Cache write_through;
+  write_through.Start(config);
+  EXPECT_FALSE(write_through.Access(0x00, true));
+  EXPECT_FALSE(write_through.Access(0x00, false)); // the write miss did not allocate
+  EXPECT_TRUE(write_through.Access(0x00, true));
+  EXPECT_FALSE(write_through.Access(0x40, false));
+  EXPECT_EQ(write_through.GetStats().writebacks, 0);
+  EXPECT_EQ(write_through.GetStats().writes, 2);
+}
+
+TEST(CacheTest, RejectsBadGeometryTest) {
+  cache::Cache cache;
+  EXPECT_THROW(cache.Start(CacheConfig(1024, 48, 2)), std::invalid_argument);
+  EXPECT_THROW(cache.Start(CacheConfig(1000, 64, 2)), std::invalid_argument);
+  EXPECT_THROW(cache.Start(CacheConfig(1024, 64, 0)), std::invalid_argument);
+  vm_config::VmConfig disabled = CacheConfig(1000, 48, 0);
+  disabled.setCacheEnabled(false);
+  cache.Start(disabled);
+  EXPECT_FALSE(cache.IsEnabled());
+}
+
+TEST(CacheTest, ModifyConfigKeepsGeometryValidTest) {
+  vm_config::VmConfig config = CacheConfig(32768, 64, 8);
+  EXPECT_THROW(config.modifyConfig("Cache", "cache_size", "1000"), std::invalid_argument);
+  EXPECT_THROW(config.modifyConfig("Cache", "cache_block_size", "48"), std::invalid_argument);
+  EXPECT_THROW(config.modifyConfig("Cache", "cache_associativity", "0"), std::invalid_argument);
+  EXPECT_EQ(config.getCacheSize(), 32768);
+  EXPECT_EQ(config.getCacheBlockSize(), 64);
+  EXPECT_EQ(config.getCacheAssociativity(), 8);
+  cache::Cache cache;
+  EXPECT_NO_THROW(cache.Start(config));
+
+  // A disabled cache takes any geometry, but cannot be enabled with a bad one.
+  config.modifyConfig("Cache", "cache_enabled", "false");
+  config.modifyConfig("Cache", "cache_size", "1000");
+  EXPECT_THROW(config.modifyConfig("Cache", "cache_enabled", "true"), std::invalid_argument);
+  EXPECT_FALSE(config.getCacheEnabled());
+  config.modifyConfig("Cache", "cache_size", "1024");
+  config.modifyConfig("Cache", "cache_associativity", "16");
+  config.modifyConfig("Cache", "cache_enabled", "true");
+  EXPECT_NO_THROW(cache.Start(config));
+}
+
+TEST(CacheTest, MissesStallTheVmTest) {
+  // Two passes over 64 KB at one load per 64-byte line: twice the default 32 KB cache.
+  const std::string source = ".data\n"
+                             "buffer: .zero 65536\n"
+                             ".text\n"
+                             "  addi s2, x0, 2\n"
+                             "pass:\n"
+                             "  la s0, buffer\n"
+                             "  li s1, 1024\n"
+                             "loop:\n"
+                             "  ld t0, 0(s0)\n"
+                             "  addi s0, s0, 64\n"
+                             "  addi s1, s1, -1\n"
+                             "  bne s1, x0, loop\n"
+                             "  addi s2, s2, -1\n"
+                             "  bne s2, x0, pass\n";
+  VmContext context = HeadlessContext();
+  context.config.setCacheEnabled(true);
+  context.config.setCacheMissPenalty(20);
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("cache.s", source));
+  while (!vm.IsHalted()) {
+    vm.RunQuantum(65536);
+  }
+  const cache::CacheStats &stats = vm.data_cache_.GetStats();
+  EXPECT_EQ(stats.accesses, 2048);
+  EXPECT_EQ(stats.misses, 2048);
+  EXPECT_EQ(vm.cycle_s_, vm.instructions_retired_ + 20*2048);
+  EXPECT_EQ(vm.stall_cycles_, 20*2048);
+  EXPECT_FALSE(vm.UsesBinaryTranslation());
+}
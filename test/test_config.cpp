@@ -7,6 +7,12 @@
 #include <gtest/gtest.h>
 
 #include "config.h"
+#include "globals.h"
+#include "utils.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
 
 // TEST(ConfigTest, GetKeyValueTest) {
 //   std::string processor_type = vm_config::ini::Get("Execution", "processor_type");
@@ -29,3 +35,41 @@
 //   ASSERT_THROW(vm_config::ini::Get("NonExistentSection", "non_existent_key"), std::invalid_argument);
 //   ASSERT_THROW(vm_config::ini::Set("NonExistentSection", "non_existent_key", "value"), std::invalid_argument);
 // }
+
+TEST(ConfigTest, LoadsTheDefaultConfigFileTest) {
+  std::filesystem::path saved = globals::config_file_path;
+  globals::config_file_path = TempPath("config.ini");
+  SetupConfigFile();
+  vm_config::VmConfig config;
+  std::vector<std::string> errors = config.loadConfigFile(globals::config_file_path);
+  EXPECT_TRUE(errors.empty()) << errors.front();
+  EXPECT_FALSE(config.getTimingEnabled());
+  EXPECT_EQ(config.getTimingLatencies().div, vm_config::TimingLatencies().div);
+  std::filesystem::remove(globals::config_file_path);
+  globals::config_file_path = saved;
+}
+
+TEST(ConfigTest, LoadConfigFileReportsBadLinesTest) {
+  std::filesystem::path file = TempPath("config_errors.ini");
+  std::ofstream(file) << "[General]\n"
+                         "name=vm\n"
+                         "[Timing]\n"
+                         "timing_enabled = true ; comment\n"
+                         "latency_mul=5\n"
+                         "latency_teleport=1\n"
+                         "\n"
+                         "# comment\n"
+                         "[Cache]\n"
+                         "cache_size\n"
+                         "cache_enabled=maybe\n";
+  vm_config::VmConfig config;
+  std::vector<std::string> errors = config.loadConfigFile(file);
+  ASSERT_EQ(errors.size(), 3);
+  EXPECT_NE(errors[0].find(":6: latency_teleport"), std::string::npos);
+  EXPECT_NE(errors[1].find(":10: Expected key=value"), std::string::npos);
+  EXPECT_NE(errors[2].find(":11: cache_enabled"), std::string::npos);
+  EXPECT_TRUE(config.getTimingEnabled());
+  EXPECT_EQ(config.getTimingLatencies().mul, 5);
+  std::filesystem::remove(file);
+  EXPECT_THROW(config.loadConfigFile(file), std::runtime_error);
+}
@@ -0,0 +1,291 @@
+/**
+ * File Name: test_dbt.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/rvss/rvss_vm.h"
+#include "vm/dbt/dbt_engine.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+void ExpectSameState(RVSSVM &interpreted, RVSSVM &translated, uint64_t data_size) {
+  EXPECT_EQ(interpreted.registers_.GetGprValues(), translated.registers_.GetGprValues());
+  EXPECT_EQ(interpreted.program_counter_, translated.program_counter_);
+  EXPECT_EQ(interpreted.instructions_retired_, translated.instructions_retired_);
+  uint64_t data = interpreted.context_.config.getDataSectionStart();
+  for (uint64_t offset = 0; offset < data_size; offset += 8) {
+    EXPECT_EQ(interpreted.memory_controller_.ReadDoubleWord(data + offset),
+              translated.memory_controller_.ReadDoubleWord(data + offset)) << "at data offset " << offset;
+  }
+}
+
+// Loops, calls through jalr, every load and store width and the M extension.
+const char *kLoopProgram = ".data\n"
+                           "arr: .dword 3, -5, 7, -11, 13, -17, 19, -23\n"
+                           "out: .dword 0, 0, 0, 0\n"
+                           ".text\n"
+                           "  la s0, arr\n"
+                           "  la s1, out\n"
+                           "  addi s2, x0, 0\n"
+                           "  addi s3, x0, 300\n"
+                           "  addi t3, x0, 1\n"
+                           "loop:\n"
+                           "  andi t0, s2, 7\n"
+                           "  slli t0, t0, 3\n"
+                           "  add t1, s0, t0\n"
+                           "  ld t2, 0(t1)\n"
+                           "  jal ra, mix\n"
+                           "  sd t2, 0(t1)\n"
+                           "  lb t4, 1(t1)\n"
+                           "  lhu t5, 2(t1)\n"
+                           "  lw t6, 4(t1)\n"
+                           "  xor t3, t3, t4\n"
+                           "  add t3, t3, t5\n"
+                           "  sub t3, t3, t6\n"
+                           "  sb t3, 0(s1)\n"
+                           "  sh t3, 2(s1)\n"
+                           "  sw t3, 4(s1)\n"
+                           "  addi s2, s2, 1\n"
+                           "  blt s2, s3, loop\n"
+                           "  sd t3, 8(s1)\n"
+                           "  addi a0, t3, 0\n"
+                           "  addi a7, x0, 93\n"
+                           "  ecall\n"
+                           "mix:\n"
+                           "  mul t2, t2, s2\n"
+                           "  addi a1, s2, 3\n"
+                           "  div a2, t2, a1\n"
+                           "  rem a3, t2, a1\n"
+                           "  divu a4, t2, a1\n"
+                           "  mulh a5, t2, t3\n"
+                           "  mulhu a6, t2, t3\n"
+                           "  add t2, t2, a2\n"
+                           "  xor t2, t2, a3\n"
+                           "  sltu a2, a4, a5\n"
+                           "  srai a3, t2, 5\n"
+                           "  or t2, t2, a2\n"
+                           "  bge a6, x0, mix_done\n"
+                           "  sra t2, t2, a2\n"
+                           "mix_done:\n"
+                           "  add t2, t2, a3\n"
+                           "  jalr x0, 0(ra)\n";
+
+} // namespace
+
+TEST(DbtTest, MatchesInterpreterTest) {
+  if (!dbt::DbtEngine::IsSupported()) {
+    GTEST_SKIP() << "Binary translation needs an x86-64 host";
+  }
+  AssembledProgram program = AssembleSource("dbt_loop.s", kLoopProgram);
+  VmContext context = HeadlessContext();
+
+  RVSSVM interpreted(context);
+  interpreted.LoadProgram(program);
+  interpreted.RunQuantum(UINT64_MAX);
+
+  RVSSVM translated(context);
+  translated.LoadProgram(program);
+  dbt::DbtEngine engine(1);
+  uint64_t executed = engine.Run(translated, UINT64_MAX);
+
+  EXPECT_EQ(executed, translated.instructions_retired_);
+  EXPECT_GT(engine.GetStats().native_instructions, engine.GetStats().interpreted_instructions);
+  EXPECT_GT(engine.GetStats().translated_instructions, 0);
+  ExpectSameState(interpreted, translated, 96);
+}
+
+TEST(DbtTest, InstructionLimitTest) {
+  if (!dbt::DbtEngine::IsSupported()) {
+    GTEST_SKIP() << "Binary translation needs an x86-64 host";
+  }
+  AssembledProgram program = AssembleSource("dbt_limit.s", kLoopProgram);
+  VmContext context = HeadlessContext();
+
+  // Stopping mid-block and resuming must land exactly where the interpreter does.
+  for (uint64_t quantum : {1, 7, 23, 64, 1000}) {
+    RVSSVM interpreted(context);
+    interpreted.LoadProgram(program);
+    RVSSVM translated(context);
+    translated.LoadProgram(program);
+    dbt::DbtEngine engine(2);
+    for (int slice = 0; slice < 5; ++slice) {
+      EXPECT_EQ(interpreted.RunQuantum(quantum), engine.Run(translated, quantum));
+      ExpectSameState(interpreted, translated, 96);
+    }
+  }
+}
+
+TEST(DbtTest, FaultTest) {
+  if (!dbt::DbtEngine::IsSupported()) {
+    GTEST_SKIP() << "Binary translation needs an x86-64 host";
+  }
+  // The load faults once s1 has walked past the end of memory.
+  AssembledProgram program = AssembleSource("dbt_fault.s", ".text\n"
+                                                                    "  lui s1, 4096\n"
+                                                                    "  addi s1, s1, -64\n"
+                                                                    "loop:\n"
+                                                                    "  ld t0, 0(s1)\n"
+                                                                    "  addi s1, s1, 8\n"
+                                                                    "  addi s2, s2, 1\n"
+                                                                    "  jal x0, loop\n");
+  VmContext context = HeadlessContext();
+  context.config.setMemorySize(0x1000000);
+
+  RVSSVM interpreted(context);
+  interpreted.LoadProgram(program);
+  EXPECT_ANY_THROW(interpreted.RunQuantum(UINT64_MAX));
+
+  RVSSVM translated(context);
+  translated.LoadProgram(program);
+  dbt::DbtEngine engine(1);
+  EXPECT_ANY_THROW(engine.Run(translated, UINT64_MAX));
+
+  EXPECT_EQ(interpreted.registers_.GetGprValues(), translated.registers_.GetGprValues());
+  EXPECT_EQ(interpreted.program_counter_, translated.program_counter_);
+  EXPECT_EQ(interpreted.current_delta_.old_pc, translated.current_delta_.old_pc);
+  EXPECT_EQ(translated.registers_.ReadGpr(18), 8);
+}
+
+TEST(DbtTest, RandomProgramTest) {
+  if (!dbt::DbtEngine::IsSupported()) {
+    GTEST_SKIP() << "Binary translation needs an x86-64 host";
+  }
+  const char *kOps[] = {"add", "sub", "sll", "slt", "sltu", "xor", "srl", "sra", "or", "and",
+                        "mul", "mulh", "mulhsu", "mulhu", "div", "divu", "rem", "remu"};
+  const char *kImmOps[] = {"addi", "slti", "sltiu", "xori", "ori", "andi"};
+  const char *kShiftOps[] = {"slli", "srli", "srai"};
+  const char *kLoads[] = {"lb", "lh", "lw", "ld", "lbu", "lhu", "lwu"};
+  const char *kStores[] = {"sb", "sh", "sw", "sd"};
+  const char *kBranches[] = {"beq", "bne", "blt", "bge", "bltu", "bgeu"};
+
+  std::mt19937_64 random(20240601);
+  for (int round = 0; round < 20; ++round) {
+    // s0 holds the data base and s1 the loop counter; everything else is fair game.
+    auto reg = [&random]() {
+      static const int kRegs[] = {0, 5, 6, 7, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 28, 29, 30, 31};
+      return "x" + std::to_string(kRegs[random() % (sizeof(kRegs)/sizeof(kRegs[0]))]);
+    };
+    std::ostringstream source;
+    source << ".data\nbuf: .dword";
+    for (int i = 0; i < 16; ++i) {
+      source << (i ? ", " : " ") << static_cast<int64_t>(random());
+    }
+    source << "\n.text\n  la s0, buf\n  addi s1, x0, 40\n";
+    for (int r = 5; r < 32; ++r) {
+      if (r != 8 && r != 9) {
+        source << "  li x" << r << ", " << random() % (1 << 30) << "\n";
+      }
+    }
+    source << "loop:\n";
+    int labels = 0;
+    for (int i = 0; i < 60; ++i) {
+      switch (random() % 6) {
+        case 0:
+        case 1:
+          source << "  " << kOps[random() % 18] << " " << reg() << ", " << reg() << ", " << reg() << "\n";
+          break;
+        case 2:
+          source << "  " << kImmOps[random() % 6] << " " << reg() << ", " << reg() << ", "
+                 << static_cast<int>(random() % 4096) - 2048 << "\n";
+          source << "  " << kShiftOps[random() % 3] << " " << reg() << ", " << reg() << ", " << random() % 32 << "\n";
+          break;
+        case 3:
+          source << "  " << kLoads[random() % 7] << " " << reg() << ", " << (random() % 15)*8 << "(s0)\n";
+          break;
+        case 4:
+          source << "  " << kStores[random() % 4] << " " << reg() << ", " << (random() % 15)*8 + random() % 8 << "(s0)\n";
+          break;
+        default:
+          source << "  " << kBranches[random() % 6] << " " << reg() << ", " << reg() << ", skip" << labels << "\n"
+                 << "  lui " << reg() << ", " << random() % (1 << 20) << "\n"
+                 << "  auipc " << reg() << ", " << random() % 16 << "\n"
+                 << "skip" << labels << ":\n";
+          labels++;
+          break;
+      }
+    }
+    source << "  addi s1, s1, -1\n  bne s1, x0, loop\n";
+
+    AssembledProgram program = AssembleSource("dbt_random.s", source.str());
+    VmContext context = HeadlessContext();
+    RVSSVM interpreted(context);
+    interpreted.LoadProgram(program);
+    interpreted.RunQuantum(UINT64_MAX);
+
+    RVSSVM translated(context);
+    translated.LoadProgram(program);
+    dbt::DbtEngine engine(1 + round % 3);
+    engine.Run(translated, UINT64_MAX);
+
+    SCOPED_TRACE("round " + std::to_string(round));
+    ExpectSameState(interpreted, translated, 128);
+  }
+}
+
+TEST(DbtTest, ExamplesMatchInterpreterTest) {
+  if (!dbt::DbtEngine::IsSupported()) {
+    GTEST_SKIP() << "Binary translation needs an x86-64 host";
+  }
+  // Some examples spin forever waiting on input, so both runs stop at the same limit.
+  const uint64_t kInstructionLimit = 100000;
+  std::vector<std::filesystem::path> programs;
+  for (const auto &entry : std::filesystem::directory_iterator(VM_EXAMPLES_DIR)) {
+    if (entry.path().extension() == ".s") {
+      programs.push_back(entry.path());
+    }
+  }
+  std::sort(programs.begin(), programs.end());
+  ASSERT_FALSE(programs.empty());
+
+  int compared = 0;
+  for (const auto &path : programs) {
+    SCOPED_TRACE(path.filename().string());
+    AssembledProgram program;
+    try {
+      program = assemble(path.string(), false);
+    } catch (const std::exception &) {
+      // error_test.s and friends are meant to fail to assemble.
+      continue;
+    }
+    VmContext context = HeadlessContext();
+
+    RVSSVM interpreted(context);
+    interpreted.LoadProgram(program);
+    interpreted.guest_io_.SetCaptureOutput(true);
+    interpreted.guest_io_.PreloadStdin("/dev/null");
+    bool interpreted_threw = false;
+    try {
+      interpreted.RunQuantum(kInstructionLimit);
+    } catch (const std::exception &) {
+      interpreted_threw = true;
+    }
+
+    RVSSVM translated(context);
+    translated.LoadProgram(program);
+    translated.guest_io_.SetCaptureOutput(true);
+    translated.guest_io_.PreloadStdin("/dev/null");
+    dbt::DbtEngine engine(1);
+    bool translated_threw = false;
+    try {
+      engine.Run(translated, kInstructionLimit);
+    } catch (const std::exception &) {
+      translated_threw = true;
+    }
+
+    EXPECT_EQ(interpreted_threw, translated_threw);
+    EXPECT_EQ(interpreted.IsHalted(), translated.IsHalted());
+    ExpectSameState(interpreted, translated, 256);
+    compared++;
+  }
+  EXPECT_GT(compared, 0);
+}
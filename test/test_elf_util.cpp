@@ -1,6 +1,6 @@
 #include <gtest/gtest.h>
 
-#include "../src/assembler/elf_util.h"
+#include "assembler/elf_util.h"
 
 TEST(ElfUtilTest, ElfHeaderTest) {
   ElfHeader elfHeader;
@@ -25,4 +25,126 @@ TEST(ElfUtilTest, ElfHeaderTest) {
   ASSERT_EQ(elfHeader.e_shentsize, 40);
   ASSERT_EQ(elfHeader.e_shnum, 3);
   ASSERT_EQ(elfHeader.e_shstrndx, 2);
-}
\ No newline at end of file
+}
+
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+template<typename T>
+void AppendBytes(std::vector<uint8_t> &image, const T &value) {
+  const auto *bytes = reinterpret_cast<const uint8_t *>(&value);
+  image.insert(image.end(), bytes, bytes + sizeof(T));
+}
+
+// Builds a small static RV64 executable: two instructions at 0x10000 and an 8-byte
+// initialised object followed by 8 bytes of .bss at 0x20000.
+std::filesystem::path WriteTestElf() {
+  const uint32_t text[] = {0x01700513, 0x01b50513}; // addi a0, x0, 23; addi a0, a0, 27
+  const uint64_t data = 0x1122334455667788;
+  const char strtab[] = "\0_start\0value";
+
+  const uint64_t phoff = sizeof(Elf64Header);
+  const uint64_t text_off = phoff + 2*sizeof(Elf64ProgramHeader);
+  const uint64_t data_off = text_off + sizeof(text);
+  const uint64_t strtab_off = data_off + sizeof(data);
+  const uint64_t symtab_off = strtab_off + 16;
+  const uint64_t shoff = symtab_off + 3*sizeof(Elf64Symbol);
+
+  Elf64Header header{};
+  std::memcpy(header.e_ident, "\x7F" "ELF", 4);
+  header.e_ident[4] = kElfClass64;
+  header.e_ident[5] = kElfDataLsb;
+  header.e_ident[6] = 1;
+  header.e_type = 2;
+  header.e_machine = kElfMachineRiscv;
+  header.e_version = 1;
+  header.e_entry = 0x10000;
+  header.e_phoff = phoff;
+  header.e_shoff = shoff;
+  header.e_ehsize = sizeof(Elf64Header);
+  header.e_phentsize = sizeof(Elf64ProgramHeader);
+  header.e_phnum = 2;
+  header.e_shentsize = sizeof(Elf64SectionHeader);
+  header.e_shnum = 3;
+
+  Elf64ProgramHeader text_ph{kElfPtLoad, 0x5, text_off, 0x10000, 0x10000, sizeof(text), sizeof(text), 0x1000};
+  Elf64ProgramHeader data_ph{kElfPtLoad, 0x6, data_off, 0x20000, 0x20000, sizeof(data), 16, 0x1000};
+
+  Elf64Symbol null_sym{};
+  Elf64Symbol start_sym{1, (1 << 4) | kElfSttFunc, 0, 1, 0x10000, sizeof(text)};
+  Elf64Symbol value_sym{8, (1 << 4) | kElfSttObject, 0, 2, 0x20000, sizeof(data)};
+
+  Elf64SectionHeader null_sh{};
+  Elf64SectionHeader strtab_sh{0, 3, 0, 0, strtab_off, sizeof(strtab), 0, 0, 1, 0};
+  Elf64SectionHeader symtab_sh{0, kElfShtSymtab, 0, 0, symtab_off, 3*sizeof(Elf64Symbol), 1, 1, 8, sizeof(Elf64Symbol)};
+
+  std::vector<uint8_t> image;
+  AppendBytes(image, header);
+  AppendBytes(image, text_ph);
+  AppendBytes(image, data_ph);
+  AppendBytes(image, text);
+  AppendBytes(image, data);
+  image.insert(image.end(), strtab, strtab + sizeof(strtab));
+  image.resize(symtab_off, 0);
+  AppendBytes(image, null_sym);
+  AppendBytes(image, start_sym);
+  AppendBytes(image, value_sym);
+  AppendBytes(image, null_sh);
+  AppendBytes(image, strtab_sh);
+  AppendBytes(image, symtab_sh);
+
+  std::filesystem::path path = TempPath("program.elf");
+  std::ofstream(path, std::ios::binary).write(reinterpret_cast<const char *>(image.data()),
+                                              static_cast<std::streamsize>(image.size()));
+  return path;
+}
+
+} // namespace
+
+TEST(ElfUtilTest, ElfFileParseTest) {
+  std::filesystem::path path = WriteTestElf();
+  ASSERT_TRUE(isElfFile(path.string()));
+
+  ElfFile elf(path.string());
+  ASSERT_EQ(elf.getEntry(), 0x10000);
+  ASSERT_EQ(elf.getSegments().size(), 2);
+  ASSERT_TRUE(elf.getSegments()[0].executable);
+  ASSERT_EQ(elf.getSegments()[1].mem_size, 16);
+  ASSERT_EQ(elf.getSegments()[1].file_bytes.size(), 8);
+  ASSERT_EQ(elf.getSymbols().size(), 2);
+  ASSERT_EQ(elf.getSymbols()[0].name, "_start");
+  ASSERT_TRUE(elf.getSymbols()[0].is_function);
+  ASSERT_EQ(elf.getSymbols()[1].name, "value");
+  ASSERT_FALSE(elf.getSymbols()[1].is_function);
+}
+
+TEST(ElfUtilTest, ElfFileRejectsNonElfTest) {
+  std::filesystem::path path = TempPath("not_elf.bin");
+  std::ofstream(path) << "addi a0, x0, 1\n";
+  ASSERT_FALSE(isElfFile(path.string()));
+  ASSERT_THROW(ElfFile elf(path.string()), std::runtime_error);
+}
+
+TEST(ElfUtilTest, LoadElfProgramTest) {
+  std::filesystem::path path = WriteTestElf();
+  RVSSVM vm;
+  vm.LoadElfProgram(path.string());
+
+  ASSERT_EQ(vm.program_counter_, 0x10000);
+  ASSERT_EQ(vm.memory_controller_.ReadWord(0x10000), 0x01700513);
+  ASSERT_EQ(vm.memory_controller_.ReadDoubleWord(0x20000), 0x1122334455667788);
+  ASSERT_EQ(vm.memory_controller_.ReadDoubleWord(0x20008), 0);
+  ASSERT_EQ(vm.program_.symbol_table["_start"].address, 0x10000);
+
+  vm.Step();
+  vm.Step();
+  ASSERT_EQ(vm.registers_.ReadGpr(10), 50);
+  ASSERT_EQ(vm.program_counter_, vm.program_size_);
+}
@@ -0,0 +1,149 @@
+/**
+ * File Name: test_fuzzer.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "fuzzer.h"
+#include "vm/edge_coverage.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+// Reads up to 8 bytes of stdin; "F" then "Z" loads from an address past the end of memory,
+// "L" spins forever, anything else exits.
+const char *kTarget = ".data\n"
+                      "buffer: .dword 0\n"
+                      ".text\n"
+                      "  addi a7, x0, 63\n"
+                      "  addi a0, x0, 0\n"
+                      "  la a1, buffer\n"
+                      "  addi a2, x0, 8\n"
+                      "  ecall\n"
+                      "  lb t0, 0(a1)\n"
+                      "  addi t1, x0, 76\n"
+                      "  beq t0, t1, spin\n"
+                      "  addi t1, x0, 70\n"
+                      "  bne t0, t1, done\n"
+                      "  lb t0, 1(a1)\n"
+                      "  addi t1, x0, 90\n"
+                      "  bne t0, t1, done\n"
+                      "  addi t2, x0, -1\n"
+                      "  lb t3, 0(t2)\n"
+                      "  jal x0, done\n"
+                      "spin:\n"
+                      "  jal x0, spin\n"
+                      "done:\n"
+                      "  addi a7, x0, 93\n"
+                      "  addi a0, x0, 0\n"
+                      "  ecall\n";
+
+} // namespace
+
+TEST(FuzzerTest, EdgeCoverageTest) {
+  EdgeCoverage coverage;
+  coverage.Record(0x100, 0x200);
+  coverage.Record(0x100, 0x200);
+  coverage.Record(0x200, 0x100);
+  ASSERT_EQ(coverage.GetTouched().size(), 2);
+  EXPECT_EQ(coverage.GetHits(coverage.GetTouched()[0]), 2);
+  EXPECT_EQ(coverage.GetHits(coverage.GetTouched()[1]), 1);
+
+  uint32_t index = coverage.GetTouched()[0];
+  coverage.Clear();
+  EXPECT_TRUE(coverage.GetTouched().empty());
+  EXPECT_EQ(coverage.GetHits(index), 0);
+
+  for (int i = 0; i < 300; ++i) {
+    coverage.Record(0x100, 0x200);
+  }
+  EXPECT_EQ(coverage.GetHits(index), 255);
+
+  EXPECT_EQ(EdgeCoverage::Bucket(1), 1);
+  EXPECT_EQ(EdgeCoverage::Bucket(3), 4);
+  EXPECT_EQ(EdgeCoverage::Bucket(5), 8);
+  EXPECT_EQ(EdgeCoverage::Bucket(100), 64);
+  EXPECT_EQ(EdgeCoverage::Bucket(255), 128);
+}
+
+TEST(FuzzerTest, ExecutorTest) {
+  std::filesystem::path target = WriteTempFile("fuzzer.s", kTarget);
+  fuzzer::Executor executor(target, VmContext::FromGlobals(), 10000);
+  std::filesystem::remove(target);
+
+  fuzzer::RunResult ok = executor.Run("A");
+  EXPECT_EQ(ok.outcome, fuzzer::Outcome::kOk);
+  std::vector<uint32_t> ok_edges = executor.GetCoverage().GetTouched();
+
+  fuzzer::RunResult partial = executor.Run("FA");
+  EXPECT_EQ(partial.outcome, fuzzer::Outcome::kOk);
+  EXPECT_NE(executor.GetCoverage().GetTouched(), ok_edges);
+
+  fuzzer::RunResult crash = executor.Run("FZ");
+  EXPECT_EQ(crash.outcome, fuzzer::Outcome::kCrash);
+  EXPECT_NE(crash.message.find("out of range"), std::string::npos);
+  EXPECT_EQ(crash.pc, executor.GetVm().text_start_ + 15*4);
+
+  fuzzer::RunResult timeout = executor.Run("L");
+  EXPECT_EQ(timeout.outcome, fuzzer::Outcome::kTimeout);
+  EXPECT_EQ(timeout.instructions, 10000);
+
+  // Every run starts from the snapshot, whatever the previous one left behind.
+  EXPECT_EQ(executor.Run("A").instructions, ok.instructions);
+}
+
+TEST(FuzzerTest, MutatorTest) {
+  fuzzer::Mutator first(7);
+  fuzzer::Mutator second(7);
+  for (int i = 0; i < 100; ++i) {
+    std::string a = first.Mutate("12 34\n", "-5", 16);
+    std::string b = second.Mutate("12 34\n", "-5", 16);
+    EXPECT_EQ(a, b);
+    EXPECT_LE(a.size(), 16);
+  }
+  EXPECT_TRUE(first.Mutate("", "", 0).empty());
+}
+
+TEST(FuzzerTest, FuzzTest) {
+  std::filesystem::path corpus = TempPath("fuzzer_corpus");
+  std::filesystem::remove_all(corpus);
+  std::filesystem::create_directories(corpus);
+  // Neither seed crashes; splicing the two does.
+  std::ofstream(corpus / "seed_1") << "F";
+  std::ofstream(corpus / "seed_2") << "Z";
+
+  fuzzer::FuzzOptions options;
+  options.jobs = 2;
+  options.max_runs = 5000;
+  options.instruction_limit = 1000;
+  std::ostringstream log;
+  std::filesystem::path target = WriteTempFile("fuzzer.s", kTarget);
+  fuzzer::FuzzStats stats = fuzzer::Fuzz(target, corpus, options, log);
+
+  EXPECT_GE(stats.runs, options.max_runs);
+  EXPECT_GT(stats.corpus_size, 1);
+  EXPECT_GT(stats.edges, 0);
+  EXPECT_EQ(stats.crashes, 1);
+  EXPECT_GE(stats.timeouts, 1);
+
+  ASSERT_TRUE(std::filesystem::is_directory(corpus / "crashes"));
+  size_t crash_inputs = 0;
+  for (const auto &entry : std::filesystem::directory_iterator(corpus / "crashes")) {
+    if (entry.path().extension() != ".txt") {
+      std::ifstream input(entry.path(), std::ios::binary);
+      std::string data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+      EXPECT_EQ(data.substr(0, 2), "FZ");
+      ++crash_inputs;
+    }
+  }
+  EXPECT_EQ(crash_inputs, 1);
+  EXPECT_TRUE(std::filesystem::is_directory(corpus / "timeouts"));
+  std::filesystem::remove_all(corpus);
+  std::filesystem::remove(target);
+}
@@ -0,0 +1,101 @@
+/**
+ * File Name: test_guest_io.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/guest_io.h"
+#include "test_util.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::span<const uint8_t> AsBytes(const std::string &text) {
+  return {reinterpret_cast<const uint8_t *>(text.data()), text.size()};
+}
+
+std::filesystem::path FreshSandbox() {
+  std::filesystem::path sandbox = TempPath("guest_fs");
+  std::filesystem::remove_all(sandbox);
+  std::filesystem::create_directories(sandbox);
+  return sandbox;
+}
+
+} // namespace
+
+TEST(GuestIoTest, ConsoleBufferingTest) {
+  GuestIo io;
+  io.SetFlushThreshold(8);
+
+  testing::internal::CaptureStdout();
+  io.Write(1, AsBytes("abc"));
+  EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+
+  testing::internal::CaptureStdout();
+  io.Write(1, AsBytes("defgh"));
+  EXPECT_EQ(testing::internal::GetCapturedStdout(), "abcdefgh");
+
+  testing::internal::CaptureStdout();
+  io.Write(1, AsBytes("x"));
+  io.Flush();
+  EXPECT_EQ(testing::internal::GetCapturedStdout(), "x");
+}
+
+TEST(GuestIoTest, FileOpenWriteSeekReadTest) {
+  GuestIo io;
+  io.SetSandboxDirectory(FreshSandbox());
+
+  constexpr int64_t o_rdwr = 02, o_creat = 0100;
+  int64_t fd = io.Open("out.txt", o_rdwr | o_creat, 0644);
+  ASSERT_GE(fd, 3);
+  EXPECT_EQ(io.Write(fd, AsBytes("hello world")), 11);
+  EXPECT_EQ(io.Seek(fd, 6, SEEK_SET), 6);
+
+  std::vector<uint8_t> buffer(16, 0);
+  EXPECT_EQ(io.Read(fd, buffer), 5);
+  EXPECT_EQ(std::string(buffer.begin(), buffer.begin() + 5), "world");
+  EXPECT_EQ(io.Close(fd), 0);
+  EXPECT_EQ(io.Close(fd), -EBADF);
+
+  EXPECT_EQ(io.Open("missing.txt", 0, 0), -ENOENT);
+  EXPECT_EQ(io.Read(42, buffer), -EBADF);
+  EXPECT_EQ(io.Seek(1, 0, SEEK_SET), -ESPIPE);
+}
+
+TEST(GuestIoTest, SandboxEscapeTest) {
+  GuestIo io;
+  std::filesystem::path sandbox = FreshSandbox();
+  io.SetSandboxDirectory(sandbox);
+
+  EXPECT_EQ(io.Open("../escape.txt", 0100 | 01, 0644), -EACCES);
+  EXPECT_FALSE(std::filesystem::exists(sandbox.parent_path() / "escape.txt"));
+
+  // Absolute guest paths are rooted at the sandbox.
+  int64_t fd = io.Open("/rooted.txt", 0100 | 01, 0644);
+  ASSERT_GE(fd, 3);
+  EXPECT_TRUE(std::filesystem::exists(sandbox / "rooted.txt"));
+}
+
+TEST(GuestIoTest, PreloadedStdinTest) {
+  std::filesystem::path input = FreshSandbox() / "stdin.txt";
+  std::ofstream(input) << "12 34\n";
+
+  GuestIo io;
+  std::vector<uint8_t> buffer(4, 0);
+  EXPECT_EQ(io.Read(0, buffer), -EAGAIN);
+
+  io.PreloadStdin(input);
+  ASSERT_TRUE(io.HasPreloadedStdin());
+  EXPECT_EQ(io.Read(0, buffer), 4);
+  EXPECT_EQ(std::string(buffer.begin(), buffer.end()), "12 3");
+  EXPECT_EQ(io.Read(0, buffer), 2);
+  EXPECT_EQ(io.Read(0, buffer), 0);
+
+  EXPECT_THROW(io.PreloadStdin(input.parent_path() / "missing.txt"), std::runtime_error);
+}
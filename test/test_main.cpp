@@ -6,7 +6,10 @@
 
 #include <gtest/gtest.h>
 
+#include "utils.h"
+
 int main(int argc, char *argv[]) {
   ::testing::InitGoogleTest(&argc, argv);
+  setupVmStateDirectory();
   return RUN_ALL_TESTS();
 }
\ No newline at end of file
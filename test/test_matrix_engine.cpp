@@ -0,0 +1,275 @@
+/**
+ * File Name: test_matrix_engine.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/mmio_devices.h"
+#include "vm/matrix_gemm.h"
+#include "vm/memory_controller.h"
+#include "vm/alu.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+
+using matrix::ElementFormat;
+
+void WriteFloats(MemoryController &memory, uint64_t address, const std::vector<float> &values) {
+  for (size_t i = 0; i < values.size(); ++i) {
+    uint32_t bits;
+    std::memcpy(&bits, &values[i], 4);
+    memory.WriteWord(address + 4*i, bits);
+  }
+}
+
+float ReadFloat(MemoryController &memory, uint64_t address) {
+  uint32_t bits = memory.ReadWord(address);
+  float value;
+  std::memcpy(&value, &bits, 4);
+  return value;
+}
+
+// The engine's contract: products summed in order with fused multiply-adds.
+float Dot(const std::vector<float> &a, const std::vector<float> &b, size_t i, size_t j, size_t n, size_t k,
+          float initial) {
+  float sum = initial;
+  for (size_t p = 0; p < k; ++p) {
+    sum = std::fma(a[i*k + p], b[p*n + j], sum);
+  }
+  return sum;
+}
+
+void Program(MatrixEngineDevice &engine, uint64_t a, uint64_t b, uint64_t c, uint64_t m, uint64_t n, uint64_t k,
+             uint64_t format) {
+  engine.write(MatrixEngineDevice::kA, a, 8);
+  engine.write(MatrixEngineDevice::kB, b, 8);
+  engine.write(MatrixEngineDevice::kC, c, 8);
+  engine.write(MatrixEngineDevice::kM, m, 8);
+  engine.write(MatrixEngineDevice::kN, n, 8);
+  engine.write(MatrixEngineDevice::kK, k, 8);
+  engine.write(MatrixEngineDevice::kFormat, format, 8);
+}
+
+} // namespace
+
+TEST(MatrixEngineTest, Fp32Test) {
+  MemoryController memory;
+  MatrixEngineDevice engine(0, memory, 16, 8);
+  std::vector<float> a(3*5);
+  std::vector<float> b(5*7);
+  for (size_t i = 0; i < a.size(); ++i) a[i] = static_cast<float>(i) - 4.0f;
+  for (size_t i = 0; i < b.size(); ++i) b[i] = static_cast<float>(i%6) * 0.5f;
+  WriteFloats(memory, 0x1000, a);
+  WriteFloats(memory, 0x2000, b);
+
+  Program(engine, 0x1000, 0x2000, 0x3000, 3, 7, 5, 0);
+  engine.write(MatrixEngineDevice::kCtrl, MatrixEngineDevice::kCtrlStart, 8);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusBusy);
+
+  // 32 setup + ceil(105 MACs / 16) + ceil((60 + 140 + 84) bytes / 8) = 32 + 7 + 36.
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kCycles, 8), 75);
+  engine.write(MatrixEngineDevice::kM, 1, 8); // ignored while busy
+  engine.tick(74);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusBusy);
+  EXPECT_EQ(memory.ReadWord(0x3000), 0); // C is written only when the operation completes
+  engine.tick(1);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusDone);
+
+  for (size_t i = 0; i < 3; ++i) {
+    for (size_t j = 0; j < 7; ++j) {
+      EXPECT_EQ(ReadFloat(memory, 0x3000 + 4*(i*7 + j)), Dot(a, b, i, j, 7, 5, 0.0f)) << i << ", " << j;
+    }
+  }
+  EXPECT_EQ(memory.ReadWord(0x3000 + 4*21), 0);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kTotalMacs, 8), 105);
+
+  engine.write(MatrixEngineDevice::kStatus, MatrixEngineDevice::kStatusDone, 8);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), 0);
+}
+
+TEST(MatrixEngineTest, HalfPrecisionTest) {
+  MemoryController memory;
+  MatrixEngineDevice engine(0, memory, 256, 32);
+  const size_t m = 4, n = 6, k = 9, lda = 12;
+  std::vector<float> a(m*k);
+  std::vector<float> b(k*n);
+  std::mt19937 random(7);
+  std::uniform_real_distribution<float> dist(-3.0f, 3.0f);
+
+  // fp16 A with a padded leading dimension and fp16 B, accumulated into fp32 C.
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t p = 0; p < k; ++p) {
+      uint16_t h = alu::float_to_float16(dist(random));
+      a[i*k + p] = alu::float16_to_float(h);
+      memory.WriteHalfWord(0x1000 + 2*(i*lda + p), h);
+    }
+  }
+  for (size_t i = 0; i < b.size(); ++i) {
+    uint16_t h = alu::float_to_float16(dist(random));
+    b[i] = alu::float16_to_float(h);
+    memory.WriteHalfWord(0x2000 + 2*i, h);
+  }
+  WriteFloats(memory, 0x3000, std::vector<float>(m*n, 1.25f));
+  Program(engine, 0x1000, 0x2000, 0x3000, m, n, k, static_cast<uint64_t>(ElementFormat::kFp16));
+  engine.write(MatrixEngineDevice::kLda, lda, 8);
+  engine.write(MatrixEngineDevice::kCtrl, MatrixEngineDevice::kCtrlStart | MatrixEngineDevice::kCtrlAccumulate, 8);
+  engine.tick(UINT64_MAX);
+  ASSERT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusDone);
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      EXPECT_EQ(ReadFloat(memory, 0x3000 + 4*(i*n + j)), Dot(a, b, i, j, n, k, 1.25f));
+    }
+  }
+
+  // bf16 A and B, rounded to bf16 through the ALU's conversion.
+  for (size_t i = 0; i < a.size(); ++i) {
+    uint16_t h = alu::float_to_bfloat16(dist(random));
+    a[i] = alu::bfloat16_to_float(h);
+    memory.WriteHalfWord(0x5000 + 2*i, h);
+  }
+  for (size_t i = 0; i < b.size(); ++i) {
+    uint16_t h = alu::float_to_bfloat16(dist(random));
+    b[i] = alu::bfloat16_to_float(h);
+    memory.WriteHalfWord(0x6000 + 2*i, h);
+  }
+  uint64_t format = static_cast<uint64_t>(ElementFormat::kBf16) | static_cast<uint64_t>(ElementFormat::kBf16) << 4;
+  Program(engine, 0x5000, 0x6000, 0x7000, m, n, k, format);
+  engine.write(MatrixEngineDevice::kLda, 0, 8);
+  engine.write(MatrixEngineDevice::kCtrl, MatrixEngineDevice::kCtrlStart, 8);
+  engine.tick(UINT64_MAX);
+  for (size_t i = 0; i < m; ++i) {
+    for (size_t j = 0; j < n; ++j) {
+      EXPECT_EQ(memory.ReadHalfWord(0x7000 + 2*(i*n + j)), alu::float_to_bfloat16(Dot(a, b, i, j, n, k, 0.0f)));
+    }
+  }
+  EXPECT_EQ(engine.getOperations(), 2);
+}
+
+TEST(MatrixEngineTest, Msfp16Test) {
+  MemoryController memory;
+  MatrixEngineDevice engine(0, memory, 256, 32);
+  // A is 2 x 4 (one block per row), B is 4 x 8 (two blocks per row).
+  std::vector<float> a = {1.0f, 0.5f, -2.0f, 0.25f, 3.0f, -1.0f, 0.75f, 1.5f};
+  std::vector<float> b(32);
+  for (size_t i = 0; i < b.size(); ++i) b[i] = static_cast<float>(static_cast<int>(i%5) - 2);
+  for (size_t row = 0; row < 2; ++row) {
+    memory.WriteDoubleWord(0x1000 + 8*row, alu::msfp16_pack({a[4*row], a[4*row + 1], a[4*row + 2], a[4*row + 3]}));
+  }
+  for (size_t block = 0; block < 8; ++block) {
+    memory.WriteDoubleWord(0x2000 + 8*block, alu::msfp16_pack({b[4*block], b[4*block + 1], b[4*block + 2],
+                                                               b[4*block + 3]}));
+  }
+  // What the engine sees after quantisation.
+  std::vector<float> qa(a.size());
+  std::vector<float> qb(b.size());
+  std::vector<uint8_t> a_bytes(16);
+  memory.ReadBlock(0x1000, a_bytes);
+  matrix::DecodeRow(ElementFormat::kMsfp16, a_bytes.data(), 8, qa.data());
+  std::vector<uint8_t> b_bytes(64);
+  memory.ReadBlock(0x2000, b_bytes);
+  matrix::DecodeRow(ElementFormat::kMsfp16, b_bytes.data(), 32, qb.data());
+
+  uint64_t format = static_cast<uint64_t>(ElementFormat::kMsfp16) | static_cast<uint64_t>(ElementFormat::kMsfp16) << 4;
+  Program(engine, 0x1000, 0x2000, 0x3000, 2, 8, 4, format);
+  engine.write(MatrixEngineDevice::kCtrl, MatrixEngineDevice::kCtrlStart, 8);
+  engine.tick(UINT64_MAX);
+  ASSERT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusDone);
+  for (size_t i = 0; i < 2; ++i) {
+    for (size_t block = 0; block < 2; ++block) {
+      std::array<float, 4> expected;
+      for (size_t lane = 0; lane < 4; ++lane) {
+        expected[lane] = Dot(qa, qb, i, 4*block + lane, 8, 4, 0.0f);
+      }
+      EXPECT_EQ(memory.ReadDoubleWord(0x3000 + 8*(2*i + block)), alu::msfp16_pack(expected));
+    }
+  }
+
+  // MSFP16 rows must hold whole blocks.
+  engine.write(MatrixEngineDevice::kLdb, 6, 8);
+  engine.write(MatrixEngineDevice::kN, 6, 8);
+  engine.write(MatrixEngineDevice::kCtrl, MatrixEngineDevice::kCtrlStart, 8);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusError);
+}
+
+TEST(MatrixEngineTest, ErrorTest) {
+  MemoryController memory;
+  MatrixEngineDevice engine(0, memory, 256, 32);
+  Program(engine, 0x1000, 0x2000, 0x3000, 2, 2, 2, 0x9);
+  engine.write(MatrixEngineDevice::kCtrl, MatrixEngineDevice::kCtrlStart, 8);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusError);
+
+  Program(engine, UINT64_MAX - 4, 0x2000, 0x3000, 2, 2, 2, 0);
+  engine.write(MatrixEngineDevice::kCtrl, MatrixEngineDevice::kCtrlStart, 8);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusError);
+
+  Program(engine, 0x1000, 0x2000, 0x3000, 1 << 20, 1 << 20, 2, 0);
+  engine.write(MatrixEngineDevice::kCtrl, MatrixEngineDevice::kCtrlStart, 8);
+  EXPECT_EQ(engine.read(MatrixEngineDevice::kStatus, 8), MatrixEngineDevice::kStatusError);
+  EXPECT_EQ(engine.getOperations(), 0);
+}
+
+TEST(MatrixEngineTest, SimdMatchesScalarTest) {
+  if (rvv::DetectHostIsa()!=rvv::HostIsa::kAvx2) {
+    GTEST_SKIP() << "The host has no AVX2 and FMA";
+  }
+  // Deeper than one depth block and wider than one column block, with ragged edges.
+  const uint64_t m = 7, n = 300, k = 261;
+  std::mt19937 random(11);
+  std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+  std::vector<float> a(m*k);
+  std::vector<float> b(k*n);
+  for (float &value : a) value = dist(random);
+  for (float &value : b) value = dist(random);
+  std::vector<float> simd(m*n, 0.5f);
+  std::vector<float> scalar = simd;
+  matrix::Gemm(rvv::HostIsa::kAvx2, m, n, k, a.data(), k, b.data(), n, simd.data(), n);
+  matrix::Gemm(rvv::HostIsa::kScalar, m, n, k, a.data(), k, b.data(), n, scalar.data(), n);
+  EXPECT_EQ(0, std::memcmp(simd.data(), scalar.data(), simd.size()*sizeof(float)));
+  EXPECT_EQ(simd[3*n + 250], Dot(a, b, 3, 250, n, k, 0.5f));
+}
+
+TEST(MatrixEngineTest, VmProgramTest) {
+  // The guest multiplies 2 x 2 fp32 matrices and polls STATUS until done.
+  const std::string source = ".data\n"
+                             "a: .float 1.0, 2.0, 3.0, 4.0\n"
+                             "b: .float 5.0, 6.0, 7.0, 8.0\n"
+                             "c: .float 0.0, 0.0, 0.0, 0.0\n"
+                             ".text\n"
+                             "  li s0, 1073938432\n" // mmio_base + 0x30000
+                             "  la t0, a\n"
+                             "  sd t0, 0(s0)\n"
+                             "  la t0, b\n"
+                             "  sd t0, 8(s0)\n"
+                             "  la t0, c\n"
+                             "  sd t0, 16(s0)\n"
+                             "  li t0, 2\n"
+                             "  sd t0, 24(s0)\n"
+                             "  sd t0, 32(s0)\n"
+                             "  sd t0, 40(s0)\n"
+                             "  li t0, 1\n"
+                             "  sd t0, 80(s0)\n"
+                             "wait:\n"
+                             "  ld t1, 88(s0)\n"
+                             "  andi t1, t1, 2\n"
+                             "  beq t1, x0, wait\n"
+                             "  la t0, c\n"
+                             "  flw fa0, 12(t0)\n";
+  VmContext context = HeadlessContext();
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("matrix.s", source));
+  vm.RunQuantum(10000);
+  float c11;
+  uint32_t bits = static_cast<uint32_t>(vm.registers_.ReadFpr(10));
+  std::memcpy(&c11, &bits, 4);
+  EXPECT_EQ(c11, 3.0f*6.0f + 4.0f*8.0f);
+  // The polling loop ran for the modelled latency.
+  EXPECT_GT(vm.instructions_retired_, MatrixEngineDevice::kSetupCycles);
+}
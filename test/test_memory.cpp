@@ -5,7 +5,10 @@
  */
 
 #include <gtest/gtest.h>
-#include "../src/vm/main_memory.h"
+#include "vm/main_memory.h"
+
+#include <algorithm>
+#include <vector>
 
 TEST(MemoryTest, ReadWriteTest) {
   Memory memory;
@@ -88,3 +91,27 @@ TEST(MemoryTest, ReadWriteLargeDoubleTest) {
 }
 
 
+
+TEST(MemoryTest, ReadWriteBlockTest) {
+  Memory memory;
+  std::vector<uint8_t> data(3000);
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<uint8_t>(i*7);
+  }
+  memory.WriteBlock(1000, data);
+
+  EXPECT_EQ(memory.Read(1000), data[0]);
+  EXPECT_EQ(memory.Read(2048), data[1048]);
+  EXPECT_EQ(memory.Read(3999), data[2999]);
+
+  std::vector<uint8_t> read_back(data.size() + 8, 0xFF);
+  memory.ReadBlock(1000, read_back);
+  EXPECT_TRUE(std::equal(data.begin(), data.end(), read_back.begin()));
+  EXPECT_EQ(read_back[3000], 0);
+
+  std::vector<uint8_t> unallocated(16, 0xFF);
+  memory.ReadBlock(268435456, unallocated);
+  EXPECT_EQ(std::count(unallocated.begin(), unallocated.end(), 0), 16);
+
+  EXPECT_THROW(memory.WriteBlock(0xFFFFFFFFFFFFFFF0ULL, data), std::out_of_range);
+}
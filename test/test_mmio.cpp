@@ -0,0 +1,148 @@
+/**
+ * File Name: test_mmio.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/mmio_bus.h"
+#include "vm/memory_controller.h"
+#include "vm/guest_io.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <memory>
+#include <stdexcept>
+
+TEST(MmioTest, BusDecodeTest) {
+  MemoryController memory;
+  MmioBus &bus = memory.GetMmioBus();
+  bus.Add(std::make_unique<ClintDevice>(0x40010000));
+  bus.Add(std::make_unique<DmaDevice>(0x40020000, memory, 8));
+  EXPECT_THROW(bus.Add(std::make_unique<DmaDevice>(0x4001FF00, memory, 8)), std::invalid_argument);
+  EXPECT_THROW(bus.Add(std::make_unique<ClintDevice>(0x40000000 + 0x8000)), std::invalid_argument);
+
+  EXPECT_FALSE(bus.InWindow(0x4000FFFF));
+  EXPECT_TRUE(bus.InWindow(0x40010000));
+  EXPECT_EQ(bus.Find(0x4001BFF8)->name(), std::string("clint"));
+  EXPECT_EQ(bus.Find(0x40020020)->name(), std::string("dma"));
+  EXPECT_EQ(bus.Find(0x40020100), nullptr);
+
+  // RAM around and between the devices is unaffected.
+  memory.WriteWord(0x4000FFFC, 0xDEADBEEF);
+  EXPECT_EQ(memory.ReadWord(0x4000FFFC), 0xDEADBEEF);
+  memory.WriteDoubleWord(0x40020100, 42);
+  EXPECT_EQ(memory.ReadDoubleWord(0x40020100), 42);
+
+  // Accesses inside a device reach its registers, not RAM.
+  memory.WriteDoubleWord(0x40014000, 0x1122334455667788);
+  EXPECT_EQ(memory.ReadWord(0x40014004), 0x11223344);
+  EXPECT_EQ(memory.ReadDoubleWord_d(0x40014000), 0);
+  memory.WriteWord(0x40014004, 0);
+  EXPECT_EQ(memory.ReadDoubleWord(0x40014000), 0x55667788);
+
+  bus.Tick(5);
+  EXPECT_EQ(memory.ReadDoubleWord(0x4001BFF8), 5);
+  memory.Reset();
+  EXPECT_EQ(memory.ReadDoubleWord(0x4001BFF8), 0);
+  EXPECT_EQ(memory.ReadDoubleWord(0x40014000), UINT64_MAX);
+}
+
+TEST(MmioTest, UartTest) {
+  GuestIo io;
+  io.SetCaptureOutput(true);
+  UartDevice uart(0, io);
+
+  uart.write(UartDevice::kRbrThr, 'h', 1);
+  uart.write(UartDevice::kRbrThr, 'i', 1);
+  io.Flush();
+  EXPECT_EQ(io.GetCapturedStdout(), "hi");
+
+  EXPECT_EQ(uart.read(UartDevice::kLsr, 1), UartDevice::kLsrTxEmpty);
+  uart.pushInput("ok");
+  EXPECT_EQ(uart.read(UartDevice::kLsr, 1) & UartDevice::kLsrDataReady, UartDevice::kLsrDataReady);
+  EXPECT_EQ(uart.read(UartDevice::kRbrThr, 1), 'o');
+  EXPECT_EQ(uart.read(UartDevice::kRbrThr, 1), 'k');
+  EXPECT_EQ(uart.read(UartDevice::kLsr, 1) & UartDevice::kLsrDataReady, 0);
+
+  // The divisor latch shadows RBR/THR and IER while LCR.DLAB is set.
+  uart.write(UartDevice::kLcr, UartDevice::kLcrDlab, 1);
+  uart.write(UartDevice::kRbrThr, 0x1B, 1);
+  EXPECT_EQ(uart.read(UartDevice::kRbrThr, 1), 0x1B);
+  uart.write(UartDevice::kLcr, 0x03, 1);
+  EXPECT_EQ(uart.read(UartDevice::kRbrThr, 1), 0);
+}
+
+TEST(MmioTest, DmaTest) {
+  MemoryController memory;
+  DmaDevice dma(0, memory, 16);
+  for (uint64_t i = 0; i < 100; ++i) {
+    memory.WriteByte(0x1000 + i, static_cast<uint8_t>(i + 1));
+  }
+  dma.write(DmaDevice::kSrc, 0x1000, 8);
+  dma.write(DmaDevice::kDst, 0x2000, 8);
+  dma.write(DmaDevice::kLen, 100, 8);
+  dma.write(DmaDevice::kCtrl, DmaDevice::kCtrlStart, 8);
+  EXPECT_EQ(dma.read(DmaDevice::kStatus, 8), DmaDevice::kStatusBusy);
+
+  dma.tick(2);
+  EXPECT_EQ(memory.ReadByte(0x2000 + 31), 32);
+  EXPECT_EQ(memory.ReadByte(0x2000 + 32), 0);
+  dma.write(DmaDevice::kLen, 1, 8); // ignored while busy
+  dma.tick(10);
+  EXPECT_EQ(dma.read(DmaDevice::kStatus, 8), DmaDevice::kStatusDone);
+  EXPECT_EQ(memory.ReadByte(0x2000 + 99), 100);
+  EXPECT_EQ(memory.ReadByte(0x2000 + 100), 0);
+
+  dma.write(DmaDevice::kStatus, DmaDevice::kStatusDone, 8);
+  EXPECT_EQ(dma.read(DmaDevice::kStatus, 8), 0);
+
+  DmaDevice failing(0, memory, 16);
+  failing.write(DmaDevice::kSrc, UINT64_MAX - 4, 8);
+  failing.write(DmaDevice::kLen, 16, 8);
+  failing.write(DmaDevice::kCtrl, DmaDevice::kCtrlStart, 8);
+  failing.tick(1);
+  EXPECT_EQ(failing.read(DmaDevice::kStatus, 8), DmaDevice::kStatusError);
+}
+
+TEST(MmioTest, VmDevicesTest) {
+  const std::string source = ".data\n"
+                             "src: .dword 1, 2, 3, 4, 5, 6, 7, 8\n"
+                             "dst: .dword 0, 0, 0, 0, 0, 0, 0, 0\n"
+                             ".text\n"
+                             "  lui s0, 0x40000\n"
+                             "  addi t0, x0, 79\n"
+                             "  sb t0, 0(s0)\n"
+                             "  addi t0, x0, 75\n"
+                             "  sb t0, 0(s0)\n"
+                             "  lui s1, 0x40020\n"
+                             "  la t0, src\n"
+                             "  sd t0, 0(s1)\n"
+                             "  la t0, dst\n"
+                             "  sd t0, 8(s1)\n"
+                             "  addi t0, x0, 64\n"
+                             "  sd t0, 16(s1)\n"
+                             "  addi t0, x0, 1\n"
+                             "  sd t0, 24(s1)\n"
+                             "wait:\n"
+                             "  ld t1, 32(s1)\n"
+                             "  andi t1, t1, 1\n"
+                             "  bne t1, x0, wait\n"
+                             "  la t0, dst\n"
+                             "  ld a0, 56(t0)\n"
+                             "  lui s2, 0x4001c\n"
+                             "  ld a1, -8(s2)\n";
+
+  VmContext context = HeadlessContext();
+  context.config.setDmaBytesPerCycle(8);
+  RVSSVM vm(context);
+  vm.guest_io_.SetCaptureOutput(true);
+  vm.LoadProgram(AssembleSource("mmio.s", source));
+  vm.Run();
+
+  EXPECT_EQ(vm.guest_io_.GetCapturedStdout(), "OK");
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 8);
+  // mtime counts the instructions executed before the load, including the polling loop.
+  EXPECT_GT(vm.registers_.ReadGpr(11), 20);
+  EXPECT_EQ(vm.registers_.ReadGpr(11), vm.instructions_retired_ - 1);
+}
@@ -0,0 +1,199 @@
+/**
+ * File Name: test_multi_hart.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/main_memory.h"
+#include "vm/rvss/multi_hart_vm.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+VmContext HartContext(uint64_t harts, vm_config::HartSyncMode mode) {
+  VmContext context = HeadlessContext();
+  context.config.setHartCount(harts);
+  context.config.setHartSyncMode(mode);
+  context.config.setHartQuantum(7);
+  return context;
+}
+
+// Each hart adds 1 to count 200 times under an lr/sc spinlock, and to total with amoadd.
+const char *kCounterProgram = ".data\n"
+                              "lock: .dword 0\n"
+                              "count: .dword 0\n"
+                              "total: .dword 0\n"
+                              ".text\n"
+                              "  la s0, lock\n"
+                              "  la s1, count\n"
+                              "  la s2, total\n"
+                              "  addi s3, x0, 200\n"
+                              "  addi t4, x0, 1\n"
+                              "loop:\n"
+                              "  lr.d t0, (s0)\n"
+                              "  bne t0, x0, loop\n"
+                              "  sc.d t2, t4, (s0)\n"
+                              "  bne t2, x0, loop\n"
+                              "  ld t3, 0(s1)\n"
+                              "  addi t3, t3, 1\n"
+                              "  sd t3, 0(s1)\n"
+                              "  sd x0, 0(s0)\n"
+                              "  amoadd.d x0, t4, (s2)\n"
+                              "  addi s3, s3, -1\n"
+                              "  bne s3, x0, loop\n"
+                              "  csrrs a0, mhartid, x0\n"
+                              "  addi a1, sp, 0\n";
+
+// Each hart claims 50 slots of a shared log with amoadd and writes its id into them.
+const char *kLogProgram = ".data\n"
+                          "next: .dword 0\n"
+                          "log: .zero 800\n"
+                          ".text\n"
+                          "  la s0, next\n"
+                          "  la s1, log\n"
+                          "  csrrs s2, mhartid, x0\n"
+                          "  addi s3, x0, 50\n"
+                          "  addi t0, x0, 4\n"
+                          "claim:\n"
+                          "  amoadd.w t1, t0, (s0)\n"
+                          "  add t2, s1, t1\n"
+                          "  sw s2, 0(t2)\n"
+                          "  addi s3, s3, -1\n"
+                          "  bne s3, x0, claim\n";
+
+std::vector<uint32_t> RunLog(vm_config::HartSyncMode mode) {
+  MultiHartVm machine(HartContext(4, mode));
+  machine.LoadProgram(AssembleSource("multi_hart_log.s", kLogProgram));
+  machine.Run();
+  uint64_t log = vm_config::config.getDataSectionStart() + 8;
+  std::vector<uint32_t> ids;
+  for (uint64_t i = 0; i < 200; ++i) {
+    ids.push_back(machine.GetHart(0).memory_controller_.ReadWord(log + 4*i));
+  }
+  return ids;
+}
+
+} // namespace
+
+TEST(MultiHartTest, MemoryConcurrencyTest) {
+  VmContext context = VmContext::FromGlobals();
+  Memory memory(context.config);
+  memory.SetReservationTracking(true);
+  // Every thread touches every block, so the threads race to allocate the same blocks.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&memory]() {
+      for (uint64_t i = 0; i < 10000; ++i) {
+        memory.AtomicRmw(Memory::AmoOp::kAdd, (i % 64) * 0x10000, 8, 1);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  uint64_t sum = 0;
+  for (uint64_t block = 0; block < 64; ++block) {
+    sum += memory.ReadDoubleWord(block * 0x10000);
+  }
+  EXPECT_EQ(sum, 40000);
+
+  uint64_t stamp = memory.GetReservationStamp(0x100);
+  memory.WriteByte(0x107, 1);
+  EXPECT_NE(memory.GetReservationStamp(0x100), stamp);
+  EXPECT_TRUE(memory.CompareExchange(0x100, 4, 0, 7));
+  EXPECT_FALSE(memory.CompareExchange(0x100, 4, 0, 9));
+  EXPECT_EQ(memory.AtomicRmw(Memory::AmoOp::kMin, 0x100, 4, 0xFFFFFFFF), 7);
+  EXPECT_EQ(memory.ReadWord(0x100), 0xFFFFFFFF);
+  EXPECT_EQ(memory.AtomicRmw(Memory::AmoOp::kMaxu, 0x100, 4, 3), 0xFFFFFFFF);
+  EXPECT_EQ(memory.ReadWord(0x100), 0xFFFFFFFF);
+}
+
+TEST(MultiHartTest, AtomicInstructionsTest) {
+  VmContext context = HartContext(1, vm_config::HartSyncMode::QUANTUM);
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("atomics.s", ".data\n"
+                                                     "word: .word -5\n"
+                                                     "pad: .word 0\n"
+                                                     "dword: .dword 10\n"
+                                                     ".text\n"
+                                                     "  la s0, word\n"
+                                                     "  la s1, dword\n"
+                                                     "  addi t0, x0, 3\n"
+                                                     "  sc.d a0, t0, (s1)\n"   // no reservation: fails
+                                                     "  lr.d a1, (s1)\n"
+                                                     "  sc.d a2, t0, (s0)\n"   // wrong address: fails
+                                                     "  lr.d a1, (s1)\n"
+                                                     "  sc.d a3, t0, (s1)\n"   // succeeds, dword = 3
+                                                     "  sc.d a4, t0, (s1)\n"   // reservation consumed
+                                                     "  amoadd.w a5, t0, (s0)\n"  // a5 = -5, word = -2
+                                                     "  amomaxu.w a6, t0, (s0)\n" // a6 = -2, word stays
+                                                     "  amomin.w a7, t0, (s0)\n"  // a7 = -2, word = -2
+                                                     "  amoswap.d s2, t0, (s1)\n"
+                                                     "  lr.w s3, (s0)\n"));
+  vm.Run();
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 1);
+  EXPECT_EQ(vm.registers_.ReadGpr(11), 10);
+  EXPECT_EQ(vm.registers_.ReadGpr(12), 1);
+  EXPECT_EQ(vm.registers_.ReadGpr(13), 0);
+  EXPECT_EQ(vm.registers_.ReadGpr(14), 1);
+  EXPECT_EQ(vm.registers_.ReadGpr(15), static_cast<uint64_t>(-5));
+  EXPECT_EQ(vm.registers_.ReadGpr(16), static_cast<uint64_t>(-2));
+  EXPECT_EQ(vm.registers_.ReadGpr(17), static_cast<uint64_t>(-2));
+  EXPECT_EQ(vm.registers_.ReadGpr(18), 3);
+  EXPECT_EQ(vm.registers_.ReadGpr(19), static_cast<uint64_t>(-2));
+  EXPECT_EQ(vm.memory_controller_.ReadDoubleWord(vm_config::config.getDataSectionStart() + 8), 3);
+
+  // Atomics need natural alignment.
+  RVSSVM misaligned(context);
+  misaligned.LoadProgram(AssembleSource("atomics_misaligned.s", ".data\n"
+                                                                        "low: .word 0\n"
+                                                                        "high: .word 0\n"
+                                                                        ".text\n"
+                                                                        "  la s0, high\n"
+                                                                        "  amoadd.d x0, s0, (s0)\n"));
+  EXPECT_THROW(misaligned.Run(), std::runtime_error);
+}
+
+TEST(MultiHartTest, SharedCounterTest) {
+  for (auto mode : {vm_config::HartSyncMode::QUANTUM, vm_config::HartSyncMode::FREE_RUNNING}) {
+    VmContext context = HartContext(4, mode);
+    MultiHartVm machine(context);
+    machine.LoadProgram(AssembleSource("multi_hart.s", kCounterProgram));
+    machine.Run();
+
+    uint64_t data = context.config.getDataSectionStart();
+    EXPECT_EQ(machine.GetHart(0).memory_controller_.ReadDoubleWord(data + 8), 800);
+    EXPECT_EQ(machine.GetHart(0).memory_controller_.ReadDoubleWord(data + 16), 800);
+    for (unsigned int id = 0; id < machine.GetHartCount(); ++id) {
+      EXPECT_EQ(machine.GetHart(id).registers_.ReadGpr(10), id);
+      EXPECT_EQ(machine.GetHart(id).registers_.ReadGpr(11),
+                context.config.getStackTop() - id*context.config.getHartStackSize());
+    }
+
+    std::ostringstream summary;
+    machine.WriteSummary(summary);
+    EXPECT_NE(summary.str().find("Harts: 4"), std::string::npos);
+    EXPECT_GT(machine.GetStats().TotalInstructions(), 4*200*11);
+  }
+}
+
+TEST(MultiHartTest, QuantumDeterminismTest) {
+  std::vector<uint32_t> first = RunLog(vm_config::HartSyncMode::QUANTUM);
+  EXPECT_EQ(first, RunLog(vm_config::HartSyncMode::QUANTUM));
+  // With a 7-instruction quantum the harts take turns claiming slots.
+  EXPECT_EQ(first[0], 0);
+  EXPECT_NE(first, std::vector<uint32_t>(200, first[0]));
+
+  std::vector<uint32_t> free_running = RunLog(vm_config::HartSyncMode::FREE_RUNNING);
+  for (uint32_t id = 0; id < 4; ++id) {
+    EXPECT_EQ(std::count(free_running.begin(), free_running.end(), id), 50);
+  }
+}
@@ -0,0 +1,79 @@
+/**
+ * File Name: test_perf_counters.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/perf_counters.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <numeric>
+
+TEST(PerfCountersTest, CsrNamesTest) {
+  EXPECT_EQ(csr_to_address.at("cycle"), kCsrCycle);
+  EXPECT_EQ(csr_to_address.at("instret"), kCsrInstret);
+  EXPECT_EQ(csr_to_address.at("hpmcounter31"), kCsrHpmCounter31);
+  EXPECT_TRUE(IsValidCsr("hpmcounter3"));
+  EXPECT_FALSE(IsValidCsr("hpmcounter32"));
+}
+
+TEST(PerfCountersTest, ClassifyAluOpTest) {
+  EXPECT_EQ(ClassifyAluOp(alu::AluOp::kAdd), InstructionClass::kAlu);
+  EXPECT_EQ(ClassifyAluOp(alu::AluOp::kMul_simd8), InstructionClass::kSimd);
+  EXPECT_EQ(ClassifyAluOp(alu::AluOp::kEcc_add), InstructionClass::kEcc);
+  EXPECT_EQ(ClassifyAluOp(alu::AluOp::kQMeas), InstructionClass::kQuantum);
+
+  PerfCounters counters;
+  counters.CountClass(InstructionClass::kStore);
+  EXPECT_EQ(counters.ReadHpmCounter(3 + static_cast<unsigned int>(InstructionClass::kStore)), 1);
+  EXPECT_EQ(counters.ReadHpmCounter(31), 0);
+  EXPECT_EQ(counters.ReadHpmCounter(2), 0);
+}
+
+TEST(PerfCountersTest, InstructionMixTest) {
+  ASSERT_TRUE(kPerfCountersEnabled);
+  RVSSVM vm(HeadlessContext());
+  vm.LoadProgram(AssembleSource("perf_mix.s",
+                                "  addi a0, x0, 2\n"
+                                "  lui a1, 0x10000\n"
+                                "loop:\n"
+                                "  sd a0, 0(a1)\n"
+                                "  ld a2, 0(a1)\n"
+                                "  addi a0, a0, -1\n"
+                                "  bne a0, x0, loop\n"
+                                "  jal x0, end\n"
+                                "end:\n"
+                                "  csrrs a3, instret, x0\n"));
+  vm.Run();
+
+  const auto &classes = vm.perf_counters_.classes;
+  EXPECT_EQ(classes[static_cast<size_t>(InstructionClass::kStore)], 2);
+  EXPECT_EQ(classes[static_cast<size_t>(InstructionClass::kLoad)], 2);
+  EXPECT_EQ(classes[static_cast<size_t>(InstructionClass::kBranchTaken)], 1);
+  EXPECT_EQ(classes[static_cast<size_t>(InstructionClass::kBranchNotTaken)], 1);
+  EXPECT_EQ(classes[static_cast<size_t>(InstructionClass::kJump)], 1);
+  EXPECT_EQ(classes[static_cast<size_t>(InstructionClass::kCsr)], 1);
+  EXPECT_EQ(classes[static_cast<size_t>(InstructionClass::kAlu)], 4);
+  // Every instruction but the CSR read goes through the ALU exactly once.
+  const auto &alu_ops = vm.perf_counters_.alu_ops;
+  EXPECT_EQ(std::accumulate(alu_ops.begin(), alu_ops.end(), uint64_t{0}), vm.instructions_retired_ - 1);
+}
+
+TEST(PerfCountersTest, GuestReadsCountersTest) {
+  RVSSVM vm(HeadlessContext());
+  vm.LoadProgram(AssembleSource("perf_csr.s",
+                                "  addi t0, x0, 1\n"
+                                "  addi t0, t0, 1\n"
+                                "  csrrs a0, instret, x0\n"
+                                "  csrrs a1, hpmcounter3, x0\n"
+                                "  csrrw a2, cycle, t0\n"
+                                "  csrrs a3, cycle, x0\n"));
+  vm.Run();
+
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 2);
+  EXPECT_EQ(vm.registers_.ReadGpr(11), 2); // two ALU instructions before it
+  // Counters are read-only: the csrrw does not reset cycle.
+  EXPECT_EQ(vm.registers_.ReadGpr(13), 5);
+}
@@ -0,0 +1,128 @@
+/**
+ * File Name: test_profiler.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/profiler.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <sstream>
+
+namespace {
+
+constexpr uint32_t kJalRa = 0x000000ef;   // jal ra, <target>
+constexpr uint32_t kReturn = 0x00008067;  // jalr x0, 0(ra)
+constexpr uint32_t kAddi = 0x00000013;
+
+// main: 0 (jal ra, func), 4 and 8 (one pseudo-instruction), func: 12, 16 (ret)
+AssembledProgram CallProgram() {
+  AssembledProgram program;
+  program.symbol_table["main"] = {0, 1, false};
+  program.symbol_table["func"] = {12, 4, false};
+  program.symbol_table["value"] = {0x10000000, 7, true};
+  program.instruction_number_line_number_mapping = {{0, 2}, {1, 3}, {2, 3}, {3, 5}, {4, 6}};
+  return program;
+}
+
+void RunCallProgram(Profiler &profiler) {
+  profiler.Start(0, 20, 0);
+  profiler.RecordInstruction(0, kJalRa, 12);
+  profiler.RecordInstruction(12, kAddi, 16);
+  profiler.RecordInstruction(16, kReturn, 4);
+  profiler.RecordInstruction(4, kAddi, 8);
+  profiler.RecordInstruction(8, kAddi, 12);
+}
+
+} // namespace
+
+TEST(ProfilerTest, HotSpotsTest) {
+  Profiler profiler;
+  RunCallProgram(profiler);
+  AssembledProgram program = CallProgram();
+
+  EXPECT_EQ(profiler.GetTotal(), 5);
+  EXPECT_EQ(profiler.GetCount(4), 1);
+  std::vector<Profiler::HotSpot> spots = profiler.GetHotSpots(program, 2);
+  ASSERT_EQ(spots.size(), 2);
+  EXPECT_EQ(spots[0].line, 3);
+  EXPECT_EQ(spots[0].pc, 4);
+  EXPECT_EQ(spots[0].count, 2);
+  EXPECT_EQ(spots[1].count, 1);
+
+  // Without a line mapping (ELF input) every instruction is its own hot spot.
+  program.instruction_number_line_number_mapping.clear();
+  EXPECT_EQ(profiler.GetHotSpots(program, 10).size(), 5);
+}
+
+TEST(ProfilerTest, CallTrackingTest) {
+  Profiler profiler;
+  RunCallProgram(profiler);
+  AssembledProgram program = CallProgram();
+
+  std::vector<Profiler::FunctionCount> functions = profiler.GetFunctionCounts(program);
+  ASSERT_EQ(functions.size(), 2);
+  EXPECT_EQ(functions[0].name, "main");
+  EXPECT_EQ(functions[0].exclusive, 3);
+  EXPECT_EQ(functions[0].inclusive, 5);
+  EXPECT_EQ(functions[1].name, "func");
+  EXPECT_EQ(functions[1].exclusive, 2);
+  EXPECT_EQ(functions[1].inclusive, 2);
+  EXPECT_TRUE(functions[1].called);
+
+  std::ostringstream folded;
+  profiler.WriteFoldedStacks(folded, program);
+  EXPECT_EQ(folded.str(), "main 3\nmain;func 2\n");
+}
+
+TEST(ProfilerTest, RecursionIsNotDoubleCountedTest) {
+  Profiler profiler;
+  profiler.Start(0, 20, 0);
+  profiler.RecordInstruction(0, kJalRa, 12);
+  profiler.RecordInstruction(12, kJalRa, 12);
+  profiler.RecordInstruction(12, kReturn, 16);
+  profiler.RecordInstruction(16, kReturn, 4);
+
+  std::vector<Profiler::FunctionCount> functions = profiler.GetFunctionCounts(CallProgram());
+  ASSERT_EQ(functions.size(), 2);
+  EXPECT_EQ(functions[1].inclusive, 3);
+  EXPECT_EQ(functions[0].inclusive, 4);
+}
+
+TEST(ProfilerTest, VmProfilingTest) {
+  const std::string source = "main:\n"
+                             "  addi a0, x0, 3\n"
+                             "loop:\n"
+                             "  jal ra, func\n"
+                             "  addi a0, a0, -1\n"
+                             "  bne a0, x0, loop\n"
+                             "  jal x0, done\n"
+                             "func:\n"
+                             "  addi a1, a1, 1\n"
+                             "  jalr x0, 0(ra)\n"
+                             "done:\n"
+                             "  addi a2, x0, 1\n";
+
+  VmContext context = HeadlessContext();
+  context.config.setProfilingEnabled(true);
+  RVSSVM vm(context);
+  // The report quotes source lines, so the file has to outlive the run.
+  std::filesystem::path path = WriteTempFile("profile.s", source);
+  vm.LoadProgram(assemble(path.string(), false));
+  vm.Run();
+
+  ASSERT_TRUE(vm.profiler_.IsEnabled());
+  EXPECT_EQ(vm.profiler_.GetTotal(), vm.instructions_retired_);
+  EXPECT_EQ(vm.profiler_.GetCount(4), 3);
+
+  std::ostringstream report;
+  vm.profiler_.WriteReport(report, vm.program_, 3);
+  EXPECT_NE(report.str().find("jal ra, func"), std::string::npos);
+
+  std::ostringstream folded;
+  vm.profiler_.WriteFoldedStacks(folded, vm.program_);
+  EXPECT_NE(folded.str().find("main;func 6\n"), std::string::npos);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,121 @@
+/**
+ * File Name: test_sim_server.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "sim_server.h"
+#include "json.h"
+#include "test_util.h"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <sstream>
+#include <thread>
+
+TEST(JsonTest, RoundTripTest) {
+  std::string text = R"({"id":18446744073709551615,"s":"a\"b\\\n\u0001","f":-1.5e3,"t":true,"n":null,"a":[1,[],{}]})";
+  json::Value value = json::Parse(" " + text + "\n");
+  EXPECT_EQ(json::Serialize(value), text);
+  EXPECT_EQ(value.Find("id")->AsUint64(), 18446744073709551615ULL);
+  EXPECT_EQ(value.Find("s")->AsString(), "a\"b\\\n\x01");
+  EXPECT_DOUBLE_EQ(value.Find("f")->AsDouble(), -1500.0);
+  EXPECT_TRUE(value.Find("t")->AsBool());
+  EXPECT_TRUE(value.Find("n")->IsNull());
+  EXPECT_EQ(value.Find("missing"), nullptr);
+  EXPECT_EQ(json::Value::String("0x10").AsUint64(), 16);
+
+  EXPECT_THROW(json::Parse("{\"a\":1,}"), std::runtime_error);
+  EXPECT_THROW(json::Parse("[1] 2"), std::runtime_error);
+  EXPECT_THROW(json::Parse("\"\\x\""), std::runtime_error);
+  EXPECT_THROW(json::Parse(std::string(100, '[') + std::string(100, ']')), std::runtime_error);
+  EXPECT_THROW(static_cast<void>(json::Parse("-1").AsUint64()), std::runtime_error);
+  EXPECT_EQ(json::Quote("\xff"), "\"\\u00ff\"");
+}
+
+TEST(SimServerTest, ParseJobRequestTest) {
+  sim_server::JobRequest request = sim_server::ParseJobRequest(
+      R"({"id":"a","source":"nop","stdin":"x","max_instructions":10,"registers":true,)"
+      R"("config":{"Execution":{"random_seed":3}},"memory":[["0x10",4]]})");
+  EXPECT_EQ(request.id.AsString(), "a");
+  EXPECT_EQ(request.source, "nop");
+  EXPECT_EQ(request.stdin_text, "x");
+  EXPECT_EQ(request.max_instructions, 10);
+  EXPECT_TRUE(request.include_registers);
+  ASSERT_EQ(request.config_overrides.size(), 1);
+  EXPECT_EQ(request.config_overrides[0][2], "3");
+  ASSERT_EQ(request.memory_reads.size(), 1);
+  EXPECT_EQ(request.memory_reads[0], std::make_pair(uint64_t{0x10}, uint64_t{4}));
+
+  EXPECT_THROW(sim_server::ParseJobRequest(R"({"id":1})"), std::runtime_error);
+  EXPECT_THROW(sim_server::ParseJobRequest(R"({"source":"","program":"a.s"})"), std::runtime_error);
+  EXPECT_THROW(sim_server::ParseJobRequest(R"({"source":"","colour":1})"), std::runtime_error);
+  EXPECT_THROW(sim_server::ParseJobRequest(R"({"source":"","config":{"Execution":{"trace_file":"x"}}})"),
+               std::runtime_error);
+}
+
+TEST(SimServerTest, ServesJobsOverSocketTest) {
+  std::filesystem::path socket_path = TempPath("sim_server.sock");
+  VmContext context = HeadlessContext();
+  sim_server::Server server(socket_path, context, 2);
+  std::thread serving([&]() { server.Serve(); });
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  ASSERT_GE(fd, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, socket_path.c_str(), sizeof(address.sun_path) - 1);
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)), 0);
+
+  std::string exiting = json::Quote(".data\nmsg: .string \"hi\"\n.text\n  la a0, msg\n  addi a0, x0, 7\n"
+                                    "  addi a7, x0, 93\n  ecall\n");
+  std::string spinning = json::Quote(".text\nloop:\n  beq x0, x0, loop\n");
+  std::ostringstream requests;
+  for (int i = 0; i < 8; ++i) {
+    requests << R"({"id":)" << i << R"(,"source":)" << exiting << R"(,"registers":true})" << "\n";
+  }
+  requests << R"({"id":"spin","source":)" << spinning << R"(,"max_instructions":1000})" << "\n";
+  requests << R"({"id":"bad","source":".text\n  addx a0\n"})" << "\n";
+  requests << "{\n";
+  std::string sent = requests.str();
+  ASSERT_EQ(send(fd, sent.data(), sent.size(), 0), static_cast<ssize_t>(sent.size()));
+  shutdown(fd, SHUT_WR);
+
+  std::string received;
+  char buffer[4096];
+  ssize_t n;
+  while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    received.append(buffer, static_cast<size_t>(n));
+  }
+  close(fd);
+
+  std::map<std::string, json::Value> answers;
+  std::istringstream lines(received);
+  std::string line;
+  while (std::getline(lines, line)) {
+    json::Value answer = json::Parse(line);
+    answers[json::Serialize(*answer.Find("id"))] = answer;
+  }
+  ASSERT_EQ(answers.size(), 11);
+  for (int i = 0; i < 8; ++i) {
+    const json::Value &answer = answers[std::to_string(i)];
+    EXPECT_EQ(answer.Find("status")->AsString(), "exited");
+    EXPECT_EQ(answer.Find("exit_code")->AsUint64(), 7);
+    EXPECT_EQ(answer.Find("instructions")->AsUint64(), 5);
+    EXPECT_EQ(answer.Find("registers")->Find("x17")->AsUint64(), 93);
+  }
+  EXPECT_EQ(answers["\"spin\""].Find("status")->AsString(), "timeout");
+  EXPECT_EQ(answers["\"spin\""].Find("instructions")->AsUint64(), 1000);
+  EXPECT_EQ(answers["\"bad\""].Find("status")->AsString(), "error");
+  EXPECT_EQ(answers["null"].Find("status")->AsString(), "error");
+
+  server.Stop();
+  serving.join();
+  EXPECT_EQ(server.GetJobsCompleted(), 10);
+}
@@ -0,0 +1,106 @@
+/**
+ * File Name: test_simpoint.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "simpoint.h"
+#include "test_util.h"
+
+#include <cmath>
+#include <filesystem>
+#include <numeric>
+#include <sstream>
+
+namespace {
+
+// Three rounds of an ALU phase (CPI about 1) and a phase that misses the cache on every load.
+const char *kPhasedProgram = ".data\n"
+                             "buffer: .zero 65536\n"
+                             ".text\n"
+                             "  li s3, 3\n"
+                             "round:\n"
+                             "  li s1, 6000\n"
+                             "alu:\n"
+                             "  mul t0, s1, s1\n"
+                             "  add t1, t1, t0\n"
+                             "  addi s1, s1, -1\n"
+                             "  bne s1, x0, alu\n"
+                             "  li s2, 4\n"
+                             "pass:\n"
+                             "  la s0, buffer\n"
+                             "  li s1, 1024\n"
+                             "load:\n"
+                             "  ld t0, 0(s0)\n"
+                             "  addi s0, s0, 64\n"
+                             "  addi s1, s1, -1\n"
+                             "  bne s1, x0, load\n"
+                             "  addi s2, s2, -1\n"
+                             "  bne s2, x0, pass\n"
+                             "  addi s3, s3, -1\n"
+                             "  bne s3, x0, round\n";
+
+} // namespace
+
+TEST(SimPointTest, CollectsAndClustersBasicBlockVectorsTest) {
+  RVSSVM vm(HeadlessContext());
+  vm.LoadProgram(AssembleSource("simpoint.s", kPhasedProgram));
+  simpoint::BasicBlockVectors bbvs = simpoint::CollectBasicBlockVectors(vm, 4000, 0);
+
+  EXPECT_EQ(bbvs.total_instructions, vm.instructions_retired_);
+  EXPECT_EQ(bbvs.intervals.size(), (bbvs.total_instructions + 3999)/4000);
+  EXPECT_EQ(std::accumulate(bbvs.interval_instructions.begin(), bbvs.interval_instructions.end(), uint64_t{0}),
+            bbvs.total_instructions);
+  EXPECT_EQ(bbvs.block_starts[0], 0);
+  EXPECT_NE(std::find(bbvs.block_starts.begin(), bbvs.block_starts.end(),
+                      vm.program_.symbol_table.at("load").address), bbvs.block_starts.end());
+  uint64_t first_interval = 0;
+  for (auto [block, count] : bbvs.intervals[0]) {
+    first_interval += count;
+  }
+  EXPECT_EQ(first_interval, 4000);
+
+  simpoint::Clustering clustering = simpoint::ClusterIntervals(bbvs, 10, 1);
+  EXPECT_GE(clustering.k, 2);
+  EXPECT_EQ(clustering.representatives.size(), clustering.k);
+  EXPECT_NEAR(std::accumulate(clustering.weights.begin(), clustering.weights.end(), 0.0), 1.0, 1e-9);
+  // The ALU phase and the load phase never share a cluster.
+  const size_t alu_interval = 1;
+  const size_t load_interval = 7;
+  EXPECT_NE(clustering.assignment[alu_interval], clustering.assignment[load_interval]);
+
+  simpoint::BasicBlockVectors limited = simpoint::CollectBasicBlockVectors(vm, 4000, 0);
+  EXPECT_EQ(limited.total_instructions, 0); // already halted
+}
+
+TEST(SimPointTest, SampledCpiMatchesFullRunTest) {
+  std::filesystem::path source = WriteTempFile("simpoint.s", kPhasedProgram);
+  simpoint::SimPointOptions options;
+  options.interval_size = 4000;
+  options.warmup = 2000;
+  options.jobs = 2;
+  options.compare = true;
+  std::ostringstream log;
+  simpoint::SimPointReport report = simpoint::Run(source, HeadlessContext(), options, log);
+
+  ASSERT_TRUE(report.full.has_value());
+  EXPECT_EQ(report.full->instructions, report.total_instructions);
+  EXPECT_GE(report.points.size(), 2);
+  EXPECT_LT(report.detailed_instructions, report.total_instructions/2);
+  EXPECT_NEAR(report.cpi, report.full->Cpi(), 0.05*report.full->Cpi());
+  EXPECT_NEAR(report.cache_miss_rate, report.full->CacheMissRate(), 0.05);
+  EXPECT_GT(report.cpi, 1.5); // the misses are charged
+  for (const simpoint::SimulationPoint &point : report.points) {
+    EXPECT_GT(point.stats.instructions, 0);
+  }
+
+  std::ostringstream text;
+  simpoint::WriteReport(text, report);
+  EXPECT_NE(text.str().find("Weighted CPI"), std::string::npos);
+  EXPECT_NE(text.str().find("sampling error"), std::string::npos);
+
+  options.interval_size = 0;
+  EXPECT_THROW(simpoint::Run(source, HeadlessContext(), options, log), std::invalid_argument);
+  std::filesystem::remove(source);
+}
@@ -0,0 +1,109 @@
+/**
+ * File Name: test_snapshot.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/main_memory.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+TEST(SnapshotTest, MemoryForkTest) {
+  VmContext context = VmContext::FromGlobals();
+  context.config.setMemoryBlockSize(64);
+  auto memory = std::make_unique<Memory>(context.config);
+  memory->WriteDoubleWord(0x1000, 1);
+  memory->WriteDoubleWord(0x2000, 2);
+
+  std::unique_ptr<Memory> fork = memory->Fork();
+  EXPECT_EQ(fork->ReadDoubleWord(0x1000), 1);
+  EXPECT_EQ(fork->GetBlockCount(), 2);
+  EXPECT_EQ(fork->GetSharedBlockCount(), 2);
+
+  // Each side copies a block on its first write; the other keeps the old contents.
+  fork->WriteDoubleWord(0x1008, 3);
+  memory->WriteDoubleWord(0x2000, 4);
+  EXPECT_EQ(memory->ReadDoubleWord(0x1008), 0);
+  EXPECT_EQ(fork->ReadDoubleWord(0x1008), 3);
+  EXPECT_EQ(fork->ReadDoubleWord(0x2000), 2);
+  EXPECT_EQ(memory->ReadDoubleWord(0x2000), 4);
+  EXPECT_EQ(fork->GetSharedBlockCount(), 0);
+  EXPECT_EQ(memory->GetSharedBlockCount(), 0);
+
+  // Blocks written only after the fork are private from the start.
+  fork->WriteByte(0x3000, 5);
+  EXPECT_EQ(memory->ReadByte(0x3000), 0);
+
+  // Once the origin is gone the fork owns its blocks and writes them in place.
+  std::unique_ptr<Memory> second = fork->Fork();
+  fork.reset();
+  second->WriteDoubleWord(0x1000, 6);
+  EXPECT_EQ(second->ReadDoubleWord(0x1000), 6);
+  EXPECT_EQ(second->ReadDoubleWord(0x1008), 3);
+  EXPECT_EQ(second->GetBlockCount(), 3);
+  EXPECT_EQ(second->GetSharedBlockCount(), 0);
+}
+
+TEST(SnapshotTest, VmForkTest) {
+  std::filesystem::path first_input = TempPath("snapshot_1.txt");
+  std::filesystem::path second_input = TempPath("snapshot_2.txt");
+  std::ofstream(first_input) << "x";
+  std::ofstream(second_input) << "yz";
+  const std::string source = ".data\n"
+                             "counter: .dword 0\n"
+                             "buffer: .dword 0\n"
+                             ".text\n"
+                             "  la s0, counter\n"
+                             "  addi s1, x0, 41\n"
+                             "  ld t0, 0(s0)\n"
+                             "  addi t0, t0, 1\n"
+                             "  sd t0, 0(s0)\n"
+                             "  addi a7, x0, 63\n"
+                             "  addi a0, x0, 0\n"
+                             "  la a1, buffer\n"
+                             "  addi a2, x0, 8\n"
+                             "  ecall\n"
+                             "  lb a3, 0(a1)\n";
+
+  VmContext context = HeadlessContext();
+  context.config.setStdinFile(first_input.string());
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("snapshot.s", source));
+  vm.Step();
+  vm.Step();
+  vm.Step();
+  VmSnapshot snapshot = vm.Snapshot();
+  EXPECT_EQ(snapshot.registers.ReadGpr(9), 41);
+
+  vm.Run();
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 1);
+  EXPECT_EQ(vm.registers_.ReadGpr(13), 'x');
+
+  // Forks resume from the snapshot, not from where the VM stopped.
+  uint64_t counter = context.config.getDataSectionStart();
+  for (int run = 0; run < 2; ++run) {
+    RVSSVM fork(context);
+    fork.Fork(snapshot);
+    EXPECT_EQ(fork.registers_.ReadGpr(9), 41);
+    EXPECT_EQ(fork.memory_controller_.ReadDoubleWord(counter), 0);
+    fork.Run();
+    EXPECT_EQ(fork.memory_controller_.ReadDoubleWord(counter), 1);
+    EXPECT_EQ(fork.registers_.ReadGpr(13), 'x');
+    EXPECT_EQ(fork.instructions_retired_, vm.instructions_retired_);
+  }
+
+  // A fork of a changed snapshot sees the new environment.
+  VmSnapshot other_input = snapshot;
+  other_input.config.setStdinFile(second_input.string());
+  vm.Fork(other_input);
+  vm.Run();
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 2);
+  EXPECT_EQ(vm.registers_.ReadGpr(13), 'y');
+  EXPECT_EQ(vm.memory_controller_.ReadDoubleWord(counter), 1);
+  EXPECT_EQ(snapshot.memory->ReadDoubleWord(counter), 0);
+}
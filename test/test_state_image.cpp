@@ -0,0 +1,149 @@
+/**
+ * File Name: test_state_image.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/state_image.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace {
+
+const char *kSquaresProgram = ".data\n"
+                              "squares: .zero 16000\n"
+                              ".text\n"
+                              "  la s0, squares\n"
+                              "  addi s1, x0, 0\n"
+                              "  li s2, 2000\n"
+                              "  vsetivli t1, 4, e32, m1, ta, ma\n"
+                              "  vmv.v.i v1, 7\n"
+                              "loop:\n"
+                              "  mul t0, s1, s1\n"
+                              "  sd t0, 0(s0)\n"
+                              "  addi s0, s0, 8\n"
+                              "  addi s1, s1, 1\n"
+                              "  bne s1, s2, loop\n";
+
+void RunToEnd(RVSSVM &vm) {
+  while (!vm.IsHalted()) {
+    vm.RunQuantum(65536);
+  }
+}
+
+} // namespace
+
+TEST(StateImageTest, RestoredVmResumesRunTest) {
+  std::filesystem::path image = TempPath("state_image.bin");
+  VmContext context = HeadlessContext();
+  context.config.setVectorLength(256);
+  context.config.setMemoryBlockSize(512);
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("state_image.s", kSquaresProgram));
+  vm.RunQuantum(3000);
+  const uint64_t loop_address = vm.program_.symbol_table.at("loop").address;
+  vm.breakpoints_.Add(loop_address + 4, "s1 == 1500", 2);
+  vm.SaveState(image);
+
+  // Another machine, configured differently: the image's memory geometry and vlen win.
+  VmContext other_context = HeadlessContext();
+  other_context.config.setVectorLength(128);
+  other_context.config.setMemoryBlockSize(4096);
+  RVSSVM restored(other_context);
+  restored.RestoreState(image);
+
+  EXPECT_EQ(restored.program_counter_, vm.program_counter_);
+  EXPECT_EQ(restored.instructions_retired_, vm.instructions_retired_);
+  EXPECT_EQ(restored.cycle_s_, vm.cycle_s_);
+  EXPECT_EQ(restored.registers_.GetGprValues(), vm.registers_.GetGprValues());
+  EXPECT_EQ(restored.registers_.ReadCsr(kCsrVl), 4);
+  EXPECT_EQ(restored.registers_.GetVlenb(), 32);
+  EXPECT_EQ(std::memcmp(restored.registers_.VectorData(), vm.registers_.VectorData(), 32*32), 0);
+  EXPECT_EQ(restored.memory_controller_.GetSharedMemory()->GetBlockShift(), 9);
+  EXPECT_EQ(restored.program_.text_buffer, vm.program_.text_buffer);
+  EXPECT_EQ(restored.program_.symbol_table.at("loop").address, loop_address);
+  EXPECT_EQ(restored.program_.instruction_number_line_number_mapping,
+            vm.program_.instruction_number_line_number_mapping);
+  std::vector<BreakpointSet::Breakpoint> breakpoints = restored.breakpoints_.GetBreakpoints();
+  ASSERT_EQ(breakpoints.size(), 1);
+  EXPECT_EQ(breakpoints[0].address, loop_address + 4);
+  EXPECT_EQ(breakpoints[0].condition, "s1 == 1500");
+  EXPECT_EQ(breakpoints[0].hit_count, 2);
+
+  RunToEnd(vm);
+  RunToEnd(restored);
+  EXPECT_EQ(restored.instructions_retired_, vm.instructions_retired_);
+  EXPECT_EQ(restored.registers_.GetGprValues(), vm.registers_.GetGprValues());
+  const uint64_t squares = context.config.getDataSectionStart();
+  for (uint64_t i = 0; i < 2000; i += 97) {
+    EXPECT_EQ(restored.memory_controller_.ReadDoubleWord(squares + 8*i), i*i);
+  }
+
+  // Only the written pages are stored, so the image is far smaller than the 16 KB they span.
+  EXPECT_LT(std::filesystem::file_size(image), 12000);
+  std::filesystem::remove(image);
+}
+
+TEST(StateImageTest, RejectsBadImagesTest) {
+  std::filesystem::path image = TempPath("state_image_bad.bin");
+  RVSSVM vm(HeadlessContext());
+  vm.LoadProgram(AssembleSource("state_image.s", kSquaresProgram));
+  vm.RunQuantum(100);
+  vm.SaveState(image);
+
+  std::vector<char> bytes;
+  {
+    std::ifstream file(image, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+  }
+  auto write = [&](const std::vector<char> &contents) {
+    std::ofstream(image, std::ios::binary | std::ios::trunc).write(contents.data(), static_cast<std::streamsize>(contents.size()));
+  };
+
+  RVSSVM restored(HeadlessContext());
+  std::vector<char> truncated(bytes.begin(), bytes.end() - 5);
+  write(truncated);
+  EXPECT_THROW(restored.RestoreState(image), std::runtime_error);
+
+  std::vector<char> newer = bytes;
+  newer[offsetof(StateImageHeader, version)] = static_cast<char>(kStateImageVersion + 1);
+  write(newer);
+  EXPECT_THROW(restored.RestoreState(image), std::runtime_error);
+
+  std::vector<char> not_an_image = bytes;
+  not_an_image[0] = 'X';
+  write(not_an_image);
+  EXPECT_THROW(restored.RestoreState(image), std::runtime_error);
+
+  // Sizes that would allocate far more than the file could fill.
+  const uint64_t huge = uint64_t{1} << 62;
+  std::vector<char> huge_metadata = bytes;
+  std::memcpy(huge_metadata.data() + offsetof(StateImageHeader, metadata_raw_size), &huge, sizeof(huge));
+  write(huge_metadata);
+  EXPECT_THROW(restored.RestoreState(image), std::runtime_error);
+  std::vector<char> huge_page_count = bytes;
+  std::memcpy(huge_page_count.data() + offsetof(StateImageHeader, page_count), &huge, sizeof(huge));
+  write(huge_page_count);
+  EXPECT_THROW(restored.RestoreState(image), std::runtime_error);
+
+  write(bytes);
+  EXPECT_NO_THROW(restored.RestoreState(image));
+  EXPECT_EQ(restored.instructions_retired_, 100);
+
+  // The counters are 64 bits wide end to end.
+  vm.instructions_retired_ += uint64_t{1} << 32;
+  vm.cycle_s_ += uint64_t{1} << 33;
+  vm.SaveState(image);
+  restored.RestoreState(image);
+  EXPECT_EQ(restored.instructions_retired_, (uint64_t{1} << 32) + 100);
+  EXPECT_EQ(restored.cycle_s_, vm.cycle_s_);
+  std::filesystem::remove(image);
+  EXPECT_THROW(restored.RestoreState(image), std::runtime_error);
+}
@@ -0,0 +1,113 @@
+/**
+ * File Name: test_state_publisher.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/state_publisher.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+TEST(StatePublisherTest, ReadersNeverSeeATornStateTest) {
+  StatePublisher publisher;
+  std::atomic<bool> done = false;
+  std::atomic<uint64_t> torn = 0;
+  std::atomic<uint64_t> reads = 0;
+
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 3; ++i) {
+    readers.emplace_back([&]() {
+      uint64_t last_sequence = 0;
+      while (!done) {
+        PublishedState state = publisher.Read();
+        bool consistent = state.instructions_retired == state.program_counter
+                          && state.cycles == 2*state.program_counter && state.sequence >= last_sequence;
+        for (size_t r = 0; r < 32; ++r) {
+          consistent = consistent && state.gprs[r] == state.program_counter + r && state.fprs[r] == ~state.gprs[r];
+        }
+        if (!consistent && state.sequence > 0) {
+          torn++;
+        }
+        last_sequence = state.sequence;
+        reads++;
+      }
+    });
+  }
+
+  for (uint64_t value = 1; value <= 200000; ++value) {
+    PublishedState state;
+    state.program_counter = value;
+    state.instructions_retired = value;
+    state.cycles = 2*value;
+    for (size_t r = 0; r < 32; ++r) {
+      state.gprs[r] = value + r;
+      state.fprs[r] = ~(value + r);
+    }
+    publisher.Publish(state);
+  }
+  done = true;
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+
+  EXPECT_EQ(torn, 0);
+  EXPECT_GT(reads, 0);
+  EXPECT_EQ(publisher.GetSequence(), 200000);
+  EXPECT_EQ(publisher.Read().program_counter, 200000);
+}
+
+TEST(StatePublisherTest, MemoryViewMatchesRegistersTest) {
+  const std::string source = ".data\n"
+                             "counter: .dword 0\n"
+                             ".text\n"
+                             "  la s0, counter\n"
+                             "  addi s1, x0, 0\n"
+                             "  li s2, 100000\n"
+                             "loop:\n"
+                             "  addi s1, s1, 1\n"
+                             "  sd s1, 0(s0)\n"
+                             "  bne s1, s2, loop\n";
+
+  VmContext context = HeadlessContext();
+  context.config.setPublishIntervalInstructions(5000);
+  context.config.setPublishIntervalMs(0);
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("state_publisher.s", source));
+  const uint64_t counter = context.config.getDataSectionStart();
+
+  std::thread vm_thread([&]() { vm.DebugRun(); });
+  unsigned int views = 0;
+  uint64_t last_instret = 0;
+  while (true) {
+    std::shared_ptr<const PublishedMemoryView> view = vm.state_publisher_.AcquireMemoryView(std::chrono::seconds(1));
+    if (!view) {
+      // The run ended between the request and the next publication point.
+      EXPECT_FALSE(vm.state_publisher_.Read().running);
+      break;
+    }
+    // The view was forked at the instruction boundary its registers describe: the counter in
+    // memory trails s1 by at most the one store in flight.
+    uint64_t s1 = view->state.gprs[9];
+    uint64_t stored = view->memory->ReadDoubleWord(counter);
+    EXPECT_TRUE(stored == s1 || stored + 1 == s1) << "s1 " << s1 << ", counter " << stored;
+    EXPECT_GE(view->state.instructions_retired, last_instret);
+    last_instret = view->state.instructions_retired;
+    views++;
+    if (!view->state.running) {
+      break;
+    }
+  }
+  vm_thread.join();
+
+  EXPECT_GT(views, 1);
+  PublishedState final_state = vm.state_publisher_.Read();
+  EXPECT_FALSE(final_state.running);
+  EXPECT_EQ(final_state.instructions_retired, vm.instructions_retired_);
+  EXPECT_EQ(final_state.gprs[9], 100000);
+  EXPECT_EQ(vm.memory_controller_.ReadDoubleWord(counter), 100000);
+}
@@ -0,0 +1,148 @@
+/**
+ * File Name: test_timing_model.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/timing_model.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+namespace {
+
+constexpr uint32_t RType(uint32_t funct7, uint32_t rs2, uint32_t rs1, uint32_t funct3, uint32_t rd, uint32_t opcode) {
+  return (funct7 << 25) | (rs2 << 20) | (rs1 << 15) | (funct3 << 12) | (rd << 7) | opcode;
+}
+
+constexpr uint32_t kMulT0S1S1 = RType(0b0000001, 9, 9, 0b000, 5, 0b0110011);
+constexpr uint32_t kAddT1T1T0 = RType(0b0000000, 5, 6, 0b000, 6, 0b0110011);
+constexpr uint32_t kAddT2S1S1 = RType(0b0000000, 9, 9, 0b000, 7, 0b0110011);
+constexpr uint32_t kDivA0A1A2 = RType(0b0000001, 12, 11, 0b100, 10, 0b0110011);
+constexpr uint32_t kDivA3A4A5 = RType(0b0000001, 15, 14, 0b100, 13, 0b0110011);
+
+vm_config::VmConfig TimingConfig() {
+  vm_config::VmConfig config;
+  config.setTimingEnabled(true);
+  return config;
+}
+
+} // namespace
+
+TEST(TimingModelTest, ClassifiesAndDecodesOperandsTest) {
+  EXPECT_EQ(ClassifyLatency(kMulT0S1S1, alu::AluOp::kMul), LatencyClass::kMul);
+  EXPECT_EQ(ClassifyLatency(kDivA0A1A2, alu::AluOp::kRem), LatencyClass::kDiv);
+  EXPECT_EQ(ClassifyLatency(RType(0, 0, 10, 0b011, 5, 0b0000011), alu::AluOp::kAdd), LatencyClass::kLoad);
+  EXPECT_EQ(ClassifyLatency(RType(0, 11, 10, 0b010, 0, 0b0100011), alu::AluOp::kAdd), LatencyClass::kStore);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::kMul_simd16), LatencyClass::kSimdMul);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::kRem_simd8), LatencyClass::kSimdDiv);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::kLoad_simdb), LatencyClass::kSimd);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::kEcc_mul), LatencyClass::kEcc);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::kQMeas), LatencyClass::kQuantum);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::FDIV_D), LatencyClass::kFpDiv);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::kFnmadd_s), LatencyClass::kFpFma);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::FLE_S), LatencyClass::kFpMisc);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::FDOT_FP16), LatencyClass::kFp16);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::FMAX_BF16), LatencyClass::kBf16);
+  EXPECT_EQ(ClassifyLatency(0, alu::AluOp::FMUL_MSFP16), LatencyClass::kMsfp16);
+
+  RegisterOperands mul = DecodeRegisterOperands(kMulT0S1S1);
+  EXPECT_EQ(mul.sources[0], 9);
+  EXPECT_EQ(mul.sources[1], 9);
+  EXPECT_EQ(mul.destination, 5);
+  // fsqrt.s f1, f2: rs2 selects the operation and is not read.
+  RegisterOperands fsqrt = DecodeRegisterOperands(RType(0b0101100, 0, 2, 0b000, 1, 0b1010011));
+  EXPECT_EQ(fsqrt.sources[0], 32 + 2);
+  EXPECT_EQ(fsqrt.sources[1], RegisterOperands::kNone);
+  EXPECT_EQ(fsqrt.destination, 32 + 1);
+  // fcvt.s.w f1, a0 reads a GPR.
+  RegisterOperands fcvt = DecodeRegisterOperands(RType(0b1101000, 0, 10, 0b000, 1, 0b1010011));
+  EXPECT_EQ(fcvt.sources[0], 10);
+  EXPECT_EQ(fcvt.destination, 32 + 1);
+  // sw a1, 0(a0) writes no register.
+  RegisterOperands store = DecodeRegisterOperands(RType(0, 11, 10, 0b010, 0, 0b0100011));
+  EXPECT_EQ(store.sources[0], 10);
+  EXPECT_EQ(store.sources[1], 11);
+  EXPECT_EQ(store.destination, RegisterOperands::kNone);
+}
+
+TEST(TimingModelTest, DependentInstructionsWaitForResultsTest) {
+  vm_config::VmConfig config = TimingConfig();
+  vm_config::TimingLatencies latencies;
+  latencies.mul = 4;
+  config.setTimingLatencies(latencies);
+  TimingModel model;
+  model.Start(config);
+  ASSERT_TRUE(model.IsEnabled());
+
+  EXPECT_EQ(model.Issue(kMulT0S1S1, alu::AluOp::kMul, 0), 0);
+  EXPECT_EQ(model.Issue(kAddT2S1S1, alu::AluOp::kAdd, 1), 0); // independent
+  EXPECT_EQ(model.Issue(kAddT1T1T0, alu::AluOp::kAdd, 2), 2); // t0 is ready at cycle 4
+  EXPECT_EQ(model.Issue(kAddT1T1T0, alu::AluOp::kAdd, 5), 0);
+  EXPECT_EQ(model.GetStats().data_stalls, 2);
+  EXPECT_EQ(model.GetStats().instructions[static_cast<size_t>(LatencyClass::kMul)], 1);
+  EXPECT_EQ(model.GetStats().instructions[static_cast<size_t>(LatencyClass::kAlu)], 3);
+
+  // Clear forgets pending results, e.g. after an undo moved the cycle count back.
+  model.Issue(kMulT0S1S1, alu::AluOp::kMul, 6);
+  model.Clear();
+  EXPECT_EQ(model.Issue(kAddT1T1T0, alu::AluOp::kAdd, 3), 0);
+
+  // Cycle counts past 32 bits.
+  model.Issue(kMulT0S1S1, alu::AluOp::kMul, 0xFFFFFFFFu);
+  EXPECT_EQ(model.Issue(kAddT1T1T0, alu::AluOp::kAdd, 0x100000000u), 3);
+
+  vm_config::VmConfig disabled;
+  model.Start(disabled);
+  EXPECT_FALSE(model.IsEnabled());
+}
+
+TEST(TimingModelTest, DividerIsNotPipelinedTest) {
+  TimingModel model;
+  model.Start(TimingConfig());
+  const uint64_t divide = vm_config::TimingLatencies().div;
+  EXPECT_EQ(model.Issue(kDivA0A1A2, alu::AluOp::kDiv, 0), 0);
+  EXPECT_EQ(model.Issue(kDivA3A4A5, alu::AluOp::kDiv, 1), divide - 1);
+  EXPECT_EQ(model.Issue(kMulT0S1S1, alu::AluOp::kMul, divide + 1), 0); // the multiplier is free
+  EXPECT_EQ(model.GetStats().structural_stalls, divide - 1);
+  EXPECT_EQ(model.GetStats().data_stalls, 0);
+}
+
+TEST(TimingModelTest, StallsTheVmTest) {
+  const std::string source = ".text\n"
+                             "  li s1, 100\n"
+                             "loop:\n"
+                             "  mul t0, t0, s1\n"
+                             "  add t1, t1, t0\n"
+                             "  addi s1, s1, -1\n"
+                             "  bne s1, x0, loop\n";
+  VmContext context = HeadlessContext();
+  context.config.setTimingEnabled(true);
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("timing.s", source));
+  while (!vm.IsHalted()) {
+    vm.RunQuantum(65536);
+  }
+  // Each add waits mul - 1 cycles for its product; nothing else stalls.
+  const uint64_t stalls = 100*(vm_config::TimingLatencies().mul - 1);
+  EXPECT_EQ(vm.stall_cycles_, stalls);
+  EXPECT_EQ(vm.cycle_s_, vm.instructions_retired_ + stalls);
+  EXPECT_EQ(vm.timing_model_.GetStats().data_stalls, stalls);
+  vm.UpdateCpi();
+  EXPECT_FLOAT_EQ(vm.cpi_, static_cast<float>(vm.cycle_s_)/static_cast<float>(vm.instructions_retired_));
+  EXPECT_FLOAT_EQ(vm.cpi_*vm.ipc_, 1.0f);
+  EXPECT_FALSE(vm.UsesBinaryTranslation());
+
+  // Undo takes back the step's stall along with the step.
+  vm.Reset();
+  vm.LoadProgram(AssembleSource("timing.s", source));
+  vm.Step();
+  vm.Step();
+  uint64_t before_add = vm.cycle_s_;
+  vm.Step();
+  EXPECT_EQ(vm.cycle_s_, before_add + vm_config::TimingLatencies().mul);
+  vm.Undo();
+  EXPECT_EQ(vm.cycle_s_, before_add);
+  vm.Redo();
+  EXPECT_EQ(vm.cycle_s_, before_add + vm_config::TimingLatencies().mul);
+}
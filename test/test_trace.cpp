@@ -0,0 +1,133 @@
+/**
+ * File Name: test_trace.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "common/lz_codec.h"
+#include "vm/trace.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+std::vector<uint8_t> RoundTrip(const std::vector<uint8_t> &data) {
+  std::vector<uint8_t> compressed = lz_codec::Compress(data.data(), data.size());
+  return lz_codec::Decompress(compressed.data(), compressed.size(), data.size());
+}
+
+} // namespace
+
+TEST(TraceTest, CodecRoundTripTest) {
+  EXPECT_TRUE(RoundTrip({}).empty());
+  EXPECT_EQ(RoundTrip({1, 2, 3}), (std::vector<uint8_t>{1, 2, 3}));
+
+  std::mt19937 rng(42);
+  std::vector<uint8_t> random(100000);
+  for (auto &byte : random) {
+    byte = static_cast<uint8_t>(rng());
+  }
+  EXPECT_EQ(RoundTrip(random), random);
+
+  // Long runs exercise the 255-continued literal and match lengths and overlapping matches.
+  std::vector<uint8_t> repetitive(random.begin(), random.begin() + 300);
+  repetitive.resize(200000, 7);
+  for (size_t i = 0; i < 1000; ++i) {
+    repetitive.push_back(static_cast<uint8_t>(i % 13));
+  }
+  std::vector<uint8_t> compressed = lz_codec::Compress(repetitive.data(), repetitive.size());
+  EXPECT_LT(compressed.size(), repetitive.size() / 50);
+  EXPECT_EQ(lz_codec::Decompress(compressed.data(), compressed.size(), repetitive.size()), repetitive);
+
+  EXPECT_THROW(lz_codec::Decompress(compressed.data(), compressed.size() / 2, repetitive.size()), std::runtime_error);
+  EXPECT_THROW(lz_codec::Decompress(compressed.data(), compressed.size(), repetitive.size() - 1), std::runtime_error);
+  EXPECT_THROW(lz_codec::Decompress(compressed.data(), compressed.size(), size_t{1} << 62), std::runtime_error);
+}
+
+TEST(TraceTest, WriterReaderRoundTripTest) {
+  std::filesystem::path file = TempPath("roundtrip.trace");
+  const uint64_t kRecords = TraceWriter::kRecordsPerChunk * 2 + 123;
+  auto make_record = [](uint64_t i) {
+    TraceRecord record{};
+    record.pc = i * 4;
+    record.instruction = 0x00000013 | static_cast<uint32_t>(i % 32) << 7;
+    record.rd = static_cast<uint8_t>(i % 32);
+    record.flags = TraceRecord::kWritesRd | (i % 3 == 0 ? TraceRecord::kMemWrite : 0);
+    record.rd_value = i * i;
+    record.mem_address = 0x10000000 + (i % 64) * 8;
+    record.mem_value = i ^ 0x5555;
+    return record;
+  };
+
+  {
+    TraceWriter writer;
+    writer.Open(file);
+    for (uint64_t i = 0; i < kRecords; ++i) {
+      writer.Append(make_record(i));
+    }
+    EXPECT_EQ(writer.GetRecordCount(), kRecords);
+    writer.Close();
+    EXPECT_FALSE(writer.IsOpen());
+  }
+  EXPECT_LT(std::filesystem::file_size(file), kRecords * sizeof(TraceRecord) / 2);
+
+  TraceReader reader(file);
+  TraceRecord record{};
+  for (uint64_t i = 0; i < kRecords; ++i) {
+    ASSERT_TRUE(reader.Next(record));
+    ASSERT_EQ(record, make_record(i)) << "record " << i;
+  }
+  EXPECT_FALSE(reader.Next(record));
+
+  std::ofstream(file) << "not a trace";
+  EXPECT_THROW(TraceReader{file}, std::runtime_error);
+}
+
+TEST(TraceTest, VmTraceTest) {
+  std::filesystem::path file = TempPath("trace.trace");
+  const std::string source = ".data\n"
+                             "value: .dword 0\n"
+                             ".text\n"
+                             "  la t0, value\n"
+                             "  addi t1, x0, 42\n"
+                             "  sw t1, 0(t0)\n"
+                             "  lw t2, 0(t0)\n"
+                             "  fcvt.d.l f1, t2\n";
+
+  VmContext context = HeadlessContext();
+  context.config.setTraceFile(file.string());
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("trace.s", source));
+  vm.Run();
+  EXPECT_FALSE(vm.trace_writer_.IsOpen());
+
+  TraceReader reader(file);
+  std::vector<TraceRecord> records;
+  TraceRecord record{};
+  while (reader.Next(record)) {
+    records.push_back(record);
+  }
+  ASSERT_EQ(records.size(), vm.instructions_retired_);
+
+  const TraceRecord &store = records[records.size() - 3];
+  EXPECT_EQ(store.flags, TraceRecord::kMemWrite);
+  EXPECT_EQ(store.mem_address, 0x10000000);
+  EXPECT_EQ(store.mem_value, 42);
+
+  const TraceRecord &load = records[records.size() - 2];
+  EXPECT_EQ(load.flags, TraceRecord::kWritesRd | TraceRecord::kMemRead);
+  EXPECT_EQ(load.rd, 7);
+  EXPECT_EQ(load.rd_value, 42);
+  EXPECT_EQ(load.mem_value, 42);
+
+  const TraceRecord &convert = records.back();
+  EXPECT_EQ(convert.flags, TraceRecord::kWritesRd | TraceRecord::kRdIsFpr);
+  EXPECT_EQ(convert.rd, 1);
+  EXPECT_EQ(convert.rd_value, 0x4045000000000000);
+}
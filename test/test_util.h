@@ -0,0 +1,81 @@
+/**
+ * File Name: test_util.h
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <gtest/gtest.h>
+#include "vm/vm_context.h"
+#include "assembler/assembler.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include <unistd.h>
+
+/**
+ * @brief The temp directory of this test process, removed again when all tests have run.
+ */
+inline std::filesystem::path TempDirectory() {
+  return std::filesystem::temp_directory_path() / ("vm_test_" + std::to_string(::getpid()));
+}
+
+class TempDirectoryEnvironment : public testing::Environment {
+ public:
+  void TearDown() override {
+    std::error_code error;
+    std::filesystem::remove_all(TempDirectory(), error);
+  }
+};
+
+inline testing::Environment *const kTempDirectoryEnvironment =
+    testing::AddGlobalTestEnvironment(new TempDirectoryEnvironment);
+
+/**
+ * @brief A path in TempDirectory() that no other test uses: the name is prefixed with the
+ *        running test's name, so concurrent test runs and tests do not collide.
+ */
+inline std::filesystem::path TempPath(const std::string &name) {
+  std::filesystem::create_directories(TempDirectory());
+  std::string prefix;
+  if (const testing::TestInfo *test = testing::UnitTest::GetInstance()->current_test_info()) {
+    prefix = std::string(test->test_suite_name()) + "_" + test->name() + "_";
+  }
+  return TempDirectory() / (prefix + name);
+}
+
+/**
+ * @brief Writes contents to TempPath(name) and returns the path.
+ */
+inline std::filesystem::path WriteTempFile(const std::string &name, const std::string &contents) {
+  std::filesystem::path path = TempPath(name);
+  std::ofstream(path) << contents;
+  return path;
+}
+
+/**
+ * @brief The global configuration, with no state dumps and no step delay.
+ */
+inline VmContext HeadlessContext() {
+  VmContext context = VmContext::FromGlobals();
+  context.dump_state = false;
+  context.config.setRunStepDelay(0);
+  return context;
+}
+
+/**
+ * @brief Assembles source through a temp file, which is removed again.
+ */
+inline AssembledProgram AssembleSource(const std::string &name, const std::string &source) {
+  std::filesystem::path path = WriteTempFile(name, source);
+  AssembledProgram program = assemble(path.string(), false);
+  std::filesystem::remove(path);
+  return program;
+}
+
+#endif // TEST_UTIL_H
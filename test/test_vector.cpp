@@ -0,0 +1,257 @@
+/**
+ * File Name: test_vector.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/rvss/rvss_vm.h"
+#include "vm/vector/vector_kernels.h"
+#include "test_util.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Data labels hold offsets into the data section.
+uint64_t DataAddress(RVSSVM &vm, const AssembledProgram &program, const std::string &label) {
+  return vm.context_.config.getDataSectionStart() + program.symbol_table.at(label).address;
+}
+
+double ReadDouble(RVSSVM &vm, uint64_t address) {
+  uint64_t bits = vm.memory_controller_.ReadDoubleWord(address);
+  double value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+} // namespace
+
+TEST(VectorTest, EncodingTest) {
+  AssembledProgram program = AssembleSource("vector_encoding.s", ".text\n"
+                                                                          "  vsetvli t0, a0, e32, m2, ta, ma\n"
+                                                                          "  vadd.vv v1, v2, v3\n"
+                                                                          "  vadd.vi v1, v2, -3, v0.t\n"
+                                                                          "  vle32.v v4, (a0)\n"
+                                                                          "  vfmacc.vf v8, fa0, v16\n"
+                                                                          "  vsetivli x0, 5, e8, mf2\n");
+  ASSERT_EQ(program.text_buffer.size(), 6);
+  EXPECT_EQ(program.text_buffer[0], 0x0D1572D7);
+  EXPECT_EQ(program.text_buffer[1], 0x022180D7);
+  EXPECT_EQ(program.text_buffer[2], 0x002EB0D7);
+  EXPECT_EQ(program.text_buffer[3], 0x02056207);
+  EXPECT_EQ(program.text_buffer[4], 0xB3055457);
+  EXPECT_EQ(program.text_buffer[5], 0xC072F057);
+}
+
+TEST(VectorTest, VsetvliTest) {
+  AssembledProgram program = AssembleSource("vector_vsetvli.s", ".text\n"
+                                                                         "  li a0, 100\n"
+                                                                         "  vsetvli t0, a0, e32, m2, ta, ma\n"
+                                                                         "  vsetvli t1, x0, e8, m8\n"
+                                                                         "  vsetivli t2, 3, e64, m2\n"
+                                                                         "  vsetvli t3, a0, e64, mf8\n");
+  VmContext context = HeadlessContext();
+  context.config.setVectorLength(128);
+  RVSSVM vm(context);
+  vm.LoadProgram(program);
+  vm.RunQuantum(4);
+  EXPECT_EQ(vm.registers_.ReadGpr(5), 8);
+  EXPECT_EQ(vm.registers_.ReadGpr(6), 128);
+  EXPECT_EQ(vm.registers_.ReadGpr(7), 3);
+  EXPECT_EQ(vm.registers_.ReadCsr(kCsrVl), 3);
+
+  // SEW 64 with LMUL 1/8 is reserved: vill is set and vl cleared.
+  vm.RunQuantum(1);
+  EXPECT_EQ(vm.registers_.ReadGpr(28), 0);
+  EXPECT_EQ(vm.registers_.ReadCsr(kCsrVtype), 1ULL << 63);
+}
+
+TEST(VectorTest, IntegerArithmeticTest) {
+  AssembledProgram program = AssembleSource("vector_int.s", ".data\n"
+                                                                     "a: .word 1, 2, 3, 4, 5, 6, 7, 8\n"
+                                                                     "b: .word 10, 20, 30, 40, 50, 60, 70, 80\n"
+                                                                     "sum: .word 0, 0, 0, 0, 0, 0, 0, 0\n"
+                                                                     "prod: .word 0, 0, 0, 0, 0, 0, 0, 0\n"
+                                                                     ".text\n"
+                                                                     "  la s0, a\n"
+                                                                     "  la s1, b\n"
+                                                                     "  la s2, sum\n"
+                                                                     "  la s3, prod\n"
+                                                                     "  li a1, 3\n"
+                                                                     "  vsetivli x0, 8, e32, m2, tu, mu\n"
+                                                                     "  vle32.v v2, (s0)\n"
+                                                                     "  vle32.v v4, (s1)\n"
+                                                                     "  vadd.vv v6, v2, v4\n"
+                                                                     "  vse32.v v6, (s2)\n"
+                                                                     "  vmsgt.vi v0, v2, 4\n"
+                                                                     "  vmv.v.i v8, -1\n"
+                                                                     "  vmul.vx v8, v4, a1, v0.t\n"
+                                                                     "  vse32.v v8, (s3)\n"
+                                                                     "  vmv.v.i v12, 0\n"
+                                                                     "  vredsum.vs v10, v6, v12\n"
+                                                                     "  vmv.x.s a2, v10\n"
+                                                                     "  vcpop.m a3, v0\n"
+                                                                     "  vfirst.m a4, v0\n"
+                                                                     "  li a7, 93\n"
+                                                                     "  ecall\n");
+  RVSSVM vm(HeadlessContext());
+  vm.LoadProgram(program);
+  vm.RunQuantum(UINT64_MAX);
+
+  uint64_t sum = DataAddress(vm, program, "sum");
+  uint64_t prod = DataAddress(vm, program, "prod");
+  for (uint64_t i = 0; i < 8; ++i) {
+    EXPECT_EQ(vm.memory_controller_.ReadWord(sum + 4*i), 11*(i + 1));
+    // Masked-off elements keep the -1 written by vmv.v.i.
+    EXPECT_EQ(vm.memory_controller_.ReadWord(prod + 4*i), i >= 4 ? 30*(i + 1) : 0xFFFFFFFF);
+  }
+  EXPECT_EQ(vm.registers_.ReadGpr(12), 396);
+  EXPECT_EQ(vm.registers_.ReadGpr(13), 4);
+  EXPECT_EQ(vm.registers_.ReadGpr(14), 4);
+}
+
+TEST(VectorTest, FloatAndStridedTest) {
+  AssembledProgram program = AssembleSource("vector_fp.s", ".data\n"
+                                                                    "x: .double 1.5, -1.0, 2.5, -2.0, 3.5, -3.0\n"
+                                                                    "k: .double 2.0\n"
+                                                                    "out: .double 0.0, 0.0, 0.0, 0.0, 0.0, 0.0\n"
+                                                                    ".text\n"
+                                                                    "  la s0, x\n"
+                                                                    "  la s1, k\n"
+                                                                    "  la s2, out\n"
+                                                                    "  li t0, 16\n"
+                                                                    "  fld fa0, 0(s1)\n"
+                                                                    "  vsetivli x0, 3, e64, m2\n"
+                                                                    "  vlse64.v v2, (s0), t0\n"
+                                                                    "  vfmul.vf v4, v2, fa0\n"
+                                                                    "  vfmv.v.f v6, fa0\n"
+                                                                    "  vfmacc.vv v6, v2, v4\n"
+                                                                    "  vsse64.v v6, (s2), t0\n"
+                                                                    "  vfmv.s.f v8, fa0\n"
+                                                                    "  vfredusum.vs v10, v4, v8\n"
+                                                                    "  vfmv.f.s fa1, v10\n"
+                                                                    "  vmflt.vf v0, v2, fa0\n"
+                                                                    "  vcpop.m a0, v0\n"
+                                                                    "  li a7, 93\n"
+                                                                    "  ecall\n");
+  RVSSVM vm(HeadlessContext());
+  vm.LoadProgram(program);
+  vm.RunQuantum(UINT64_MAX);
+
+  // Elements 0, 2 and 4 of x, each doubled and then squared into k.
+  uint64_t out = DataAddress(vm, program, "out");
+  EXPECT_DOUBLE_EQ(ReadDouble(vm, out), 2.0 + 1.5*3.0);
+  EXPECT_DOUBLE_EQ(ReadDouble(vm, out + 16), 2.0 + 2.5*5.0);
+  EXPECT_DOUBLE_EQ(ReadDouble(vm, out + 32), 2.0 + 3.5*7.0);
+  EXPECT_DOUBLE_EQ(ReadDouble(vm, out + 8), 0.0);
+
+  double reduced;
+  uint64_t bits = vm.registers_.ReadFpr(11);
+  std::memcpy(&reduced, &bits, sizeof(reduced));
+  EXPECT_DOUBLE_EQ(reduced, 2.0 + 3.0 + 5.0 + 7.0);
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 1);
+}
+
+TEST(VectorTest, UndoTest) {
+  AssembledProgram program = AssembleSource("vector_undo.s", ".data\n"
+                                                                      "buf: .dword 1, 2, 3, 4\n"
+                                                                      ".text\n"
+                                                                      "  la s0, buf\n"
+                                                                      "  vsetvli t0, x0, e64, m2\n"
+                                                                      "  vle64.v v2, (s0)\n"
+                                                                      "  vadd.vv v2, v2, v2\n"
+                                                                      "  vse64.v v2, (s0)\n");
+  RVSSVM vm(HeadlessContext());
+  vm.LoadProgram(program);
+  uint64_t buf = DataAddress(vm, program, "buf");
+  std::vector<uint8_t> initial_registers(vm.registers_.VectorData(),
+                                         vm.registers_.VectorData() + 32*vm.registers_.GetVlenb());
+  uint64_t initial_vtype = vm.registers_.ReadCsr(kCsrVtype);
+
+  while (vm.program_counter_ < program.text_buffer.size()*4) {
+    vm.Step();
+  }
+  EXPECT_EQ(vm.memory_controller_.ReadDoubleWord(buf + 24), 8);
+
+  // Undo the store, the add, the load and the vsetvli.
+  for (int i = 0; i < 4; ++i) {
+    vm.Undo();
+  }
+  EXPECT_EQ(vm.memory_controller_.ReadDoubleWord(buf + 24), 4);
+  EXPECT_EQ(vm.registers_.ReadCsr(kCsrVtype), initial_vtype);
+  EXPECT_TRUE(std::equal(initial_registers.begin(), initial_registers.end(), vm.registers_.VectorData()));
+
+  for (int i = 0; i < 4; ++i) {
+    vm.Redo();
+  }
+  EXPECT_EQ(vm.memory_controller_.ReadDoubleWord(buf + 24), 8);
+  EXPECT_EQ(vm.registers_.ReadVectorSlice(2*vm.registers_.GetVlenb()/8 + 1), 4);
+}
+
+TEST(VectorTest, IllegalTest) {
+  // vtype starts out illegal, so arithmetic before a vsetvli traps.
+  AssembledProgram program = AssembleSource("vector_illegal.s", ".text\n"
+                                                                         "  vadd.vv v1, v2, v3\n");
+  RVSSVM vm(HeadlessContext());
+  vm.LoadProgram(program);
+  EXPECT_ANY_THROW(vm.RunQuantum(UINT64_MAX));
+
+  // Groups must be aligned to LMUL.
+  program = AssembleSource("vector_group.s", ".text\n"
+                                                      "  vsetvli t0, x0, e32, m4\n"
+                                                      "  vadd.vv v2, v4, v8\n");
+  RVSSVM grouped(HeadlessContext());
+  grouped.LoadProgram(program);
+  EXPECT_ANY_THROW(grouped.RunQuantum(UINT64_MAX));
+}
+
+TEST(VectorTest, HostSimdMatchesScalarTest) {
+  rvv::HostIsa isa = rvv::DetectHostIsa();
+  if (isa==rvv::HostIsa::kScalar) {
+    GTEST_SKIP() << "The host has no SIMD kernels";
+  }
+  std::mt19937_64 random(42);
+  const size_t kElements = 37; // not a multiple of any vector width, so the tails run too
+  std::vector<uint8_t> a(kElements*8);
+  std::vector<uint8_t> b(kElements*8);
+  for (int op = 0; op <= static_cast<int>(rvv::IntOp::kNmsac); ++op) {
+    for (unsigned int sew : {8u, 16u, 32u, 64u}) {
+      for (auto &byte : a) byte = static_cast<uint8_t>(random());
+      for (auto &byte : b) byte = static_cast<uint8_t>(random());
+      std::vector<uint8_t> simd(a.rbegin(), a.rend());
+      std::vector<uint8_t> scalar = simd;
+      rvv::IntKernel(isa, static_cast<rvv::IntOp>(op), sew, kElements, a.data(), b.data(), simd.data());
+      rvv::IntKernel(rvv::HostIsa::kScalar, static_cast<rvv::IntOp>(op), sew, kElements, a.data(), b.data(),
+                     scalar.data());
+      EXPECT_EQ(simd, scalar) << "IntOp " << op << " at SEW " << sew;
+    }
+  }
+  // Values and NaNs alike; every NaN result is canonical on both paths.
+  const double kDoubles[] = {0.0, -0.0, 1.5, -2.25, 1e300, -1e-300, 3.0, std::numeric_limits<double>::quiet_NaN()};
+  const float kFloats[] = {0.0f, -0.0f, 1.5f, -2.25f, 1e30f, -1e-30f, 3.0f, std::numeric_limits<float>::quiet_NaN()};
+  for (int op = 0; op <= static_cast<int>(rvv::FpOp::kNmsac); ++op) {
+    for (unsigned int sew : {32u, 64u}) {
+      for (size_t i = 0; i < kElements; ++i) {
+        if (sew==64) {
+          std::memcpy(&a[8*i], &kDoubles[random()%8], 8);
+          std::memcpy(&b[8*i], &kDoubles[random()%8], 8);
+        } else {
+          std::memcpy(&a[4*i], &kFloats[random()%8], 4);
+          std::memcpy(&b[4*i], &kFloats[random()%8], 4);
+        }
+      }
+      std::vector<uint8_t> simd(b.rbegin(), b.rend());
+      std::vector<uint8_t> scalar = simd;
+      rvv::FpKernel(isa, static_cast<rvv::FpOp>(op), sew, kElements, a.data(), b.data(), simd.data());
+      rvv::FpKernel(rvv::HostIsa::kScalar, static_cast<rvv::FpOp>(op), sew, kElements, a.data(), b.data(),
+                    scalar.data());
+      EXPECT_EQ(simd, scalar) << "FpOp " << op << " at SEW " << sew;
+    }
+  }
+}
@@ -5,8 +5,13 @@
  */
 
 #include <gtest/gtest.h>
-#include "../src/vm/rvss/rvss_vm.h"
-#include "../src/assembler/assembler.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+#include "config.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <fstream>
 
 TEST(VmTest, ImmGenTest1) {
   RVSSVM vm;
@@ -104,11 +109,13 @@ TEST(VmTest, ExecutionTest3) {
 }
 
 TEST(VmTest, ExecutionTest4) {
-  AssembledProgram program = assemble("/home/vis/Desk/codes/assembler/examples/branch_test.s");
+  AssembledProgram program = assemble(VM_EXAMPLES_DIR "/branch_test.s");
   RVSSVM vm;
     vm.LoadProgram(program);
-  vm.Step();
-  vm.Step();
+  // lui, ld, sd and the two addis
+  for (int i = 0; i < 5; i++) {
+    vm.Step();
+  }
   vm.Fetch();
   vm.Decode();
   vm.Execute();
@@ -121,7 +128,7 @@ TEST(VmTest, ExecutionTest4) {
 }
 
 TEST(VmTest, ExecutionTest5) {
-  AssembledProgram program = assemble("/home/vis/Desk/codes/assembler/examples/load_test.s");
+  AssembledProgram program = assemble(VM_EXAMPLES_DIR "/load_test.s");
   RVSSVM vm;
     vm.LoadProgram(program);
   vm.Fetch();
@@ -136,7 +143,7 @@ TEST(VmTest, ExecutionTest5) {
 }
 
 TEST(VmTest, ExecutionTest6) {
-  AssembledProgram program = assemble("/home/vis/Desk/codes/assembler/examples/load_store_test_1.s");
+  AssembledProgram program = assemble(VM_EXAMPLES_DIR "/load_store_test_1.s");
   RVSSVM vm;
     vm.LoadProgram(program);
   vm.Step();
@@ -150,7 +157,7 @@ TEST(VmTest, ExecutionTest6) {
 }
 
 TEST(VmTest, ExecutionTest7) {
-  AssembledProgram program = assemble("/home/vis/Desk/codes/assembler/examples/load_store_test_2.s");
+  AssembledProgram program = assemble(VM_EXAMPLES_DIR "/load_store_test_2.s");
   RVSSVM vm;
     vm.LoadProgram(program);
   vm.Step();
@@ -168,7 +175,7 @@ TEST(VmTest, ExecutionTest7) {
 }
 
 TEST(VmTest, ExecutionTest8) {
-  AssembledProgram program = assemble("/home/vis/Desk/codes/assembler/examples/load_test_2.s");
+  AssembledProgram program = assemble(VM_EXAMPLES_DIR "/load_test_2.s");
   RVSSVM vm;
     vm.LoadProgram(program);
   vm.registers_.WriteGpr(3, 0x10000000); // set the data section address
@@ -177,20 +184,23 @@ TEST(VmTest, ExecutionTest8) {
 }
 
 TEST(VmTest, ExecutionTest9) {
-  AssembledProgram program = assemble("/home/vis/Desk/codes/assembler/examples/branch_test.s");
+  AssembledProgram program = assemble(VM_EXAMPLES_DIR "/branch_test.s");
   RVSSVM vm;
     vm.LoadProgram(program);
 
+  // Each pass reloads a0 with the first two instructions (lui, ld), adds 50 and branches back.
   for (int i = 1; i < 5; i++) {
-    vm.Step();
-    vm.Step();
-    vm.Step();
-    ASSERT_EQ(vm.registers_.ReadGpr(10), 50*i);
+    for (int step = 0; step < 6; step++) {
+      vm.Step();
+    }
+    ASSERT_EQ(vm.memory_controller_.ReadDoubleWord(0x10000000), 0x00003503100001b7);
+    ASSERT_EQ(vm.registers_.ReadGpr(10), 0x00003503100001b7 + 50);
+    ASSERT_EQ(vm.program_counter_, 0x0);
   }
 }
 
 // TEST(VmTest, ExecutionTest10) {
-//     AssembledProgram program = assemble("/home/vis/Desk/codes/assembler/examples/jal_test.s");
+//     AssembledProgram program = assemble(VM_EXAMPLES_DIR "/jal_test.s");
 //     RVSSVM vm;
 //     vm.LoadProgram(program);
 //     vm.registers_.WriteGpr(3, 0x10000000); // set the data section address
@@ -202,11 +212,132 @@ TEST(VmTest, ExecutionTest9) {
 // }
 
 TEST(VmTest, ExecutionTest11) {
-  AssembledProgram program = assemble("/home/vis/Desk/codes/assembler/examples/lui_auipc_test.s");
+  AssembledProgram program = assemble(VM_EXAMPLES_DIR "/lui_auipc_test.s");
   RVSSVM vm;
     vm.LoadProgram(program);
   vm.Step();
   ASSERT_EQ(vm.registers_.ReadGpr(3), 0x0000000000100000);
   vm.Step();
   ASSERT_EQ(vm.registers_.ReadGpr(4), 0x0000000000100004);
-}
\ No newline at end of file
+}
+TEST(VmTest, LoadProgramDataSectionTest) {
+  RVSSVM vm;
+  AssembledProgram program;
+  program.text_buffer.push_back(0x01700513);
+  program.data_buffer.emplace_back(static_cast<uint8_t>(0x11));
+  program.data_buffer.emplace_back(static_cast<uint32_t>(0x22334455));
+  program.data_buffer.emplace_back(std::string("hi"));
+  program.data_buffer.emplace_back(static_cast<uint64_t>(0x0102030405060708));
+
+  std::vector<uint8_t> image = SerializeDataSection(program);
+  ASSERT_EQ(image.size(), 24);
+
+  vm.LoadProgram(std::move(program));
+  uint64_t data_start = vm_config::config.getDataSectionStart();
+  ASSERT_EQ(vm.memory_controller_.ReadWord(0), 0x01700513);
+  ASSERT_EQ(vm.memory_controller_.ReadByte(data_start), 0x11);
+  ASSERT_EQ(vm.memory_controller_.ReadWord(data_start + 4), 0x22334455);
+  ASSERT_EQ(vm.memory_controller_.ReadByte(data_start + 8), 'h');
+  ASSERT_EQ(vm.memory_controller_.ReadByte(data_start + 9), 'i');
+  ASSERT_EQ(vm.memory_controller_.ReadDoubleWord(data_start + 16), 0x0102030405060708);
+  ASSERT_EQ(vm.program_size_, 4);
+}
+
+TEST(VmTest, PreloadedStdinSyscallTest) {
+  std::filesystem::path input = TempPath("stdin.txt");
+  std::ofstream(input) << "abc";
+  vm_config::config.setStdinFile(input.string());
+
+  RVSSVM vm;
+  AssembledProgram program;
+  program.text_buffer.push_back(0x03F00893); // addi a7, x0, 63
+  program.text_buffer.push_back(0x00000513); // addi a0, x0, 0
+  program.text_buffer.push_back(0x100005B7); // lui a1, 0x10000
+  program.text_buffer.push_back(0x00800613); // addi a2, x0, 8
+  program.text_buffer.push_back(0x00000073); // ecall
+  vm.LoadProgram(std::move(program));
+  vm_config::config.setStdinFile("");
+
+  for (int i = 0; i < 5; ++i) {
+    vm.Step();
+  }
+  ASSERT_EQ(vm.registers_.ReadGpr(10), 3);
+  ASSERT_EQ(vm.ReadString(0x10000000), "abc");
+}
+
+TEST(VmTest, PerInstanceContextTest) {
+  VmContext first_context = VmContext::FromGlobals();
+  first_context.dump_state = false;
+  first_context.config.setDataSectionStart(0x20000000);
+  VmContext second_context = first_context;
+  second_context.config.setDataSectionStart(0x30000000);
+  second_context.config.setMemoryBlockSize(64);
+
+  RVSSVM first(first_context);
+  RVSSVM second(second_context);
+  AssembledProgram program;
+  program.text_buffer.push_back(0x01700513);
+  program.data_buffer.emplace_back(static_cast<uint32_t>(0xdeadbeef));
+  first.LoadProgram(program);
+  second.LoadProgram(program);
+
+  ASSERT_EQ(first.memory_controller_.ReadWord(0x20000000), 0xdeadbeef);
+  ASSERT_EQ(first.memory_controller_.ReadWord(0x30000000), 0);
+  ASSERT_EQ(second.memory_controller_.ReadWord(0x30000000), 0xdeadbeef);
+  ASSERT_EQ(second.memory_controller_.ReadWord(0x20000000), 0);
+  ASSERT_EQ(vm_config::config.getDataSectionStart(), 0x10000000);
+}
+
+TEST(VmTest, HugeSyscallLengthTest) {
+  const std::string source = ".data\n"
+                             "message: .dword 0x6968\n"  // "hi"
+                             ".text\n"
+                             "  li t0, 1\n"
+                             "  slli t0, t0, 21\n"
+                             "  slli t0, t0, 21\n" // 1 << 42
+                             "  li a7, 64\n"
+                             "  li a0, 1\n"
+                             "  la a1, message\n"
+                             "  add a2, t0, x0\n"
+                             "  ecall\n"
+                             "  add s0, a0, x0\n"
+                             "  li a7, 63\n"
+                             "  li a0, 0\n"
+                             "  la a1, message\n"
+                             "  add a2, t0, x0\n"
+                             "  ecall\n"
+                             "  add s1, a0, x0\n"
+                             "  li a7, 64\n"
+                             "  li a0, 1\n"
+                             "  addi a1, x0, -1\n"
+                             "  li a2, 2\n"
+                             "  ecall\n"
+                             "  add s2, a0, x0\n"
+                             "  li a7, 64\n"
+                             "  li a0, 1\n"
+                             "  la a1, message\n"
+                             "  li a2, 2\n"
+                             "  ecall\n"
+                             "  add s3, a0, x0\n"
+                             "  li a7, 64\n"
+                             "  li a0, 1\n"
+                             "  li a1, 269484032\n" // 0x10100000
+                             "  li a2, 200000\n"
+                             "  ecall\n"
+                             "  add s4, a0, x0\n";
+  VmContext context = HeadlessContext();
+  context.config.setMemorySize(0x20000000);
+  RVSSVM vm(context);
+  vm.guest_io_.SetCaptureOutput(true);
+  vm.LoadProgram(AssembleSource("huge_length.s", source));
+  vm.Run();
+  vm.guest_io_.Flush();
+
+  EXPECT_EQ(static_cast<int64_t>(vm.registers_.ReadGpr(8)), -EFAULT);
+  EXPECT_EQ(static_cast<int64_t>(vm.registers_.ReadGpr(9)), -EFAULT);
+  EXPECT_EQ(static_cast<int64_t>(vm.registers_.ReadGpr(18)), -EFAULT); // address + length wraps
+  EXPECT_EQ(vm.registers_.ReadGpr(19), 2);
+  // Spans several copy chunks.
+  EXPECT_EQ(vm.registers_.ReadGpr(20), 200000);
+  EXPECT_EQ(vm.guest_io_.GetCapturedStdout(), "hi" + std::string(200000, '\0'));
+}
@@ -0,0 +1,82 @@
+/**
+ * File Name: test_watchpoints.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "vm/watchpoints.h"
+#include "vm/rvss/rvss_vm.h"
+#include "test_util.h"
+
+#include <stdexcept>
+
+TEST(WatchpointTest, PageFilterAndMatchTest) {
+  WatchpointSet watchpoints;
+  EXPECT_TRUE(watchpoints.Empty());
+  EXPECT_FALSE(watchpoints.IsPageWatched(0x10000000, 8, kWatchWrite));
+
+  watchpoints.Add(0x10000010, 8, kWatchWrite);
+  EXPECT_TRUE(watchpoints.IsPageWatched(0x10000000, 8, kWatchWrite));
+  EXPECT_FALSE(watchpoints.IsPageWatched(0x10000000, 8, kWatchRead));
+  EXPECT_FALSE(watchpoints.IsPageWatched(0x10001000, 8, kWatchWrite));
+  // Same slot, different page: passes the filter, rejected by the range check.
+  uint64_t aliased = 0x10000000 + WatchpointSet::kPageSlots * 4096;
+  EXPECT_TRUE(watchpoints.IsPageWatched(aliased, 8, kWatchWrite));
+  EXPECT_EQ(watchpoints.Match(aliased, 8, kWatchWrite), nullptr);
+
+  EXPECT_EQ(watchpoints.Match(0x10000008, 8, kWatchWrite), nullptr);
+  EXPECT_NE(watchpoints.Match(0x1000000C, 8, kWatchWrite), nullptr);
+  EXPECT_NE(watchpoints.Match(0x10000017, 1, kWatchWrite), nullptr);
+  EXPECT_EQ(watchpoints.Match(0x10000018, 1, kWatchWrite), nullptr);
+  EXPECT_EQ(watchpoints.GetWatchpoints()[0].hits, 2);
+
+  // An access straddling a page boundary checks the page of its last byte too.
+  watchpoints.Add(0x10002000, 4, ParseWatchKind("rw"));
+  EXPECT_TRUE(watchpoints.IsPageWatched(0x10001FFC, 8, kWatchRead));
+  EXPECT_NE(watchpoints.Match(0x10001FFC, 8, kWatchRead), nullptr);
+
+  EXPECT_TRUE(watchpoints.Remove(0x10000010));
+  EXPECT_FALSE(watchpoints.Remove(0x10000010));
+  EXPECT_FALSE(watchpoints.IsPageWatched(0x10000000, 8, kWatchWrite));
+
+  EXPECT_THROW(watchpoints.Add(0x100, 0, kWatchRead), std::invalid_argument);
+  EXPECT_THROW(watchpoints.Add(UINT64_MAX, 2, kWatchRead), std::invalid_argument);
+  EXPECT_THROW(ParseWatchKind("x"), std::invalid_argument);
+}
+
+TEST(WatchpointTest, VmWatchpointTest) {
+  const std::string source = ".data\n"
+                             "arr: .dword 0, 0, 0, 0\n"
+                             ".text\n"
+                             "  la t0, arr\n"
+                             "  addi t1, x0, 3\n"
+                             "loop:\n"
+                             "  sd t1, 0(t0)\n"
+                             "  addi t0, t0, 8\n"
+                             "  addi t1, t1, -1\n"
+                             "  bne t1, x0, loop\n"
+                             "  la t0, arr\n"
+                             "  ld a0, 16(t0)\n"
+                             "  addi a1, x0, 1\n";
+
+  VmContext context = HeadlessContext();
+  RVSSVM vm(context);
+  vm.LoadProgram(AssembleSource("watchpoints.s", source));
+  vm.AddWatchpoint(0x10000010, 8, "rw");
+
+  // The store of the third iteration; execution stops after it.
+  vm.DebugRun();
+  EXPECT_EQ(vm.output_status_, "VM_WATCHPOINT_HIT");
+  EXPECT_EQ(vm.program_counter_, 16);
+  EXPECT_EQ(vm.memory_controller_.ReadDoubleWord(0x10000010), 1);
+
+  vm.DebugRun();
+  EXPECT_EQ(vm.output_status_, "VM_WATCHPOINT_HIT");
+  EXPECT_EQ(vm.registers_.ReadGpr(10), 1);
+  EXPECT_EQ(vm.watchpoints_.GetWatchpoints()[0].hits, 2);
+
+  vm.DebugRun();
+  EXPECT_EQ(vm.output_status_, "VM_PROGRAM_END");
+  EXPECT_EQ(vm.registers_.ReadGpr(11), 1);
+}
@@ -0,0 +1,80 @@
+/**
+ * File Name: test_yolo_bench.cpp
+ * Author: Vishank Singh
+ * Github: https://github.com/VishankSingh
+ */
+
+#include <gtest/gtest.h>
+#include "yolo_bench.h"
+#include "test_util.h"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using yolo_bench::NumberFormat;
+
+TEST(YoloBenchTest, ParseYoloV4TinyTest) {
+  std::vector<yolo_bench::ConvLayer> layers = yolo_bench::ParseConvLayers(std::string(VM_EXAMPLES_DIR)
+                                                                              + "/../yolov4-tiny.cfg");
+  ASSERT_EQ(layers.size(), 21);
+  EXPECT_EQ(layers[0].in_channels, 3);
+  EXPECT_EQ(layers[0].out_width, 208);
+  EXPECT_EQ(layers[0].pad, 1);
+  // After the grouped route, which keeps half of layer 2's 64 channels.
+  EXPECT_EQ(layers[3].darknet_layer, 4);
+  EXPECT_EQ(layers[3].in_channels, 32);
+  // After the third maxpool.
+  EXPECT_EQ(layers[14].in_height, 13);
+  EXPECT_EQ(layers[14].in_channels, 512);
+  // The head convolutions: 1x1, linear, and the upsampled route of 128 + 256 channels.
+  EXPECT_EQ(layers[17].filters, 255);
+  EXPECT_EQ(layers[17].pad, 0);
+  EXPECT_FALSE(layers[17].leaky);
+  EXPECT_EQ(layers[19].in_width, 26);
+  EXPECT_EQ(layers[19].in_channels, 384);
+}
+
+TEST(YoloBenchTest, BadConfigTest) {
+  std::filesystem::path cfg = TempPath("yolo_bad.cfg");
+  std::ofstream(cfg) << "[net]\nwidth=8\nheight=8\nchannels=3\n[route]\nlayers=-3\n";
+  EXPECT_THROW(yolo_bench::ParseConvLayers(cfg), std::runtime_error);
+  std::ofstream(cfg) << "[net]\n[lstm]\n";
+  EXPECT_THROW(yolo_bench::ParseConvLayers(cfg), std::runtime_error);
+  EXPECT_THROW(yolo_bench::ParseFormat("fp8"), std::invalid_argument);
+}
+
+TEST(YoloBenchTest, KernelMatchesReferenceTest) {
+  std::filesystem::path cfg = TempPath("yolo.cfg");
+  std::ofstream(cfg) << "[net]\nwidth=6\nheight=6\nchannels=5\n\n"
+                        "[convolutional]\nfilters=6\nsize=3\nstride=2\npad=1\nactivation=leaky\n";
+  std::vector<yolo_bench::ConvLayer> layers = yolo_bench::ParseConvLayers(cfg);
+  ASSERT_EQ(layers.size(), 1);
+  ASSERT_EQ(layers[0].out_width, 3);
+
+  // The tile is clamped to the 3x3 output, so the window reaches the padding on both sides.
+  yolo_bench::Workload workload = yolo_bench::MakeWorkload(layers[0], 8, 0, 7);
+  EXPECT_EQ(workload.tile, 3);
+  EXPECT_EQ(workload.window, 7);
+  EXPECT_EQ(workload.input[0], 0.0f);
+
+  std::filesystem::path source = TempPath("yolo_kernel.s");
+  uint64_t fp32_instructions = 0;
+  for (NumberFormat format : {NumberFormat::kFp32, NumberFormat::kFp16, NumberFormat::kBf16, NumberFormat::kMsfp16}) {
+    std::ofstream(source) << yolo_bench::GenerateKernel(workload, format);
+    VmContext context = VmContext::FromGlobals();
+    yolo_bench::KernelResult result = yolo_bench::RunKernel(workload, format, source, context);
+    ASSERT_EQ(result.output.size(), 3*3*6);
+    EXPECT_GT(result.instructions, 0);
+    EXPECT_EQ(result.cycles, result.instructions);
+    if (format == NumberFormat::kFp32) {
+      fp32_instructions = result.instructions;
+      EXPECT_LT(result.rms_rel_error, 1e-6);
+    } else {
+      // Four filters per instruction; the six filters take two groups.
+      EXPECT_LT(result.instructions, fp32_instructions/2);
+      EXPECT_LT(result.rms_rel_error, format == NumberFormat::kBf16 ? 5e-2 : 1e-2) << yolo_bench::FormatName(format);
+      EXPECT_GT(result.rms_rel_error, 0);
+    }
+  }
+}
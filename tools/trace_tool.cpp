@@ -0,0 +1,143 @@
+/**
+ * @file trace_tool.cpp
+ * @brief Offline viewer and differ for binary execution traces.
+ * @author Vishank Singh, https://github.com/VishankSingh
+ */
+
+#include "vm/trace.h"
+
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+void PrintUsage(const char *program) {
+  std::cout << "Usage: " << program << " <command> [options]\n"
+            << "Commands:\n"
+            << "  dump <trace> [--start <n>] [--count <n>]  Print records\n"
+            << "  stats <trace>                             Print record counts per kind\n"
+            << "  diff <a> <b> [--context <n>]              Find the first diverging record\n"
+            << "Exit status of diff: 0 identical, 1 diverged, 2 error.\n";
+}
+
+uint64_t OptionValue(int argc, char *argv[], const std::string &name, uint64_t fallback) {
+  for (int i = 0; i + 1 < argc; ++i) {
+    if (argv[i] == name) {
+      return std::stoull(argv[i + 1]);
+    }
+  }
+  return fallback;
+}
+
+/**
+ * @brief Names the first field that differs, pc first since a control-flow divergence explains the rest.
+ */
+std::string DescribeDifference(const TraceRecord &a, const TraceRecord &b) {
+  if (a.pc != b.pc) return "pc";
+  if (a.instruction != b.instruction) return "instruction";
+  if (a.rd != b.rd || (a.flags & 0b11) != (b.flags & 0b11)) return "destination register";
+  if (a.rd_value != b.rd_value) return "destination register value";
+  if (a.flags != b.flags) return "memory access kind";
+  if (a.mem_address != b.mem_address) return "memory address";
+  return "memory value";
+}
+
+int Dump(const std::string &filename, uint64_t start, uint64_t count) {
+  TraceReader reader(filename);
+  TraceRecord record{};
+  while (reader.GetPosition() < start && reader.Next(record)) {
+  }
+  for (uint64_t printed = 0; printed < count && reader.Next(record); ++printed) {
+    std::cout << FormatTraceRecord(reader.GetPosition() - 1, record) << '\n';
+  }
+  return 0;
+}
+
+int Stats(const std::string &filename) {
+  TraceReader reader(filename);
+  TraceRecord record{};
+  uint64_t register_writes = 0;
+  uint64_t loads = 0;
+  uint64_t stores = 0;
+  while (reader.Next(record)) {
+    register_writes += (record.flags & TraceRecord::kWritesRd) != 0;
+    loads += (record.flags & TraceRecord::kMemRead) != 0;
+    stores += (record.flags & TraceRecord::kMemWrite) != 0;
+  }
+  std::cout << "records:         " << reader.GetPosition() << '\n'
+            << "register writes: " << register_writes << '\n'
+            << "loads:           " << loads << '\n'
+            << "stores:          " << stores << '\n';
+  return 0;
+}
+
+int Diff(const std::string &filename_a, const std::string &filename_b, uint64_t context) {
+  TraceReader reader_a(filename_a);
+  TraceReader reader_b(filename_b);
+  std::deque<TraceRecord> history;
+  TraceRecord a{};
+  TraceRecord b{};
+
+  while (true) {
+    bool has_a = reader_a.Next(a);
+    bool has_b = reader_b.Next(b);
+    if (!has_a && !has_b) {
+      std::cout << "Traces are identical (" << reader_a.GetPosition() << " records)\n";
+      return 0;
+    }
+    uint64_t index = (has_a ? reader_a.GetPosition() : reader_b.GetPosition()) - 1;
+    if (has_a && has_b && a == b) {
+      history.push_back(a);
+      if (history.size() > context) {
+        history.pop_front();
+      }
+      continue;
+    }
+
+    for (size_t i = 0; i < history.size(); ++i) {
+      std::cout << "  " << FormatTraceRecord(index - history.size() + i, history[i]) << '\n';
+    }
+    if (!has_a || !has_b) {
+      std::cout << "First divergence at record " << index << ": " << (has_a ? filename_b : filename_a)
+                << " ends here\n";
+    } else {
+      std::cout << "First divergence at record " << index << ": " << DescribeDifference(a, b) << " differs\n";
+    }
+    if (has_a) {
+      std::cout << "< " << FormatTraceRecord(index, a) << '\n';
+    }
+    if (has_b) {
+      std::cout << "> " << FormatTraceRecord(index, b) << '\n';
+    }
+    return 1;
+  }
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+  if (argc < 3) {
+    PrintUsage(argv[0]);
+    return 2;
+  }
+  std::string command = argv[1];
+  try {
+    if (command == "dump") {
+      return Dump(argv[2], OptionValue(argc, argv, "--start", 0), OptionValue(argc, argv, "--count", UINT64_MAX));
+    }
+    if (command == "stats") {
+      return Stats(argv[2]);
+    }
+    if (command == "diff" && argc >= 4) {
+      return Diff(argv[2], argv[3], OptionValue(argc, argv, "--context", 5));
+    }
+  } catch (const std::exception &e) {
+    std::cerr << "Error: " << e.what() << '\n';
+    return 2;
+  }
+  PrintUsage(argv[0]);
+  return 2;
+}